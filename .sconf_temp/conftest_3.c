@@ -0,0 +1,9 @@
+
+
+#include "GL/gl.h"
+
+int
+main() {
+  glXGetProcAddressARB("");
+return 0;
+}
@@ -7,6 +7,7 @@
 #include "src/cli_cli_extension.cpp"
 #include "src/cli_clog.cpp"
 #include "src/cli_commandtofile.cpp"
+#include "src/cli_deadline.cpp"
 #include "src/cli_debug.cpp"
 #include "src/cli_defaultwmedepth.cpp"
 #include "src/cli_dirs.cpp"
@@ -44,7 +45,9 @@
 #include "src/cli_predict.cpp"
 #include "src/cli_preferences.cpp"
 #include "src/cli_print.cpp"
+#include "src/cli_productioncost.cpp"
 #include "src/cli_productionfind.cpp"
+#include "src/cli_profile.cpp"
 #include "src/cli_pushd.cpp"
 #include "src/cli_pwatch.cpp"
 #include "src/cli_pwd.cpp"
@@ -88,6 +88,21 @@ namespace cli
             
             virtual bool DoCommandToFile(const eLogMode mode, const std::string& filename, std::vector< std::string >& argv) = 0;
             
+            enum eDeadlineMode
+            {
+                DEADLINE_QUERY,
+                DEADLINE_SET,
+                DEADLINE_OFF,
+                DEADLINE_RESET,
+            };
+            
+            /**
+             * @brief deadline command
+             * @param mode Set the deadline or turn it off, reset the counts, or report them
+             * @param usec The deadline for each decision cycle, for DEADLINE_SET
+             */
+            virtual bool DoDeadline(eDeadlineMode mode, int64_t usec = 0) = 0;
+            
             /**
              * @brief debug command
              *
@@ -419,6 +434,31 @@ namespace cli
              */
             virtual bool DoPrint(PrintBitset options, int depth, const std::string* pArg = 0) = 0;
             
+            enum eProductionCostMode
+            {
+                PRODUCTION_COST_QUERY,
+                PRODUCTION_COST_ON,
+                PRODUCTION_COST_OFF,
+                PRODUCTION_COST_RESET,
+            };
+            
+            enum eProductionCostSort
+            {
+                PRODUCTION_COST_SORT_MATCH,
+                PRODUCTION_COST_SORT_TOKENS,
+                PRODUCTION_COST_SORT_ACTIVATIONS,
+                PRODUCTION_COST_SORT_TESTS,
+                PRODUCTION_COST_SORT_FIRING,
+            };
+            
+            /**
+             * @brief production-cost command
+             * @param mode Turn the counting on or off, reset the counts, or list them
+             * @param sort What to sort the list by, most expensive first
+             * @param numberToList The number of productions to list, -1 lists all
+             */
+            virtual bool DoProductionCost(eProductionCostMode mode, eProductionCostSort sort = PRODUCTION_COST_SORT_MATCH, int numberToList = -1) = 0;
+            
             enum eProductionFindOptions
             {
                 PRODUCTION_FIND_INCLUDE_LHS,
@@ -437,6 +477,23 @@ namespace cli
              */
             virtual bool DoProductionFind(const ProductionFindBitset& options, const std::string& pattern) = 0;
             
+            enum eProfileMode
+            {
+                PROFILE_QUERY,
+                PROFILE_ON,
+                PROFILE_OFF,
+                PROFILE_CLEAR,
+                PROFILE_CHROME,
+                PROFILE_COLLAPSED,
+            };
+            
+            /**
+             * @brief profile command
+             * @param mode What to do
+             * @param pFilename The file to write the spans to (PROFILE_CHROME and PROFILE_COLLAPSED only)
+             */
+            virtual bool DoProfile(eProfileMode mode, const std::string* pFilename = 0) = 0;
+            
             /**
              * @brief pushd command
              * @param directory The directory to change to
@@ -606,6 +663,10 @@ namespace cli
                 STATS_STOP_TRACK,
                 STATS_DECISION,
                 STATS_AGENT,
+                STATS_UTILIZATION,
+                STATS_HISTOGRAM,
+                STATS_ACCOUNTING,
+                STATS_COUNTERS,
                 STATS_NUM_OPTIONS, // must be last
             };
             typedef std::bitset<STATS_NUM_OPTIONS> StatsBitset;
@@ -634,8 +695,9 @@ namespace cli
              * @brief timers command
              * @param pSetting The timers setting, true to turn on, false to turn off,
              *        pass 0 (null) to query
+             * @param pCounters The hardware counters setting, as for pSetting
              */
-            virtual bool DoTimers(bool* pSetting = 0) = 0;
+            virtual bool DoTimers(bool* pSetting = 0, bool* pCounters = 0) = 0;
             
             virtual bool DoUnalias(std::vector<std::string>& argv) = 0;
             
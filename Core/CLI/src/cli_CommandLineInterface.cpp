@@ -46,6 +46,7 @@ EXPORT CommandLineInterface::CommandLineInterface()
     m_Parser.AddCommand(new cli::CliExtensionMessageCommand(*this));
     m_Parser.AddCommand(new cli::CLogCommand(*this));
     m_Parser.AddCommand(new cli::CommandToFileCommand(*this));
+    m_Parser.AddCommand(new cli::DeadlineCommand(*this));
     m_Parser.AddCommand(new cli::DebugCommand(*this));
     m_Parser.AddCommand(new cli::DefaultWMEDepthCommand(*this));
     m_Parser.AddCommand(new cli::DirsCommand(*this));
@@ -83,7 +84,9 @@ EXPORT CommandLineInterface::CommandLineInterface()
     m_Parser.AddCommand(new cli::PredictCommand(*this));
     m_Parser.AddCommand(new cli::PreferencesCommand(*this));
     m_Parser.AddCommand(new cli::PrintCommand(*this));
+    m_Parser.AddCommand(new cli::ProductionCostCommand(*this));
     m_Parser.AddCommand(new cli::ProductionFindCommand(*this));
+    m_Parser.AddCommand(new cli::ProfileCommand(*this));
     m_Parser.AddCommand(new cli::PushDCommand(*this));
     m_Parser.AddCommand(new cli::PWatchCommand(*this));
     m_Parser.AddCommand(new cli::PWDCommand(*this));
@@ -119,6 +119,7 @@ namespace cli
             virtual bool DoCLIMessage(const std::string& pMessage);
             virtual bool DoCLog(const eLogMode mode = LOG_QUERY, const std::string* pFilename = 0, const std::string* pToAdd = 0, bool silent = false);
             virtual bool DoCommandToFile(const eLogMode mode, const std::string& filename, std::vector< std::string >& argv);
+            virtual bool DoDeadline(eDeadlineMode mode, int64_t usec = 0);
             virtual bool DoDebug(std::vector< std::string >* argv = 0);
             virtual bool DoDefaultWMEDepth(const int* pDepth);
             virtual bool DoDirs();
@@ -156,7 +157,9 @@ namespace cli
             virtual bool DoPredict();
             virtual bool DoPreferences(const ePreferencesDetail detail, const bool object, const std::string* pId = 0, const std::string* pAttribute = 0);
             virtual bool DoPrint(PrintBitset options, int depth, const std::string* pArg = 0);
+            virtual bool DoProductionCost(eProductionCostMode mode, eProductionCostSort sort = PRODUCTION_COST_SORT_MATCH, int numberToList = -1);
             virtual bool DoProductionFind(const ProductionFindBitset& options, const std::string& pattern);
+            virtual bool DoProfile(eProfileMode mode, const std::string* pFilename = 0);
             virtual bool DoPushD(const std::string& directory);
             virtual bool DoPWatch(bool query = true, const std::string* pProduction = 0, bool setting = false);
             virtual bool DoPWD();
@@ -177,7 +180,7 @@ namespace cli
             virtual bool DoStats(const StatsBitset& options, int sort = 0);
             virtual bool DoStopSoar(bool self, const std::string* reasonForStopping = 0);
             virtual bool DoTime(std::vector<std::string>& argv);
-            virtual bool DoTimers(bool* pSetting = 0);
+            virtual bool DoTimers(bool* pSetting = 0, bool* pCounters = 0);
             virtual bool DoUnalias(std::vector<std::string>& argv);
             virtual bool DoVerbose(bool* pSetting = 0);
             virtual bool DoVersion();
@@ -255,6 +258,10 @@ namespace cli
             void GetMaxStats(); // for stats
             void GetReteStats(); // for stats
             void GetAgentStats(); // for stats
+            void GetUtilizationStats(bool reset); // for stats
+            void GetHistogramStats(bool reset); // for stats
+            void GetAccountingStats(); // for stats
+            void GetCounterStats(bool reset); // for stats
             
             bool Evaluate(const char* pInput); // source, formerly StreamSource
             
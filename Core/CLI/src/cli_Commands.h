@@ -618,6 +618,113 @@ namespace cli
             CommandToFileCommand& operator=(const CommandToFileCommand&);
     };
     
+    class DeadlineCommand : public cli::ParserCommand
+    {
+        public:
+            DeadlineCommand(cli::Cli& cli) : cli(cli), ParserCommand() {}
+            virtual ~DeadlineCommand() {}
+            virtual const char* GetString() const
+            {
+                return "deadline";
+            }
+            virtual const char* GetSyntax() const
+            {
+                return
+                    "Syntax: deadline [--seconds] [n]\n"
+                    "deadline --off|--reset";
+            }
+            
+            virtual bool Parse(std::vector< std::string >& argv)
+            {
+                cli::Options opt;
+                OptionsData optionsData[] =
+                {
+                    {'s', "seconds", OPTARG_NONE},
+                    {'d', "disable", OPTARG_NONE},
+                    {'o', "off",     OPTARG_NONE},
+                    {'r', "reset",   OPTARG_NONE},
+                    {0, 0, OPTARG_NONE}
+                };
+                
+                Cli::eDeadlineMode mode = Cli::DEADLINE_QUERY;
+                bool seconds = false;
+                
+                for (;;)
+                {
+                    if (!opt.ProcessOptions(argv, optionsData))
+                    {
+                        return cli.SetError(opt.GetError());
+                    }
+                    
+                    if (opt.GetOption() == -1)
+                    {
+                        break;
+                    }
+                    
+                    switch (opt.GetOption())
+                    {
+                        case 's':
+                            seconds = true;
+                            break;
+                        case 'd':
+                        case 'o':
+                            mode = Cli::DEADLINE_OFF;
+                            break;
+                        case 'r':
+                            mode = Cli::DEADLINE_RESET;
+                            break;
+                    }
+                }
+                
+                if (opt.GetNonOptionArguments() > 1)
+                {
+                    return cli.SetError(GetSyntax());
+                }
+                
+                int64_t usec = 0;
+                
+                if (opt.GetNonOptionArguments() == 1)
+                {
+                    if (mode != Cli::DEADLINE_QUERY)
+                    {
+                        return cli.SetError(GetSyntax());
+                    }
+                    
+                    int index = opt.GetArgument() - opt.GetNonOptionArguments();
+                    
+                    if (seconds)
+                    {
+                        double nsec = 0;
+                        
+                        if (!from_string(nsec, argv[index]))
+                        {
+                            return cli.SetError(GetSyntax());
+                        }
+                        
+                        usec = static_cast<int64_t>(nsec * 1000000);
+                    }
+                    else if (!from_string(usec, argv[index]))
+                    {
+                        return cli.SetError(GetSyntax());
+                    }
+                    
+                    if (usec <= 0)
+                    {
+                        return cli.SetError("Expected a positive deadline.");
+                    }
+                    
+                    mode = Cli::DEADLINE_SET;
+                }
+                
+                return cli.DoDeadline(mode, usec);
+            }
+            
+        private:
+            cli::Cli& cli;
+            
+            DeadlineCommand& operator=(const DeadlineCommand&);
+    };
+    
     class DebugCommand : public cli::ParserCommand
     {
         public:
@@ -2943,6 +3050,124 @@ namespace cli
             PrintCommand& operator=(const PrintCommand&);
     };
     
+    class ProductionCostCommand : public cli::ParserCommand
+    {
+        public:
+            ProductionCostCommand(cli::Cli& cli) : cli(cli), ParserCommand() {}
+            virtual ~ProductionCostCommand() {}
+            virtual const char* GetString() const
+            {
+                return "production-cost";
+            }
+            virtual const char* GetSyntax() const
+            {
+                return
+                    "Syntax: production-cost --on|--off|--reset\n"
+                    "production-cost [--sort match|tokens|activations|tests|firing] [n]";
+            }
+            
+            virtual bool Parse(std::vector< std::string >& argv)
+            {
+                cli::Options opt;
+                OptionsData optionsData[] =
+                {
+                    {'d', "disable", OPTARG_NONE},
+                    {'d', "off",     OPTARG_NONE},
+                    {'e', "enable",  OPTARG_NONE},
+                    {'e', "on",      OPTARG_NONE},
+                    {'r', "reset",   OPTARG_NONE},
+                    {'s', "sort",    OPTARG_REQUIRED},
+                    {0, 0, OPTARG_NONE}
+                };
+                
+                Cli::eProductionCostMode mode = Cli::PRODUCTION_COST_QUERY;
+                Cli::eProductionCostSort sort = Cli::PRODUCTION_COST_SORT_MATCH;
+                
+                for (;;)
+                {
+                    if (!opt.ProcessOptions(argv, optionsData))
+                    {
+                        return cli.SetError(opt.GetError());
+                    }
+                    
+                    if (opt.GetOption() == -1)
+                    {
+                        break;
+                    }
+                    
+                    switch (opt.GetOption())
+                    {
+                        case 'd':
+                            mode = Cli::PRODUCTION_COST_OFF;
+                            break;
+                        case 'e':
+                            mode = Cli::PRODUCTION_COST_ON;
+                            break;
+                        case 'r':
+                            mode = Cli::PRODUCTION_COST_RESET;
+                            break;
+                        case 's':
+                        {
+                            std::string key = opt.GetOptionArgument();
+                            if (key == "match")
+                            {
+                                sort = Cli::PRODUCTION_COST_SORT_MATCH;
+                            }
+                            else if (key == "tokens")
+                            {
+                                sort = Cli::PRODUCTION_COST_SORT_TOKENS;
+                            }
+                            else if (key == "activations")
+                            {
+                                sort = Cli::PRODUCTION_COST_SORT_ACTIVATIONS;
+                            }
+                            else if (key == "tests")
+                            {
+                                sort = Cli::PRODUCTION_COST_SORT_TESTS;
+                            }
+                            else if (key == "firing")
+                            {
+                                sort = Cli::PRODUCTION_COST_SORT_FIRING;
+                            }
+                            else
+                            {
+                                return cli.SetError("Unknown sort key: " + key);
+                            }
+                        }
+                        break;
+                    }
+                }
+                
+                // The number to list defaults to -1 (list all)
+                int numberToList = -1;
+                
+                if (opt.GetNonOptionArguments() > 1)
+                {
+                    return cli.SetError(GetSyntax());
+                }
+                
+                if (opt.GetNonOptionArguments() == 1)
+                {
+                    if (mode != Cli::PRODUCTION_COST_QUERY)
+                    {
+                        return cli.SetError(GetSyntax());
+                    }
+                    
+                    if (!from_string(numberToList, argv[opt.GetArgument() - opt.GetNonOptionArguments()]) || numberToList <= 0)
+                    {
+                        return cli.SetError("Expected positive integer (count).");
+                    }
+                }
+                
+                return cli.DoProductionCost(mode, sort, numberToList);
+            }
+            
+        private:
+            cli::Cli& cli;
+            
+            ProductionCostCommand& operator=(const ProductionCostCommand&);
+    };
+    
     class ProductionFindCommand : public cli::ParserCommand
     {
         public:
@@ -3033,6 +3258,95 @@ namespace cli
             ProductionFindCommand& operator=(const ProductionFindCommand&);
     };
     
+    class ProfileCommand : public cli::ParserCommand
+    {
+        public:
+            ProfileCommand(cli::Cli& cli) : cli(cli), ParserCommand() {}
+            virtual ~ProfileCommand() {}
+            virtual const char* GetString() const
+            {
+                return "profile";
+            }
+            virtual const char* GetSyntax() const
+            {
+                return
+                    "Syntax: profile [--query]\n"
+                    "profile --on|--off|--clear\n"
+                    "profile --chrome filename\n"
+                    "profile --flame filename";
+            }
+            
+            virtual bool Parse(std::vector< std::string >& argv)
+            {
+                cli::Options opt;
+                OptionsData optionsData[] =
+                {
+                    {'c', "clear",   OPTARG_NONE},
+                    {'C', "chrome",  OPTARG_REQUIRED},
+                    {'d', "disable", OPTARG_NONE},
+                    {'d', "off",     OPTARG_NONE},
+                    {'e', "enable",  OPTARG_NONE},
+                    {'e', "on",      OPTARG_NONE},
+                    {'f', "flame",   OPTARG_REQUIRED},
+                    {'q', "query",   OPTARG_NONE},
+                    {0, 0, OPTARG_NONE}
+                };
+                
+                Cli::eProfileMode mode = Cli::PROFILE_QUERY;
+                std::string filename;
+                
+                for (;;)
+                {
+                    if (!opt.ProcessOptions(argv, optionsData))
+                    {
+                        return cli.SetError(opt.GetError());
+                    }
+                    
+                    if (opt.GetOption() == -1)
+                    {
+                        break;
+                    }
+                    
+                    switch (opt.GetOption())
+                    {
+                        case 'c':
+                            mode = Cli::PROFILE_CLEAR;
+                            break;
+                        case 'C':
+                            mode = Cli::PROFILE_CHROME;
+                            filename = opt.GetOptionArgument();
+                            break;
+                        case 'd':
+                            mode = Cli::PROFILE_OFF;
+                            break;
+                        case 'e':
+                            mode = Cli::PROFILE_ON;
+                            break;
+                        case 'f':
+                            mode = Cli::PROFILE_COLLAPSED;
+                            filename = opt.GetOptionArgument();
+                            break;
+                        case 'q':
+                            mode = Cli::PROFILE_QUERY;
+                            break;
+                    }
+                }
+                
+                if (opt.GetNonOptionArguments())
+                {
+                    return cli.SetError(GetSyntax());
+                }
+                
+                bool writing = (mode == Cli::PROFILE_CHROME || mode == Cli::PROFILE_COLLAPSED);
+                return cli.DoProfile(mode, writing ? &filename : 0);
+            }
+            
+        private:
+            cli::Cli& cli;
+            
+            ProfileCommand& operator=(const ProfileCommand&);
+    };
+    
     class PushDCommand : public cli::ParserCommand
     {
         public:
@@ -3903,6 +4217,7 @@ namespace cli
                     {'g', "get",        OPTARG_NONE},
                     {'h', "history",    OPTARG_NONE},//Testing/unstable - 23-7-2014
                     {'i', "init",       OPTARG_NONE},
+                    {'I', "import",     OPTARG_NONE},
                     {'p', "print",      OPTARG_NONE},
                     {'q', "query",      OPTARG_NONE},//Testing/unstable - 23-7-2014
                     {'r', "remove",     OPTARG_NONE},//Testing/unstable - 23-7-2014
@@ -3982,6 +4297,15 @@ namespace cli
                         return cli.DoSMem(option, &(argv[2]), 0);
                     }
                     
+                    case 'I':
+                        // case: import requires one non-option argument
+                        if (!opt.CheckNumNonOptArgs(1, 1))
+                        {
+                            return cli.SetError(opt.GetError().c_str());
+                        }
+                        
+                        return cli.DoSMem(option, &(argv[2]));
+                        
                     case 'i':
                     case 'e':
                     case 'd':
@@ -4330,6 +4654,10 @@ namespace cli
                     {'C', "cycle-csv",  OPTARG_NONE},
                     {'S', "sort",       OPTARG_REQUIRED},
                     {'a', "agent",      OPTARG_NONE},
+                    {'u', "utilization", OPTARG_NONE},
+                    {'H', "histogram",  OPTARG_NONE},
+                    {'A', "accounting", OPTARG_NONE},
+                    {'P', "counters",   OPTARG_NONE},
                     {0, 0, OPTARG_NONE}
                 };
                 
@@ -4390,6 +4718,18 @@ namespace cli
                         case 'a':
                             options.set(Cli::STATS_AGENT);
                             break;
+                        case 'u':
+                            options.set(Cli::STATS_UTILIZATION);
+                            break;
+                        case 'H':
+                            options.set(Cli::STATS_HISTOGRAM);
+                            break;
+                        case 'A':
+                            options.set(Cli::STATS_ACCOUNTING);
+                            break;
+                        case 'P':
+                            options.set(Cli::STATS_COUNTERS);
+                            break;
                     }
                 }
                 
@@ -4531,11 +4871,16 @@ namespace cli
                     {'d', "disable",    OPTARG_NONE},
                     {'d', "off",        OPTARG_NONE},
                     {'e', "on",            OPTARG_NONE},
+                    {'c', "counters",    OPTARG_NONE},
+                    {'C', "no-counters", OPTARG_NONE},
                     {0, 0, OPTARG_NONE}
                 };
                 
                 bool print = true;
                 bool setting = false;    // enable or disable timers, default of false ignored
+                bool setTimers = false;
+                bool counters = false;   // enable or disable hardware counters
+                bool setCounters = false;
                 
                 for (;;)
                 {
@@ -4554,10 +4899,22 @@ namespace cli
                         case 'e':
                             print = false;
                             setting = true; // enable timers
+                            setTimers = true;
                             break;
                         case 'd':
                             print = false;
                             setting = false; // disable timers
+                            setTimers = true;
+                            break;
+                        case 'c':
+                            print = false;
+                            counters = true;
+                            setCounters = true;
+                            break;
+                        case 'C':
+                            print = false;
+                            counters = false;
+                            setCounters = true;
                             break;
                     }
                 }
@@ -4568,7 +4925,12 @@ namespace cli
                     return cli.SetError(GetSyntax());
                 }
                 
-                return cli.DoTimers(print ? 0 : &setting);
+                if (print)
+                {
+                    return cli.DoTimers();
+                }
+                
+                return cli.DoTimers(setTimers ? &setting : 0, setCounters ? &counters : 0);
             }
             
         private:
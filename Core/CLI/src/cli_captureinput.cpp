@@ -37,7 +37,7 @@ bool CommandLineInterface::DoCaptureInput(eCaptureInputMode mode, bool autoflush
                 return SetError("File name required.");
             }
             
-            uint32_t seed = SoarRandInt();
+            uint32_t seed = SoarRandInt(m_pAgentSML->GetSoarAgent());
             
             if (!m_pAgentSML->StartCaptureInput(*pathname, autoflush, seed))
             {
@@ -0,0 +1,78 @@
+/////////////////////////////////////////////////////////////////
+// deadline command file.
+//
+// Sets the per-decision-cycle deadline and reports the work
+// deadline mode has put off (see deadline.h).
+//
+/////////////////////////////////////////////////////////////////
+
+#include "portability.h"
+
+#include "cli_CommandLineInterface.h"
+
+#include "cli_Commands.h"
+
+#include "sml_AgentSML.h"
+
+#include "agent.h"
+#include "deadline.h"
+
+#include <iomanip>
+
+using namespace cli;
+using namespace sml;
+
+bool CommandLineInterface::DoDeadline(eDeadlineMode mode, int64_t usec)
+{
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    
+    switch (mode)
+    {
+        case DEADLINE_SET:
+            thisAgent->sysparams[DECISION_CYCLE_DEADLINE_USEC] = usec;
+            return true;
+            
+        case DEADLINE_OFF:
+            // Anything still queued is done at the end of the next output phase
+            thisAgent->sysparams[DECISION_CYCLE_DEADLINE_USEC] = 0;
+            return true;
+            
+        case DEADLINE_RESET:
+            deadline_reset_stats(thisAgent);
+            return true;
+            
+        case DEADLINE_QUERY:
+            break;
+    }
+    
+    if (thisAgent->sysparams[DECISION_CYCLE_DEADLINE_USEC] > 0)
+    {
+        m_Result << "Deadline: " << thisAgent->sysparams[DECISION_CYCLE_DEADLINE_USEC] << " microseconds per decision cycle.\n";
+    }
+    else
+    {
+        m_Result << "Deadline mode is off.\n";
+    }
+    
+    size_t oldPrecision = m_Result.precision(1);
+    m_Result << std::setiosflags(std::ios_base::fixed);
+    
+    double missed = thisAgent->deadline_cycles ? 100.0 * thisAgent->deadline_missed / thisAgent->deadline_cycles : 0.0;
+    m_Result << "Cycles with a deadline: " << thisAgent->deadline_cycles << ", over it: " << thisAgent->deadline_missed << " (" << missed << "%)\n";
+    
+    m_Result << "Work             Deferred    Done        Waiting\n";
+    m_Result << "---------------- ----------- ----------- -----------\n";
+    
+    for (int i = 0; i < NUM_DEFERRED_WORK_TYPES; i++)
+    {
+        m_Result << std::setw(16) << std::left << deferred_work_names[i] << std::right << " ";
+        m_Result << std::setw(11) << thisAgent->deadline_deferred[i] << " ";
+        m_Result << std::setw(11) << thisAgent->deadline_drained[i] << " ";
+        m_Result << std::setw(11) << thisAgent->deadline_queued[i] << "\n";
+    }
+    
+    m_Result << std::resetiosflags(std::ios_base::fixed);
+    m_Result.precision(oldPrecision);
+    
+    return true;
+}
@@ -435,6 +435,47 @@ void initdocstrings()
         "\n"
         "clog\n"
         ;
+    docstrings["deadline"] =
+        "Give each decision cycle a deadline and put off background work to meet it.\n"
+        "\n"
+        "Synopsis \n"
+        "\n"
+        "deadline [--seconds] [n]\n"
+        "deadline --off|--reset\n"
+        "\n"
+        "Options \n"
+        "\n"
+        "-s, --seconds        n is in seconds rather than microseconds.\n"
+        "-d, --disable, --off Turn deadline mode off.\n"
+        "-r, --reset          Set the counts back to zero.\n"
+        "n                    The deadline for each decision cycle (default\n"
+        "                     microseconds).\n"
+        "\n"
+        "Description \n"
+        "\n"
+        "With a deadline set, background work that doesn't have to be done in the\n"
+        "decision cycle that asked for it is put on a queue once the cycle has used up\n"
+        "its time: WMA's forgetting sweep and smem's incremental base-level activation\n"
+        "updates. At the end of each output phase the queue is worked through, oldest\n"
+        "first, for as long as that cycle is still under the deadline, so the work is\n"
+        "done in the spare time of later cycles. Forgetting sweeps asked for while one\n"
+        "is already waiting are folded into it. Storing episodes and building chunks\n"
+        "are never put off, as both depend on the cycle that asked for them.\n"
+        "\n"
+        "With no arguments the command reports the deadline, how many cycles have run\n"
+        "with one and how many of those went over it, and for each kind of work how\n"
+        "many times it was put off, how many queued items have been done and how many\n"
+        "are waiting. A cycle's time is the time spent in its phases, as reported by\n"
+        "stats --histogram, so the deadline has no effect while the timers are off.\n"
+        "Turning deadline mode off does all the waiting work at the end of the next\n"
+        "output phase. init-soar throws the waiting work away and resets the counts.\n"
+        "\n"
+        "Unlike max-dc-time, a cycle that goes over its deadline doesn't stop Soar.\n"
+        "\n"
+        "See Also \n"
+        "\n"
+        "max-dc-time stats timers\n"
+        ;
     docstrings["default-wme-depth"] =
         "Set the level of detail used to print WMEs.\n"
         "\n"
@@ -2283,6 +2324,39 @@ void initdocstrings()
         "\n"
         "default-wme-depth wma\n"
         ;
+    docstrings["production-cost"] =
+        "Find the productions that cost the most to match and fire.\n"
+        "\n"
+        "Synopsis \n"
+        "\n"
+        "production-cost --on|--off|--reset\n"
+        "production-cost [--sort match|tokens|activations|tests|firing] [n]\n"
+        "\n"
+        "Options \n"
+        "\n"
+        "-e, --enable, --on   Start counting.\n"
+        "-d, --disable, --off Stop counting.\n"
+        "-r, --reset          Set all the counts back to zero.\n"
+        "-s, --sort           Column to sort the list by (default match).\n"
+        "n                    List only the n most expensive productions.\n"
+        "\n"
+        "Description \n"
+        "\n"
+        "While counting is on, each node in the rete counts the tokens it creates, its\n"
+        "left and right activations and the variable tests it evaluates, and the time\n"
+        "spent firing each production (building its instantiation and executing its\n"
+        "actions) is recorded. With no options the command lists the productions, most\n"
+        "expensive first. Nodes are shared between productions, so each production is\n"
+        "charged an equal share of the counts on every node it uses; the columns for\n"
+        "all productions add up to the total work done in the rete.\n"
+        "\n"
+        "The match column is the sum of the tokens, activations and tests. Counting is\n"
+        "off by default, as it slows matching down. Counts are not reset by init-soar.\n"
+        "\n"
+        "See Also \n"
+        "\n"
+        "firing-counts stats profile\n"
+        ;
     docstrings["production-find"] =
         "Find productions by condition or action patterns.\n"
         "\n"
@@ -2351,6 +2425,45 @@ void initdocstrings()
         "\n"
         "sp\n"
         ;
+    docstrings["profile"] =
+        "Record where the kernel spends its time and write it out for a trace viewer\n"
+        "or flame graph.\n"
+        "\n"
+        "Synopsis \n"
+        "\n"
+        "profile [--query]\n"
+        "profile --on|--off|--clear\n"
+        "profile --chrome filename\n"
+        "profile --flame filename\n"
+        "\n"
+        "Options \n"
+        "\n"
+        "-q, --query          Print whether the profiler is on and a summary of the\n"
+        "                     time spent in each kind of span (default).\n"
+        "-e, --enable, --on   Start recording.\n"
+        "-d, --disable, --off Stop recording.\n"
+        "-c, --clear          Throw away everything recorded so far.\n"
+        "-C, --chrome         Write the spans to filename in Chrome trace event format.\n"
+        "-f, --flame          Write the spans to filename as collapsed stacks.\n"
+        "\n"
+        "Description \n"
+        "\n"
+        "While the profiler is on the kernel records a span (start and end time) for\n"
+        "each phase and for the work inside phases that usually matters: matching,\n"
+        "firing productions, chunking, epmem, smem, the input and output functions\n"
+        "and the SML commands it handles. Spans are kept per thread, in a ring buffer\n"
+        "that holds the most recent 65536, so the profiler can be left on. It is off\n"
+        "by default and costs almost nothing while off.\n"
+        "\n"
+        "The --chrome file can be loaded into chrome://tracing or Perfetto. The\n"
+        "--flame file has one line per stack of spans with its self time in\n"
+        "microseconds, which is the input flamegraph.pl and speedscope expect. Stop\n"
+        "the profiler before writing, or spans recorded while writing may be missed.\n"
+        "\n"
+        "See Also \n"
+        "\n"
+        "stats timers\n"
+        ;
     docstrings["pushd"] =
         "Push a directory onto the directory stack, changing to it.\n"
         "\n"
@@ -2987,6 +3100,7 @@ void initdocstrings()
         "smem -S|--stats [<statistic>]\n"
         "smem -t|--timers [<timer>]\n"
         "smem -a|--add <concept>\n"
+        "smem -I|--import <file name>\n"
         "smem -p|--print [<lti>] [<depth>]\n"
         "smem -v|--viz [<lti>] [<depth>]\n"
         "smem -b|--backup <file name>\n"
@@ -3002,6 +3116,7 @@ void initdocstrings()
         "-S, --stats          Print statistic summary or specific statistic\n"
         "-t, --timers         Print timer summary or specific statistic\n"
         "-a, --add            Add concepts to semantic memory\n"
+        "-I, --import         Bulk-load concepts from a file into semantic memory\n"
         "-r, --remove         Remove concepts from semantic memory\n"
         "-p, --print          Print semantic store in user-readable format\n"
         "-q, --query          Print concepts in semantic store matching some cue\n"
@@ -3037,6 +3152,8 @@ void initdocstrings()
         "          changes\n"
         "path      Location of database file                          empty,     empty\n"
         "                                                             some path\n"
+        "shared    Share one read-only copy of the database file with on, off    off\n"
+        "          other agents in the process\n"
         "\n"
         "The learning parameter turns the episodic memory module on or off. When\n"
         "learning is set to off, no new episodes are encoded and no commands put on the\n"
@@ -3059,6 +3176,15 @@ void initdocstrings()
         "switch databases or database storage types while running, set your new\n"
         "parameters and then perform an smem --init command.\n"
         "\n"
+        "When shared is on and database is file, the file at path is read once into\n"
+        "process memory and that copy is used by every agent that shares the same path.\n"
+        "It is freed when the last of them closes it. Each agent keeps its own\n"
+        "activation and spreading data. The shared store cannot be changed, so store\n"
+        "commands fail, mirroring is skipped, smem --add, --import, --remove, --viz\n"
+        "and --backup report an error, and activation is not written back to the\n"
+        "file. The incremental base-update-policy reads the shared store and the\n"
+        "agent's own access data.\n"
+        "\n"
         "The smem --backup command can be used to make a copy of the current state of\n"
         "the database, whether in memory or on disk. This command will commit all\n"
         "outstanding changes before initiating the copy.\n"
@@ -3107,6 +3233,14 @@ void initdocstrings()
         "                          re-computed for old memories\n"
         "thresh                    Threshold for activation         0, 1, ...    100\n"
         "                          locality\n"
+        "spreading                 Spread activation from LTIs in   on, off      off\n"
+        "                          working memory\n"
+        "spreading-depth           Number of LTI edges activation   1, 2, ...    2\n"
+        "                          spreads across\n"
+        "spreading-limit           LTIs with more LTI values than   1, 2, ...    100\n"
+        "                          this do not spread\n"
+        "spreading-budget          LTIs visited per query to spread 1, 2, ...    10000\n"
+        "                          from new context\n"
         "\n"
         "If activation-mode is base-level, three parameters control bias values. The\n"
         "base-decay parameter sets the free decay parameter in the base-level model.\n"
@@ -3121,6 +3255,16 @@ void initdocstrings()
         "updates a constant number of memories, those with last-access ages defined by\n"
         "the base-incremental-threshes set.\n"
         "\n"
+        "When spreading is on, each LTI in working memory spreads one unit of\n"
+        "activation through the LTI values of the semantic store, divided evenly among\n"
+        "the values at each step, for up to spreading-depth steps. The activation an LTI\n"
+        "receives is added to its activation when ranking query candidates. Each LTI's\n"
+        "spread is computed once, when it enters working memory, and removed when it\n"
+        "leaves. A query computes spread for at most spreading-budget LTIs visited;\n"
+        "the rest is computed by later queries. Spreading requires native-store, and\n"
+        "spreading, spreading-depth and spreading-limit cannot be changed while the\n"
+        "database is open.\n"
+        "\n"
         "Performance Parameters \n"
         "\n"
         "Parameter    Description                          Possible values   Default\n"
@@ -3128,6 +3272,8 @@ void initdocstrings()
         "             SQLite cache\n"
         "lazy-commit  Delay writing semantic store changes on, off           on\n"
         "             to file until agent exits\n"
+        "native-store Serve reads from an in-process copy   on, off           on\n"
+        "             of the semantic store\n"
         "optimization Policy for committing data to disk   safety,           performance\n"
         "                                                  performance\n"
         "page-size    Size of each memory page used in the 1k, 2k, 4k, 8k,   8k\n"
@@ -3144,6 +3290,11 @@ void initdocstrings()
         "setting the database to memory or another database and issuing init-soar/smem\n"
         "--init or by shutting down the Soar kernel.\n"
         "\n"
+        "When native-store is on, the semantic store is read into process memory when\n"
+        "the database is initialized and all retrievals are served from that copy.\n"
+        "SQLite is then used only to persist changes. This parameter cannot be changed\n"
+        "while the database is open.\n"
+        "\n"
         "Statistics \n"
         "\n"
         "Semantic memory tracks statistics over the lifetime of the agent. These can be\n"
@@ -3198,6 +3349,7 @@ void initdocstrings()
         "\n"
         "Timer            Description\n"
         "three_activation Recency information maintenance\n"
+        "three_spreading  Spreading activation from working memory\n"
         "\n"
         "Manual Storage \n"
         "\n"
@@ -3219,6 +3371,15 @@ void initdocstrings()
         "children. Each child will be its own concept with two constant attribute/value\n"
         "pairs.\n"
         "\n"
+        "Large knowledge bases are better loaded with smem --import <file name>. The\n"
+        "file may hold either bare concepts, in the --add format above, or Soar\n"
+        "source containing smem --add commands. Importing inserts augmentations in\n"
+        "batches, builds the retrieval indices once loading is complete, and updates\n"
+        "frequencies and activations in a single pass at the end. It reports the\n"
+        "number of concepts loaded and the load rate; with watch --smem on, progress is\n"
+        "printed periodically. If any concept can't be parsed, nothing in the file is\n"
+        "imported.\n"
+        "\n"
         "Manual Removal \n"
         "\n"
         "Part or all of the information in the semantic store of some LTI can be\n"
@@ -3526,6 +3687,11 @@ void initdocstrings()
         "providing a seed will seed the generator based on the contents of /dev/urandom\n"
         "(if available) or else based on time() and clock() values.\n"
         "\n"
+        "Each agent has its own generator, seeded as if by srand without a seed when the\n"
+        "agent is created, so srand only affects the agent it is run in. An agent's\n"
+        "sequence does not depend on other agents, even when they are run on several\n"
+        "threads (see set_run_threads).\n"
+        "\n"
         "Examples \n"
         "\n"
         "srand 0\n"
@@ -3559,6 +3725,16 @@ void initdocstrings()
         "-C,          print out collected per-cycle maximum statistics saved by --track\n"
         "--cycle-csv  in comma-separated form\n"
         "-S, --sort N sort the tracked cycle stats by column number N, see table below\n"
+        "-u,          report how long this agent's steps take and how busy each run\n"
+        "--utilization thread has been (with --reset, zero these afterwards)\n"
+        "-H,          report percentiles of how long this agent's decision cycles,\n"
+        "--histogram  phases and epmem/smem queries and the kernel's commands have taken\n"
+        "             (with --reset, empty the histograms afterwards)\n"
+        "-A,          report the memory this agent is using, by subsystem, and\n"
+        "--accounting SQLite's total\n"
+        "-P,          report the cycles, instructions, cache misses and branch\n"
+        "--counters   mispredicts counted in each phase and in matching (with --reset,\n"
+        "             zero them afterwards)\n"
         "\n"
         "Tracked Cycle Stats Columns \n"
         "\n"
@@ -3605,6 +3781,39 @@ void initdocstrings()
         "The stats argument --rete provides information about node usage in the Rete\n"
         "net, the large data structure used for efficient matching in Soar.\n"
         "\n"
+        "The --utilization argument reports the number of steps (phases, or whatever\n"
+        "agents are interleaved by) this agent has been run for, the time they took and\n"
+        "a recent average, which is used to share agents out between run threads. If\n"
+        "agents are run on several threads it also reports how many steps each thread\n"
+        "took, how many of those it took from another thread's share, and the fraction\n"
+        "of the run it spent stepping agents.\n"
+        "\n"
+        "The --histogram argument reports how long things have taken as percentiles\n"
+        "(in microseconds) rather than totals, so the occasional slow decision cycle\n"
+        "shows up. Decision cycles are the sum of their phases, so time between\n"
+        "interleaved steps isn't counted. Commands are those sent to the kernel that\n"
+        "didn't run Soar. Percentiles are accurate to within about 6%. The same\n"
+        "histograms are available from the kernel as structured output (the\n"
+        "get_latency_stats command), and init-soar empties the agent's histograms.\n"
+        "\n"
+        "The --accounting argument breaks down the memory the agent is using by what\n"
+        "it is for: the rete, working memory, productions, symbols, RL, WMA, epmem,\n"
+        "smem, SVS and SML, plus hash tables, strings and other memory the kernel\n"
+        "allocates, and the cache, schema and statements of each SQLite database. Live\n"
+        "bytes are in use; reserved bytes also count free items in memory pools. SVS\n"
+        "and SML figures are estimates. SQLite's total is for every database of every\n"
+        "agent. The kernel's get_memory_stats command returns the same figures for\n"
+        "every agent as structured output.\n"
+        "\n"
+        "The --counters argument reports the CPU's hardware counters for each phase\n"
+        "(turn them on with timers --counters): how many times the phase ran, the\n"
+        "cycles, instructions, cache misses and branch mispredicts counted while it\n"
+        "ran, and instructions per cycle. The total row adds up the phases; the match\n"
+        "row is the rete's share of them, counted for each batch of working memory\n"
+        "changes. Only user-space work on the thread running the agent is counted.\n"
+        "Counters the CPU doesn't have are shown as n/a, and if it can't count them\n"
+        "all at once the counts are estimates.\n"
+        "\n"
         "The --max argument reports per-cycle maximum statistics for decision cycle\n"
         "time, working memory changes, and production fires. For example, if Soar runs\n"
         "for three cycles and there were 23 working memory changes in the first cycle,\n"
@@ -3819,6 +4028,9 @@ void initdocstrings()
         "\n"
         "-d, --disable, --off Disable all timers.\n"
         "-e, --enable, --on   Enable timers as compiled.\n"
+        "-c, --counters       Count cycles, instructions, cache misses and branch\n"
+        "                     mispredicts in each phase (see stats --counters).\n"
+        "-C, --no-counters    Stop counting them.\n"
         "\n"
         "Description \n"
         "\n"
@@ -3830,6 +4042,12 @@ void initdocstrings()
         "been enabled with compiler directives. See the stats command for more info on\n"
         "the Soar timing system.\n"
         "\n"
+        "The hardware counters are off by default, and only available on Linux, where\n"
+        "they are read with perf_event_open. Containers and virtual machines often don't\n"
+        "provide them, and /proc/sys/kernel/perf_event_paranoid can forbid them; then\n"
+        "--counters fails with the reason, and printing the timer status says why\n"
+        "they're unavailable. With them on, each phase costs two more system calls.\n"
+        "\n"
         "See Also \n"
         "\n"
         "stats\n"
@@ -0,0 +1,115 @@
+/////////////////////////////////////////////////////////////////
+// production-cost command file.
+//
+// Turns per-production cost counting on and off and lists the
+// productions that cost the most (see get_production_costs in rete.cpp).
+//
+/////////////////////////////////////////////////////////////////
+
+#include "portability.h"
+
+#include "cli_CommandLineInterface.h"
+
+#include <algorithm>
+
+#include "cli_Commands.h"
+
+#include "sml_AgentSML.h"
+
+#include "agent.h"
+#include "production.h"
+#include "rete.h"
+#include "symtab.h"
+
+using namespace cli;
+using namespace sml;
+
+// The value a production is sorted by
+static double GetProductionCost(const production_cost& cost, Cli::eProductionCostSort sort)
+{
+    switch (sort)
+    {
+        case Cli::PRODUCTION_COST_SORT_TOKENS:
+            return cost.tokens;
+        case Cli::PRODUCTION_COST_SORT_ACTIVATIONS:
+            return cost.left_activations + cost.right_activations;
+        case Cli::PRODUCTION_COST_SORT_TESTS:
+            return cost.tests;
+        case Cli::PRODUCTION_COST_SORT_FIRING:
+            return static_cast<double>(cost.prod->firing_time);
+        case Cli::PRODUCTION_COST_SORT_MATCH:
+        default:
+            break;
+    }
+    return cost.tokens + cost.left_activations + cost.right_activations + cost.tests;
+}
+
+struct ProductionCostSort
+{
+    Cli::eProductionCostSort sort;
+    
+    bool operator()(const production_cost& a, const production_cost& b) const
+    {
+        return GetProductionCost(a, sort) > GetProductionCost(b, sort);
+    }
+};
+
+bool CommandLineInterface::DoProductionCost(eProductionCostMode mode, eProductionCostSort sort, int numberToList)
+{
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    
+    switch (mode)
+    {
+        case PRODUCTION_COST_ON:
+            thisAgent->production_cost_enabled = true;
+            return true;
+            
+        case PRODUCTION_COST_OFF:
+            thisAgent->production_cost_enabled = false;
+            return true;
+            
+        case PRODUCTION_COST_RESET:
+            reset_production_costs(thisAgent);
+            return true;
+            
+        case PRODUCTION_COST_QUERY:
+            break;
+    }
+    
+    std::vector<production_cost> costs;
+    get_production_costs(thisAgent, &costs);
+    
+    ProductionCostSort s;
+    s.sort = sort;
+    std::stable_sort(costs.begin(), costs.end(), s);
+    
+    double raw_per_msec = get_raw_time_per_usec() * 1000;
+    
+    m_Result << "Production costs are " << (thisAgent->production_cost_enabled ? "on" : "off") << ".\n";
+    m_Result << "       Match      Tokens   L-Activ'ns  R-Activ'ns       Tests    Firings  Firing (ms)  Production\n";
+    
+    size_t oldPrecision = m_Result.precision();
+    m_Result << std::setiosflags(std::ios_base::fixed);
+    
+    int i = 0;
+    for (std::vector<production_cost>::iterator iter = costs.begin();
+            iter != costs.end() && (numberToList <= 0 || i < numberToList);
+            ++iter, ++i)
+    {
+        m_Result << std::setprecision(0);
+        m_Result << std::setw(12) << GetProductionCost(*iter, PRODUCTION_COST_SORT_MATCH);
+        m_Result << std::setw(12) << iter->tokens;
+        m_Result << std::setw(12) << iter->left_activations;
+        m_Result << std::setw(12) << iter->right_activations;
+        m_Result << std::setw(12) << iter->tests;
+        m_Result << std::setw(11) << iter->prod->firing_count;
+        m_Result << std::setprecision(3);
+        m_Result << std::setw(13) << iter->prod->firing_time / raw_per_msec;
+        m_Result << "  " << iter->prod->name->sc->name << "\n";
+    }
+    
+    m_Result << std::resetiosflags(std::ios_base::fixed);
+    m_Result.precision(oldPrecision);
+    
+    return true;
+}
@@ -0,0 +1,92 @@
+/////////////////////////////////////////////////////////////////
+// profile command file.
+//
+// Starts, stops and writes out the kernel's span profiler
+// (see profiler.h).
+//
+/////////////////////////////////////////////////////////////////
+
+#include "portability.h"
+
+#include "sml_Utils.h"
+#include "cli_CommandLineInterface.h"
+
+#include "cli_Commands.h"
+
+#include "profiler.h"
+
+#include <fstream>
+
+using namespace cli;
+
+bool CommandLineInterface::DoProfile(eProfileMode mode, const std::string* pFilename)
+{
+    switch (mode)
+    {
+        case PROFILE_ON:
+            profiler_start();
+            break;
+            
+        case PROFILE_OFF:
+            profiler_stop();
+            break;
+            
+        case PROFILE_CLEAR:
+            profiler_clear();
+            break;
+            
+        case PROFILE_CHROME:
+        case PROFILE_COLLAPSED:
+        {
+            if (!pFilename || pFilename->empty())
+            {
+                return SetError("File name required.");
+            }
+            
+            std::ofstream file(pFilename->c_str());
+            if (!file)
+            {
+                return SetError("Error opening file: " + *pFilename);
+            }
+            
+            if (mode == PROFILE_CHROME)
+            {
+                profiler_write_chrome_trace(file);
+            }
+            else
+            {
+                profiler_write_collapsed_stacks(file);
+            }
+            
+            file.close();
+            if (file.fail())
+            {
+                return SetError("Error writing file: " + *pFilename);
+            }
+        }
+        break;
+        
+        case PROFILE_QUERY:
+        {
+            uint64_t spans = 0;
+            uint64_t overwritten = 0;
+            profiler_get_counts(&spans, &overwritten);
+            
+            m_Result << "Profiler is " << (profiler_enabled ? "on" : "off") << ", holding " << spans << " spans";
+            if (overwritten)
+            {
+                m_Result << " (" << overwritten << " older spans overwritten)";
+            }
+            m_Result << ".";
+            
+            if (spans)
+            {
+                m_Result << "\n\n";
+                profiler_write_summary(m_Result);
+            }
+        }
+        break;
+    }
+    
+    return true;
+}
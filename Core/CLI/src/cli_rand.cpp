@@ -13,6 +13,7 @@
 #include "cli_Commands.h"
 
 #include "sml_Names.h"
+#include "sml_AgentSML.h"
 
 #include "soar_rand.h"
 #include "misc.h"
@@ -22,6 +23,8 @@ using namespace sml;
 
 bool CommandLineInterface::DoRand(bool integer, std::string* bound)
 {
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    
     if (integer)
     {
         uint32_t out;
@@ -33,11 +36,11 @@ bool CommandLineInterface::DoRand(bool integer, std::string* bound)
             {
                 return SetError("Integer expected.");
             }
-            out = SoarRandInt(n);
+            out = SoarRandInt(thisAgent, n);
         }
         else
         {
-            out = SoarRandInt();
+            out = SoarRandInt(thisAgent);
         }
         
         m_Result << out;
@@ -53,11 +56,11 @@ bool CommandLineInterface::DoRand(bool integer, std::string* bound)
             {
                 return SetError("Real number expected.");
             }
-            out = SoarRand(n);
+            out = SoarRand(thisAgent, n);
         }
         else
         {
-            out = SoarRand();
+            out = SoarRand(thisAgent);
         }
         
         m_Result << out;
@@ -38,6 +38,7 @@ bool CommandLineInterface::DoSMem(const char pOp, const std::string* pAttr, cons
         PrintCLIMessage_Item("append:", thisAgent->smem_params->append_db, 40);
         PrintCLIMessage_Item("path:", thisAgent->smem_params->path, 40);
         PrintCLIMessage_Item("lazy-commit:", thisAgent->smem_params->lazy_commit, 40);
+        PrintCLIMessage_Item("shared:", thisAgent->smem_params->shared, 40);
         PrintCLIMessage_Section("Activation", 40);
         PrintCLIMessage_Item("activation-mode:", thisAgent->smem_params->activation_mode, 40);
         PrintCLIMessage_Item("activate-on-query:", thisAgent->smem_params->activate_on_query, 40);
@@ -45,10 +46,15 @@ bool CommandLineInterface::DoSMem(const char pOp, const std::string* pAttr, cons
         PrintCLIMessage_Item("base-update-policy:", thisAgent->smem_params->base_update, 40);
         PrintCLIMessage_Item("base-incremental-threshes:", thisAgent->smem_params->base_incremental_threshes, 40);
         PrintCLIMessage_Item("thresh:", thisAgent->smem_params->thresh, 40);
+        PrintCLIMessage_Item("spreading:", thisAgent->smem_params->spreading, 40);
+        PrintCLIMessage_Item("spreading-depth:", thisAgent->smem_params->spreading_depth, 40);
+        PrintCLIMessage_Item("spreading-limit:", thisAgent->smem_params->spreading_limit, 40);
+        PrintCLIMessage_Item("spreading-budget:", thisAgent->smem_params->spreading_budget, 40);
         PrintCLIMessage_Section("Performance", 40);
         PrintCLIMessage_Item("page-size:", thisAgent->smem_params->page_size, 40);
         PrintCLIMessage_Item("cache-size:", thisAgent->smem_params->cache_size, 40);
         PrintCLIMessage_Item("optimization:", thisAgent->smem_params->opt, 40);
+        PrintCLIMessage_Item("native-store:", thisAgent->smem_params->native_store, 40);
         PrintCLIMessage_Item("timers:", thisAgent->smem_params->timers, 40);
         PrintCLIMessage_Section("Experimental", 40);
         PrintCLIMessage_Item("merge:", thisAgent->smem_params->merge, 40);
@@ -186,6 +192,24 @@ bool CommandLineInterface::DoSMem(const char pOp, const std::string* pAttr, cons
         PrintCLIMessage("Semantic memory system re-initialized.");
         return true;
     }
+    else if (pOp == 'I')
+    {
+        std::string* err = new std::string("");
+        std::string* retrieved = new std::string("");
+        bool result = smem_import_chunks(thisAgent, pAttr->c_str(), &(err), &(retrieved));
+        
+        if (!result)
+        {
+            SetError(*err);
+        }
+        else
+        {
+            PrintCLIMessage(retrieved);
+        }
+        delete err;
+        delete retrieved;
+        return result;
+    }
     else if (pOp == 'p')
     {
         smem_lti_id lti_id = NIL;
@@ -419,6 +443,12 @@ bool CommandLineInterface::DoSMem(const char pOp, const std::string* pAttr, cons
         // vizualizing the store requires an open semantic database
         smem_attach(thisAgent);
         
+        // a shared store's database is only this agent's scratch copy
+        if (thisAgent->smem_overlay && thisAgent->smem_overlay->shared)
+        {
+            return SetError("Semantic memory is shared; visualize its database from an unshared agent instead.");
+        }
+        
         if (pAttr)
         {
             get_lexeme_from_string(thisAgent, pAttr->c_str());
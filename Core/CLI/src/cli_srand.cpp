@@ -13,6 +13,7 @@
 
 #include "cli_Commands.h"
 #include "sml_KernelSML.h"
+#include "sml_AgentSML.h"
 #include "soar_rand.h"
 
 
@@ -21,13 +22,15 @@ using namespace sml;
 
 bool CommandLineInterface::DoSRand(uint32_t* pSeed)
 {
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    
     if (pSeed)
     {
-        SoarSeedRNG(*pSeed);
+        SoarSeedRNG(thisAgent, *pSeed);
     }
     else
     {
-        SoarSeedRNG();
+        SoarSeedRNG(thisAgent);
     }
     
     return true;
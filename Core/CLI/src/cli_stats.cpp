@@ -16,12 +16,17 @@
 #include "sml_Names.h"
 #include "sml_KernelSML.h"
 #include "sml_AgentSML.h"
+#include "sml_RunScheduler.h"
+#include "sml_RunThreads.h"
 
 #include "agent.h"
 #include "stats.h"
 #include "print.h"
 #include "rete.h" // for get_node_count_statistics
 #include "soar_db.h"
+#include "profiler.h" // for profile_span_names
+#include "init_soar.h" // for reset_latency_stats
+#include "perf_counters.h"
 
 extern const char* bnode_type_names[256];
 
@@ -42,6 +47,30 @@ bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
         return true;
     }
     
+    if (options.test(STATS_UTILIZATION))
+    {
+        GetUtilizationStats(options.test(STATS_RESET));
+        return true;
+    }
+    
+    if (options.test(STATS_HISTOGRAM))
+    {
+        GetHistogramStats(options.test(STATS_RESET));
+        return true;
+    }
+    
+    if (options.test(STATS_ACCOUNTING))
+    {
+        GetAccountingStats();
+        return true;
+    }
+    
+    if (options.test(STATS_COUNTERS))
+    {
+        GetCounterStats(options.test(STATS_RESET));
+        return true;
+    }
+    
     if (options.test(STATS_DECISION))
     {
         m_Result << thisAgent->decision_phases_count;
@@ -261,6 +290,166 @@ void CommandLineInterface::GetAgentStats()
     }
 }
 
+void CommandLineInterface::GetUtilizationStats(bool reset)
+{
+    RunScheduler* pScheduler = m_pAgentSML->GetKernelSML()->GetRunScheduler();
+    
+    size_t oldPrecision = m_Result.precision(3);
+    m_Result << std::setiosflags(std::ios_base::fixed);
+    
+    m_Result << "Agent steps:     " << m_pAgentSML->GetStepCount() << "\n";
+    m_Result << "Step time (sec): " << m_pAgentSML->GetStepUSec() / 1000000.0 << "\n";
+    m_Result << "Last step (usec): " << m_pAgentSML->GetLastStepUSec() << "\n";
+    m_Result << "Step cost (usec): " << m_pAgentSML->GetStepCost() << "\n";
+    
+    std::vector<RunThreadStats> threads;
+    uint64_t passes = 0;
+    uint64_t totalUSec = 0;
+    
+    if (!pScheduler->GetRunThreadStats(&threads, &passes, &totalUSec))
+    {
+        m_Result << "\nAgents are run on one thread (see SetRunThreads).\n";
+    }
+    else
+    {
+        m_Result << "\nRun threads: " << threads.size() << ", " << passes << " passes, " << totalUSec / 1000000.0 << " sec\n";
+        m_Result << "Thread Steps       Steals      Busy (sec)  Utilization\n";
+        m_Result << "------ ----------- ----------- ----------- -----------\n";
+        
+        for (size_t i = 0; i < threads.size(); ++i)
+        {
+            double utilization = totalUSec ? 100.0 * threads[i].m_BusyUSec / totalUSec : 0.0;
+            
+            m_Result << std::setw(6) << i << " ";
+            m_Result << std::setw(11) << threads[i].m_Steps << " ";
+            m_Result << std::setw(11) << threads[i].m_Steals << " ";
+            m_Result << std::setw(11) << threads[i].m_BusyUSec / 1000000.0 << " ";
+            m_Result << std::setw(10) << utilization << "%\n";
+        }
+    }
+    
+    m_Result << std::resetiosflags(std::ios_base::fixed);
+    m_Result.precision(oldPrecision);
+    
+    if (reset)
+    {
+        pScheduler->ResetRunStats();
+    }
+}
+
+// One row of the --histogram table
+static void PrintLatencyHistogram(std::ostream& out, const char* name, const soar_latency_histogram& histogram)
+{
+    out << std::setw(16) << std::left << name << std::right << " ";
+    out << std::setw(10) << histogram.get_count() << " ";
+    out << std::setw(10) << histogram.get_mean() << " ";
+    out << std::setw(8) << histogram.get_percentile(50) << " ";
+    out << std::setw(8) << histogram.get_percentile(90) << " ";
+    out << std::setw(8) << histogram.get_percentile(99) << " ";
+    out << std::setw(8) << histogram.get_percentile(99.9) << " ";
+    out << std::setw(10) << histogram.get_max() << "\n";
+}
+
+void CommandLineInterface::GetHistogramStats(bool reset)
+{
+    soar_latency_histogram* pCommandLatency = m_pAgentSML->GetKernelSML()->GetCommandLatency();
+    
+    size_t oldPrecision = m_Result.precision(1);
+    m_Result << std::setiosflags(std::ios_base::fixed);
+    
+    m_Result << "Latency (usec)   Count      Mean       p50      p90      p99      p99.9    Max\n";
+    m_Result << "---------------- ---------- ---------- -------- -------- -------- -------- ----------\n";
+    
+#ifndef NO_TIMING_STUFF
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    
+    PrintLatencyHistogram(m_Result, "decision-cycle", thisAgent->latency_decision_cycle);
+    for (int phase = 0; phase < NUM_PHASE_TYPES; phase++)
+    {
+        PrintLatencyHistogram(m_Result, profile_span_names[phase], thisAgent->latency_phase[phase]);
+    }
+    PrintLatencyHistogram(m_Result, "epmem-query", thisAgent->latency_epmem_query);
+    PrintLatencyHistogram(m_Result, "smem-query", thisAgent->latency_smem_query);
+#endif
+    PrintLatencyHistogram(m_Result, "sml-command", *pCommandLatency);
+    
+    m_Result << std::resetiosflags(std::ios_base::fixed);
+    m_Result.precision(oldPrecision);
+    
+    if (reset)
+    {
+        reset_latency_stats(m_pAgentSML->GetSoarAgent());
+        pCommandLatency->reset();
+    }
+}
+
+#ifndef NO_TIMING_STUFF
+// One row of the --counters table; counters the CPU doesn't have are n/a
+static void PrintPerfCounters(std::ostream& out, const char* name, const perf_counter_accumulator& counts)
+{
+    static const int widths[NUM_PERF_COUNTERS] = { 14, 14, 12, 13 };
+    
+    out << std::setw(16) << std::left << name << std::right << " ";
+    out << std::setw(10) << counts.get_intervals() << " ";
+    
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        if (perf_counter_supported(static_cast<perf_counter_type>(i)))
+        {
+            out << std::setw(widths[i]) << counts.get(static_cast<perf_counter_type>(i)) << " ";
+        }
+        else
+        {
+            out << std::setw(widths[i]) << "n/a" << " ";
+        }
+    }
+    
+    out << std::setw(5) << counts.get_ipc() << "\n";
+}
+#endif
+
+void CommandLineInterface::GetCounterStats(bool reset)
+{
+    std::string reason;
+    if (!perf_counters_available(&reason))
+    {
+        m_Result << "Hardware counters are unavailable: " << reason << "\n";
+        return;
+    }
+    
+#ifndef NO_TIMING_STUFF
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    
+    if (!thisAgent->sysparams[PERF_COUNTERS_ENABLED])
+    {
+        m_Result << "Hardware counters are off (timers --counters turns them on).\n";
+    }
+    
+    size_t oldPrecision = m_Result.precision(2);
+    m_Result << std::setiosflags(std::ios_base::fixed);
+    
+    m_Result << "Counts           Intervals  Cycles         Instructions   Cache-misses Branch-misses IPC\n";
+    m_Result << "---------------- ---------- -------------- -------------- ------------ ------------- -----\n";
+    
+    perf_counter_accumulator total;
+    for (int phase = 0; phase < NUM_PHASE_TYPES; phase++)
+    {
+        PrintPerfCounters(m_Result, profile_span_names[phase], thisAgent->perf_phase[phase]);
+        total.add(thisAgent->perf_phase[phase]);
+    }
+    PrintPerfCounters(m_Result, "total", total);
+    PrintPerfCounters(m_Result, "match", thisAgent->perf_match);
+    
+    m_Result << std::resetiosflags(std::ios_base::fixed);
+    m_Result.precision(oldPrecision);
+    
+    if (reset)
+    {
+        reset_perf_counter_stats(thisAgent);
+    }
+#endif
+}
+
 void CommandLineInterface::GetSystemStats()
 {
     // Hostname
@@ -553,6 +742,36 @@ void CommandLineInterface::GetMemoryStats()
     GetMemoryPoolStatistics();
 }
 
+void CommandLineInterface::GetAccountingStats()
+{
+    mem_usage usage[NUM_MEM_SUBSYSTEMS];
+    get_memory_accounting(m_pAgentSML->GetSoarAgent(), usage);
+    
+    uint64_t smlBytes = m_pAgentSML->GetMemoryUsage();
+    uint64_t totalLive = smlBytes;
+    uint64_t totalReserved = smlBytes;
+    
+    m_Result << "Memory (bytes)   Live         Reserved\n";
+    m_Result << "---------------- ------------ ------------\n";
+    
+    for (int i = 0; i < NUM_MEM_SUBSYSTEMS; i++)
+    {
+        m_Result << std::setw(16) << std::left << mem_subsystem_names[i] << std::right << " ";
+        m_Result << std::setw(12) << usage[i].live << " " << std::setw(12) << usage[i].reserved << "\n";
+        
+        totalLive += usage[i].live;
+        totalReserved += usage[i].reserved;
+    }
+    m_Result << std::setw(16) << std::left << "sml" << std::right << " ";
+    m_Result << std::setw(12) << smlBytes << " " << std::setw(12) << smlBytes << "\n";
+    
+    m_Result << "---------------- ------------ ------------\n";
+    m_Result << std::setw(16) << std::left << "total" << std::right << " ";
+    m_Result << std::setw(12) << totalLive << " " << std::setw(12) << totalReserved << "\n";
+    
+    m_Result << "\nSQLite (all agents): " << get_sqlite_memory_used() << " bytes\n";
+}
+
 void CommandLineInterface::GetMemoryPoolStatistics()
 {
     agent* thisAgent = m_pAgentSML->GetSoarAgent();
@@ -19,18 +19,31 @@
 #include "sml_KernelSML.h"
 #include "gsysparam.h"
 #include "agent.h"
+#include "perf_counters.h"
 
 using namespace cli;
 using namespace sml;
 
-bool CommandLineInterface::DoTimers(bool* pSetting)
+bool CommandLineInterface::DoTimers(bool* pSetting, bool* pCounters)
 {
     agent* thisAgent = m_pAgentSML->GetSoarAgent();
-    if (pSetting)
+    if (pSetting || pCounters)
     {
         // set, don't print
-        set_sysparam(thisAgent, TIMERS_ENABLED, *pSetting);
+        if (pSetting)
+        {
+            set_sysparam(thisAgent, TIMERS_ENABLED, *pSetting);
+        }
         
+        if (pCounters)
+        {
+            std::string reason;
+            if (*pCounters && !perf_counters_available(&reason))
+            {
+                return SetError("Hardware counters are unavailable: " + reason);
+            }
+            set_sysparam(thisAgent, PERF_COUNTERS_ENABLED, *pCounters);
+        }
     }
     else
     {
@@ -49,6 +62,17 @@ bool CommandLineInterface::DoTimers(bool* pSetting)
 #ifdef DETAILED_TIMING_STATS
             m_Result << ", detailed stats are on";
 #endif // DETAILED_TIMING_STATS
+            m_Result << ".\nHardware counters are ";
+            
+            std::string reason;
+            if (!perf_counters_available(&reason))
+            {
+                m_Result << "unavailable (" << reason << ")";
+            }
+            else
+            {
+                m_Result << (thisAgent->sysparams[PERF_COUNTERS_ENABLED] ? "enabled" : "disabled");
+            }
 #endif // NO_TIMING_STUFF
             m_Result << ".";
         }
@@ -57,6 +81,7 @@ bool CommandLineInterface::DoTimers(bool* pSetting)
             // adds <arg name="timers">true</arg> (or false) if the timers are
             // enabled (or disabled)
             AppendArgTagFast(sml_Names::kParamTimers, sml_Names::kTypeBoolean, thisAgent->sysparams[TIMERS_ENABLED] ? sml_Names::kTrue : sml_Names::kFalse);
+            AppendArgTagFast(sml_Names::kParamPerfCounters, sml_Names::kTypeBoolean, thisAgent->sysparams[PERF_COUNTERS_ENABLED] ? sml_Names::kTrue : sml_Names::kFalse);
         }
     }
     return true;
@@ -269,6 +269,42 @@ bool Agent::LoadProductions(char const* pFilename, bool echoResults)
     return ok ;
 }
 
+bool Agent::ImportSMem(char const* pFilename)
+{
+    if (!pFilename)
+    {
+        return false;
+    }
+    
+    // remove quotes or braces if they exist
+    std::string cmd("smem --import {");
+    size_t len = strlen(pFilename);
+    if ((pFilename[0] == '\"' && pFilename[len - 1] == '\"') || (pFilename[0] == '{' && pFilename[len - 1] == '}'))
+    {
+        cmd.append(pFilename + 1, len - 2);
+    }
+    else
+    {
+        cmd.append(pFilename, len);
+    }
+    cmd.push_back('}');
+    
+    char const* pResult = ExecuteCommandLine(cmd.c_str()) ;
+    
+    bool ok = GetLastCommandLineResult() ;
+    
+    if (ok)
+    {
+        ClearError() ;
+    }
+    else
+    {
+        SetDetailedError(Error::kDetailedError, pResult) ;
+    }
+    
+    return ok ;
+}
+
 // These are little utility classes we define to help with searching the event maps
 class Agent::TestRunCallback : public RunEventMap::ValueTest
 {
@@ -1244,6 +1280,14 @@ char const* Agent::RunSelfForever()
 
 bool Agent::WasAgentOnRunList()
 {
+#ifdef SML_DIRECT
+    if (GetConnection()->IsDirectConnection())
+    {
+        EmbeddedConnection* ec = static_cast<EmbeddedConnection*>(GetConnection());
+        return ec->DirectWasAgentOnRunList(GetWM()->m_AgentSMLHandle) ;
+    }
+#endif
+
     AnalyzeXML response ;
     
     bool ok = GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_WasAgentOnRunList, GetAgentName()) ;
@@ -1259,6 +1303,14 @@ bool Agent::WasAgentOnRunList()
 
 smlRunResult Agent::GetResultOfLastRun()
 {
+#ifdef SML_DIRECT
+    if (GetConnection()->IsDirectConnection())
+    {
+        EmbeddedConnection* ec = static_cast<EmbeddedConnection*>(GetConnection());
+        return ec->DirectGetResultOfLastRun(GetWM()->m_AgentSMLHandle) ;
+    }
+#endif
+
     AnalyzeXML response ;
     
     bool ok = GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_GetResultOfLastRun, GetAgentName()) ;
@@ -1321,6 +1373,14 @@ void Agent::Refresh()
 
 smlPhase Agent::GetCurrentPhase()
 {
+#ifdef SML_DIRECT
+    if (GetConnection()->IsDirectConnection())
+    {
+        EmbeddedConnection* ec = static_cast<EmbeddedConnection*>(GetConnection());
+        return ec->DirectGetCurrentPhase(GetWM()->m_AgentSMLHandle) ;
+    }
+#endif
+
     AnalyzeXML response ;
     
     bool ok = GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_GetRunState, GetAgentName(), sml_Names::kParamValue, sml_Names::kParamPhase) ;
@@ -1337,6 +1397,14 @@ smlPhase Agent::GetCurrentPhase()
 
 int Agent::GetDecisionCycleCounter()
 {
+#ifdef SML_DIRECT
+    if (GetConnection()->IsDirectConnection())
+    {
+        EmbeddedConnection* ec = static_cast<EmbeddedConnection*>(GetConnection());
+        return static_cast<int>(ec->DirectGetDecisionCycleCounter(GetWM()->m_AgentSMLHandle)) ;
+    }
+#endif
+
     AnalyzeXML response ;
     
     bool ok = GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_GetRunState, GetAgentName(), sml_Names::kParamValue, sml_Names::kParamDecision) ;
@@ -1351,6 +1419,14 @@ int Agent::GetDecisionCycleCounter()
 
 smlRunState Agent::GetRunState()
 {
+#ifdef SML_DIRECT
+    if (GetConnection()->IsDirectConnection())
+    {
+        EmbeddedConnection* ec = static_cast<EmbeddedConnection*>(GetConnection());
+        return ec->DirectGetRunState(GetWM()->m_AgentSMLHandle) ;
+    }
+#endif
+
     AnalyzeXML response ;
     
     bool ok = GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_GetRunState, GetAgentName(), sml_Names::kParamValue, sml_Names::kParamRunState) ;
@@ -278,6 +278,19 @@ namespace sml
             *************************************************************/
             bool LoadProductions(char const* pFilename, bool echoResults = true) ;
             
+            /*************************************************************
+            * @brief Bulk-load semantic memory from a file (smem --import).
+            *
+            * The file holds either bare concepts in smem --add format or
+            * Soar source containing smem --add commands.  As with
+            * LoadProductions, the kernel must be able to access the file.
+            *
+            * @returns True if the knowledge was imported successfully.
+            *          On failure nothing is imported, and the error is available
+            *          through GetLastErrorDescription.
+            *************************************************************/
+            bool ImportSMem(char const* pFilename) ;
+            
             /*************************************************************
             * @brief Returns the id object for the input link.
             *        The agent retains ownership of this object.
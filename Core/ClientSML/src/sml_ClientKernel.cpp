@@ -789,7 +789,7 @@ int Kernel::GetListenerPort()
     return -1;
 }
 
-Kernel* Kernel::CreateRemoteConnection(bool sharedFileSystem, char const* pIPaddress, int port, bool ignoreOutput)
+Kernel* Kernel::CreateRemoteConnection(bool sharedFileSystem, char const* pIPaddress, int port, bool ignoreOutput, bool sharedMemory)
 {
     ErrorCode errorCode = 0 ;
     
@@ -800,7 +800,7 @@ Kernel* Kernel::CreateRemoteConnection(bool sharedFileSystem, char const* pIPadd
     sock::SocketLib* pLib = new sock::SocketLib() ;
     
     // Connect to the remote socket
-    Connection* pConnection = Connection::CreateRemoteConnection(sharedFileSystem, pIPaddress, port, &errorCode) ;
+    Connection* pConnection = Connection::CreateRemoteConnection(sharedFileSystem, pIPaddress, port, &errorCode, sharedMemory) ;
     
     // Even if pConnection is NULL, we still build a kernel object, so we have
     // a clean way to pass the error code back to the caller.
@@ -1529,6 +1529,14 @@ char const* Kernel::StopAllAgents()
 *************************************************************/
 bool Kernel::IsSoarRunning()
 {
+#ifdef SML_DIRECT
+    if (GetConnection()->IsDirectConnection())
+    {
+        EmbeddedConnection* ec = static_cast<EmbeddedConnection*>(GetConnection());
+        return ec->DirectIsSoarRunning() ;
+    }
+#endif
+
     AnalyzeXML response ;
     
     bool ok = (GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_IsSoarRunning)) ;
@@ -1622,6 +1630,14 @@ bool Kernel::GetLastCommandLineResult()
 *************************************************************/
 bool Kernel::CheckForIncomingCommands()
 {
+#ifdef SML_DIRECT
+    if (GetConnection()->IsDirectConnection())
+    {
+        EmbeddedConnection* ec = static_cast<EmbeddedConnection*>(GetConnection());
+        return ec->DirectCheckForIncomingCommands() ;
+    }
+#endif
+
     AnalyzeXML response ;
     if (GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_CheckForIncomingCommands))
     {
@@ -2407,6 +2423,54 @@ bool Kernel::SetInterruptCheckRate(int newRate)
     return ok ;
 }
 
+/*************************************************************
+* @brief Controls how the kernel sends print and XML trace
+*        events to remote clients (see the header for details).
+*************************************************************/
+bool Kernel::SetEventBatching(int windowMilliseconds, int maxBatchBytes, int maxBacklogBytes)
+{
+    if (windowMilliseconds < 0 || maxBatchBytes < 0 || maxBacklogBytes < 0)
+    {
+        return false ;
+    }
+    
+    AnalyzeXML response ;
+    
+    // Convert the ints to strings
+    std::ostringstream window, batchSize, backlog ;
+    window << windowMilliseconds ;
+    batchSize << maxBatchBytes ;
+    backlog << maxBacklogBytes ;
+    
+    bool ok = GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_SetEventBatching, NULL,
+                                                sml_Names::kParamBatchWindow, window.str().c_str(),
+                                                sml_Names::kParamBatchSize, batchSize.str().c_str(),
+                                                sml_Names::kParamBacklog, backlog.str().c_str()) ;
+                                                
+    return ok ;
+}
+
+/*************************************************************
+* @brief Runs agents on this many threads at once
+*        (see the header for details).
+*************************************************************/
+bool Kernel::SetRunThreads(int threads)
+{
+    if (threads < 0)
+    {
+        return false ;
+    }
+    
+    AnalyzeXML response ;
+    
+    std::ostringstream ostr ;
+    ostr << threads ;
+    
+    bool ok = GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_SetRunThreads, NULL, sml_Names::kParamValue, ostr.str().c_str()) ;
+    
+    return ok ;
+}
+
 /*************************************************************
 * @brief The Soar kernel version is based on sending a request
 *        to the kernel asking for its version and returning the
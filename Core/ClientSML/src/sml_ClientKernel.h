@@ -356,11 +356,13 @@ namespace sml
             *                   If connecting to a local machine with a kernel created using kUseAnyPort, you can pass the PID here to connect to a high-performance
             *                   local connection.
             * @param ignoreOutput Setting this to true means output link changes won't be sent to this client (improving performance if you aren't interested in output)
+            * @param sharedMemory When connecting to the local machine (pIPaddress is NULL), pass messages through shared memory rather than a socket
+            *                   if the kernel supports it.  This is much faster; pass false to always use a socket.
             *
             * @returns A new kernel object which is used to communicate with the kernel
             *          If an error occurs a Kernel object is still returned.  Call "HadError()" and "GetLastErrorDescription()" on it.
             *************************************************************/
-            static Kernel* CreateRemoteConnection(bool sharedFileSystem = true, char const* pIPaddress = 0, int port = kDefaultSMLPort, bool ignoreOutput = false) ;
+            static Kernel* CreateRemoteConnection(bool sharedFileSystem = true, char const* pIPaddress = 0, int port = kDefaultSMLPort, bool ignoreOutput = false, bool sharedMemory = true) ;
             
             /*************************************************************
             * @brief Returns the default port we use for remote connections.
@@ -756,6 +758,48 @@ namespace sml
             *************************************************************/
             bool SetInterruptCheckRate(int newRate) ;
             
+            /*************************************************************
+            * @brief Controls how the kernel sends print and XML trace
+            *        events to remote clients (such as a debugger).
+            *
+            *        Events that arrive within the window are sent together
+            *        as one message (up to maxBatchBytes), from a thread of the
+            *        kernel's own, so the agent doesn't wait for each listener.
+            *        A listener with more than maxBacklogBytes waiting to be
+            *        sent to it has new events dropped (see the dropped-events
+            *        count from get_connection_stats) and is told how much
+            *        print output it missed once it catches up.
+            *
+            *        The defaults are 10 ms, 64 KB and 4 MB.
+            *
+            * @param windowMilliseconds 0 sends every event as it happens, waiting for each listener (no batching)
+            * @param maxBatchBytes      0 sends each event on its own (but still without waiting)
+            * @param maxBacklogBytes    0 never drops events
+            *************************************************************/
+            bool SetEventBatching(int windowMilliseconds, int maxBatchBytes, int maxBacklogBytes) ;
+            
+            /*************************************************************
+            * @brief Runs agents on this many threads at once.
+            *
+            *        By default (0) the agents take turns on the thread
+            *        that runs Soar.  With more threads each agent still runs
+            *        for the same phase or decision at a time (see RunAllAgents
+            *        for the interleave step size) but they all take that step
+            *        together, so independent agents run in parallel.
+            *
+            *        Event handlers and RHS functions are still called on the
+            *        thread that runs Soar, one at a time, but the other agents
+            *        carry on while they run -- so a handler should only work
+            *        with the agent it was called for.  Each agent has its own
+            *        random number generator, so a seeded agent draws the same
+            *        numbers however many threads there are.
+            *
+            *        Can't be changed while Soar is running.
+            *
+            * @param threads 0 or 1 to run every agent on one thread
+            *************************************************************/
+            bool SetRunThreads(int threads) ;
+            
             /*************************************************************
             * @brief Register a handler for a RHS (right hand side) function.
             *        This function can be called in the RHS of a production firing
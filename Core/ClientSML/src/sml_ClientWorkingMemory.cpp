@@ -31,6 +31,7 @@
 #include "sml_ClientIntElement.h"
 #include "sml_ClientFloatElement.h"
 #include "sml_TagWme.h"
+#include "sml_InputBatch.h"
 #include "sml_StringOps.h"
 #include "sml_Errors.h"
 
@@ -1343,15 +1344,23 @@ bool WorkingMemory::Commit()
     ElementXML_Handle hCommand = GetConnection()->AddParameterToSMLCommand(pMsg, sml_Names::kParamAgent, GetAgentName()) ;
     ElementXML command(hCommand) ;
     
-    // Build the list of WME changes
-    for (int i = 0 ; i < deltas ; i++)
+    if (m_DeltaList.IsBatchEnabled())
     {
-        // Get the next change
-        TagWme* pDelta = m_DeltaList.GetDelta(i) ;
+        // All of the changes go as one <wme_batch> tag (see sml_InputBatch.h)
+        command.AddChild(m_DeltaList.GetBatch()->CreateBatchTag()) ;
+    }
+    else
+    {
+        // Build the list of WME changes
+        for (int i = 0 ; i < deltas ; i++)
+        {
+            // Get the next change
+            TagWme* pDelta = m_DeltaList.GetDelta(i) ;
         
-        // Add it as a child of the command tag
-        // (the command takes ownership of the delta)
-        command.AddChild(pDelta) ;
+            // Add it as a child of the command tag
+            // (the command takes ownership of the delta)
+            command.AddChild(pDelta) ;
+        }
     }
     
     // This is important.  We are working with a subpart of pMsg.
@@ -1376,6 +1385,29 @@ bool WorkingMemory::Commit()
     // Clean up
     delete pMsg ;
     
+    if (m_DeltaList.IsBatchEnabled())
+    {
+        // If the kernel didn't get this batch it doesn't know the strings it defined,
+        // so start the handle table again with the next batch.
+        if (!ok)
+        {
+            m_DeltaList.Clear(true) ;
+        }
+    }
+    else if (ok && GetConnection()->IsRemoteConnection())
+    {
+        // Switch to batches once we know the kernel understands them.
+        // (Embedded connections don't gain anything from this, as no strings are sent).
+        soarxml::ElementXML root(response.GetElementXMLHandle()) ;
+        root.AddRefOnHandle() ;
+        
+        char const* pBatch = root.GetAttribute(sml_Names::kInputBatch) ;
+        if (pBatch && IsStringEqual(pBatch, sml_Names::kTrue))
+        {
+            m_DeltaList.EnableBatch() ;
+        }
+    }
+    
     return ok ;
 }
 
@@ -52,6 +52,7 @@ namespace sml
     class EXPORT WorkingMemory
     {
             friend class Identifier;
+            friend class Agent;     // For the agent's handle in the kernel
             
         protected:
         
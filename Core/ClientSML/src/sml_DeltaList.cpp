@@ -17,9 +17,40 @@
 #include "sml_ClientIdentifier.h"
 #include "sml_Connection.h"
 #include "sml_TagWme.h"
+#include "sml_InputBatch.h"
+#include "sml_ClientIntElement.h"
+#include "sml_ClientFloatElement.h"
+#include "sml_StringOps.h"
+#include "sml_Names.h"
 
 using namespace sml ;
 
+DeltaList::~DeltaList()
+{
+    Clear(true) ;
+    delete m_pBatch ;
+}
+
+void DeltaList::EnableBatch()
+{
+    if (!m_pBatch)
+    {
+        m_pBatch = new InputBatchWriter() ;
+    }
+}
+
+int DeltaList::GetSize()
+{
+    int size = (int)m_DeltaList.size() ;
+    
+    if (m_pBatch)
+    {
+        size += m_pBatch->GetSize() ;
+    }
+    
+    return size ;
+}
+
 void DeltaList::RemoveWME(long long timeTag)
 {
 // BADBAD: We should scan the existing list of tags and if we are adding this value
@@ -30,6 +61,12 @@ void DeltaList::RemoveWME(long long timeTag)
 // (Then again, that might be ok as presumably those adds would fail when we
 //  got to the kernel, possibly saving a bunch of time in the matcher).
 
+    if (m_pBatch)
+    {
+        m_pBatch->RemoveWME(timeTag) ;
+        return ;
+    }
+
     // Create the wme tag
     TagWme* pTag = new TagWme() ;
     
@@ -42,6 +79,36 @@ void DeltaList::RemoveWME(long long timeTag)
 
 void DeltaList::AddWME(WMElement* pWME)
 {
+    if (m_pBatch)
+    {
+        char const* pID = pWME->GetIdentifier()->GetIdentifierSymbol() ;
+        char const* pType = pWME->GetValueType() ;
+        
+        if (IsStringEqual(pType, sml_Names::kTypeInt))
+        {
+            m_pBatch->AddIntWME(pID, pWME->GetAttribute(), pWME->ConvertToIntElement()->GetValue(), pWME->GetTimeTag()) ;
+        }
+        else if (IsStringEqual(pType, sml_Names::kTypeDouble))
+        {
+            m_pBatch->AddDoubleWME(pID, pWME->GetAttribute(), pWME->ConvertToFloatElement()->GetValue(), pWME->GetTimeTag()) ;
+        }
+        else
+        {
+            std::string temp ;
+            char const* pValue = pWME->GetValueAsString(temp) ;
+            
+            if (IsStringEqual(pType, sml_Names::kTypeID))
+            {
+                m_pBatch->AddIdWME(pID, pWME->GetAttribute(), pValue, pWME->GetTimeTag()) ;
+            }
+            else
+            {
+                m_pBatch->AddStringWME(pID, pWME->GetAttribute(), pValue, pWME->GetTimeTag()) ;
+            }
+        }
+        return ;
+    }
+    
     // Create the wme tag
     TagWme* pTag = new TagWme() ;
     
@@ -69,6 +136,11 @@ void DeltaList::Clear(bool deleteContents)
             TagWme* pDelta = m_DeltaList[i] ;
             delete pDelta ;
         }
+        
+        if (m_pBatch)
+        {
+            m_pBatch->Clear() ;
+        }
     }
     
     m_DeltaList.clear() ;
@@ -21,18 +21,35 @@ namespace sml
 
     class WMElement ;
     class TagWme ;
+    class InputBatchWriter ;
     
     class EXPORT DeltaList
     {
         protected:
             std::vector<TagWme*>        m_DeltaList ;
             
+            // Once the kernel has said it accepts batched input (see sml_InputBatch.h)
+            // changes are recorded here instead of as TagWme's.
+            InputBatchWriter*           m_pBatch ;
+            
         public:
-            DeltaList() { }
+            DeltaList()
+            {
+                m_pBatch = NULL ;
+            }
+            
+            ~DeltaList() ;
+            
+            // Record later changes in a batch rather than a list of tags
+            void EnableBatch() ;
             
-            ~DeltaList()
+            bool IsBatchEnabled()
             {
-                Clear(true) ;
+                return m_pBatch != NULL ;
+            }
+            InputBatchWriter* GetBatch()
+            {
+                return m_pBatch ;
             }
             
             // We make deleting the contents optional as
@@ -53,10 +70,7 @@ namespace sml
                 AddWME(pWME) ;
             }
             
-            int GetSize()
-            {
-                return (int)m_DeltaList.size() ;
-            }
+            int GetSize() ;
             TagWme* GetDelta(int i)
             {
                 return m_DeltaList[i] ;
@@ -1,11 +1,14 @@
 #include "src/sml_AnalyzeXML.cpp"
 #include "src/sml_ArgMap.cpp"
+#include "src/sml_BinarySML.cpp"
 #include "src/sml_Connection.cpp"
 #include "src/sml_EmbeddedConnection.cpp"
 #include "src/sml_EmbeddedConnectionAsynch.cpp"
 #include "src/sml_EmbeddedConnectionSynch.cpp"
 #include "src/sml_Events.cpp"
 #include "src/sml_EventThread.cpp"
+#include "src/sml_InputBatch.cpp"
+#include "src/sml_MessageQueue.cpp"
 #include "src/sml_MessageSML.cpp"
 #include "src/sml_Names.cpp"
 #include "src/sml_RemoteConnection.cpp"
@@ -25,6 +28,8 @@
 #include "src/sock_ListenerSocket.cpp"
 #include "src/sock_NamedPipe.cpp"
 #include "src/sock_OSspecific.cpp"
+#include "src/sock_Reactor.cpp"
+#include "src/sock_SharedMemory.cpp"
 #include "src/sock_Socket.cpp"
 #include "src/sock_SocketLib.cpp"
 #include "src/thread_Event.cpp"
@@ -0,0 +1,1008 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// BinarySML class
+//
+// A compact binary encoding for SML messages sent over a remote connection.
+// See sml_BinarySML.h for a description of the format.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "sml_BinarySML.h"
+#include "sml_Names.h"
+#include "ElementXML.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace sml ;
+using namespace soarxml ;
+
+// Value kinds (the byte in front of each attribute value)
+#define BINARY_SML_VALUE_STRING     0
+#define BINARY_SML_VALUE_INTERNED   1
+#define BINARY_SML_VALUE_INT        2
+#define BINARY_SML_VALUE_DOUBLE     3
+
+// Element flags
+#define BINARY_SML_FLAG_COMMENT     0x01
+#define BINARY_SML_FLAG_DATA        0x02
+#define BINARY_SML_FLAG_BINARY      0x04
+#define BINARY_SML_FLAG_CDATA       0x08
+
+// Nesting deeper than this is treated as a corrupt message rather than risking the stack.
+#define BINARY_SML_MAX_DEPTH        1024
+
+// The interned name table.  The position of each name is part of the wire format,
+// so new names must be appended at the end (and the version strings, which differ
+// between releases, must never be included).
+static char const* const* const kBinarySMLNames[] =
+{
+    &sml_Names::kTagSML,
+    &sml_Names::kID,
+    &sml_Names::kAck,
+    &sml_Names::kDocType,
+    &sml_Names::kDocType_Call,
+    &sml_Names::kDocType_Response,
+    &sml_Names::kDocType_Notify,
+    &sml_Names::kSMLVersion,
+    &sml_Names::kOutputLinkName,
+    &sml_Names::kEncoding,
+    &sml_Names::kEncodingBinary,
+    &sml_Names::kTagCommand,
+    &sml_Names::kCommandName,
+    &sml_Names::kCommandOutput,
+    &sml_Names::kRawOutput,
+    &sml_Names::kStructuredOutput,
+    &sml_Names::kTagConnection,
+    &sml_Names::kConnectionId,
+    &sml_Names::kConnectionName,
+    &sml_Names::kConnectionStatus,
+    &sml_Names::kAgentStatus,
+    &sml_Names::kStatusCreated,
+    &sml_Names::kStatusNotReady,
+    &sml_Names::kStatusReady,
+    &sml_Names::kStatusClosing,
+    &sml_Names::kTagArg,
+    &sml_Names::kArgParam,
+    &sml_Names::kArgType,
+    &sml_Names::kTagError,
+    &sml_Names::kErrorCode,
+    &sml_Names::kTagName,
+    &sml_Names::kTagResult,
+    &sml_Names::kValueDelta,
+    &sml_Names::kValueFull,
+    &sml_Names::kTagRHS_write,
+    &sml_Names::kRHS_String,
+    &sml_Names::kTagTrace,
+    &sml_Names::kTagState,
+    &sml_Names::kTagOperator,
+    &sml_Names::kState_ID,
+    &sml_Names::kState_Name,
+    &sml_Names::kState_DecisionCycleCt,
+    &sml_Names::kState_ImpasseObject,
+    &sml_Names::kState_ImpasseType,
+    &sml_Names::kState_StackLevel,
+    &sml_Names::kOperator_ID,
+    &sml_Names::kOperator_Name,
+    &sml_Names::kOperator_DecisionCycleCt,
+    &sml_Names::kOperator_StackLevel,
+    &sml_Names::kTagPhase,
+    &sml_Names::kPhase_Name,
+    &sml_Names::kPhase_Status,
+    &sml_Names::kPhase_FiringType,
+    &sml_Names::kPhase_LevelNum,
+    &sml_Names::kPhaseName_Input,
+    &sml_Names::kPhaseName_Pref,
+    &sml_Names::kPhaseName_WM,
+    &sml_Names::kPhaseName_Decision,
+    &sml_Names::kPhaseName_Output,
+    &sml_Names::kPhaseName_Propose,
+    &sml_Names::kPhaseName_Apply,
+    &sml_Names::kPhaseName_Unknown,
+    &sml_Names::kPhaseStatus_Begin,
+    &sml_Names::kPhaseStatus_End,
+    &sml_Names::kPhaseFiringType_IE,
+    &sml_Names::kPhaseFiringType_PE,
+    &sml_Names::kTagSubphase,
+    &sml_Names::kSubphaseName_FiringProductions,
+    &sml_Names::kSubphaseName_ChangingWorkingMemory,
+    &sml_Names::kTagProduction,
+    &sml_Names::kProduction_Name,
+    &sml_Names::kTagProduction_Firing,
+    &sml_Names::kTagProduction_Retracting,
+    &sml_Names::kTagWME,
+    &sml_Names::kWME_TimeTag,
+    &sml_Names::kWME_Id,
+    &sml_Names::kWME_Attribute,
+    &sml_Names::kWME_Value,
+    &sml_Names::kWME_ValueType,
+    &sml_Names::kWME_AttributeType,
+    &sml_Names::kWME_Preference,
+    &sml_Names::kWME_Action,
+    &sml_Names::kValueAdd,
+    &sml_Names::kValueRemove,
+    &sml_Names::kTagWMERemove,
+    &sml_Names::kTagWMEAdd,
+    &sml_Names::kTagPreference,
+    &sml_Names::kPreference_Type,
+    &sml_Names::kOSupported,
+    &sml_Names::kReferent,
+    &sml_Names::kTagWarning,
+    &sml_Names::kFunctionBeginTag,
+    &sml_Names::kFunctionEndTag,
+    &sml_Names::kFunctionAddAttribute,
+    &sml_Names::kTagLearning,
+    &sml_Names::kTagFilter,
+    &sml_Names::kFilterCommand,
+    &sml_Names::kFilterError,
+    &sml_Names::kFilterOutput,
+    &sml_Names::kFilterName,
+    &sml_Names::kParamNoFiltering,
+    &sml_Names::kTagConditions,
+    &sml_Names::kTagConjunctive_Negation_Condition,
+    &sml_Names::kTagCondition,
+    &sml_Names::kTagActions,
+    &sml_Names::kTagAction,
+    &sml_Names::kProductionDocumentation,
+    &sml_Names::kProductionType,
+    &sml_Names::kProductionTypeDefault,
+    &sml_Names::kProductionTypeChunk,
+    &sml_Names::kProductionTypeJustification,
+    &sml_Names::kProductionDeclaredSupport,
+    &sml_Names::kProductionDeclaredOSupport,
+    &sml_Names::kProductionDeclaredISupport,
+    &sml_Names::kConditionId,
+    &sml_Names::kConditionTest,
+    &sml_Names::kConditionTestState,
+    &sml_Names::kConditionTestImpasse,
+    &sml_Names::kCondition,
+    &sml_Names::kAction,
+    &sml_Names::kActionFunction,
+    &sml_Names::kActionId,
+    &sml_Names::kTagBacktrace,
+    &sml_Names::kTagGrounds,
+    &sml_Names::kTagPotentials,
+    &sml_Names::kTagLocals,
+    &sml_Names::kTagLocal,
+    &sml_Names::kTagBacktraceResult,
+    &sml_Names::kTagCDPSPreference,
+    &sml_Names::kTagAddToPotentials,
+    &sml_Names::kTagNegated,
+    &sml_Names::kTagNots,
+    &sml_Names::kTagNot,
+    &sml_Names::kTagGroundedPotentials,
+    &sml_Names::kTagUngroundedPotentials,
+    &sml_Names::kTagUngroundedPotential,
+    &sml_Names::kBacktracedAlready,
+    &sml_Names::kBacktraceSymbol1,
+    &sml_Names::kBacktraceSymbol2,
+    &sml_Names::kTagLocalNegation,
+    &sml_Names::kTagCandidate,
+    &sml_Names::kCandidateName,
+    &sml_Names::kCandidateType,
+    &sml_Names::kCandidateTypeSum,
+    &sml_Names::kCandidateTypeAvg,
+    &sml_Names::kCandidateValue,
+    &sml_Names::kCandidateExpValue,
+    &sml_Names::kTagVerbose,
+    &sml_Names::kTagMessage,
+    &sml_Names::kTagActionSideMarker,
+    &sml_Names::kTypeString,
+    &sml_Names::kTypeInt,
+    &sml_Names::kTypeDouble,
+    &sml_Names::kTypeChar,
+    &sml_Names::kTypeBoolean,
+    &sml_Names::kTypeID,
+    &sml_Names::kTypeVariable,
+    &sml_Names::kParamAgent,
+    &sml_Names::kParamKernel,
+    &sml_Names::kParamThis,
+    &sml_Names::kParamName,
+    &sml_Names::kParamFilename,
+    &sml_Names::kParamLearning,
+    &sml_Names::kParamOSupportMode,
+    &sml_Names::kParamValue,
+    &sml_Names::kParamWme,
+    &sml_Names::kParamWmeObject,
+    &sml_Names::kParamAttribute,
+    &sml_Names::kParamCount,
+    &sml_Names::kParamLength,
+    &sml_Names::kParamThread,
+    &sml_Names::kParamProcess,
+    &sml_Names::kParamLine,
+    &sml_Names::kParamEcho,
+    &sml_Names::kParamLocation,
+    &sml_Names::kParamLogLocation,
+    &sml_Names::kParamLogLevel,
+    &sml_Names::kParamInputProducer,
+    &sml_Names::kParamOutputProcessor,
+    &sml_Names::kParamWorkingMemory,
+    &sml_Names::kParamAttributePath,
+    &sml_Names::kParamUpdate,
+    &sml_Names::kParamEventID,
+    &sml_Names::kParamLearnSetting,
+    &sml_Names::kParamLearnOnlySetting,
+    &sml_Names::kParamLearnExceptSetting,
+    &sml_Names::kParamLearnAllLevelsSetting,
+    &sml_Names::kParamLearnForceLearnStates,
+    &sml_Names::kParamLearnDontLearnStates,
+    &sml_Names::kParamLogSetting,
+    &sml_Names::kParamDirectory,
+    &sml_Names::kParamProcSeconds,
+    &sml_Names::kParamRealSeconds,
+    &sml_Names::kParamWarningsSetting,
+    &sml_Names::kParamPhase,
+    &sml_Names::kParamDecision,
+    &sml_Names::kParamRunState,
+    &sml_Names::kParamInstance,
+    &sml_Names::kParamTimers,
+    &sml_Names::kParamMessage,
+    &sml_Names::kParamSelf,
+    &sml_Names::kParamAlias,
+    &sml_Names::kParamAliasedCommand,
+    &sml_Names::kParamIndifferentSelectionMode,
+    &sml_Names::kParamNumericIndifferentMode,
+    &sml_Names::kParamRunResult,
+    &sml_Names::kParamVersionMajor,
+    &sml_Names::kParamVersionMinor,
+    &sml_Names::kParamVersionMicro,
+    &sml_Names::kParamBuildDate,
+    &sml_Names::kParamWaitSNC,
+    &sml_Names::kParamFunction,
+    &sml_Names::kParamChunkNamePrefix,
+    &sml_Names::kParamChunkCount,
+    &sml_Names::kParamChunkLongFormat,
+    &sml_Names::kParamPort,
+    &sml_Names::kParamSourcedProductionCount,
+    &sml_Names::kParamExcisedProductionCount,
+    &sml_Names::kParamIgnoredProductionCount,
+    &sml_Names::kParamStatsProductionCountDefault,
+    &sml_Names::kParamStatsProductionCountUser,
+    &sml_Names::kParamStatsProductionCountChunk,
+    &sml_Names::kParamStatsProductionCountJustification,
+    &sml_Names::kParamStatsCycleCountDecision,
+    &sml_Names::kParamStatsCycleCountElaboration,
+    &sml_Names::kParamStatsCycleCountInnerElaboration,
+    &sml_Names::kParamStatsProductionFiringCount,
+    &sml_Names::kParamStatsWmeCountAddition,
+    &sml_Names::kParamStatsWmeCountRemoval,
+    &sml_Names::kParamStatsWmeCount,
+    &sml_Names::kParamStatsWmeCountAverage,
+    &sml_Names::kParamStatsWmeCountMax,
+    &sml_Names::kParamStatsKernelCPUTime,
+    &sml_Names::kParamStatsTotalCPUTime,
+    &sml_Names::kParamStatsPhaseTimeInputPhase,
+    &sml_Names::kParamStatsPhaseTimeProposePhase,
+    &sml_Names::kParamStatsPhaseTimeDecisionPhase,
+    &sml_Names::kParamStatsPhaseTimeApplyPhase,
+    &sml_Names::kParamStatsPhaseTimeOutputPhase,
+    &sml_Names::kParamStatsPhaseTimePreferencePhase,
+    &sml_Names::kParamStatsPhaseTimeWorkingMemoryPhase,
+    &sml_Names::kParamStatsMonitorTimeInputPhase,
+    &sml_Names::kParamStatsMonitorTimeProposePhase,
+    &sml_Names::kParamStatsMonitorTimeDecisionPhase,
+    &sml_Names::kParamStatsMonitorTimeApplyPhase,
+    &sml_Names::kParamStatsMonitorTimeOutputPhase,
+    &sml_Names::kParamStatsMonitorTimePreferencePhase,
+    &sml_Names::kParamStatsMonitorTimeWorkingMemoryPhase,
+    &sml_Names::kParamStatsInputFunctionTime,
+    &sml_Names::kParamStatsOutputFunctionTime,
+    &sml_Names::kParamStatsMatchTimeInputPhase,
+    &sml_Names::kParamStatsMatchTimePreferencePhase,
+    &sml_Names::kParamStatsMatchTimeWorkingMemoryPhase,
+    &sml_Names::kParamStatsMatchTimeOutputPhase,
+    &sml_Names::kParamStatsMatchTimeDecisionPhase,
+    &sml_Names::kParamStatsMatchTimeProposePhase,
+    &sml_Names::kParamStatsMatchTimeApplyPhase,
+    &sml_Names::kParamStatsOwnershipTimeInputPhase,
+    &sml_Names::kParamStatsOwnershipTimePreferencePhase,
+    &sml_Names::kParamStatsOwnershipTimeWorkingMemoryPhase,
+    &sml_Names::kParamStatsOwnershipTimeOutputPhase,
+    &sml_Names::kParamStatsOwnershipTimeDecisionPhase,
+    &sml_Names::kParamStatsOwnershipTimeProposePhase,
+    &sml_Names::kParamStatsOwnershipTimeApplyPhase,
+    &sml_Names::kParamStatsChunkingTimeInputPhase,
+    &sml_Names::kParamStatsChunkingTimePreferencePhase,
+    &sml_Names::kParamStatsChunkingTimeWorkingMemoryPhase,
+    &sml_Names::kParamStatsChunkingTimeOutputPhase,
+    &sml_Names::kParamStatsChunkingTimeDecisionPhase,
+    &sml_Names::kParamStatsChunkingTimeProposePhase,
+    &sml_Names::kParamStatsChunkingTimeApplyPhase,
+    &sml_Names::kParamStatsGDSTimeInputPhase,
+    &sml_Names::kParamStatsGDSTimePreferencePhase,
+    &sml_Names::kParamStatsGDSTimeWorkingMemoryPhase,
+    &sml_Names::kParamStatsGDSTimeOutputPhase,
+    &sml_Names::kParamStatsGDSTimeDecisionPhase,
+    &sml_Names::kParamStatsGDSTimeProposePhase,
+    &sml_Names::kParamStatsGDSTimeApplyPhase,
+    &sml_Names::kParamStatsMemoryUsageMiscellaneous,
+    &sml_Names::kParamStatsMemoryUsageHash,
+    &sml_Names::kParamStatsMemoryUsageString,
+    &sml_Names::kParamStatsMemoryUsagePool,
+    &sml_Names::kParamStatsMemoryUsageStatsOverhead,
+    &sml_Names::kParamStatsMaxDecisionCycleTimeValueSec,
+    &sml_Names::kParamStatsMaxDecisionCycleTimeValueUSec,
+    &sml_Names::kParamStatsMaxDecisionCycleTimeCycle,
+    &sml_Names::kParamStatsMaxDecisionCycleEpMemTimeCycle,
+    &sml_Names::kParamStatsMaxDecisionCycleEpMemTimeValueSec,
+    &sml_Names::kParamStatsMaxDecisionCycleSMemTimeCycle,
+    &sml_Names::kParamStatsMaxDecisionCycleSMemTimeValueSec,
+    &sml_Names::kParamStatsMaxDecisionCycleWMChangesCycle,
+    &sml_Names::kParamStatsMaxDecisionCycleWMChangesValue,
+    &sml_Names::kParamStatsMaxDecisionCycleFireCountCycle,
+    &sml_Names::kParamStatsMaxDecisionCycleFireCountValue,
+    &sml_Names::kParamWatchDecisions,
+    &sml_Names::kParamWatchPhases,
+    &sml_Names::kParamWatchProductionDefault,
+    &sml_Names::kParamWatchProductionUser,
+    &sml_Names::kParamWatchProductionChunks,
+    &sml_Names::kParamWatchProductionJustifications,
+    &sml_Names::kParamWatchProductionTemplates,
+    &sml_Names::kParamWatchWMEDetail,
+    &sml_Names::kParamWatchWorkingMemoryChanges,
+    &sml_Names::kParamWatchPreferences,
+    &sml_Names::kParamWatchLearning,
+    &sml_Names::kParamWatchBacktracing,
+    &sml_Names::kParamWatchIndifferentSelection,
+    &sml_Names::kParamWatchRL,
+    &sml_Names::kParamWatchWaterfall,
+    &sml_Names::kParamWatchEpMem,
+    &sml_Names::kParamWatchSMem,
+    &sml_Names::kParamWatchWMA,
+    &sml_Names::kParamWatchGDS,
+    &sml_Names::kTrue,
+    &sml_Names::kFalse,
+    &sml_Names::kCommand_CreateAgent,
+    &sml_Names::kCommand_DestroyAgent,
+    &sml_Names::kCommand_GetAgentList,
+    &sml_Names::kCommand_GetInputLink,
+    &sml_Names::kCommand_GetOutputLink,
+    &sml_Names::kCommand_Run,
+    &sml_Names::kCommand_Input,
+    &sml_Names::kCommand_Output,
+    &sml_Names::kCommand_StopOnOutput,
+    &sml_Names::kCommand_RegisterForEvent,
+    &sml_Names::kCommand_UnregisterForEvent,
+    &sml_Names::kCommand_Event,
+    &sml_Names::kCommand_FireEvent,
+    &sml_Names::kCommand_SuppressEvent,
+    &sml_Names::kCommand_CheckForIncomingCommands,
+    &sml_Names::kCommand_SetInterruptCheckRate,
+    &sml_Names::kCommand_Shutdown,
+    &sml_Names::kCommand_GetVersion,
+    &sml_Names::kCommand_IsSoarRunning,
+    &sml_Names::kCommand_GetConnections,
+    &sml_Names::kCommand_SetConnectionInfo,
+    &sml_Names::kCommand_GetAllInput,
+    &sml_Names::kCommand_GetAllOutput,
+    &sml_Names::kCommand_GetRunState,
+    &sml_Names::kCommand_IsProductionLoaded,
+    &sml_Names::kCommand_SendClientMessage,
+    &sml_Names::kCommand_WasAgentOnRunList,
+    &sml_Names::kCommand_GetResultOfLastRun,
+    &sml_Names::kCommand_GetInitialTimeTag,
+    &sml_Names::kCommand_OutputInit,
+    &sml_Names::kCommand_ConvertIdentifier,
+    &sml_Names::kCommand_GetListenerPort,
+    &sml_Names::kCommand_CommandLine,
+    &sml_Names::kCommand_SVSInput,
+    &sml_Names::kCommand_SVSOutput,
+    &sml_Names::kCommand_SVSQuery,
+} ;
+
+static const int kBinarySMLNumberNames = static_cast<int>(sizeof(kBinarySMLNames) / sizeof(kBinarySMLNames[0])) ;
+
+/*************************************************************
+* @brief Sorted (name, index) pairs so the encoder can look up
+*        a name's index with a binary search.
+*
+*        Built once during static initialization (the sml_Names
+*        constants are string literals so they are already set).
+*************************************************************/
+class BinarySMLNameIndex
+{
+    public:
+        typedef std::pair<char const*, int> NameEntry ;
+        
+        struct NameLess
+        {
+            bool operator()(NameEntry const& a, NameEntry const& b) const
+            {
+                return strcmp(a.first, b.first) < 0 ;
+            }
+        } ;
+        
+        std::vector<NameEntry> m_Entries ;
+        
+        BinarySMLNameIndex()
+        {
+            m_Entries.reserve(kBinarySMLNumberNames) ;
+            for (int i = 0 ; i < kBinarySMLNumberNames ; i++)
+            {
+                m_Entries.push_back(NameEntry(*kBinarySMLNames[i], i)) ;
+            }
+            
+            // Stable so that duplicate strings (e.g. "id") always encode as the first entry
+            std::stable_sort(m_Entries.begin(), m_Entries.end(), NameLess()) ;
+        }
+} ;
+
+static BinarySMLNameIndex s_BinarySMLNameIndex ;
+
+int BinarySML::GetNumberInternedNames()
+{
+    return kBinarySMLNumberNames ;
+}
+
+/*************************************************************
+* @brief Returns the index of the name in the interned table
+*        or -1 if it is not there.
+*************************************************************/
+int BinarySML::FindInternedName(char const* pName)
+{
+    BinarySMLNameIndex::NameEntry key(pName, 0) ;
+    
+    std::vector<BinarySMLNameIndex::NameEntry>::const_iterator iter =
+        std::lower_bound(s_BinarySMLNameIndex.m_Entries.begin(), s_BinarySMLNameIndex.m_Entries.end(), key, BinarySMLNameIndex::NameLess()) ;
+        
+    if (iter == s_BinarySMLNameIndex.m_Entries.end() || strcmp(iter->first, pName) != 0)
+    {
+        return -1 ;
+    }
+    
+    return iter->second ;
+}
+
+////////////////////////////////////////////////////////////////
+//
+// Encoding
+//
+////////////////////////////////////////////////////////////////
+
+void BinarySML::Encode(ElementXML const* pMsg, std::string* pBuffer)
+{
+    pBuffer->clear() ;
+    pBuffer->push_back(static_cast<char>(kMagic)) ;
+    pBuffer->push_back(static_cast<char>(kVersion)) ;
+    
+    EncodeElement(pMsg->GetXMLHandle(), pBuffer) ;
+}
+
+void BinarySML::EncodeVarint(uint64_t value, std::string* pBuffer)
+{
+    while (value >= 0x80)
+    {
+        pBuffer->push_back(static_cast<char>((value & 0x7F) | 0x80)) ;
+        value >>= 7 ;
+    }
+    pBuffer->push_back(static_cast<char>(value)) ;
+}
+
+void BinarySML::EncodeString(char const* pStr, size_t length, std::string* pBuffer)
+{
+    EncodeVarint(length, pBuffer) ;
+    pBuffer->append(pStr, length) ;
+}
+
+void BinarySML::EncodeName(char const* pName, std::string* pBuffer)
+{
+    int index = FindInternedName(pName) ;
+    
+    if (index >= 0)
+    {
+        EncodeVarint(index + 1, pBuffer) ;
+    }
+    else
+    {
+        EncodeVarint(0, pBuffer) ;
+        EncodeString(pName, strlen(pName), pBuffer) ;
+    }
+}
+
+/*************************************************************
+* @brief Returns true (and the value) if the string is an integer
+*        written the way we would write it back out again
+*        (no '+', no leading zeros, no "-0").
+*************************************************************/
+static bool BinarySMLIsCanonicalInt(char const* pStr, int64_t* pValue)
+{
+    char const* p = pStr ;
+    bool negative = (*p == '-') ;
+    
+    if (negative)
+    {
+        p++ ;
+    }
+    
+    // Limiting the digits keeps us well clear of overflow
+    size_t digits = strlen(p) ;
+    if (digits == 0 || digits > 18 || (p[0] == '0' && (digits > 1 || negative)))
+    {
+        return false ;
+    }
+    
+    int64_t value = 0 ;
+    for (; *p != 0 ; p++)
+    {
+        if (*p < '0' || *p > '9')
+        {
+            return false ;
+        }
+        value = value * 10 + (*p - '0') ;
+    }
+    
+    *pValue = negative ? -value : value ;
+    return true ;
+}
+
+/*************************************************************
+* @brief Returns true (and the value) if the string is a double
+*        that is written exactly the way the decoder will write
+*        it back out again.
+*************************************************************/
+static bool BinarySMLIsCanonicalDouble(char const* pStr, double* pValue)
+{
+    if (!strchr(pStr, '.') && !strchr(pStr, 'e'))
+    {
+        return false ;
+    }
+    
+    char* pEnd = NULL ;
+    double value = strtod(pStr, &pEnd) ;
+    
+    if (pEnd == pStr || *pEnd != 0)
+    {
+        return false ;
+    }
+    
+    char buffer[64] ;
+    SNPRINTF(buffer, sizeof(buffer), "%.16g", value) ;
+    buffer[sizeof(buffer) - 1] = 0 ;
+    
+    if (strcmp(buffer, pStr) != 0)
+    {
+        return false ;
+    }
+    
+    *pValue = value ;
+    return true ;
+}
+
+void BinarySML::EncodeValue(char const* pName, char const* pValue, std::string* pBuffer)
+{
+    int64_t intValue = 0 ;
+    double doubleValue = 0 ;
+    
+    if (BinarySMLIsCanonicalInt(pValue, &intValue))
+    {
+        // Zigzag so small negative numbers (e.g. client time tags) stay small too
+        pBuffer->push_back(BINARY_SML_VALUE_INT) ;
+        EncodeVarint((static_cast<uint64_t>(intValue) << 1) ^ static_cast<uint64_t>(intValue >> 63), pBuffer) ;
+        return ;
+    }
+    
+    int index = FindInternedName(pValue) ;
+    if (index >= 0)
+    {
+        pBuffer->push_back(BINARY_SML_VALUE_INTERNED) ;
+        EncodeVarint(index + 1, pBuffer) ;
+        return ;
+    }
+    
+    // Only WME values are worth checking for doubles
+    if (strcmp(pName, sml_Names::kWME_Value) == 0 && BinarySMLIsCanonicalDouble(pValue, &doubleValue))
+    {
+        uint64_t bits = 0 ;
+        memcpy(&bits, &doubleValue, sizeof(bits)) ;
+        
+        pBuffer->push_back(BINARY_SML_VALUE_DOUBLE) ;
+        for (int shift = 56 ; shift >= 0 ; shift -= 8)
+        {
+            pBuffer->push_back(static_cast<char>((bits >> shift) & 0xFF)) ;
+        }
+        return ;
+    }
+    
+    pBuffer->push_back(BINARY_SML_VALUE_STRING) ;
+    EncodeString(pValue, strlen(pValue), pBuffer) ;
+}
+
+void BinarySML::EncodeElement(ElementXML_Handle hXML, std::string* pBuffer)
+{
+    char const* pTag = ::soarxml_GetTagName(hXML) ;
+    EncodeName(pTag ? pTag : "", pBuffer) ;
+    
+    char const* pComment = ::soarxml_GetComment(hXML) ;
+    char const* pData = ::soarxml_GetCharacterData(hXML) ;
+    bool binary = ::soarxml_IsCharacterDataBinary(hXML) ;
+    
+    unsigned char flags = 0 ;
+    if (pComment && *pComment)
+    {
+        flags |= BINARY_SML_FLAG_COMMENT ;
+    }
+    if (pData && (binary || *pData))
+    {
+        flags |= BINARY_SML_FLAG_DATA ;
+    }
+    if (binary)
+    {
+        flags |= BINARY_SML_FLAG_BINARY ;
+    }
+    if (::soarxml_GetUseCData(hXML))
+    {
+        flags |= BINARY_SML_FLAG_CDATA ;
+    }
+    pBuffer->push_back(static_cast<char>(flags)) ;
+    
+    if (flags & BINARY_SML_FLAG_COMMENT)
+    {
+        EncodeString(pComment, strlen(pComment), pBuffer) ;
+    }
+    
+    int numberAttributes = ::soarxml_GetNumberAttributes(hXML) ;
+    EncodeVarint(numberAttributes, pBuffer) ;
+    
+    for (int i = 0 ; i < numberAttributes ; i++)
+    {
+        char const* pName = ::soarxml_GetAttributeName(hXML, i) ;
+        EncodeName(pName, pBuffer) ;
+        EncodeValue(pName, ::soarxml_GetAttributeValue(hXML, i), pBuffer) ;
+    }
+    
+    if (flags & BINARY_SML_FLAG_DATA)
+    {
+        size_t length = binary ? ::soarxml_GetCharacterDataLength(hXML) : strlen(pData) ;
+        EncodeString(pData, length, pBuffer) ;
+    }
+    
+    int numberChildren = ::soarxml_GetNumberChildren(hXML) ;
+    EncodeVarint(numberChildren, pBuffer) ;
+    
+    for (int i = 0 ; i < numberChildren ; i++)
+    {
+        EncodeElement(::soarxml_GetChild(hXML, i), pBuffer) ;
+    }
+}
+
+////////////////////////////////////////////////////////////////
+//
+// Decoding
+//
+////////////////////////////////////////////////////////////////
+
+ElementXML* BinarySML::Decode(char const* pData, size_t length)
+{
+    if (!IsBinary(pData, length) || static_cast<unsigned char>(pData[1]) != kVersion)
+    {
+        return NULL ;
+    }
+    
+    char const* pEnd = pData + length ;
+    pData += 2 ;
+    
+    ElementXML_Handle hXML = DecodeElement(pData, pEnd, 0) ;
+    
+    if (!hXML)
+    {
+        return NULL ;
+    }
+    
+    // Trailing bytes mean we've misread the message somewhere
+    if (pData != pEnd)
+    {
+        ::soarxml_ReleaseRef(hXML) ;
+        return NULL ;
+    }
+    
+    return new ElementXML(hXML) ;
+}
+
+bool BinarySML::DecodeVarint(char const*& pData, char const* pEnd, uint64_t* pValue)
+{
+    uint64_t value = 0 ;
+    
+    for (int shift = 0 ; shift < 64 ; shift += 7)
+    {
+        if (pData >= pEnd)
+        {
+            return false ;
+        }
+        
+        unsigned char byte = static_cast<unsigned char>(*pData++) ;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift ;
+        
+        if ((byte & 0x80) == 0)
+        {
+            *pValue = value ;
+            return true ;
+        }
+    }
+    
+    return false ;
+}
+
+/*************************************************************
+* @brief Reads a string into a newly allocated (null terminated)
+*        ElementXML string.  Returns NULL on error.
+*************************************************************/
+char* BinarySML::DecodeString(char const*& pData, char const* pEnd, size_t* pLength)
+{
+    uint64_t length = 0 ;
+    
+    if (!DecodeVarint(pData, pEnd, &length) || length > static_cast<uint64_t>(pEnd - pData))
+    {
+        return NULL ;
+    }
+    
+    char* pStr = ElementXML::AllocateString(static_cast<int>(length)) ;
+    memcpy(pStr, pData, static_cast<size_t>(length)) ;
+    pStr[length] = 0 ;
+    
+    pData += length ;
+    *pLength = static_cast<size_t>(length) ;
+    
+    return pStr ;
+}
+
+/*************************************************************
+* @brief Reads a name, which is either one of the interned
+*        names (returned in pInterned, not to be released) or
+*        a literal string (returned in pLiteral, owned by the caller).
+*************************************************************/
+bool BinarySML::DecodeName(char const*& pData, char const* pEnd, char const** pInterned, char** pLiteral)
+{
+    uint64_t index = 0 ;
+    
+    *pInterned = NULL ;
+    *pLiteral = NULL ;
+    
+    if (!DecodeVarint(pData, pEnd, &index) || index > static_cast<uint64_t>(kBinarySMLNumberNames))
+    {
+        return false ;
+    }
+    
+    if (index > 0)
+    {
+        *pInterned = *kBinarySMLNames[index - 1] ;
+        return true ;
+    }
+    
+    size_t length = 0 ;
+    *pLiteral = DecodeString(pData, pEnd, &length) ;
+    
+    return *pLiteral != NULL ;
+}
+
+bool BinarySML::DecodeValue(char const*& pData, char const* pEnd, char const** pInterned, char** pCopy)
+{
+    *pInterned = NULL ;
+    *pCopy = NULL ;
+    
+    if (pData >= pEnd)
+    {
+        return false ;
+    }
+    
+    int kind = static_cast<unsigned char>(*pData++) ;
+    
+    switch (kind)
+    {
+        case BINARY_SML_VALUE_STRING:
+        {
+            size_t length = 0 ;
+            *pCopy = DecodeString(pData, pEnd, &length) ;
+            return *pCopy != NULL ;
+        }
+        
+        case BINARY_SML_VALUE_INTERNED:
+        {
+            // An interned value is encoded exactly like an interned name (but is never a literal)
+            uint64_t index = 0 ;
+            if (!DecodeVarint(pData, pEnd, &index) || index == 0 || index > static_cast<uint64_t>(kBinarySMLNumberNames))
+            {
+                return false ;
+            }
+            
+            *pInterned = *kBinarySMLNames[index - 1] ;
+            return true ;
+        }
+        
+        case BINARY_SML_VALUE_INT:
+        {
+            uint64_t zigzag = 0 ;
+            if (!DecodeVarint(pData, pEnd, &zigzag))
+            {
+                return false ;
+            }
+            
+            int64_t value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1) ;
+            
+            // Written by hand to avoid depending on the platform's 64-bit printf format
+            char buffer[24] ;
+            char* p = buffer + sizeof(buffer) ;
+            *--p = 0 ;
+            
+            uint64_t magnitude = value < 0 ? static_cast<uint64_t>(-value) : static_cast<uint64_t>(value) ;
+            do
+            {
+                *--p = static_cast<char>('0' + (magnitude % 10)) ;
+                magnitude /= 10 ;
+            }
+            while (magnitude != 0) ;
+            
+            if (value < 0)
+            {
+                *--p = '-' ;
+            }
+            
+            *pCopy = ElementXML::CopyString(p) ;
+            return true ;
+        }
+        
+        case BINARY_SML_VALUE_DOUBLE:
+        {
+            if (pEnd - pData < 8)
+            {
+                return false ;
+            }
+            
+            uint64_t bits = 0 ;
+            for (int i = 0 ; i < 8 ; i++)
+            {
+                bits = (bits << 8) | static_cast<unsigned char>(*pData++) ;
+            }
+            
+            double value = 0 ;
+            memcpy(&value, &bits, sizeof(value)) ;
+            
+            char buffer[64] ;
+            SNPRINTF(buffer, sizeof(buffer), "%.16g", value) ;
+            buffer[sizeof(buffer) - 1] = 0 ;
+            
+            *pCopy = ElementXML::CopyString(buffer) ;
+            return true ;
+        }
+    }
+    
+    return false ;
+}
+
+ElementXML_Handle BinarySML::DecodeElement(char const*& pData, char const* pEnd, int depth)
+{
+    if (depth > BINARY_SML_MAX_DEPTH)
+    {
+        return NULL ;
+    }
+    
+    ElementXML_Handle hXML = ::soarxml_NewElementXML() ;
+    
+    char const* pInterned = NULL ;
+    char* pLiteral = NULL ;
+    
+    // Tag name
+    if (!DecodeName(pData, pEnd, &pInterned, &pLiteral))
+    {
+        ::soarxml_ReleaseRef(hXML) ;
+        return NULL ;
+    }
+    
+    if (pInterned)
+    {
+        ::soarxml_SetTagNameFast(hXML, pInterned) ;
+    }
+    else
+    {
+        ::soarxml_SetTagName(hXML, pLiteral, false) ;
+    }
+    
+    if (pData >= pEnd)
+    {
+        ::soarxml_ReleaseRef(hXML) ;
+        return NULL ;
+    }
+    
+    unsigned char flags = static_cast<unsigned char>(*pData++) ;
+    size_t length = 0 ;
+    
+    // Comment
+    if (flags & BINARY_SML_FLAG_COMMENT)
+    {
+        char* pComment = DecodeString(pData, pEnd, &length) ;
+        if (!pComment)
+        {
+            ::soarxml_ReleaseRef(hXML) ;
+            return NULL ;
+        }
+        
+        ::soarxml_SetComment(hXML, pComment) ;
+        ElementXML::DeleteString(pComment) ;
+    }
+    
+    // Attributes
+    uint64_t numberAttributes = 0 ;
+    if (!DecodeVarint(pData, pEnd, &numberAttributes))
+    {
+        ::soarxml_ReleaseRef(hXML) ;
+        return NULL ;
+    }
+    
+    for (uint64_t i = 0 ; i < numberAttributes ; i++)
+    {
+        char const* pInternedValue = NULL ;
+        char* pValue = NULL ;
+        
+        if (!DecodeName(pData, pEnd, &pInterned, &pLiteral) || !DecodeValue(pData, pEnd, &pInternedValue, &pValue))
+        {
+            ElementXML::DeleteString(pLiteral) ;
+            ElementXML::DeleteString(pValue) ;
+            ::soarxml_ReleaseRef(hXML) ;
+            return NULL ;
+        }
+        
+        if (pInterned && pInternedValue)
+        {
+            ::soarxml_AddAttributeFastFast(hXML, pInterned, pInternedValue) ;
+        }
+        else if (pInterned)
+        {
+            ::soarxml_AddAttributeFast(hXML, pInterned, pValue, false) ;
+        }
+        else if (pInternedValue)
+        {
+            ::soarxml_AddAttribute(hXML, pLiteral, const_cast<char*>(pInternedValue), false, true) ;
+        }
+        else
+        {
+            ::soarxml_AddAttribute(hXML, pLiteral, pValue, false, false) ;
+        }
+    }
+    
+    // Character data
+    if (flags & BINARY_SML_FLAG_DATA)
+    {
+        char* pCharData = DecodeString(pData, pEnd, &length) ;
+        if (!pCharData)
+        {
+            ::soarxml_ReleaseRef(hXML) ;
+            return NULL ;
+        }
+        
+        if (flags & BINARY_SML_FLAG_BINARY)
+        {
+            ::soarxml_SetBinaryCharacterData(hXML, pCharData, static_cast<int>(length), false) ;
+        }
+        else
+        {
+            ::soarxml_SetCharacterData(hXML, pCharData, false) ;
+        }
+    }
+    
+    if (flags & BINARY_SML_FLAG_CDATA)
+    {
+        ::soarxml_SetUseCData(hXML, true) ;
+    }
+    
+    // Children
+    uint64_t numberChildren = 0 ;
+    if (!DecodeVarint(pData, pEnd, &numberChildren))
+    {
+        ::soarxml_ReleaseRef(hXML) ;
+        return NULL ;
+    }
+    
+    for (uint64_t i = 0 ; i < numberChildren ; i++)
+    {
+        ElementXML_Handle hChild = DecodeElement(pData, pEnd, depth + 1) ;
+        if (!hChild)
+        {
+            ::soarxml_ReleaseRef(hXML) ;
+            return NULL ;
+        }
+        
+        ::soarxml_AddChild(hXML, hChild) ;
+    }
+    
+    return hXML ;
+}
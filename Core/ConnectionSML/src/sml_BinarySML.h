@@ -0,0 +1,108 @@
+/////////////////////////////////////////////////////////////////
+// BinarySML class
+//
+// A compact binary encoding for SML messages sent over a remote connection.
+//
+// Generating an XML string for every message and parsing it again on the
+// other side of the socket is a large part of the cost of a remote connection.
+// This encoding writes the ElementXML tree directly:
+//
+//  message   := kMagic kVersion element
+//  element   := name flags [comment] attrCount (name value)* [data] childCount element*
+//  name      := varint (0 = literal string follows, n = n-th interned sml_Names entry)
+//  value     := kind byte + string / interned name / zigzag varint / 8 byte double
+//  string    := varint length + bytes
+//
+// Names that appear in sml_Names (tags, attribute names and many common values)
+// are sent as small integers and are decoded straight back to the static
+// sml_Names constants, so decoding does not copy them.  Integer values are sent
+// as varints and WME values that are doubles are sent as raw 8 byte values
+// (but only when that round trips to exactly the same string).
+//
+// A message always starts with kMagic, which can never start an XML string,
+// so a receiver can tell the two encodings apart one message at a time.
+// RemoteConnection only switches to this encoding once it knows the other side
+// can read it (see RemoteConnection::SendMsg).
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SML_BINARY_SML_H
+#define SML_BINARY_SML_H
+
+#include "Export.h"
+#include "ElementXMLHandle.h"
+
+#include <string>
+
+namespace soarxml
+{
+    class ElementXML ;
+}
+
+namespace sml
+{
+
+    class EXPORT BinarySML
+    {
+        public:
+            // The first byte of every binary message.  XML strings start with '<' or whitespace.
+            static const unsigned char kMagic = 0x01 ;
+            
+            // Bump this when the format or the interned name table changes in a way
+            // that an older reader would misinterpret (appending names is not enough on its own).
+            static const unsigned char kVersion = 1 ;
+            
+            /*************************************************************
+            * @brief Encodes the message (and all of its children) into pBuffer,
+            *        replacing anything already in the buffer.
+            *************************************************************/
+            static void Encode(soarxml::ElementXML const* pMsg, std::string* pBuffer) ;
+            
+            /*************************************************************
+            * @brief Decodes a message created by Encode().
+            *
+            * @returns NULL if the data is not a valid binary message,
+            *          otherwise a new ElementXML object the caller must delete.
+            *************************************************************/
+            static soarxml::ElementXML* Decode(char const* pData, size_t length) ;
+            
+            /*************************************************************
+            * @brief Returns true if the data starts with a binary message header
+            *        (rather than an XML document).
+            *************************************************************/
+            static bool IsBinary(char const* pData, size_t length)
+            {
+                return length >= 2 && static_cast<unsigned char>(pData[0]) == kMagic ;
+            }
+            
+            /*************************************************************
+            * @brief Returns the number of names in the interned name table.
+            *************************************************************/
+            static int GetNumberInternedNames() ;
+            
+            /*************************************************************
+            * @brief The primitives the encoding is built from
+            *        (also used by InputBatch, see sml_InputBatch.h).
+            *
+            * DecodeVarint returns false if the data ends before the value does.
+            *************************************************************/
+            static void EncodeString(char const* pStr, size_t length, std::string* pBuffer) ;
+            static void EncodeVarint(uint64_t value, std::string* pBuffer) ;
+            static bool DecodeVarint(char const*& pData, char const* pEnd, uint64_t* pValue) ;
+            
+        protected:
+            static void EncodeElement(ElementXML_Handle hXML, std::string* pBuffer) ;
+            static void EncodeName(char const* pName, std::string* pBuffer) ;
+            static void EncodeValue(char const* pName, char const* pValue, std::string* pBuffer) ;
+            
+            static ElementXML_Handle DecodeElement(char const*& pData, char const* pEnd, int depth) ;
+            static bool DecodeName(char const*& pData, char const* pEnd, char const** pInterned, char** pLiteral) ;
+            static bool DecodeValue(char const*& pData, char const* pEnd, char const** pInterned, char** pCopy) ;
+            static char* DecodeString(char const*& pData, char const* pEnd, size_t* pLength) ;
+            
+            static int FindInternedName(char const* pName) ;
+    };
+    
+} // End of namespace
+
+#endif // SML_BINARY_SML_H
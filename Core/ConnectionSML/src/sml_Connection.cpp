@@ -39,6 +39,10 @@
 #include "sock_ClientNamedPipe.h"
 #endif
 
+#ifdef ENABLE_SHARED_MEMORY
+#include "sock_SharedMemory.h"
+#endif
+
 #include <time.h>   // For debug random start of message id's
 #include <sstream>
 
@@ -64,6 +68,8 @@ Connection::Connection()
     m_bIsDirectConnection = false ;
     m_bTraceCommunications = false ;
     m_bIsKernelSide = false ;
+    m_OutgoingBytes = 0 ;
+    m_HasOutgoing = false ;
     
     m_Timer.reset();
     m_IncomingTime.reset();
@@ -99,13 +105,10 @@ Connection::~Connection()
         delete pList ;
     }
     
-    // Clear out any messages sitting on the queues
-    while (m_IncomingMessageQueue.size() > 0)
+    // Clear out any messages sitting on the outgoing queue (the incoming one empties itself)
+    for (OutgoingQueue::iterator iter = m_OutgoingQueue.begin() ; iter != m_OutgoingQueue.end() ; iter++)
     {
-        ElementXML_Handle hMsg = m_IncomingMessageQueue.back() ;
-        delete hMsg ;
-        
-        m_IncomingMessageQueue.pop() ;
+        delete iter->first ;
     }
 }
 
@@ -150,10 +153,24 @@ Connection* Connection::CreateEmbeddedConnection(bool clientThread, bool optimiz
     return pConnection ;
 }
 
-Connection* Connection::CreateRemoteConnection(bool sharedFileSystem, char const* pIPaddress, int port, ErrorCode* pError)
+Connection* Connection::CreateRemoteConnection(bool sharedFileSystem, char const* pIPaddress, int port, ErrorCode* pError, bool sharedMemory)
 {
     RemoteConnection* pConnection = 0;
     
+#ifdef ENABLE_SHARED_MEMORY
+    if (pIPaddress == 0 && sharedMemory)
+    {
+        sock::SharedMemory* pSharedMemory = sock::SharedMemory::ConnectToServer(port) ;
+        
+        if (pSharedMemory)
+        {
+            return new RemoteConnection(sharedFileSystem, pSharedMemory) ;
+        }
+    }
+#else
+    unused(sharedMemory) ;
+#endif
+    
 #ifdef ENABLE_NAMED_PIPES
     if (pIPaddress == 0)
     {
@@ -496,8 +513,18 @@ bool Connection::SendMessageGetResponse(AnalyzeXML* pAnalysis, ElementXML* pMsg)
     //  when the client is sleeping, but we don't want them both to be sending/receiving at the same time).
     soar_thread::Lock lock(&m_ClientMutex) ;
     
-    // Send the command over.
-    SendMsg(pMsg);
+    {
+        soar_thread::Lock sendLock(&m_SendMutex) ;
+        
+        // Anything queued earlier has to arrive first
+        if (m_HasOutgoing)
+        {
+            SendQueuedMessages() ;
+        }
+    
+        // Send the command over.
+        SendMsg(pMsg);
+    }
     
     // There was an error in the send, so we're done.
     if (HadError())
@@ -842,6 +869,83 @@ bool Connection::SendClassCommand(AnalyzeXML* pResponse, char const* pCommandNam
 }
 
 
+void Connection::QueueMessage(ElementXML* pMsg, size_t size)
+{
+    soar_thread::Lock lock(&m_OutgoingMutex) ;
+    
+    m_OutgoingQueue.push_back(std::make_pair(pMsg, size)) ;
+    m_OutgoingBytes += size ;
+    m_HasOutgoing = true ;
+}
+
+bool Connection::SendQueuedMessages()
+{
+    // Holding this while we take each message off the queue means two threads
+    // sending the queue can't swap the order of the messages.  (It's not
+    // m_ClientMutex, so we don't wait for a command that's executing).
+    soar_thread::Lock lock(&m_SendMutex) ;
+    
+    bool sent = false ;
+    
+    while (true)
+    {
+        std::pair< ElementXML*, size_t > next ;
+        
+        {
+            soar_thread::Lock queueLock(&m_OutgoingMutex) ;
+            
+            if (m_OutgoingQueue.empty())
+            {
+                m_HasOutgoing = false ;
+                break ;
+            }
+            
+            next = m_OutgoingQueue.front() ;
+            m_OutgoingQueue.pop_front() ;
+        }
+        
+        // Nobody will read the response, which is fine as remote connections
+        // throw away responses they aren't waiting for.
+        if (!IsClosed())
+        {
+            SendMsg(next.first) ;
+        }
+        
+        delete next.first ;
+        sent = true ;
+        
+        // Only take the message off the count once it's gone, so the count
+        // includes one that's stuck in a send to a slow client.
+        soar_thread::Lock queueLock(&m_OutgoingMutex) ;
+        m_OutgoingBytes -= next.second ;
+    }
+    
+    return sent ;
+}
+
+size_t Connection::GetQueuedBytes()
+{
+    soar_thread::Lock lock(&m_OutgoingMutex) ;
+    return m_OutgoingBytes ;
+}
+
+/*************************************************************
+* @brief Creates a new ID that's unique for this generator.
+*        Kernel events can be sent from more than one thread
+*        (see sml_EventBatcher.h), so we increment atomically
+*        where we can.
+*
+* @returns The new ID.
+*************************************************************/
+int Connection::GenerateID()
+{
+#ifdef HAVE_ATOMICS
+    return static_cast<int>(atomic_inc(&m_MessageID) - 1) ;
+#else
+    return static_cast<int>(m_MessageID++) ;
+#endif
+}
+
 /*************************************************************
 * @brief Create a basic SML message, with the top level <sml> tag defined
 *        together with the version, doctype, soarVersion and id filled in.
@@ -1085,29 +1189,14 @@ void Connection::AddSimpleResultToSMLResponse(ElementXML* pResponse, char const*
 }
 
 /*************************************************************
-* @brief Removes the top message from the incoming message queue
-*        in a thread safe way.
+* @brief Removes the top message from the incoming message queue.
+*        Only one thread may do this at a time (the callers hold m_ClientMutex).
 *        Returns NULL if there is no waiting message.
 *************************************************************/
 ElementXML* Connection::PopIncomingMessageQueue()
 {
-    // Ensure only one thread is changing the message queue at a time
-    // This lock is released when we exit this function.
-    soar_thread::Lock lock(&m_IncomingMutex) ;
-    
-    if (m_IncomingMessageQueue.size() == 0)
-    {
-        return NULL ;
-    }
-    
-    //  Read the first message that's waiting
-    ElementXML_Handle hIncomingMsg = m_IncomingMessageQueue.front() ;
-    m_IncomingMessageQueue.pop() ;
-    
-    ElementXML* pIncomingMsg = new ElementXML(hIncomingMsg);
-    
     // The guy receiving this expects to delete this object anyway when they're done
-    return pIncomingMsg ;
+    return m_IncomingMessageQueue.Pop() ;
 }
 
 
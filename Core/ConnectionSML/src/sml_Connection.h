@@ -38,6 +38,7 @@
 
 #include "sml_Errors.h"
 #include "thread_Lock.h"
+#include "sml_MessageQueue.h"
 
 // These last ones are just for convenience, they could come out
 #include "ElementXMLHandle.h"
@@ -50,6 +51,8 @@ namespace sock
 {
     // Forward declarations
     class DataSender ;
+    class Reactor ;
+    struct DataSenderStats ;
 }
 
 namespace soarxml
@@ -124,9 +127,6 @@ namespace sml
     typedef std::map< std::string, CallbackList* >  CallbackMap ;
     typedef CallbackMap::iterator                   CallbackMapIter ;
     
-// Used to store a queue of messages
-    typedef std::queue< ElementXML_Handle > MessageQueue ;
-    
     typedef std::list< soarxml::ElementXML* >   MessageList ;
     typedef MessageList::iterator       MessageListIter ;
     
@@ -150,18 +150,17 @@ namespace sml
             void*           m_pUserData ;
             
             // The ID to use for the next message we send
-            int             m_MessageID ;
+            // (long so GenerateID can use atomic_inc, see sml_Connection.cpp)
+            volatile long   m_MessageID ;
             
             // The error status of the last function called.
             ErrorCode       m_ErrorCode ;
             
             // A list of messages that have been received on this connection and are waiting to be executed.
-            // This queue may not be in use for a given type of connection
+            // This queue may not be in use for a given type of connection.
+            // (It doesn't need a lock, see sml_MessageQueue.h).
             MessageQueue    m_IncomingMessageQueue ;
             
-            // We use this mutex to serialize acccess to the incoming message queue (for certain types of connections)
-            soar_thread::Mutex  m_IncomingMutex ;
-            
             // True if we can make direct calls to gSKI to optimize I/O
             bool m_bIsDirectConnection ;
             
@@ -177,6 +176,21 @@ namespace sml
             // alive even when the client itself goes to sleep.
             soar_thread::Mutex  m_ClientMutex ;
             
+            // Held while queued messages and the message that follows them go out, so they
+            // can't be interleaved.  This is separate from m_ClientMutex, which a remote
+            // connection holds for as long as a command it received takes to execute
+            // (e.g. a run), so the event batcher can still send the queue meanwhile.
+            soar_thread::Mutex  m_SendMutex ;
+            
+            // Messages waiting to be sent without a response (see QueueMessage),
+            // with the size the sender estimated for each.
+            typedef std::list< std::pair< soarxml::ElementXML*, size_t > >  OutgoingQueue ;
+            
+            OutgoingQueue       m_OutgoingQueue ;
+            size_t              m_OutgoingBytes ;
+            volatile bool       m_HasOutgoing ;     // Lets SendMessageGetResponse skip the lock when nothing is queued
+            soar_thread::Mutex  m_OutgoingMutex ;   // Guards the three above
+            
             // This information can be requested and set by clients, so one client can
             // find out who else is connected.
             std::string m_ID ;          // Unique ID, machine generated (by kernel)
@@ -226,10 +240,12 @@ namespace sml
             *                   Pass "127.0.0.1" to create a connection between two processes on the same machine.
             * @param port       The port number to connect to.  The default port for SML is 12121 (picked at random).
             * @param pError     Pass in a pointer to an int and receive back an error code if there is a problem.  (Can pass NULL).
+            * @param sharedMemory   If true and pIPaddress is NULL, try to connect through shared memory first (see sock_SharedMemory.h),
+            *                   falling back to a socket if the kernel doesn't support it.
             *
             * @returns A RemoteConnection instance.
             *************************************************************/
-            static Connection* CreateRemoteConnection(bool sharedFileSystem, char const* pIPaddress, int port = kDefaultSMLPort, ErrorCode* pError = NULL) ;
+            static Connection* CreateRemoteConnection(bool sharedFileSystem, char const* pIPaddress, int port = kDefaultSMLPort, ErrorCode* pError = NULL, bool sharedMemory = true) ;
             
             /*************************************************************
             * @brief Create a new connection object wrapping a socket.
@@ -287,6 +303,41 @@ namespace sml
                 return m_bTraceCommunications ;
             }
             
+            /*************************************************************
+            * @brief Controls whether this connection offers the binary SML encoding
+            *        (see sml_BinarySML.h) to the other side.  Messages are only sent
+            *        in binary once the other side has shown it can read them, so this
+            *        is safe to leave on when talking to an older client or kernel.
+            *        Only affects remote connections.
+            *************************************************************/
+            virtual void        SetBinaryEncoding(bool /*state*/)
+            {
+            }
+            virtual bool        IsBinaryEncoding()
+            {
+                return false ;
+            }
+            
+            /*************************************************************
+            * @brief Ask a reactor to report when messages arrive on this
+            *        connection (see sock_Reactor.h) so it doesn't need polling.
+            *        Returns false if the connection can't be used that way
+            *        (in which case it should be polled as usual).
+            *************************************************************/
+            virtual bool        AttachReactor(sock::Reactor* /*pReactor*/)
+            {
+                return false ;
+            }
+            
+            /*************************************************************
+            * @brief Fills in the traffic through this connection.
+            *        Returns false if it isn't recorded (for embedded connections).
+            *************************************************************/
+            virtual bool        GetStats(sock::DataSenderStats* /*pStats*/)
+            {
+                return false ;
+            }
+            
             /*************************************************************
             * @brief True if this connection is from the kernel to the client (false if other way, from client to kernel).
             *        This has no impact on the logic but can help with debugging.
@@ -311,6 +362,29 @@ namespace sml
             *************************************************************/
             virtual void SendMsg(soarxml::ElementXML* pMsg) = 0 ;
             
+            /*************************************************************
+            * @brief Adds a message to the queue of messages to send without
+            *        waiting for their responses, taking ownership of it.
+            *
+            *        The queue is sent by SendQueuedMessages(), which
+            *        SendMessageGetResponse() and remote connections (before
+            *        they send a response) call first, so messages still
+            *        go out in the order they were queued or sent.
+            *
+            * @param size   An estimate of the message's size, counted by
+            *               GetQueuedBytes() until the message has been sent.
+            *************************************************************/
+            virtual void QueueMessage(soarxml::ElementXML* pMsg, size_t size) ;
+            
+            /*************************************************************
+            * @brief Sends everything on the queue (see QueueMessage).
+            *        Returns true if there was anything to send.
+            *************************************************************/
+            virtual bool SendQueuedMessages() ;
+            
+            // The estimated size of the messages waiting to be sent
+            size_t GetQueuedBytes() ;
+            
             /*************************************************************
             * @brief Retrieve any commands, notifications, responses etc. that are waiting.
             *        Messages that are received are routed to callback functions in the client for processing.
@@ -578,10 +652,7 @@ namespace sml
             *
             * @returns The new ID.
             *************************************************************/
-            int GenerateID()
-            {
-                return m_MessageID++ ;
-            }
+            int GenerateID() ;
             
             /*************************************************************
             * @brief Create a basic SML message, with the top level <sml> tag defined
@@ -695,8 +766,8 @@ namespace sml
             virtual CallbackList* GetCallbackList(char const* pType) ;
             
             /*************************************************************
-            * @brief Removes the top message from the incoming message queue
-            *        in a thread safe way.
+            * @brief Removes the top message from the incoming message queue.
+            *        Only one thread may do this at a time (the callers hold m_ClientMutex).
             *        Returns NULL if there is no waiting message.
             *************************************************************/
             soarxml::ElementXML* PopIncomingMessageQueue() ;
@@ -20,6 +20,7 @@
 #include "thread_Thread.h"
 #include "sml_KernelSML.h"
 #include "sml_AgentSML.h"
+#include "sml_RunScheduler.h"
 #include "EmbeddedSMLInterface.h"
 
 #include <string>
@@ -274,3 +275,53 @@ void EmbeddedConnection::DirectRun
 {
     m_pKernelSML->DirectRun(pAgentName, forever, stepSize, interleaveSize, count) ;
 }
+
+bool EmbeddedConnection::DirectIsSoarRunning()
+{
+    return m_pKernelSML->GetRunScheduler()->IsRunning() ;
+}
+
+bool EmbeddedConnection::DirectCheckForIncomingCommands()
+{
+    return m_pKernelSML->ReceiveAllMessages() ;
+}
+
+bool EmbeddedConnection::DirectWasAgentOnRunList
+(Direct_AgentSML_Handle pAgentSML)
+{
+    AgentSML* a = reinterpret_cast<AgentSML*>(pAgentSML);
+    assert(a);
+    return a->WasAgentOnRunList() ;
+}
+
+smlRunResult EmbeddedConnection::DirectGetResultOfLastRun
+(Direct_AgentSML_Handle pAgentSML)
+{
+    AgentSML* a = reinterpret_cast<AgentSML*>(pAgentSML);
+    assert(a);
+    return a->GetResultOfLastRun() ;
+}
+
+smlPhase EmbeddedConnection::DirectGetCurrentPhase
+(Direct_AgentSML_Handle pAgentSML)
+{
+    AgentSML* a = reinterpret_cast<AgentSML*>(pAgentSML);
+    assert(a);
+    return a->GetCurrentPhase() ;
+}
+
+uint64_t EmbeddedConnection::DirectGetDecisionCycleCounter
+(Direct_AgentSML_Handle pAgentSML)
+{
+    AgentSML* a = reinterpret_cast<AgentSML*>(pAgentSML);
+    assert(a);
+    return a->GetNumDecisionsExecuted() ;
+}
+
+smlRunState EmbeddedConnection::DirectGetRunState
+(Direct_AgentSML_Handle pAgentSML)
+{
+    AgentSML* a = reinterpret_cast<AgentSML*>(pAgentSML);
+    assert(a);
+    return a->GetRunState() ;
+}
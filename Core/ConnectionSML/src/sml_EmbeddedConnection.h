@@ -15,6 +15,7 @@
 
 #include "sml_Connection.h"
 #include "sml_Handles.h"
+#include "sml_Events.h"
 #include "EmbeddedSMLInterface.h"
 
 namespace sml
@@ -82,6 +83,16 @@ namespace sml
             void DirectAddID(Direct_AgentSML_Handle pAgentSML, char const* pId, char const* pAttribute, char const* pValueId, int64_t clientTimetag);
             Direct_AgentSML_Handle DirectGetAgentSMLHandle(char const* pAgentName);
             void DirectRun(char const* pAgentName, bool forever, int stepSize, int interleaveSize, uint64_t count);
+            
+            // The queries clients make most often (usually once or more per decision), so they're
+            // worth answering without building and parsing a message for each one.
+            bool DirectIsSoarRunning();
+            bool DirectCheckForIncomingCommands();
+            bool DirectWasAgentOnRunList(Direct_AgentSML_Handle pAgentSML);
+            smlRunResult DirectGetResultOfLastRun(Direct_AgentSML_Handle pAgentSML);
+            smlPhase DirectGetCurrentPhase(Direct_AgentSML_Handle pAgentSML);
+            uint64_t DirectGetDecisionCycleCounter(Direct_AgentSML_Handle pAgentSML);
+            smlRunState DirectGetRunState(Direct_AgentSML_Handle pAgentSML);
     } ;
     
 } // End of namespace
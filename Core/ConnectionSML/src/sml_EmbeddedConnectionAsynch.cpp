@@ -22,6 +22,7 @@
 #include "ElementXML.h"
 #include "sml_MessageSML.h"
 #include "thread_Thread.h"
+#include "sock_Reactor.h"
 
 #include <string>
 #include <iostream>
@@ -39,6 +40,108 @@ EmbeddedConnectionAsynch::~EmbeddedConnectionAsynch()
     }
 }
 
+/*************************************************************
+* @brief Adds a message to the queue this connection executes
+*        (on the receiver's thread, at a later point).
+*
+* A response that a command on this side is waiting for goes
+* straight to that command instead, unless there are still
+* messages queued ahead of it (e.g. events sent while the command
+* was executing), which have to be handled first.
+*************************************************************/
+void EmbeddedConnectionAsynch::AddToIncomingMessageQueue(ElementXML_Handle hMsg)
+{
+    ElementXML* pMsg = new ElementXML(hMsg) ;
+    
+    if (m_IncomingMessageQueue.IsEmpty() && HandToWaiter(pMsg))
+    {
+        return ;
+    }
+    
+    m_IncomingMessageQueue.Push(pMsg) ;
+    
+#ifdef ENABLE_EPOLL
+    // Wake the kernel's receiver thread
+    if (m_pReactor)
+    {
+        m_pReactor->Post(static_cast<Connection*>(this)) ;
+    }
+#endif
+
+    // Wake up anybody who's waiting for a response
+    m_WaitEvent.TriggerEvent() ;
+}
+
+bool EmbeddedConnectionAsynch::AttachReactor(sock::Reactor* pReactor)
+{
+#ifdef ENABLE_EPOLL
+    m_pReactor = pReactor ;
+    
+    // In case something arrived before we were watched
+    if (!m_IncomingMessageQueue.IsEmpty())
+    {
+        m_pReactor->Post(static_cast<Connection*>(this)) ;
+    }
+    
+    return true ;
+#else
+    unused(pReactor) ;
+    return false ;
+#endif
+}
+
+bool EmbeddedConnectionAsynch::HandToWaiter(ElementXML* pMsg)
+{
+    if (m_Waiting == 0)
+    {
+        return false ;
+    }
+    
+    char const* pAckID = pMsg->GetAttribute(sml_Names::kAck) ;
+    
+    if (!pAckID)
+    {
+        return false ;
+    }
+    
+    soar_thread::Lock lock(&m_ListMutex) ;
+    
+    for (PendingList::iterator iter = m_PendingList.begin() ; iter != m_PendingList.end() ; iter++)
+    {
+        PendingResponse* pPending = *iter ;
+        
+        if (!pPending->m_pResponse && strcmp(pPending->m_pID, pAckID) == 0)
+        {
+            pPending->m_pResponse = pMsg ;
+            m_WaitEvent.TriggerEvent() ;
+            return true ;
+        }
+    }
+    
+    return false ;
+}
+
+void EmbeddedConnectionAsynch::AddPending(PendingResponse* pPending)
+{
+    soar_thread::Lock lock(&m_ListMutex) ;
+    
+    // Newest first, as that's the one most likely to be answered next
+    // (a callback can send a command while an earlier one is still waiting).
+    m_PendingList.push_front(pPending) ;
+    atomic_inc(&m_Waiting) ;
+}
+
+// Stops the response being handed over and returns it if it already has been
+ElementXML* EmbeddedConnectionAsynch::RemovePending(PendingResponse* pPending)
+{
+    soar_thread::Lock lock(&m_ListMutex) ;
+    
+    m_PendingList.remove(pPending) ;
+    atomic_dec(&m_Waiting) ;
+    
+    return pPending->m_pResponse ;
+}
+
 /*************************************************************
 * @brief Send a message to the other side of this connection.
 *
@@ -230,11 +333,12 @@ ElementXML* EmbeddedConnectionAsynch::GetResponseForID(char const* pID, bool wai
         return pResponse ;
     }
     
-    // How long we sleep in seconds+milliseconds each pass through
-    // (0 means we only sleep if another thread is scheduled to run --
-    //  it ensures maximum performance otherwise).
-    int sleepTimeSecs = 0 ;
-    int sleepTimeMillisecs = 0 ;
+    // Have the response handed to us when it arrives, so we don't have
+    // to look for it in the queue (see AddToIncomingMessageQueue).
+    PendingResponse pending ;
+    pending.m_pID = pID ;
+    pending.m_pResponse = NULL ;
+    AddPending(&pending) ;
     
     // How long we will wait before checking for a message (in msecs)
     // (If one comes in it'll wake us up from this immediately, but having
@@ -242,18 +346,20 @@ ElementXML* EmbeddedConnectionAsynch::GetResponseForID(char const* pID, bool wai
     int maximumWaitTimeSeconds = 1 ;
     int maximumWaitTimeMilliseconds = 0 ;
     
-    // If we don't already have this response cached,
-    // then read any pending messages.
     do
     {
-        // Loop until there are no more messages waiting for us
-        while (ReceiveMessages(false))
+        // Read any pending messages (events sent to us while the command
+        // was executing, or a response that arrived while others were queued).
+        while (!pending.m_pResponse && ReceiveMessages(false))
         {
             // Check each message to see if it's a match
             if (DoesResponseMatch(m_pLastResponse, pID))
             {
                 pResponse = m_pLastResponse ;
                 m_pLastResponse = NULL ;
+                
+                // It can't have been handed over as well, as the ID is only used once
+                RemovePending(&pending) ;
                 return pResponse ;
             }
             else
@@ -263,15 +369,32 @@ ElementXML* EmbeddedConnectionAsynch::GetResponseForID(char const* pID, bool wai
             }
         }
         
+        if (pending.m_pResponse)
+        {
+            break ;
+        }
+        
         // Check to see if the message has been added to the list of
         // waiting messages.  This could have happened on a different
         // thread while we were in here waiting.
-        ElementXML* pResponse = IsResponseInList(pID) ;
+        pResponse = IsResponseInList(pID) ;
         if (pResponse != NULL)
         {
+            RemovePending(&pending) ;
             return pResponse ;
         }
         
+        // The response (or a message we need to handle first) may have come in since we looked
+        if (pending.m_pResponse || !m_IncomingMessageQueue.IsEmpty())
+        {
+            continue ;
+        }
+        
+        if (!wait)
+        {
+            break ;
+        }
+        
 #ifdef PROFILE_CONNECTIONS
         m_Timer.start() ;
 #endif
@@ -280,11 +403,6 @@ ElementXML* EmbeddedConnectionAsynch::GetResponseForID(char const* pID, bool wai
         // If one comes in it will trigger this event to wake us up immediately.
         m_WaitEvent.WaitForEvent(maximumWaitTimeSeconds, maximumWaitTimeMilliseconds) ;
         
-        // Allow other threads the chance to update
-        // (by calling with 0 for sleep time we don't give away cycles if
-        //  no other thread is waiting to execute).
-        sml::Sleep(sleepTimeSecs, sleepTimeMillisecs) ;
-        
 #ifdef PROFILE_CONNECTIONS
         m_Timer.stop();
         m_IncomingTime.update(m_Timer);
@@ -293,16 +411,16 @@ ElementXML* EmbeddedConnectionAsynch::GetResponseForID(char const* pID, bool wai
         // Check if the connection has been closed
         if (IsClosed())
         {
-            return NULL ;
+            break ;
         }
         
     }
     while (wait) ;
     
-    // If we get here we didn't find the response.
-    // (If we're waiting we'll wait forever, so we'll only get here if
-    //  we chose not to wait).
-    return NULL ;
+    // Returns the response if it was handed over.  Otherwise we didn't find it
+    // (if we're waiting we'll wait forever, so we'll only get here if
+    //  we chose not to wait or the connection closed).
+    return RemovePending(&pending) ;
 }
 
 /*************************************************************
@@ -33,45 +33,70 @@ namespace sml
         protected:
             // Clients should not use this.  Use Connection::CreateEmbeddedConnection instead.
             // Making it protected so you can't accidentally create one like this.
-            EmbeddedConnectionAsynch() { }
+            EmbeddedConnectionAsynch()
+            {
+                m_pReactor = NULL ;
+                m_Waiting = 0 ;
+            }
             
             /** A list of messages we've received that have "ack" fields but have yet to match up to the commands which triggered them */
             MessageList     m_ReceivedMessageList ;
             
             enum            { kMaxListSize = 10 } ;
             
-            /** Ensures only one thread accesses the response list at a time **/
+            /** A command that's waiting for its response.  The response is handed straight to it when it arrives (rather than
+                going through the incoming queue) as long as nothing is queued ahead of it. **/
+            struct PendingResponse
+            {
+                char const*                     m_pID ;
+                soarxml::ElementXML* volatile   m_pResponse ;
+            } ;
+            
+            typedef std::list< PendingResponse* >   PendingList ;
+            
+            PendingList     m_PendingList ;
+            
+            /** The size of m_PendingList, so messages can skip the lock when nobody's waiting **/
+            volatile long   m_Waiting ;
+            
+            /** Ensures only one thread accesses the response list (and the pending list) at a time **/
             soar_thread::Mutex  m_ListMutex ;
             
             /** An event object which we use to have one thread sleep while waiting for another thread to drop off a response to a message */
             soar_thread::Event  m_WaitEvent ;
             
+            /** The reactor to tell about new messages (see AttachReactor), or NULL **/
+            sock::Reactor*  m_pReactor ;
+            
             /** Adds the message to the queue, taking ownership of it at the same time */
             void AddResponseToList(soarxml::ElementXML* pResponse) ;
             soarxml::ElementXML* IsResponseInList(char const* pID) ;
             
             bool DoesResponseMatch(soarxml::ElementXML* pResponse, char const* pID) ;
             
+            /** Gives the message to the command waiting for it and returns true, or returns false if nobody is **/
+            bool HandToWaiter(soarxml::ElementXML* pMsg) ;
+            
+            void AddPending(PendingResponse* pPending) ;
+            soarxml::ElementXML* RemovePending(PendingResponse* pPending) ;
+            
         public:
             virtual ~EmbeddedConnectionAsynch() ;
             
             // Commands are added to this queue that this connection will
             // process in the future.  E.g. A client would use this call to add
             // a command to the queue that the kernel would then execute.
-            void AddToIncomingMessageQueue(ElementXML_Handle hMsg)
-            {
-                // Make sure only one thread modifies the message queue at a time.
-                soar_thread::Lock lock(&m_IncomingMutex) ;
-                m_IncomingMessageQueue.push(hMsg) ;
-                
-                // Wake up anybody who's waiting for a response
-                m_WaitEvent.TriggerEvent() ;
-            }
+            // Can be called from any thread without waiting on the one reading the queue.
+            void AddToIncomingMessageQueue(ElementXML_Handle hMsg) ;
             
             virtual bool IsAsynchronous()
             {
                 return true ;
             }
+            
+            // The kernel's side of the connection uses this so its receiver thread
+            // can sleep until a command arrives rather than polling for one.
+            virtual bool AttachReactor(sock::Reactor* pReactor) ;
             virtual void SendMsg(soarxml::ElementXML* pMsg) ;
             virtual soarxml::ElementXML* GetResponseForID(char const* pID, bool wait) ;
             virtual bool ReceiveMessages(bool allMessages) ;
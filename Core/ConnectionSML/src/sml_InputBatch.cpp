@@ -0,0 +1,306 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// InputBatch classes
+//
+// A compact format for sending a set of input-link changes to the kernel.
+// See sml_InputBatch.h for the format.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "sml_InputBatch.h"
+#include "sml_BinarySML.h"
+#include "sml_Names.h"
+#include "ElementXML.h"
+
+#include <string.h>
+
+using namespace sml ;
+
+static void InputBatchAddInt(int64_t value, std::string* pBuffer)
+{
+    // Zigzag encoding, so small negative values (like client timetags) stay small
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63) ;
+    BinarySML::EncodeVarint(zigzag, pBuffer) ;
+}
+
+static bool InputBatchReadInt(char const*& pData, char const* pEnd, int64_t* pValue)
+{
+    uint64_t zigzag = 0 ;
+    
+    if (!BinarySML::DecodeVarint(pData, pEnd, &zigzag))
+    {
+        return false ;
+    }
+    
+    *pValue = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1) ;
+    return true ;
+}
+
+InputBatchWriter::InputBatchWriter()
+{
+    m_Size = 0 ;
+    m_NeedsReset = false ;
+}
+
+void InputBatchWriter::Clear()
+{
+    // The reader will never see any strings this batch defined, so start the table again
+    m_Buffer.clear() ;
+    m_Size = 0 ;
+    m_Handles.clear() ;
+    m_NeedsReset = true ;
+}
+
+void InputBatchWriter::StartChange()
+{
+    if (m_Buffer.empty())
+    {
+        m_Buffer.push_back(static_cast<char>(InputBatch::kVersion)) ;
+        
+        // The reader only accepts a reset at the start of a batch, so this is the only place we can do it
+        if (m_NeedsReset || m_Handles.size() >= InputBatch::kMaxHandles)
+        {
+            m_Handles.clear() ;
+            m_NeedsReset = false ;
+            m_Buffer.push_back(static_cast<char>(InputBatch::kReset)) ;
+        }
+    }
+    
+    m_Size++ ;
+}
+
+/*************************************************************
+* @brief Returns the handle for this string, defining it first
+*        if this is the first time we've sent it.
+*************************************************************/
+int InputBatchWriter::GetHandle(char const* pStr)
+{
+    std::map<std::string, int>::iterator iter = m_Handles.find(pStr) ;
+    
+    if (iter != m_Handles.end())
+    {
+        return iter->second ;
+    }
+    
+    int handle = static_cast<int>(m_Handles.size()) ;
+    m_Handles[pStr] = handle ;
+    
+    m_Buffer.push_back(static_cast<char>(InputBatch::kDefine)) ;
+    BinarySML::EncodeString(pStr, strlen(pStr), &m_Buffer) ;
+    
+    return handle ;
+}
+
+void InputBatchWriter::AddChange(int type, char const* pID, char const* pAttribute, char const* pIdValue)
+{
+    StartChange() ;
+    
+    // Any definitions have to come before the change that uses them
+    int id = GetHandle(pID) ;
+    int attribute = GetHandle(pAttribute) ;
+    int value = pIdValue ? GetHandle(pIdValue) : 0 ;
+    
+    m_Buffer.push_back(static_cast<char>(type)) ;
+    BinarySML::EncodeVarint(id, &m_Buffer) ;
+    BinarySML::EncodeVarint(attribute, &m_Buffer) ;
+    
+    if (pIdValue)
+    {
+        BinarySML::EncodeVarint(value, &m_Buffer) ;
+    }
+}
+
+void InputBatchWriter::AddTimeTag(int64_t timeTag)
+{
+    InputBatchAddInt(timeTag, &m_Buffer) ;
+}
+
+void InputBatchWriter::AddStringWME(char const* pID, char const* pAttribute, char const* pValue, int64_t timeTag)
+{
+    AddChange(InputBatch::kAddString, pID, pAttribute) ;
+    BinarySML::EncodeString(pValue, strlen(pValue), &m_Buffer) ;
+    AddTimeTag(timeTag) ;
+}
+
+void InputBatchWriter::AddIntWME(char const* pID, char const* pAttribute, int64_t value, int64_t timeTag)
+{
+    AddChange(InputBatch::kAddInt, pID, pAttribute) ;
+    InputBatchAddInt(value, &m_Buffer) ;
+    AddTimeTag(timeTag) ;
+}
+
+void InputBatchWriter::AddDoubleWME(char const* pID, char const* pAttribute, double value, int64_t timeTag)
+{
+    AddChange(InputBatch::kAddDouble, pID, pAttribute) ;
+    
+    uint64_t bits = 0 ;
+    memcpy(&bits, &value, sizeof(bits)) ;
+    
+    for (int i = 0 ; i < 8 ; i++)
+    {
+        m_Buffer.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF)) ;
+    }
+    
+    AddTimeTag(timeTag) ;
+}
+
+void InputBatchWriter::AddIdWME(char const* pID, char const* pAttribute, char const* pValue, int64_t timeTag)
+{
+    AddChange(InputBatch::kAddId, pID, pAttribute, pValue) ;
+    AddTimeTag(timeTag) ;
+}
+
+void InputBatchWriter::RemoveWME(int64_t timeTag)
+{
+    StartChange() ;
+    m_Buffer.push_back(static_cast<char>(InputBatch::kRemove)) ;
+    AddTimeTag(timeTag) ;
+}
+
+soarxml::ElementXML* InputBatchWriter::CreateBatchTag()
+{
+    soarxml::ElementXML* pTag = new soarxml::ElementXML() ;
+    pTag->SetTagName(sml_Names::kTagWMEBatch) ;
+    pTag->SetBinaryCharacterData(m_Buffer.data(), static_cast<int>(m_Buffer.size())) ;
+    
+    m_Buffer.clear() ;
+    m_Size = 0 ;
+    
+    return pTag ;
+}
+
+char const* InputBatchReader::ReadHandle(char const*& pData, char const* pEnd)
+{
+    uint64_t handle = 0 ;
+    
+    if (!BinarySML::DecodeVarint(pData, pEnd, &handle) || handle >= m_Handles.size())
+    {
+        return NULL ;
+    }
+    
+    return m_Handles[static_cast<size_t>(handle)].c_str() ;
+}
+
+bool InputBatchReader::Read(char const* pData, size_t length, std::vector<InputBatchChange>* pChanges)
+{
+    m_Values.clear() ;
+    
+    char const* pEnd = pData + length ;
+    
+    if (length == 0 || static_cast<unsigned char>(*pData++) != InputBatch::kVersion)
+    {
+        return false ;
+    }
+    
+    bool first = true ;
+    
+    while (pData < pEnd)
+    {
+        int type = static_cast<unsigned char>(*pData++) ;
+        
+        InputBatchChange change ;
+        memset(&change, 0, sizeof(change)) ;
+        change.m_Type = type ;
+        
+        switch (type)
+        {
+            case InputBatch::kReset:
+                // Strings from earlier in this batch would be lost, so this can only come first
+                if (!first)
+                {
+                    return false ;
+                }
+                m_Handles.clear() ;
+                continue ;
+                
+            case InputBatch::kDefine:
+            {
+                uint64_t len = 0 ;
+                if (!BinarySML::DecodeVarint(pData, pEnd, &len) || len > static_cast<uint64_t>(pEnd - pData))
+                {
+                    return false ;
+                }
+                
+                m_Handles.push_back(std::string(pData, static_cast<size_t>(len))) ;
+                pData += len ;
+                first = false ;
+                continue ;
+            }
+            
+            case InputBatch::kRemove:
+                break ;
+                
+            case InputBatch::kAddString:
+            case InputBatch::kAddInt:
+            case InputBatch::kAddDouble:
+            case InputBatch::kAddId:
+            {
+                change.m_pID = ReadHandle(pData, pEnd) ;
+                change.m_pAttribute = ReadHandle(pData, pEnd) ;
+                
+                if (!change.m_pID || !change.m_pAttribute)
+                {
+                    return false ;
+                }
+                
+                if (type == InputBatch::kAddString)
+                {
+                    uint64_t len = 0 ;
+                    if (!BinarySML::DecodeVarint(pData, pEnd, &len) || len > static_cast<uint64_t>(pEnd - pData))
+                    {
+                        return false ;
+                    }
+                    
+                    m_Values.push_back(std::string(pData, static_cast<size_t>(len))) ;
+                    change.m_pValue = m_Values.back().c_str() ;
+                    pData += len ;
+                }
+                else if (type == InputBatch::kAddInt)
+                {
+                    if (!InputBatchReadInt(pData, pEnd, &change.m_IntValue))
+                    {
+                        return false ;
+                    }
+                }
+                else if (type == InputBatch::kAddDouble)
+                {
+                    if (pEnd - pData < 8)
+                    {
+                        return false ;
+                    }
+                    
+                    uint64_t bits = 0 ;
+                    for (int i = 0 ; i < 8 ; i++)
+                    {
+                        bits |= static_cast<uint64_t>(static_cast<unsigned char>(*pData++)) << (8 * i) ;
+                    }
+                    memcpy(&change.m_DoubleValue, &bits, sizeof(bits)) ;
+                }
+                else
+                {
+                    change.m_pValue = ReadHandle(pData, pEnd) ;
+                    
+                    if (!change.m_pValue)
+                    {
+                        return false ;
+                    }
+                }
+                break ;
+            }
+            
+            default:
+                return false ;
+        }
+        
+        if (!InputBatchReadInt(pData, pEnd, &change.m_TimeTag))
+        {
+            return false ;
+        }
+        
+        pChanges->push_back(change) ;
+        first = false ;
+    }
+    
+    return true ;
+}
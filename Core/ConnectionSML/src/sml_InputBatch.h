@@ -0,0 +1,150 @@
+/////////////////////////////////////////////////////////////////
+// InputBatch classes
+//
+// A compact format for sending a set of input-link changes to the kernel.
+//
+// Normally WorkingMemory::Commit() sends one <wme> tag per change, each with
+// string ids, attributes, values and timetags that the kernel then has to look
+// up one attribute at a time.  Over a remote connection, once the kernel has said
+// it understands batches, the client sends all of the changes as one block of
+// binary data instead (the character data of a single <wme_batch> tag):
+//
+//  batch   := kVersion change*
+//  change  := kDefine string                       (gives the string the next handle)
+//           | kAddString id attr string timetag
+//           | kAddInt    id attr zigzag timetag
+//           | kAddDouble id attr 8 byte double timetag
+//           | kAddId     id attr handle timetag
+//           | kRemove    timetag
+//           | kReset                               (forget all handles)
+//  id, attr, handle := varint handle
+//  timetag := zigzag varint
+//
+// Identifiers and attributes are sent as integer handles.  A handle is defined
+// the first time the string is used and both sides keep the table for the
+// life of the connection, so later batches refer to it with a byte or two.
+// (String values are sent in full, as they are often unique).
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SML_INPUT_BATCH_H
+#define SML_INPUT_BATCH_H
+
+#include "Export.h"
+#include "portability.h"
+
+#include <string>
+#include <map>
+#include <deque>
+#include <vector>
+
+namespace soarxml
+{
+    class ElementXML ;
+}
+
+namespace sml
+{
+
+    class EXPORT InputBatch
+    {
+        public:
+            enum { kVersion = 1 } ;
+            
+            enum ChangeType { kDefine = 1, kAddString, kAddInt, kAddDouble, kAddId, kRemove, kReset } ;
+            
+            // When the client's table gets this large it starts again at the beginning of the next batch
+            // (with a kReset), so neither side's table grows without limit.
+            enum { kMaxHandles = 65536 } ;
+    } ;
+    
+    /*************************************************************
+    * @brief Builds batches on the client side.
+    *************************************************************/
+    class EXPORT InputBatchWriter
+    {
+        public:
+            InputBatchWriter() ;
+            
+            void AddStringWME(char const* pID, char const* pAttribute, char const* pValue, int64_t timeTag) ;
+            void AddIntWME(char const* pID, char const* pAttribute, int64_t value, int64_t timeTag) ;
+            void AddDoubleWME(char const* pID, char const* pAttribute, double value, int64_t timeTag) ;
+            void AddIdWME(char const* pID, char const* pAttribute, char const* pValue, int64_t timeTag) ;
+            void RemoveWME(int64_t timeTag) ;
+            
+            // The number of changes in the current batch
+            int GetSize() const
+            {
+                return m_Size ;
+            }
+            
+            /*************************************************************
+            * @brief Returns a new <wme_batch> tag holding the current batch
+            *        (which the caller must delete) and starts a new batch.
+            *        The handle table is kept for the next batch.
+            *************************************************************/
+            soarxml::ElementXML* CreateBatchTag() ;
+            
+            /*************************************************************
+            * @brief Throws away the current batch without sending it.
+            *        The handle table is reset too, as the batch may have defined handles.
+            *************************************************************/
+            void Clear() ;
+            
+        protected:
+            std::string                 m_Buffer ;
+            int                         m_Size ;
+            std::map<std::string, int>  m_Handles ;
+            bool                        m_NeedsReset ;
+            
+            void StartChange() ;
+            int  GetHandle(char const* pStr) ;
+            void AddChange(int type, char const* pID, char const* pAttribute, char const* pIdValue = NULL) ;
+            void AddTimeTag(int64_t timeTag) ;
+    } ;
+    
+    /*************************************************************
+    * @brief One change read back out of a batch.
+    *        The strings belong to the InputBatchReader.
+    *************************************************************/
+    struct InputBatchChange
+    {
+        int         m_Type ;
+        char const* m_pID ;
+        char const* m_pAttribute ;
+        char const* m_pValue ;          // kAddString and kAddId
+        int64_t     m_IntValue ;        // kAddInt
+        double      m_DoubleValue ;     // kAddDouble
+        int64_t     m_TimeTag ;
+    } ;
+    
+    /*************************************************************
+    * @brief Reads batches on the kernel side.
+    *        There needs to be one reader for each writer (i.e. for each
+    *        connection and agent), as it holds that writer's handle table.
+    *************************************************************/
+    class EXPORT InputBatchReader
+    {
+        public:
+            /*************************************************************
+            * @brief Decodes a batch, adding its changes to pChanges.
+            *
+            * The string values in the changes are only valid until the next call.
+            *
+            * @returns false if the data is not a valid batch.
+            *************************************************************/
+            bool Read(char const* pData, size_t length, std::vector<InputBatchChange>* pChanges) ;
+            
+        protected:
+            // A deque so adding a handle doesn't move the strings we've already handed out
+            std::deque<std::string> m_Handles ;
+            
+            // String values for the current batch
+            std::deque<std::string> m_Values ;
+            
+            char const* ReadHandle(char const*& pData, char const* pEnd) ;
+    } ;
+    
+} // End of namespace
+
+#endif // SML_INPUT_BATCH_H
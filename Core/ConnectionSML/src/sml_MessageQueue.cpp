@@ -0,0 +1,119 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// MessageQueue class
+//
+// A lock free queue of incoming messages (many threads push, one pops).
+// See sml_MessageQueue.h.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "sml_MessageQueue.h"
+#include "ElementXML.h"
+
+using namespace sml ;
+
+MessageQueue::MessageQueue()
+{
+    m_Stub.m_pNext = NULL ;
+    m_Stub.m_pMsg  = NULL ;
+    m_pHead = &m_Stub ;
+    m_pTail = &m_Stub ;
+    m_Count = 0 ;
+}
+
+MessageQueue::~MessageQueue()
+{
+    soarxml::ElementXML* pMsg ;
+    
+    while ((pMsg = Pop()) != NULL)
+    {
+        delete pMsg ;
+    }
+}
+
+void MessageQueue::PushNode(Node* pNode)
+{
+    pNode->m_pNext = NULL ;
+    
+    // The exchange is a full barrier, so the node is complete before anyone can reach it
+    Node* pPrev = static_cast<Node*>(atomic_exchange_ptr(reinterpret_cast<void* volatile*>(&m_pHead), pNode)) ;
+    pPrev->m_pNext = pNode ;
+}
+
+soarxml::ElementXML* MessageQueue::TakeNode(Node* pNode)
+{
+    // Make sure we see the message the producer stored before linking the node in
+    memory_barrier() ;
+    
+    soarxml::ElementXML* pMsg = pNode->m_pMsg ;
+    delete pNode ;
+    
+    atomic_dec(&m_Count) ;
+    
+    return pMsg ;
+}
+
+void MessageQueue::Push(soarxml::ElementXML* pMsg)
+{
+#ifndef HAVE_ATOMICS
+    soar_thread::Lock lock(&m_Mutex) ;
+#endif
+
+    Node* pNode = new Node() ;
+    pNode->m_pMsg = pMsg ;
+    
+    // Counted first so IsEmpty() is never true while a message is on its way in
+    atomic_inc(&m_Count) ;
+    
+    PushNode(pNode) ;
+}
+
+soarxml::ElementXML* MessageQueue::Pop()
+{
+#ifndef HAVE_ATOMICS
+    soar_thread::Lock lock(&m_Mutex) ;
+#endif
+
+    Node* pTail = m_pTail ;
+    Node* pNext = pTail->m_pNext ;
+    
+    // Step over the stub
+    if (pTail == &m_Stub)
+    {
+        if (!pNext)
+        {
+            return NULL ;
+        }
+        
+        m_pTail = pNext ;
+        pTail = pNext ;
+        pNext = pNext->m_pNext ;
+    }
+    
+    if (pNext)
+    {
+        m_pTail = pNext ;
+        return TakeNode(pTail) ;
+    }
+    
+    // pTail is the last node we can reach.  If it isn't the head a push is half done,
+    // so leave it for the next call.
+    if (pTail != m_pHead)
+    {
+        return NULL ;
+    }
+    
+    // Otherwise put the stub back behind it, so we can take it without emptying the list
+    PushNode(&m_Stub) ;
+    
+    pNext = pTail->m_pNext ;
+    
+    if (pNext)
+    {
+        m_pTail = pNext ;
+        return TakeNode(pTail) ;
+    }
+    
+    return NULL ;
+}
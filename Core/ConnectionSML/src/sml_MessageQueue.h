@@ -0,0 +1,89 @@
+/////////////////////////////////////////////////////////////////
+// MessageQueue class
+//
+// The queue of incoming messages an asynchronous embedded connection
+// keeps for the thread that will execute them.
+//
+// Any number of threads can push onto it without taking a lock (each push
+// is one atomic exchange), so the client threads sending commands and the
+// kernel thread sending back responses no longer wait on the thread that's
+// reading the queue or on each other.  Only one thread may pop at a time,
+// which the connection already guarantees by holding its client mutex
+// while it reads messages.
+//
+// This is the usual intrusive multiple-producer, single-consumer queue:
+// producers swap themselves into the head and then link the old head to
+// them, while the consumer follows the links from the tail.  Between those
+// two steps the new message is briefly invisible, so Pop() can return NULL
+// while a push is still finishing (it'll be there on the next call).
+//
+// Without atomics (see portability.h) it falls back to a mutex.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SML_MESSAGE_QUEUE_H
+#define SML_MESSAGE_QUEUE_H
+
+#include "portability.h"
+#include "thread_Lock.h"
+
+namespace soarxml
+{
+    class ElementXML ;
+}
+
+namespace sml
+{
+
+    class MessageQueue
+    {
+        public:
+            MessageQueue() ;
+            
+            // Deletes any messages still in the queue
+            ~MessageQueue() ;
+            
+            // Adds a message to the end of the queue, taking ownership of it.
+            // Can be called from any thread.
+            void Push(soarxml::ElementXML* pMsg) ;
+            
+            // Removes the oldest message (the caller takes ownership) or returns NULL.
+            // Only one thread may call this at a time.
+            soarxml::ElementXML* Pop() ;
+            
+            // True if nothing has been pushed that hasn't been popped yet
+            bool IsEmpty()
+            {
+                return m_Count == 0 ;
+            }
+            
+        protected:
+            struct Node
+            {
+                Node* volatile          m_pNext ;
+                soarxml::ElementXML*    m_pMsg ;
+            } ;
+            
+            // The newest node, swapped by each push
+            Node* volatile  m_pHead ;
+            
+            // The oldest node, only touched by the consumer
+            Node*           m_pTail ;
+            
+            // Stays in the queue so there's always a node to swap (it carries no message)
+            Node            m_Stub ;
+            
+            // Messages pushed but not popped
+            volatile long   m_Count ;
+            
+#ifndef HAVE_ATOMICS
+            soar_thread::Mutex  m_Mutex ;
+#endif
+
+            void PushNode(Node* pNode) ;
+            soarxml::ElementXML* TakeNode(Node* pNode) ;
+    } ;
+    
+} // Namespace
+
+#endif // SML_MESSAGE_QUEUE_H
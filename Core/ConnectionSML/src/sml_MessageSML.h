@@ -43,7 +43,7 @@ namespace sml
             
             void SetDocType(char const* pType)
             {
-                this->AddAttributeFast(sml_Names::kDocType, CopyString(pType), false) ;
+                this->AddAttributeFast(sml_Names::kDocType, pType) ;
             }
             
             char const* GetDocType()
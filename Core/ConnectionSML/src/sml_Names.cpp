@@ -27,6 +27,9 @@ char const* const sml_Names::kDocType_Response  = "response" ;
 char const* const sml_Names::kDocType_Notify    = "notify" ;
 char const* const sml_Names::kSMLVersion        = "smlversion" ;
 char const* const sml_Names::kOutputLinkName    = "output-link" ;
+char const* const sml_Names::kEncoding          = "encoding" ;
+char const* const sml_Names::kEncodingBinary    = "binary" ;
+char const* const sml_Names::kInputBatch        = "input_batch" ;
 
 // Version strings
 char const* const sml_Names::kSoarVersionValue = VERSION_STRING();
@@ -45,11 +48,51 @@ char const* const sml_Names::kConnectionId      = "id" ;
 char const* const sml_Names::kConnectionName    = "name" ;
 char const* const sml_Names::kConnectionStatus  = "status" ;
 char const* const sml_Names::kAgentStatus       = "agent-status" ;
+char const* const sml_Names::kConnectionCount   = "count" ;
+char const* const sml_Names::kConnectionMessagesSent     = "messages-sent" ;
+char const* const sml_Names::kConnectionMessagesReceived = "messages-received" ;
+char const* const sml_Names::kConnectionBytesSent        = "bytes-sent" ;
+char const* const sml_Names::kConnectionBytesReceived    = "bytes-received" ;
+char const* const sml_Names::kConnectionSeconds          = "seconds" ;
+char const* const sml_Names::kConnectionEventDriven      = "event-driven" ;
+char const* const sml_Names::kConnectionQueuedBytes      = "queued-bytes" ;
+char const* const sml_Names::kConnectionPeakQueuedBytes  = "peak-queued-bytes" ;
+char const* const sml_Names::kConnectionSendStalls       = "send-stalls" ;
+char const* const sml_Names::kConnectionBatchedEvents    = "batched-events" ;
+char const* const sml_Names::kConnectionEventBatches     = "event-batches" ;
+char const* const sml_Names::kConnectionDroppedEvents    = "dropped-events" ;
+char const* const sml_Names::kConnectionDroppedBytes     = "dropped-bytes" ;
 char const* const sml_Names::kStatusCreated     = "created" ;   // Initial status -- simply means connection exists
 char const* const sml_Names::kStatusNotReady    = "not-ready" ; // Connection not ready (work needs to be done still)
 char const* const sml_Names::kStatusReady       = "ready" ;     // Connection ready (registered for events etc.)
 char const* const sml_Names::kStatusClosing     = "closing" ;   // Connection about to shut down
 
+char const* const sml_Names::kTagRunThread      = "thread" ;
+char const* const sml_Names::kTagRunAgent       = "agent" ;
+char const* const sml_Names::kRunThreadCount    = "threads" ;
+char const* const sml_Names::kRunPasses         = "passes" ;
+char const* const sml_Names::kRunSeconds        = "seconds" ;
+char const* const sml_Names::kRunSteps          = "steps" ;
+char const* const sml_Names::kRunSteals         = "steals" ;
+char const* const sml_Names::kRunBusySeconds    = "busy-seconds" ;
+char const* const sml_Names::kRunStepSeconds    = "step-seconds" ;
+char const* const sml_Names::kRunLastStepUSec   = "last-step-usec" ;
+char const* const sml_Names::kRunStepCostUSec   = "cost-usec" ;
+
+char const* const sml_Names::kTagLatencyHistogram = "histogram" ;
+char const* const sml_Names::kLatencyCount      = "count" ;
+char const* const sml_Names::kLatencyMeanUSec   = "mean-usec" ;
+char const* const sml_Names::kLatencyP50USec    = "p50-usec" ;
+char const* const sml_Names::kLatencyP90USec    = "p90-usec" ;
+char const* const sml_Names::kLatencyP99USec    = "p99-usec" ;
+char const* const sml_Names::kLatencyP999USec   = "p999-usec" ;
+char const* const sml_Names::kLatencyMaxUSec    = "max-usec" ;
+
+char const* const sml_Names::kTagMemoryUsage    = "memory" ;
+char const* const sml_Names::kMemoryLiveBytes   = "live-bytes" ;
+char const* const sml_Names::kMemoryReservedBytes = "reserved-bytes" ;
+char const* const sml_Names::kMemorySQLiteBytes = "sqlite-bytes" ;
+
 // <arg> tag identifiers
 char const* const sml_Names::kTagArg            = "arg" ;
 char const* const sml_Names::kArgParam          = "param" ;
@@ -125,6 +168,7 @@ char const* const sml_Names::kTagProduction_Retracting  = "retracting_production
 
 // <wme> tag identifiers, also for Watch level 4
 char const* const sml_Names::kTagWME        = "wme" ;
+char const* const sml_Names::kTagWMEBatch   = "wme_batch" ;
 char const* const sml_Names::kWME_TimeTag   = "tag" ;
 char const* const sml_Names::kWME_Id        = "id" ;
 char const* const sml_Names::kWME_Attribute = "attr" ;
@@ -281,6 +325,7 @@ char const* const sml_Names::kParamDecision         = "decision" ;
 char const* const sml_Names::kParamRunState         = "runstate" ;
 char const* const sml_Names::kParamInstance         = "instance" ;
 char const* const sml_Names::kParamTimers           = "timers";
+char const* const sml_Names::kParamPerfCounters     = "perfcounters";
 char const* const sml_Names::kParamMessage          = "message";
 char const* const sml_Names::kParamSelf             = "self" ;
 char const* const sml_Names::kParamAlias            = "alias";
@@ -298,6 +343,9 @@ char const* const sml_Names::kParamChunkNamePrefix  = "chunknameprefix" ;
 char const* const sml_Names::kParamChunkCount       = "chunkcount" ;
 char const* const sml_Names::kParamChunkLongFormat  = "chunklongformat" ;
 char const* const sml_Names::kParamPort             = "port" ;
+char const* const sml_Names::kParamBatchWindow      = "window" ;
+char const* const sml_Names::kParamBatchSize        = "batch-size" ;
+char const* const sml_Names::kParamBacklog          = "backlog" ;
 
 // Source command parameters
 char const* const sml_Names::kParamSourcedProductionCount   = "sourced-production-count";
@@ -435,6 +483,12 @@ char const* const sml_Names::kCommand_Shutdown              = "shutdown" ;
 char const* const sml_Names::kCommand_GetVersion            = "version" ;
 char const* const sml_Names::kCommand_IsSoarRunning         = "is_running" ;
 char const* const sml_Names::kCommand_GetConnections        = "get_connections" ;
+char const* const sml_Names::kCommand_GetConnectionStats    = "get_connection_stats" ;
+char const* const sml_Names::kCommand_SetEventBatching      = "set_event_batching" ;
+char const* const sml_Names::kCommand_SetRunThreads         = "set_run_threads" ;
+char const* const sml_Names::kCommand_GetRunThreadStats     = "get_run_thread_stats" ;
+char const* const sml_Names::kCommand_GetLatencyStats       = "get_latency_stats" ;
+char const* const sml_Names::kCommand_GetMemoryStats        = "get_memory_stats" ;
 char const* const sml_Names::kCommand_SetConnectionInfo     = "set_connection_info" ;
 char const* const sml_Names::kCommand_GetAllInput           = "get_all_input" ;
 char const* const sml_Names::kCommand_GetAllOutput          = "get_all_output" ;
@@ -29,6 +29,9 @@ namespace sml
             static char const* const kDocType_Notify ;
             static char const* const kSMLVersion ;
             static char const* const kOutputLinkName ;
+            static char const* const kEncoding ;
+            static char const* const kEncodingBinary ;
+            static char const* const kInputBatch ;
             
             static const char* const kSoarVersionValue;
             static const char* const kSMLVersionValue;
@@ -46,11 +49,54 @@ namespace sml
             static char const* const kConnectionName ;
             static char const* const kConnectionStatus ;
             static char const* const kAgentStatus ;
+            static char const* const kConnectionCount ;
+            static char const* const kConnectionMessagesSent ;
+            static char const* const kConnectionMessagesReceived ;
+            static char const* const kConnectionBytesSent ;
+            static char const* const kConnectionBytesReceived ;
+            static char const* const kConnectionSeconds ;
+            static char const* const kConnectionEventDriven ;
+            static char const* const kConnectionQueuedBytes ;
+            static char const* const kConnectionPeakQueuedBytes ;
+            static char const* const kConnectionSendStalls ;
+            static char const* const kConnectionBatchedEvents ;
+            static char const* const kConnectionEventBatches ;
+            static char const* const kConnectionDroppedEvents ;
+            static char const* const kConnectionDroppedBytes ;
             static char const* const kStatusCreated ;   // Initial status -- simply means connection exists
             static char const* const kStatusNotReady ;  // Connection not ready (work needs to be done still)
             static char const* const kStatusReady ;     // Connection ready (registered for events etc.)
             static char const* const kStatusClosing ;   // Connection about to shut down
             
+            // get_run_thread_stats tags and attributes
+            static char const* const kTagRunThread ;
+            static char const* const kTagRunAgent ;
+            static char const* const kRunThreadCount ;
+            static char const* const kRunPasses ;
+            static char const* const kRunSeconds ;
+            static char const* const kRunSteps ;
+            static char const* const kRunSteals ;
+            static char const* const kRunBusySeconds ;
+            static char const* const kRunStepSeconds ;
+            static char const* const kRunLastStepUSec ;
+            static char const* const kRunStepCostUSec ;
+            
+            // get_latency_stats tags and attributes
+            static char const* const kTagLatencyHistogram ;
+            static char const* const kLatencyCount ;
+            static char const* const kLatencyMeanUSec ;
+            static char const* const kLatencyP50USec ;
+            static char const* const kLatencyP90USec ;
+            static char const* const kLatencyP99USec ;
+            static char const* const kLatencyP999USec ;
+            static char const* const kLatencyMaxUSec ;
+            
+            // get_memory_stats tags and attributes
+            static char const* const kTagMemoryUsage ;
+            static char const* const kMemoryLiveBytes ;
+            static char const* const kMemoryReservedBytes ;
+            static char const* const kMemorySQLiteBytes ;
+            
             // <arg> tag identifiers
             static char const* const kTagArg ;
             static char const* const kArgParam ;
@@ -123,6 +169,7 @@ namespace sml
             
             // <wme> tag identifiers, also Watch level 4
             static char const* const kTagWME ;
+            static char const* const kTagWMEBatch ;
             static char const* const kWME_TimeTag ;
             static char const* const kWME_Id ;
             static char const* const kWME_Attribute ;
@@ -279,6 +326,7 @@ namespace sml
             static char const* const kParamRunState ;
             static char const* const kParamInstance ;
             static char const* const kParamTimers;
+            static char const* const kParamPerfCounters;
             static char const* const kParamMessage;
             static char const* const kParamSelf ;
             static char const* const kParamAlias;
@@ -296,6 +344,9 @@ namespace sml
             static char const* const kParamChunkCount;
             static char const* const kParamChunkLongFormat;
             static char const* const kParamPort;
+            static char const* const kParamBatchWindow ;
+            static char const* const kParamBatchSize ;
+            static char const* const kParamBacklog ;
             
             // Parameter names for source command
             static char const* const kParamSourcedProductionCount;
@@ -425,6 +476,12 @@ namespace sml
             static char const* const kCommand_GetVersion ;
             static char const* const kCommand_IsSoarRunning ;
             static char const* const kCommand_GetConnections ;
+            static char const* const kCommand_GetConnectionStats ;
+            static char const* const kCommand_SetEventBatching ;
+            static char const* const kCommand_SetRunThreads ;
+            static char const* const kCommand_GetRunThreadStats ;
+            static char const* const kCommand_GetLatencyStats ;
+            static char const* const kCommand_GetMemoryStats ;
             static char const* const kCommand_SetConnectionInfo ;
             static char const* const kCommand_GetAllInput ;
             static char const* const kCommand_GetAllOutput ;
@@ -17,6 +17,7 @@
 
 #include "sml_Utils.h"
 #include "sml_RemoteConnection.h"
+#include "sml_BinarySML.h"
 #include "sock_Socket.h"
 #include "thread_Thread.h"
 
@@ -30,6 +31,8 @@ RemoteConnection::RemoteConnection(bool sharedFileSystem, sock::DataSender* pDat
     m_SharedFileSystem = sharedFileSystem ;
     m_DataSender = pDataSender ;
     m_pLastResponse = NULL ;
+    m_bBinaryEnabled = true ;
+    m_bPeerBinary = false ;
 }
 
 RemoteConnection::~RemoteConnection()
@@ -169,7 +172,13 @@ bool RemoteConnection::DoesResponseMatch(ElementXML* pResponse, char const* pID)
 * @brief Send a message to the other side of this connection.
 *
 * For an remote connection this is done by sending the command
-* over a socket as an actual XML string.
+* over a socket as an actual XML string, or in the binary SML
+* encoding once we know the other side can read it.
+*
+* Until then we advertise that we can read binary SML by adding
+* an "encoding" attribute to the XML messages we send.  Older
+* clients and kernels ignore the attribute and will never send
+* us binary, so both sides stay with XML.
 *
 * There is no immediate response because we have to wait for
 * the other side to read from the socket and execute the command.
@@ -180,28 +189,55 @@ void RemoteConnection::SendMsg(ElementXML* pMsg)
 {
     ClearError() ;
     
-    // Convert the message to an XML string
-    char* pXMLString = pMsg->GenerateXMLString(true) ;
-    
-    // Send it
-    bool ok = m_DataSender->SendString(pXMLString) ;
+    bool ok = true ;
     
-    // Dump the message if we're tracing
-    if (m_bTraceCommunications)
+    if (m_bBinaryEnabled && m_bPeerBinary)
     {
-        if (IsKernelSide())
+        std::string buffer ;
+        BinarySML::Encode(pMsg, &buffer) ;
+        
+        // Send it
+        ok = m_DataSender->SendData(buffer.data(), static_cast<uint32_t>(buffer.size())) ;
+        
+        // Dump the message if we're tracing (converting it to XML just for the trace)
+        if (m_bTraceCommunications)
         {
-            sml::PrintDebugFormat("Kernel remote send: %s\n", pXMLString) ;
+            char* pXMLString = pMsg->GenerateXMLString(true) ;
+            sml::PrintDebugFormat("%s remote send (binary, %u bytes): %s\n", IsKernelSide() ? "Kernel" : "Client", static_cast<unsigned int>(buffer.size()), pXMLString) ;
+            pMsg->DeleteString(pXMLString) ;
         }
-        else
+    }
+    else
+    {
+        // Let the other side know we can read binary messages
+        if (m_bBinaryEnabled && !pMsg->GetAttribute(sml_Names::kEncoding))
+        {
+            pMsg->AddAttribute(sml_Names::kEncoding, sml_Names::kEncodingBinary) ;
+        }
+        
+        // Convert the message to an XML string
+        char* pXMLString = pMsg->GenerateXMLString(true) ;
+        
+        // Send it
+        ok = m_DataSender->SendString(pXMLString) ;
+        
+        // Dump the message if we're tracing
+        if (m_bTraceCommunications)
         {
-            sml::PrintDebugFormat("Client remote send: %s\n", pXMLString) ;
+            if (IsKernelSide())
+            {
+                sml::PrintDebugFormat("Kernel remote send: %s\n", pXMLString) ;
+            }
+            else
+            {
+                sml::PrintDebugFormat("Client remote send: %s\n", pXMLString) ;
+            }
         }
+        
+        // Release the XML string
+        pMsg->DeleteString(pXMLString) ;
     }
     
-    // Release the XML string
-    pMsg->DeleteString(pXMLString) ;
-    
     // If we had an error close the connection
     if (!ok)
     {
@@ -353,26 +389,60 @@ bool RemoteConnection::ReceiveMessages(bool allMessages, int secondsWait, int mi
             return receivedMessage ;
         }
         
-        // Dump the message if we're tracing
-        if (m_bTraceCommunications)
+        ElementXML* pIncomingMsg = NULL ;
+        
+        if (BinarySML::IsBinary(xmlString.data(), xmlString.size()))
         {
-            if (IsKernelSide())
+            // Get an XML message from the incoming binary data
+            pIncomingMsg = BinarySML::Decode(xmlString.data(), xmlString.size()) ;
+            
+            if (!pIncomingMsg)
             {
-                sml::PrintDebugFormat("Kernel remote receive: %s\n", xmlString.c_str()) ;
+                this->SetError(Error::kParsingXMLError) ;
+                return receivedMessage ;
             }
-            else
+            
+            // The other side can clearly read binary too
+            m_bPeerBinary = true ;
+            
+            // Dump the message if we're tracing
+            if (m_bTraceCommunications)
             {
-                sml::PrintDebugFormat("Client remote receive: %s\n", xmlString.c_str()) ;
+                char* pXMLString = pIncomingMsg->GenerateXMLString(true) ;
+                sml::PrintDebugFormat("%s remote receive (binary, %u bytes): %s\n", IsKernelSide() ? "Kernel" : "Client", static_cast<unsigned int>(xmlString.size()), pXMLString) ;
+                pIncomingMsg->DeleteString(pXMLString) ;
             }
         }
-        
-        // Get an XML message from the incoming string
-        ElementXML* pIncomingMsg = ElementXML::ParseXMLFromString(xmlString.c_str()) ;
-        
-        if (!pIncomingMsg)
+        else
         {
-            this->SetError(Error::kParsingXMLError) ;
-            return receivedMessage ;
+            // Dump the message if we're tracing
+            if (m_bTraceCommunications)
+            {
+                if (IsKernelSide())
+                {
+                    sml::PrintDebugFormat("Kernel remote receive: %s\n", xmlString.c_str()) ;
+                }
+                else
+                {
+                    sml::PrintDebugFormat("Client remote receive: %s\n", xmlString.c_str()) ;
+                }
+            }
+            
+            // Get an XML message from the incoming string
+            pIncomingMsg = ElementXML::ParseXMLFromString(xmlString.c_str()) ;
+            
+            if (!pIncomingMsg)
+            {
+                this->SetError(Error::kParsingXMLError) ;
+                return receivedMessage ;
+            }
+            
+            // See if the other side is offering the binary encoding
+            char const* pEncoding = pIncomingMsg->GetAttribute(sml_Names::kEncoding) ;
+            if (pEncoding && strcmp(pEncoding, sml_Names::kEncodingBinary) == 0)
+            {
+                m_bPeerBinary = true ;
+            }
         }
         
 #ifdef _DEBUG
@@ -387,9 +457,17 @@ bool RemoteConnection::ReceiveMessages(bool allMessages, int secondsWait, int mi
         // Pass this message back to the client and possibly get their response
         ElementXML* pResponse = this->InvokeCallbacks(pIncomingMsg) ;
         
-        // If we got a response to the incoming message, send that response back.
+        // If we got a response to the incoming message, send that response back
+        // (after any events the command queued, so they arrive first).
         if (pResponse)
         {
+            soar_thread::Lock sendLock(&m_SendMutex) ;
+            
+            if (m_HasOutgoing)
+            {
+                SendQueuedMessages() ;
+            }
+            
             SendMsg(pResponse) ;
         }
         
@@ -419,6 +497,27 @@ void RemoteConnection::SetTraceCommunications(bool state)
     }
 }
 
+void RemoteConnection::SetBinaryEncoding(bool state)
+{
+    m_bBinaryEnabled = state ;
+}
+
+bool RemoteConnection::IsBinaryEncoding()
+{
+    return m_bBinaryEnabled && m_bPeerBinary ;
+}
+
+bool RemoteConnection::AttachReactor(sock::Reactor* pReactor)
+{
+    return m_DataSender->AttachReactor(pReactor, static_cast<Connection*>(this)) ;
+}
+
+bool RemoteConnection::GetStats(sock::DataSenderStats* pStats)
+{
+    m_DataSender->GetStats(pStats) ;
+    return true ;
+}
+
 void RemoteConnection::CloseConnection()
 {
     m_DataSender->Close() ;
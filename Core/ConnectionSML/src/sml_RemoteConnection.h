@@ -44,6 +44,13 @@ namespace sml
             // breaking of existing code.
             bool m_SharedFileSystem ;
             
+            // Whether we offer the binary SML encoding (see sml_BinarySML.h) to the other side.
+            bool m_bBinaryEnabled ;
+            
+            // Set once the other side has shown it can read binary SML (by advertising it
+            // on an XML message or by sending us a binary message).  Until then we send XML.
+            volatile bool m_bPeerBinary ;
+            
             /** We need to cache the responses to calls **/
             soarxml::ElementXML* m_pLastResponse ;
             
@@ -81,6 +88,10 @@ namespace sml
                 return true ;
             }
             virtual void SetTraceCommunications(bool state) ;
+            virtual void SetBinaryEncoding(bool state) ;
+            virtual bool IsBinaryEncoding() ;
+            virtual bool AttachReactor(sock::Reactor* pReactor) ;
+            virtual bool GetStats(sock::DataSenderStats* pStats) ;
             
     };
     
@@ -25,7 +25,7 @@ namespace sml
             
             void SetParam(char const* pName)
             {
-                this->AddAttributeFast(sml_Names::kArgParam, CopyString(pName), false) ;
+                this->AddAttributeFast(sml_Names::kArgParam, pName) ;
             }
             
             // NOTE: Be careful with this one.  If you call this, you must keep pName in scope
@@ -37,7 +37,7 @@ namespace sml
             
             void SetType(char const* pType)
             {
-                this->AddAttributeFast(sml_Names::kArgType, CopyString(pType), false) ;
+                this->AddAttributeFast(sml_Names::kArgType, pType) ;
             }
             
             // NOTE: Be careful with this one.  If you call this, you must keep pType in scope
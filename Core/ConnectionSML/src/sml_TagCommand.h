@@ -31,7 +31,7 @@ namespace sml
             
             void SetName(char const* pName)
             {
-                this->AddAttributeFast(sml_Names::kCommandName, CopyString(pName), false) ;
+                this->AddAttributeFast(sml_Names::kCommandName, pName) ;
             }
             
             // NOTE: Be careful with this one.  If you call this, you must keep pName in scope
@@ -31,31 +31,31 @@ namespace sml
             
             void SetIdentifier(char const* pIdentifier)
             {
-                this->AddAttributeFast(sml_Names::kWME_Id, CopyString(pIdentifier), false) ;
+                this->AddAttributeFast(sml_Names::kWME_Id, pIdentifier) ;
             }
             
             void SetAttribute(char const* pAttribute)
             {
-                this->AddAttributeFast(sml_Names::kWME_Attribute, CopyString(pAttribute), false) ;
+                this->AddAttributeFast(sml_Names::kWME_Attribute, pAttribute) ;
             }
             
             void SetValue(char const* pValue, char const* pType)
             {
-                this->AddAttributeFast(sml_Names::kWME_Value, CopyString(pValue), false) ;
+                this->AddAttributeFast(sml_Names::kWME_Value, pValue) ;
                 
                 // The string type is the default, so we don't need to add it to the object
                 // We do a direct pointer comparison here for speed, so if the user passes in "string" without using
                 // sml_Names, we'll add it to the list of attributes (which does no harm).  This all just saves a little time.
                 if (pType && pType != sml_Names::kTypeString)
                 {
-                    this->AddAttributeFast(sml_Names::kWME_ValueType, CopyString(pType), false) ;
+                    this->AddAttributeFast(sml_Names::kWME_ValueType, pType) ;
                 }
             }
             
             void SetTimeTag(int64_t timeTag)
             {
                 char buf[TO_C_STRING_BUFSIZE];
-                this->AddAttributeFast(sml_Names::kWME_TimeTag, CopyString(to_c_string(timeTag, buf)), false) ;
+                this->AddAttributeFast(sml_Names::kWME_TimeTag, to_c_string(timeTag, buf)) ;
             }
             
             void SetActionAdd()
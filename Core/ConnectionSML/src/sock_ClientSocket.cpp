@@ -83,11 +83,12 @@ const char* kLocalHost = "127.0.0.1" ; // Special IP address meaning "this machi
 // Return type    : bool
 // Argument       : char* pNetAddress   // Can be NULL -- in which case connect to "this machine"
 // Argument       : int port
+// Argument       : char const* pLocalSuffix   // If given, only try the local socket with this suffix (see ListenerSocket)
 //
 // Description    : Connect to a server
 //
 /////////////////////////////////////////////////////////////////////
-bool ClientSocket::ConnectToServer(char const* pNetAddress, int port)
+bool ClientSocket::ConnectToServer(char const* pNetAddress, int port, char const* pLocalSuffix)
 {
     CTDEBUG_ENTER_METHOD("ClientSocket::ConnectToServer");
     
@@ -103,7 +104,7 @@ bool ClientSocket::ConnectToServer(char const* pNetAddress, int port)
     {
         memset(&local_address, 0, sizeof(local_address));
         local_address.sun_family = AF_UNIX;
-        sprintf(local_address.sun_path, "%s%d", sock::GetLocalSocketDir().c_str(), port);
+        SNPRINTF(local_address.sun_path, sizeof(local_address.sun_path), "%s%d%s", sock::GetLocalSocketDir().c_str(), port, pLocalSuffix ? pLocalSuffix : "");
         
         // set the name of the datasender
         this->name = "file ";
@@ -133,6 +134,17 @@ bool ClientSocket::ConnectToServer(char const* pNetAddress, int port)
         }
         
     }
+    
+    // Falling back to an internet socket would reach a different listener
+    if (res != 0 && pLocalSuffix)
+    {
+        if (sock != INVALID_SOCKET)
+        {
+            NET_CLOSESOCKET(sock) ;
+        }
+        return false ;
+    }
+    
     if (res != 0)
 #endif
     {
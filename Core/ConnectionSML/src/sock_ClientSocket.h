@@ -17,7 +17,7 @@
 namespace sock
 {
 
-    class ClientSocket : public Socket
+    class EXPORT ClientSocket : public Socket
     {
         public:
             ClientSocket();
@@ -29,11 +29,12 @@ namespace sock
             // Return type    : bool
             // Argument       : char* pNetAddress   // Can be NULL -- in which case connect to "this machine"
             // Argument       : int port
+            // Argument       : char const* pLocalSuffix   // If given, only try the local socket with this suffix (see ListenerSocket)
             //
             // Description    : Connect to a server
             //
             /////////////////////////////////////////////////////////////////////
-            bool    ConnectToServer(char const* netAddress, int port) ;
+            bool    ConnectToServer(char const* netAddress, int port, char const* pLocalSuffix = NULL) ;
     };
     
 } // Namespace
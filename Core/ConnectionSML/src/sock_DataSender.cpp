@@ -17,8 +17,23 @@ using namespace sock ;
 /////////////////////////////////////////////////////////////////////
 bool DataSender::SendString(char const* pString)
 {
-    uint32_t len = static_cast<uint32_t>(strlen(pString));
-    
+    return SendData(pString, static_cast<uint32_t>(strlen(pString))) ;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : DataSender::SendData
+//
+// Return type    : bool
+// Argument       : char const* pData
+// Argument       : uint32_t len
+//
+// Description    : Send a buffer of data to a socket.
+//                  The buffer may contain embedded nulls.
+//                  The outgoing format is the same as SendString.
+//
+/////////////////////////////////////////////////////////////////////
+bool DataSender::SendData(char const* pData, uint32_t len)
+{
     // Convert the value into network byte ordering (so it's compatible if we send it
     // from a big-endian machine to a little endian one or vice-versa).
     uint32_t netLen = htonl(len) ;
@@ -27,7 +42,13 @@ bool DataSender::SendString(char const* pString)
     bool ok = SendBuffer(reinterpret_cast<const char*>(&netLen), sizeof(netLen)) ;
     
     // Now send the string of characters
-    ok = ok && SendBuffer(pString, len) ;
+    ok = ok && SendBuffer(pData, len) ;
+    
+    if (ok)
+    {
+        m_MessagesSent++ ;
+        m_BytesSent += sizeof(netLen) + len ;
+    }
     
     return ok ;
 }
@@ -59,6 +80,11 @@ bool DataSender::ReceiveString(std::string* pString)
     // If we got a zero length string.
     if (len == 0)
     {
+        if (ok)
+        {
+            m_MessagesReceived++ ;
+            m_BytesReceived += sizeof(netLen) ;
+        }
         return ok ;
     }
     
@@ -72,9 +98,13 @@ bool DataSender::ReceiveString(std::string* pString)
     buffer[len] = 0 ;
     
     // Return the result in the string
+    // (using the length so binary messages with embedded nulls come through intact)
     if (ok)
     {
-        pString->assign(buffer) ;
+        pString->assign(buffer, len) ;
+        
+        m_MessagesReceived++ ;
+        m_BytesReceived += sizeof(netLen) + len ;
     }
     
     // Release our temp buffer
@@ -83,6 +113,20 @@ bool DataSender::ReceiveString(std::string* pString)
     return ok ;
 }
 
+void DataSender::GetStats(DataSenderStats* pStats)
+{
+    pStats->m_MessagesSent = m_MessagesSent ;
+    pStats->m_MessagesReceived = m_MessagesReceived ;
+    pStats->m_BytesSent = m_BytesSent ;
+    pStats->m_BytesReceived = m_BytesReceived ;
+    pStats->m_Seconds = static_cast<uint64_t>(time(NULL) - m_CreationTime) ;
+    
+    pStats->m_EventDriven = false ;
+    pStats->m_QueuedBytes = 0 ;
+    pStats->m_PeakQueuedBytes = 0 ;
+    pStats->m_SendStalls = 0 ;
+}
+
 void DataSender::Close()
 {
     soar_thread::Lock lock(&m_CloseMutex);
@@ -24,12 +24,32 @@
 #define DATA_SENDER_H
 
 #include <string>
+#include <time.h>
 #include "thread_Lock.h"
+#include "Export.h"
 
 namespace sock
 {
 
-    class DataSender
+    class Reactor ;
+    
+    // The traffic through a data sender since it was created (see GetStats)
+    struct DataSenderStats
+    {
+        uint64_t    m_MessagesSent ;
+        uint64_t    m_MessagesReceived ;
+        uint64_t    m_BytesSent ;
+        uint64_t    m_BytesReceived ;
+        uint64_t    m_Seconds ;             // How long the data sender has existed
+        
+        // Only used by data senders attached to a reactor (see sock_Reactor.h)
+        bool        m_EventDriven ;
+        uint64_t    m_QueuedBytes ;         // Waiting to be sent right now
+        uint64_t    m_PeakQueuedBytes ;
+        uint64_t    m_SendStalls ;          // Times a sender had to wait for the queue to drain
+    } ;
+
+    class EXPORT DataSender
     {
     
         protected:
@@ -40,11 +60,24 @@ namespace sock
             // The name of this datasender
             std::string name;
             
+            // Counts for GetStats.  These are only updated by the thread sending (or receiving)
+            // so they're not locked, and a reader may see a value that's a moment out of date.
+            uint64_t    m_MessagesSent ;
+            uint64_t    m_MessagesReceived ;
+            uint64_t    m_BytesSent ;
+            uint64_t    m_BytesReceived ;
+            time_t      m_CreationTime ;
+            
             // These objects are created through the ListenerDataSender or ClientDataSender classes.
         protected:
             DataSender()
             {
                 name = "NONAME";
+                m_MessagesSent = 0 ;
+                m_MessagesReceived = 0 ;
+                m_BytesSent = 0 ;
+                m_BytesReceived = 0 ;
+                m_CreationTime = time(NULL) ;
             };
             
         public:
@@ -69,6 +102,16 @@ namespace sock
                 return name;
             }
             
+            // Fill in the traffic through this data sender
+            virtual void GetStats(DataSenderStats* pStats) ;
+            
+            // Ask a reactor to tell us when data arrives, rather than being polled (see sock_Reactor.h).
+            // Returns false if this kind of data sender can't be used with a reactor.
+            virtual bool AttachReactor(Reactor* /*pReactor*/, void* /*pUserData*/)
+            {
+                return false ;
+            }
+            
         public:
             // Print out debug information about the messages we are sending and receiving.
             // NOTE: We still print out information about start up/shut down, errors etc. without this flag being true.
@@ -80,7 +123,11 @@ namespace sock
             // Send a string of characters.  Outgoing format will be "<4-byte length>"+string data
             bool        SendString(char const* pString) ;
             
+            // Send a buffer that may contain embedded nulls (e.g. a binary SML message).  Same format as SendString.
+            bool        SendData(char const* pData, uint32_t length) ;
+            
             // Receive a string of characters.  Incoming format on socket should be "<4-byte length>"+string data
+            // The received data may contain embedded nulls if it was sent with SendData.
             bool        ReceiveString(std::string* pString) ;
             
         protected:
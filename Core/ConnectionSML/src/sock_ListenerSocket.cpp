@@ -36,12 +36,14 @@ ListenerSocket::~ListenerSocket()
 //
 // Return type    : bool
 // Argument       : int port
+// Argument       : bool local
+// Argument       : char const* pLocalSuffix
 //
 // Description    : Create a non-blocking socket that listens
 //                  on a specific port.
 //
 /////////////////////////////////////////////////////////////////////
-bool ListenerSocket::CreateListener(int port, bool local)
+bool ListenerSocket::CreateListener(int port, bool local, char const* pLocalSuffix)
 {
     CTDEBUG_ENTER_METHOD("ListenerSocket::CreateListener");
     
@@ -93,7 +95,7 @@ bool ListenerSocket::CreateListener(int port, bool local)
             // use PID
             port = getpid();
         }
-        sprintf(local_address.sun_path, "%s%d", sock::GetLocalSocketDir().c_str(), port); // buffer is 108 chars long, so this is safe
+        SNPRINTF(local_address.sun_path, sizeof(local_address.sun_path), "%s%d%s", sock::GetLocalSocketDir().c_str(), port, pLocalSuffix);
         
         // set the name of the datasender
         this->name = "file ";
@@ -17,7 +17,7 @@
 namespace sock
 {
 
-    class ListenerSocket : public Socket
+    class EXPORT ListenerSocket : public Socket
     {
         public:
             ListenerSocket() : m_Port(0) {}
@@ -25,7 +25,8 @@ namespace sock
             
             // Creates a listener socket -- used by the server to create connections
             // Pass -1 to listen on any port, -1 and local = true to listen on pid-named local socket
-            bool CreateListener(int port, bool local = false);
+            // pLocalSuffix is added to the name of a local socket's file, so one port can have more than one.
+            bool CreateListener(int port, bool local = false, char const* pLocalSuffix = "");
             
             // Check for an incoming client connection
             // This call does not block.  If there is no pending connection it returns NULL immediately.
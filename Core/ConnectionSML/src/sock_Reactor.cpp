@@ -0,0 +1,242 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// Reactor class
+//
+// Lets the kernel wait on all of its remote sockets at once (with epoll).
+// See sock_Reactor.h.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "sock_Reactor.h"
+
+#ifdef ENABLE_EPOLL
+
+#include "sml_Utils.h"
+#include "sock_Socket.h"
+
+#include <algorithm>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+using namespace sock ;
+
+// The most events we take from the kernel in one call (more just wait for the next one)
+static const int kMaxEvents = 64 ;
+
+Reactor::Reactor()
+{
+    m_EpollHandle = epoll_create(kMaxEvents) ;
+    m_WakeHandle = -1 ;
+    
+    if (m_EpollHandle == -1)
+    {
+        sml::PrintDebug("Error: Unable to create the epoll set, so we'll poll each connection instead") ;
+        return ;
+    }
+    
+    m_WakeHandle = eventfd(0, EFD_NONBLOCK) ;
+    
+    epoll_event event ;
+    memset(&event, 0, sizeof(event)) ;
+    event.events = EPOLLIN ;
+    event.data.fd = m_WakeHandle ;
+    
+    if (m_WakeHandle == -1 || epoll_ctl(m_EpollHandle, EPOLL_CTL_ADD, m_WakeHandle, &event) != 0)
+    {
+        sml::PrintDebug("Error: Unable to create the reactor's wake event, so we'll poll each connection instead") ;
+        
+        if (m_WakeHandle != -1)
+        {
+            close(m_WakeHandle) ;
+            m_WakeHandle = -1 ;
+        }
+        
+        close(m_EpollHandle) ;
+        m_EpollHandle = -1 ;
+    }
+}
+
+Reactor::~Reactor()
+{
+    if (m_WakeHandle != -1)
+    {
+        close(m_WakeHandle) ;
+    }
+    
+    if (m_EpollHandle != -1)
+    {
+        close(m_EpollHandle) ;
+    }
+}
+
+bool Reactor::Control(int op, int handle, bool write)
+{
+    epoll_event event ;
+    memset(&event, 0, sizeof(event)) ;
+    event.events = EPOLLIN | EPOLLRDHUP | (write ? EPOLLOUT : 0) ;
+    event.data.fd = handle ;
+    
+    return epoll_ctl(m_EpollHandle, op, handle, &event) == 0 ;
+}
+
+bool Reactor::Add(Socket* pSocket, void* pUserData)
+{
+    int handle = static_cast<int>(pSocket->GetSocketHandle()) ;
+    
+    if (!IsValid() || handle == NO_CONNECTION)
+    {
+        return false ;
+    }
+    
+    soar_thread::Lock lock(&m_Mutex) ;
+    
+    // A closed socket leaves the epoll set by itself, but its entry stays until the
+    // handle is reused, which is now.
+    if (!Control(EPOLL_CTL_ADD, handle, false))
+    {
+        return false ;
+    }
+    
+    Entry& entry = m_Entries[handle] ;
+    entry.m_pSocket = pSocket ;
+    entry.m_pUserData = pUserData ;
+    entry.m_Write = false ;
+    
+    return true ;
+}
+
+void Reactor::WatchForWrite(Socket* pSocket, bool state)
+{
+    int handle = static_cast<int>(pSocket->GetSocketHandle()) ;
+    
+    soar_thread::Lock lock(&m_Mutex) ;
+    
+    EntryMap::iterator iter = m_Entries.find(handle) ;
+    
+    if (iter == m_Entries.end() || iter->second.m_pSocket != pSocket || iter->second.m_Write == state)
+    {
+        return ;
+    }
+    
+    if (Control(EPOLL_CTL_MOD, handle, state))
+    {
+        iter->second.m_Write = state ;
+    }
+}
+
+void Reactor::Signal(Socket* pSocket)
+{
+    {
+        soar_thread::Lock lock(&m_Mutex) ;
+        
+        EntryMap::iterator iter = m_Entries.find(static_cast<int>(pSocket->GetSocketHandle())) ;
+        
+        if (iter == m_Entries.end() || iter->second.m_pSocket != pSocket)
+        {
+            return ;
+        }
+        
+        m_Signalled.push_back(iter->second.m_pUserData) ;
+    }
+    
+    Wake() ;
+}
+
+void Reactor::Post(void* pUserData)
+{
+    bool wake ;
+    
+    {
+        soar_thread::Lock lock(&m_Mutex) ;
+        
+        if (std::find(m_Signalled.begin(), m_Signalled.end(), pUserData) != m_Signalled.end())
+        {
+            return ;
+        }
+        
+        // If something was already waiting to be reported, Wait() has been woken for it
+        wake = m_Signalled.empty() ;
+        m_Signalled.push_back(pUserData) ;
+    }
+    
+    if (wake)
+    {
+        Wake() ;
+    }
+}
+
+void Reactor::Wake()
+{
+    if (m_WakeHandle == -1)
+    {
+        return ;
+    }
+    
+    uint64_t one = 1 ;
+    ssize_t result = write(m_WakeHandle, &one, sizeof(one)) ;
+    unused(result) ;    // Fails only if the counter is already huge, which still wakes the waiter
+}
+
+void Reactor::Wait(int milliseconds, std::vector<void*>* pReady)
+{
+    if (!IsValid())
+    {
+        sml::Sleep(0, milliseconds < 0 ? 5 : milliseconds) ;
+        return ;
+    }
+    
+    epoll_event events[kMaxEvents] ;
+    int count = epoll_wait(m_EpollHandle, events, kMaxEvents, milliseconds) ;
+    
+    // The sockets we need to send more data on.  We do this after releasing the
+    // lock, as sending can call back into WatchForWrite.
+    std::vector<Socket*> writable ;
+    
+    {
+        soar_thread::Lock lock(&m_Mutex) ;
+        
+        for (int i = 0 ; i < count ; i++)
+        {
+            int handle = events[i].data.fd ;
+            
+            if (handle == m_WakeHandle)
+            {
+                uint64_t value = 0 ;
+                ssize_t result = read(m_WakeHandle, &value, sizeof(value)) ;
+                unused(result) ;
+                continue ;
+            }
+            
+            EntryMap::iterator iter = m_Entries.find(handle) ;
+            
+            if (iter == m_Entries.end())
+            {
+                continue ;
+            }
+            
+            if (events[i].events & EPOLLOUT)
+            {
+                writable.push_back(iter->second.m_pSocket) ;
+            }
+            
+            // A socket that has hung up or failed is reported as having input,
+            // so the read finds out and the connection is closed.
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            {
+                pReady->push_back(iter->second.m_pUserData) ;
+            }
+        }
+        
+        pReady->insert(pReady->end(), m_Signalled.begin(), m_Signalled.end()) ;
+        m_Signalled.clear() ;
+    }
+    
+    for (std::vector<Socket*>::iterator iter = writable.begin() ; iter != writable.end() ; iter++)
+    {
+        (*iter)->SendQueuedData() ;
+    }
+}
+
+#endif // ENABLE_EPOLL
@@ -0,0 +1,96 @@
+/////////////////////////////////////////////////////////////////
+// Reactor class
+//
+// Lets the kernel wait on all of its remote sockets at once (with epoll),
+// rather than checking each one in turn and sleeping in between.
+//
+// Sockets are added with Socket::AttachReactor.  From then on the socket
+// reads whatever has arrived without blocking, keeping any partial message
+// until the rest comes in, and queues what it can't send straight away
+// (see Socket::kMaxQueuedBytes).  The reactor sends queued data on as the
+// socket becomes writable, and Wait() reports which sockets have input.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SOCK_REACTOR_H
+#define SOCK_REACTOR_H
+
+#ifdef ENABLE_EPOLL
+
+#include <map>
+#include <vector>
+
+#include "thread_Lock.h"
+#include "Export.h"
+
+namespace sock
+{
+
+    class Socket ;
+    
+    class EXPORT Reactor
+    {
+        public:
+            Reactor() ;
+            ~Reactor() ;
+            
+            // False if we couldn't create the epoll set (the caller should poll instead)
+            bool IsValid()
+            {
+                return m_EpollHandle != -1 ;
+            }
+            
+            // Watch this socket.  pUserData is what Wait() reports when it has input.
+            // (Sockets leave by themselves when they close).
+            bool Add(Socket* pSocket, void* pUserData) ;
+            
+            // Called by the socket when it starts (or stops) having data queued to send
+            void WatchForWrite(Socket* pSocket, bool state) ;
+            
+            // Report this socket as having input on the next Wait(), even though the
+            // data has already been read from it (into the socket's buffer by another thread).
+            void Signal(Socket* pSocket) ;
+            
+            // Report pUserData as having input on the next Wait().  This is for connections
+            // without a socket (an embedded connection with the kernel in its own thread).
+            void Post(void* pUserData) ;
+            
+            // Wake up a thread that's inside Wait()
+            void Wake() ;
+            
+            /*************************************************************
+            * @brief Waits up to milliseconds (-1 for no limit) for input.
+            *        Sends any queued data on sockets that can take it and
+            *        adds the user data for each socket with input to pReady.
+            *************************************************************/
+            void Wait(int milliseconds, std::vector<void*>* pReady) ;
+            
+        protected:
+            struct Entry
+            {
+                Socket* m_pSocket ;
+                void*   m_pUserData ;
+                bool    m_Write ;
+            } ;
+            
+            // The events only carry the handle, which we look up here.  (A handle can be
+            // reused once its socket closes, so the worst a late event can do is report
+            // the new socket as ready when it isn't).
+            typedef std::map<int, Entry> EntryMap ;
+            
+            int     m_EpollHandle ;
+            int     m_WakeHandle ;      // An eventfd, used by Wake()
+            
+            // Guards m_Entries and m_Signalled
+            soar_thread::Mutex          m_Mutex ;
+            EntryMap                    m_Entries ;
+            std::vector<void*>          m_Signalled ;
+            
+            bool Control(int op, int handle, bool write) ;
+    } ;
+    
+} // Namespace
+
+#endif // ENABLE_EPOLL
+
+#endif // SOCK_REACTOR_H
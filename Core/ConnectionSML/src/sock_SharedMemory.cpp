@@ -0,0 +1,508 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// SharedMemory class
+//
+// A data sender for a client and kernel on the same machine, which passes
+// messages through a pair of ring buffers in a shared memory segment.
+// See sock_SharedMemory.h for how it works.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "sock_SharedMemory.h"
+
+#ifdef ENABLE_SHARED_MEMORY
+
+#include "sml_Utils.h"
+#include "sock_Socket.h"
+#include "sock_ClientSocket.h"
+
+#include <sys/mman.h>
+#include <poll.h>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#endif
+
+using namespace sock ;
+
+char const* const SharedMemory::kHandshakeSuffix = "_shm" ;
+
+namespace sock
+{
+
+    // Each index has a cache line to itself, as the two processes are writing them at the same time.
+    struct SharedMemoryRing
+    {
+        volatile uint32_t   m_Head ;            // Total bytes written (wrapping around)
+        char                m_Pad1[60] ;
+        volatile uint32_t   m_Tail ;            // Total bytes read
+        char                m_Pad2[60] ;
+        volatile uint32_t   m_ReaderWaiting ;   // Set by a reader that is about to sleep on m_Head
+        volatile uint32_t   m_WriterWaiting ;   // Set by a writer that is about to sleep on m_Tail
+        volatile uint32_t   m_Closed ;
+        char                m_Pad3[52] ;
+    } ;
+    
+    // The segment is this header followed by the data for each ring
+    struct SharedMemoryHeader
+    {
+        uint32_t            m_Magic ;
+        uint32_t            m_RingSize ;
+        char                m_Pad[56] ;
+        SharedMemoryRing    m_Rings[2] ;        // Client to kernel, then kernel to client
+    } ;
+    
+} // Namespace
+
+static const uint32_t kSharedMemoryMagic = 0x534d4c31 ;
+
+// How long the kernel waits for a client to send the segment's name, and the client for the reply
+static const int kHandshakeSeconds = 2 ;
+
+// Check this many times for data before going to sleep
+static const int kSpinCount = 2000 ;
+
+// The longest we sleep at once before checking the other process is still there
+#ifdef __linux__
+static const int kSleepMillis = 100 ;
+#else
+static const int kSleepMillis = 1 ;
+#endif
+
+// When we're being polled (rather than asked to wait) only check the socket this often
+static const int kPollsPerSocketCheck = 1000 ;
+
+// Spinning only helps if the other process can be running at the same time
+static int GetSpinCount()
+{
+    static int spinCount = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? kSpinCount : 0 ;
+    return spinCount ;
+}
+
+static size_t SegmentSize()
+{
+    return sizeof(SharedMemoryHeader) + 2 * SharedMemory::kRingSize ;
+}
+
+static inline void SharedMemoryBarrier()
+{
+    __sync_synchronize() ;
+}
+
+// Sleeps until *pAddress no longer holds value (or for at most milliseconds)
+static void SleepOnValue(volatile uint32_t* pAddress, uint32_t value, int milliseconds)
+{
+#ifdef __linux__
+    timespec timeout ;
+    timeout.tv_sec = milliseconds / 1000 ;
+    timeout.tv_nsec = (milliseconds % 1000) * 1000000L ;
+    
+    syscall(SYS_futex, const_cast<uint32_t*>(pAddress), FUTEX_WAIT, value, &timeout, NULL, 0) ;
+#else
+    // There's no portable way to sleep on an address in shared memory, so just poll it
+    unused(pAddress) ;
+    unused(value) ;
+    sml::Sleep(0, milliseconds) ;
+#endif
+}
+
+static void WakeSleepers(volatile uint32_t* pAddress)
+{
+#ifdef __linux__
+    syscall(SYS_futex, const_cast<uint32_t*>(pAddress), FUTEX_WAKE, INT_MAX, NULL, NULL, 0) ;
+#else
+    unused(pAddress) ;
+#endif
+}
+
+SharedMemory::SharedMemory(Socket* pSocket, SharedMemoryHeader* pHeader, bool client)
+{
+    m_bTraceCommunications = false ;
+    
+    m_pSocket = pSocket ;
+    m_pHeader = pHeader ;
+    m_Closed = false ;
+    m_PollCount = 0 ;
+    
+    char* pData = reinterpret_cast<char*>(pHeader + 1) ;
+    int send = client ? 0 : 1 ;
+    
+    m_pSend         = &pHeader->m_Rings[send] ;
+    m_pSendData     = pData + send * kRingSize ;
+    m_pReceive      = &pHeader->m_Rings[1 - send] ;
+    m_pReceiveData  = pData + (1 - send) * kRingSize ;
+    
+    name = "shared memory " + pSocket->GetName() ;
+}
+
+SharedMemory::~SharedMemory()
+{
+    Close() ;
+    
+    munmap(m_pHeader, SegmentSize()) ;
+    delete m_pSocket ;
+}
+
+/*************************************************************
+* @brief Client side: create a segment and ask the kernel to use it.
+*************************************************************/
+SharedMemory* SharedMemory::ConnectToServer(int port)
+{
+    // Older kernels don't have a handshake listener, so don't try to connect (and report an error) if it's not there.
+    std::ostringstream path ;
+    path << GetLocalSocketDir() << port << kHandshakeSuffix ;
+    
+    if (access(path.str().c_str(), F_OK) != 0)
+    {
+        return NULL ;
+    }
+    
+    ClientSocket* pSocket = new ClientSocket() ;
+    
+    if (!pSocket->ConnectToServer(NULL, port, kHandshakeSuffix))
+    {
+        delete pSocket ;
+        return NULL ;
+    }
+    
+    // A name that is unique to this process and connection
+    static uint32_t counter = 0 ;
+    std::ostringstream nameStream ;
+    nameStream << "/soar_sml_" << getpid() << "_" << __sync_fetch_and_add(&counter, 1) ;
+    std::string segmentName = nameStream.str() ;
+    
+    void* pMapping = MAP_FAILED ;
+    
+    int fd = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600) ;
+    if (fd >= 0)
+    {
+        // ftruncate fills the segment with zeros, so the rings start out empty
+        if (ftruncate(fd, SegmentSize()) == 0)
+        {
+            pMapping = mmap(NULL, SegmentSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) ;
+        }
+        close(fd) ;
+    }
+    
+    bool ok = (pMapping != MAP_FAILED) ;
+    
+    SharedMemoryHeader* pHeader = static_cast<SharedMemoryHeader*>(pMapping) ;
+    if (ok)
+    {
+        pHeader->m_Magic = kSharedMemoryMagic ;
+        pHeader->m_RingSize = kRingSize ;
+    }
+    
+    // Ask the kernel to map it too
+    DataSender* pSender = pSocket ;
+    std::string reply ;
+    
+    ok = ok && pSender->SendString(segmentName.c_str()) ;
+    ok = ok && pSocket->IsReadDataAvailable(kHandshakeSeconds, 0) && pSender->ReceiveString(&reply) && reply == "ok" ;
+    
+    // Both sides have mapped the segment by now (or never will), so we don't need the name any more
+    if (fd >= 0)
+    {
+        shm_unlink(segmentName.c_str()) ;
+    }
+    
+    if (!ok)
+    {
+        sml::PrintDebug("Unable to set up a shared memory connection, using a socket instead") ;
+        
+        if (pMapping != MAP_FAILED)
+        {
+            munmap(pMapping, SegmentSize()) ;
+        }
+        delete pSocket ;
+        return NULL ;
+    }
+    
+    return new SharedMemory(pSocket, pHeader, true) ;
+}
+
+/*************************************************************
+* @brief Kernel side: map the segment the client has created.
+*************************************************************/
+SharedMemory* SharedMemory::AcceptClient(Socket* pSocket)
+{
+    DataSender* pSender = pSocket ;
+    std::string segmentName ;
+    
+    bool ok = pSocket->IsReadDataAvailable(kHandshakeSeconds, 0) && pSender->ReceiveString(&segmentName) ;
+    
+    // Only map segments named the way our clients name them
+    ok = ok && segmentName.compare(0, 10, "/soar_sml_") == 0 ;
+    
+    void* pMapping = MAP_FAILED ;
+    
+    if (ok)
+    {
+        int fd = shm_open(segmentName.c_str(), O_RDWR, 0) ;
+        if (fd >= 0)
+        {
+            struct stat info ;
+            if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) == SegmentSize())
+            {
+                pMapping = mmap(NULL, SegmentSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) ;
+            }
+            close(fd) ;
+        }
+    }
+    
+    SharedMemoryHeader* pHeader = static_cast<SharedMemoryHeader*>(pMapping) ;
+    
+    ok = ok && pMapping != MAP_FAILED && pHeader->m_Magic == kSharedMemoryMagic && pHeader->m_RingSize == kRingSize ;
+    ok = ok && pSender->SendString("ok") ;
+    
+    if (!ok)
+    {
+        sml::PrintDebug("Error: Unable to accept a shared memory connection") ;
+        
+        if (pMapping != MAP_FAILED)
+        {
+            munmap(pMapping, SegmentSize()) ;
+        }
+        delete pSocket ;
+        return NULL ;
+    }
+    
+    return new SharedMemory(pSocket, pHeader, false) ;
+}
+
+bool SharedMemory::IsAlive()
+{
+    return !m_Closed ;
+}
+
+/*************************************************************
+* @brief Notices if the other side has closed the connection
+*        (or its process has gone away, closing the handshake socket).
+*************************************************************/
+bool SharedMemory::CheckPeerAlive(bool checkSocket)
+{
+    if (!m_Closed && (m_pSend->m_Closed || m_pReceive->m_Closed))
+    {
+        m_Closed = true ;
+    }
+    
+    if (!m_Closed && checkSocket)
+    {
+        // Nothing more is sent on the socket after the handshake, so if it's readable it has been closed
+        pollfd fd ;
+        fd.fd = m_pSocket->GetSocketHandle() ;
+        fd.events = POLLIN ;
+        fd.revents = 0 ;
+        
+        if (poll(&fd, 1, 0) != 0)
+        {
+            m_Closed = true ;
+        }
+    }
+    
+    return !m_Closed ;
+}
+
+/*************************************************************
+* @brief Waits until *pIndex no longer holds value, the connection
+*        closes or the time runs out.
+*
+* @returns true if the index changed.
+*************************************************************/
+bool SharedMemory::WaitForChange(volatile uint32_t* pIndex, volatile uint32_t* pWaiting, uint32_t value, int milliseconds)
+{
+    // The other side is often just about to answer, so spin for a moment before paying for a sleep
+    int spinCount = GetSpinCount() ;
+    for (int i = 0 ; i < spinCount ; i++)
+    {
+        if (*pIndex != value)
+        {
+            return true ;
+        }
+    }
+    
+    while (milliseconds > 0 && CheckPeerAlive(false))
+    {
+        *pWaiting = 1 ;
+        SharedMemoryBarrier() ;
+        
+        // Check again now the other side can see we're waiting, or we could sleep through its wake up call
+        if (*pIndex != value)
+        {
+            return true ;
+        }
+        
+        int sleep = (milliseconds < kSleepMillis) ? milliseconds : kSleepMillis ;
+        SleepOnValue(pIndex, value, sleep) ;
+        milliseconds -= sleep ;
+        
+        if (*pIndex != value)
+        {
+            return true ;
+        }
+        
+        CheckPeerAlive(true) ;
+    }
+    
+    return *pIndex != value ;
+}
+
+bool SharedMemory::IsReadDataAvailable(int secondsWait, int millisecondsWait)
+{
+    uint32_t head = m_pReceive->m_Head ;
+    
+    if (head != m_pReceive->m_Tail)
+    {
+        return true ;
+    }
+    
+    int milliseconds = secondsWait * 1000 + millisecondsWait ;
+    
+    if (milliseconds == 0)
+    {
+        // The kernel polls its connections continually, so keep this to a couple of memory reads
+        return !CheckPeerAlive(++m_PollCount % kPollsPerSocketCheck == 0) ;
+    }
+    
+    return WaitForChange(&m_pReceive->m_Head, &m_pReceive->m_ReaderWaiting, head, milliseconds) || m_Closed ;
+}
+
+bool SharedMemory::SendBuffer(char const* pSendBuffer, uint32_t bufferSize)
+{
+    SharedMemoryRing* pRing = m_pSend ;
+    
+    while (bufferSize > 0)
+    {
+        if (m_Closed)
+        {
+            if (m_bTraceCommunications)
+            {
+                sml::PrintDebug("Error: Can't send because this shared memory connection is closed") ;
+            }
+            return false ;
+        }
+        
+        uint32_t head = pRing->m_Head ;
+        uint32_t tail = pRing->m_Tail ;
+        SharedMemoryBarrier() ;
+        
+        uint32_t space = kRingSize - (head - tail) ;
+        
+        if (space == 0)
+        {
+            // Wait for the reader to make some room
+            WaitForChange(&pRing->m_Tail, &pRing->m_WriterWaiting, tail, kSleepMillis) ;
+            continue ;
+        }
+        
+        uint32_t count  = (bufferSize < space) ? bufferSize : space ;
+        uint32_t offset = head & (kRingSize - 1) ;
+        uint32_t first  = (count < kRingSize - offset) ? count : kRingSize - offset ;
+        
+        memcpy(m_pSendData + offset, pSendBuffer, first) ;
+        memcpy(m_pSendData, pSendBuffer + first, count - first) ;
+        
+        // The data has to be visible before the reader sees the new head
+        SharedMemoryBarrier() ;
+        pRing->m_Head = head + count ;
+        SharedMemoryBarrier() ;
+        
+        if (pRing->m_ReaderWaiting)
+        {
+            pRing->m_ReaderWaiting = 0 ;
+            WakeSleepers(&pRing->m_Head) ;
+        }
+        
+        pSendBuffer += count ;
+        bufferSize  -= count ;
+    }
+    
+    return true ;
+}
+
+bool SharedMemory::ReceiveBuffer(char* pRecvBuffer, uint32_t bufferSize)
+{
+    SharedMemoryRing* pRing = m_pReceive ;
+    
+    while (bufferSize > 0)
+    {
+        uint32_t tail = pRing->m_Tail ;
+        uint32_t head = pRing->m_Head ;
+        SharedMemoryBarrier() ;
+        
+        uint32_t available = head - tail ;
+        
+        if (available == 0)
+        {
+            if (!CheckPeerAlive(false))
+            {
+                // The other side may have sent more between our reading the head and
+                // seeing it close, so look again: anything sent before it closed is still ours
+                SharedMemoryBarrier() ;
+                if (pRing->m_Head != tail)
+                {
+                    continue ;
+                }
+                
+                if (m_bTraceCommunications)
+                {
+                    sml::PrintDebug("Error: Shared memory connection closed while we were reading") ;
+                }
+                return false ;
+            }
+            
+            WaitForChange(&pRing->m_Head, &pRing->m_ReaderWaiting, head, kSleepMillis) ;
+            continue ;
+        }
+        
+        uint32_t count  = (bufferSize < available) ? bufferSize : available ;
+        uint32_t offset = tail & (kRingSize - 1) ;
+        uint32_t first  = (count < kRingSize - offset) ? count : kRingSize - offset ;
+        
+        memcpy(pRecvBuffer, m_pReceiveData + offset, first) ;
+        memcpy(pRecvBuffer + first, m_pReceiveData, count - first) ;
+        
+        // We have to finish copying before the writer can reuse the space
+        SharedMemoryBarrier() ;
+        pRing->m_Tail = tail + count ;
+        SharedMemoryBarrier() ;
+        
+        if (pRing->m_WriterWaiting)
+        {
+            pRing->m_WriterWaiting = 0 ;
+            WakeSleepers(&pRing->m_Tail) ;
+        }
+        
+        pRecvBuffer += count ;
+        bufferSize  -= count ;
+    }
+    
+    return true ;
+}
+
+void SharedMemory::CloseInternal()
+{
+    if (!m_pHeader)
+    {
+        return ;
+    }
+    
+    // Let the other side know, waking it if it's asleep.
+    // (The segment itself stays mapped until we're deleted, in case another thread is still using it).
+    for (int i = 0 ; i < 2 ; i++)
+    {
+        SharedMemoryRing* pRing = &m_pHeader->m_Rings[i] ;
+        pRing->m_Closed = 1 ;
+        SharedMemoryBarrier() ;
+        WakeSleepers(&pRing->m_Head) ;
+        WakeSleepers(&pRing->m_Tail) ;
+    }
+    
+    m_Closed = true ;
+    
+    m_pSocket->Close() ;
+}
+
+#endif // ENABLE_SHARED_MEMORY
@@ -0,0 +1,102 @@
+/////////////////////////////////////////////////////////////////
+// SharedMemory class
+//
+// A data sender for a client and kernel on the same machine, which passes
+// messages through a pair of ring buffers in a shared memory segment
+// rather than through a socket.
+//
+// The client creates the segment and then asks the kernel to use it over a
+// "handshake" socket.  The kernel listens for these on a local socket of its
+// own (next to the usual one, see kHandshakeSuffix) so older clients never see
+// any of this.  Once the kernel has agreed, the socket is only kept so that
+// each side notices if the other process goes away.
+//
+// Each ring has a single writer and a single reader.  The writer copies bytes
+// in and then moves the head on, the reader copies them out and moves the
+// tail on, so neither needs a lock.  A side that finds its ring empty (or full)
+// spins for a moment and then sleeps on the index it's waiting for (a futex on
+// Linux, short sleeps elsewhere).  The other side only makes the system call
+// to wake it when it knows someone is asleep.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#ifdef ENABLE_SHARED_MEMORY
+
+#include <string>
+
+#include "sock_DataSender.h"
+
+namespace sock
+{
+
+    class Socket ;
+    struct SharedMemoryRing ;
+    struct SharedMemoryHeader ;
+    
+    class EXPORT SharedMemory : public DataSender
+    {
+        public:
+            // The size of each ring.  Larger messages are streamed through it.
+            enum { kRingSize = 1 << 20 } ;
+            
+            // Added to the name of the kernel's local socket for the handshake listener
+            static char const* const kHandshakeSuffix ;
+            
+            /*************************************************************
+            * @brief Client side.  Creates a segment and asks the kernel
+            *        listening on this port to use it.
+            *
+            * @returns NULL if the kernel isn't listening for shared memory
+            *          connections (the caller should use a socket instead).
+            *************************************************************/
+            static SharedMemory* ConnectToServer(int port) ;
+            
+            /*************************************************************
+            * @brief Kernel side.  Completes the handshake on a socket that
+            *        connected to the handshake listener.
+            *        Takes ownership of the socket (deleting it if this fails).
+            *************************************************************/
+            static SharedMemory* AcceptClient(Socket* pSocket) ;
+            
+            virtual ~SharedMemory() ;
+            
+            bool IsAlive() ;
+            
+            // Returns true if data is waiting (or the connection has closed, so the next read will fail).
+            // Waits for up to secondsWait + millisecondsWait for data to arrive.
+            bool IsReadDataAvailable(int secondsWait = 0, int millisecondsWait = 0) ;
+            
+        protected:
+            SharedMemory(Socket* pSocket, SharedMemoryHeader* pHeader, bool client) ;
+            
+            virtual bool SendBuffer(char const* pSendBuffer, uint32_t bufferSize) ;
+            virtual bool ReceiveBuffer(char* pRecvBuffer, uint32_t bufferSize) ;
+            virtual void CloseInternal() ;
+            
+            bool WaitForChange(volatile uint32_t* pIndex, volatile uint32_t* pWaiting, uint32_t value, int milliseconds) ;
+            bool CheckPeerAlive(bool checkSocket) ;
+            
+            // The handshake socket, kept to notice when the other side goes away
+            Socket*             m_pSocket ;
+            
+            SharedMemoryHeader* m_pHeader ;
+            
+            SharedMemoryRing*   m_pSend ;
+            char*               m_pSendData ;
+            SharedMemoryRing*   m_pReceive ;
+            char*               m_pReceiveData ;
+            
+            bool                m_Closed ;
+            
+            // Number of times we've been polled without waiting (see IsReadDataAvailable)
+            int                 m_PollCount ;
+    } ;
+    
+} // Namespace
+
+#endif // ENABLE_SHARED_MEMORY
+
+#endif // SHARED_MEMORY_H
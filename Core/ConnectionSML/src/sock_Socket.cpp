@@ -29,6 +29,10 @@
 #include <cstdlib>
 #include <assert.h>
 
+#ifdef ENABLE_EPOLL
+#include "sock_Reactor.h"
+#endif
+
 #ifdef NON_BLOCKING
 #include "sml_Utils.h"  // For sml::Sleep
 #endif
@@ -43,12 +47,18 @@ Socket::Socket()
 {
     m_hSocket = NO_CONNECTION ;
     m_bTraceCommunications = false ;
+#ifdef ENABLE_EPOLL
+    InitReactorState() ;
+#endif
 }
 
 Socket::Socket(SOCKET hSocket)
 {
     m_hSocket = hSocket ;
     m_bTraceCommunications = false ;
+#ifdef ENABLE_EPOLL
+    InitReactorState() ;
+#endif
 }
 
 Socket::~Socket()
@@ -209,6 +219,13 @@ bool Socket::SendBuffer(char const* pSendBuffer, uint32_t bufferSize)
         return false;
     }
     
+#ifdef ENABLE_EPOLL
+    if (m_pReactor)
+    {
+        return QueueBuffer(pSendBuffer, bufferSize) ;
+    }
+#endif
+
     uint32_t bytesSent = 0 ;
     int    thisSend = 0 ;
     
@@ -287,6 +304,13 @@ bool Socket::IsReadDataAvailable(int secondsWait, int millisecondsWait)
         return false;
     }
     
+#ifdef ENABLE_EPOLL
+    if (m_pReactor)
+    {
+        return IsMessageAvailable(secondsWait, millisecondsWait) ;
+    }
+#endif
+    
     fd_set set ;
     FD_ZERO(&set) ;
     
@@ -371,6 +395,27 @@ bool Socket::ReceiveBuffer(char* pRecvBuffer, uint32_t bufferSize)
         return false ;
     }
     
+#ifdef ENABLE_EPOLL
+    // Start with anything we've already read (and only read from the socket, blocking, for the rest)
+    size_t buffered = m_Incoming.size() - m_IncomingStart ;
+    
+    if (buffered > 0)
+    {
+        uint32_t fromBuffer = (buffered < bufferSize) ? static_cast<uint32_t>(buffered) : bufferSize ;
+        memcpy(pRecvBuffer, m_Incoming.data() + m_IncomingStart, fromBuffer) ;
+        
+        m_IncomingStart += fromBuffer ;
+        if (m_IncomingStart == m_Incoming.size())
+        {
+            m_Incoming.clear() ;
+            m_IncomingStart = 0 ;
+        }
+        
+        bytesRead   += fromBuffer ;
+        pRecvBuffer += fromBuffer ;
+    }
+#endif
+    
     // May need to make repeated calls to read all of the data
     while (bytesRead < bufferSize)
     {
@@ -459,6 +504,18 @@ void Socket::CloseInternal()
 {
     if (m_hSocket)
     {
+#ifdef ENABLE_EPOLL
+        // Send what we can of anything still queued (unless another thread is sending)
+        if (m_pReactor)
+        {
+            soar_thread::ConditionalLock lock ;
+            if (lock.TryToLock(&m_QueueMutex))
+            {
+                SendQueue() ;
+            }
+        }
+#endif
+
         // Let the other side know we're shutting down
         shutdown(m_hSocket, NET_SD_BOTH);
         
@@ -466,3 +523,424 @@ void Socket::CloseInternal()
         m_hSocket = NO_CONNECTION ;
     }
 }
+
+#ifdef ENABLE_EPOLL
+
+void Socket::InitReactorState()
+{
+    m_pReactor = NULL ;
+    m_IncomingStart = 0 ;
+    m_QueueStart = 0 ;
+    m_QueuedBytes = 0 ;
+    m_PeakQueuedBytes = 0 ;
+    m_SendStalls = 0 ;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : Socket::AttachReactor
+//
+// Return type    : bool
+// Argument       : Reactor* pReactor
+// Argument       : void* pUserData -- What the reactor reports when we have input
+//
+// Description    : From now on read only what has arrived and queue what can't
+//                  be sent straight away, letting the reactor tell the owner
+//                  when there's input (and send the queue on as the socket drains).
+//
+/////////////////////////////////////////////////////////////////////
+bool Socket::AttachReactor(Reactor* pReactor, void* pUserData)
+{
+    if (!m_hSocket || m_pReactor)
+    {
+        return false ;
+    }
+    
+    // Set this first, as input could be reported as soon as we're added
+    m_pReactor = pReactor ;
+    
+    if (!pReactor->Add(this, pUserData))
+    {
+        m_pReactor = NULL ;
+        return false ;
+    }
+    
+    return true ;
+}
+
+void Socket::GetStats(DataSenderStats* pStats)
+{
+    DataSender::GetStats(pStats) ;
+    
+    pStats->m_EventDriven = (m_pReactor != NULL) ;
+    pStats->m_QueuedBytes = m_QueuedBytes ;
+    pStats->m_PeakQueuedBytes = m_PeakQueuedBytes ;
+    pStats->m_SendStalls = m_SendStalls ;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : Socket::SendQueue
+//
+// Return type    : bool
+//
+// Description    : Send as much of the queue as the socket will take
+//                  without blocking.  m_QueueMutex must be held.
+//                  Returns false if the socket has failed.
+//
+/////////////////////////////////////////////////////////////////////
+bool Socket::SendQueue()
+{
+    if (m_QueueStart == m_Queue.size())
+    {
+        return true ;
+    }
+    
+    while (m_QueueStart < m_Queue.size())
+    {
+        int thisSend = send(m_hSocket, m_Queue.data() + m_QueueStart, static_cast<int>(m_Queue.size() - m_QueueStart), MSG_DONTWAIT) ;
+        
+        if (thisSend == SOCKET_ERROR)
+        {
+            int error = ERROR_NUMBER ;
+            
+            if (error == NET_EINTR)
+            {
+                continue ;
+            }
+            
+            if (error == NET_EWOULDBLOCK || error == EAGAIN)
+            {
+                break ;
+            }
+            
+            sml::ReportSystemErrorMessage() ;
+            return false ;
+        }
+        
+        if (m_bTraceCommunications)
+        {
+            sml::PrintDebugFormat("Sent %d queued bytes", thisSend) ;
+        }
+        
+        m_QueueStart += thisSend ;
+    }
+    
+    if (m_QueueStart == m_Queue.size())
+    {
+        m_Queue.clear() ;
+        m_QueueStart = 0 ;
+        
+        // Nothing more to send, so we no longer care when the socket can take more
+        m_pReactor->WatchForWrite(this, false) ;
+    }
+    
+    m_QueuedBytes = m_Queue.size() - m_QueueStart ;
+    
+    return true ;
+}
+
+bool Socket::SendQueuedData()
+{
+    bool ok = true ;
+    
+    {
+        // If another thread holds the lock it's sending already
+        soar_thread::ConditionalLock lock ;
+        if (!m_hSocket || !lock.TryToLock(&m_QueueMutex))
+        {
+            return true ;
+        }
+        
+        ok = SendQueue() ;
+    }
+    
+    // Close outside the lock, so the reader finds out the next time it looks
+    if (!ok)
+    {
+        Close() ;
+    }
+    
+    return ok ;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : Socket::QueueBuffer
+//
+// Return type    : bool
+// Argument       : char* pSendBuffer
+// Argument       : uint32_t bufferSize
+//
+// Description    : Send what we can of a buffer without blocking and
+//                  queue the rest, for the reactor to send as the socket drains.
+//
+//                  A reader that isn't keeping up could make the queue grow without
+//                  limit, so once it goes over kMaxQueuedBytes we wait here until
+//                  it's back under.  That holds up whoever is sending, just as a
+//                  blocking send would, but only for readers that are far behind.
+//
+/////////////////////////////////////////////////////////////////////
+bool Socket::QueueBuffer(char const* pSendBuffer, uint32_t bufferSize)
+{
+    soar_thread::Lock lock(&m_QueueMutex) ;
+    
+    // Anything already queued has to go first
+    if (!SendQueue())
+    {
+        return false ;
+    }
+    
+    bool wasEmpty = (m_QueueStart == m_Queue.size()) ;
+    
+    if (wasEmpty)
+    {
+        m_Queue.clear() ;
+        m_QueueStart = 0 ;
+        
+        while (bufferSize > 0)
+        {
+            int thisSend = send(m_hSocket, pSendBuffer, static_cast<int>(bufferSize), MSG_DONTWAIT) ;
+            
+            if (thisSend == SOCKET_ERROR)
+            {
+                int error = ERROR_NUMBER ;
+                
+                if (error == NET_EINTR)
+                {
+                    continue ;
+                }
+                
+                if (error == NET_EWOULDBLOCK || error == EAGAIN)
+                {
+                    break ;
+                }
+                
+                sml::ReportSystemErrorMessage() ;
+                return false ;
+            }
+            
+            if (m_bTraceCommunications)
+            {
+                sml::PrintDebugFormat("Sent %d bytes", thisSend) ;
+            }
+            
+            bufferSize  -= thisSend ;
+            pSendBuffer += thisSend ;
+        }
+        
+        if (bufferSize == 0)
+        {
+            return true ;
+        }
+        
+        m_pReactor->WatchForWrite(this, true) ;
+    }
+    
+    m_Queue.append(pSendBuffer, bufferSize) ;
+    m_QueuedBytes = m_Queue.size() - m_QueueStart ;
+    
+    if (m_QueuedBytes > m_PeakQueuedBytes)
+    {
+        m_PeakQueuedBytes = m_QueuedBytes ;
+    }
+    
+    if (m_QueuedBytes <= kMaxQueuedBytes)
+    {
+        return true ;
+    }
+    
+    if (m_bTraceCommunications)
+    {
+        sml::PrintDebugFormat("Waiting for the other side to read %d queued bytes", static_cast<int>(m_QueuedBytes)) ;
+    }
+    
+    m_SendStalls++ ;
+    
+    while (m_QueuedBytes > kMaxQueuedBytes)
+    {
+        fd_set set ;
+        FD_ZERO(&set) ;
+        FD_SET(m_hSocket, &set) ;
+        
+        TIMEVAL wait ;
+        wait.tv_sec = 1 ;
+        wait.tv_usec = 0 ;
+        
+        if (select(static_cast<int>(m_hSocket) + 1, NULL, &set, NULL, &wait) == SOCKET_ERROR && ERROR_NUMBER != NET_EINTR)
+        {
+            sml::ReportSystemErrorMessage() ;
+            return false ;
+        }
+        
+        if (!SendQueue())
+        {
+            return false ;
+        }
+    }
+    
+    return true ;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : Socket::ReadWithoutBlocking
+//
+// Return type    : bool
+//
+// Description    : Add whatever has arrived on the socket to m_Incoming.
+//                  Returns false if the other side has closed the socket
+//                  (or it has failed).
+//
+/////////////////////////////////////////////////////////////////////
+bool Socket::ReadWithoutBlocking()
+{
+    char buffer[16384] ;
+    
+    for (;;)
+    {
+        int thisRead = recv(m_hSocket, buffer, sizeof(buffer), MSG_DONTWAIT) ;
+        
+        if (thisRead == 0)
+        {
+            return false ;
+        }
+        
+        if (thisRead == SOCKET_ERROR)
+        {
+            int error = ERROR_NUMBER ;
+            
+            if (error == NET_EINTR)
+            {
+                continue ;
+            }
+            
+            return (error == NET_EWOULDBLOCK || error == EAGAIN) ;
+        }
+        
+        if (m_bTraceCommunications)
+        {
+            sml::PrintDebugFormat("Received %d bytes", thisRead) ;
+        }
+        
+        // Drop what's been handed out before the buffer grows
+        if (m_IncomingStart > 0 && (m_IncomingStart == m_Incoming.size() || m_IncomingStart >= sizeof(buffer)))
+        {
+            m_Incoming.erase(0, m_IncomingStart) ;
+            m_IncomingStart = 0 ;
+        }
+        
+        m_Incoming.append(buffer, thisRead) ;
+        
+        if (thisRead < static_cast<int>(sizeof(buffer)))
+        {
+            return true ;
+        }
+    }
+}
+
+// Returns how many whole messages are buffered, counting no higher than limit
+int Socket::CountBufferedMessages(int limit)
+{
+    int count = 0 ;
+    size_t start = m_IncomingStart ;
+    
+    while (count < limit && m_Incoming.size() - start >= sizeof(uint32_t))
+    {
+        uint32_t netLen = 0 ;
+        memcpy(&netLen, m_Incoming.data() + start, sizeof(netLen)) ;
+        
+        size_t end = start + sizeof(netLen) + ntohl(netLen) ;
+        if (end > m_Incoming.size())
+        {
+            break ;
+        }
+        
+        start = end ;
+        count++ ;
+    }
+    
+    return count ;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : Socket::IsMessageAvailable
+//
+// Return type    : bool
+//
+// Description    : IsReadDataAvailable for a socket attached to a reactor.
+//                  Only returns true once a whole message has arrived, so reading it
+//                  never blocks (a slow client can't hold up the thread serving everyone).
+//                  Also returns true if the socket is closed.
+//
+/////////////////////////////////////////////////////////////////////
+bool Socket::IsMessageAvailable(int secondsWait, int millisecondsWait)
+{
+    bool waiting = (secondsWait > 0 || millisecondsWait > 0) ;
+    
+    TIMEVAL wait ;
+    wait.tv_sec = secondsWait ;
+    wait.tv_usec = millisecondsWait * 1000 ;
+    
+    for (;;)
+    {
+        // A caller waiting here for a response may be the one who would have sent
+        // the rest of the request, so push any queued data on first.
+        if (!SendQueuedData())
+        {
+            return false ;
+        }
+        
+        int messages = CountBufferedMessages(2) ;
+        
+        if (messages == 0)
+        {
+            if (!ReadWithoutBlocking())
+            {
+                return true ;
+            }
+            messages = CountBufferedMessages(2) ;
+        }
+        
+        if (messages > 0)
+        {
+            // A caller waiting for a response reads one message at a time and stops
+            // at the response, which could leave the rest here without the socket
+            // ever becoming readable again.  So make sure the reactor looks.
+            if (messages > 1 && waiting)
+            {
+                m_pReactor->Signal(this) ;
+            }
+            return true ;
+        }
+        
+        if (!waiting)
+        {
+            return false ;
+        }
+        
+        fd_set readSet ;
+        fd_set writeSet ;
+        FD_ZERO(&readSet) ;
+        FD_ZERO(&writeSet) ;
+        FD_SET(m_hSocket, &readSet) ;
+        
+        if (m_QueuedBytes > 0)
+        {
+            FD_SET(m_hSocket, &writeSet) ;
+        }
+        
+        // Linux reduces the timeout by the time spent waiting, so we only wait as long as asked in total
+        int res = select(static_cast<int>(m_hSocket) + 1, &readSet, &writeSet, NULL, &wait) ;
+        
+        if (res == 0)
+        {
+            return false ;
+        }
+        
+        if (res == SOCKET_ERROR && ERROR_NUMBER != NET_EINTR)
+        {
+            sml::ReportSystemErrorMessage() ;
+            Close() ;
+            return false ;
+        }
+    }
+}
+
+#endif // ENABLE_EPOLL
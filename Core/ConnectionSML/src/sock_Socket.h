@@ -52,7 +52,7 @@ namespace sock
     class ListenerSocket ;
     class ClientSocket ;
     
-    class Socket : public DataSender
+    class EXPORT Socket : public DataSender
     {
             // Allow these classes access to our constructor
             friend class ListenerSocket ;
@@ -89,8 +89,24 @@ namespace sock
             // Check if data is waiting to be read
             // Returns true if socket is closed--but then receiveMsg will know it's closed.
             // The timeout for waiting for data is secondsWait + millisecondsWait, where millisecondsWait < 1000
+            // (Once attached to a reactor this only returns true when a whole message has arrived).
             bool        IsReadDataAvailable(int secondsWait = 0, int millisecondsWait = 0) ;
             
+#ifdef ENABLE_EPOLL
+            // Once this much is queued to send, SendBuffer waits for the other side to catch up
+            enum { kMaxQueuedBytes = 1 << 20 } ;
+            
+            // From now on read and send without blocking, letting the reactor
+            // tell us when there's more to do (see sock_Reactor.h)
+            bool        AttachReactor(Reactor* pReactor, void* pUserData) ;
+            
+            // Send as much of the queued data as the socket will take without blocking.
+            // Returns false if the socket has failed.
+            bool        SendQueuedData() ;
+            
+            void        GetStats(DataSenderStats* pStats) ;
+#endif
+            
         public:
             // Print out debug information about the messages we are sending and receiving.
             // NOTE: We still print out information about start up/shut down, errors etc. without this flag being true.
@@ -113,6 +129,31 @@ namespace sock
             // Close down our side of the socket
             virtual void        CloseInternal() ;
             
+#ifdef ENABLE_EPOLL
+            // The reactor we're attached to (or NULL if we block as usual)
+            Reactor*    m_pReactor ;
+            
+            // Data we've read but not yet handed out, which may end part way through a message
+            std::string m_Incoming ;
+            size_t      m_IncomingStart ;
+            
+            // Data waiting to be sent, guarded by m_QueueMutex
+            std::string m_Queue ;
+            size_t      m_QueueStart ;
+            soar_thread::Mutex m_QueueMutex ;
+            
+            volatile uint64_t m_QueuedBytes ;
+            uint64_t    m_PeakQueuedBytes ;
+            uint64_t    m_SendStalls ;
+            
+            bool        QueueBuffer(char const* pSendBuffer, uint32_t bufferSize) ;
+            bool        SendQueue() ;
+            bool        ReadWithoutBlocking() ;
+            int         CountBufferedMessages(int limit) ;
+            bool        IsMessageAvailable(int secondsWait, int millisecondsWait) ;
+            void        InitReactorState() ;
+#endif
+
     };
     
 } // Namespace
@@ -3,3 +3,4 @@
 #include "src/ParseXML.cpp"
 #include "src/ParseXMLFile.cpp"
 #include "src/ParseXMLString.cpp"
+#include "src/ParseXMLPull.cpp"
@@ -275,7 +275,7 @@ namespace soarxml
             *************************************************************/
             bool SetTagName(char const* tagName)
             {
-                return SetTagName(CopyString(tagName), false) ;
+                return SetTagName(const_cast<char*>(tagName), true) ;
             }
             
             /*************************************************************
@@ -472,14 +472,16 @@ namespace soarxml
             
             /*************************************************************
             * @brief Helper overloads -- if we're passed a const, must copy it.
+            *        The element makes the copy (into its own arena) so there's
+            *        no separate allocation for each string.
             *************************************************************/
             bool AddAttribute(char const* attributeName, char* attributeValue)
             {
-                return AddAttribute(CopyString(attributeName), attributeValue, false, true) ;
+                return AddAttribute(const_cast<char*>(attributeName), attributeValue, true, true) ;
             }
             bool AddAttribute(char const* attributeName, char const* attributeValue)
             {
-                return AddAttribute(CopyString(attributeName), CopyString(attributeValue), false, false) ;
+                return AddAttribute(const_cast<char*>(attributeName), const_cast<char*>(attributeValue), true, true) ;
             }
             
             /*************************************************************
@@ -542,7 +544,7 @@ namespace soarxml
             }
             void SetCharacterData(char const* characterData)
             {
-                SetCharacterData(CopyString(characterData), false) ;
+                SetCharacterData(const_cast<char*>(characterData), true) ;
             }
             
             /*************************************************************
@@ -559,7 +561,7 @@ namespace soarxml
             }
             void SetBinaryCharacterData(char const* characterData, int length)
             {
-                SetBinaryCharacterData(CopyBuffer(characterData, length), length, false) ;
+                SetBinaryCharacterData(const_cast<char*>(characterData), length, true) ;
             }
             
             /*************************************************************
@@ -722,6 +724,26 @@ namespace soarxml
                 return ::soarxml_CopyBuffer(original, length) ;
             }
             
+            /*************************************************************
+            * @brief    Returns the number of heap allocations ElementXML has made so far
+            *           (for elements, their strings and their lists of children/attributes).
+            *           Compare two readings to see what building or parsing a message costs.
+            *           Returns -1 unless counting was turned on with SetCountAllocations().
+            *************************************************************/
+            static long GetAllocationCount()
+            {
+                return ::soarxml_GetAllocationCount() ;
+            }
+            
+            /*************************************************************
+            * @brief    Turns allocation counting on or off.  It's off by default,
+            *           as it adds an atomic increment to every allocation.
+            *************************************************************/
+            static void SetCountAllocations(bool count)
+            {
+                ::soarxml_SetCountAllocations(count) ;
+            }
+            
             ////////////////////////////////////////////////////////////////
             //
             // Parsing functions
@@ -817,7 +839,7 @@ namespace soarxml
             
             bool AddAttributeFast(char const* attributeName, char const* attributeValue)
             {
-                return AddAttributeFast(attributeName, CopyString(attributeValue), false) ;
+                return AddAttributeFast(attributeName, const_cast<char*>(attributeValue), true) ;
             }
             
             /*************************************************************
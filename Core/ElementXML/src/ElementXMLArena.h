@@ -0,0 +1,180 @@
+/////////////////////////////////////////////////////////////////
+// ElementXMLArena class
+//
+// A bump allocator for the strings an ElementXMLImpl owns.
+//
+// Building an SML message used to mean a separate malloc (and a later free)
+// for every tag name, attribute value, comment and block of character data
+// that was copied into an element.  Each element now copies these strings
+// into its arena instead: a small buffer inside the element itself, followed
+// by larger chunks only if that fills up.  The whole arena goes back to the
+// heap in one step when the element is destroyed.
+//
+// A string that's replaced (a new attribute value or character data) is
+// given back with Release().  If it was the last thing allocated its space is
+// reused; otherwise it's only counted as abandoned.  Once kMaxAbandoned bytes
+// have been abandoned the element stops using its arena, and later strings
+// are separate allocations that are freed as they are replaced, so an
+// element whose data is set over and over doesn't grow without limit.
+//
+// The arena only holds strings.  Strings a caller hands over with copy=false
+// (allocated with AllocateString) are still released individually, and
+// constant names set with the Fast methods are never copied at all.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef ELEMENTXML_ARENA_H
+#define ELEMENTXML_ARENA_H
+
+#include <cstdlib>
+#include <cstring>
+
+namespace soarxml
+{
+
+    class ElementXMLArena
+    {
+        public:
+            // Most elements (an SML <wme> or <arg> for example) fit their strings in the inline buffer.
+            enum { kInlineSize = 128, kChunkSize = 1024, kMaxAbandoned = 4 * kChunkSize } ;
+            
+            ElementXMLArena()
+            {
+                m_pNext      = m_Inline ;
+                m_Remaining  = kInlineSize ;
+                m_pChunks    = NULL ;
+                m_Abandoned  = 0 ;
+            }
+            
+            ~ElementXMLArena()
+            {
+                while (m_pChunks)
+                {
+                    Chunk* pNext = m_pChunks->m_pNext ;
+                    free(m_pChunks) ;
+                    m_pChunks = pNext ;
+                }
+            }
+            
+            /*************************************************************
+            * @brief Returns length bytes from the arena.
+            *        Sets *pNewChunk if a new chunk had to be allocated.
+            *************************************************************/
+            char* Allocate(size_t length, bool* pNewChunk)
+            {
+                *pNewChunk = false ;
+                
+                if (length <= m_Remaining)
+                {
+                    char* p = m_pNext ;
+                    m_pNext += length ;
+                    m_Remaining -= length ;
+                    return p ;
+                }
+                
+                *pNewChunk = true ;
+                
+                // Large strings get a chunk to themselves so we don't waste the rest of the current chunk
+                if (length > kChunkSize / 2)
+                {
+                    return AddChunk(length)->Data() ;
+                }
+                
+                Chunk* pChunk = AddChunk(kChunkSize) ;
+                m_pNext = pChunk->Data() + length ;
+                m_Remaining = kChunkSize - length ;
+                
+                return pChunk->Data() ;
+            }
+            
+            /*************************************************************
+            * @brief Gives back length bytes at p, which are no longer used.
+            *        Only the most recent allocation can be reused.
+            *************************************************************/
+            void Release(char* p, size_t length)
+            {
+                if (p + length == m_pNext)
+                {
+                    m_pNext = p ;
+                    m_Remaining += length ;
+                    return ;
+                }
+                
+                m_Abandoned += length ;
+            }
+            
+            /*************************************************************
+            * @brief True once too much space has been released that couldn't be reused.
+            *************************************************************/
+            bool IsWasteful() const
+            {
+                return m_Abandoned > kMaxAbandoned ;
+            }
+            
+            /*************************************************************
+            * @brief Returns true if the string was allocated from this arena.
+            *************************************************************/
+            bool Owns(char const* p) const
+            {
+                if (InRange(p, m_Inline, kInlineSize))
+                {
+                    return true ;
+                }
+                
+                for (Chunk const* pChunk = m_pChunks ; pChunk != NULL ; pChunk = pChunk->m_pNext)
+                {
+                    if (InRange(p, pChunk->Data(), pChunk->m_Size))
+                    {
+                        return true ;
+                    }
+                }
+                
+                return false ;
+            }
+            
+        protected:
+            struct Chunk
+            {
+                Chunk*  m_pNext ;
+                size_t  m_Size ;
+                
+                // The data follows the header
+                char* Data()
+                {
+                    return reinterpret_cast<char*>(this + 1) ;
+                }
+                char const* Data() const
+                {
+                    return reinterpret_cast<char const*>(this + 1) ;
+                }
+            } ;
+            
+            Chunk* AddChunk(size_t size)
+            {
+                Chunk* pChunk = static_cast<Chunk*>(malloc(sizeof(Chunk) + size)) ;
+                pChunk->m_Size = size ;
+                pChunk->m_pNext = m_pChunks ;
+                m_pChunks = pChunk ;
+                return pChunk ;
+            }
+            
+            static bool InRange(char const* p, char const* pStart, size_t size)
+            {
+                return reinterpret_cast<size_t>(p) >= reinterpret_cast<size_t>(pStart) && reinterpret_cast<size_t>(p) < reinterpret_cast<size_t>(pStart) + size ;
+            }
+            
+            char    m_Inline[kInlineSize] ;
+            char*   m_pNext ;
+            size_t  m_Remaining ;
+            Chunk*  m_pChunks ;
+            size_t  m_Abandoned ;    // Bytes released that couldn't be reused
+            
+        private:
+            // Strings in the arena point into the element that owns it, so it can't be copied.
+            ElementXMLArena(ElementXMLArena const&) ;
+            ElementXMLArena& operator=(ElementXMLArena const&) ;
+    } ;
+    
+} // namespace soarxml
+
+#endif // ELEMENTXML_ARENA_H
@@ -382,6 +382,25 @@ inline static char* AddXMLString(char* pDest, char const* pAdd)
 }
 
 
+// The number of allocations made for elements while counting is on (see CountAllocation())
+static volatile long s_ElementXMLAllocationCount = 0 ;
+bool ElementXMLImpl::s_CountAllocations = false ;
+
+void ElementXMLImpl::AddAllocation()
+{
+    elementxml_atomic_inc(&s_ElementXMLAllocationCount) ;
+}
+
+void ElementXMLImpl::SetCountAllocations(bool count)
+{
+    s_CountAllocations = count ;
+}
+
+long ElementXMLImpl::GetAllocationCount()
+{
+    return s_CountAllocations ? s_ElementXMLAllocationCount : -1 ;
+}
+
 /*************************************************************
 * @brief XML ids can only contain letters, numbers, �.� �-� and �_�.
 *************************************************************/
@@ -430,11 +449,157 @@ ElementXMLImpl::ElementXMLImpl(void)
     // Creation of the object creates an initial reference.
     m_RefCount = 1 ;
     
-    // Guessing at the approx number of strings we'll store makes adding
-    // attributes substantially faster.
-    m_StringsToDelete.reserve(20) ;
+    // We used to reserve space for m_StringsToDelete here, but copied strings
+    // now go into m_Arena and the list is usually empty.
     
     elementxml_atomic_init();
+    
+    // The element itself
+    CountAllocation() ;
+}
+
+/*************************************************************
+* @brief Copies a string into the arena (rather than a separate allocation).
+*************************************************************/
+char* ElementXMLImpl::CopyToArena(char const* original)
+{
+    if (original == NULL)
+    {
+        return NULL ;
+    }
+    
+    size_t length = strlen(original) + 1 ;
+    char* pCopy = AllocateInArena(length) ;
+    memcpy(pCopy, original, length) ;
+    
+    return pCopy ;
+}
+
+char* ElementXMLImpl::CopyBufferToArena(char const* original, int length)
+{
+    // Same rules as CopyBuffer(), except that a trailing null is added as AllocateString() does
+    if (original == NULL || length <= 0)
+    {
+        return NULL ;
+    }
+    
+    char* pCopy = AllocateInArena(length + 1) ;
+    memcpy(pCopy, original, length) ;
+    pCopy[length] = 0 ;
+    
+    return pCopy ;
+}
+
+char* ElementXMLImpl::AllocateInArena(size_t length)
+{
+    // Once too much has been replaced, strings are allocated separately so replacing them frees them
+    if (m_Arena.IsWasteful())
+    {
+        char* p = static_cast<char*>(malloc(length)) ;
+        CountAllocation() ;
+        AddStringToDelete(p) ;
+        return p ;
+    }
+    
+    bool newChunk = false ;
+    char* p = m_Arena.Allocate(length, &newChunk) ;
+    
+    if (newChunk)
+    {
+        CountAllocation() ;
+    }
+    
+    return p ;
+}
+
+/*************************************************************
+* @brief Copies a string over one of ours that's being replaced, if it's
+*        in the arena and long enough.  Lengths don't include the trailing null.
+*
+* @returns false if the new string has to go somewhere else.
+*************************************************************/
+bool ElementXMLImpl::CopyOverString(char const* pOld, size_t oldLength, char const* pNew, size_t newLength)
+{
+    if (pOld == NULL || pNew == NULL || newLength > oldLength || !m_Arena.Owns(pOld))
+    {
+        return false ;
+    }
+    
+    // memmove, as the new string may be (part of) the old one
+    char* p = const_cast<char*>(pOld) ;
+    memmove(p, pNew, newLength) ;
+    p[newLength] = 0 ;
+    
+    m_Arena.Release(p + newLength + 1, oldLength - newLength) ;
+    return true ;
+}
+
+/*************************************************************
+* @brief Gives back a string of ours that has been replaced.
+*        Constants (from the Fast methods) are ignored.
+*
+* @param length     The length of the string, not including the trailing null.
+*************************************************************/
+void ElementXMLImpl::ReleaseString(char const* pString, size_t length)
+{
+    if (pString == NULL)
+    {
+        return ;
+    }
+    
+    if (m_Arena.Owns(pString))
+    {
+        m_Arena.Release(const_cast<char*>(pString), length + 1) ;
+        return ;
+    }
+    
+    xmlStringListIter iter = std::find(m_StringsToDelete.begin(), m_StringsToDelete.end(), pString) ;
+    
+    if (iter != m_StringsToDelete.end())
+    {
+        m_StringsToDelete.erase(iter) ;
+        DeleteString(const_cast<char*>(pString)) ;
+    }
+}
+
+/*************************************************************
+* @brief Records that we've taken ownership of a string allocated with AllocateString().
+*        (Strings that are already in our arena are ignored, as we own them anyway,
+*        and so are strings AllocateInArena() already recorded).
+*************************************************************/
+void ElementXMLImpl::AddStringToDelete(char* pString)
+{
+    if (m_Arena.Owns(pString))
+    {
+        return ;
+    }
+    
+    // A string AllocateInArena() just handed out is normally the last one in the list
+    if (std::find(m_StringsToDelete.rbegin(), m_StringsToDelete.rend(), pString) != m_StringsToDelete.rend())
+    {
+        return ;
+    }
+    
+    if (m_StringsToDelete.size() == m_StringsToDelete.capacity())
+    {
+        CountAllocation() ;
+    }
+    
+    m_StringsToDelete.push_back(pString) ;
+}
+
+/*************************************************************
+* @brief True if the string was copied into this element (or handed over to it),
+*        false if it is a constant set through one of the Fast methods.
+*************************************************************/
+bool ElementXMLImpl::IsOwnedString(char const* pString) const
+{
+    if (m_Arena.Owns(pString))
+    {
+        return true ;
+    }
+    
+    return std::find(m_StringsToDelete.begin(), m_StringsToDelete.end(), pString) != m_StringsToDelete.end() ;
 }
 
 // Provide a static way to call release ref to get round an STL challenge.
@@ -448,11 +613,8 @@ static inline void StaticReleaseRef(ElementXMLImpl* pXML)
 *************************************************************/
 ElementXMLImpl::~ElementXMLImpl(void)
 {
-    // Delete the comment
-    DeleteString(m_Comment) ;
-    
-    // Delete the character data
-    DeleteString(m_CharacterData) ;
+    // The comment, character data and any other strings we copied are in m_Arena,
+    // which releases them all when it is destroyed.
     
     // Delete all of the strings that we own
     // (We store these in a separate list because some elements in
@@ -514,10 +676,20 @@ ElementXMLImpl* ElementXMLImpl::MakeCopy() const
     pCopy->m_pParent          = NULL ;
     
     // Copy the comment
-    pCopy->SetComment(m_Comment) ;
+    if (m_Comment)
+    {
+        pCopy->SetComment(m_Comment) ;
+    }
     
-    // Copy the tag name
-    pCopy->SetTagName(m_TagName) ;
+    // Copy the tag name (if it's a constant we can just point to it again)
+    if (m_TagName && !IsOwnedString(m_TagName))
+    {
+        pCopy->SetTagNameFast(m_TagName) ;
+    }
+    else if (m_TagName)
+    {
+        pCopy->SetTagName(m_TagName) ;
+    }
     
     // Copy the character data
     if (m_DataIsBinary)
@@ -529,13 +701,22 @@ ElementXMLImpl* ElementXMLImpl::MakeCopy() const
         pCopy->SetCharacterData(m_CharacterData) ;
     }
     
-    // Copy the attributes
+    // Copy the attributes (again, constant attribute names are shared not copied)
+    pCopy->m_AttributeMap.reserve(m_AttributeMap.size()) ;
+    
     for (xmlAttributeMapConstIter mapIter = m_AttributeMap.begin() ; mapIter != m_AttributeMap.end() ; mapIter++)
     {
         xmlStringConst att = mapIter->first ;
         xmlStringConst val = mapIter->second ;
         
-        pCopy->AddAttribute(att, val) ;
+        if (IsOwnedString(att))
+        {
+            pCopy->AddAttribute(att, val) ;
+        }
+        else
+        {
+            pCopy->AddAttributeFast(att, const_cast<char*>(val), true) ;
+        }
     }
     
     // Copy all of the children, overwriting the parent field for them so that everything connects up correctly.
@@ -608,11 +789,13 @@ bool ElementXMLImpl::SetTagName(char* tagName, bool copyName)
     // Decide if we're taking ownership of this string or not.
     if (copyName)
     {
-        tagName = CopyString(tagName) ;
+        tagName = CopyToArena(tagName) ;
+    }
+    else
+    {
+        // In this version, we take ownership of the name.
+        AddStringToDelete(tagName) ;
     }
-    
-    // In this version, we take ownership of the name.
-    m_StringsToDelete.push_back(tagName) ;
     
     return SetTagNameFast(tagName) ;
 }
@@ -636,8 +819,14 @@ bool ElementXMLImpl::SetTagNameFast(char const* tagName)
     }
 #endif
     
+    char const* pOld = m_TagName ;
     m_TagName = tagName ;
     
+    if (pOld != tagName && pOld != NULL)
+    {
+        ReleaseString(pOld, strlen(pOld)) ;
+    }
+    
     return true ;
 }
 
@@ -672,6 +861,11 @@ void ElementXMLImpl::AddChild(ElementXMLImpl* pChild)
         return ;
     }
     
+    if (m_Children.size() == m_Children.capacity())
+    {
+        CountAllocation() ;
+    }
+    
     pChild->m_pParent = this ;
     this->m_Children.push_back(pChild) ;
 }
@@ -736,15 +930,30 @@ ElementXMLImpl const* ElementXMLImpl::GetParent() const
 *************************************************************/
 bool ElementXMLImpl::AddAttribute(char* attributeName, char* attributeValue, bool copyName, bool copyValue)
 {
-    // Decide if we're taking ownership of this string or not.
-    if (copyName)
+    // If the attribute is already there we just need the new value
+    xmlAttributeMapIter iter = FindAttribute(attributeName) ;
+    
+    if (iter != m_AttributeMap.end())
     {
-        attributeName = CopyString(attributeName) ;
+        if (!copyName && attributeName != iter->first)
+        {
+            DeleteString(attributeName) ;
+        }
+        
+        return AddAttributeFast(iter->first, attributeValue, copyValue) ;
     }
     
+    // Decide if we're taking ownership of this string or not.
     // In this version of the call, we own the attribute as well
     // as the value.  (The value gets recorded in the Fast() call).
-    m_StringsToDelete.push_back(attributeName) ;
+    if (copyName)
+    {
+        attributeName = CopyToArena(attributeName) ;
+    }
+    else
+    {
+        AddStringToDelete(attributeName) ;
+    }
     
     return AddAttributeFast(attributeName, attributeValue, copyValue) ;
 }
@@ -765,13 +974,24 @@ bool ElementXMLImpl::AddAttribute(char* attributeName, char* attributeValue, boo
 bool ElementXMLImpl::AddAttributeFast(char const* attributeName, char* attributeValue, bool copyValue)
 {
     // Decide if we're taking ownership of this string or not.
+    // In this version of the call, we only own the value.
     if (copyValue)
     {
-        attributeValue = CopyString(attributeValue) ;
+        // A new value for an attribute can often go where the old one was
+        xmlAttributeMapIter iter = FindAttribute(attributeName) ;
+        
+        if (iter != m_AttributeMap.end() && attributeValue != NULL &&
+                CopyOverString(iter->second, strlen(iter->second), attributeValue, strlen(attributeValue)))
+        {
+            return true ;
+        }
+        
+        attributeValue = CopyToArena(attributeValue) ;
+    }
+    else
+    {
+        AddStringToDelete(attributeValue) ;
     }
-    
-    // In this version of the call, we only own the value.
-    m_StringsToDelete.push_back(attributeValue) ;
     
 #ifdef DEBUG
     // Run this test after we've added it to list of strings to delete,
@@ -782,7 +1002,7 @@ bool ElementXMLImpl::AddAttributeFast(char const* attributeName, char* attribute
     }
 #endif
     
-    m_AttributeMap[attributeName] = attributeValue ;
+    SetAttributeValue(attributeName, attributeValue) ;
     
     return true ;
 }
@@ -808,11 +1028,59 @@ bool ElementXMLImpl::AddAttributeFastFast(char const* attributeName, char const*
     }
 #endif
     
-    m_AttributeMap[attributeName] = attributeValue ;
+    SetAttributeValue(attributeName, attributeValue) ;
     
     return true ;
 }
 
+/*************************************************************
+* @brief Adds the attribute to the (sorted) list or replaces
+*        its value if it's already there.
+*************************************************************/
+xmlAttributeMapIter ElementXMLImpl::FindAttribute(char const* attributeName)
+{
+    xmlAttributeMapIter iter = std::lower_bound(m_AttributeMap.begin(), m_AttributeMap.end(), attributeName, strCompareElementXMLImpl()) ;
+    
+    if (iter != m_AttributeMap.end() && strcmp(iter->first, attributeName) == 0)
+    {
+        return iter ;
+    }
+    
+    return m_AttributeMap.end() ;
+}
+
+void ElementXMLImpl::SetAttributeValue(char const* attributeName, char const* attributeValue)
+{
+    xmlAttributeMapIter iter = std::lower_bound(m_AttributeMap.begin(), m_AttributeMap.end(), attributeName, strCompareElementXMLImpl()) ;
+    
+    if (iter != m_AttributeMap.end() && strcmp(iter->first, attributeName) == 0)
+    {
+        char const* pOld = iter->second ;
+        iter->second = attributeValue ;
+        
+        if (pOld != attributeValue && pOld != NULL)
+        {
+            ReleaseString(pOld, strlen(pOld)) ;
+        }
+        return ;
+    }
+    
+    // Leave room for a typical SML element's attributes the first time
+    if (m_AttributeMap.capacity() == 0)
+    {
+        size_t offset = iter - m_AttributeMap.begin() ;
+        m_AttributeMap.reserve(kInitialAttributes) ;
+        iter = m_AttributeMap.begin() + offset ;
+        CountAllocation() ;
+    }
+    else if (m_AttributeMap.size() == m_AttributeMap.capacity())
+    {
+        CountAllocation() ;
+    }
+    
+    m_AttributeMap.insert(iter, xmlAttribute(attributeName, attributeValue)) ;
+}
+
 /*************************************************************
 * @brief Get the number of attributes attached to this element.
 *************************************************************/
@@ -830,22 +1098,12 @@ int ElementXMLImpl::GetNumberAttributes() const
 *************************************************************/
 const char* ElementXMLImpl::GetAttributeName(int index) const
 {
-    xmlAttributeMapConstIter mapIter = m_AttributeMap.begin() ;
-    
-    while (mapIter != m_AttributeMap.end())
+    if (index < 0 || index >= static_cast<int>(m_AttributeMap.size()))
     {
-        if (index == 0)
-        {
-            xmlStringConst att = mapIter->first ;
-            
-            return att ;
-        }
-        
-        mapIter++ ;
-        index-- ;
+        return NULL ;
     }
     
-    return NULL ;
+    return m_AttributeMap[index].first ;
 }
 
 /*************************************************************
@@ -855,22 +1113,12 @@ const char* ElementXMLImpl::GetAttributeName(int index) const
 *************************************************************/
 const char* ElementXMLImpl::GetAttributeValue(int index) const
 {
-    xmlAttributeMapConstIter mapIter = m_AttributeMap.begin() ;
-    
-    while (mapIter != m_AttributeMap.end())
+    if (index < 0 || index >= static_cast<int>(m_AttributeMap.size()))
     {
-        if (index == 0)
-        {
-            xmlStringConst val = mapIter->second ;
-            
-            return val ;
-        }
-        
-        mapIter++ ;
-        index-- ;
+        return NULL ;
     }
     
-    return NULL ;
+    return m_AttributeMap[index].second ;
 }
 
 /*************************************************************
@@ -881,14 +1129,9 @@ const char* ElementXMLImpl::GetAttributeValue(int index) const
 *************************************************************/
 const char* ElementXMLImpl::GetAttribute(const char* attName) const
 {
-    // Note: We can't use the apparently simpler "return m_AttributeMap[attName]" for two reasons.
-    // First, this will create an object in the map if one didn't exist before (which we don't want) and
-    // Second, there is no const version of [] so we can't do this anyway (it's not const because of the first behavior...)
-    
-    // Use find to locate the object not [].
-    xmlAttributeMapConstIter iter = m_AttributeMap.find(attName) ;
+    xmlAttributeMapConstIter iter = std::lower_bound(m_AttributeMap.begin(), m_AttributeMap.end(), attName, strCompareElementXMLImpl()) ;
     
-    if (iter == m_AttributeMap.end())
+    if (iter == m_AttributeMap.end() || strcmp(iter->first, attName) != 0)
     {
         return NULL ;
     }
@@ -910,7 +1153,17 @@ const char* ElementXMLImpl::GetAttribute(const char* attName) const
 *************************************************************/
 bool ElementXMLImpl::SetComment(const char* comment)
 {
-    m_Comment = CopyString(comment) ;
+    size_t oldLength = m_Comment ? strlen(m_Comment) : 0 ;
+    
+    if (comment && CopyOverString(m_Comment, oldLength, comment, strlen(comment)))
+    {
+        return true ;
+    }
+    
+    char* pOld = m_Comment ;
+    m_Comment = CopyToArena(comment) ;
+    ReleaseString(pOld, oldLength) ;
+    
     return true ;
 }
 
@@ -943,37 +1196,64 @@ char const* ElementXMLImpl::GetComment()
 *************************************************************/
 void ElementXMLImpl::SetCharacterData(char* characterData, bool copyData)
 {
+    char* pOld = m_CharacterData ;
+    size_t oldLength = pOld ? static_cast<size_t>(GetCharacterDataLength() - (m_DataIsBinary ? 0 : 1)) : 0 ;
+    
     // Decide if we're taking ownership of this string or not.
     if (copyData)
     {
-        characterData = CopyString(characterData) ;
+        if (characterData && CopyOverString(pOld, oldLength, characterData, strlen(characterData)))
+        {
+            this->m_DataIsBinary = false ;
+            return ;
+        }
+        
+        characterData = CopyToArena(characterData) ;
     }
-    
-    if (this->m_CharacterData != NULL)
+    else if (characterData)
     {
-        DeleteString(this->m_CharacterData) ;
+        AddStringToDelete(characterData) ;
     }
     
     this->m_CharacterData = characterData ;
     this->m_DataIsBinary = false ;
+    
+    if (pOld != characterData)
+    {
+        ReleaseString(pOld, oldLength) ;
+    }
 }
 
 void ElementXMLImpl::SetBinaryCharacterData(char* characterData, int length, bool copyData)
 {
+    char* pOld = m_CharacterData ;
+    size_t oldLength = pOld ? static_cast<size_t>(GetCharacterDataLength() - (m_DataIsBinary ? 0 : 1)) : 0 ;
+    
     // Decide if we're taking ownership of this string or not.
     if (copyData)
     {
-        characterData = CopyBuffer(characterData, length) ;
+        if (characterData && length > 0 && CopyOverString(pOld, oldLength, characterData, length))
+        {
+            this->m_DataIsBinary     = true ;
+            this->m_BinaryDataLength = length ;
+            return ;
+        }
+        
+        characterData = CopyBufferToArena(characterData, length) ;
     }
-    
-    if (this->m_CharacterData != NULL)
+    else if (characterData)
     {
-        DeleteString(this->m_CharacterData) ;
+        AddStringToDelete(characterData) ;
     }
     
     this->m_CharacterData    = characterData ;
     this->m_DataIsBinary     = true ;
     this->m_BinaryDataLength = length ;
+    
+    if (pOld != characterData)
+    {
+        ReleaseString(pOld, oldLength) ;
+    }
 }
 
 /*************************************************************
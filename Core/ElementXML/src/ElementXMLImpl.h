@@ -41,6 +41,7 @@
 #include <vector>
 #include <map>
 #include "Export.h"
+#include "ElementXMLArena.h"
 
 namespace soarxml
 {
@@ -64,19 +65,28 @@ namespace soarxml
     typedef xmlStringList::iterator         xmlStringListIter ;
     typedef xmlStringList::const_iterator   xmlStringListConstIter ;
     
-// We need a comparator to make the map we're about to define work with char*
+// Used to store an attribute name and its value
+    typedef std::pair<xmlStringConst, xmlStringConst>   xmlAttribute ;
+    
+// We need a comparator to keep the attribute list sorted by name (comparing the char*'s contents)
     struct strCompareElementXMLImpl
     {
         inline bool operator()(const char* s1, const char* s2) const
         {
             return std::strcmp(s1, s2) < 0;
         }
+        inline bool operator()(xmlAttribute const& a1, const char* s2) const
+        {
+            return std::strcmp(a1.first, s2) < 0;
+        }
     };
     
-// Used to store a map from attribute name to attribute value
-    typedef std::map<xmlStringConst, xmlStringConst, strCompareElementXMLImpl>  xmlAttributeMap ;
-    typedef xmlAttributeMap::iterator                                       xmlAttributeMapIter ;
-    typedef xmlAttributeMap::const_iterator                                 xmlAttributeMapConstIter ;
+// Used to store the attributes, sorted by attribute name.  This used to be a std::map,
+// but elements rarely have more than a handful of attributes and a sorted vector
+// needs one allocation for all of them rather than one for each.
+    typedef std::vector<xmlAttribute>               xmlAttributeMap ;
+    typedef xmlAttributeMap::iterator               xmlAttributeMapIter ;
+    typedef xmlAttributeMap::const_iterator         xmlAttributeMapConstIter ;
     
     /*************************************************************
     * @brief The ElementXMLImpl class represents an element in an XML stream.
@@ -87,6 +97,9 @@ namespace soarxml
             // Let MessageGenerator have access to Fast methods (which are protected because they take care to use correctly).
             friend class MessageGenerator ;
             
+            // The pull parser writes (unescaped) strings straight into the element's arena.
+            friend class ParseXMLPull ;
+            
         protected:
             int             m_ErrorCode ;       // Used to report any errors.
             bool            m_UseCData ;        // If true, should store character data in a CDATA section when encoding as XML.
@@ -101,6 +114,56 @@ namespace soarxml
             ElementXMLImpl* m_pParent ;         // The parent of this object (can be NULL)
             
             xmlStringList   m_StringsToDelete ; // List of strings we now own and should delete when we are destroyed.
+            ElementXMLArena m_Arena ;           // Strings we've copied (tag, attributes, comment, character data).  Released all at once when we are destroyed.
+            
+            /*************************************************************
+            * @brief Copies a string into the arena (rather than a separate allocation).
+            *************************************************************/
+            char* CopyToArena(char const* original) ;
+            char* CopyBufferToArena(char const* original, int length) ;
+            
+            /*************************************************************
+            * @brief Returns length bytes of (uninitialized) space in the arena,
+            *        or a separate allocation once the arena has had too much
+            *        replaced (see ElementXMLArena).
+            *************************************************************/
+            char* AllocateInArena(size_t length) ;
+            
+            /*************************************************************
+            * @brief Reuses the space of a string that's being replaced, if it can.
+            *************************************************************/
+            bool CopyOverString(char const* pOld, size_t oldLength, char const* pNew, size_t newLength) ;
+            
+            /*************************************************************
+            * @brief Gives back a string of ours that has been replaced.
+            *************************************************************/
+            void ReleaseString(char const* pString, size_t length) ;
+            
+            /*************************************************************
+            * @brief Records that we've taken ownership of a string allocated with AllocateString().
+            *        (Strings that are already in our arena are ignored, as we own them anyway,
+            *        and so are strings AllocateInArena() already recorded).
+            *************************************************************/
+            void AddStringToDelete(char* pString) ;
+            
+            /*************************************************************
+            * @brief True if the string was copied into this element (or handed over to it),
+            *        false if it is a constant set through one of the Fast methods.
+            *************************************************************/
+            bool IsOwnedString(char const* pString) const ;
+            
+            /*************************************************************
+            * @brief Adds the attribute to the (sorted) list or replaces
+            *        its value if it's already there (releasing the old value).
+            *************************************************************/
+            void SetAttributeValue(char const* attributeName, char const* attributeValue) ;
+            
+            /*************************************************************
+            * @brief Returns the attribute with this name, or the end of the list.
+            *************************************************************/
+            xmlAttributeMapIter FindAttribute(char const* attributeName) ;
+            
+            enum { kInitialAttributes = 8 } ;
             
             /*************************************************************
             * @brief Destructor.  This is private so we are forced to
@@ -190,7 +253,7 @@ namespace soarxml
             *************************************************************/
             bool SetTagName(char const* tagName)
             {
-                return SetTagName(CopyString(tagName), false) ;
+                return SetTagName(const_cast<char*>(tagName), true) ;
             }
             
             /*************************************************************
@@ -274,11 +337,11 @@ namespace soarxml
             *************************************************************/
             bool AddAttribute(char const* attributeName, char* attributeValue)
             {
-                return AddAttribute(CopyString(attributeName), attributeValue, false, true) ;
+                return AddAttribute(const_cast<char*>(attributeName), attributeValue, true, true) ;
             }
             bool AddAttribute(char const* attributeName, char const* attributeValue)
             {
-                return AddAttribute(CopyString(attributeName), CopyString(attributeValue), false, false) ;
+                return AddAttribute(const_cast<char*>(attributeName), const_cast<char*>(attributeValue), true, true) ;
             }
             
             /*************************************************************
@@ -481,6 +544,8 @@ namespace soarxml
                 xmlString str = (xmlString)malloc(length + 1) ;
                 str[0] = 0 ;
                 
+                CountAllocation() ;
+                
                 return str ;
             }
             
@@ -511,6 +576,8 @@ namespace soarxml
                     return NULL ;
                 }
                 
+                CountAllocation() ;
+                
                 return strdup(original) ;
             }
             
@@ -523,6 +590,39 @@ namespace soarxml
             *************************************************************/
             static char* CopyBuffer(char const* original, int length) ;
             
+            /*************************************************************
+            * @brief Records a heap allocation made for an element (the element itself,
+            *        a string, an arena chunk or growing one of its lists).
+            *        Counting is an atomic increment shared by every thread, so it's
+            *        only done after SetCountAllocations(true).
+            *************************************************************/
+            static inline void CountAllocation()
+            {
+                if (s_CountAllocations)
+                {
+                    AddAllocation() ;
+                }
+            }
+            
+            /*************************************************************
+            * @brief Turns allocation counting on or off (it starts off).
+            *************************************************************/
+            static void SetCountAllocations(bool count) ;
+            
+            /*************************************************************
+            * @brief Returns the total number of allocations recorded by CountAllocation().
+            *        Compare two readings to count the allocations made in between
+            *        (e.g. building a particular command).  Returns -1 if counting
+            *        is off.
+            *************************************************************/
+            static long GetAllocationCount() ;
+            
+        protected:
+            static bool s_CountAllocations ;
+            static void AddAllocation() ;
+            
+        public:
+            
 //protected:
             /*************************************************************
             * @brief Adds an attribute name-value pair.
@@ -24,6 +24,7 @@
 #include "ElementXMLImpl.h"
 #include "ParseXMLFile.h"
 #include "ParseXMLString.h"
+#include "ParseXMLPull.h"
 
 #include <string>
 #include <cstdio>
@@ -478,6 +479,25 @@ char* soarxml_CopyBuffer(char const* original, int length)
     return ElementXMLImpl::CopyBuffer(original, length) ;
 }
 
+/*************************************************************
+* @brief    Returns the number of heap allocations made for elements so far
+*           (the elements, their strings and their lists of children/attributes),
+*           or -1 if counting is off.
+*************************************************************/
+long soarxml_GetAllocationCount()
+{
+    return ElementXMLImpl::GetAllocationCount() ;
+}
+
+/*************************************************************
+* @brief    Turns counting of the allocations made for elements on or off.
+*           Counting is an atomic increment on each allocation, so it starts off.
+*************************************************************/
+void soarxml_SetCountAllocations(bool count)
+{
+    ElementXMLImpl::SetCountAllocations(count) ;
+}
+
 /*************************************************************
 * @brief Adds an attribute name-value pair.
 *
@@ -553,7 +573,7 @@ ElementXML_Handle soarxml_ParseXMLFromString(char const* pString)
         return NULL ;
     }
     
-    ParseXMLString parser(pString, 0) ;
+    ParseXMLPull parser(pString, strlen(pString)) ;
     ElementXMLImpl* pXML = parser.ParseElement() ;
     
     if (!pXML)
@@ -581,11 +601,11 @@ ElementXML_Handle soarxml_ParseXMLFromStringSequence(char const* pString, size_t
         return NULL ;
     }
     
-    ParseXMLString parser(pString, startPos) ;
+    ParseXMLPull parser(pString, strlen(pString), startPos) ;
     
     ElementXMLImpl* pXML = parser.ParseElement() ;
     
-    *endPos = parser.getEndPosition() ;
+    *endPos = parser.GetPosition() ;
     
     if (!pXML)
     {
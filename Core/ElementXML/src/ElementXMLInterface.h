@@ -386,6 +386,19 @@ EXPORT char* soarxml_CopyString(char const* original) ;
 *************************************************************/
 EXPORT char* soarxml_CopyBuffer(char const* original, int length) ;
 
+/*************************************************************
+* @brief    Returns the number of heap allocations made for elements so far
+*           (the elements, their strings and their lists of children/attributes),
+*           or -1 if counting is off.
+*************************************************************/
+EXPORT long soarxml_GetAllocationCount() ;
+
+/*************************************************************
+* @brief    Turns counting of the allocations made for elements on or off.
+*           Counting is an atomic increment on each allocation, so it starts off.
+*************************************************************/
+EXPORT void soarxml_SetCountAllocations(bool count) ;
+
 /*************************************************************
 * @brief Adds an attribute name-value pair.
 *
@@ -0,0 +1,572 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// ParseXMLPull class
+//
+// A pull parser that reads an XML document in place, one event at a time.
+// See ParseXMLPull.h for details.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "ParseXMLPull.h"
+#include "ElementXMLImpl.h"
+
+using namespace soarxml;
+
+// The same special attribute ParseXML looks for, which marks character data as hex encoded binary.
+static char const* kBinaryEncodingAtt = "bin_encoding" ;
+
+/*************************************************************
+* @brief Converts an escape sequence (e.g. &lt;) to the original character.
+*        pStart points to the '&' and length is the number of chars up to (not including) the ';'.
+*        Uses the same rules as ParseXML::GetEscapeChar().
+*************************************************************/
+static char UnescapeChar(char const* pStart, size_t length)
+{
+    if (length < 3)
+    {
+        return '&' ;
+    }
+    
+    switch (pStart[1])
+    {
+        case 'l':
+            return '<' ;
+        case 'g':
+            return '>' ;
+        case 'q':
+            return '"' ;
+        case 'a':
+            return (pStart[2] == 'm') ? '&' : '\'' ;
+    }
+    
+    return '&' ;
+}
+
+static bool IsWhiteSpaceOnly(XMLStringView const& view)
+{
+    for (size_t i = 0 ; i < view.GetLength() ; i++)
+    {
+        char ch = view.GetStart()[i] ;
+        
+        if (ch != ' ' && ch != '\t' && ch != '\r' && ch != '\n')
+        {
+            return false ;
+        }
+    }
+    
+    return true ;
+}
+
+size_t XMLStringView::CopyTo(char* pDest) const
+{
+    if (!m_Escaped)
+    {
+        memcpy(pDest, m_pStart, m_Length) ;
+        return m_Length ;
+    }
+    
+    char const* pEnd = m_pStart + m_Length ;
+    char* pOut = pDest ;
+    
+    for (char const* p = m_pStart ; p < pEnd ; p++)
+    {
+        if (*p != '&')
+        {
+            *pOut++ = *p ;
+            continue ;
+        }
+        
+        char const* pSemi = p ;
+        while (pSemi < pEnd && *pSemi != ';')
+        {
+            pSemi++ ;
+        }
+        
+        // A stray '&' with no ';' is copied through unchanged
+        if (pSemi == pEnd)
+        {
+            *pOut++ = *p ;
+            continue ;
+        }
+        
+        *pOut++ = UnescapeChar(p, pSemi - p) ;
+        p = pSemi ;
+    }
+    
+    return pOut - pDest ;
+}
+
+bool XMLStringView::Equals(char const* pStr) const
+{
+    if (!m_Escaped)
+    {
+        return strlen(pStr) == m_Length && memcmp(m_pStart, pStr, m_Length) == 0 ;
+    }
+    
+    return ToString().compare(pStr) == 0 ;
+}
+
+std::string XMLStringView::ToString() const
+{
+    if (!m_Escaped)
+    {
+        return std::string(m_pStart, m_Length) ;
+    }
+    
+    std::string result(m_Length, ' ') ;
+    result.resize(CopyTo(&result[0])) ;
+    return result ;
+}
+
+ParseXMLPull::ParseXMLPull(char const* pBuffer, size_t length, size_t startPos)
+{
+    m_pBuffer = pBuffer ;
+    m_Length = length ;
+    m_Pos = startPos ;
+    m_State = kContent ;
+    m_Event = kEndDocument ;
+    
+    if (!m_pBuffer)
+    {
+        Error("Invalid input string") ;
+    }
+}
+
+ParseXMLPull::~ParseXMLPull()
+{
+}
+
+ParseXMLPull::EventType ParseXMLPull::Error(std::string const& msg)
+{
+    // We only report the first error
+    if (m_Event != kError)
+    {
+        m_ErrorMsg = msg ;
+        m_Event = kError ;
+    }
+    
+    return m_Event ;
+}
+
+void ParseXMLPull::SkipWhiteSpace()
+{
+    while (!AtEnd() && IsWhiteSpace(m_pBuffer[m_Pos]))
+    {
+        m_Pos++ ;
+    }
+}
+
+bool ParseXMLPull::ReadName(XMLStringView* pName)
+{
+    size_t start = m_Pos ;
+    
+    while (!AtEnd() && IsNameChar(m_pBuffer[m_Pos]))
+    {
+        m_Pos++ ;
+    }
+    
+    *pName = XMLStringView(m_pBuffer + start, m_Pos - start, false) ;
+    
+    return m_Pos > start ;
+}
+
+ParseXMLPull::EventType ParseXMLPull::Next()
+{
+    if (m_Event == kError)
+    {
+        return kError ;
+    }
+    
+    switch (m_State)
+    {
+        case kInTag:
+            m_Event = ReadInTag() ;
+            break ;
+        case kContent:
+            m_Event = ReadContent() ;
+            break ;
+        case kDone:
+            m_Event = kEndDocument ;
+            break ;
+    }
+    
+    return m_Event ;
+}
+
+/************************************************************************
+*
+* Reads what follows a start tag (or comes before the first one):
+* character data, comments, child elements and end tags.
+*
+*************************************************************************/
+ParseXMLPull::EventType ParseXMLPull::ReadContent()
+{
+    while (true)
+    {
+        if (AtEnd())
+        {
+            if (m_OpenElements.empty())
+            {
+                m_State = kDone ;
+                return kEndDocument ;
+            }
+            
+            return Error("Unexpected end of file when parsing file") ;
+        }
+        
+        // Character data runs up to the next tag
+        if (m_pBuffer[m_Pos] != '<')
+        {
+            size_t start = m_Pos ;
+            bool escaped = false ;
+            bool whiteSpace = true ;
+            
+            while (!AtEnd() && m_pBuffer[m_Pos] != '<')
+            {
+                char ch = m_pBuffer[m_Pos] ;
+                escaped = escaped || (ch == '&') ;
+                whiteSpace = whiteSpace && IsWhiteSpace(ch) ;
+                m_Pos++ ;
+            }
+            
+            if (m_OpenElements.empty())
+            {
+                if (whiteSpace)
+                {
+                    continue ;
+                }
+                
+                return Error("Found character data outside of an element") ;
+            }
+            
+            m_Value = XMLStringView(m_pBuffer + start, m_Pos - start, escaped) ;
+            return kCharData ;
+        }
+        
+        if (LookingAt("</"))
+        {
+            return ReadEndTag() ;
+        }
+        
+        if (LookingAt("<!"))
+        {
+            return ReadComment() ;
+        }
+        
+        // For now ignore header tags <? ... ?>
+        if (LookingAt("<?"))
+        {
+            while (!AtEnd() && m_pBuffer[m_Pos] != '>')
+            {
+                m_Pos++ ;
+            }
+            
+            if (AtEnd())
+            {
+                return Error("Unexpected end of file when parsing file") ;
+            }
+            
+            m_Pos++ ;
+            continue ;
+        }
+        
+        // Start tag
+        m_Pos++ ;
+        SkipWhiteSpace() ;
+        
+        if (!ReadName(&m_Name))
+        {
+            return Error("Looking for a tag name after <") ;
+        }
+        
+        m_OpenElements.push_back(m_Name) ;
+        m_State = kInTag ;
+        
+        return kStartElement ;
+    }
+}
+
+/************************************************************************
+*
+* Reads the attributes of a start tag, up to and including the closing > or />
+*
+*************************************************************************/
+ParseXMLPull::EventType ParseXMLPull::ReadInTag()
+{
+    SkipWhiteSpace() ;
+    
+    if (AtEnd())
+    {
+        return Error("Unexpected end of file when parsing file") ;
+    }
+    
+    // Single tag <tag ... />
+    if (LookingAt("/>"))
+    {
+        m_Pos += 2 ;
+        m_Name = m_OpenElements.back() ;
+        m_OpenElements.pop_back() ;
+        m_State = m_OpenElements.empty() ? kDone : kContent ;
+        
+        return kEndElement ;
+    }
+    
+    if (m_pBuffer[m_Pos] == '>')
+    {
+        m_Pos++ ;
+        m_State = kContent ;
+        
+        return ReadContent() ;
+    }
+    
+    // Attribute name="value"
+    if (!ReadName(&m_Name))
+    {
+        return Error("Found an unexpected character '" + std::string(1, m_pBuffer[m_Pos]) + "' in the tag for " + m_OpenElements.back().ToString()) ;
+    }
+    
+    SkipWhiteSpace() ;
+    
+    if (AtEnd() || m_pBuffer[m_Pos] != '=')
+    {
+        return Error("Looking for = after attribute " + m_Name.ToString()) ;
+    }
+    
+    m_Pos++ ;
+    SkipWhiteSpace() ;
+    
+    if (AtEnd() || m_pBuffer[m_Pos] != '"')
+    {
+        return Error("Looking for a quoted value for attribute " + m_Name.ToString()) ;
+    }
+    
+    m_Pos++ ;
+    
+    size_t start = m_Pos ;
+    bool escaped = false ;
+    
+    while (!AtEnd() && m_pBuffer[m_Pos] != '"')
+    {
+        escaped = escaped || (m_pBuffer[m_Pos] == '&') ;
+        m_Pos++ ;
+    }
+    
+    if (AtEnd())
+    {
+        return Error("Unexpected end of file when parsing file") ;
+    }
+    
+    m_Value = XMLStringView(m_pBuffer + start, m_Pos - start, escaped) ;
+    
+    // Consume the closing quote
+    m_Pos++ ;
+    
+    return kAttribute ;
+}
+
+ParseXMLPull::EventType ParseXMLPull::ReadEndTag()
+{
+    // Consume the </
+    m_Pos += 2 ;
+    SkipWhiteSpace() ;
+    
+    if (!ReadName(&m_Name))
+    {
+        return Error("Looking for a tag name after </") ;
+    }
+    
+    SkipWhiteSpace() ;
+    
+    if (AtEnd() || m_pBuffer[m_Pos] != '>')
+    {
+        return Error("Looking for > to close the end tag for " + m_Name.ToString()) ;
+    }
+    
+    m_Pos++ ;
+    
+    if (m_OpenElements.empty())
+    {
+        return Error("Found the closing tag for " + m_Name.ToString() + " without an opening tag") ;
+    }
+    
+    XMLStringView const& open = m_OpenElements.back() ;
+    
+    if (open.GetLength() != m_Name.GetLength() || memcmp(open.GetStart(), m_Name.GetStart(), open.GetLength()) != 0)
+    {
+        return Error("The closing tag for " + open.ToString() + " doesn't match the opening tag") ;
+    }
+    
+    m_OpenElements.pop_back() ;
+    m_State = m_OpenElements.empty() ? kDone : kContent ;
+    
+    return kEndElement ;
+}
+
+ParseXMLPull::EventType ParseXMLPull::ReadComment()
+{
+    if (!LookingAt("<!--"))
+    {
+        return Error("Only comments <!-- --> are supported after <!") ;
+    }
+    
+    m_Pos += 4 ;
+    size_t start = m_Pos ;
+    
+    while (!AtEnd() && !LookingAt("-->"))
+    {
+        m_Pos++ ;
+    }
+    
+    if (AtEnd())
+    {
+        return Error("Error trying to parse a comment.  Started with <!-- but had no ending -->") ;
+    }
+    
+    m_Value = XMLStringView(m_pBuffer + start, m_Pos - start, false) ;
+    
+    // Consume the -->
+    m_Pos += 3 ;
+    
+    return kComment ;
+}
+
+bool ParseXMLPull::SkipElement()
+{
+    if (m_Event != kStartElement)
+    {
+        return false ;
+    }
+    
+    int depth = GetDepth() ;
+    
+    while (Next() != kError)
+    {
+        if (m_Event == kEndElement && GetDepth() == depth - 1)
+        {
+            return true ;
+        }
+    }
+    
+    return false ;
+}
+
+/*************************************************************
+* @brief Copies the (unescaped) view into the element's arena
+*        as a null terminated string.
+*************************************************************/
+char* ParseXMLPull::CopyToElement(ElementXMLImpl* pElement, XMLStringView const& view)
+{
+    char* pStr = pElement->AllocateInArena(view.GetLength() + 1) ;
+    size_t length = view.CopyTo(pStr) ;
+    pStr[length] = 0 ;
+    
+    return pStr ;
+}
+
+/************************************************************************
+*
+* Builds an ElementXMLImpl tree for the next element in the buffer.
+* Produces the same tree ParseXML::ParseElement() would.
+*
+* @return The element or NULL if there was an error.
+*
+*************************************************************************/
+ElementXMLImpl* ParseXMLPull::ParseElement()
+{
+    ElementXMLImpl* pRoot = NULL ;
+    
+    // The elements we're currently inside and whether their data is encoded binary
+    std::vector<ElementXMLImpl*> open ;
+    std::vector<bool> dataIsEncoded ;
+    
+    // A comment is attached to the element that follows it
+    XMLStringView comment ;
+    bool hasComment = false ;
+    
+    while (true)
+    {
+        switch (Next())
+        {
+            case kComment:
+                comment = m_Value ;
+                hasComment = true ;
+                break ;
+                
+            case kStartElement:
+            {
+                ElementXMLImpl* pElement = new ElementXMLImpl() ;
+                pElement->SetTagNameFast(CopyToElement(pElement, m_Name)) ;
+                
+                if (hasComment)
+                {
+                    pElement->SetComment(comment.ToString().c_str()) ;
+                    hasComment = false ;
+                }
+                
+                if (open.empty())
+                {
+                    pRoot = pElement ;
+                }
+                else
+                {
+                    open.back()->AddChild(pElement) ;
+                }
+                
+                open.push_back(pElement) ;
+                dataIsEncoded.push_back(false) ;
+                break ;
+            }
+            
+            case kAttribute:
+                // We don't show the encoding attribute to the user, instead we decode the
+                // character data as binary and they can call "IsDataBinary".
+                if (m_Name.Equals(kBinaryEncodingAtt))
+                {
+                    dataIsEncoded.back() = true ;
+                    break ;
+                }
+                
+                // Both strings are in the element's arena, so it owns them already
+                open.back()->AddAttributeFastFast(CopyToElement(open.back(), m_Name), CopyToElement(open.back(), m_Value)) ;
+                break ;
+                
+            case kCharData:
+                // White space between child elements is just formatting, so don't let it replace the element's data
+                if (open.back()->GetNumberChildren() > 0 && IsWhiteSpaceOnly(m_Value))
+                {
+                    break ;
+                }
+                
+                open.back()->SetCharacterData(CopyToElement(open.back(), m_Value), false) ;
+                
+                if (dataIsEncoded.back())
+                {
+                    open.back()->ConvertCharacterDataToBinary() ;
+                }
+                break ;
+                
+            case kEndElement:
+                open.pop_back() ;
+                dataIsEncoded.pop_back() ;
+                
+                if (open.empty())
+                {
+                    return pRoot ;
+                }
+                break ;
+                
+            case kEndDocument:
+                Error("Unexpected end of file when parsing file") ;
+                
+                // Fall through
+            case kError:
+                // This deletes the entire tree
+                if (pRoot)
+                {
+                    pRoot->ReleaseRef() ;
+                }
+                return NULL ;
+        }
+    }
+}
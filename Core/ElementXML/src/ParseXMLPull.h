@@ -0,0 +1,226 @@
+/////////////////////////////////////////////////////////////////
+// ParseXMLPull class
+//
+// A pull parser that reads an XML document in place, one event at a time.
+//
+// ParseXMLString builds a std::string for every token and then a complete
+// ElementXMLImpl tree before the caller can look at any of it.  This class
+// works directly on the caller's buffer instead: each call to Next() moves to
+// the next start tag, attribute, block of character data, comment or end tag,
+// and the names and values are returned as XMLStringViews that point into the
+// buffer.  Nothing is copied or unescaped unless the caller asks for it.
+//
+// A caller that only needs a few values from a message (e.g. the name of a
+// command and its arguments) can read them this way without building a tree.
+// ParseElement() builds the usual ElementXMLImpl tree from the events for
+// callers that do want it (soarxml_ParseXMLFromString uses this).
+//
+// It accepts the same subset of XML as ParseXML (and the same "bin_encoding"
+// attribute when building a tree).  The buffer must stay unchanged while it
+// is being parsed.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef PARSE_XML_PULL_H
+#define PARSE_XML_PULL_H
+
+#include "Export.h"
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+namespace soarxml
+{
+
+    class ElementXMLImpl ;
+    
+    /*************************************************************
+    * @brief A (pointer, length) reference to a string inside the buffer
+    *        being parsed.  It is not null terminated and, if IsEscaped() is true,
+    *        still contains XML escape sequences (e.g. &lt;).
+    *************************************************************/
+    class EXPORT XMLStringView
+    {
+        public:
+            XMLStringView()
+            {
+                m_pStart = NULL ;
+                m_Length = 0 ;
+                m_Escaped = false ;
+            }
+            
+            XMLStringView(char const* pStart, size_t length, bool escaped)
+            {
+                m_pStart = pStart ;
+                m_Length = length ;
+                m_Escaped = escaped ;
+            }
+            
+            char const* GetStart() const
+            {
+                return m_pStart ;
+            }
+            size_t      GetLength() const
+            {
+                return m_Length ;
+            }
+            bool        IsEscaped() const
+            {
+                return m_Escaped ;
+            }
+            
+            /*************************************************************
+            * @brief Returns true if the (unescaped) view is equal to the string.
+            *************************************************************/
+            bool Equals(char const* pStr) const ;
+            
+            /*************************************************************
+            * @brief Writes the unescaped string to pDest (which must hold at least
+            *        GetLength() chars) and returns the number of chars written.
+            *        No trailing null is added.
+            *************************************************************/
+            size_t CopyTo(char* pDest) const ;
+            
+            /*************************************************************
+            * @brief Returns the unescaped string.
+            *************************************************************/
+            std::string ToString() const ;
+            
+        protected:
+            char const* m_pStart ;
+            size_t      m_Length ;
+            bool        m_Escaped ;
+    } ;
+    
+    class EXPORT ParseXMLPull
+    {
+        public:
+            enum EventType { kStartElement, kAttribute, kCharData, kComment, kEndElement, kEndDocument, kError } ;
+            
+            /*************************************************************
+            * @brief Parses one XML document from pBuffer, starting at startPos.
+            *
+            * Parsing stops at the end of the first complete element, so a buffer
+            * holding a sequence of documents can be read by starting the next
+            * parser at GetPosition().
+            *************************************************************/
+            ParseXMLPull(char const* pBuffer, size_t length, size_t startPos = 0) ;
+            virtual ~ParseXMLPull() ;
+            
+            /*************************************************************
+            * @brief Moves to the next event and returns its type.
+            *
+            * kStartElement     GetName() is the tag name.  The element's attributes follow as kAttribute events.
+            * kAttribute        GetName() and GetValue() are the attribute name and value.
+            * kCharData         GetValue() is a block of character data.
+            * kComment          GetValue() is the text of a comment.
+            * kEndElement       GetName() is the tag name (for <tag/> as well as </tag>).
+            * kEndDocument      The first element is complete (or the buffer ended before any element started).
+            * kError            GetErrorMessage() describes the problem.  Every later call also returns kError.
+            *************************************************************/
+            EventType Next() ;
+            
+            EventType GetEventType() const
+            {
+                return m_Event ;
+            }
+            XMLStringView const& GetName() const
+            {
+                return m_Name ;
+            }
+            XMLStringView const& GetValue() const
+            {
+                return m_Value ;
+            }
+            
+            /*************************************************************
+            * @brief The number of elements that are currently open
+            *        (1 for the root element's attributes and data).
+            *************************************************************/
+            int GetDepth() const
+            {
+                return static_cast<int>(m_OpenElements.size()) ;
+            }
+            
+            /*************************************************************
+            * @brief The position just after the last event read.
+            *        After kEndDocument this is where the next document (if any) starts.
+            *************************************************************/
+            size_t GetPosition() const
+            {
+                return m_Pos ;
+            }
+            
+            /*************************************************************
+            * @brief After a kStartElement event, skips past the rest of that element
+            *        (its attributes, data and children) to its kEndElement.
+            *************************************************************/
+            bool SkipElement() ;
+            
+            /*************************************************************
+            * @brief Reads the next complete element and builds an ElementXMLImpl tree for it.
+            *
+            * @returns NULL if there was an error (see GetErrorMessage()).
+            *************************************************************/
+            ElementXMLImpl* ParseElement() ;
+            
+            bool IsError() const
+            {
+                return m_Event == kError ;
+            }
+            std::string GetErrorMessage() const
+            {
+                return m_ErrorMsg ;
+            }
+            
+        protected:
+            enum State { kContent, kInTag, kDone } ;
+            
+            char const* m_pBuffer ;
+            size_t      m_Length ;
+            size_t      m_Pos ;
+            State       m_State ;
+            
+            EventType       m_Event ;
+            XMLStringView   m_Name ;
+            XMLStringView   m_Value ;
+            std::string     m_ErrorMsg ;
+            
+            // The names of the elements we're inside, so we can check end tags match.
+            std::vector<XMLStringView> m_OpenElements ;
+            
+            EventType ReadContent() ;
+            EventType ReadInTag() ;
+            EventType ReadEndTag() ;
+            EventType ReadComment() ;
+            
+            bool ReadName(XMLStringView* pName) ;
+            void SkipWhiteSpace() ;
+            
+            EventType Error(std::string const& msg) ;
+            
+            bool AtEnd() const
+            {
+                return m_Pos >= m_Length ;
+            }
+            bool LookingAt(char const* pStr) const
+            {
+                size_t len = strlen(pStr) ;
+                return m_Pos + len <= m_Length && memcmp(m_pBuffer + m_Pos, pStr, len) == 0 ;
+            }
+            static bool IsWhiteSpace(char ch)
+            {
+                return (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') ;
+            }
+            static bool IsNameChar(char ch)
+            {
+                return !IsWhiteSpace(ch) && ch != '<' && ch != '>' && ch != '/' && ch != '?' && ch != '=' && ch != '"' ;
+            }
+            
+            static char* CopyToElement(ElementXMLImpl* pElement, XMLStringView const& view) ;
+    } ;
+    
+}   // namespace
+
+#endif // PARSE_XML_PULL_H
@@ -2,7 +2,9 @@
 #include "src/sml_AgentListener.cpp"
 #include "src/sml_AgentOutputFlusher.cpp"
 #include "src/sml_AgentSML.cpp"
+#include "src/sml_CommandTable.cpp"
 #include "src/sml_ConnectionManager.cpp"
+#include "src/sml_EventBatcher.cpp"
 #include "src/sml_EventManager.cpp"
 #include "src/sml_InputListener.cpp"
 #include "src/sml_KernelCallback.cpp"
@@ -17,6 +19,7 @@
 #include "src/sml_RhsListener.cpp"
 #include "src/sml_RunListener.cpp"
 #include "src/sml_RunScheduler.cpp"
+#include "src/sml_RunThreads.cpp"
 #include "src/sml_StringListener.cpp"
 #include "src/sml_SystemListener.cpp"
 #include "src/sml_UpdateListener.cpp"
@@ -17,6 +17,7 @@
 #include "sml_OutputListener.h"
 #include "sml_StringOps.h"
 #include "sml_KernelSML.h"
+#include "sml_TagWme.h"
 #include "sml_RhsFunction.h"
 
 #include "KernelHeaders.h"
@@ -46,6 +47,8 @@ AgentSML::AgentSML(KernelSML* pKernelSML, agent* pAgent)
     m_pCaptureFile = 0;
     getSoarInstance()->Register_Soar_AgentSML(pAgent->name, this);
     
+    ResetStepStats() ;
+    
 }
 
 void AgentSML::InitListeners()
@@ -110,6 +113,11 @@ AgentSML::~AgentSML()
     
     delete m_pAgentRunCallback ;
     
+    for (InputBatchReaderMapIter iter = m_InputBatchReaders.begin() ; iter != m_InputBatchReaders.end() ; iter++)
+    {
+        delete iter->second ;
+    }
+    
     /* RPM 9/06 added code from reinitialize_soar to clean up stuff hanging from last run
                need to put it here instead of in destroy_soar_agent because gSKI is
                 cleaning up too much stuff and thus it will crash if called later */
@@ -274,6 +282,14 @@ void AgentSML::RemoveAllListeners(Connection* pConnection)
     m_PrintListener.RemoveAllListeners(pConnection);
     m_OutputListener.RemoveAllListeners(pConnection) ;
     m_XMLListener.RemoveAllListeners(pConnection) ;
+    
+    // The connection is going away, so we won't see any more batches that use its handles
+    InputBatchReaderMapIter iter = m_InputBatchReaders.find(pConnection) ;
+    if (iter != m_InputBatchReaders.end())
+    {
+        delete iter->second ;
+        m_InputBatchReaders.erase(iter) ;
+    }
 }
 
 /*************************************************************
@@ -1269,7 +1285,7 @@ bool AgentSML::StartCaptureInput(const std::string& pathname, bool autoflush, ui
     m_pCaptureFile = new std::fstream(pathname.c_str(), std::fstream::out | std::fstream::trunc);
     if (m_pCaptureFile && m_pCaptureFile->good())
     {
-        SoarSeedRNG(seed);
+        SoarSeedRNG(m_agent, seed);
         *m_pCaptureFile << seed << std::endl;
         return true;
     }
@@ -1349,7 +1365,7 @@ bool AgentSML::StartReplayInput(const std::string& pathname)
     {
         return false;
     }
-    SoarSeedRNG(seed);
+    SoarSeedRNG(m_agent, seed);
     
     // load replay file
     while (getline(replayFile, line))
@@ -1608,3 +1624,128 @@ void AgentSML::BufferedRemoveInputWME(int64_t clientTimeTag)
 {
     m_DirectInputDeltaList.push_back(DirectInputDelta(clientTimeTag));
 }
+
+// What a std::map or std::list node adds to its value (the links and the color)
+#define SML_NODE_OVERHEAD (4 * sizeof(void*))
+
+template <class Container>
+static size_t GetNodesMemoryUsage(Container const& container)
+{
+    return container.size() * (SML_NODE_OVERHEAD + sizeof(typename Container::value_type)) ;
+}
+
+static size_t GetIdentifierMapMemoryUsage(IdentifierMap const& map)
+{
+    size_t bytes = GetNodesMemoryUsage(map) ;
+    for (IdentifierMapConstIter iter = map.begin() ; iter != map.end() ; iter++)
+    {
+        bytes += iter->first.capacity() + iter->second.capacity() ;
+    }
+    return bytes ;
+}
+
+size_t AgentSML::GetMemoryUsage() const
+{
+    size_t bytes = GetIdentifierMapMemoryUsage(m_IdentifierMap) + GetIdentifierMapMemoryUsage(m_ToClientIdentifierMap) ;
+    
+    bytes += GetNodesMemoryUsage(m_IdentifierRefMap) ;
+    for (IdentifierRefMapConstIter iter = m_IdentifierRefMap.begin() ; iter != m_IdentifierRefMap.end() ; iter++)
+    {
+        bytes += iter->first.capacity() ;
+    }
+    
+    bytes += GetNodesMemoryUsage(m_CKTimeMap) + GetNodesMemoryUsage(m_KCTimeMap) + GetNodesMemoryUsage(m_KernelTimeTagToWmeMap) ;
+    bytes += GetNodesMemoryUsage(m_PendingInput) + GetNodesMemoryUsage(m_DirectInputDeltaList) ;
+    bytes += m_InputBatchChanges.capacity() * sizeof(InputBatchChange) ;
+    
+    return bytes ;
+}
+
+bool AgentSML::AddInputBatch(Connection* pConnection, char const* pData, size_t length)
+{
+    InputBatchReader*& pReader = m_InputBatchReaders[pConnection] ;
+    if (!pReader)
+    {
+        pReader = new InputBatchReader() ;
+    }
+    
+    m_InputBatchChanges.clear() ;
+    if (!pReader->Read(pData, length, &m_InputBatchChanges))
+    {
+        return false ;
+    }
+    
+    for (size_t i = 0 ; i < m_InputBatchChanges.size() ; i++)
+    {
+        InputBatchChange const& change = m_InputBatchChanges[i] ;
+        
+        switch (change.m_Type)
+        {
+            case InputBatch::kAddString:
+                BufferedAddStringInputWME(change.m_pID, change.m_pAttribute, change.m_pValue, change.m_TimeTag) ;
+                break ;
+            case InputBatch::kAddInt:
+                BufferedAddIntInputWME(change.m_pID, change.m_pAttribute, change.m_IntValue, change.m_TimeTag) ;
+                break ;
+            case InputBatch::kAddDouble:
+                BufferedAddDoubleInputWME(change.m_pID, change.m_pAttribute, change.m_DoubleValue, change.m_TimeTag) ;
+                break ;
+            case InputBatch::kAddId:
+                BufferedAddIdInputWME(change.m_pID, change.m_pAttribute, change.m_pValue, change.m_TimeTag) ;
+                break ;
+            case InputBatch::kRemove:
+                BufferedRemoveInputWME(change.m_TimeTag) ;
+                break ;
+        }
+    }
+    
+    // Listeners for the input received event still get the usual list of <wme> tags (rarely used, so only built on demand)
+    if (m_XMLListener.HasEvents(smlEVENT_XML_INPUT_RECEIVED))
+    {
+        soarxml::ElementXML command ;
+        char buf[TO_C_STRING_BUFSIZE] ;
+        std::string temp ;
+        
+        for (size_t i = 0 ; i < m_InputBatchChanges.size() ; i++)
+        {
+            InputBatchChange const& change = m_InputBatchChanges[i] ;
+            
+            TagWme* pTag = new TagWme() ;
+            pTag->SetTimeTag(change.m_TimeTag) ;
+            
+            if (change.m_Type == InputBatch::kRemove)
+            {
+                pTag->SetActionRemove() ;
+            }
+            else
+            {
+                pTag->SetIdentifier(change.m_pID) ;
+                pTag->SetAttribute(change.m_pAttribute) ;
+                
+                switch (change.m_Type)
+                {
+                    case InputBatch::kAddInt:
+                        pTag->SetValue(to_c_string(change.m_IntValue, buf), sml_Names::kTypeInt) ;
+                        break ;
+                    case InputBatch::kAddDouble:
+                        pTag->SetValue(to_string(change.m_DoubleValue, temp).c_str(), sml_Names::kTypeDouble) ;
+                        break ;
+                    case InputBatch::kAddId:
+                        pTag->SetValue(change.m_pValue, sml_Names::kTypeID) ;
+                        break ;
+                    default:
+                        pTag->SetValue(change.m_pValue, sml_Names::kTypeString) ;
+                        break ;
+                }
+                
+                pTag->SetActionAdd() ;
+            }
+            
+            command.AddChild(pTag) ;
+        }
+        
+        FireInputReceivedEvent(&command) ;
+    }
+    
+    return true ;
+}
@@ -18,6 +18,7 @@
 #include "sml_XMLListener.h"
 #include "sml_OutputListener.h"
 #include "sml_InputListener.h"
+#include "sml_InputBatch.h"
 
 #include "callback.h"
 
@@ -29,6 +30,7 @@ typedef struct wme_struct wme;
 
 #include <map>
 #include <list>
+#include <vector>
 #include <string>
 #include <fstream>
 
@@ -69,6 +71,10 @@ namespace sml
     typedef std::list<soarxml::ElementXML*>     PendingInputList ;
     typedef PendingInputList::iterator          PendingInputListIter ;
     
+// Map from a connection to the reader that holds its input batch handles (see sml_InputBatch.h)
+    typedef std::map< Connection*, InputBatchReader* >  InputBatchReaderMap ;
+    typedef InputBatchReaderMap::iterator               InputBatchReaderMapIter ;
+    
 // Map of kernel time tags to kernel wmes for input
     typedef std::map< uint64_t, wme* >          WmeMap;
     typedef WmeMap::iterator                    WmeMapIter;
@@ -136,6 +142,22 @@ namespace sml
                 return &m_DirectInputDeltaList ;
             }
             
+            /*************************************************************
+            * @brief    Decodes a batch of input changes sent by a client on this connection
+            *           (see sml_InputBatch.h) and adds them to the buffered direct list,
+            *           so they are applied at the next input phase.
+            *
+            * @returns  false if the batch could not be read (none of it is applied).
+            *************************************************************/
+            bool AddInputBatch(Connection* pConnection, char const* pData, size_t length) ;
+            
+            /*************************************************************
+            * @brief    An estimate of the memory this agent's SML state takes
+            *           up (its identifier and time tag maps and the input
+            *           waiting for the next input phase), for memory accounting.
+            *************************************************************/
+            size_t GetMemoryUsage() const ;
+            
         protected:
         
             // A reference to the underlying kernel agent object
@@ -172,6 +194,10 @@ namespace sml
             // Input changes waiting to be processed at next input phase callback
             PendingInputList    m_PendingInput ;
             
+            // One reader for each connection sending batched input, and the changes read from the current batch
+            InputBatchReaderMap             m_InputBatchReaders ;
+            std::vector<InputBatchChange>   m_InputBatchChanges ;
+            
             // Used to listen for a before removed event
             //class AgentBeforeDestroyedListener ;
             //AgentBeforeDestroyedListener* m_pBeforeDestroyedListener ;
@@ -190,6 +216,12 @@ namespace sml
             smlRunState     m_runState;          // Current agent run state
             unsigned        m_interruptFlags;    // Flags indicating an interrupt request
             
+            // How long this agent's steps take (kept across init-soar)
+            uint64_t        m_StepCount ;
+            uint64_t        m_StepUSec ;
+            uint64_t        m_LastStepUSec ;
+            double          m_StepCost ;         // Recent average, in usec
+            
             // Used for update world events
             bool            m_CompletedOutputPhase ;
             bool            m_GeneratedOutput ;
@@ -605,6 +637,40 @@ namespace sml
             
             uint64_t GetRunCounter(smlRunStepSize runStepSize) ;
             
+            // The run scheduler records how long each step takes, so the run threads can start the expensive agents first
+            void RecordStepTime(uint64_t usec)
+            {
+                m_StepCount++ ;
+                m_StepUSec += usec ;
+                m_LastStepUSec = usec ;
+                
+                // Weighted toward recent steps, as what an agent is doing changes as it runs
+                m_StepCost += (static_cast<double>(usec) - m_StepCost) / 8 ;
+            }
+            uint64_t GetStepCount()
+            {
+                return m_StepCount ;
+            }
+            uint64_t GetStepUSec()
+            {
+                return m_StepUSec ;
+            }
+            uint64_t GetLastStepUSec()
+            {
+                return m_LastStepUSec ;
+            }
+            double GetStepCost()
+            {
+                return m_StepCost ;
+            }
+            void ResetStepStats()
+            {
+                m_StepCount = 0 ;
+                m_StepUSec = 0 ;
+                m_LastStepUSec = 0 ;
+                m_StepCost = 0 ;
+            }
+            
             // Request that the agent stop soon.
             void Interrupt(smlStopLocationFlags stopLoc) ;
             void ClearInterrupts() ;
@@ -658,6 +724,11 @@ namespace sml
                     }
                 }
             }
+            
+            virtual bool IsAgentLocal(int)
+            {
+                return true ;
+            }
     } ;
     
 }
@@ -0,0 +1,106 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// CommandTable class
+//
+// Maps incoming command names to the KernelSML methods that handle them.
+// See sml_CommandTable.h.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "sml_CommandTable.h"
+
+#include <string.h>
+
+using namespace sml ;
+
+CommandTable::CommandTable()
+{
+    Rehash(64) ;
+}
+
+uint32_t CommandTable::Hash(char const* pName)
+{
+    // FNV-1a, which is plenty for a few dozen short names
+    uint32_t hash = 2166136261u ;
+    
+    for (unsigned char const* p = reinterpret_cast<unsigned char const*>(pName) ; *p ; p++)
+    {
+        hash ^= *p ;
+        hash *= 16777619u ;
+    }
+    
+    return hash ;
+}
+
+size_t CommandTable::FindSlot(char const* pName, uint32_t hash) const
+{
+    size_t mask = m_Index.size() - 1 ;
+    size_t slot = hash & mask ;
+    
+    // The index is never more than half full, so this always finds an empty slot
+    while (m_Index[slot] != kUnknownCommand)
+    {
+        Command const& command = m_Commands[m_Index[slot]] ;
+        
+        if (command.m_Hash == hash && strcmp(command.m_pName, pName) == 0)
+        {
+            break ;
+        }
+        
+        slot = (slot + 1) & mask ;
+    }
+    
+    return slot ;
+}
+
+void CommandTable::Rehash(size_t size)
+{
+    m_Index.assign(size, static_cast<int>(kUnknownCommand)) ;
+    
+    for (size_t id = 0 ; id < m_Commands.size() ; id++)
+    {
+        m_Index[FindSlot(m_Commands[id].m_pName, m_Commands[id].m_Hash)] = static_cast<int>(id) ;
+    }
+}
+
+int CommandTable::Add(char const* pName, CommandFunction pFunction)
+{
+    uint32_t hash = Hash(pName) ;
+    size_t slot = FindSlot(pName, hash) ;
+    
+    if (m_Index[slot] != kUnknownCommand)
+    {
+        m_Commands[m_Index[slot]].m_pFunction = pFunction ;
+        return m_Index[slot] ;
+    }
+    
+    Command command ;
+    command.m_pName = pName ;
+    command.m_Hash = hash ;
+    command.m_pFunction = pFunction ;
+    
+    int id = static_cast<int>(m_Commands.size()) ;
+    m_Commands.push_back(command) ;
+    
+    if (m_Commands.size() * 2 > m_Index.size())
+    {
+        Rehash(m_Index.size() * 2) ;
+    }
+    else
+    {
+        m_Index[slot] = id ;
+    }
+    
+    return id ;
+}
+
+int CommandTable::GetID(char const* pName) const
+{
+    if (!pName)
+    {
+        return kUnknownCommand ;
+    }
+    
+    return m_Index[FindSlot(pName, Hash(pName))] ;
+}
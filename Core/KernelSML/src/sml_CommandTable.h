@@ -0,0 +1,97 @@
+/////////////////////////////////////////////////////////////////
+// CommandTable class
+//
+// The table KernelSML uses to find the handler for an incoming command.
+//
+// Each command is given a small integer id when it's added (its position
+// in the table) and its name is hashed into an open addressed index, so
+// finding a handler is one hash of the name and (almost always) one string
+// compare.  Unlike the std::map this replaced it never allocates while
+// looking a name up, and a name it doesn't know isn't added to it.
+//
+// The names are not copied, so they must outlive the table (we use the
+// strings in sml_Names).
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SML_COMMAND_TABLE_H
+#define SML_COMMAND_TABLE_H
+
+#include "portability.h"
+
+#include <vector>
+
+namespace soarxml
+{
+    class ElementXML ;
+}
+
+namespace sml
+{
+
+    class KernelSML ;
+    class AgentSML ;
+    class Connection ;
+    class AnalyzeXML ;
+    
+// Define the CommandFunction which we'll call to process commands
+    typedef bool (KernelSML::*CommandFunction)(AgentSML*, char const*, Connection*, AnalyzeXML*, soarxml::ElementXML*);
+    
+    class CommandTable
+    {
+        public:
+            enum { kUnknownCommand = -1 } ;
+            
+            CommandTable() ;
+            
+            /*************************************************************
+            * @brief Adds a command (or replaces its handler if it's already
+            *        in the table) and returns its id.
+            *************************************************************/
+            int Add(char const* pName, CommandFunction pFunction) ;
+            
+            // Returns the id of this command or kUnknownCommand
+            int GetID(char const* pName) const ;
+            
+            // The handler for a command id returned by Add() or GetID()
+            CommandFunction GetFunction(int id) const
+            {
+                return m_Commands[id].m_pFunction ;
+            }
+            
+            char const* GetName(int id) const
+            {
+                return m_Commands[id].m_pName ;
+            }
+            
+            int GetSize() const
+            {
+                return static_cast<int>(m_Commands.size()) ;
+            }
+            
+        protected:
+            struct Command
+            {
+                char const*     m_pName ;
+                uint32_t        m_Hash ;
+                CommandFunction m_pFunction ;
+            } ;
+            
+            // The commands, indexed by id
+            std::vector<Command>    m_Commands ;
+            
+            // Open addressed hash index holding ids (kUnknownCommand for an empty slot).
+            // Its size is a power of two and kept at least twice the number of commands.
+            std::vector<int>        m_Index ;
+            
+            static uint32_t Hash(char const* pName) ;
+            
+            // Returns the slot holding this name, or the empty slot where it would go
+            size_t FindSlot(char const* pName, uint32_t hash) const ;
+            
+            void Rehash(size_t size) ;
+    } ;
+    
+} // Namespace
+
+#endif // SML_COMMAND_TABLE_H
@@ -18,6 +18,11 @@
 #include "sml_ListenerThread.h"
 #include "sml_ReceiverThread.h"
 #include "sml_KernelSML.h"
+#include "sml_EventBatcher.h"
+
+#ifdef ENABLE_EPOLL
+#include "sock_Reactor.h"
+#endif
 
 #include <time.h>   // To get clock
 
@@ -26,6 +31,23 @@ using namespace sock ;
 
 ConnectionManager::ConnectionManager(int port, KernelSML* pKernel)
 {
+    // The reactor has to exist before the listener starts adding connections
+    m_pReactor = NULL ;
+#ifdef ENABLE_EPOLL
+    sock::Reactor* pReactor = new sock::Reactor() ;
+    if (pReactor->IsValid())
+    {
+        m_pReactor = pReactor ;
+    }
+    else
+    {
+        delete pReactor ;
+    }
+#endif
+
+    // Its thread only starts once there are events to send
+    m_pEventBatcher = new EventBatcher() ;
+
     // Start the thread that wraps the listener socket running.
     // (Unless passed port 0 -- which suppresses this)
     m_ListenerThread = NULL ;
@@ -53,6 +75,17 @@ ConnectionManager::~ConnectionManager()
     {
         Shutdown() ;
     }
+    
+    delete m_pEventBatcher ;
+    
+#ifdef ENABLE_EPOLL
+    if (m_pReactor)
+    {
+        // Make sure nothing is still waiting on it
+        StopReceiverThread() ;
+        delete m_pReactor ;
+    }
+#endif
 }
 
 // Cause the receiver thread to quit.
@@ -61,6 +94,16 @@ void ConnectionManager::StopReceiverThread()
     // Stop the receiver thread (and wait until is has stopped)
     if (m_ReceiverThread)
     {
+        m_ReceiverThread->Stop(false) ;
+        
+#ifdef ENABLE_EPOLL
+        // It may be waiting on the reactor with no time limit
+        if (m_pReactor)
+        {
+            m_pReactor->Wake() ;
+        }
+#endif
+
         m_ReceiverThread->Stop(true) ;
     }
 }
@@ -105,7 +148,7 @@ void ConnectionManager::Shutdown()
     // Stop the receiver thread (and wait until is has stopped)
     if (m_ReceiverThread)
     {
-        m_ReceiverThread->Stop(true) ;
+        StopReceiverThread() ;
         
         //  sml::PrintDebug("Receiver stopped") ;
         
@@ -114,6 +157,9 @@ void ConnectionManager::Shutdown()
         m_ReceiverThread = NULL ;
     }
     
+    // Stop sending events before the connections go away
+    m_pEventBatcher->Shutdown() ;
+    
     // Serialize thread access to the connections list
     soar_thread::Lock lock(&m_ConnectionsMutex) ;
     
@@ -134,6 +180,7 @@ void ConnectionManager::Shutdown()
     }
     
     m_Connections.clear() ;
+    m_ReactorConnections.clear() ;
     
     // Now clean up all closed connections.
     for (ConnectionsIter iter = m_ClosedConnections.begin() ; iter != m_ClosedConnections.end() ; iter++)
@@ -161,6 +208,20 @@ void ConnectionManager::AddConnection(Connection* pConnection)
     pConnection->SetStatus(sml_Names::kStatusCreated) ;
     
     m_Connections.push_back(pConnection) ;
+    
+#ifdef ENABLE_EPOLL
+    // Sockets (and asynchronous embedded connections) let the reactor tell us when they have input.  Anything else we poll.
+    if (m_pReactor)
+    {
+        if (pConnection->AttachReactor(m_pReactor))
+        {
+            m_ReactorConnections.insert(pConnection) ;
+        }
+        
+        // Let the receiver thread know there's something new to wait for (or poll)
+        m_pReactor->Wake() ;
+    }
+#endif
 }
 
 Connection* ConnectionManager::GetConnectionByIndex(int i)
@@ -198,6 +259,14 @@ void ConnectionManager::RemoveConnection(Connection* pConnection)
     
     // Remove the connection from our list
     m_Connections.remove(pConnection) ;
+    m_ReactorConnections.erase(pConnection) ;
+}
+
+bool ConnectionManager::HasPolledConnections()
+{
+    soar_thread::Lock lock(&m_ConnectionsMutex) ;
+    
+    return m_Connections.size() > m_ReactorConnections.size() ;
 }
 
 void ConnectionManager::SetAgentStatus(char const* pStatus)
@@ -217,6 +286,32 @@ void ConnectionManager::SetAgentStatus(char const* pStatus)
 // Those calls could take a long time to execute (e.g. a call to Run Soar).
 // Returns true if we received at least one message.
 bool ConnectionManager::ReceiveAllMessages()
+{
+    return ReceiveMessages(NULL) ;
+}
+
+bool ConnectionManager::ReceiveReadyMessages(int milliseconds)
+{
+    std::set< Connection* > ready ;
+    
+#ifdef ENABLE_EPOLL
+    std::vector< void* > readyList ;
+    m_pReactor->Wait(milliseconds, &readyList) ;
+    
+    for (std::vector< void* >::iterator iter = readyList.begin() ; iter != readyList.end() ; iter++)
+    {
+        ready.insert(static_cast<Connection*>(*iter)) ;
+    }
+#else
+    unused(milliseconds) ;
+#endif
+
+    return ReceiveMessages(&ready) ;
+}
+
+// If pReady is not NULL, connections the reactor is watching are only read if they're in pReady
+// (the rest are still checked to see if they've closed, which doesn't involve the socket).
+bool ConnectionManager::ReceiveMessages(std::set< Connection* > const* pReady)
 {
     int index = 0 ;
     bool receivedOneMessage = false ;
@@ -236,7 +331,18 @@ bool ConnectionManager::ReceiveAllMessages()
         // (which includes if the other side has dropped its half of the socket)
         if (!pConnection->IsClosed())
         {
-            receivedOneMessage = pConnection->ReceiveMessages(true) || receivedOneMessage ;
+            bool read = true ;
+            
+            if (pReady && pReady->find(pConnection) == pReady->end())
+            {
+                soar_thread::Lock lock(&m_ConnectionsMutex) ;
+                read = (m_ReactorConnections.find(pConnection) == m_ReactorConnections.end()) ;
+            }
+            
+            if (read)
+            {
+                receivedOneMessage = pConnection->ReceiveMessages(true) || receivedOneMessage ;
+            }
         }
         else
         {
@@ -19,6 +19,12 @@
 #include "sml_Connection.h"
 
 #include <list>
+#include <set>
+
+namespace sock
+{
+    class Reactor ;
+}
 
 namespace sml
 {
@@ -27,6 +33,7 @@ namespace sml
     class KernelSML ;
     class ListenerThread ;
     class ReceiverThread ;
+    class EventBatcher ;
     
     class ConnectionManager
     {
@@ -54,6 +61,19 @@ namespace sml
             // (and perhaps embedded connections too?)
             bool    m_bTraceCommunications ;
             
+            // Tells us which sockets have input (see sock_Reactor.h).
+            // NULL if the platform doesn't support it, in which case we poll every connection.
+            sock::Reactor*              m_pReactor ;
+            
+            // The connections the reactor is watching (guarded by m_ConnectionsMutex).
+            // The rest (embedded connections and shared memory) still need polling.
+            std::set< Connection* >     m_ReactorConnections ;
+            
+            // Collects print and trace events for remote connections and sends them on its own thread
+            EventBatcher*               m_pEventBatcher ;
+            
+            bool ReceiveMessages(std::set< Connection* > const* pReady) ;
+            
         public:
             ConnectionManager(int port, KernelSML* pKernel) ;
             ~ConnectionManager() ;
@@ -90,6 +110,30 @@ namespace sml
             // for more messages (and presumably shutdown completely).
             bool ReceiveAllMessages() ;
             
+            /*************************************************************
+            * @brief Waits up to milliseconds (-1 for no limit) for input on
+            *        the sockets and then reads messages from those that have it,
+            *        as well as from any connections we have to poll.
+            *        Returns true if we received at least one message.
+            *
+            *        Only the receiver thread calls this.
+            *************************************************************/
+            bool ReceiveReadyMessages(int milliseconds) ;
+            
+            // True if we have a reactor, so ReceiveReadyMessages can be used
+            bool IsEventDriven()
+            {
+                return m_pReactor != NULL ;
+            }
+            
+            // True if some connections can't tell the reactor when they have input
+            bool HasPolledConnections() ;
+            
+            EventBatcher* GetEventBatcher()
+            {
+                return m_pEventBatcher ;
+            }
+            
             // Cause the receiver thread to quit.
             void StopReceiverThread() ;
             
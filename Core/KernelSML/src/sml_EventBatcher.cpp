@@ -0,0 +1,433 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// EventBatcher class
+//
+// Collects the print and XML trace events going to remote connections
+// and sends them from a thread of its own.  See sml_EventBatcher.h.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "sml_EventBatcher.h"
+
+#include "sml_Connection.h"
+#include "sml_Names.h"
+#include "sock_DataSender.h"
+#include "ElementXML.h"
+
+#include <sstream>
+#include <vector>
+#include <string.h>
+
+using namespace sml ;
+
+// Our guess at the size of a message around the text or trace it carries
+static const size_t kMessageOverhead = 128 ;
+
+// And at the size of each element of a trace (so we don't have to generate the XML to find out)
+static const size_t kTraceElementBytes = 64 ;
+
+static size_t EstimateTraceSize(soarxml::ElementXML const* pTrace)
+{
+    size_t size = kTraceElementBytes ;
+    int children = pTrace->GetNumberChildren() ;
+    
+    for (int i = 0 ; i < children ; i++)
+    {
+        soarxml::ElementXML child ;
+        pTrace->GetChild(&child, i) ;
+        size += EstimateTraceSize(&child) ;
+    }
+    
+    return size ;
+}
+
+EventBatcher::EventBatcher()
+{
+    m_Window = kDefaultWindow ;
+    m_MaxBatchBytes = kDefaultMaxBatchBytes ;
+    m_MaxBacklogBytes = kDefaultMaxBacklogBytes ;
+    m_RawPerMillisecond = get_raw_time_per_usec() * 1000.0 ;
+}
+
+EventBatcher::~EventBatcher()
+{
+    Shutdown() ;
+    
+    for (StateMapIter iter = m_State.begin() ; iter != m_State.end() ; iter++)
+    {
+        Batch* pBatch = iter->second.m_pBatch ;
+        
+        if (pBatch)
+        {
+            delete pBatch->m_pTrace ;
+            delete pBatch ;
+        }
+    }
+}
+
+void EventBatcher::SetLimits(int windowMilliseconds, int maxBatchBytes, int maxBacklogBytes)
+{
+    {
+        soar_thread::Lock lock(&m_Mutex) ;
+        
+        m_Window = (windowMilliseconds > 0) ? windowMilliseconds : 0 ;
+        m_MaxBatchBytes = (maxBatchBytes > 0) ? static_cast<size_t>(maxBatchBytes) : 0 ;
+        m_MaxBacklogBytes = (maxBacklogBytes > 0) ? static_cast<size_t>(maxBacklogBytes) : 0 ;
+    }
+    
+    // If batching is now off, nothing should be left waiting
+    if (m_Window == 0)
+    {
+        Commit(NULL) ;
+    }
+}
+
+bool EventBatcher::IsBatching(Connection* pConnection)
+{
+    return m_Window > 0 && pConnection->IsRemoteConnection() ;
+}
+
+void EventBatcher::AddPrint(Connection* pConnection, char const* pAgentName, char const* pEventName, char const* pText)
+{
+    size_t length = strlen(pText) ;
+    
+    soar_thread::Lock lock(&m_Mutex) ;
+    
+    ConnectionState* pState = Prepare(pConnection, pAgentName, pEventName, length, true) ;
+    
+    if (pState)
+    {
+        pState->m_pBatch->m_Text.append(pText, length) ;
+        pState->m_pBatch->m_Size += length ;
+        Added(pConnection, pState) ;
+    }
+}
+
+void EventBatcher::AddTrace(Connection* pConnection, char const* pAgentName, char const* pEventName, soarxml::ElementXML const* pTrace)
+{
+    size_t size = EstimateTraceSize(pTrace) ;
+    
+    soar_thread::Lock lock(&m_Mutex) ;
+    
+    ConnectionState* pState = Prepare(pConnection, pAgentName, pEventName, size, false) ;
+    
+    if (!pState)
+    {
+        return ;
+    }
+    
+    Batch* pBatch = pState->m_pBatch ;
+    
+    if (!pBatch->m_pTrace)
+    {
+        pBatch->m_pTrace = pTrace->MakeCopy() ;
+    }
+    else
+    {
+        // Move this trace's contents into the one we already have
+        int children = pTrace->GetNumberChildren() ;
+        
+        for (int i = 0 ; i < children ; i++)
+        {
+            soarxml::ElementXML child ;
+            pTrace->GetChild(&child, i) ;
+            pBatch->m_pTrace->AddChild(child.MakeCopy()) ;
+        }
+    }
+    
+    pBatch->m_Size += size ;
+    Added(pConnection, pState) ;
+}
+
+// Returns the state for this connection with a batch ready for the event
+// (or NULL if the event should be dropped instead).
+EventBatcher::ConnectionState* EventBatcher::Prepare(Connection* pConnection, char const* pAgentName, char const* pEventName, size_t size, bool print)
+{
+    StateMapIter iter = m_State.find(pConnection) ;
+    
+    if (iter == m_State.end())
+    {
+        ConnectionState state ;
+        state.m_pBatch = NULL ;
+        state.m_Stats.m_BatchedEvents = 0 ;
+        state.m_Stats.m_Batches = 0 ;
+        state.m_Stats.m_DroppedEvents = 0 ;
+        state.m_Stats.m_DroppedBytes = 0 ;
+        state.m_UnreportedEvents = 0 ;
+        state.m_UnreportedBytes = 0 ;
+        
+        iter = m_State.insert(std::make_pair(pConnection, state)).first ;
+    }
+    
+    ConnectionState* pState = &iter->second ;
+    
+    // The backlog is everything waiting to be sent to this listener, including what
+    // the socket is holding on to (when it's waiting for the client to read it).
+    size_t backlog = pConnection->GetQueuedBytes() + (pState->m_pBatch ? pState->m_pBatch->m_Size : 0) ;
+    
+    sock::DataSenderStats stats ;
+    if (pConnection->GetStats(&stats))
+    {
+        backlog += static_cast<size_t>(stats.m_QueuedBytes) ;
+    }
+    
+    if (m_MaxBacklogBytes != 0 && backlog + size > m_MaxBacklogBytes)
+    {
+        pState->m_Stats.m_DroppedEvents++ ;
+        pState->m_Stats.m_DroppedBytes += size ;
+        
+        if (print)
+        {
+            pState->m_UnreportedEvents++ ;
+            pState->m_UnreportedBytes += size ;
+            pState->m_UnreportedAgent = pAgentName ;
+            pState->m_UnreportedEvent = pEventName ;
+        }
+        
+        return NULL ;
+    }
+    
+    // The listener has caught up, so tell it what it missed before anything else
+    if (pState->m_UnreportedEvents != 0)
+    {
+        ReportDrops(pConnection, pState) ;
+    }
+    
+    Batch* pBatch = pState->m_pBatch ;
+    
+    // Only events of the same kind, for the same agent, can share a batch
+    if (pBatch && (pBatch->m_Agent != pAgentName || pBatch->m_Event != pEventName || (pBatch->m_pTrace == NULL) != print))
+    {
+        CommitBatch(pConnection, pState) ;
+        pBatch = NULL ;
+    }
+    
+    if (!pBatch)
+    {
+        pBatch = new Batch() ;
+        pBatch->m_Agent = pAgentName ;
+        pBatch->m_Event = pEventName ;
+        pBatch->m_pTrace = NULL ;
+        pBatch->m_Size = kMessageOverhead ;
+        pBatch->m_Start = get_raw_time() ;
+        pBatch->m_Events = 0 ;
+        
+        pState->m_pBatch = pBatch ;
+        
+        // The delivery thread starts with the first batch, so kernels with no remote
+        // listeners never have one.
+        if (!IsStarted())
+        {
+            Start() ;
+        }
+    }
+    
+    return pState ;
+}
+
+void EventBatcher::ReportDrops(Connection* pConnection, ConnectionState* pState)
+{
+    std::ostringstream notice ;
+    notice << "\n*** Dropped " << pState->m_UnreportedEvents << " print events (" << pState->m_UnreportedBytes
+           << " bytes) because this connection fell behind ***\n" ;
+           
+    Batch* pBatch = pState->m_pBatch ;
+    
+    if (pBatch && (pBatch->m_pTrace || pBatch->m_Agent != pState->m_UnreportedAgent || pBatch->m_Event != pState->m_UnreportedEvent))
+    {
+        CommitBatch(pConnection, pState) ;
+        pBatch = NULL ;
+    }
+    
+    if (!pBatch)
+    {
+        pBatch = new Batch() ;
+        pBatch->m_Agent = pState->m_UnreportedAgent ;
+        pBatch->m_Event = pState->m_UnreportedEvent ;
+        pBatch->m_pTrace = NULL ;
+        pBatch->m_Size = kMessageOverhead ;
+        pBatch->m_Start = get_raw_time() ;
+        pBatch->m_Events = 0 ;
+        
+        pState->m_pBatch = pBatch ;
+    }
+    
+    pBatch->m_Text += notice.str() ;
+    pBatch->m_Size += notice.str().size() ;
+    
+    pState->m_UnreportedEvents = 0 ;
+    pState->m_UnreportedBytes = 0 ;
+}
+
+void EventBatcher::Added(Connection* pConnection, ConnectionState* pState)
+{
+    pState->m_pBatch->m_Events++ ;
+    pState->m_Stats.m_BatchedEvents++ ;
+    
+    // A full batch goes straight away
+    if (pState->m_pBatch->m_Size >= m_MaxBatchBytes)
+    {
+        CommitBatch(pConnection, pState) ;
+        m_WakeEvent.TriggerEvent() ;
+    }
+}
+
+void EventBatcher::CommitBatch(Connection* pConnection, ConnectionState* pState)
+{
+    Batch* pBatch = pState->m_pBatch ;
+    
+    if (!pBatch)
+    {
+        return ;
+    }
+    
+    // Build the same message the listener would have sent for a single event.
+    // (The agent has to be the first parameter of a trace message, see XMLListener).
+    soarxml::ElementXML* pMsg = pConnection->CreateSMLCommand(sml_Names::kCommand_Event) ;
+    pConnection->AddParameterToSMLCommand(pMsg, sml_Names::kParamAgent, pBatch->m_Agent.c_str()) ;
+    pConnection->AddParameterToSMLCommand(pMsg, sml_Names::kParamEventID, pBatch->m_Event.c_str()) ;
+    
+    if (pBatch->m_pTrace)
+    {
+        pMsg->AddChild(pBatch->m_pTrace) ;
+    }
+    else
+    {
+        pConnection->AddParameterToSMLCommand(pMsg, sml_Names::kParamMessage, pBatch->m_Text.c_str()) ;
+    }
+    
+    pConnection->QueueMessage(pMsg, pBatch->m_Size) ;
+    
+    pState->m_Stats.m_Batches++ ;
+    
+    delete pBatch ;
+    pState->m_pBatch = NULL ;
+}
+
+void EventBatcher::Commit(Connection* pConnection)
+{
+    bool committed = false ;
+    
+    {
+        soar_thread::Lock lock(&m_Mutex) ;
+        
+        if (pConnection)
+        {
+            StateMapIter iter = m_State.find(pConnection) ;
+            
+            if (iter != m_State.end() && iter->second.m_pBatch)
+            {
+                CommitBatch(pConnection, &iter->second) ;
+            }
+            
+            // The caller is about to send something, which sends the batch first
+            return ;
+        }
+        
+        for (StateMapIter iter = m_State.begin() ; iter != m_State.end() ; iter++)
+        {
+            if (iter->second.m_pBatch)
+            {
+                CommitBatch(iter->first, &iter->second) ;
+                committed = true ;
+            }
+        }
+    }
+    
+    if (committed)
+    {
+        m_WakeEvent.TriggerEvent() ;
+    }
+}
+
+void EventBatcher::RemoveConnection(Connection* pConnection)
+{
+    soar_thread::Lock lock(&m_Mutex) ;
+    
+    StateMapIter iter = m_State.find(pConnection) ;
+    
+    if (iter == m_State.end())
+    {
+        return ;
+    }
+    
+    Batch* pBatch = iter->second.m_pBatch ;
+    
+    if (pBatch)
+    {
+        delete pBatch->m_pTrace ;
+        delete pBatch ;
+    }
+    
+    m_State.erase(iter) ;
+}
+
+bool EventBatcher::GetStats(Connection* pConnection, EventBatchStats* pStats)
+{
+    soar_thread::Lock lock(&m_Mutex) ;
+    
+    StateMapIter iter = m_State.find(pConnection) ;
+    
+    if (iter == m_State.end())
+    {
+        return false ;
+    }
+    
+    *pStats = iter->second.m_Stats ;
+    return true ;
+}
+
+void EventBatcher::Shutdown()
+{
+    Stop(false) ;
+    
+    // It may be waiting for the window to pass
+    m_WakeEvent.TriggerEvent() ;
+    
+    Stop(true) ;
+}
+
+void EventBatcher::Run()
+{
+    std::vector< Connection* > ready ;
+    
+    while (!QuitNow())
+    {
+        // (The wait has to be under a second)
+        int window = m_Window ;
+        m_WakeEvent.WaitForEvent(0, (window <= 0 || window > 999) ? 999 : window) ;
+        
+        ready.clear() ;
+        
+        {
+            soar_thread::Lock lock(&m_Mutex) ;
+            
+            uint64_t now = get_raw_time() ;
+            double age = m_Window * m_RawPerMillisecond ;
+            
+            for (StateMapIter iter = m_State.begin() ; iter != m_State.end() ; iter++)
+            {
+                Batch* pBatch = iter->second.m_pBatch ;
+                
+                if (pBatch && static_cast<double>(now - pBatch->m_Start) >= age)
+                {
+                    CommitBatch(iter->first, &iter->second) ;
+                }
+                
+                if (iter->first->GetQueuedBytes() != 0)
+                {
+                    ready.push_back(iter->first) ;
+                }
+            }
+        }
+        
+        // Connections are only deleted once this thread has stopped (see ConnectionManager::Shutdown),
+        // so it's safe to send to them after releasing the lock.  Sending can wait on the connection
+        // while the agent's thread is using it, which is why we mustn't hold our lock here.
+        for (std::vector< Connection* >::iterator iter = ready.begin() ; iter != ready.end() && !QuitNow() ; iter++)
+        {
+            (*iter)->SendQueuedMessages() ;
+        }
+    }
+}
@@ -0,0 +1,168 @@
+/////////////////////////////////////////////////////////////////
+// EventBatcher class
+//
+// Collects the print and XML trace events going to remote connections
+// and sends them from a thread of its own, so a debugger watching the
+// trace no longer costs the agent a round trip for every event.
+//
+// Events for the same agent and event that arrive within the window
+// are merged into one message (print text is joined together, trace
+// tags are merged into one <trace>) until the batch reaches its size
+// limit.  A finished batch goes on the connection's outgoing queue (see
+// Connection::QueueMessage), which is always sent before the next
+// message that needs a response, so events still arrive in order.
+// Events that need the client to act during them (run events, output
+// etc.) are still sent synchronously; they just commit any batch first.
+//
+// A listener that falls behind far enough that its backlog passes the
+// limit has new print and trace events dropped (and counted).  Once it
+// catches up it's sent a line saying how much print output it missed.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SML_EVENT_BATCHER_H
+#define SML_EVENT_BATCHER_H
+
+#include "thread_Thread.h"
+#include "thread_Lock.h"
+#include "thread_Event.h"
+
+#include <map>
+#include <string>
+
+namespace soarxml
+{
+    class ElementXML ;
+}
+
+namespace sml
+{
+
+    class Connection ;
+    
+    // What the batcher has done for one connection (reported by get_connection_stats)
+    struct EventBatchStats
+    {
+        uint64_t    m_BatchedEvents ;   // Events that went into batches
+        uint64_t    m_Batches ;         // The messages they were sent as
+        uint64_t    m_DroppedEvents ;   // Events thrown away because the listener was too far behind
+        uint64_t    m_DroppedBytes ;    // The (estimated) size of those events
+    } ;
+    
+    class EventBatcher : public soar_thread::Thread
+    {
+        public:
+            enum
+            {
+                kDefaultWindow          = 10,               // Milliseconds
+                kDefaultMaxBatchBytes   = 64 * 1024,
+                kDefaultMaxBacklogBytes = 4 * 1024 * 1024
+            } ;
+            
+            EventBatcher() ;
+            virtual ~EventBatcher() ;
+            
+            /*************************************************************
+            * @brief Sets how long events are collected for, how large a batch
+            *        can grow and how far a listener can fall behind before
+            *        its events are dropped.
+            *        A window of 0 turns batching off (events are sent
+            *        synchronously to every connection, as they used to be).
+            *************************************************************/
+            void SetLimits(int windowMilliseconds, int maxBatchBytes, int maxBacklogBytes) ;
+            
+            int GetWindow()
+            {
+                return m_Window ;
+            }
+            int GetMaxBatchBytes()
+            {
+                return static_cast<int>(m_MaxBatchBytes) ;
+            }
+            int GetMaxBacklogBytes()
+            {
+                return static_cast<int>(m_MaxBacklogBytes) ;
+            }
+            
+            // True if print and trace events for this connection should go through AddPrint and AddTrace
+            bool IsBatching(Connection* pConnection) ;
+            
+            // Adds some print output (pEventName is the event's name, e.g. "print")
+            void AddPrint(Connection* pConnection, char const* pAgentName, char const* pEventName, char const* pText) ;
+            
+            // Adds an XML trace (copying it, so the caller keeps ownership)
+            void AddTrace(Connection* pConnection, char const* pAgentName, char const* pEventName, soarxml::ElementXML const* pTrace) ;
+            
+            /*************************************************************
+            * @brief Finishes any batch for this connection (or every connection
+            *        if NULL) and puts it on the connection's outgoing queue.
+            *        Call this before sending anything the client should see
+            *        after the events already batched.
+            *************************************************************/
+            void Commit(Connection* pConnection) ;
+            
+            // Forget a connection that's closing
+            void RemoveConnection(Connection* pConnection) ;
+            
+            // Returns false if we've never batched anything for this connection
+            bool GetStats(Connection* pConnection, EventBatchStats* pStats) ;
+            
+            // Stops the delivery thread (and waits for it)
+            void Shutdown() ;
+            
+        protected:
+            // The events being collected for a connection
+            struct Batch
+            {
+                std::string             m_Agent ;
+                std::string             m_Event ;
+                std::string             m_Text ;        // The print output
+                soarxml::ElementXML*    m_pTrace ;      // Or the trace (NULL for print events)
+                size_t                  m_Size ;
+                uint64_t                m_Start ;       // When the first event arrived (see get_raw_time)
+                uint64_t                m_Events ;
+            } ;
+            
+            struct ConnectionState
+            {
+                Batch*          m_pBatch ;          // NULL if nothing is being collected
+                EventBatchStats m_Stats ;
+                
+                // Print output dropped since we last told the listener about it
+                uint64_t        m_UnreportedEvents ;
+                uint64_t        m_UnreportedBytes ;
+                std::string     m_UnreportedAgent ;
+                std::string     m_UnreportedEvent ;
+            } ;
+            
+            typedef std::map< Connection*, ConnectionState >    StateMap ;
+            typedef StateMap::iterator                          StateMapIter ;
+            
+            // Guards everything below
+            soar_thread::Mutex  m_Mutex ;
+            
+            StateMap            m_State ;
+            
+            volatile int        m_Window ;          // Read without the lock by IsBatching
+            size_t              m_MaxBatchBytes ;
+            size_t              m_MaxBacklogBytes ;
+            
+            // Raw time ticks in a millisecond
+            double              m_RawPerMillisecond ;
+            
+            // Wakes the delivery thread early (when a batch fills up or we're stopping)
+            soar_thread::Event  m_WakeEvent ;
+            
+            // This method is executed in the delivery thread
+            void Run() ;
+            
+            // These expect m_Mutex to be held
+            ConnectionState* Prepare(Connection* pConnection, char const* pAgentName, char const* pEventName, size_t size, bool print) ;
+            void CommitBatch(Connection* pConnection, ConnectionState* pState) ;
+            void ReportDrops(Connection* pConnection, ConnectionState* pState) ;
+            void Added(Connection* pConnection, ConnectionState* pState) ;
+    } ;
+    
+} // Namespace
+
+#endif  // SML_EVENT_BATCHER_H
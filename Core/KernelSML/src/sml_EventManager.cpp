@@ -14,6 +14,8 @@
 #include "sml_EventManager.h"
 
 #include "sml_AgentSML.h"
+#include "sml_KernelSML.h"
+#include "sml_EventBatcher.h"
 
 using namespace sml ;
 
@@ -33,3 +35,12 @@ void sml::flushPrintOnAgent(AgentSML* pFlushPrintOnThisAgent)
         pFlushPrintOnThisAgent->FlushPrintOutput();
     }
 }
+
+void sml::commitBatchedEvents(Connection* pConnection)
+{
+    if (pConnection->IsRemoteConnection())
+    {
+        KernelSML* pKernelSML = static_cast<KernelSML*>(pConnection->GetUserData()) ;
+        pKernelSML->GetEventBatcher()->Commit(pConnection) ;
+    }
+}
@@ -35,6 +35,10 @@ namespace sml
 // sml_AgentSML.h currently breaks things.
     void flushPrintOnAgent(AgentSML* pFlushPrintOnThisAgent);
     
+// Puts any print or trace events batched for this connection on its outgoing queue
+// (see sml_EventBatcher.h), so they arrive before the event we're about to send.
+    void commitBatchedEvents(Connection* pConnection);
+    
     template<typename EventType> class EventManager : public KernelCallback
     {
         protected:
@@ -219,6 +223,8 @@ namespace sml
                     pConnection = *connectionIter ;
                     connectionIter++ ;
                     
+                    commitBatchedEvents(pConnection) ;
+                    
                     // It would be faster to just send a message here without waiting for a response
                     // but that could produce incorrect behavior if the client expects to act *during*
                     // the event that we're notifying them about (e.g. notification that we're in the input phase).
@@ -15,6 +15,7 @@
 
 #include "sml_Utils.h"
 #include "sml_AgentSML.h"
+#include "sml_RunThreads.h"
 
 #include "KernelHeaders.h"
 
@@ -24,6 +25,30 @@
 
 using namespace sml ;
 
+// An event fired while an agent is being stepped on a run thread, which we pass back to the thread running Soar
+class KernelEventCall : public RunThreadCall
+{
+    public:
+        KernelEventCall(KernelCallback* pCallback, int eventID, AgentSML* pAgentSML, void* pCallData)
+        {
+            m_pCallback = pCallback ;
+            m_EventID = eventID ;
+            m_pAgentSML = pAgentSML ;
+            m_pCallData = pCallData ;
+        }
+        
+        void Execute()
+        {
+            m_pCallback->OnKernelEvent(m_EventID, m_pAgentSML, m_pCallData) ;
+        }
+        
+    protected:
+        KernelCallback* m_pCallback ;
+        int             m_EventID ;
+        AgentSML*       m_pAgentSML ;
+        void*           m_pCallData ;
+} ;
+
 void KernelCallback::KernelCallbackStatic(agent* pAgent, int eventID, void* pData, void* pCallData)
 {
     KernelCallback* pThis = static_cast<KernelCallback*>(pData) ;
@@ -32,6 +57,14 @@ void KernelCallback::KernelCallbackStatic(agent* pAgent, int eventID, void* pDat
     (void)pAgent; // silences warning in release mode
     assert(pThis->m_pCallbackAgentSML->GetSoarAgent() == pAgent) ;
     
+    // Listeners are only ever called on the thread running Soar
+    if (RunThreads::OnWorkerThread() && !pThis->IsAgentLocal(eventID))
+    {
+        KernelEventCall call(pThis, eventID, pThis->m_pCallbackAgentSML, pCallData) ;
+        RunThreads::CallOnRunThread(&call) ;
+        return ;
+    }
+    
     // Make the callback to the non-static method
     pThis->OnKernelEvent(eventID, pThis->m_pCallbackAgentSML, pCallData) ;
 }
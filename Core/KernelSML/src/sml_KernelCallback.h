@@ -67,6 +67,14 @@ namespace sml
             
             // This is the actual callback for the event
             virtual void OnKernelEvent(int eventID, AgentSML* pAgentSML, void* pCallData) = 0 ;
+            
+            // Return true if OnKernelEvent only touches its own agent, so it can be called
+            // on whichever thread is stepping the agent (see sml_RunThreads.h).
+            // Anything that calls out to a client must leave this false.
+            virtual bool IsAgentLocal(int)
+            {
+                return false ;
+            }
     } ;
     
 }
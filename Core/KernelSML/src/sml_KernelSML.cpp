@@ -20,6 +20,7 @@
 #include "sml_Connection.h"
 #include "sml_OutputListener.h"
 #include "sml_ConnectionManager.h"
+#include "sml_EventBatcher.h"
 #include "sml_Events.h"
 #include "sml_RunScheduler.h"
 #include "sml_EmbeddedConnection.h"
@@ -33,6 +34,7 @@
 #include <stdlib.h>
 
 #include "KernelHeaders.h"
+#include "profiler.h"
 
 using namespace sml ;
 
@@ -412,6 +414,14 @@ void KernelSML::RemoveAllListeners(Connection* pConnection)
     m_SystemListener.RemoveAllListeners(pConnection);
     m_UpdateListener.RemoveAllListeners(pConnection) ;
     m_StringListener.RemoveAllListeners(pConnection) ;
+    
+    // And anything waiting to be sent to it
+    GetEventBatcher()->RemoveConnection(pConnection) ;
+}
+
+EventBatcher* KernelSML::GetEventBatcher()
+{
+    return m_pConnectionManager->GetEventBatcher() ;
 }
 
 /*************************************************************
@@ -578,9 +588,9 @@ void KernelSML::ClearAllInterrupts()
 bool KernelSML::ProcessCommand(char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse)
 {
     // Look up the function that handles this command
-    CommandFunction pFunction = m_CommandMap[pCommandName] ;
+    int commandID = m_CommandMap.GetID(pCommandName) ;
     
-    if (!pFunction)
+    if (commandID == CommandTable::kUnknownCommand)
     {
         // There is no handler for this command
         std::stringstream msg;
@@ -610,7 +620,25 @@ bool KernelSML::ProcessCommand(char const* pCommandName, Connection* pConnection
     }
     
     // Call to the handler (this is a pointer to member call so it's a bit odd)
-    bool result = (this->*pFunction)(pAgentSML, pCommandName, pConnection, pIncoming, pResponse) ;
+    CommandFunction pFunction = m_CommandMap.GetFunction(commandID) ;
+    bool result ;
+    
+    {
+        profile_span span(PROFILE_SML_COMMAND) ;
+        
+        uint64_t runCount = m_pRunScheduler->GetRunCount() ;
+        soar_timer timer ;
+        timer.start() ;
+        
+        result = (this->*pFunction)(pAgentSML, pCommandName, pConnection, pIncoming, pResponse) ;
+        
+        // A command that ran Soar takes as long as the run did, which says nothing about the kernel's latency
+        timer.stop() ;
+        if (m_pRunScheduler->GetRunCount() == runCount)
+        {
+            m_CommandLatency.record(timer.get_usec()) ;
+        }
+    }
     
     // If we return false, we report a generic error about the call.
     if (!result)
@@ -667,6 +695,13 @@ soarxml::ElementXML* KernelSML::ProcessIncomingSML(Connection* pConnection, soar
     if (pCommandName)
     {
         ProcessCommand(pCommandName, pConnection, &msg, pResponse) ;
+        
+        // Events the command caused should reach this client before the response does
+        // (the connection sends its queue first, see Connection::QueueMessage).
+        if (pConnection->IsRemoteConnection())
+        {
+            GetEventBatcher()->Commit(pConnection) ;
+        }
     }
     else
     {
@@ -27,6 +27,8 @@ typedef struct wme_struct wme;
 #include "sml_StringListener.h"
 #include "sml_Utils.h"
 #include "sml_Events.h"
+#include "sml_CommandTable.h"
+#include "misc.h"
 #include "init_soar.h"
 #include "soar_instance.h"
 
@@ -50,18 +52,11 @@ namespace sml
     class OutputListener ;
     class AgentSML;
     class ConnectionManager ;
+    class EventBatcher ;
     class Events ;
     class RunScheduler ;
     class KernelHelpers ;
     
-// Define the CommandFunction which we'll call to process commands
-    typedef bool (KernelSML::*CommandFunction)(AgentSML*, char const*, Connection*, AnalyzeXML*, soarxml::ElementXML*);
-    
-// Used to store a map from command name to function handler for that command
-    typedef std::map< std::string, CommandFunction >    CommandMap ;
-    typedef CommandMap::iterator                    CommandMapIter ;
-    typedef CommandMap::const_iterator              CommandMapConstIter ;
-    
 // Map from agent names to information we keep for SML about those agents.
     typedef std::map< std::string, AgentSML* >  AgentMap ;
     typedef AgentMap::iterator                  AgentMapIter ;
@@ -87,7 +82,7 @@ namespace sml
             static void*        s_hModule ;
             
             // Map from command name to function to handle it
-            CommandMap  m_CommandMap ;
+            CommandTable    m_CommandMap ;
             
             // Map from agent names to AgentSML objects, where we keep additional information
             // required for SML about each agent.
@@ -128,6 +123,9 @@ namespace sml
             
             RunScheduler*   m_pRunScheduler ;
             
+            // How long commands take to handle, in usec.  Commands that run Soar aren't included.
+            soar_latency_histogram m_CommandLatency ;
+            
             // If true, whenever a user issues a command that changes the state of the kernel in some manner
             // the command and its results are echoed to anyone listening.  This is useful when two users
             // are debugging the same kernel (and should be off at other times).
@@ -347,6 +345,12 @@ namespace sml
             *************************************************************/
             void RemoveAllListeners(Connection* pConnection) ;
             
+            /*************************************************************
+            * @brief    Collects print and trace events for remote connections
+            *           (see sml_EventBatcher.h).
+            *************************************************************/
+            EventBatcher* GetEventBatcher() ;
+            
             /*************************************************************
             * @brief    Receive and process any messages from remote connections
             *           that are waiting on a socket.
@@ -414,6 +418,15 @@ namespace sml
                 return m_pRunScheduler ;
             }
             
+            /*************************************************************
+            * @brief    How long the commands sent to the kernel have taken
+            *           to handle (see stats --histogram).
+            *************************************************************/
+            soar_latency_histogram* GetCommandLatency()
+            {
+                return &m_CommandLatency ;
+            }
+            
             /*************************************************************
             * @brief    Defines which phase we stop before when running by decision.
             *           E.g. Pass input phase to stop just after generating output and before receiving input.
@@ -510,6 +523,12 @@ namespace sml
             bool HandleIsSoarRunning(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
             bool HandleSetConnectionInfo(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
             bool HandleGetConnections(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
+            bool HandleGetConnectionStats(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
+            bool HandleSetEventBatching(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
+            bool HandleSetRunThreads(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
+            bool HandleGetRunThreadStats(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
+            bool HandleGetLatencyStats(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
+            bool HandleGetMemoryStats(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
             bool HandleGetAllInput(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
             bool HandleGetAllOutput(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
             bool HandleGetRunState(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
@@ -19,14 +19,19 @@
 #include "sml_Connection.h"
 #include "sml_OutputListener.h"
 #include "sml_ConnectionManager.h"
+#include "sml_EventBatcher.h"
+#include "sock_DataSender.h"
 #include "sml_TagResult.h"
 #include "sml_TagName.h"
 #include "sml_TagWme.h"
 #include "sml_TagFilter.h"
+#include "ParseXMLPull.h"
 #include "sml_TagCommand.h"
 #include "sml_Events.h"
 #include "sml_RunScheduler.h"
+#include "sml_RunThreads.h"
 #include "KernelHeaders.h"
+#include "profiler.h"
 
 #include <iostream>
 #include <fstream>
@@ -41,36 +46,42 @@ using namespace sml ;
 
 void KernelSML::BuildCommandMap()
 {
-    m_CommandMap[sml_Names::kCommand_CreateAgent]       = &sml::KernelSML::HandleCreateAgent ;
-    m_CommandMap[sml_Names::kCommand_DestroyAgent]      = &sml::KernelSML::HandleDestroyAgent ;
-    m_CommandMap[sml_Names::kCommand_GetInputLink]      = &sml::KernelSML::HandleGetInputLink ;
-    m_CommandMap[sml_Names::kCommand_Input]             = &sml::KernelSML::HandleInput ;
-    m_CommandMap[sml_Names::kCommand_CommandLine]       = &sml::KernelSML::HandleCommandLine ;
-    m_CommandMap[sml_Names::kCommand_CheckForIncomingCommands] = &sml::KernelSML::HandleCheckForIncomingCommands ;
-    m_CommandMap[sml_Names::kCommand_GetAgentList]      = &sml::KernelSML::HandleGetAgentList ;
-    m_CommandMap[sml_Names::kCommand_RegisterForEvent]  = &sml::KernelSML::HandleRegisterForEvent ;
-    m_CommandMap[sml_Names::kCommand_UnregisterForEvent] = &sml::KernelSML::HandleRegisterForEvent ; // Note -- both register and unregister go to same handler
-    m_CommandMap[sml_Names::kCommand_FireEvent]         = &sml::KernelSML::HandleFireEvent ;
-    m_CommandMap[sml_Names::kCommand_SuppressEvent]     = &sml::KernelSML::HandleSuppressEvent ;
-    m_CommandMap[sml_Names::kCommand_SetInterruptCheckRate] = &sml::KernelSML::HandleSetInterruptCheckRate ;
-    m_CommandMap[sml_Names::kCommand_GetVersion]        = &sml::KernelSML::HandleGetVersion ;
-    m_CommandMap[sml_Names::kCommand_Shutdown]          = &sml::KernelSML::HandleShutdown ;
-    m_CommandMap[sml_Names::kCommand_IsSoarRunning]     = &sml::KernelSML::HandleIsSoarRunning ;
-    m_CommandMap[sml_Names::kCommand_GetConnections]    = &sml::KernelSML::HandleGetConnections ;
-    m_CommandMap[sml_Names::kCommand_SetConnectionInfo] = &sml::KernelSML::HandleSetConnectionInfo ;
-    m_CommandMap[sml_Names::kCommand_GetAllInput]       = &sml::KernelSML::HandleGetAllInput ;
-    m_CommandMap[sml_Names::kCommand_GetAllOutput]      = &sml::KernelSML::HandleGetAllOutput ;
-    m_CommandMap[sml_Names::kCommand_GetRunState]       = &sml::KernelSML::HandleGetRunState ;
-    m_CommandMap[sml_Names::kCommand_IsProductionLoaded] = &sml::KernelSML::HandleIsProductionLoaded ;
-    m_CommandMap[sml_Names::kCommand_SendClientMessage] = &sml::KernelSML::HandleSendClientMessage ;
-    m_CommandMap[sml_Names::kCommand_WasAgentOnRunList] = &sml::KernelSML::HandleWasAgentOnRunList ;
-    m_CommandMap[sml_Names::kCommand_GetResultOfLastRun] = &sml::KernelSML::HandleGetResultOfLastRun ;
-    m_CommandMap[sml_Names::kCommand_GetInitialTimeTag] = &sml::KernelSML::HandleGetInitialTimeTag ;
-    m_CommandMap[sml_Names::kCommand_ConvertIdentifier] = &sml::KernelSML::HandleConvertIdentifier;
-    m_CommandMap[sml_Names::kCommand_GetListenerPort]   = &sml::KernelSML::HandleGetListenerPort;
-    m_CommandMap[sml_Names::kCommand_SVSInput] = &sml::KernelSML::HandleSVSInput;
-    m_CommandMap[sml_Names::kCommand_SVSOutput] = &sml::KernelSML::HandleSVSOutput;
-    m_CommandMap[sml_Names::kCommand_SVSQuery] = &sml::KernelSML::HandleSVSQuery;
+    m_CommandMap.Add(sml_Names::kCommand_CreateAgent,       &sml::KernelSML::HandleCreateAgent) ;
+    m_CommandMap.Add(sml_Names::kCommand_DestroyAgent,      &sml::KernelSML::HandleDestroyAgent) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetInputLink,      &sml::KernelSML::HandleGetInputLink) ;
+    m_CommandMap.Add(sml_Names::kCommand_Input,             &sml::KernelSML::HandleInput) ;
+    m_CommandMap.Add(sml_Names::kCommand_CommandLine,       &sml::KernelSML::HandleCommandLine) ;
+    m_CommandMap.Add(sml_Names::kCommand_CheckForIncomingCommands, &sml::KernelSML::HandleCheckForIncomingCommands) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetAgentList,      &sml::KernelSML::HandleGetAgentList) ;
+    m_CommandMap.Add(sml_Names::kCommand_RegisterForEvent,  &sml::KernelSML::HandleRegisterForEvent) ;
+    m_CommandMap.Add(sml_Names::kCommand_UnregisterForEvent, &sml::KernelSML::HandleRegisterForEvent) ; // Note -- both register and unregister go to same handler
+    m_CommandMap.Add(sml_Names::kCommand_FireEvent,         &sml::KernelSML::HandleFireEvent) ;
+    m_CommandMap.Add(sml_Names::kCommand_SuppressEvent,     &sml::KernelSML::HandleSuppressEvent) ;
+    m_CommandMap.Add(sml_Names::kCommand_SetInterruptCheckRate, &sml::KernelSML::HandleSetInterruptCheckRate) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetVersion,        &sml::KernelSML::HandleGetVersion) ;
+    m_CommandMap.Add(sml_Names::kCommand_Shutdown,          &sml::KernelSML::HandleShutdown) ;
+    m_CommandMap.Add(sml_Names::kCommand_IsSoarRunning,     &sml::KernelSML::HandleIsSoarRunning) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetConnections,    &sml::KernelSML::HandleGetConnections) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetConnectionStats, &sml::KernelSML::HandleGetConnectionStats) ;
+    m_CommandMap.Add(sml_Names::kCommand_SetEventBatching,  &sml::KernelSML::HandleSetEventBatching) ;
+    m_CommandMap.Add(sml_Names::kCommand_SetRunThreads,     &sml::KernelSML::HandleSetRunThreads) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetRunThreadStats, &sml::KernelSML::HandleGetRunThreadStats) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetLatencyStats,  &sml::KernelSML::HandleGetLatencyStats) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetMemoryStats,   &sml::KernelSML::HandleGetMemoryStats) ;
+    m_CommandMap.Add(sml_Names::kCommand_SetConnectionInfo, &sml::KernelSML::HandleSetConnectionInfo) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetAllInput,       &sml::KernelSML::HandleGetAllInput) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetAllOutput,      &sml::KernelSML::HandleGetAllOutput) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetRunState,       &sml::KernelSML::HandleGetRunState) ;
+    m_CommandMap.Add(sml_Names::kCommand_IsProductionLoaded, &sml::KernelSML::HandleIsProductionLoaded) ;
+    m_CommandMap.Add(sml_Names::kCommand_SendClientMessage, &sml::KernelSML::HandleSendClientMessage) ;
+    m_CommandMap.Add(sml_Names::kCommand_WasAgentOnRunList, &sml::KernelSML::HandleWasAgentOnRunList) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetResultOfLastRun, &sml::KernelSML::HandleGetResultOfLastRun) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetInitialTimeTag, &sml::KernelSML::HandleGetInitialTimeTag) ;
+    m_CommandMap.Add(sml_Names::kCommand_ConvertIdentifier, &sml::KernelSML::HandleConvertIdentifier) ;
+    m_CommandMap.Add(sml_Names::kCommand_GetListenerPort,   &sml::KernelSML::HandleGetListenerPort) ;
+    m_CommandMap.Add(sml_Names::kCommand_SVSInput, &sml::KernelSML::HandleSVSInput) ;
+    m_CommandMap.Add(sml_Names::kCommand_SVSOutput, &sml::KernelSML::HandleSVSOutput) ;
+    m_CommandMap.Add(sml_Names::kCommand_SVSQuery, &sml::KernelSML::HandleSVSQuery) ;
 }
 
 /*************************************************************
@@ -407,6 +418,258 @@ bool KernelSML::HandleGetConnections(AgentSML* /*pAgentSML*/, char const* /*pCom
     
 }
 
+// Returns the traffic through each connection, e.g.
+// <result output="structured" count="2"><connection id="id_0x..." name="java-debugger" messages-sent="1200" ... /></result>
+// Embedded connections only have an id and name.  Connections that have been sent batched
+// events also report the batches and any events dropped because they fell behind.
+bool KernelSML::HandleGetConnectionStats(AgentSML* /*pAgentSML*/, char const* /*pCommandName*/, Connection* /*pCallingConnection*/, AnalyzeXML* /*pIncoming*/, soarxml::ElementXML* pResponse)
+{
+    TagResult* pTagResult = new TagResult() ;
+    pTagResult->AddAttribute(sml_Names::kCommandOutput, sml_Names::kStructuredOutput) ;
+    
+    std::string temp ;
+    int index = 0 ;
+    Connection* pConnection = m_pConnectionManager->GetConnectionByIndex(index) ;
+    
+    while (pConnection)
+    {
+        soarxml::ElementXML* pTagConnection = new soarxml::ElementXML() ;
+        pTagConnection->SetTagName(sml_Names::kTagConnection) ;
+        
+        pTagConnection->AddAttribute(sml_Names::kConnectionId, pConnection->GetID()) ;
+        pTagConnection->AddAttribute(sml_Names::kConnectionName, pConnection->GetName()) ;
+        
+        sock::DataSenderStats stats ;
+        if (pConnection->GetStats(&stats))
+        {
+            pTagConnection->AddAttribute(sml_Names::kConnectionMessagesSent, to_string(stats.m_MessagesSent, temp).c_str()) ;
+            pTagConnection->AddAttribute(sml_Names::kConnectionMessagesReceived, to_string(stats.m_MessagesReceived, temp).c_str()) ;
+            pTagConnection->AddAttribute(sml_Names::kConnectionBytesSent, to_string(stats.m_BytesSent, temp).c_str()) ;
+            pTagConnection->AddAttribute(sml_Names::kConnectionBytesReceived, to_string(stats.m_BytesReceived, temp).c_str()) ;
+            pTagConnection->AddAttribute(sml_Names::kConnectionSeconds, to_string(stats.m_Seconds, temp).c_str()) ;
+            pTagConnection->AddAttribute(sml_Names::kConnectionEventDriven, stats.m_EventDriven ? sml_Names::kTrue : sml_Names::kFalse) ;
+            pTagConnection->AddAttribute(sml_Names::kConnectionQueuedBytes, to_string(stats.m_QueuedBytes, temp).c_str()) ;
+            pTagConnection->AddAttribute(sml_Names::kConnectionPeakQueuedBytes, to_string(stats.m_PeakQueuedBytes, temp).c_str()) ;
+            pTagConnection->AddAttribute(sml_Names::kConnectionSendStalls, to_string(stats.m_SendStalls, temp).c_str()) ;
+        }
+        
+        EventBatchStats batchStats ;
+        if (GetEventBatcher()->GetStats(pConnection, &batchStats))
+        {
+            pTagConnection->AddAttribute(sml_Names::kConnectionBatchedEvents, to_string(batchStats.m_BatchedEvents, temp).c_str()) ;
+            pTagConnection->AddAttribute(sml_Names::kConnectionEventBatches, to_string(batchStats.m_Batches, temp).c_str()) ;
+            pTagConnection->AddAttribute(sml_Names::kConnectionDroppedEvents, to_string(batchStats.m_DroppedEvents, temp).c_str()) ;
+            pTagConnection->AddAttribute(sml_Names::kConnectionDroppedBytes, to_string(batchStats.m_DroppedBytes, temp).c_str()) ;
+        }
+        
+        pTagResult->AddChild(pTagConnection) ;
+        
+        index++ ;
+        pConnection = m_pConnectionManager->GetConnectionByIndex(index) ;
+    }
+    
+    pTagResult->AddAttribute(sml_Names::kConnectionCount, to_string(index, temp).c_str()) ;
+    
+    pResponse->AddChild(pTagResult) ;
+    
+    return true ;
+}
+
+// Sets how remote connections are sent print and trace events (see sml_EventBatcher.h).
+// A window of 0 sends every event synchronously.  Missing parameters are left unchanged.
+bool KernelSML::HandleSetEventBatching(AgentSML* /*pAgentSML*/, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse)
+{
+    EventBatcher* pBatcher = GetEventBatcher() ;
+    
+    int window = pIncoming->GetArgInt(sml_Names::kParamBatchWindow, pBatcher->GetWindow()) ;
+    int batchSize = pIncoming->GetArgInt(sml_Names::kParamBatchSize, pBatcher->GetMaxBatchBytes()) ;
+    int backlog = pIncoming->GetArgInt(sml_Names::kParamBacklog, pBatcher->GetMaxBacklogBytes()) ;
+    
+    if (window < 0 || batchSize < 0 || backlog < 0)
+    {
+        return InvalidArg(pConnection, pResponse, pCommandName, "Event batching limits can't be negative") ;
+    }
+    
+    pBatcher->SetLimits(window, batchSize, backlog) ;
+    
+    return true ;
+}
+
+// Sets how many threads the run scheduler steps agents on (see sml_RunThreads.h)
+bool KernelSML::HandleSetRunThreads(AgentSML* /*pAgentSML*/, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse)
+{
+    int threads = pIncoming->GetArgInt(sml_Names::kParamValue, 0) ;
+    
+    if (threads < 0)
+    {
+        return InvalidArg(pConnection, pResponse, pCommandName, "The number of run threads can't be negative") ;
+    }
+    
+    if (!GetRunScheduler()->SetRunThreads(threads))
+    {
+        return InvalidArg(pConnection, pResponse, pCommandName, "Can't change the number of run threads while Soar is running") ;
+    }
+    
+    return true ;
+}
+
+// Reports how busy each run thread has been and how long each agent's steps take (see sml_RunThreads.h).
+// The agents are reported even without run threads, as their costs show whether it's worth having some.
+bool KernelSML::HandleGetRunThreadStats(AgentSML* /*pAgentSML*/, char const* /*pCommandName*/, Connection* /*pConnection*/, AnalyzeXML* /*pIncoming*/, soarxml::ElementXML* pResponse)
+{
+    TagResult* pTagResult = new TagResult() ;
+    pTagResult->AddAttribute(sml_Names::kCommandOutput, sml_Names::kStructuredOutput) ;
+    
+    std::string temp ;
+    std::vector<RunThreadStats> threads ;
+    uint64_t passes = 0 ;
+    uint64_t totalUSec = 0 ;
+    
+    GetRunScheduler()->GetRunThreadStats(&threads, &passes, &totalUSec) ;
+    
+    pTagResult->AddAttribute(sml_Names::kRunThreadCount, to_string(threads.size(), temp).c_str()) ;
+    pTagResult->AddAttribute(sml_Names::kRunPasses, to_string(passes, temp).c_str()) ;
+    pTagResult->AddAttribute(sml_Names::kRunSeconds, to_string(totalUSec / 1000000.0, temp).c_str()) ;
+    
+    for (std::vector<RunThreadStats>::iterator iter = threads.begin() ; iter != threads.end() ; iter++)
+    {
+        soarxml::ElementXML* pTagThread = new soarxml::ElementXML() ;
+        pTagThread->SetTagName(sml_Names::kTagRunThread) ;
+        
+        pTagThread->AddAttribute(sml_Names::kRunSteps, to_string(iter->m_Steps, temp).c_str()) ;
+        pTagThread->AddAttribute(sml_Names::kRunSteals, to_string(iter->m_Steals, temp).c_str()) ;
+        pTagThread->AddAttribute(sml_Names::kRunBusySeconds, to_string(iter->m_BusyUSec / 1000000.0, temp).c_str()) ;
+        
+        pTagResult->AddChild(pTagThread) ;
+    }
+    
+    for (AgentMapIter iter = m_AgentMap.begin() ; iter != m_AgentMap.end() ; iter++)
+    {
+        AgentSML* pAgent = iter->second ;
+        
+        soarxml::ElementXML* pTagAgent = new soarxml::ElementXML() ;
+        pTagAgent->SetTagName(sml_Names::kTagRunAgent) ;
+        
+        pTagAgent->AddAttribute(sml_Names::kParamName, pAgent->GetName()) ;
+        pTagAgent->AddAttribute(sml_Names::kRunSteps, to_string(pAgent->GetStepCount(), temp).c_str()) ;
+        pTagAgent->AddAttribute(sml_Names::kRunStepSeconds, to_string(pAgent->GetStepUSec() / 1000000.0, temp).c_str()) ;
+        pTagAgent->AddAttribute(sml_Names::kRunLastStepUSec, to_string(pAgent->GetLastStepUSec(), temp).c_str()) ;
+        pTagAgent->AddAttribute(sml_Names::kRunStepCostUSec, to_string(pAgent->GetStepCost(), temp).c_str()) ;
+        
+        pTagResult->AddChild(pTagAgent) ;
+    }
+    
+    pResponse->AddChild(pTagResult) ;
+    
+    return true ;
+}
+
+// Adds a <histogram> tag summarizing one latency histogram
+static void AddLatencyHistogram(soarxml::ElementXML* pParent, char const* pName, soar_latency_histogram const& histogram)
+{
+    std::string temp ;
+    
+    soarxml::ElementXML* pTag = new soarxml::ElementXML() ;
+    pTag->SetTagName(sml_Names::kTagLatencyHistogram) ;
+    
+    pTag->AddAttribute(sml_Names::kParamName, pName) ;
+    pTag->AddAttribute(sml_Names::kLatencyCount, to_string(histogram.get_count(), temp).c_str()) ;
+    pTag->AddAttribute(sml_Names::kLatencyMeanUSec, to_string(histogram.get_mean(), temp, 1, true).c_str()) ;
+    pTag->AddAttribute(sml_Names::kLatencyP50USec, to_string(histogram.get_percentile(50), temp).c_str()) ;
+    pTag->AddAttribute(sml_Names::kLatencyP90USec, to_string(histogram.get_percentile(90), temp).c_str()) ;
+    pTag->AddAttribute(sml_Names::kLatencyP99USec, to_string(histogram.get_percentile(99), temp).c_str()) ;
+    pTag->AddAttribute(sml_Names::kLatencyP999USec, to_string(histogram.get_percentile(99.9), temp).c_str()) ;
+    pTag->AddAttribute(sml_Names::kLatencyMaxUSec, to_string(histogram.get_max(), temp).c_str()) ;
+    
+    pParent->AddChild(pTag) ;
+}
+
+// Reports the latency histograms (see stats --histogram): how long the kernel's commands have taken
+// and, for each agent, its decision cycles, each phase and its epmem and smem queries.
+// Meant to be polled by monitoring tools, so it doesn't reset anything.
+bool KernelSML::HandleGetLatencyStats(AgentSML* /*pAgentSML*/, char const* /*pCommandName*/, Connection* /*pConnection*/, AnalyzeXML* /*pIncoming*/, soarxml::ElementXML* pResponse)
+{
+    TagResult* pTagResult = new TagResult() ;
+    pTagResult->AddAttribute(sml_Names::kCommandOutput, sml_Names::kStructuredOutput) ;
+    
+    AddLatencyHistogram(pTagResult, "sml-command", m_CommandLatency) ;
+    
+#ifndef NO_TIMING_STUFF
+    for (AgentMapIter iter = m_AgentMap.begin() ; iter != m_AgentMap.end() ; iter++)
+    {
+        agent* pSoarAgent = iter->second->GetSoarAgent() ;
+        
+        soarxml::ElementXML* pTagAgent = new soarxml::ElementXML() ;
+        pTagAgent->SetTagName(sml_Names::kTagRunAgent) ;
+        pTagAgent->AddAttribute(sml_Names::kParamName, iter->second->GetName()) ;
+        
+        AddLatencyHistogram(pTagAgent, "decision-cycle", pSoarAgent->latency_decision_cycle) ;
+        for (int phase = 0 ; phase < NUM_PHASE_TYPES ; phase++)
+        {
+            AddLatencyHistogram(pTagAgent, profile_span_names[phase], pSoarAgent->latency_phase[phase]) ;
+        }
+        AddLatencyHistogram(pTagAgent, "epmem-query", pSoarAgent->latency_epmem_query) ;
+        AddLatencyHistogram(pTagAgent, "smem-query", pSoarAgent->latency_smem_query) ;
+        
+        pTagResult->AddChild(pTagAgent) ;
+    }
+#endif
+
+    pResponse->AddChild(pTagResult) ;
+    
+    return true ;
+}
+
+// Adds a <memory> tag for one subsystem's memory
+static void AddMemoryUsage(soarxml::ElementXML* pParent, char const* pName, uint64_t live, uint64_t reserved)
+{
+    std::string temp ;
+    
+    soarxml::ElementXML* pTag = new soarxml::ElementXML() ;
+    pTag->SetTagName(sml_Names::kTagMemoryUsage) ;
+    
+    pTag->AddAttribute(sml_Names::kParamName, pName) ;
+    pTag->AddAttribute(sml_Names::kMemoryLiveBytes, to_string(live, temp).c_str()) ;
+    pTag->AddAttribute(sml_Names::kMemoryReservedBytes, to_string(reserved, temp).c_str()) ;
+    
+    pParent->AddChild(pTag) ;
+}
+
+// Reports the memory each agent is using, by subsystem (see stats --accounting), and SQLite's
+// total for all of them.  Meant to be polled by monitoring tools.
+bool KernelSML::HandleGetMemoryStats(AgentSML* /*pAgentSML*/, char const* /*pCommandName*/, Connection* /*pConnection*/, AnalyzeXML* /*pIncoming*/, soarxml::ElementXML* pResponse)
+{
+    std::string temp ;
+    
+    TagResult* pTagResult = new TagResult() ;
+    pTagResult->AddAttribute(sml_Names::kCommandOutput, sml_Names::kStructuredOutput) ;
+    pTagResult->AddAttribute(sml_Names::kMemorySQLiteBytes, to_string(get_sqlite_memory_used(), temp).c_str()) ;
+    
+    for (AgentMapIter iter = m_AgentMap.begin() ; iter != m_AgentMap.end() ; iter++)
+    {
+        mem_usage usage[NUM_MEM_SUBSYSTEMS] ;
+        get_memory_accounting(iter->second->GetSoarAgent(), usage) ;
+        
+        soarxml::ElementXML* pTagAgent = new soarxml::ElementXML() ;
+        pTagAgent->SetTagName(sml_Names::kTagRunAgent) ;
+        pTagAgent->AddAttribute(sml_Names::kParamName, iter->second->GetName()) ;
+        
+        for (int i = 0 ; i < NUM_MEM_SUBSYSTEMS ; i++)
+        {
+            AddMemoryUsage(pTagAgent, mem_subsystem_names[i], usage[i].live, usage[i].reserved) ;
+        }
+        
+        size_t smlBytes = iter->second->GetMemoryUsage() ;
+        AddMemoryUsage(pTagAgent, "sml", smlBytes, smlBytes) ;
+        
+        pTagResult->AddChild(pTagAgent) ;
+    }
+    
+    pResponse->AddChild(pTagResult) ;
+    
+    return true ;
+}
+
 bool KernelSML::HandleDestroyAgent(AgentSML* pAgentSML, char const* /*pCommandName*/, Connection* /*pConnection*/, AnalyzeXML* /*pIncoming*/, soarxml::ElementXML* /*pResponse*/)
 {
     if (!pAgentSML)
@@ -857,7 +1120,7 @@ bool KernelSML::HandleGetAllOutput(AgentSML* pAgentSML, char const* /*pCommandNa
 }
 
 // Add or remove a list of wmes we've been sent
-bool KernelSML::HandleInput(AgentSML* pAgentSML, char const* /*pCommandName*/, Connection* /*pConnection*/, AnalyzeXML* pIncoming, soarxml::ElementXML* /*pResponse*/)
+bool KernelSML::HandleInput(AgentSML* pAgentSML, char const* /*pCommandName*/, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse)
 {
     // Flag to control printing debug information about the input link
 #ifdef _DEBUG
@@ -871,14 +1134,42 @@ bool KernelSML::HandleInput(AgentSML* pAgentSML, char const* /*pCommandName*/, C
         return false ;
     }
     
-    // Record the input coming input message on a list
-    pAgentSML->AddToPendingInputList(pIncoming->GetElementXMLHandle()) ;
+    // Let the client know it can send its changes as a single batch from now on (see sml_InputBatch.h)
+    pResponse->AddAttribute(sml_Names::kInputBatch, sml_Names::kTrue) ;
     
     bool ok = true ;
     
     // Get the command tag which contains the list of wmes
     soarxml::ElementXML const* pCommand = pIncoming->GetCommandTag() ;
     
+    // A batch comes as the only child after the agent argument, so look for it before falling back to the list of wmes.
+    soarxml::ElementXML batch(NULL) ;
+    soarxml::ElementXML* pBatch = &batch ;
+    
+    int nChildren = pCommand->GetNumberChildren() ;
+    for (int i = 0 ; i < nChildren ; i++)
+    {
+        pCommand->GetChild(pBatch, i) ;
+        
+        if (pBatch->IsTag(sml_Names::kTagWMEBatch))
+        {
+            // Decode it now, as the string table has to be updated in the order the batches arrive.
+            // The changes themselves are buffered and applied at the next input phase (this also echoes them back).
+            pBatch->ConvertCharacterDataToBinary() ;
+            ok = pAgentSML->AddInputBatch(pConnection, pBatch->GetCharacterData(), pBatch->GetCharacterDataLength()) ;
+            
+            if (kDebugInput)
+            {
+                sml::PrintDebugFormat("--------- %s read input batch (%s) ----------", pAgentSML->GetName(), ok ? "ok" : "invalid") ;
+            }
+            
+            return ok ;
+        }
+    }
+    
+    // Record the input coming input message on a list
+    pAgentSML->AddToPendingInputList(pIncoming->GetElementXMLHandle()) ;
+    
     // Echo back the list of wmes received, so other clients can see what's been added (rarely used).
     pAgentSML->FireInputReceivedEvent(pCommand) ;
     
@@ -949,7 +1240,7 @@ bool KernelSML::HandleCommandLine(AgentSML* pAgentSML, char const* pCommandName,
     // If there are no filters (or this command requested not to be filtered), this copies the original line into the filtered line unchanged.
     char const* pFilteredLine   = pLine ;
     bool filteredError = false ;
-    soarxml::ElementXML* pFilteredXML = NULL ;
+    std::string filteredLine ;
     
     if (!noFiltering && HasFilterRegistered())
     {
@@ -982,35 +1273,58 @@ bool KernelSML::HandleCommandLine(AgentSML* pAgentSML, char const* pCommandName,
         
         if (filtered)
         {
-            pFilteredXML = soarxml::ElementXML::ParseXMLFromString(filteredXML.c_str()) ;
-            if (!pFilteredXML)
+            // Get the results of the filtering.  They're all attributes of the root,
+            // so they're read with the pull parser rather than building a tree.
+            std::string filteredOutput ;
+            soarxml::ParseXMLPull parser(filteredXML.data(), filteredXML.size()) ;
+            soarxml::ParseXMLPull::EventType event = parser.Next() ;
+            
+            while (event == soarxml::ParseXMLPull::kComment || event == soarxml::ParseXMLPull::kCharData)
             {
-                // Error parsing the XML that the filter returned
-                return false ;
+                event = parser.Next() ;
             }
             
-            // Get the results of the filtering
-            pFilteredLine    = pFilteredXML->GetAttribute(sml_Names::kFilterCommand) ;
-            char const* pFilteredOutput  = pFilteredXML->GetAttribute(sml_Names::kFilterOutput) ;
-            char const* pErr = pFilteredXML->GetAttribute(sml_Names::kFilterError) ;
-            filteredError    = (pErr && strcasecmp(pErr, "true") == 0) ;
-            
-            // See if the filter consumed the command.  If so, we just need to return the output.
-            if (!pFilteredLine || strlen(pFilteredLine) == 0)
+            if (event == soarxml::ParseXMLPull::kStartElement)
             {
-                // We may have no output defined and that's not an error so cover that case
-                if (pFilteredOutput == NULL)
+                while ((event = parser.Next()) == soarxml::ParseXMLPull::kAttribute)
                 {
-                    pFilteredOutput = "" ;
+                    soarxml::XMLStringView const& name = parser.GetName() ;
+                    
+                    if (name.Equals(sml_Names::kFilterCommand))
+                    {
+                        filteredLine = parser.GetValue().ToString() ;
+                    }
+                    else if (name.Equals(sml_Names::kFilterOutput))
+                    {
+                        filteredOutput = parser.GetValue().ToString() ;
+                    }
+                    else if (name.Equals(sml_Names::kFilterError))
+                    {
+                        filteredError = (strcasecmp(parser.GetValue().ToString().c_str(), "true") == 0) ;
+                    }
                 }
                 
-                bool res = this->ReturnResult(pConnection, pResponse, pFilteredOutput) ;
-                
-                // Can only clean this up after we're finished using it or pFilteredLine will become invalid
-                delete pFilteredXML ;
-                
-                return res ;
+                // The rest of the document still has to be well formed
+                while (event != soarxml::ParseXMLPull::kEndDocument && event != soarxml::ParseXMLPull::kError)
+                {
+                    event = parser.Next() ;
+                }
+            }
+            
+            if (event != soarxml::ParseXMLPull::kEndDocument)
+            {
+                // Error parsing the XML that the filter returned
+                return false ;
+            }
+            
+            // See if the filter consumed the command.  If so, we just need to return the output.
+            // (We may have no output defined and that's not an error.)
+            if (filteredLine.empty())
+            {
+                return this->ReturnResult(pConnection, pResponse, filteredOutput.c_str()) ;
             }
+                
+            pFilteredLine = filteredLine.c_str() ;
         }
     }
     
@@ -1028,9 +1342,6 @@ bool KernelSML::HandleCommandLine(AgentSML* pAgentSML, char const* pCommandName,
         sml::PrintDebugFormat("Completed %s", pLine) ;
     }
     
-    // Can only clean this up after we're finished using it or pFilteredLine will become invalid
-    delete pFilteredXML ;
-    
     return result ;
 }
 
@@ -53,6 +53,15 @@ void ListenerThread::Run()
     }
 #endif
     
+#ifdef ENABLE_SHARED_MEMORY
+    // Not being able to offer shared memory isn't fatal, clients will just use the local socket
+    if (!m_SharedMemoryListenerSocket.CreateListener(m_Port, true, SharedMemory::kHandshakeSuffix))
+    {
+        sml::PrintDebug("Failed to create the shared memory handshake socket.") ;
+        m_SharedMemoryListenerSocket.Close() ;
+    }
+#endif
+
 #ifdef ENABLE_NAMED_PIPES
     ok = m_ListenerNamedPipe.CreateListener(m_Port) ;
     if (ok)
@@ -85,6 +94,22 @@ void ListenerThread::Run()
 #ifdef ENABLE_NAMED_PIPES
         NamedPipe* pNamedPipe = m_ListenerNamedPipe.CheckForClientConnection();
 #endif
+
+#ifdef ENABLE_SHARED_MEMORY
+        if (m_SharedMemoryListenerSocket.IsAlive())
+        {
+            Socket* pHandshake = m_SharedMemoryListenerSocket.CheckForClientConnection() ;
+            
+            // The client sends the name of its segment straight after connecting, so this doesn't wait long
+            SharedMemory* pSharedMemory = pHandshake ? SharedMemory::AcceptClient(pHandshake) : NULL ;
+            
+            if (pSharedMemory)
+            {
+                CreateConnection(pSharedMemory) ;
+            }
+        }
+#endif
+
         if (pSocket)
         {
             CreateConnection(pSocket);
@@ -116,6 +141,9 @@ void ListenerThread::Run()
     
     // Shut down our listener socket
     m_ListenerSocket.Close() ;
+#ifdef ENABLE_SHARED_MEMORY
+    m_SharedMemoryListenerSocket.Close();
+#endif
 #ifdef ENABLE_LOCAL_SOCKETS
     m_LocalListenerSocket.Close();
     
@@ -22,6 +22,10 @@
 #include "sock_ListenerNamedPipe.h"
 #endif
 
+#ifdef ENABLE_SHARED_MEMORY
+#include "sock_SharedMemory.h"
+#endif
+
 #include <list>
 
 namespace sml
@@ -39,6 +43,10 @@ namespace sml
             ConnectionManager*          m_Parent ;
             sock::ListenerSocket        m_ListenerSocket ;
             sock::ListenerSocket        m_LocalListenerSocket;
+#ifdef ENABLE_SHARED_MEMORY
+            // Clients on this machine connect here to set up a shared memory connection
+            sock::ListenerSocket        m_SharedMemoryListenerSocket;
+#endif
 #ifdef ENABLE_NAMED_PIPES
             sock::ListenerNamedPipe     m_ListenerNamedPipe ;
 #endif
@@ -100,7 +100,7 @@ void OutputListener::OnKernelEvent(int eventID, AgentSML* pAgentSML, void* pCall
     int outputMode = oinfo->mode;
     
     io_wme* pWmes = oinfo->outputs ;
-    SendOutput(smlWorkingMemoryEventId(eventID), pAgentSML, outputMode, pWmes) ;
+    SendOutput(smlWorkingMemoryEventId(eventID), pAgentSML, outputMode, pWmes, oinfo->added, oinfo->removed) ;
 }
 
 // OutputMode is one of:
@@ -108,7 +108,7 @@ void OutputListener::OnKernelEvent(int eventID, AgentSML* pAgentSML, void* pCall
 // #define MODIFIED_OUTPUT_COMMAND 2
 // #define REMOVED_OUTPUT_COMMAND 3
 
-void OutputListener::SendOutput(smlWorkingMemoryEventId eventId, AgentSML* pAgentSML, int /*outputMode*/, io_wme* io_wmelist)
+void OutputListener::SendOutput(smlWorkingMemoryEventId eventId, AgentSML* pAgentSML, int /*outputMode*/, io_wme* io_wmelist, io_wme* pAdded, io_wme* pRemoved)
 {
     if (eventId != smlEVENT_OUTPUT_PHASE_CALLBACK)
     {
@@ -119,6 +119,8 @@ void OutputListener::SendOutput(smlWorkingMemoryEventId eventId, AgentSML* pAgen
     ConnectionListIter connectionIter ;
     if (!EventManager<smlWorkingMemoryEventId>::GetBegin(eventId, &connectionIter))
     {
+        // Whoever listens next will need the whole output link
+        m_InSync = false ;
         return ;
     }
     
@@ -133,10 +135,59 @@ void OutputListener::SendOutput(smlWorkingMemoryEventId eventId, AgentSML* pAgen
     ElementXML_Handle hCommand = pConnection->AddParameterToSMLCommand(pMsg, sml_Names::kParamAgent, pAgentSML->GetName()) ;
     soarxml::ElementXML command(hCommand) ;
     
-    // We are passed a list of all wmes in the transitive closure (TC) of the output link.
-    // We need to decide which of these we've already seen before, so we can just send the
-    // changes over to the client (rather than sending the entire TC each time).
+    // Start with the output link itself
+    // The kernel seems to only output this itself during link initialization
+    // and we might be connecting up after that.  Including it twice will not hurt on the client side.
+    agent* pSoarAgent = pAgentSML->GetSoarAgent() ;
+    output_link* ol = pSoarAgent->existing_output_links ;    // This is technically a list but we only support one output link
+    TagWme* pOutputLinkWme = OutputListener::CreateTagWme(pAgentSML, ol->link_wme) ;
+    command.AddChild(pOutputLinkWme) ;
+    
+    if (io_wmelist)
+    {
+        AddAllOutput(&command, pAgentSML, io_wmelist) ;
+    }
+    else if (m_InSync)
+    {
+        AddOutputChanges(&command, pAgentSML, pAdded, pRemoved) ;
+    }
+    else
+    {
+        // We've missed some changes, so compare against everything that's there now
+        io_wme* pAll = get_io_wmes_for_output_link(pSoarAgent, ol) ;
+        AddAllOutput(&command, pAgentSML, pAll) ;
+        deallocate_io_wme_list(pSoarAgent, pAll) ;
+    }
+    
+    // This is important.  We are working with a subpart of pMsg.
+    // If we retain ownership of the handle and delete the object
+    // it will release the handle...deleting part of our message.
+    command.Detach() ;
+    
+    smlWorkingMemoryEventId eventID = smlEVENT_OUTPUT_PHASE_CALLBACK ;
+    
+#ifdef _DEBUG
+    // Convert the XML to a string so we can look at it in the debugger
+    char* pStr = pMsg->GenerateXMLString(true) ;
+#endif
+
+    // Send the message out
+    AnalyzeXML response ;
+    SendEvent(pAgentSML, pConnection, pMsg, &response, connectionIter, GetEnd(eventID)) ;
     
+#ifdef _DEBUG
+    pMsg->DeleteString(pStr) ;
+#endif
+
+    // Clean up
+    delete pMsg ;
+}
+
+// We are passed a list of all wmes in the transitive closure (TC) of the output link.
+// We need to decide which of these we've already seen before, so we can just send the
+// changes over to the client (rather than sending the entire TC each time).
+void OutputListener::AddAllOutput(soarxml::ElementXML* pCommand, AgentSML* pAgentSML, io_wme* io_wmelist)
+{
     // Reset everything in the current list of tags to "not in use".  After we've processed all wmes,
     // any still in this state have been removed.
     for (OutputTimeTagIter iter = m_TimeTags.begin() ; iter != m_TimeTags.end() ; iter++)
@@ -144,13 +195,6 @@ void OutputListener::SendOutput(smlWorkingMemoryEventId eventId, AgentSML* pAgen
         iter->second = false ;
     }
     
-    // Start with the output link itself
-    // The kernel seems to only output this itself during link initialization
-    // and we might be connecting up after that.  Including it twice will not hurt on the client side.
-    output_link* ol = pAgentSML->GetSoarAgent()->existing_output_links ;    // This is technically a list but we only support one output link
-    TagWme* pOutputLinkWme = OutputListener::CreateTagWme(pAgentSML, ol->link_wme) ;
-    command.AddChild(pOutputLinkWme) ;
-    
     for (io_wme* wme = io_wmelist ; wme != NIL ; wme = wme->next)
     {
         // Build the list of WME changes
@@ -174,7 +218,7 @@ void OutputListener::SendOutput(smlWorkingMemoryEventId eventId, AgentSML* pAgen
         TagWme* pTag = CreateTagIOWme(pAgentSML, wme) ;
         
         // Add it as a child of the command tag
-        command.AddChild(pTag) ;
+        pCommand->AddChild(pTag) ;
     }
     
     // At this point we check the list of time tags and any which are not marked as "in use" must
@@ -200,34 +244,44 @@ void OutputListener::SendOutput(smlWorkingMemoryEventId eventId, AgentSML* pAgen
         pTag->SetActionRemove() ;
         
         // Add it as a child of the command tag
-        command.AddChild(pTag) ;
+        pCommand->AddChild(pTag) ;
         
         // Delete the entry from the time tag map
         m_TimeTags.erase(iter++);
     }
     
-    // This is important.  We are working with a subpart of pMsg.
-    // If we retain ownership of the handle and delete the object
-    // it will release the handle...deleting part of our message.
-    command.Detach() ;
-    
-    smlWorkingMemoryEventId eventID = smlEVENT_OUTPUT_PHASE_CALLBACK ;
+    m_InSync = true ;
+}
     
-#ifdef _DEBUG
-    // Convert the XML to a string so we can look at it in the debugger
-    char* pStr = pMsg->GenerateXMLString(true) ;
-#endif
+// The kernel has tracked the changes to the output link for us, so we just pass them on
+// (and keep m_TimeTags up to date in case we need to compare against the full list later).
+// This costs time in proportion to the size of the change rather than the size of the link.
+void OutputListener::AddOutputChanges(soarxml::ElementXML* pCommand, AgentSML* pAgentSML, io_wme* pAdded, io_wme* pRemoved)
+{
+    for (io_wme* wme = pAdded ; wme != NIL ; wme = wme->next)
+    {
+        // The link wme itself may be in here, and it's already been sent
+        if (!m_TimeTags.insert(std::make_pair(wme->timetag, true)).second)
+        {
+            continue ;
+        }
     
-    // Send the message out
-    AnalyzeXML response ;
-    SendEvent(pAgentSML, pConnection, pMsg, &response, connectionIter, GetEnd(eventID)) ;
+        pCommand->AddChild(CreateTagIOWme(pAgentSML, wme)) ;
+    }
     
-#ifdef _DEBUG
-    pMsg->DeleteString(pStr) ;
-#endif
+    for (io_wme* wme = pRemoved ; wme != NIL ; wme = wme->next)
+    {
+        // Only tell the client about wmes it has seen
+        if (m_TimeTags.erase(wme->timetag) == 0)
+        {
+            continue ;
+        }
     
-    // Clean up
-    delete pMsg ;
+        TagWme* pTag = new TagWme() ;
+        pTag->SetTimeTag(static_cast<int64_t>(wme->timetag)) ;
+        pTag->SetActionRemove() ;
+        pCommand->AddChild(pTag) ;
+    }
 }
 
 // Register for the events that KernelSML itself needs to know about in order to work correctly.
@@ -352,5 +406,6 @@ void OutputListener::ReinitializeEvent(smlAgentEventId eventId)
         // we will send over output link information again.  The client also needs to register for this event
         // (which it does automatically) so it can clear out its output tree to match.
         m_TimeTags.clear() ;
+        m_InSync = false ;
     }
 }
@@ -20,6 +20,11 @@
 typedef struct io_wme_struct io_wme;
 typedef struct wme_struct wme;
 
+namespace soarxml
+{
+    class ElementXML ;
+}
+
 namespace sml
 {
 
@@ -40,10 +45,18 @@ namespace sml
             // This allows us to only send changes over.
             OutputTimeTagMap m_TimeTags ;
             
+            // False if output went by while no one was listening, so m_TimeTags may not match
+            // the output link and we need the full list of wmes next time to catch up.
+            bool            m_InSync ;
+            
+            void AddAllOutput(soarxml::ElementXML* pCommand, AgentSML* pAgentSML, io_wme* io_wmelist) ;
+            void AddOutputChanges(soarxml::ElementXML* pCommand, AgentSML* pAgentSML, io_wme* pAdded, io_wme* pRemoved) ;
+            
         public:
             OutputListener()
             {
                 m_KernelSML = 0 ;
+                m_InSync = false ;
             }
             
             virtual ~OutputListener()
@@ -59,8 +72,9 @@ namespace sml
             // Called when an event occurs in the kernel
             virtual void OnKernelEvent(int eventID, AgentSML* pAgentSML, void* pCallData) ;
             
-            // Send output out to the clients
-            virtual void SendOutput(smlWorkingMemoryEventId eventID, AgentSML* pAgentSML, int outputMode, io_wme* io_wmelist) ;
+            // Send output out to the clients.  We're either passed every wme on the output link (io_wmelist)
+            // or, when io_wmelist is NULL, just the wmes added to and removed from it since the last call.
+            virtual void SendOutput(smlWorkingMemoryEventId eventID, AgentSML* pAgentSML, int outputMode, io_wme* io_wmelist, io_wme* pAdded, io_wme* pRemoved) ;
             
             // Register for the events that KernelSML itself needs to know about in order to work correctly.
             void RegisterForKernelSMLEvents() ;
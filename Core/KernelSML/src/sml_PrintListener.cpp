@@ -20,6 +20,7 @@
 #include "sml_Connection.h"
 #include "sml_KernelSML.h"
 #include "sml_AgentSML.h"
+#include "sml_EventBatcher.h"
 
 #include "assert.h"
 
@@ -139,15 +140,35 @@ void PrintListener::FlushOutput(Connection* pSourceConnection, smlPrintEventId e
     // For non-echo events, just send it normally
     if (eventID != smlEVENT_ECHO)
     {
-        // Build the SML message we're going to send.
-        soarxml::ElementXML* pMsg = pConnection->CreateSMLCommand(sml_Names::kCommand_Event);
-        pConnection->AddParameterToSMLCommand(pMsg, sml_Names::kParamAgent, m_pCallbackAgentSML->GetName());
-        pConnection->AddParameterToSMLCommand(pMsg, sml_Names::kParamEventID, event);
-        pConnection->AddParameterToSMLCommand(pMsg, sml_Names::kParamMessage, m_BufferedPrintOutput[buffer].str().c_str());
+        std::string output = m_BufferedPrintOutput[buffer].str() ;
+        EventBatcher* pBatcher = m_pKernelSML->GetEventBatcher() ;
+        soarxml::ElementXML* pMsg = NULL ;
         
-        // Send the message out
-        AnalyzeXML response ;
-        SendEvent(0, pConnection, pMsg, &response, connectionIter, GetEnd(eventID)) ;
+        while (connectionIter != GetEnd(eventID))
+        {
+            pConnection = *connectionIter ;
+            connectionIter++ ;
+            
+            // Remote listeners are sent print output in batches, from another thread
+            // (see sml_EventBatcher.h) so the agent doesn't wait for each of them.
+            if (pBatcher->IsBatching(pConnection))
+            {
+                pBatcher->AddPrint(pConnection, m_pCallbackAgentSML->GetName(), event, output.c_str()) ;
+                continue ;
+            }
+            
+            // Build the SML message we're going to send (once, for all the other listeners).
+            if (!pMsg)
+            {
+                pMsg = pConnection->CreateSMLCommand(sml_Names::kCommand_Event);
+                pConnection->AddParameterToSMLCommand(pMsg, sml_Names::kParamAgent, m_pCallbackAgentSML->GetName());
+                pConnection->AddParameterToSMLCommand(pMsg, sml_Names::kParamEventID, event);
+                pConnection->AddParameterToSMLCommand(pMsg, sml_Names::kParamMessage, output.c_str());
+            }
+        
+            // Send the message out
+            pConnection->SendMessageGetResponse(&response, pMsg) ;
+        }
         
         // Clean up
         delete pMsg ;
@@ -174,6 +195,9 @@ void PrintListener::FlushOutput(Connection* pSourceConnection, smlPrintEventId e
             char* pStr = pMsg->GenerateXMLString(true) ;
 #endif
             
+            // Any print output batched for this listener has to arrive first
+            commitBatchedEvents(pConnection) ;
+            
             // It would be faster to just send a message here without waiting for a response
             // but that could produce incorrect behavior if the client expects to act *during*
             // the event that we're notifying them about (e.g. notification that we're in the input phase).
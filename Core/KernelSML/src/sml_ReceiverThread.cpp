@@ -43,6 +43,9 @@ void ReceiverThread::Run()
     // the CPU quickly drops off to 0% usage as we sleep a lot.
     // The other option would be to have a notification system where we sleep until a command
     // comes in, but building that in a cross platform fashion isn't something we want to tackle right now.
+    //
+    // Where we do have one (a reactor, see sock_Reactor.h) the sockets and embedded connections
+    // wake us as soon as a message arrives, so we only need this for connections that can't.
     clock_t last = 0 ;
     
     // How long to wait before sleeping (currently 1 sec)
@@ -62,6 +65,24 @@ void ReceiverThread::Run()
         }
         */
 #endif
+        if (m_ConnectionManager->IsEventDriven())
+        {
+            // Wait for input, coming back on the same schedule as below if we have connections to poll
+            int wait = -1 ;
+            
+            if (m_ConnectionManager->HasPolledConnections())
+            {
+                wait = (clock() - last > delay) ? 5 : 0 ;
+            }
+            
+            if (m_ConnectionManager->ReceiveReadyMessages(wait))
+            {
+                last = clock() ;
+            }
+            
+            continue ;
+        }
+        
         // Receive any incoming commands and execute them
         bool receivedMessage = m_ConnectionManager->ReceiveAllMessages() ;
         
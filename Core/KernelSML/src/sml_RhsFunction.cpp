@@ -14,6 +14,7 @@
 #include "sml_Utils.h"
 #include "sml_AgentSML.h"
 #include "sml_KernelSML.h"
+#include "sml_RunThreads.h"
 
 #include "KernelHeaders.h"
 
@@ -21,6 +22,34 @@
 
 using namespace sml ;
 
+// A RHS function called while its agent is being stepped on a run thread.
+// These can call out to clients, so we execute them on the thread running Soar.
+class RhsFunctionCall : public RunThreadCall
+{
+    public:
+        RhsFunctionCall(RhsFunction* pFunction, std::vector<Symbol*>* pArguments)
+        {
+            m_pFunction = pFunction ;
+            m_pArguments = pArguments ;
+            m_pReturn = 0 ;
+        }
+        
+        void Execute()
+        {
+            m_pReturn = m_pFunction->Execute(m_pArguments) ;
+        }
+        
+        Symbol* GetReturn()
+        {
+            return m_pReturn ;
+        }
+        
+    protected:
+        RhsFunction*            m_pFunction ;
+        std::vector<Symbol*>*   m_pArguments ;
+        Symbol*                 m_pReturn ;
+} ;
+
 // This method is called by the kernel, which in turn calls the Execute method of the RhsFunction.
 Symbol* RhsFunction::RhsFunctionCallback(agent* thisAgent, list* args, void* user_data)
 {
@@ -44,7 +73,18 @@ Symbol* RhsFunction::RhsFunctionCallback(agent* thisAgent, list* args, void* use
     {
         // Actually make the call.  We can do the dynamic cast because we passed in the
         //  symbol factory and thus know how the symbol was created.
-        Symbol* pReturn = rhsFunction->Execute(&symVector);
+        Symbol* pReturn ;
+        
+        if (RunThreads::OnWorkerThread())
+        {
+            RhsFunctionCall call(rhsFunction, &symVector) ;
+            RunThreads::CallOnRunThread(&call) ;
+            pReturn = call.GetReturn() ;
+        }
+        else
+        {
+            pReturn = rhsFunction->Execute(&symVector);
+        }
         
         // Return the result, assuming it is not NIL
         if (rhsFunction->IsValueReturned() == true)
@@ -18,8 +18,11 @@
 #include "sml_KernelSML.h"
 #include "sml_AgentSML.h"
 #include "sml_Events.h"
+#include "sml_RunThreads.h"
+#include "misc.h"
 
 #include <assert.h>
+#include <vector>
 
 using namespace sml ;
 
@@ -28,7 +31,61 @@ RunScheduler::RunScheduler(KernelSML* pKernelSML)
     m_pKernelSML = pKernelSML ;
     m_RunFlags = sml_NONE ;
     m_IsRunning = false ;
+    m_RunCount = 0 ;
     m_StopBeforePhase = sml_APPLY_PHASE ;
+    m_pRunThreads = NULL ;
+}
+
+RunScheduler::~RunScheduler()
+{
+    delete m_pRunThreads ;
+}
+
+bool RunScheduler::SetRunThreads(int threads)
+{
+    if (m_IsRunning)
+    {
+        return false ;
+    }
+    
+    if (threads == GetRunThreads())
+    {
+        return true ;
+    }
+    
+    delete m_pRunThreads ;
+    m_pRunThreads = (threads > 1) ? new RunThreads(threads) : NULL ;
+    
+    return true ;
+}
+
+int RunScheduler::GetRunThreads()
+{
+    return m_pRunThreads ? m_pRunThreads->GetNumberThreads() : 0 ;
+}
+
+bool RunScheduler::GetRunThreadStats(std::vector<RunThreadStats>* pStats, uint64_t* pPasses, uint64_t* pTotalUSec)
+{
+    if (!m_pRunThreads)
+    {
+        return false ;
+    }
+    
+    m_pRunThreads->GetStats(pStats, pPasses, pTotalUSec) ;
+    return true ;
+}
+
+void RunScheduler::ResetRunStats()
+{
+    if (m_pRunThreads)
+    {
+        m_pRunThreads->ResetStats() ;
+    }
+    
+    for (AgentMapIter iter = m_pKernelSML->m_AgentMap.begin() ; iter != m_pKernelSML->m_AgentMap.end() ; iter++)
+    {
+        iter->second->ResetStepStats() ;
+    }
 }
 
 /*************************************************************
@@ -677,6 +734,60 @@ bool RunScheduler::TestIfAllFinished(bool forever, smlRunStepSize runStepSize, u
     return allDone ;
 }
 
+/********************************************************************
+* @brief    Updates the run list after an agent has taken one step.
+*           Returns true if the agent is done for this pass through
+*           the step list (finished its run type or stopped running).
+*********************************************************************/
+bool RunScheduler::FinishAgentStep(AgentSML* pAgentSML, smlRunResult runResult, bool forever, smlRunStepSize runStepSize, uint64_t count)
+{
+    bool done = true ;
+    
+    // halted and running agents will return an error from StepInClientThread
+    //
+    
+    // if agent finished one runType, incr counter and remove from stepList
+    if (pAgentSML->CompletedRunType(pAgentSML->GetRunCounter(runStepSize)) /* || pAgent->MaxNilOutputCyclesReached */)
+    {
+        pAgentSML->IncrementLocalRunCounter();
+        pAgentSML->PutAgentOnStepList(false);
+    }
+    else
+    {
+        done = false;
+    }
+    
+    // if agent finished count runTypes, remove from RunList, else runFinished = false;
+    // can also return true if a gSKI_STOP_AFTER_DECISION_CYCLE interrupt occurred
+    // or is pending on agents with RunType DECISION or FOREVER.
+    bool agentFinishedRun = IsAgentFinished(pAgentSML, forever, runStepSize, count) ;
+    
+    // Have to test the run state to find out if we are still ok to keep running
+    // (not sure if runResult provides this as well, but they're from different enums).
+    smlRunState runState = pAgentSML->GetRunState() ;
+    
+    // An agent should return "stopped" if it's just pausing in the middle of a run
+    // before we run it for the next phase.  Anything else means this agent is done running.
+    if (runState != sml_RUNSTATE_STOPPED || agentFinishedRun)
+    {
+        pAgentSML->RemoveAgentFromRunList() ;
+        pAgentSML->SetResultOfRun(runResult) ;
+        // If we know we won't have to step to StopBefore phase
+        // notify listeners that this agent is finished running
+        if ((runStepSize != sml_DECISION) && !forever)
+        {
+            pAgentSML->FireRunEvent(smlEVENT_AFTER_RUN_ENDS) ;
+        }
+    }
+    else
+    {
+        // If at least one agent wants to keep running, we keep running.
+        done = false ;
+    }
+    
+    return done ;
+}
+
 /********************************************************************
 * @brief    Returns true if some agents are currently running.
 *********************************************************************/
@@ -761,9 +872,15 @@ smlRunResult RunScheduler::RunScheduledAgents(bool forever, smlRunStepSize runSt
     
     // Record that we're now running, so we can poll for our status during a run.
     m_IsRunning = true ;
+    m_RunCount++ ;
     
     int interruptCheckRate = m_pKernelSML->GetInterruptCheckRate() ;
     
+    // The agents being stepped at once (when we have run threads) and how each step went
+    std::vector<AgentSML*> stepAgents ;
+    std::vector<smlRunResult> stepResults ;
+    soar_timer stepTimer ;
+    
     // If we need to synchronize agents, we'll set the synchAgent pointer.
     // Otherwise, we'll clear it to indicate no synch needed.
     // This only matters when interleaving by Phases, since SoarKernel methods
@@ -833,6 +950,32 @@ smlRunResult RunScheduler::RunScheduledAgents(bool forever, smlRunStepSize runSt
             //    note that there is not a corresponding AFTER_AGENTS_RUN_STEP event...
             m_pKernelSML->FireSystemEvent(smlEVENT_BEFORE_AGENTS_RUN_STEP) ;
             
+            if (m_pRunThreads)
+            {
+                // Step every agent on the step list at once, then finish each step in order
+                stepAgents.clear() ;
+                
+                for (AgentMapIter iter = m_pKernelSML->m_AgentMap.begin() ; iter != m_pKernelSML->m_AgentMap.end() ; iter++)
+                {
+                    if (iter->second->IsAgentOnStepList())
+                    {
+                        stepAgents.push_back(iter->second) ;
+                    }
+                }
+                
+                m_pRunThreads->StepAgents(stepAgents, interleaveStepSize, &stepResults) ;
+                
+                for (size_t i = 0 ; i < stepAgents.size() ; i++)
+                {
+                    if (!FinishAgentStep(stepAgents[i], stepResults[i], forever, runStepSize, count))
+                    {
+                        runFinished = false ;
+                    }
+                }
+                
+                continue ;
+            }
+            
             for (AgentMapIter iter = m_pKernelSML->m_AgentMap.begin() ; iter != m_pKernelSML->m_AgentMap.end() ; iter++)
             {
                 AgentSML* pAgentSML = iter->second ;
@@ -840,48 +983,14 @@ smlRunResult RunScheduler::RunScheduledAgents(bool forever, smlRunStepSize runSt
                 if (pAgentSML->IsAgentOnStepList())
                 {
                     // Run all agents one "interleaveStepSize".
+                    stepTimer.start() ;
                     smlRunResult runResult = pAgentSML->StepInClientThread(interleaveStepSize) ;
+                    stepTimer.stop() ;
+                    pAgentSML->RecordStepTime(stepTimer.get_usec()) ;
                     // ?? pAgentSML->IncrementLocalStepCounter();
                     
-                    // halted and running agents will return an error from StepInClientThread
-                    //
-                    
-                    // if agent finished one runType, incr counter and remove from stepList
-                    if (pAgentSML->CompletedRunType(pAgentSML->GetRunCounter(runStepSize)) /* || pAgent->MaxNilOutputCyclesReached */)
-                    {
-                        pAgentSML->IncrementLocalRunCounter();
-                        pAgentSML->PutAgentOnStepList(false);
-                    }
-                    else
-                    {
-                        runFinished = false;
-                    }
-                    
-                    // if agent finished count runTypes, remove from RunList, else runFinished = false;
-                    // can also return true if a gSKI_STOP_AFTER_DECISION_CYCLE interrupt occurred
-                    // or is pending on agents with RunType DECISION or FOREVER.
-                    bool agentFinishedRun = IsAgentFinished(pAgentSML, forever, runStepSize, count) ;
-                    
-                    // Have to test the run state to find out if we are still ok to keep running
-                    // (not sure if runResult provides this as well, but they're from different enums).
-                    smlRunState runState = pAgentSML->GetRunState() ;
-                    
-                    // An agent should return "stopped" if it's just pausing in the middle of a run
-                    // before we run it for the next phase.  Anything else means this agent is done running.
-                    if (runState != sml_RUNSTATE_STOPPED || agentFinishedRun)
-                    {
-                        pAgentSML->RemoveAgentFromRunList() ;
-                        pAgentSML->SetResultOfRun(runResult) ;
-                        // If we know we won't have to step to StopBefore phase
-                        // notify listeners that this agent is finished running
-                        if ((runStepSize != sml_DECISION) && !forever)
-                        {
-                            pAgentSML->FireRunEvent(smlEVENT_AFTER_RUN_ENDS) ;
-                        }
-                    }
-                    else
+                    if (!FinishAgentStep(pAgentSML, runResult, forever, runStepSize, count))
                     {
-                        // If at least one agent wants to keep running, we keep running.
                         runFinished = false ;
                     }
                 }
@@ -13,12 +13,16 @@
 
 #include "sml_Events.h"
 
+#include <vector>
+
 namespace sml
 {
 
 // Forward declarations
     class KernelSML ;
     class AgentSML ;
+    class RunThreads ;
+    struct RunThreadStats ;
     
     class RunScheduler
     {
@@ -26,6 +30,7 @@ namespace sml
             KernelSML*  m_pKernelSML ;
             smlRunFlags m_RunFlags ;
             bool        m_IsRunning ;
+            uint64_t    m_RunCount ;
             smlRunStepSize m_CurrentRunStepSize ;
             
             // When running by decision stop before this phase runs.
@@ -34,8 +39,12 @@ namespace sml
             // When running multiple agents, we synchronize them to this agent (same phase) before starting the real run.
             AgentSML*   m_pSynchAgentSML ;
             
+            // Steps agents on other threads when more than one is running (NULL to step them all on this one)
+            RunThreads* m_pRunThreads ;
+            
         public:
             RunScheduler(KernelSML* pKernelSML) ;
+            ~RunScheduler() ;
             
             /********************************************************************
             * @brief    This is a method for getting the default value
@@ -87,6 +96,12 @@ namespace sml
             *************************************************************/
             bool IsRunning() ;
             
+            // How many runs have been started (so a caller can tell whether one happened while it wasn't looking)
+            uint64_t GetRunCount()
+            {
+                return m_RunCount ;
+            }
+            
             /*************************************************************
             * @brief    Returns current run step size, only valid if IsRunning
             *************************************************************/
@@ -114,6 +129,24 @@ namespace sml
                 return m_StopBeforePhase ;
             }
             
+            /*********************************************************************
+            * @brief    Sets how many threads agents are stepped on (see sml_RunThreads.h).
+            *           With 0 or 1 every agent is stepped on the thread that called Run,
+            *           one after another.  With more, all the agents on the step list
+            *           take their next step at the same time and the scheduler waits for
+            *           them all before going on, so interleaving by phase or decision
+            *           puts a barrier after each phase or decision.
+            *           Can't be changed while agents are running (returns false).
+            **********************************************************************/
+            bool SetRunThreads(int threads) ;
+            int  GetRunThreads() ;
+            
+            // The run threads' stats (see RunThreads::GetStats).  Returns false if there are no run threads.
+            bool GetRunThreadStats(std::vector<RunThreadStats>* pStats, uint64_t* pPasses, uint64_t* pTotalUSec) ;
+            
+            // Resets the run threads' stats and how long each agent's steps have taken
+            void ResetRunStats() ;
+            
         protected:
             bool            AgentsStillStepping() ;
             bool            AreAgentsSynchronized(AgentSML* pSynchAgent) ;
@@ -131,6 +164,7 @@ namespace sml
             void            TerminateUpdateWorldEvents(bool removeListeners) ;
             void            TestForFiringUpdateWorldEvents();
             bool            TestIfAllFinished(bool forever, smlRunStepSize runStepSize, uint64_t count) ;
+            bool            FinishAgentStep(AgentSML* pAgentSML, smlRunResult runResult, bool forever, smlRunStepSize runStepSize, uint64_t count) ;
             
             AgentSML*       GetAgentToSynchronizeWith() ;
     } ;
@@ -0,0 +1,330 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// RunThreads class
+//
+// A pool of threads the RunScheduler uses to step several agents at once.
+// See sml_RunThreads.h.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "sml_RunThreads.h"
+#include "sml_AgentSML.h"
+#include "misc.h"
+
+#include <algorithm>
+
+using namespace sml ;
+
+THREAD_LOCAL RunThreads::Worker* RunThreads::s_pCurrentWorker = NULL ;
+
+RunThreads::Worker::Worker(RunThreads* pPool, int index)
+{
+    m_pPool = pPool ;
+    m_Index = index ;
+    
+    m_Stats.m_Steps = 0 ;
+    m_Stats.m_Steals = 0 ;
+    m_Stats.m_BusyUSec = 0 ;
+}
+
+void RunThreads::Worker::Run()
+{
+    s_pCurrentWorker = this ;
+    
+    while (true)
+    {
+        m_Start.WaitForEventForever() ;
+        
+        if (QuitNow())
+        {
+            break ;
+        }
+        
+        m_pPool->Work(this) ;
+    }
+    
+    s_pCurrentWorker = NULL ;
+}
+
+RunThreads::RunThreads(int threads)
+{
+    m_pAgents = NULL ;
+    m_pResults = NULL ;
+    m_StepSize = sml_PHASE ;
+    m_Busy = 0 ;
+    m_Passes = 0 ;
+    m_TotalUSec = 0 ;
+    
+    for (int i = 0 ; i < threads ; i++)
+    {
+        Worker* pWorker = new Worker(this, i) ;
+        m_Workers.push_back(pWorker) ;
+        pWorker->Start() ;
+    }
+    
+    m_Load.resize(threads) ;
+}
+
+RunThreads::~RunThreads()
+{
+    for (std::vector<Worker*>::iterator iter = m_Workers.begin() ; iter != m_Workers.end() ; iter++)
+    {
+        // Ask it to stop, wake it up so it sees that, then wait for it
+        (*iter)->Stop(false) ;
+        (*iter)->m_Start.TriggerEvent() ;
+        (*iter)->Stop(true) ;
+        delete *iter ;
+    }
+}
+
+bool RunThreads::OnWorkerThread()
+{
+    return s_pCurrentWorker != NULL ;
+}
+
+// Sorts agent indices most expensive first
+class CompareStepCost
+{
+    public:
+        CompareStepCost(AgentSML* const* pAgents)
+        {
+            m_pAgents = pAgents ;
+        }
+        
+        bool operator()(int a, int b) const
+        {
+            return m_pAgents[a]->GetStepCost() > m_pAgents[b]->GetStepCost() ;
+        }
+        
+    protected:
+        AgentSML* const* m_pAgents ;
+} ;
+
+void RunThreads::StepAgents(std::vector<AgentSML*> const& agents, smlRunStepSize stepSize, std::vector<smlRunResult>* pResults)
+{
+    pResults->resize(agents.size()) ;
+    
+    if (agents.empty())
+    {
+        return ;
+    }
+    
+    soar_timer timer ;
+    timer.start() ;
+    
+    // With only one agent to step it's quicker to do it here
+    if (agents.size() == 1)
+    {
+        soar_timer stepTimer ;
+        stepTimer.start() ;
+        (*pResults)[0] = agents[0]->StepInClientThread(stepSize) ;
+        stepTimer.stop() ;
+        agents[0]->RecordStepTime(stepTimer.get_usec()) ;
+        
+        timer.stop() ;
+        m_Passes++ ;
+        m_TotalUSec += timer.get_usec() ;
+        return ;
+    }
+    
+    m_pAgents = &agents[0] ;
+    m_pResults = &(*pResults)[0] ;
+    m_StepSize = stepSize ;
+    
+    // Deal the agents out, most expensive first, each to the worker with the least work so far.
+    // The stable sort keeps agents that cost the same in step list order.
+    m_Order.resize(agents.size()) ;
+    for (size_t i = 0 ; i < agents.size() ; i++)
+    {
+        m_Order[i] = static_cast<int>(i) ;
+    }
+    std::stable_sort(m_Order.begin(), m_Order.end(), CompareStepCost(m_pAgents)) ;
+    
+    std::fill(m_Load.begin(), m_Load.end(), 0.0) ;
+    
+    for (size_t i = 0 ; i < m_Order.size() ; i++)
+    {
+        size_t least = 0 ;
+        for (size_t w = 1 ; w < m_Workers.size() ; w++)
+        {
+            if (m_Load[w] < m_Load[least])
+            {
+                least = w ;
+            }
+        }
+        
+        // Agents we know nothing about yet count as one usec, so they're spread out too
+        double cost = m_pAgents[m_Order[i]]->GetStepCost() ;
+        m_Load[least] += (cost > 0) ? cost : 1 ;
+        m_Workers[least]->m_Queue.push_back(m_Order[i]) ;
+    }
+    
+    // Only wake the workers that were given something.  Decide which before waking any: once one is running
+    // it can steal another's whole queue, and a worker that's counted in m_Busy has to be woken to finish.
+    m_Starting.clear() ;
+    for (size_t w = 0 ; w < m_Workers.size() ; w++)
+    {
+        if (!m_Workers[w]->m_Queue.empty())
+        {
+            m_Starting.push_back(m_Workers[w]) ;
+        }
+    }
+    
+    m_Busy = static_cast<long>(m_Starting.size()) ;
+    
+    // Triggering the event is a barrier, so the workers see everything set above
+    for (size_t w = 0 ; w < m_Starting.size() ; w++)
+    {
+        m_Starting[w]->m_Start.TriggerEvent() ;
+    }
+    
+    // Handle calls from the workers until they're all done.  A worker can't finish
+    // while it's waiting on a call, so once none are busy there are none left to execute.
+    while (true)
+    {
+        m_Wake.WaitForEventForever() ;
+        
+        ExecuteCalls() ;
+        
+        if (m_Busy == 0)
+        {
+            break ;
+        }
+    }
+    
+    // The last worker to finish decremented m_Busy (a full barrier) after storing its results
+    memory_barrier() ;
+    
+    m_pAgents = NULL ;
+    m_pResults = NULL ;
+    
+    timer.stop() ;
+    m_Passes++ ;
+    m_TotalUSec += timer.get_usec() ;
+}
+
+int RunThreads::TakeAgent(Worker* pWorker)
+{
+    {
+        soar_thread::Lock lock(&pWorker->m_QueueMutex) ;
+        
+        if (!pWorker->m_Queue.empty())
+        {
+            int index = pWorker->m_Queue.front() ;
+            pWorker->m_Queue.pop_front() ;
+            return index ;
+        }
+    }
+    
+    // Our own queue is empty, so steal the cheapest agent another worker hasn't got to yet
+    size_t workers = m_Workers.size() ;
+    
+    for (size_t i = 1 ; i < workers ; i++)
+    {
+        Worker* pVictim = m_Workers[(pWorker->m_Index + i) % workers] ;
+        
+        soar_thread::Lock lock(&pVictim->m_QueueMutex) ;
+        
+        if (!pVictim->m_Queue.empty())
+        {
+            int index = pVictim->m_Queue.back() ;
+            pVictim->m_Queue.pop_back() ;
+            pWorker->m_Stats.m_Steals++ ;
+            return index ;
+        }
+    }
+    
+    return -1 ;
+}
+
+void RunThreads::Work(Worker* pWorker)
+{
+    soar_timer timer ;
+    
+    while (true)
+    {
+        int index = TakeAgent(pWorker) ;
+        
+        if (index < 0)
+        {
+            break ;
+        }
+        
+        AgentSML* pAgentSML = m_pAgents[index] ;
+        
+        timer.start() ;
+        m_pResults[index] = pAgentSML->StepInClientThread(m_StepSize) ;
+        timer.stop() ;
+        
+        uint64_t usec = timer.get_usec() ;
+        pAgentSML->RecordStepTime(usec) ;
+        pWorker->m_Stats.m_Steps++ ;
+        pWorker->m_Stats.m_BusyUSec += usec ;
+    }
+    
+    if (atomic_dec(&m_Busy) == 0)
+    {
+        m_Wake.TriggerEvent() ;
+    }
+}
+
+void RunThreads::GetStats(std::vector<RunThreadStats>* pStats, uint64_t* pPasses, uint64_t* pTotalUSec)
+{
+    pStats->clear() ;
+    
+    for (std::vector<Worker*>::iterator iter = m_Workers.begin() ; iter != m_Workers.end() ; iter++)
+    {
+        pStats->push_back((*iter)->m_Stats) ;
+    }
+    
+    *pPasses = m_Passes ;
+    *pTotalUSec = m_TotalUSec ;
+}
+
+void RunThreads::ResetStats()
+{
+    for (std::vector<Worker*>::iterator iter = m_Workers.begin() ; iter != m_Workers.end() ; iter++)
+    {
+        (*iter)->m_Stats.m_Steps = 0 ;
+        (*iter)->m_Stats.m_Steals = 0 ;
+        (*iter)->m_Stats.m_BusyUSec = 0 ;
+    }
+    
+    m_Passes = 0 ;
+    m_TotalUSec = 0 ;
+}
+
+void RunThreads::CallOnRunThread(RunThreadCall* pCall)
+{
+    Worker* pWorker = s_pCurrentWorker ;
+    RunThreads* pPool = pWorker->m_pPool ;
+    
+    PendingCall pending ;
+    pending.m_pCall = pCall ;
+    pending.m_pWorker = pWorker ;
+    
+    {
+        soar_thread::Lock lock(&pPool->m_Mutex) ;
+        pPool->m_Calls.push_back(pending) ;
+    }
+    
+    pPool->m_Wake.TriggerEvent() ;
+    pWorker->m_Done.WaitForEventForever() ;
+}
+
+void RunThreads::ExecuteCalls()
+{
+    std::vector<PendingCall> calls ;
+    
+    {
+        soar_thread::Lock lock(&m_Mutex) ;
+        calls.swap(m_Calls) ;
+    }
+    
+    for (std::vector<PendingCall>::iterator iter = calls.begin() ; iter != calls.end() ; iter++)
+    {
+        iter->m_pCall->Execute() ;
+        iter->m_pWorker->m_Done.TriggerEvent() ;
+    }
+}
@@ -0,0 +1,176 @@
+/////////////////////////////////////////////////////////////////
+// RunThreads class
+//
+// A pool of threads the RunScheduler uses to step several agents at
+// once.  Each time it's given the agents on the step list it spreads
+// them over its threads, steps each one by the interleave step size and
+// returns once they've all finished, so the scheduler's existing loop
+// becomes a barrier after every phase (or decision etc.) and everything
+// it does between steps (update world events, interrupt checks, reading
+// incoming commands) still happens on the thread that called Run.
+//
+// As the slowest thread decides how long each step takes, the agents
+// are shared out by cost: every agent keeps a recent average of how long
+// its steps take, and each pass deals them out most expensive first to
+// whichever thread has the least work so far.  Each thread works through
+// its own queue from the expensive end, and a thread that runs out takes
+// the cheapest agent left on another thread's queue, which evens things
+// up when an agent costs more (or less) than it did last time.
+//
+// The listeners for an agent's events (and SML RHS functions) are still
+// called on that thread too, one at a time, just as they are when the
+// agents are stepped there.  A worker thread that fires an event hands
+// it to the thread running Soar and waits for it to be handled, so
+// clients don't need to be thread safe -- but while a listener for one
+// agent is running the other agents keep going, so it should only touch
+// the agent it was called for.
+//
+// Agents share very little kernel state (symbols, memory pools, working
+// memory and random number generators are all per agent).  What they
+// do share is either locked (the print sinks, shared smem stores) or
+// kept per thread (print buffers and trace formatting state).
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SML_RUN_THREADS_H
+#define SML_RUN_THREADS_H
+
+#include "sml_Events.h"
+#include "thread_Thread.h"
+#include "thread_Lock.h"
+#include "thread_Event.h"
+
+#include <vector>
+#include <deque>
+
+namespace sml
+{
+
+    class AgentSML ;
+    
+    // What one run thread has done since the stats were last reset
+    struct RunThreadStats
+    {
+        uint64_t    m_Steps ;       // Agent steps taken
+        uint64_t    m_Steals ;      // How many of those came from another thread's queue
+        uint64_t    m_BusyUSec ;    // Time spent stepping agents
+    } ;
+    
+    // Something a worker thread needs done on the thread running Soar
+    class RunThreadCall
+    {
+        public:
+            virtual ~RunThreadCall() { }
+            virtual void Execute() = 0 ;
+    } ;
+    
+    class RunThreads
+    {
+        public:
+            // Starts this many threads
+            RunThreads(int threads) ;
+            
+            // Stops them (and waits for them)
+            ~RunThreads() ;
+            
+            int GetNumberThreads()
+            {
+                return static_cast<int>(m_Workers.size()) ;
+            }
+            
+            /*************************************************************
+            * @brief Steps each agent by one stepSize (see AgentSML::StepInClientThread),
+            *        putting the result for agents[i] in (*pResults)[i], and
+            *        returns when they have all finished.
+            *        While it waits it executes any calls the agents make back
+            *        to this thread.
+            *************************************************************/
+            void StepAgents(std::vector<AgentSML*> const& agents, smlRunStepSize stepSize, std::vector<smlRunResult>* pResults) ;
+            
+            // True if this is one of our threads (in the middle of stepping an agent)
+            static bool OnWorkerThread() ;
+            
+            /*************************************************************
+            * @brief Executes pCall on the thread that called StepAgents and
+            *        returns once it's done.  Only call this from a worker
+            *        thread (OnWorkerThread() is true).
+            *************************************************************/
+            static void CallOnRunThread(RunThreadCall* pCall) ;
+            
+            // Each thread's stats, plus how many times StepAgents was called and how long it took in all
+            // (so a thread's utilization is its busy time over the total).  Only call between steps.
+            void GetStats(std::vector<RunThreadStats>* pStats, uint64_t* pPasses, uint64_t* pTotalUSec) ;
+            void ResetStats() ;
+            
+        protected:
+            class Worker ;
+            friend class Worker ;
+            
+            class Worker : public soar_thread::Thread
+            {
+                public:
+                    Worker(RunThreads* pPool, int index) ;
+                    
+                    void Run() ;
+                    
+                    RunThreads*         m_pPool ;
+                    int                 m_Index ;
+                    soar_thread::Event  m_Start ;   // There's work (or it's time to stop)
+                    soar_thread::Event  m_Done ;    // A call this worker made has been executed
+                    
+                    // Indices of the agents this worker has still to step, most expensive first.
+                    // The worker takes from the front and other workers steal from the back.
+                    std::deque<int>     m_Queue ;
+                    soar_thread::Mutex  m_QueueMutex ;
+                    
+                    RunThreadStats      m_Stats ;
+            } ;
+            
+            // A call from a worker, waiting to be executed
+            struct PendingCall
+            {
+                RunThreadCall*  m_pCall ;
+                Worker*         m_pWorker ;
+            } ;
+            
+            // The worker running on this thread (NULL on any other thread)
+            static THREAD_LOCAL Worker* s_pCurrentWorker ;
+            
+            std::vector<Worker*>    m_Workers ;
+            
+            // The agents being stepped
+            AgentSML* const*        m_pAgents ;
+            smlRunResult*           m_pResults ;
+            smlRunStepSize          m_StepSize ;
+            
+            // Agent indices sorted by cost, each worker's share of the cost and the workers given any agents
+            // (reused from pass to pass)
+            std::vector<int>        m_Order ;
+            std::vector<double>     m_Load ;
+            std::vector<Worker*>    m_Starting ;
+            
+            uint64_t                m_Passes ;
+            uint64_t                m_TotalUSec ;
+            
+            // Workers that haven't finished yet
+            volatile long           m_Busy ;
+            
+            // Guards m_Calls
+            soar_thread::Mutex      m_Mutex ;
+            std::vector<PendingCall> m_Calls ;
+            
+            // Wakes the thread running Soar when there's a call or the last worker finishes
+            soar_thread::Event      m_Wake ;
+            
+            // Steps agents until there are none left.  Called on each worker thread.
+            void Work(Worker* pWorker) ;
+            
+            // Takes the next agent for this worker (from its own queue or another's), or returns -1
+            int TakeAgent(Worker* pWorker) ;
+            
+            void ExecuteCalls() ;
+    } ;
+    
+} // Namespace
+
+#endif // SML_RUN_THREADS_H
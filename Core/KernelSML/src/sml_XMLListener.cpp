@@ -20,6 +20,7 @@
 #include "sml_Connection.h"
 #include "sml_KernelSML.h"
 #include "sml_AgentSML.h"
+#include "sml_EventBatcher.h"
 
 #include "assert.h"
 
@@ -86,13 +87,39 @@ void XMLListener::OnKernelEvent(int eventIDIn, AgentSML* pAgentSML, void* pCallD
         return ;
     }
     
-    // We need the first connection for when we're building the message.  Perhaps this is a sign that
-    // we shouldn't have rolled these methods into Connection.
-    Connection* pConnection = *connectionIter;
-    
     // Convert eventID to a string
     char const* event = m_pKernelSML->ConvertEventToString(eventID) ;
     
+    // Remote listeners are sent the trace in batches, from another thread (see sml_EventBatcher.h).
+    // The batcher takes a copy, so we only need to send the trace ourselves to the rest.
+    EventBatcher* pBatcher = m_pKernelSML->GetEventBatcher() ;
+    ConnectionList unbatched ;
+    
+    // Print output from before this trace goes first (SendEvent would do this too, but too late for the batches)
+    flushPrintOnAgent(pAgentSML) ;
+    
+    for (; connectionIter != GetEnd(eventID) ; connectionIter++)
+    {
+        if (pBatcher->IsBatching(*connectionIter))
+        {
+            pBatcher->AddTrace(*connectionIter, m_pCallbackAgentSML->GetName(), event, pXMLTrace) ;
+        }
+        else
+        {
+            unbatched.push_back(*connectionIter) ;
+        }
+    }
+    
+    if (unbatched.empty())
+    {
+        delete pXMLTrace ;
+        return ;
+    }
+    
+    // We need the first connection for when we're building the message.  Perhaps this is a sign that
+    // we shouldn't have rolled these methods into Connection.
+    Connection* pConnection = unbatched.front();
+    
     // Build the SML message we're going to send.
     soarxml::ElementXML* pMsg = pConnection->CreateSMLCommand(sml_Names::kCommand_Event);
     
@@ -108,7 +135,7 @@ void XMLListener::OnKernelEvent(int eventIDIn, AgentSML* pAgentSML, void* pCallD
     
     // Send the message out
     AnalyzeXML response ;
-    SendEvent(pAgentSML, pConnection, pMsg, &response, connectionIter, GetEnd(eventID)) ;
+    SendEvent(pAgentSML, pConnection, pMsg, &response, unbatched.begin(), unbatched.end()) ;
     
     // Clean up
     delete pMsg ;
@@ -482,6 +482,45 @@ string svs::svs_query(const string& query)
     return state_stack[0]->get_scene()->parse_query(query);
 }
 
+/*
+ An estimate of the memory the scene graphs take up, for memory
+ accounting: the nodes, and the vertices of convex nodes (in local and
+ world coordinates).
+*/
+size_t svs::get_memory_usage() const
+{
+    size_t bytes = 0;
+    
+    for (int i = 0, iend = state_stack.size(); i < iend; ++i)
+    {
+        scene* scn = state_stack[i]->get_scene();
+        if (!scn)
+        {
+            continue;
+        }
+        
+        vector<const sgnode*> nodes;
+        scn->get_all_nodes(nodes);
+        for (int j = 0, jend = nodes.size(); j < jend; ++j)
+        {
+            const convex_node* c = dynamic_cast<const convex_node*>(nodes[j]);
+            if (c)
+            {
+                bytes += sizeof(convex_node) + 2 * c->get_verts().size() * sizeof(vec3);
+            }
+            else if (dynamic_cast<const ball_node*>(nodes[j]))
+            {
+                bytes += sizeof(ball_node);
+            }
+            else
+            {
+                bytes += sizeof(group_node);
+            }
+        }
+    }
+    return bytes;
+}
+
 void svs::proxy_get_children(map<string, cliproxy*>& c)
 {
     c["connect_viewer"]    = new memfunc_proxy<svs>(this, &svs::cli_connect_viewer);
@@ -155,6 +155,7 @@ class svs : public svs_interface, public cliproxy
         void input_callback();
         void add_input(const std::string& in);
         std::string svs_query(const std::string& query);
+        size_t get_memory_usage() const;
         
         soar_interface* get_soar_interface()
         {
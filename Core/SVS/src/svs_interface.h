@@ -17,6 +17,7 @@ class svs_interface
         virtual bool do_cli_command(const std::vector<std::string>& args, std::string& output) = 0;
         virtual bool is_enabled() = 0;
         virtual void set_enabled(bool newSetting) = 0;
+        virtual size_t get_memory_usage() const = 0;
 };
 
 svs_interface* make_svs(agent* a);
@@ -3,6 +3,7 @@
 #include "src/callback.cpp"
 #include "src/chunk.cpp"
 #include "src/consistency.cpp"
+#include "src/deadline.cpp"
 #include "src/debug.cpp"
 #include "src/debug_print.cpp"
 #include "src/debug_disabled.cpp"
@@ -20,9 +21,11 @@
 #include "src/output_manager_db.cpp"
 #include "src/output_manager_params.cpp"
 #include "src/parser.cpp"
+#include "src/perf_counters.cpp"
 #include "src/prefmem.cpp"
 #include "src/print.cpp"
 #include "src/production.cpp"
+#include "src/profiler.cpp"
 #include "src/recmem.cpp"
 #include "src/reinforcement_learning.cpp"
 #include "src/reorder.cpp"
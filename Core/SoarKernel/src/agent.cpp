@@ -56,6 +56,7 @@
 #include "soar_instance.h"
 #include "output_manager.h"
 #include "svs_interface.h"
+#include "soar_rand.h"
 
 /* ================================================================== */
 
@@ -188,6 +189,7 @@ agent* create_soar_agent(char* agent_name)
     newAgent->current_symbol_hash_id             = 0;
     newAgent->current_variable_gensym_number     = 0;
     newAgent->current_wme_timetag                = 1;
+    newAgent->deadline_draining                  = false;
     newAgent->default_wme_depth                  = 1;  /* AGR 646 */
     newAgent->disconnected_ids                   = NIL;
     newAgent->existing_output_links              = NIL;
@@ -217,6 +219,7 @@ agent* create_soar_agent(char* agent_name)
     newAgent->prev_top_state                     = NIL;
     newAgent->print_prompt_flag                  = true;
     newAgent->production_being_fired             = NIL;
+    newAgent->production_cost_enabled            = false;
     newAgent->productions_being_traced           = NIL;
     newAgent->promoted_ids                       = NIL;
     newAgent->reason_for_stopping                = "Startup";
@@ -277,7 +280,15 @@ agent* create_soar_agent(char* agent_name)
     newAgent->lexeme.id_letter = 'A';
     newAgent->lexeme.id_number = 0;
     
+    /* Initializing memory accounting (before any pool allocator is made) */
+    for (int i = 0; i < NUM_MEM_SUBSYSTEMS; i++)
+    {
+        newAgent->pool_allocator_memory[i] = 0;
+    }
+    
     reset_max_stats(newAgent);
+    deadline_clear(newAgent);
+    deadline_reset_stats(newAgent);
     
     newAgent->real_time_tracker = 0;
     newAgent->attention_lapse_tracker = 0;
@@ -325,6 +336,7 @@ agent* create_soar_agent(char* agent_name)
     newAgent->timers_cpu.set_enabled(&(newAgent->sysparams[TIMERS_ENABLED]));
     newAgent->timers_kernel.set_enabled(&(newAgent->sysparams[TIMERS_ENABLED]));
     newAgent->timers_phase.set_enabled(&(newAgent->sysparams[TIMERS_ENABLED]));
+    newAgent->timers_phase_latency.set_enabled(&(newAgent->sysparams[TIMERS_ENABLED]));
 #ifdef DETAILED_TIMING_STATS
     newAgent->timers_gds.set_enabled(&(newAgent->sysparams[TIMERS_ENABLED]));
 #endif
@@ -353,6 +365,9 @@ agent* create_soar_agent(char* agent_name)
     select_init(newAgent);
     
     
+    // seeded from /dev/urandom (or the time) until srand
+    newAgent->rand_generator = new MTRand();
+    
     // predict initialization
     newAgent->prediction = new std::string();
     predict_init(newAgent);
@@ -364,9 +379,9 @@ agent* create_soar_agent(char* agent_name)
     newAgent->wma_timers = new wma_timer_container(newAgent);
     
 #ifdef USE_MEM_POOL_ALLOCATORS
-    newAgent->wma_forget_pq = new wma_forget_p_queue(std::less< wma_d_cycle >(), soar_module::soar_memory_pool_allocator< std::pair< wma_d_cycle, wma_decay_set* > >(newAgent));
-    newAgent->wma_touched_elements = new wma_pooled_wme_set(std::less< wme* >(), soar_module::soar_memory_pool_allocator< wme* >(newAgent));
-    newAgent->wma_touched_sets = new wma_decay_cycle_set(std::less< wma_d_cycle >(), soar_module::soar_memory_pool_allocator< wma_d_cycle >(newAgent));
+    newAgent->wma_forget_pq = new wma_forget_p_queue(std::less< wma_d_cycle >(), soar_module::soar_memory_pool_allocator< std::pair< wma_d_cycle, wma_decay_set* > >(newAgent, MEM_SUBSYSTEM_WMA));
+    newAgent->wma_touched_elements = new wma_pooled_wme_set(std::less< wme* >(), soar_module::soar_memory_pool_allocator< wme* >(newAgent, MEM_SUBSYSTEM_WMA));
+    newAgent->wma_touched_sets = new wma_decay_cycle_set(std::less< wma_d_cycle >(), soar_module::soar_memory_pool_allocator< wma_d_cycle >(newAgent, MEM_SUBSYSTEM_WMA));
 #else
     newAgent->wma_forget_pq = new wma_forget_p_queue();
     newAgent->wma_touched_elements = new wma_pooled_wme_set();
@@ -399,13 +414,13 @@ agent* create_soar_agent(char* agent_name)
     newAgent->output_settings = new AgentOutput_Info();
     
 #ifdef USE_MEM_POOL_ALLOCATORS
-    newAgent->epmem_node_removals = new epmem_id_removal_map(std::less< epmem_node_id >(), soar_module::soar_memory_pool_allocator< std::pair< epmem_node_id, bool > >(newAgent));
-    newAgent->epmem_edge_removals = new epmem_id_removal_map(std::less< epmem_node_id >(), soar_module::soar_memory_pool_allocator< std::pair< epmem_node_id, bool > >(newAgent));
+    newAgent->epmem_node_removals = new epmem_id_removal_map(std::less< epmem_node_id >(), soar_module::soar_memory_pool_allocator< std::pair< epmem_node_id, bool > >(newAgent, MEM_SUBSYSTEM_EPMEM));
+    newAgent->epmem_edge_removals = new epmem_id_removal_map(std::less< epmem_node_id >(), soar_module::soar_memory_pool_allocator< std::pair< epmem_node_id, bool > >(newAgent, MEM_SUBSYSTEM_EPMEM));
     
-    newAgent->epmem_wme_adds = new epmem_symbol_set(std::less< Symbol* >(), soar_module::soar_memory_pool_allocator< Symbol* >(newAgent));
-    newAgent->epmem_promotions = new epmem_symbol_set(std::less< Symbol* >(), soar_module::soar_memory_pool_allocator< Symbol* >(newAgent));
+    newAgent->epmem_wme_adds = new epmem_symbol_set(std::less< Symbol* >(), soar_module::soar_memory_pool_allocator< Symbol* >(newAgent, MEM_SUBSYSTEM_EPMEM));
+    newAgent->epmem_promotions = new epmem_symbol_set(std::less< Symbol* >(), soar_module::soar_memory_pool_allocator< Symbol* >(newAgent, MEM_SUBSYSTEM_EPMEM));
     
-    newAgent->epmem_id_removes = new epmem_symbol_stack(soar_module::soar_memory_pool_allocator< Symbol* >(newAgent));
+    newAgent->epmem_id_removes = new epmem_symbol_stack(soar_module::soar_memory_pool_allocator< Symbol* >(newAgent, MEM_SUBSYSTEM_EPMEM));
 #else
     newAgent->epmem_node_removals = new epmem_id_removal_map();
     newAgent->epmem_edge_removals = new epmem_id_removal_map();
@@ -424,11 +439,13 @@ agent* create_soar_agent(char* agent_name)
     newAgent->smem_timers = new smem_timer_container(newAgent);
     
     newAgent->smem_db = new soar_module::sqlite_database();
+    newAgent->smem_store = NIL;
+    newAgent->smem_overlay = NIL;
     
     newAgent->smem_validation = 0;
     
 #ifdef USE_MEM_POOL_ALLOCATORS
-    newAgent->smem_changed_ids = new smem_pooled_symbol_set(std::less< Symbol* >(), soar_module::soar_memory_pool_allocator< Symbol* >(newAgent));
+    newAgent->smem_changed_ids = new smem_pooled_symbol_set(std::less< Symbol* >(), soar_module::soar_memory_pool_allocator< Symbol* >(newAgent, MEM_SUBSYSTEM_SMEM));
 #else
     newAgent->smem_changed_ids = new smem_pooled_symbol_set();
 #endif
@@ -475,6 +492,7 @@ void destroy_soar_agent(agent* delete_agent)
     
     // cleanup predict
     delete delete_agent->prediction;
+    delete delete_agent->rand_generator;
     
     // cleanup wma
     delete_agent->wma_params->activation->set_value(off);
@@ -527,6 +545,12 @@ void destroy_soar_agent(agent* delete_agent)
     delete delete_agent->debug_params;
     delete delete_agent->output_settings;
     
+    // cleanup output links that were never removed (the structs are in a pool)
+    for (output_link* ol = delete_agent->existing_output_links; ol != NIL; ol = ol->next)
+    {
+        delete ol->ids_in_tc;
+    }
+    
     /////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////
     
@@ -35,6 +35,8 @@
 #include "wma.h"
 #include "episodic_memory.h"
 #include "semantic_memory.h"
+#include "deadline.h"
+#include "perf_counters.h"
 
 #include <string>
 #include <map>
@@ -64,6 +66,7 @@ typedef struct io_wme_struct io_wme;
 typedef struct multi_attributes_struct multi_attribute;
 typedef struct rhs_function_struct rhs_function;
 typedef struct select_info_struct select_info;
+class MTRand;
 class AgentOutput_Info;
 class debug_param_container;
 
@@ -195,6 +198,7 @@ typedef struct agent_struct
     memory_pool         alpha_mem_pool;
     memory_pool         ms_change_pool;
     memory_pool         node_varnames_pool;
+    memory_pool         rete_node_cost_pool;
     
     memory_pool         gds_pool;
     
@@ -231,6 +235,9 @@ typedef struct agent_struct
     uint64_t       num_null_right_activations;
     uint64_t       num_null_left_activations;
     
+    /* Count the work done at each beta node and time production firings (see get_production_costs) */
+    bool           production_cost_enabled;
+    
     
     /* Miscellaneous other stuff */
     uint32_t       alpha_mem_id_counter; /* node id's for hashing */
@@ -583,6 +590,29 @@ typedef struct agent_struct
     
     soar_timer_accumulator callback_timers[NUMBER_OF_CALLBACKS];
     
+    /* Latency histograms (usec), see stats --histogram.  Phases are timed by the wall clock from start to
+       finish, callbacks and all, and a decision cycle's time is the sum of its phases, so time spent
+       between phases (e.g. waiting on other agents) isn't counted. */
+    soar_timer timers_phase_latency;
+    uint64_t latency_dc_usec;                     // Time in the phases of the current decision cycle so far
+    soar_latency_histogram latency_decision_cycle;
+    soar_latency_histogram latency_phase[NUM_PHASE_TYPES];
+    soar_latency_histogram latency_epmem_query;
+    soar_latency_histogram latency_smem_query;
+    
+    /* Hardware counters (see perf_counters.h).  Matching is counted within the phases as well. */
+    perf_counter_accumulator perf_phase[NUM_PHASE_TYPES];
+    perf_counter_accumulator perf_match;
+    
+    /* Deadline mode (see deadline.h) */
+    deferred_work_queue deadline_queue;
+    uint64_t deadline_queued[NUM_DEFERRED_WORK_TYPES];    // Items of each type on the queue
+    uint64_t deadline_deferred[NUM_DEFERRED_WORK_TYPES];  // Times work of each type was deferred, folded or not
+    uint64_t deadline_drained[NUM_DEFERRED_WORK_TYPES];   // Items of each type done from the queue
+    uint64_t deadline_cycles;                             // Decision cycles run with a deadline set
+    uint64_t deadline_missed;                             // How many of those went over it
+    bool deadline_draining;
+    
     /* accumulated cpu time spent in various parts of the system */
     /* only used if DETAILED_TIMING_STATS is #def'd in kernel.h */
 #ifdef DETAILED_TIMING_STATS
@@ -647,6 +677,9 @@ typedef struct agent_struct
     /* Counters for memory usage of various types */
     size_t              memory_for_usage[NUM_MEM_USAGE_CODES];
     
+    /* Live bytes allocated by the STL pool allocators, by mem_subsystem */
+    uint64_t            pool_allocator_memory[NUM_MEM_SUBSYSTEMS];
+    
     /* List of all memory pools being used */
     memory_pool*        memory_pools_in_use;
     
@@ -853,6 +886,9 @@ typedef struct agent_struct
     // select
     select_info* select;
     
+    // random number generator (see soar_rand.h)
+    MTRand*      rand_generator;
+    
     // predict
     uint32_t     predict_seed;
     std::string* prediction;
@@ -914,6 +950,8 @@ typedef struct agent_struct
     
     soar_module::sqlite_database* smem_db;
     smem_statement_container* smem_stmts;
+    smem_native_store* smem_store;
+    smem_store_overlay* smem_overlay;
     
     uint64_t smem_validation;
     int64_t smem_max_cycle;
@@ -48,6 +48,7 @@
 #include "soar_instance.h"
 #include "wma.h"
 #include "test.h"
+#include "profiler.h"
 
 #include <ctype.h>
 
@@ -1162,6 +1163,8 @@ bool should_variablize(agent* thisAgent, instantiation* inst)
 
 void chunk_instantiation(agent* thisAgent, instantiation* inst, bool dont_variablize, instantiation** custom_inst_list)
 {
+    profile_span span(PROFILE_CHUNKING);
+    
     goal_stack_level grounds_level;
     preference* results, *pref;
     action* rhs;
@@ -0,0 +1,143 @@
+#include "portability.h"
+
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+ 
+/* -- deadline.cpp
+ *
+ *    Real-time deadline mode (see deadline.h).
+ */
+ 
+#include "deadline.h"
+#include "agent.h"
+#include "semantic_memory.h"
+#include "wma.h"
+
+const char* deferred_work_names[NUM_DEFERRED_WORK_TYPES] =
+{
+    "wma-forgetting",
+    "smem-activation"
+};
+
+uint64_t deadline_dc_usec(agent* thisAgent)
+{
+#ifndef NO_TIMING_STUFF
+    return thisAgent->latency_dc_usec + thisAgent->timers_phase_latency.get_running_usec();
+#else
+    return 0;
+#endif
+}
+
+bool deadline_defer(agent* thisAgent, deferred_work_type type, int64_t time)
+{
+    int64_t deadline = thisAgent->sysparams[DECISION_CYCLE_DEADLINE_USEC];
+    
+    if ((deadline <= 0) || thisAgent->deadline_draining)
+    {
+        return false;
+    }
+    
+    // Work of a type that's already waiting goes behind it, so it's still done in order
+    if (!thisAgent->deadline_queued[type] && (deadline_dc_usec(thisAgent) < static_cast<uint64_t>(deadline)))
+    {
+        return false;
+    }
+    
+    // Each smem update is for its own access time; the others are folded into the one waiting
+    if ((type == DEFERRED_SMEM_ACTIVATION) || !thisAgent->deadline_queued[type])
+    {
+        deferred_work work;
+        work.type = type;
+        work.time = time;
+        
+        thisAgent->deadline_queue.push_back(work);
+        thisAgent->deadline_queued[type]++;
+    }
+    
+    thisAgent->deadline_deferred[type]++;
+    
+    return true;
+}
+
+void deadline_drain(agent* thisAgent)
+{
+    int64_t deadline = thisAgent->sysparams[DECISION_CYCLE_DEADLINE_USEC];
+    
+    thisAgent->deadline_draining = true;
+    
+    while (!thisAgent->deadline_queue.empty())
+    {
+        if ((deadline > 0) && (deadline_dc_usec(thisAgent) >= static_cast<uint64_t>(deadline)))
+        {
+            break;
+        }
+        
+        deferred_work work = thisAgent->deadline_queue.front();
+        thisAgent->deadline_queue.pop_front();
+        thisAgent->deadline_queued[work.type]--;
+        
+        // The module may have been turned off since the work was queued
+        switch (work.type)
+        {
+            case DEFERRED_WMA_FORGETTING:
+                if (wma_enabled(thisAgent))
+                {
+                    wma_go(thisAgent, wma_forgetting);
+                }
+                break;
+                
+            case DEFERRED_SMEM_ACTIVATION:
+                if (thisAgent->smem_db->get_status() == soar_module::connected)
+                {
+                    smem_update_incremental_activations(thisAgent, work.time);
+                }
+                break;
+                
+            default:
+                break;
+        }
+        
+        thisAgent->deadline_drained[work.type]++;
+    }
+    
+    thisAgent->deadline_draining = false;
+}
+
+void deadline_end_cycle(agent* thisAgent, uint64_t dc_usec)
+{
+    int64_t deadline = thisAgent->sysparams[DECISION_CYCLE_DEADLINE_USEC];
+    
+    if (deadline > 0)
+    {
+        thisAgent->deadline_cycles++;
+        
+        if (dc_usec > static_cast<uint64_t>(deadline))
+        {
+            thisAgent->deadline_missed++;
+        }
+    }
+}
+
+void deadline_clear(agent* thisAgent)
+{
+    thisAgent->deadline_queue.clear();
+    
+    for (int i = 0; i < NUM_DEFERRED_WORK_TYPES; i++)
+    {
+        thisAgent->deadline_queued[i] = 0;
+    }
+}
+
+void deadline_reset_stats(agent* thisAgent)
+{
+    for (int i = 0; i < NUM_DEFERRED_WORK_TYPES; i++)
+    {
+        thisAgent->deadline_deferred[i] = 0;
+        thisAgent->deadline_drained[i] = 0;
+    }
+    
+    thisAgent->deadline_cycles = 0;
+    thisAgent->deadline_missed = 0;
+}
@@ -0,0 +1,77 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/* -- deadline.h
+ *
+ *    Real-time deadline mode.  max-dc-time stops a run once a decision
+ *    cycle has gone on too long; a deadline instead tries to keep each
+ *    cycle short.  With one set (see the deadline command), background
+ *    work that doesn't have to be done in the cycle that asked for it is
+ *    put on a queue once the cycle has used up its time:
+ *
+ *      - WMA's forgetting sweep (further sweeps asked for while one is
+ *        waiting are folded into it)
+ *      - smem's incremental base-level activation updates
+ *
+ *    The queue is drained, oldest first, at the end of each output phase
+ *    for as long as that cycle is still under its deadline, so the work is
+ *    done in the slack of later cycles.  Turning the deadline off drains
+ *    it all at the next output phase, and init-soar throws it away.
+ *
+ *    Chunk building isn't deferred: a chunk is built from the instantiation
+ *    that returned its results, which won't be around in a later cycle.
+ *    Nor is storing an episode, which has to record working memory as it is
+ *    in the cycle that asked for it.
+ *
+ *    A cycle's time is the time spent in its phases (as for
+ *    stats --histogram), so the deadline needs the timers on.
+ */
+ 
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include "portability.h"
+
+#include <deque>
+
+typedef struct agent_struct agent;
+
+enum deferred_work_type
+{
+    DEFERRED_WMA_FORGETTING = 0,
+    DEFERRED_SMEM_ACTIVATION,
+    
+    NUM_DEFERRED_WORK_TYPES
+};
+
+extern const char* deferred_work_names[NUM_DEFERRED_WORK_TYPES];
+
+struct deferred_work
+{
+    deferred_work_type  type;
+    int64_t             time;       // For smem, the access time the activations are updated for
+};
+
+typedef std::deque<deferred_work> deferred_work_queue;
+
+// Time spent in the current decision cycle so far (usec)
+extern uint64_t deadline_dc_usec(agent* thisAgent);
+
+// Called before doing deferrable work.  Returns true (and queues the work) if it should be left for later:
+// the cycle is over its deadline or work of this type is already waiting.
+extern bool deadline_defer(agent* thisAgent, deferred_work_type type, int64_t time = 0);
+
+// Does queued work until the queue is empty or the cycle reaches its deadline
+extern void deadline_drain(agent* thisAgent);
+
+// Called at the end of each decision cycle with its time
+extern void deadline_end_cycle(agent* thisAgent, uint64_t dc_usec);
+
+// Throws the queued work away (init-soar)
+extern void deadline_clear(agent* thisAgent);
+
+extern void deadline_reset_stats(agent* thisAgent);
+
+#endif // DEADLINE_H
@@ -126,7 +126,7 @@ void predict_srand_store_snapshot(agent* thisAgent)
     
     while (!storage_val)
     {
-        storage_val = SoarRandInt();
+        storage_val = SoarRandInt(thisAgent);
     }
     
     thisAgent->predict_seed = storage_val;
@@ -139,7 +139,7 @@ void predict_srand_restore_snapshot(agent* thisAgent, bool clear_snapshot)
 {
     if (thisAgent->predict_seed)
     {
-        SoarSeedRNG(thisAgent->predict_seed);
+        SoarSeedRNG(thisAgent, thisAgent->predict_seed);
     }
     
     if (clear_snapshot)
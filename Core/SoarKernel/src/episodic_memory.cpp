@@ -34,6 +34,7 @@
 #include "xml.h"
 #include "instantiations.h"
 #include "decide.h"
+#include "profiler.h"
 
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
@@ -2161,7 +2162,7 @@ void epmem_init_db(agent* thisAgent, bool readonly)
             (*thisAgent->epmem_id_repository)[ EPMEM_NODEID_ROOT ] = new epmem_hashed_id_pool;
             {
 #ifdef USE_MEM_POOL_ALLOCATORS
-                epmem_wme_set* wms_temp = new epmem_wme_set(std::less< wme* >(), soar_module::soar_memory_pool_allocator< wme* >(thisAgent));
+                epmem_wme_set* wms_temp = new epmem_wme_set(std::less< wme* >(), soar_module::soar_memory_pool_allocator< wme* >(thisAgent, MEM_SUBSYSTEM_EPMEM));
 #else
                 epmem_wme_set* wms_temp = new epmem_wme_set();
 #endif
@@ -2875,7 +2876,7 @@ inline void _epmem_store_level(agent* thisAgent,
                     
                     // add ref set
 #ifdef USE_MEM_POOL_ALLOCATORS
-                    (*thisAgent->epmem_id_ref_counts)[(*w_p)->value->id->epmem_id ] = new epmem_wme_set(std::less< wme* >(), soar_module::soar_memory_pool_allocator< wme* >(thisAgent));
+                    (*thisAgent->epmem_id_ref_counts)[(*w_p)->value->id->epmem_id ] = new epmem_wme_set(std::less< wme* >(), soar_module::soar_memory_pool_allocator< wme* >(thisAgent, MEM_SUBSYSTEM_EPMEM));
 #else
                     (*thisAgent->epmem_id_ref_counts)[(*w_p)->value->id->epmem_id ] = new epmem_wme_set();
 #endif
@@ -2936,7 +2937,7 @@ inline void _epmem_store_level(agent* thisAgent,
                 if (thisAgent->epmem_id_ref_counts->count((*w_p)->value->id->epmem_id) == 0)
                 {
 #ifdef USE_MEM_POOL_ALLOCATORS
-                    (*thisAgent->epmem_id_ref_counts)[(*w_p)->value->id->epmem_id ] = new epmem_wme_set(std::less< wme* >(), soar_module::soar_memory_pool_allocator< wme* >(thisAgent));
+                    (*thisAgent->epmem_id_ref_counts)[(*w_p)->value->id->epmem_id ] = new epmem_wme_set(std::less< wme* >(), soar_module::soar_memory_pool_allocator< wme* >(thisAgent, MEM_SUBSYSTEM_EPMEM));
 #else
                     (*thisAgent->epmem_id_ref_counts)[(*w_p)->value->id->epmem_id ] = new epmem_wme_set;
 #endif
@@ -4077,7 +4078,7 @@ epmem_literal* epmem_build_dnf(wme* cue_wme, epmem_wme_literal_map& literal_cach
     literal->is_neg_q = query_type;
     literal->weight = (literal->is_neg_q ? -1 : 1) * (thisAgent->epmem_params->balance->get_value() >= 1.0 - 1.0e-8 ? 1.0 : wma_get_wme_activation(thisAgent, cue_wme, true));
 #ifdef USE_MEM_POOL_ALLOCATORS
-    new(&(literal->matches)) epmem_node_pair_set(std::less<epmem_node_pair>(), soar_module::soar_memory_pool_allocator<epmem_node_pair>(thisAgent));
+    new(&(literal->matches)) epmem_node_pair_set(std::less<epmem_node_pair>(), soar_module::soar_memory_pool_allocator<epmem_node_pair>(thisAgent, MEM_SUBSYSTEM_EPMEM));
 #else
     new(&(literal->matches)) epmem_node_pair_set();
 #endif
@@ -4390,8 +4391,8 @@ bool epmem_graph_match(epmem_literal_deque::iterator& dnf_iter, epmem_literal_de
     epmem_literal_deque::iterator next_iter = dnf_iter;
     next_iter++;
 #ifdef USE_MEM_POOL_ALLOCATORS
-    epmem_node_set failed_parents = epmem_node_set(std::less<epmem_node_id>(), soar_module::soar_memory_pool_allocator<epmem_node_id>(thisAgent));
-    epmem_node_set failed_children = epmem_node_set(std::less<epmem_node_id>(), soar_module::soar_memory_pool_allocator<epmem_node_id>(thisAgent));
+    epmem_node_set failed_parents = epmem_node_set(std::less<epmem_node_id>(), soar_module::soar_memory_pool_allocator<epmem_node_id>(thisAgent, MEM_SUBSYSTEM_EPMEM));
+    epmem_node_set failed_children = epmem_node_set(std::less<epmem_node_id>(), soar_module::soar_memory_pool_allocator<epmem_node_id>(thisAgent, MEM_SUBSYSTEM_EPMEM));
 #else
     epmem_node_set failed_parents;
     epmem_node_set failed_children;
@@ -4556,10 +4557,10 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
 #ifdef USE_MEM_POOL_ALLOCATORS
     epmem_triple_uedge_map uedge_caches[2] =
     {
-        epmem_triple_uedge_map(std::less<epmem_triple>(), soar_module::soar_memory_pool_allocator<std::pair<const epmem_triple, epmem_uedge*> >(thisAgent)),
-        epmem_triple_uedge_map(std::less<epmem_triple>(), soar_module::soar_memory_pool_allocator<std::pair<const epmem_triple, epmem_uedge*> >(thisAgent))
+        epmem_triple_uedge_map(std::less<epmem_triple>(), soar_module::soar_memory_pool_allocator<std::pair<const epmem_triple, epmem_uedge*> >(thisAgent, MEM_SUBSYSTEM_EPMEM)),
+        epmem_triple_uedge_map(std::less<epmem_triple>(), soar_module::soar_memory_pool_allocator<std::pair<const epmem_triple, epmem_uedge*> >(thisAgent, MEM_SUBSYSTEM_EPMEM))
     };
-    epmem_interval_set interval_cleanup = epmem_interval_set(std::less<epmem_interval*>(), soar_module::soar_memory_pool_allocator<epmem_interval*>(thisAgent));
+    epmem_interval_set interval_cleanup = epmem_interval_set(std::less<epmem_interval*>(), soar_module::soar_memory_pool_allocator<epmem_interval*>(thisAgent, MEM_SUBSYSTEM_EPMEM));
 #else
     epmem_triple_uedge_map uedge_caches[2] = {epmem_triple_uedge_map(), epmem_triple_uedge_map()};
     epmem_interval_set interval_cleanup = epmem_interval_set();
@@ -4610,7 +4611,7 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
             new(&(root_literal->parents)) epmem_literal_set();
             new(&(root_literal->children)) epmem_literal_set();
 #ifdef USE_MEM_POOL_ALLOCATORS
-            new(&(root_literal->matches)) epmem_node_pair_set(std::less<epmem_node_pair>(), soar_module::soar_memory_pool_allocator<epmem_node_pair>(thisAgent));
+            new(&(root_literal->matches)) epmem_node_pair_set(std::less<epmem_node_pair>(), soar_module::soar_memory_pool_allocator<epmem_node_pair>(thisAgent, MEM_SUBSYSTEM_EPMEM));
 #else
             new(&(root_literal->matches)) epmem_node_pair_set();
 #endif
@@ -6027,7 +6028,19 @@ void epmem_respond_to_cmd(agent* thisAgent)
                 // query
                 else if (path == 3)
                 {
+#ifndef NO_TIMING_STUFF
+                    soar_timer query_timer;
+                    query_timer.set_enabled(&(thisAgent->sysparams[ TIMERS_ENABLED ]));
+                    query_timer.start();
+#endif
                     epmem_process_query(thisAgent, state, query, neg_query, prohibit, before, after, cue_wmes, meta_wmes, retrieval_wmes);
+#ifndef NO_TIMING_STUFF
+                    query_timer.stop();
+                    if (thisAgent->sysparams[ TIMERS_ENABLED ])
+                    {
+                        thisAgent->latency_epmem_query.record(query_timer.get_usec());
+                    }
+#endif
                     
                     // add one to the cbr stat
                     thisAgent->epmem_stats->cbr->set_value(thisAgent->epmem_stats->cbr->get_value() + 1);
@@ -6116,6 +6129,7 @@ void epmem_respond_to_cmd(agent* thisAgent)
  **************************************************************************/
 void epmem_go(agent* thisAgent, bool allow_store)
 {
+    profile_span span(PROFILE_EPMEM);
 
     thisAgent->epmem_timers->total->start();
     
@@ -148,10 +148,10 @@ extern preference* exploration_choose_according_to_policy(agent* thisAgent, slot
 extern double exploration_probability_according_to_policy(agent* thisAgent, slot* s, preference* candidates, preference* selection);
 
 // selects a candidate in a random fashion
-extern preference* exploration_randomly_select(preference* candidates);
+extern preference* exploration_randomly_select(agent* thisAgent, preference* candidates);
 
 // selects a candidate in a softmax fashion
-extern preference* exploration_probabilistically_select(preference* candidates);
+extern preference* exploration_probabilistically_select(agent* thisAgent, preference* candidates);
 
 // selects a candidate based on a boltzmann distribution
 extern preference* exploration_boltzmann_select(agent* thisAgent, preference* candidates);
@@ -160,7 +160,7 @@ extern preference* exploration_boltzmann_select(agent* thisAgent, preference* ca
 extern preference* exploration_epsilon_greedy_select(agent* thisAgent, preference* candidates);
 
 // returns candidate with highest q-value (random amongst ties), assumes computed values
-extern preference* exploration_get_highest_q_value_pref(preference* candidates);
+extern preference* exploration_get_highest_q_value_pref(agent* thisAgent, preference* candidates);
 
 // computes total contribution for a candidate from each preference, as well as number of contributions
 extern void exploration_compute_value_of_candidate(agent* thisAgent, preference* cand, slot* s, double default_value = 0);
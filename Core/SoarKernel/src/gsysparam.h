@@ -133,8 +133,14 @@ typedef struct agent_struct agent;
 /* MMA: Chunk over evaluation rules in subgoals */
 #define CHUNK_THROUGH_EVALUATION_RULES_SYSPARAM  45
 
+/* Deadline for each decision cycle, see deadline.h */
+#define DECISION_CYCLE_DEADLINE_USEC             46
+
+/* Count cycles, instructions etc. per phase, see perf_counters.h */
+#define PERF_COUNTERS_ENABLED                    47
+
 /* --- Warning: if you add sysparams, be sure to update the next line! --- */
-#define HIGHEST_SYSPARAM_NUMBER                  45
+#define HIGHEST_SYSPARAM_NUMBER                  47
 
 /* -----------------------------------------
    Sysparams[] stores the parameters; set_sysparam()
@@ -45,6 +45,9 @@
 #include "semantic_memory.h"
 #include "svs_interface.h"
 #include "output_manager.h"
+#include "profiler.h"
+#include "deadline.h"
+#include "perf_counters.h"
 
 /* REW: begin 08.20.97   these defined in consistency.c  */
 extern void determine_highest_active_production_level_in_stack_propose(agent* thisAgent);
@@ -264,6 +267,8 @@ void init_sysparams(agent* thisAgent)
     thisAgent->sysparams[CHUNK_THROUGH_EVALUATION_RULES_SYSPARAM] = false;
     
     thisAgent->sysparams[DECISION_CYCLE_MAX_USEC_INTERRUPT] = 0;
+    thisAgent->sysparams[DECISION_CYCLE_DEADLINE_USEC] = 0;
+    thisAgent->sysparams[PERF_COUNTERS_ENABLED] = false;
 }
 
 /* ===================================================================
@@ -367,6 +372,7 @@ void reset_statistics(agent* thisAgent)
     
     reset_timers(thisAgent);
     reset_max_stats(thisAgent);
+    deadline_reset_stats(thisAgent);
     
     thisAgent->wma_timers->reset();
     thisAgent->epmem_timers->reset();
@@ -403,6 +409,8 @@ void reset_timers(agent* thisAgent)
 #endif
     }
     
+    reset_perf_counter_stats(thisAgent);
+    
     thisAgent->last_derived_kernel_time_usec = 0;
 #endif // NO_TIMING_STUFF
 }
@@ -425,6 +433,33 @@ void reset_max_stats(agent* thisAgent)
     thisAgent->total_dc_smem_time_sec = -1;
     thisAgent->max_dc_smem_time_cycle = 0;
 #endif // NO_TIMING_STUFF
+
+    reset_latency_stats(thisAgent);
+}
+
+void reset_latency_stats(agent* thisAgent)
+{
+#ifndef NO_TIMING_STUFF
+    thisAgent->latency_dc_usec = 0;
+    thisAgent->latency_decision_cycle.reset();
+    for (int i = 0; i < NUM_PHASE_TYPES; i++)
+    {
+        thisAgent->latency_phase[i].reset();
+    }
+    thisAgent->latency_epmem_query.reset();
+    thisAgent->latency_smem_query.reset();
+#endif // NO_TIMING_STUFF
+}
+
+void reset_perf_counter_stats(agent* thisAgent)
+{
+#ifndef NO_TIMING_STUFF
+    for (int i = 0; i < NUM_PHASE_TYPES; i++)
+    {
+        thisAgent->perf_phase[i].reset();
+    }
+    thisAgent->perf_match.reset();
+#endif // NO_TIMING_STUFF
 }
 
 bool reinitialize_soar(agent* thisAgent)
@@ -467,6 +502,9 @@ bool reinitialize_soar(agent* thisAgent)
     set_sysparam(thisAgent, TRACE_WM_CHANGES_SYSPARAM,               false);
     set_sysparam(thisAgent, TRACE_GDS_SYSPARAM,                      false);
     
+    /* Work left for later by deadline mode was for the old working memory */
+    deadline_clear(thisAgent);
+    
     /* Re-init episodic and semantic memory databases */
     epmem_reinit(thisAgent);
     smem_reinit(thisAgent);
@@ -589,6 +627,14 @@ void do_one_top_level_phase(agent* thisAgent)
         return;
     }
     
+    profile_span phase_span(static_cast<profile_span_type>(thisAgent->current_phase));
+    
+#ifndef NO_TIMING_STUFF
+    top_level_phase latency_phase = thisAgent->current_phase;
+    thisAgent->timers_phase_latency.start();
+    perf_span perf_phase_span(thisAgent->perf_phase[latency_phase], thisAgent->sysparams[PERF_COUNTERS_ENABLED]);
+#endif
+    
     smem_attach(thisAgent);
     
     /*
@@ -1064,6 +1110,9 @@ void do_one_top_level_phase(agent* thisAgent)
                 wma_go(thisAgent, wma_forgetting);
             }
             
+            // catch up on work deadline mode put off, while this cycle has time to spare
+            deadline_drain(thisAgent);
+            
             ///////////////////////////////////////////////////////////////////
             assert(thisAgent->wma_d_cycle_count == thisAgent->d_cycle_count);
             ///////////////////////////////////////////////////////////////////
@@ -1325,6 +1374,23 @@ void do_one_top_level_phase(agent* thisAgent)
             
     }  /* end switch stmt for current_phase */
     
+#ifndef NO_TIMING_STUFF
+    /* --- update latency histograms (the decision cycle's once its output phase is done) --- */
+    thisAgent->timers_phase_latency.stop();
+    uint64_t phase_usec = thisAgent->timers_phase_latency.get_usec();
+    if (thisAgent->sysparams[TIMERS_ENABLED])
+    {
+        thisAgent->latency_phase[latency_phase].record(phase_usec);
+        thisAgent->latency_dc_usec += phase_usec;
+        if (latency_phase == OUTPUT_PHASE)
+        {
+            thisAgent->latency_decision_cycle.record(thisAgent->latency_dc_usec);
+            deadline_end_cycle(thisAgent, thisAgent->latency_dc_usec);
+            thisAgent->latency_dc_usec = 0;
+        }
+    }
+#endif
+
     /* --- update WM size statistics --- */
     if (thisAgent->num_wmes_in_rete > thisAgent->max_wm_size)
     {
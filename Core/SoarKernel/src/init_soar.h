@@ -67,6 +67,20 @@ extern void reset_timers(agent* thisAgent);
 --------------------------------------------------------------------- */
 extern void reset_max_stats(agent* thisAgent);
 
+/* ---------------------------------------------------------------------
+                         Reset Latency Stats
+   Empties the decision cycle, phase and epmem/smem query latency
+   histograms (stats --histogram).  Also done by reset_max_stats.
+--------------------------------------------------------------------- */
+extern void reset_latency_stats(agent* thisAgent);
+
+/* ---------------------------------------------------------------------
+                       Reset Perf Counter Stats
+   Zeroes the hardware counts kept per phase and for matching (stats
+   --counters).  Also done by reset_timers.
+--------------------------------------------------------------------- */
+extern void reset_perf_counter_stats(agent* thisAgent);
+
 /* ---------------------------------------------------------------------
                          Reinitializing Soar
 
@@ -57,6 +57,7 @@
 
 
 #include "wma.h"
+#include "profiler.h"
 
 #include <ctype.h>
 
@@ -112,6 +113,9 @@ void add_output_function(agent* thisAgent,
     }
 }
 
+void remove_output_link_tc_info(agent* thisAgent, output_link* ol);
+void release_output_link_changes(agent* thisAgent, ::list** changes);
+
 void remove_output_function(agent* thisAgent, const char* name)
 {
     soar_callback* cb;
@@ -130,6 +134,10 @@ void remove_output_function(agent* thisAgent, const char* name)
         if (ol->cb == cb)
         {
             /* Remove ol entry */
+            remove_output_link_tc_info(thisAgent, ol);
+            release_output_link_changes(thisAgent, &ol->added_wmes);
+            release_output_link_changes(thisAgent, &ol->removed_wmes);
+            delete ol->ids_in_tc;
             ol->link_wme->output_link = NULL;
             wme_remove_ref(thisAgent, ol->link_wme);
             remove_from_dll(thisAgent->existing_output_links, ol, next, prev);
@@ -311,6 +319,7 @@ bool remove_input_wme(agent* thisAgent, wme* w)
 
 void do_input_cycle(agent* thisAgent)
 {
+    profile_span span(PROFILE_INPUT_FUNCTION);
 
     if (thisAgent->prev_top_state && (!thisAgent->top_state))
     {
@@ -395,9 +404,9 @@ void do_input_cycle(agent* thisAgent)
    the output_link structures accordingly.
 
    Transitive closure information is kept as follows:  each output_link
-   structure has a list of all the ids in the link's TC.  Each id in
-   the system has a list of all the output_link structures that it's
-   in the TC of.
+   structure has a map of all the ids in the link's TC (counting the wmes
+   in the TC that point to each one).  Each id in the system has a list
+   of all the output_link structures that it's in the TC of.
 
    After some number of calls to inform_output_module_of_wm_changes(),
    eventually do_output_cycle() gets called.  It scans through the list
@@ -408,11 +417,10 @@ void do_input_cycle(agent* thisAgent)
 /* --- output link statuses --- */
 #define NEW_OL_STATUS 0                    /* just created it */
 #define UNCHANGED_OL_STATUS 1              /* normal status */
-#define MODIFIED_BUT_SAME_TC_OL_STATUS 2   /* some value in its TC has been
-                                              modified, but the ids in its TC
-                                              are the same */
-#define MODIFIED_OL_STATUS 3               /* the set of ids in its TC has
-                                              changed */
+#define CHANGES_RECORDED_OL_STATUS 2       /* wmes have joined or left its
+                                              TC, and they've been recorded
+                                              on added_wmes/removed_wmes */
+#define MODIFIED_OL_STATUS 3               /* its TC has to be recalculated */
 #define REMOVED_OL_STATUS 4                /* link has just been removed */
 
 /* --------------------------------------------------------------------
@@ -427,18 +435,14 @@ void do_input_cycle(agent* thisAgent)
 
    TC of existing link changes:
 
-     For wme addition or removal: (<id> ^att constant):
-       for each link in associated_output_links(id),
-         mark link "modified but same tc" (unless it's already marked
-         some other more serious way)
-
-     For wme addition or removal: (<id> ^att <id2>):
-       for each link in associated_output_links(id),
-         mark link "modified" (unless it's already marked
-         some other more serious way)
-
-   Note that we don't update all the TC information after every WM change.
-   The TC info doesn't get updated until do_output_cycle() is called.
+     The batch of wme changes is scanned once, and each wme on an id in
+     the TC of some links (id->associated_output_links) is handed to
+     those links.  For each link that was handed any,
+     update_output_link_tc() brings the TC up to date and records the
+     wmes that joined or left it, marking the link "changes recorded"
+     (unless it's already marked some other more serious way).  If it
+     can't be sure what the TC is now, it marks the link "modified"
+     instead and the whole TC is recalculated by do_output_cycle().
 -------------------------------------------------------------------- */
 
 #define LINK_NAME_SIZE 1024
@@ -463,8 +467,12 @@ void update_for_top_state_wme_addition(agent* thisAgent, wme* w)
     ol->status = NEW_OL_STATUS;
     ol->link_wme = w;
     wme_add_ref(w);
-    ol->ids_in_tc = NIL;
+    ol->ids_in_tc = new output_link_tc();
     ol->cb = cb;
+    ol->added_wmes = NIL;
+    ol->removed_wmes = NIL;
+    ol->batch_added = NIL;
+    ol->batch_removed = NIL;
     /* --- make wme point to the structure --- */
     w->output_link = ol;
     
@@ -504,40 +512,17 @@ void update_for_top_state_wme_removal(wme* w)
     w->output_link->status = REMOVED_OL_STATUS;
 }
 
-void update_for_io_wme_change(wme* w)
-{
-    cons* c;
-    output_link* ol;
-    
-    for (c = w->id->id->associated_output_links; c != NIL; c = c->rest)
-    {
-        ol = static_cast<output_link_struct*>(c->first);
-        if (w->value->symbol_type == IDENTIFIER_SYMBOL_TYPE)
-        {
-            /* --- mark ol "modified" --- */
-            if ((ol->status == UNCHANGED_OL_STATUS) ||
-                    (ol->status == MODIFIED_BUT_SAME_TC_OL_STATUS))
-            {
-                ol->status = MODIFIED_OL_STATUS;
-            }
-        }
-        else
-        {
-            /* --- mark ol "modified but same tc" --- */
-            if (ol->status == UNCHANGED_OL_STATUS)
-            {
-                ol->status = MODIFIED_BUT_SAME_TC_OL_STATUS;
-            }
-        }
-    }
-}
+void update_output_link_tc(agent* thisAgent, output_link* ol,
+                           list* wmes_being_added, list* wmes_being_removed);
 
 void inform_output_module_of_wm_changes(agent* thisAgent,
                                         list* wmes_being_added,
                                         list* wmes_being_removed)
 {
-    cons* c;
+    cons* c, *c2;
     wme* w;
+    output_link* ol;
+    bool tc_changed = false;
     
     /* if wmes are added, set flag so can stop when running til output */
     for (c = wmes_being_added; c != NIL; c = c->rest)
@@ -551,9 +536,16 @@ void inform_output_module_of_wm_changes(agent* thisAgent,
         }
         if (w->id->id->associated_output_links)
         {
-            update_for_io_wme_change(w);
+            tc_changed = true;
             thisAgent->output_link_changed = true; /* KJC 11/23/98 */
             thisAgent->d_cycle_last_output = thisAgent->d_cycle_count;   /* KJC 11/17/05 */
+            
+            /* --- hand the wme to each link whose TC its id is in --- */
+            for (c2 = w->id->id->associated_output_links; c2 != NIL; c2 = c2->rest)
+            {
+                ol = static_cast<output_link*>(c2->first);
+                push(thisAgent, w, ol->batch_added);
+            }
         }
         
 #if DEBUG_RTO
@@ -579,7 +571,29 @@ void inform_output_module_of_wm_changes(agent* thisAgent,
         }
         if (w->id->id->associated_output_links)
         {
-            update_for_io_wme_change(w);
+            tc_changed = true;
+            for (c2 = w->id->id->associated_output_links; c2 != NIL; c2 = c2->rest)
+            {
+                ol = static_cast<output_link*>(c2->first);
+                push(thisAgent, w, ol->batch_removed);
+            }
+        }
+    }
+    
+    /* --- bring the TC of each link that was touched up to date --- */
+    if (tc_changed)
+    {
+        for (ol = thisAgent->existing_output_links; ol != NIL; ol = ol->next)
+        {
+            if (!ol->batch_added && !ol->batch_removed)
+            {
+                continue;
+            }
+            update_output_link_tc(thisAgent, ol, ol->batch_added, ol->batch_removed);
+            free_list(thisAgent, ol->batch_added);
+            free_list(thisAgent, ol->batch_removed);
+            ol->batch_added = NIL;
+            ol->batch_removed = NIL;
         }
     }
 }
@@ -587,93 +601,262 @@ void inform_output_module_of_wm_changes(agent* thisAgent,
 /* --------------------------------------------------------------------
                      Updating Link TC Information
 
-   We make no attempt to do the TC updating intelligently.  Whenever the
-   TC changes, we throw away all the old TC info and recalculate the new
-   TC from scratch.  I figure that this part of the system won't get
-   used very frequently and I hope it won't be a time hog.
-
-   Remove_output_link_tc_info() and calculate_output_link_tc_info() are
-   the main routines here.
+   Each output link keeps the ids in its TC, with the number of wmes in
+   the TC that point to each one.  As wmes come and go these counts are
+   kept up to date:  an id that joins the TC brings everything below it
+   along, and an id whose count drops to zero leaves, taking anything
+   that was only in the TC because of it.  Each wme that joins or leaves
+   on the way is recorded for the next output phase, so the work done
+   follows the size of the change rather than the size of the TC.
+
+   Counting can't tell when a cycle of ids has been cut off from the
+   link, as the ids in it still point to each other.  So if an id loses
+   a reference but keeps some others (the structure is shared or has a
+   cycle), we drop the recorded changes and have do_output_cycle()
+   recalculate the TC from scratch, as it always used to.
+   
+   Remove_output_link_tc_info() and calculate_output_link_tc_info() do
+   that (and build the TC of a new link).
 -------------------------------------------------------------------- */
 
-void remove_output_link_tc_info(agent* thisAgent, output_link* ol)
+bool id_in_output_link_tc(output_link* ol, Symbol* id)
 {
-    cons* c, *prev_c;
-    Symbol* id;
+    return (ol->ids_in_tc->find(id) != ol->ids_in_tc->end());
+}
+
+void record_output_link_change(agent* thisAgent, ::list** changes, wme* w)
+{
+    push(thisAgent, w, *changes);
+    wme_add_ref(w);     /* keep it around until the output phase */
+}
+
+void release_output_link_changes(agent* thisAgent, ::list** changes)
+{
+    cons* c;
     
-    while (ol->ids_in_tc)    /* for each id in the old TC... */
+    while (*changes)
     {
-        c = ol->ids_in_tc;
-        ol->ids_in_tc = c->rest;
-        id = static_cast<symbol_struct*>(c->first);
+        c = *changes;
+        *changes = c->rest;
+        wme_remove_ref(thisAgent, static_cast<wme_struct*>(c->first));
         free_cons(thisAgent, c);
+    }
+}
+
+void remove_output_link_from_id(agent* thisAgent, output_link* ol, Symbol* id)
+{
+    cons* c, *prev_c;
         
-        /* --- remove "ol" from the list of associated_output_links(id) --- */
-        prev_c = NIL;
-        for (c = id->id->associated_output_links; c != NIL; prev_c = c, c = c->rest)
-            if (c->first == ol)
-            {
-                break;
-            }
-        if (!c)
-        {
-            char msg[BUFFER_MSG_SIZE];
-            strncpy(msg, "io.c: Internal error: can't find output link in id's list\n", BUFFER_MSG_SIZE);
-            msg[BUFFER_MSG_SIZE - 1] = 0; /* ensure null termination */
-            abort_with_fatal_error(thisAgent, msg);
-        }
-        if (prev_c)
+    /* --- remove "ol" from the list of associated_output_links(id) --- */
+    prev_c = NIL;
+    for (c = id->id->associated_output_links; c != NIL; prev_c = c, c = c->rest)
+        if (c->first == ol)
         {
-            prev_c->rest = c->rest;
-        }
-        else
-        {
-            id->id->associated_output_links = c->rest;
+            break;
         }
-        free_cons(thisAgent, c);
-        symbol_remove_ref(thisAgent, id);
+    if (!c)
+    {
+        char msg[BUFFER_MSG_SIZE];
+        strncpy(msg, "io.c: Internal error: can't find output link in id's list\n", BUFFER_MSG_SIZE);
+        msg[BUFFER_MSG_SIZE - 1] = 0; /* ensure null termination */
+        abort_with_fatal_error(thisAgent, msg);
+    }
+    if (prev_c)
+    {
+        prev_c->rest = c->rest;
+    }
+    else
+    {
+        id->id->associated_output_links = c->rest;
+    }
+    free_cons(thisAgent, c);
+}
+
+void remove_output_link_tc_info(agent* thisAgent, output_link* ol)
+{
+    output_link_tc::iterator iter;
+
+    for (iter = ol->ids_in_tc->begin(); iter != ol->ids_in_tc->end(); iter++)    /* for each id in the old TC... */
+    {
+        remove_output_link_from_id(thisAgent, ol, iter->first);
+        symbol_remove_ref(thisAgent, iter->first);
     }
+    ol->ids_in_tc->clear();
 }
 
+void add_wme_to_output_link_tc(agent* thisAgent, wme* w, bool record);
 
-void add_id_to_output_link_tc(agent* thisAgent, Symbol* id)
+/* Adds a reference to an id from a wme in the TC of thisAgent->output_link_for_tc */
+void add_id_to_output_link_tc(agent* thisAgent, Symbol* id, bool record)
 {
+    output_link* ol = thisAgent->output_link_for_tc;
+    output_link_tc::iterator iter;
     slot* s;
     wme* w;
     
-    /* --- if id is already in the TC, exit --- */
-    if (id->tc_num == thisAgent->output_link_tc_num)
+    /* --- if id is already in the TC, it just has one more reference --- */
+    iter = ol->ids_in_tc->find(id);
+    if (iter != ol->ids_in_tc->end())
     {
+        iter->second++;
         return;
     }
-    id->tc_num = thisAgent->output_link_tc_num;
-    
-    
-    /* --- add id to output_link's list --- */
-    push(thisAgent, id, thisAgent->output_link_for_tc->ids_in_tc);
-    symbol_add_ref(thisAgent, id);  /* make sure the id doesn't get deallocated before we
-                           have a chance to free the cons cell we just added */
+    (*ol->ids_in_tc)[id] = 1;
+    symbol_add_ref(thisAgent, id);  /* make sure the id doesn't get deallocated while it's in the TC */
 
     /* --- add output_link to id's list --- */
-    push(thisAgent, thisAgent->output_link_for_tc, id->id->associated_output_links);
+    push(thisAgent, ol, id->id->associated_output_links);
     
     /* --- do TC through working memory --- */
     /* --- scan through all wmes for all slots for this id --- */
     for (w = id->id->input_wmes; w != NIL; w = w->next)
-        if (w->value->symbol_type == IDENTIFIER_SYMBOL_TYPE)
-        {
-            add_id_to_output_link_tc(thisAgent, w->value);
-        }
+    {
+        add_wme_to_output_link_tc(thisAgent, w, record);
+    }
     for (s = id->id->slots; s != NIL; s = s->next)
         for (w = s->wmes; w != NIL; w = w->next)
-            if (w->value->symbol_type == IDENTIFIER_SYMBOL_TYPE)
-            {
-                add_id_to_output_link_tc(thisAgent, w->value);
-            }
+        {
+            add_wme_to_output_link_tc(thisAgent, w, record);
+        }
     /* don't need to check impasse_wmes, because we couldn't have a pointer
        to a goal or impasse identifier */
 }
 
+void add_wme_to_output_link_tc(agent* thisAgent, wme* w, bool record)
+{
+    if (record)
+    {
+        record_output_link_change(thisAgent, &thisAgent->output_link_for_tc->added_wmes, w);
+    }
+    if (w->value->symbol_type == IDENTIFIER_SYMBOL_TYPE)
+    {
+        add_id_to_output_link_tc(thisAgent, w->value, record);
+    }
+}
+
+/* Records a wme leaving the TC and drops the reference it held.  Ids left with
+   no references go on "leaving", ids left with some on "reduced". */
+void remove_wme_from_output_link_tc(agent* thisAgent, wme* w, ::list** leaving, ::list** reduced)
+{
+    output_link* ol = thisAgent->output_link_for_tc;
+    output_link_tc::iterator iter;
+    
+    record_output_link_change(thisAgent, &ol->removed_wmes, w);
+    
+    if (w->value->symbol_type != IDENTIFIER_SYMBOL_TYPE)
+    {
+        return;
+    }
+    iter = ol->ids_in_tc->find(w->value);
+    if (iter == ol->ids_in_tc->end())
+    {
+        return;
+    }
+    if (--iter->second == 0)
+    {
+        push(thisAgent, w->value, *leaving);
+    }
+    else
+    {
+        push(thisAgent, w->value, *reduced);
+    }
+}
+
+void update_output_link_tc(agent* thisAgent, output_link* ol,
+                           list* wmes_being_added, list* wmes_being_removed)
+{
+    cons* c;
+    wme* w;
+    Symbol* id;
+    slot* s;
+    output_link_tc::iterator iter;
+    ::list* leaving = NIL;
+    ::list* reduced = NIL;
+    bool changed = false;
+    bool shared = false;
+    
+    /* --- if the TC is going to be recalculated anyway, there's nothing to do --- */
+    if ((ol->status != UNCHANGED_OL_STATUS) && (ol->status != CHANGES_RECORDED_OL_STATUS))
+    {
+        return;
+    }
+    
+    thisAgent->output_link_for_tc = ol;
+    
+    /* --- additions first.  These are only wmes on ids that were in the TC
+           before the batch:  an id that joins the TC brings along everything
+           below it as it is now (these wmes are already in their slots) --- */
+    for (c = wmes_being_added; c != NIL; c = c->rest)
+    {
+        w = static_cast<wme_struct*>(c->first);
+        add_wme_to_output_link_tc(thisAgent, w, true);
+        changed = true;
+    }
+    
+    /* --- then removals.  These wmes have already left their slots, so an
+           id that joined above never counted them --- */
+    for (c = wmes_being_removed; c != NIL; c = c->rest)
+    {
+        w = static_cast<wme_struct*>(c->first);
+        remove_wme_from_output_link_tc(thisAgent, w, &leaving, &reduced);
+        changed = true;
+    }
+    
+    /* --- ids that nothing in the TC points to any more leave it --- */
+    while (leaving)
+    {
+        c = leaving;
+        leaving = c->rest;
+        id = static_cast<symbol_struct*>(c->first);
+        free_cons(thisAgent, c);
+        
+        iter = ol->ids_in_tc->find(id);
+        if ((iter == ol->ids_in_tc->end()) || (iter->second > 0))
+        {
+            continue;
+        }
+        ol->ids_in_tc->erase(iter);
+        remove_output_link_from_id(thisAgent, ol, id);
+        
+        for (w = id->id->input_wmes; w != NIL; w = w->next)
+        {
+            remove_wme_from_output_link_tc(thisAgent, w, &leaving, &reduced);
+        }
+        for (s = id->id->slots; s != NIL; s = s->next)
+            for (w = s->wmes; w != NIL; w = w->next)
+            {
+                remove_wme_from_output_link_tc(thisAgent, w, &leaving, &reduced);
+            }
+            
+        symbol_remove_ref(thisAgent, id);
+    }
+    
+    /* --- an id that's still referenced might only be held by a cycle --- */
+    while (reduced)
+    {
+        c = reduced;
+        reduced = c->rest;
+        id = static_cast<symbol_struct*>(c->first);
+        free_cons(thisAgent, c);
+        
+        if (id_in_output_link_tc(ol, id))
+        {
+            shared = true;
+        }
+    }
+    
+    if (shared)
+    {
+        /* the recorded changes are dropped in the output phase:  wmes being
+           added don't hold a reference of their own until the batch is done */
+        ol->status = MODIFIED_OL_STATUS;
+    }
+    else if (changed)
+    {
+        ol->status = CHANGES_RECORDED_OL_STATUS;
+    }
+}
+
 void calculate_output_link_tc_info(agent* thisAgent, output_link* ol)
 {
     /* --- if link doesn't have any substructure, there's no TC --- */
@@ -685,7 +868,7 @@ void calculate_output_link_tc_info(agent* thisAgent, output_link* ol)
     /* --- do TC starting with the link wme's value --- */
     thisAgent->output_link_for_tc = ol;
     thisAgent->output_link_tc_num = get_new_tc_number(thisAgent);
-    add_id_to_output_link_tc(thisAgent, ol->link_wme->value);
+    add_id_to_output_link_tc(thisAgent, ol->link_wme->value, false);
 }
 
 /* --------------------------------------------------------------------
@@ -713,16 +896,16 @@ void add_wme_to_collected_io_wmes(agent* thisAgent, wme* w)
 
 io_wme* get_io_wmes_for_output_link(agent* thisAgent, output_link* ol)
 {
-    cons* c;
+    output_link_tc::iterator iter;
     Symbol* id;
     slot* s;
     wme* w;
     
     thisAgent->collected_io_wmes = NIL;
     add_wme_to_collected_io_wmes(thisAgent, ol->link_wme);
-    for (c = ol->ids_in_tc; c != NIL; c = c->rest)
+    for (iter = ol->ids_in_tc->begin(); iter != ol->ids_in_tc->end(); iter++)
     {
-        id = static_cast<symbol_struct*>(c->first);
+        id = iter->first;
         for (w = id->id->input_wmes; w != NIL; w = w->next)
         {
             add_wme_to_collected_io_wmes(thisAgent, w);
@@ -736,6 +919,73 @@ io_wme* get_io_wmes_for_output_link(agent* thisAgent, output_link* ol)
     return thisAgent->collected_io_wmes;
 }
 
+/* Builds the io_wme's for a list of wmes recorded by update_output_link_tc(),
+   in the order they were recorded (so parents come before their children) */
+io_wme* get_io_wmes_for_changes(agent* thisAgent, ::list* changes)
+{
+    cons* c;
+    
+    thisAgent->collected_io_wmes = NIL;
+    for (c = changes; c != NIL; c = c->rest)
+    {
+        add_wme_to_collected_io_wmes(thisAgent, static_cast<wme_struct*>(c->first));
+    }
+    return thisAgent->collected_io_wmes;
+}
+
+/* Drops the entries on a list of changes that don't count towards the net
+   change, keeping the most recent entry for each wme that does */
+void keep_net_output_link_changes(agent* thisAgent, ::list** changes,
+                                  std::map<wme*, int>& net, int sign)
+{
+    cons** prev = changes;
+    cons* c;
+    wme* w;
+    
+    while ((c = *prev) != NIL)
+    {
+        w = static_cast<wme_struct*>(c->first);
+        int& count = net[w];
+        if (count * sign > 0)
+        {
+            count = 0;      /* later entries for it are repeats */
+            prev = &c->rest;
+        }
+        else
+        {
+            *prev = c->rest;
+            wme_remove_ref(thisAgent, w);
+            free_cons(thisAgent, c);
+        }
+    }
+}
+
+/* A wme can join and leave the TC more than once between output phases
+   (an i-supported wme may come and go within a phase, or a subtree may be
+   moved from one parent to another).  Only the net change is passed on:
+   wmes whose joins and leaves cancel out are dropped from both lists, so
+   output functions that apply additions before removals stay correct. */
+void net_output_link_changes(agent* thisAgent, output_link* ol)
+{
+    std::map<wme*, int> net;
+    cons* c;
+    
+    if (!ol->added_wmes || !ol->removed_wmes)
+    {
+        return;
+    }
+    for (c = ol->added_wmes; c != NIL; c = c->rest)
+    {
+        net[static_cast<wme_struct*>(c->first)]++;
+    }
+    for (c = ol->removed_wmes; c != NIL; c = c->rest)
+    {
+        net[static_cast<wme_struct*>(c->first)]--;
+    }
+    keep_net_output_link_changes(thisAgent, &ol->added_wmes, net, 1);
+    keep_net_output_link_changes(thisAgent, &ol->removed_wmes, net, -1);
+}
+
 void deallocate_io_wme_list(agent* thisAgent, io_wme* iw)
 {
     io_wme* next;
@@ -758,12 +1008,38 @@ void deallocate_io_wme_list(agent* thisAgent, io_wme* iw)
 
 /* Struct used to pass output data to callback functions */
 
+void invoke_output_function(agent* thisAgent, output_link* ol, output_call_info* output_call_data)
+{
+#ifndef NO_TIMING_STUFF     /* moved here from do_one_top_level_phase June 05.  KJC */
+    thisAgent->timers_phase.stop();
+    thisAgent->timers_kernel.stop();
+    thisAgent->timers_total_kernel_time.update(thisAgent->timers_kernel);
+    thisAgent->timers_decision_cycle_phase[thisAgent->current_phase].update(thisAgent->timers_phase);
+    thisAgent->timers_kernel.start();
+#endif
+    if (ol->cb)
+    {
+        (ol->cb->function)(thisAgent, ol->cb->eventid, ol->cb->data, output_call_data);
+    }
+#ifndef NO_TIMING_STUFF
+    thisAgent->timers_kernel.stop();
+    thisAgent->timers_output_function_cpu_time.update(thisAgent->timers_kernel);
+    thisAgent->timers_kernel.start();
+    thisAgent->timers_phase.start();
+#endif
+}
+
 void do_output_cycle(agent* thisAgent)
 {
+    profile_span span(PROFILE_OUTPUT_FUNCTION);
+    
     output_link* ol, *next_ol;
     io_wme* iw_list;
     output_call_info output_call_data;
     
+    output_call_data.added = NIL;
+    output_call_data.removed = NIL;
+    
     for (ol = thisAgent->existing_output_links; ol != NIL; ol = next_ol)
     {
         next_ol = ol->next;
@@ -780,105 +1056,56 @@ void do_output_cycle(agent* thisAgent)
                 iw_list = get_io_wmes_for_output_link(thisAgent, ol);
                 output_call_data.mode = ADDED_OUTPUT_COMMAND;
                 output_call_data.outputs = iw_list;
-#ifndef NO_TIMING_STUFF     /* moved here from do_one_top_level_phase June 05.  KJC */
-                thisAgent->timers_phase.stop();
-                thisAgent->timers_kernel.stop();
-                thisAgent->timers_total_kernel_time.update(thisAgent->timers_kernel);
-                thisAgent->timers_decision_cycle_phase[thisAgent->current_phase].update(thisAgent->timers_phase);
-                thisAgent->timers_kernel.start();
-#endif
-                if (ol->cb)
-                {
-                    (ol->cb->function)(thisAgent, ol->cb->eventid, ol->cb->data, &output_call_data);
-                }
-#ifndef NO_TIMING_STUFF
-                thisAgent->timers_kernel.stop();
-                thisAgent->timers_output_function_cpu_time.update(thisAgent->timers_kernel);
-                thisAgent->timers_kernel.start();
-                thisAgent->timers_phase.start();
-#endif
+                invoke_output_function(thisAgent, ol, &output_call_data);
                 deallocate_io_wme_list(thisAgent, iw_list);
                 ol->status = UNCHANGED_OL_STATUS;
                 break;
                 
-            case MODIFIED_BUT_SAME_TC_OL_STATUS:
-                /* --- don't have to redo the TC, but do call the output function --- */
-                iw_list = get_io_wmes_for_output_link(thisAgent, ol);
-                output_call_data.mode = MODIFIED_OUTPUT_COMMAND;
-                output_call_data.outputs = iw_list;
-#ifndef NO_TIMING_STUFF     /* moved here from do_one_top_level_phase June 05.  KJC */
-                thisAgent->timers_phase.stop();
-                thisAgent->timers_kernel.stop();
-                thisAgent->timers_total_kernel_time.update(thisAgent->timers_kernel);
-                thisAgent->timers_decision_cycle_phase[thisAgent->current_phase].update(thisAgent->timers_phase);
-                thisAgent->timers_kernel.start();
-#endif
-                if (ol->cb)
+            case CHANGES_RECORDED_OL_STATUS:
+                /* --- the TC is up to date, so just pass on what changed --- */
+                net_output_link_changes(thisAgent, ol);
+                if (ol->added_wmes || ol->removed_wmes)
                 {
-                    (ol->cb->function)(thisAgent, ol->cb->eventid, ol->cb->data, &output_call_data);
+                    output_call_data.mode = MODIFIED_OUTPUT_COMMAND;
+                    output_call_data.outputs = NIL;
+                    output_call_data.added = get_io_wmes_for_changes(thisAgent, ol->added_wmes);
+                    output_call_data.removed = get_io_wmes_for_changes(thisAgent, ol->removed_wmes);
+                    invoke_output_function(thisAgent, ol, &output_call_data);
+                    deallocate_io_wme_list(thisAgent, output_call_data.added);
+                    deallocate_io_wme_list(thisAgent, output_call_data.removed);
+                    output_call_data.added = NIL;
+                    output_call_data.removed = NIL;
                 }
-#ifndef NO_TIMING_STUFF
-                thisAgent->timers_kernel.stop();
-                thisAgent->timers_output_function_cpu_time.update(thisAgent->timers_kernel);
-                thisAgent->timers_kernel.start();
-                thisAgent->timers_phase.start();
-#endif
-                deallocate_io_wme_list(thisAgent, iw_list);
+                release_output_link_changes(thisAgent, &ol->added_wmes);
+                release_output_link_changes(thisAgent, &ol->removed_wmes);
                 ol->status = UNCHANGED_OL_STATUS;
                 break;
                 
             case MODIFIED_OL_STATUS:
                 /* --- redo the TC, and call the output function */
+                release_output_link_changes(thisAgent, &ol->added_wmes);
+                release_output_link_changes(thisAgent, &ol->removed_wmes);
                 remove_output_link_tc_info(thisAgent, ol);
                 calculate_output_link_tc_info(thisAgent, ol);
                 iw_list = get_io_wmes_for_output_link(thisAgent, ol);
                 output_call_data.mode = MODIFIED_OUTPUT_COMMAND;
                 output_call_data.outputs = iw_list;
-#ifndef NO_TIMING_STUFF     /* moved here from do_one_top_level_phase June 05.  KJC */
-                thisAgent->timers_phase.stop();
-                thisAgent->timers_kernel.stop();
-                thisAgent->timers_total_kernel_time.update(thisAgent->timers_kernel);
-                thisAgent->timers_decision_cycle_phase[thisAgent->current_phase].update(thisAgent->timers_phase);
-                thisAgent->timers_kernel.start();
-#endif
-                if (ol->cb)
-                {
-                    (ol->cb->function)(thisAgent, ol->cb->eventid, ol->cb->data, &output_call_data);
-                }
-#ifndef NO_TIMING_STUFF
-                thisAgent->timers_kernel.stop();
-                thisAgent->timers_output_function_cpu_time.update(thisAgent->timers_kernel);
-                thisAgent->timers_kernel.start();
-                thisAgent->timers_phase.start();
-#endif
+                invoke_output_function(thisAgent, ol, &output_call_data);
                 deallocate_io_wme_list(thisAgent, iw_list);
                 ol->status = UNCHANGED_OL_STATUS;
                 break;
                 
             case REMOVED_OL_STATUS:
                 /* --- call the output function, and free output_link structure --- */
-                remove_output_link_tc_info(thisAgent, ol);             /* sets ids_in_tc to NIL */
+                remove_output_link_tc_info(thisAgent, ol);             /* empties ids_in_tc */
+                release_output_link_changes(thisAgent, &ol->added_wmes);
+                release_output_link_changes(thisAgent, &ol->removed_wmes);
                 iw_list = get_io_wmes_for_output_link(thisAgent, ol);  /* gives just the link wme */
                 output_call_data.mode = REMOVED_OUTPUT_COMMAND;
                 output_call_data.outputs = iw_list;
-#ifndef NO_TIMING_STUFF     /* moved here from do_one_top_level_phase June 05.  KJC */
-                thisAgent->timers_phase.stop();
-                thisAgent->timers_kernel.stop();
-                thisAgent->timers_total_kernel_time.update(thisAgent->timers_kernel);
-                thisAgent->timers_decision_cycle_phase[thisAgent->current_phase].update(thisAgent->timers_phase);
-                thisAgent->timers_kernel.start();
-#endif
-                if (ol->cb)
-                {
-                    (ol->cb->function)(thisAgent, ol->cb->eventid, ol->cb->data, &output_call_data);
-                }
-#ifndef NO_TIMING_STUFF
-                thisAgent->timers_kernel.stop();
-                thisAgent->timers_output_function_cpu_time.update(thisAgent->timers_kernel);
-                thisAgent->timers_kernel.start();
-                thisAgent->timers_phase.start();
-#endif
+                invoke_output_function(thisAgent, ol, &output_call_data);
                 deallocate_io_wme_list(thisAgent, iw_list);
+                delete ol->ids_in_tc;
                 wme_remove_ref(thisAgent, ol->link_wme);
                 remove_from_dll(thisAgent->existing_output_links, ol, next, prev);
                 free_with_pool(&thisAgent->output_link_pool, ol);
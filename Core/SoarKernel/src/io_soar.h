@@ -28,6 +28,8 @@
 
 #include "callback.h"
 
+#include <map>
+
 typedef unsigned char byte;
 typedef struct cons_struct cons;
 typedef struct wme_struct wme;
@@ -139,6 +141,17 @@ extern bool remove_input_wme(agent* thisAgent, wme* w);
    REMOVED_OUTPUT_COMMAND, the chain consists of just one io_wme--the top-level
    ouput link being removed.
 
+   Rather than the whole transitive closure, a MODIFIED_OUTPUT_COMMAND
+   usually passes just what changed:  "outputs" is NIL, "added" is the chain
+   of wmes that have joined the TC since the last call and "removed" those
+   that have left it (either chain can be empty).  The kernel keeps the TC
+   up to date as working memory changes, so the cost of a call follows the
+   size of the change rather than the size of the output structure.  When
+   it can't tell what changed (see update_output_link_tc() in io_soar.cpp)
+   it falls back to passing the whole TC in "outputs" as before.  An output
+   function that wants the whole TC anyway can always call
+   get_io_wmes_for_output_link().
+   
    Output functions should inspect the io_wme chain and take whatever
    actions are appropriate.  Note that Soar deallocates the io_wme chain
    after calling the output function, so the output function is responsible
@@ -169,13 +182,21 @@ typedef struct io_wme_struct
     uint64_t timetag ;        /* DJP: Added.  Only guaranteed valid for an output wme. */
 } io_wme;
 
+/* --- the ids in the TC of an output link, each with the number of wmes in
+       the TC (including the link wme) that have it as their value --- */
+typedef std::map< Symbol*, uint64_t > output_link_tc;
+
 typedef struct output_link_struct
 {
     struct output_link_struct* next, *prev;  /* dll of all existing links */
     byte status;                             /* current xxx_OL_STATUS */
     wme* link_wme;                           /* points to the output link wme */
-    ::list* ids_in_tc;                         /* ids in TC(link) */
+    output_link_tc* ids_in_tc;               /* ids in TC(link) */
     soar_callback* cb;                       /* corresponding output function */
+    ::list* added_wmes;                      /* wmes that joined TC(link) since the last output phase */
+    ::list* removed_wmes;                    /* and wmes that left it */
+    ::list* batch_added;                     /* wmes on ids in TC(link) in the batch of wm changes */
+    ::list* batch_removed;                   /* being handled (empty otherwise) */
 } output_link;
 
 
@@ -186,7 +207,9 @@ typedef struct output_link_struct
 typedef struct output_call_info_struct
 {
     int mode;
-    io_wme* outputs;
+    io_wme* outputs;    /* every wme in TC(link), or NIL if only the changes are given */
+    io_wme* added;      /* wmes that joined TC(link) since the last call */
+    io_wme* removed;    /* wmes that left it */
 } output_call_info;
 
 extern Symbol* get_output_value(io_wme* outputs, Symbol* id, Symbol* attr);
@@ -24,6 +24,8 @@
 #include "agent.h"
 #include "init_soar.h"
 #include "print.h"
+#include "soar_db.h"
+#include "svs_interface.h"
 
 #include <assert.h>
 
@@ -125,6 +127,184 @@ void print_memory_statistics(agent* thisAgent)
           thisAgent->memory_for_usage[MISCELLANEOUS_MEM_USAGE]);
 }
 
+/* ====================================================================
+
+                          Memory Accounting
+                          
+   See mem.h.  The pools shared by the STL pool allocators (the
+   "dynamic" pools of soar_module::get_memory_pool()) hold items for
+   every subsystem, so their live bytes are counted by the allocators
+   as they allocate and free, and only their free items are put down to
+   "other".
+==================================================================== */
+
+const char* mem_subsystem_names[NUM_MEM_SUBSYSTEMS] =
+{
+    "rete",
+    "working-memory",
+    "productions",
+    "symbols",
+    "rl",
+    "wma",
+    "epmem",
+    "smem",
+    "svs",
+    "hash-tables",
+    "strings",
+    "other",
+    "epmem-db",
+    "smem-db",
+    "stats-db"
+};
+
+/* The subsystem of the pools shared by the pool allocators */
+#define POOL_ALLOCATOR_SUBSYSTEM NUM_MEM_SUBSYSTEMS
+
+/* Pools whose names start with these are for the subsystem; the rest are "other" */
+static const struct
+{
+    const char* name;
+    int subsystem;
+} pool_subsystems[] =
+{
+    { "token",           MEM_SUBSYSTEM_RETE },
+    { "alpha mem",       MEM_SUBSYSTEM_RETE },
+    { "rete",            MEM_SUBSYSTEM_RETE },
+    { "node varnames",   MEM_SUBSYSTEM_RETE },
+    { "right mem",       MEM_SUBSYSTEM_RETE },
+    { "ms change",       MEM_SUBSYSTEM_RETE },
+    { "wme",             MEM_SUBSYSTEM_WORKING_MEMORY },
+    { "slot",            MEM_SUBSYSTEM_WORKING_MEMORY },
+    { "io wme",          MEM_SUBSYSTEM_WORKING_MEMORY },
+    { "output link",     MEM_SUBSYSTEM_WORKING_MEMORY },
+    { "gds",             MEM_SUBSYSTEM_WORKING_MEMORY },
+    { "preference",      MEM_SUBSYSTEM_WORKING_MEMORY },
+    { "instantiation",   MEM_SUBSYSTEM_WORKING_MEMORY },
+    { "production",      MEM_SUBSYSTEM_PRODUCTIONS },
+    { "condition",       MEM_SUBSYSTEM_PRODUCTIONS },
+    { "action",          MEM_SUBSYSTEM_PRODUCTIONS },
+    { "complex test",    MEM_SUBSYSTEM_PRODUCTIONS },
+    { "not",             MEM_SUBSYSTEM_PRODUCTIONS },
+    { "saved test",      MEM_SUBSYSTEM_PRODUCTIONS },
+    { "chunk condition", MEM_SUBSYSTEM_PRODUCTIONS },
+    { "float constant",  MEM_SUBSYSTEM_SYMBOLS },
+    { "int constant",    MEM_SUBSYSTEM_SYMBOLS },
+    { "str constant",    MEM_SUBSYSTEM_SYMBOLS },
+    { "identifier",      MEM_SUBSYSTEM_SYMBOLS },
+    { "variable",        MEM_SUBSYSTEM_SYMBOLS },
+    { "rl_",             MEM_SUBSYSTEM_RL },
+    { "wma",             MEM_SUBSYSTEM_WMA },
+    { "epmem",           MEM_SUBSYSTEM_EPMEM },
+    { "smem",            MEM_SUBSYSTEM_SMEM },
+    { "dynamic",         POOL_ALLOCATOR_SUBSYSTEM },
+    { NIL,               MEM_SUBSYSTEM_OTHER }
+};
+
+static int pool_subsystem(const char* name)
+{
+    int i;
+    
+    for (i = 0; pool_subsystems[i].name; i++)
+    {
+        if (!strncmp(name, pool_subsystems[i].name, strlen(pool_subsystems[i].name)))
+        {
+            break;
+        }
+    }
+    return pool_subsystems[i].subsystem;
+}
+
+uint64_t* get_pool_allocator_counter(agent* thisAgent, mem_subsystem subsystem)
+{
+    return &(thisAgent->pool_allocator_memory[subsystem]);
+}
+
+static void add_database_memory(soar_module::sqlite_database* db, mem_usage* usage)
+{
+    static const int ops[] = { SQLITE_DBSTATUS_CACHE_USED, SQLITE_DBSTATUS_SCHEMA_USED, SQLITE_DBSTATUS_STMT_USED };
+    int current, highwater;
+    
+    if (db->get_status() != soar_module::connected)
+    {
+        return;
+    }
+    
+    for (size_t i = 0; i < (sizeof(ops) / sizeof(ops[0])); i++)
+    {
+        if (sqlite3_db_status(db->get_db(), ops[i], &current, &highwater, 0) == SQLITE_OK)
+        {
+            usage->live += current;
+            usage->reserved += current;
+        }
+    }
+}
+
+static void add_usage(mem_usage* usage, uint64_t live, uint64_t reserved)
+{
+    usage->live += live;
+    usage->reserved += reserved;
+}
+
+void get_memory_accounting(agent* thisAgent, mem_usage usage[NUM_MEM_SUBSYSTEMS])
+{
+    int i;
+    uint64_t allocator_reserved = 0;
+    uint64_t allocator_live = 0;
+    
+    for (i = 0; i < NUM_MEM_SUBSYSTEMS; i++)
+    {
+        usage[i].live = 0;
+        usage[i].reserved = 0;
+    }
+    
+    /* --- pools: the free items are the ones on the free list, which each pool counts --- */
+    for (memory_pool* p = thisAgent->memory_pools_in_use; p != NIL; p = p->next)
+    {
+        uint64_t reserved = static_cast<uint64_t>(p->num_blocks) * p->items_per_block * p->item_size;
+        uint64_t free_items = p->free_count;
+        
+        if (p->subsystem == POOL_ALLOCATOR_SUBSYSTEM)
+        {
+            allocator_reserved += reserved;
+        }
+        else
+        {
+            add_usage(&usage[p->subsystem], reserved - (free_items * p->item_size), reserved);
+        }
+    }
+    
+    for (i = 0; i < NUM_MEM_SUBSYSTEMS; i++)
+    {
+        add_usage(&usage[i], thisAgent->pool_allocator_memory[i], thisAgent->pool_allocator_memory[i]);
+        allocator_live += thisAgent->pool_allocator_memory[i];
+    }
+    if (allocator_reserved > allocator_live)
+    {
+        add_usage(&usage[MEM_SUBSYSTEM_OTHER], 0, allocator_reserved - allocator_live);
+    }
+    
+    /* --- everything else allocate_memory() hands out --- */
+    add_usage(&usage[MEM_SUBSYSTEM_HASH_TABLES], thisAgent->memory_for_usage[HASH_TABLE_MEM_USAGE], thisAgent->memory_for_usage[HASH_TABLE_MEM_USAGE]);
+    add_usage(&usage[MEM_SUBSYSTEM_STRINGS], thisAgent->memory_for_usage[STRING_MEM_USAGE], thisAgent->memory_for_usage[STRING_MEM_USAGE]);
+    add_usage(&usage[MEM_SUBSYSTEM_OTHER], thisAgent->memory_for_usage[MISCELLANEOUS_MEM_USAGE], thisAgent->memory_for_usage[MISCELLANEOUS_MEM_USAGE]);
+    add_usage(&usage[MEM_SUBSYSTEM_OTHER], thisAgent->memory_for_usage[STATS_OVERHEAD_MEM_USAGE], thisAgent->memory_for_usage[STATS_OVERHEAD_MEM_USAGE]);
+    
+    if (thisAgent->svs)
+    {
+        uint64_t svs_bytes = thisAgent->svs->get_memory_usage();
+        add_usage(&usage[MEM_SUBSYSTEM_SVS], svs_bytes, svs_bytes);
+    }
+    
+    add_database_memory(thisAgent->epmem_db, &usage[MEM_SUBSYSTEM_EPMEM_DB]);
+    add_database_memory(thisAgent->smem_db, &usage[MEM_SUBSYSTEM_SMEM_DB]);
+    add_database_memory(thisAgent->stats_db, &usage[MEM_SUBSYSTEM_STATS_DB]);
+}
+
+int64_t get_sqlite_memory_used()
+{
+    return sqlite3_memory_used();
+}
+
 /* ====================================================================
 
                           String Utilities
@@ -297,6 +477,7 @@ void add_block_to_memory_pool(agent* thisAgent, memory_pool* p)
     }
     *(char**)prev_item = static_cast<char*>(p->free_list);
     p->free_list = new_block + sizeof(char*);
+    p->free_count += p->items_per_block;
 }
 
 /* RPM 6/09, with help from AMN */
@@ -313,6 +494,7 @@ void free_memory_pool(agent* thisAgent, memory_pool* p)
         cur_block = next_block;
     }
     p->num_blocks = 0;
+    p->free_count = 0;
 }
 
 void init_memory_pool(agent* thisAgent, memory_pool* p, size_t item_size, const char* name)
@@ -330,6 +512,7 @@ void init_memory_pool(agent* thisAgent, memory_pool* p, size_t item_size, const
     p->num_blocks = 0;
     p->first_block = NIL;
     p->free_list = NIL;
+    p->free_count = 0;
 #ifdef MEMORY_POOL_STATS
     p->used_count = 0;
 #endif
@@ -344,6 +527,7 @@ void init_memory_pool(agent* thisAgent, memory_pool* p, size_t item_size, const
     }
     strncpy(p->name, name, MAX_POOL_NAME_LENGTH);
     p->name[MAX_POOL_NAME_LENGTH - 1] = 0; /* ensure null termination */
+    p->subsystem = pool_subsystem(p->name);
 }
 
 /* ====================================================================
@@ -19,6 +19,18 @@
      is used purely for statistics keeping.
 
      Print_memory_statistics() prints out stats on the memory usage.
+     
+   Memory accounting:
+   
+     Get_memory_accounting() says how much memory each subsystem of an
+     agent (the rete, epmem, etc.) is using.  Memory pools are put down
+     to a subsystem by their names (see init_memory_pool()), and the STL
+     containers using soar_module::soar_memory_pool_allocator to the
+     subsystem their allocator was made for.  The other usage codes are
+     reported as they are, SQLite databases by what sqlite3_db_status()
+     says each is using, and SVS by its own estimate.  Live bytes are
+     in use; reserved bytes also count the free items in pool blocks.
+     Get_sqlite_memory_used() is SQLite's total, for all agents.
 
    String utilities:
 
@@ -170,6 +182,41 @@ extern void* allocate_memory_and_zerofill(agent* thisAgent, size_t size, int usa
 extern void free_memory(agent* thisAgent, void* mem, int usage_code);
 extern void print_memory_statistics(agent* thisAgent);
 
+enum mem_subsystem
+{
+    MEM_SUBSYSTEM_RETE = 0,
+    MEM_SUBSYSTEM_WORKING_MEMORY,
+    MEM_SUBSYSTEM_PRODUCTIONS,
+    MEM_SUBSYSTEM_SYMBOLS,
+    MEM_SUBSYSTEM_RL,
+    MEM_SUBSYSTEM_WMA,
+    MEM_SUBSYSTEM_EPMEM,
+    MEM_SUBSYSTEM_SMEM,
+    MEM_SUBSYSTEM_SVS,
+    MEM_SUBSYSTEM_HASH_TABLES,
+    MEM_SUBSYSTEM_STRINGS,
+    MEM_SUBSYSTEM_OTHER,
+    MEM_SUBSYSTEM_EPMEM_DB,
+    MEM_SUBSYSTEM_SMEM_DB,
+    MEM_SUBSYSTEM_STATS_DB,
+    
+    NUM_MEM_SUBSYSTEMS
+};
+
+extern const char* mem_subsystem_names[NUM_MEM_SUBSYSTEMS];
+
+typedef struct mem_usage_struct
+{
+    uint64_t live;
+    uint64_t reserved;
+} mem_usage;
+
+extern void get_memory_accounting(agent* thisAgent, mem_usage usage[NUM_MEM_SUBSYSTEMS]);
+extern int64_t get_sqlite_memory_used();
+
+/* The count of live bytes a pool allocator made for the subsystem adds to */
+extern uint64_t* get_pool_allocator_counter(agent* thisAgent, mem_subsystem subsystem);
+
 /* ---------------- */
 /* string utilities */
 /* ---------------- */
@@ -216,11 +263,13 @@ typedef struct memory_pool_struct
 {
     void* free_list;             /* header of chain of free items */
     size_t used_count;             /* used for statistics only when #def'd MEMORY_POOL_STATS */
+    size_t free_count;             /* items on the free list (for memory accounting) */
     size_t item_size;               /* bytes per item */
     size_t items_per_block;        /* number of items in each big block */
     size_t num_blocks;             /* number of big blocks in use by this pool */
     void* first_block;           /* header of chain of blocks */
     char name[MAX_POOL_NAME_LENGTH];  /* name of the pool (for memory-stats) */
+    int subsystem;                    /* mem_subsystem it's for (for memory accounting) */
     struct memory_pool_struct* next;  /* next in list of all memory pools */
 } memory_pool;
 
@@ -268,6 +317,7 @@ inline void allocate_with_pool(agent* thisAgent, memory_pool* p, T** dest_item_p
     //  (at least, everything appears to work properly if you swap these lines):
     // (p)->free_list = (*static_cast<P*>(dest_item_pointer))->free_list;
     (p)->free_list =  *(void**)(*(dest_item_pointer));
+    (p)->free_count--;
     
     fill_with_zeroes(*(dest_item_pointer), (p)->item_size);
     increment_used_count(p);
@@ -292,6 +342,7 @@ inline void free_with_pool(memory_pool* p, T* item)
     fill_with_garbage((item), (p)->item_size);
     *(void**)(item) = (p)->free_list;
     (p)->free_list = (void*)(item);
+    (p)->free_count++;
     decrement_used_count(p);
     
 #else // !MEM_POOLS_ENABLED
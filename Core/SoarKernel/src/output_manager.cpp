@@ -1,3 +1,5 @@
+#include "portability.h"
+
 /*************************************************************************
  * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
  * FOR LICENSE AND COPYRIGHT INFORMATION.
@@ -18,6 +20,7 @@
 #include "output_manager_params.h"
 #include "print.h"
 #include "agent.h"
+#include "thread_Lock.h"
 
 AgentOutput_Info::AgentOutput_Info() :
     print_enabled(OM_Init_print_enabled),
@@ -53,8 +56,6 @@ Output_Manager::Output_Manager()
     m_params = new OM_Parameters();
     m_db = NIL;
     
-    next_output_string = 0;
-    
     print_enabled = OM_Init_print_enabled;
     dprint_enabled = OM_Init_dprint_enabled;
     db_mode = OM_Init_db_mode;
@@ -71,6 +72,32 @@ Output_Manager::Output_Manager()
     
 }
 
+/* -- A quick replacement for Soar's printed_output_strings system.  Rather than have
+ *    one string buffer, it rotates through 10 of them.  It allows us to have multiple
+ *    function calls that use that buffer within one print statements.  There are
+ *    probably better approaches, but this avoided revising a lot of other code and
+ *    does the job.  -- */
+static THREAD_LOCAL char printed_output_strings[num_output_strings][output_string_size];
+static THREAD_LOCAL int next_output_string = 0;
+
+char* Output_Manager::get_printed_output_string()
+{
+    if (++next_output_string == num_output_strings)
+    {
+        next_output_string = 0;
+    }
+    return printed_output_strings[next_output_string];
+}
+
+/* -- Guards what every agent prints to (stdout, the database and the column we
+ *    track for it), as agents can be run on several threads at once.  Never freed,
+ *    so it's still there for anything printed during shutdown. -- */
+static soar_thread::Mutex* shared_output_mutex()
+{
+    static soar_thread::Mutex* pMutex = new soar_thread::Mutex();
+    return pMutex;
+}
+
 bool Output_Manager::debug_mode_enabled(TraceMode mode)
 {
     return mode_info[mode].debug_enabled;
@@ -224,11 +251,14 @@ void Output_Manager::print_agent(agent* pSoarAgent, const char* msg)
         
         if (stdout_mode)
         {
+            soar_thread::Lock lock(shared_output_mutex());
             fputs(msg, stdout);
         }
         
     }
     
+    soar_thread::Lock lock(shared_output_mutex());
+    
     update_printer_columns(pSoarAgent, msg);
     
     if (db_mode)
@@ -263,11 +293,14 @@ void Output_Manager::print_debug_agent(agent* pSoarAgent, const char* msg, Trace
             
             if (stdout_mode)
             {
+                soar_thread::Lock lock(shared_output_mutex());
                 fputs(newTrace.c_str(), stdout);
             }
             
         }
         
+        soar_thread::Lock lock(shared_output_mutex());
+        
         update_printer_columns(pSoarAgent, msg);
         
         if (db_mode)
@@ -107,14 +107,9 @@ class Output_Manager
         void print_debug_agent(agent* pSoarAgent, const char* msg, TraceMode mode = No_Mode, bool no_prefix = false);
         void print_db_agent(agent* pSoarAgent, MessageType msgType, TraceMode mode, const char* msg);
         
-        char* get_printed_output_string()
-        {
-            if (++next_output_string == num_output_strings)
-            {
-                next_output_string = 0;
-            }
-            return printed_output_strings[next_output_string];
-        }
+        /* Rotates through num_output_strings buffers.  Each thread has its own
+         * (agents can be run on several threads at once). */
+        char* get_printed_output_string();
         
         int get_printer_output_column(agent* thisAgent = NULL);
         void set_printer_output_column(agent* thisAgent = NULL, int pOutputColumn = 1);
@@ -139,14 +134,6 @@ class Output_Manager
         bool print_enabled, db_mode, stdout_mode, file_mode;
         bool dprint_enabled, db_dbg_mode, stdout_dbg_mode, file_dbg_mode;
         
-        /* -- A quick replacement for Soar's printed_output_strings system.  Rather than have
-         *    one string buffer, it rotates through 10 of them.  It allows us to have multiple
-         *    function calls that use that buffer within one print statements.  There are
-         *    probably better approaches, but this avoided revising a lot of other code and
-         *    does the job.  -- */
-        char    printed_output_strings[output_string_size][num_output_strings];
-        int64_t next_output_string;
-        
         int     global_printer_output_column;
         void    update_printer_columns(agent* pSoarAgent, const char* msg);
         
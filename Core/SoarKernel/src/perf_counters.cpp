@@ -0,0 +1,254 @@
+#include "portability.h"
+
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+ 
+/* -- perf_counters.cpp
+ *
+ *    Hardware performance counters (see perf_counters.h).
+ */
+ 
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <pthread.h>
+#endif
+
+const char* perf_counter_names[NUM_PERF_COUNTERS] =
+{
+    "cycles",
+    "instructions",
+    "cache-misses",
+    "branch-misses"
+};
+
+#ifdef __linux__
+
+static const uint64_t perf_counter_configs[NUM_PERF_COUNTERS] =
+{
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+struct perf_thread_counters
+{
+    int             group;                          // The group leader (cycles), or -1 if it couldn't be opened
+    int             fds[NUM_PERF_COUNTERS];         // -1 for counters that couldn't be opened
+    int             position[NUM_PERF_COUNTERS];    // Where each counter is in a read of the group
+    int             count;                          // Counters in the group
+    std::string     reason;                         // Why the group couldn't be opened
+};
+
+// This thread's counters (opened the first time the thread reads them).  They're also held under
+// counters_key, whose destructor closes them when the thread exits, so run threads and kernel threads
+// that come and go don't leave descriptors behind.  (The main thread's are closed when the process exits.)
+static THREAD_LOCAL perf_thread_counters* current_counters = NULL;
+static pthread_key_t counters_key;
+static pthread_once_t counters_key_once = PTHREAD_ONCE_INIT;
+
+static int open_counter(perf_counter_type type, int group)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = perf_counter_configs[type];
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.disabled = (group == -1) ? 1 : 0;    // The leader is enabled once the whole group is open
+    attr.exclude_kernel = 1;                    // Allowed at the default perf_event_paranoid level
+    attr.exclude_hv = 1;
+    
+    // This thread, on whichever CPU it runs
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group, 0));
+}
+
+static std::string open_error(int error)
+{
+    switch (error)
+    {
+        case ENOENT:
+        case ENODEV:
+        case EOPNOTSUPP:
+            return "this CPU (or VM) doesn't provide hardware counters";
+            
+        case EACCES:
+        case EPERM:
+            return "not permitted (see /proc/sys/kernel/perf_event_paranoid, or the container's seccomp profile)";
+            
+        case ENOSYS:
+            return "this kernel doesn't support perf_event_open";
+            
+        default:
+            return strerror(error);
+    }
+}
+
+static perf_thread_counters* open_thread_counters()
+{
+    perf_thread_counters* counters = new perf_thread_counters;
+    counters->count = 0;
+    
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        counters->fds[i] = -1;
+        counters->position[i] = -1;
+    }
+    
+    counters->group = open_counter(PERF_CYCLES, -1);
+    if (counters->group == -1)
+    {
+        counters->reason = open_error(errno);
+        return counters;
+    }
+    
+    counters->fds[PERF_CYCLES] = counters->group;
+    counters->position[PERF_CYCLES] = counters->count++;
+    
+    // The rest are optional: VMs often pass through cycles and instructions but not the others
+    for (int i = PERF_CYCLES + 1; i < NUM_PERF_COUNTERS; i++)
+    {
+        counters->fds[i] = open_counter(static_cast<perf_counter_type>(i), counters->group);
+        if (counters->fds[i] != -1)
+        {
+            counters->position[i] = counters->count++;
+        }
+    }
+    
+    ioctl(counters->group, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counters->group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    
+    return counters;
+}
+
+static void close_thread_counters(void* pCounters)
+{
+    perf_thread_counters* counters = static_cast<perf_thread_counters*>(pCounters);
+    
+    // The group's members before its leader
+    for (int i = NUM_PERF_COUNTERS - 1; i >= 0; i--)
+    {
+        if (counters->fds[i] != -1)
+        {
+            close(counters->fds[i]);
+        }
+    }
+    
+    delete counters;
+    current_counters = NULL;
+}
+
+static void create_counters_key()
+{
+    pthread_key_create(&counters_key, close_thread_counters);
+}
+
+static perf_thread_counters* thread_counters()
+{
+    if (!current_counters)
+    {
+        current_counters = open_thread_counters();
+        
+        pthread_once(&counters_key_once, create_counters_key);
+        pthread_setspecific(counters_key, current_counters);
+    }
+    
+    return current_counters;
+}
+
+bool perf_counters_available(std::string* pReason)
+{
+    perf_thread_counters* counters = thread_counters();
+    
+    if ((counters->group == -1) && pReason)
+    {
+        *pReason = counters->reason;
+    }
+    
+    return counters->group != -1;
+}
+
+bool perf_counter_supported(perf_counter_type type)
+{
+    return thread_counters()->fds[type] != -1;
+}
+
+bool perf_counters_read(uint64_t values[NUM_PERF_COUNTERS])
+{
+    perf_thread_counters* counters = thread_counters();
+    
+    if (counters->group == -1)
+    {
+        return false;
+    }
+    
+    // Laid out as: number of counters, time enabled, time running, then each counter's value
+    uint64_t buffer[3 + NUM_PERF_COUNTERS];
+    ssize_t size = static_cast<ssize_t>((3 + counters->count) * sizeof(uint64_t));
+    
+    if (read(counters->group, buffer, size) != size)
+    {
+        return false;
+    }
+    
+    uint64_t enabled = buffer[1];
+    uint64_t running = buffer[2];
+    
+    if (!running)
+    {
+        return false;
+    }
+    
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        if (counters->position[i] == -1)
+        {
+            values[i] = 0;
+        }
+        else if (running < enabled)
+        {
+            // The counters were only on the CPU part of the time; estimate the whole
+            values[i] = static_cast<uint64_t>(static_cast<double>(buffer[3 + counters->position[i]]) * enabled / running);
+        }
+        else
+        {
+            values[i] = buffer[3 + counters->position[i]];
+        }
+    }
+    
+    return true;
+}
+
+#else // __linux__
+
+bool perf_counters_available(std::string* pReason)
+{
+    if (pReason)
+    {
+        *pReason = "hardware counters are only supported on Linux";
+    }
+    
+    return false;
+}
+
+bool perf_counter_supported(perf_counter_type)
+{
+    return false;
+}
+
+bool perf_counters_read(uint64_t[NUM_PERF_COUNTERS])
+{
+    return false;
+}
+
+#endif // __linux__
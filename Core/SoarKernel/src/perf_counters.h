@@ -0,0 +1,145 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/* -- perf_counters.h
+ *
+ *    Hardware performance counters.  With them turned on (timers
+ *    --counters), the CPU's cycle, instruction, cache miss and branch
+ *    mispredict counts are read at the start and end of each top-level
+ *    phase and of each batch of rete matching (working memory changes),
+ *    and what was counted in between is added up per phase next to the
+ *    agent's timers.  See stats --counters.
+ *
+ *    Counters are opened (with perf_event_open, so this is Linux only) for
+ *    each thread the first time it reads them and closed when it exits, and
+ *    only count user-space work on that thread.  They often can't be opened at all: in containers
+ *    and VMs that don't pass them through, or when perf_event_paranoid
+ *    forbids it.  Threads that can't open them don't count, and the reason
+ *    is kept for reporting.  If the CPU can't count all four at once the
+ *    kernel takes turns with them, and the counts are scaled up by the time
+ *    each was actually counting, so they are estimates.
+ *
+ *    Reading the counters is a system call, so a phase costs two more of
+ *    them with the counters on.  With them off a span is one test.
+ */
+ 
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include "portability.h"
+
+#include <string>
+
+enum perf_counter_type
+{
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    
+    NUM_PERF_COUNTERS
+};
+
+extern const char* perf_counter_names[NUM_PERF_COUNTERS];
+
+// Opens the counters for the calling thread if that hasn't been tried yet.  Returns false if none of them
+// could be opened, with the reason in pReason.
+extern bool perf_counters_available(std::string* pReason = 0);
+
+// Whether a counter could be opened on the calling thread (the CPU may have some and not others)
+extern bool perf_counter_supported(perf_counter_type type);
+
+// Reads the calling thread's counters into values, returning false if they aren't open
+extern bool perf_counters_read(uint64_t values[NUM_PERF_COUNTERS]);
+
+// What the counters counted over a number of intervals
+class perf_counter_accumulator
+{
+    public:
+        perf_counter_accumulator()
+        {
+            reset();
+        }
+        
+        void reset()
+        {
+            for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+            {
+                totals[i] = 0;
+            }
+            intervals = 0;
+        }
+        
+        // Adds the counts between two reads
+        void update(const uint64_t start[NUM_PERF_COUNTERS], const uint64_t end[NUM_PERF_COUNTERS])
+        {
+            for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+            {
+                if (end[i] > start[i])
+                {
+                    totals[i] += end[i] - start[i];
+                }
+            }
+            intervals++;
+        }
+        
+        void add(const perf_counter_accumulator& other)
+        {
+            for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+            {
+                totals[i] += other.totals[i];
+            }
+            intervals += other.intervals;
+        }
+        
+        uint64_t get(perf_counter_type type) const
+        {
+            return totals[type];
+        }
+        
+        uint64_t get_intervals() const
+        {
+            return intervals;
+        }
+        
+        // Instructions per cycle
+        double get_ipc() const
+        {
+            return totals[PERF_CYCLES] ? static_cast<double>(totals[PERF_INSTRUCTIONS]) / totals[PERF_CYCLES] : 0.0;
+        }
+        
+    private:
+        uint64_t totals[NUM_PERF_COUNTERS];
+        uint64_t intervals;
+};
+
+// Adds what the calling thread's counters count while it exists to an accumulator (if enabled is set)
+class perf_span
+{
+    public:
+        perf_span(perf_counter_accumulator& accumulator, int64_t enabled)
+        {
+            m_accumulator = (enabled && perf_counters_read(m_start)) ? &accumulator : 0;
+        }
+        
+        ~perf_span()
+        {
+            uint64_t end[NUM_PERF_COUNTERS];
+            
+            if (m_accumulator && perf_counters_read(end))
+            {
+                m_accumulator->update(m_start, end);
+            }
+        }
+        
+    private:
+        perf_counter_accumulator*   m_accumulator;
+        uint64_t                    m_start[NUM_PERF_COUNTERS];
+        
+        perf_span(const perf_span&);
+        perf_span& operator=(const perf_span&);
+};
+
+#endif // PERF_COUNTERS_H
@@ -321,7 +321,7 @@ void add_preference_to_tm(agent* thisAgent, preference* pref)
             {
                 allocate_with_pool(thisAgent, &(thisAgent->wma_slot_refs_pool), &(s->wma_val_references));
 #ifdef USE_MEM_POOL_ALLOCATORS
-                s->wma_val_references = new(s->wma_val_references) wma_sym_reference_map(std::less< Symbol* >(), soar_module::soar_memory_pool_allocator< std::pair< Symbol*, uint64_t > >(thisAgent));
+                s->wma_val_references = new(s->wma_val_references) wma_sym_reference_map(std::less< Symbol* >(), soar_module::soar_memory_pool_allocator< std::pair< Symbol*, uint64_t > >(thisAgent, MEM_SUBSYSTEM_WMA));
 #else
                 s->wma_val_references = new(s->wma_val_references) wma_sym_reference_map();
 #endif
@@ -1089,6 +1089,7 @@ production* make_production(agent* thisAgent,
     p->documentation = NIL;
     p->filename = NIL;
     p->firing_count = 0;
+    p->firing_time = 0;
     p->reference_count = 1;
     insert_at_head_of_dll(thisAgent->all_productions_of_type[type], p, next, prev);
     thisAgent->num_productions_of_type[type]++;
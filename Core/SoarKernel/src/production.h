@@ -175,6 +175,7 @@ typedef struct production_struct
     char* filename;             /* name of source file, or NIL.  kjh CUSP(b11) */
     uint64_t reference_count;
     uint64_t firing_count;             /* how many times it's fired */
+    uint64_t firing_time;              /* raw time spent firing it while production costs are on */
     struct production_struct* next, *prev;  /* used for dll */
     byte type;
     byte declared_support;
@@ -0,0 +1,423 @@
+#include "portability.h"
+
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+ 
+/* -- profiler.cpp
+ *
+ *    The span profiler (see profiler.h).
+ */
+ 
+#include "profiler.h"
+#include "thread_Lock.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+const char* profile_span_names[NUM_PROFILE_SPAN_TYPES] =
+{
+    "input-phase",
+    "propose-phase",
+    "decision-phase",
+    "apply-phase",
+    "output-phase",
+    "preference-phase",
+    "wm-phase",
+    "match",
+    "firing",
+    "chunking",
+    "epmem",
+    "smem",
+    "input-function",
+    "output-function",
+    "sml-command"
+};
+
+volatile bool profiler_enabled = false;
+
+// Spans held per thread (a power of two).  At 24 bytes each this is 1.5 MB for every thread that records.
+static const uint64_t profile_buffer_size = 1 << 16;
+
+struct profile_event
+{
+    uint64_t    start;
+    uint64_t    end;
+    uint16_t    type;
+    uint16_t    depth;
+};
+
+struct profile_thread_buffer
+{
+    int             id;
+    uint16_t        depth;      // Spans currently open on this thread
+    uint64_t        next;       // Spans ever recorded; the latest is at (next - 1) % profile_buffer_size
+    profile_event   events[profile_buffer_size];
+};
+
+// The buffer for this thread (created the first time the thread records a span)
+static THREAD_LOCAL profile_thread_buffer* current_buffer = NULL;
+
+// Every thread's buffer.  They're never freed, so the spans of a thread that has exited can still be written out.
+static std::vector<profile_thread_buffer*>* all_buffers = NULL;
+
+static soar_thread::Mutex* profiler_mutex()
+{
+    // Never deleted, so it's still there for threads that record spans during shutdown
+    static soar_thread::Mutex* pMutex = new soar_thread::Mutex();
+    return pMutex;
+}
+
+static profile_thread_buffer* create_thread_buffer()
+{
+    soar_thread::Lock lock(profiler_mutex());
+    
+    if (!all_buffers)
+    {
+        all_buffers = new std::vector<profile_thread_buffer*>();
+    }
+    
+    profile_thread_buffer* buffer = new profile_thread_buffer;
+    buffer->id = static_cast<int>(all_buffers->size()) + 1;
+    buffer->depth = 0;
+    buffer->next = 0;
+    all_buffers->push_back(buffer);
+    
+    return buffer;
+}
+
+uint16_t profiler_begin_span()
+{
+    if (!current_buffer)
+    {
+        current_buffer = create_thread_buffer();
+    }
+    
+    return current_buffer->depth++;
+}
+
+void profiler_end_span(profile_span_type type, uint16_t depth, uint64_t start)
+{
+    uint64_t end = get_raw_time();
+    profile_thread_buffer* buffer = current_buffer;
+    
+    profile_event& event = buffer->events[buffer->next & (profile_buffer_size - 1)];
+    event.start = start;
+    event.end = end;
+    event.type = static_cast<uint16_t>(type);
+    event.depth = depth;
+    
+    buffer->depth = depth;
+    buffer->next++;
+}
+
+void profiler_start()
+{
+    profiler_enabled = true;
+}
+
+void profiler_stop()
+{
+    profiler_enabled = false;
+}
+
+void profiler_clear()
+{
+    soar_thread::Lock lock(profiler_mutex());
+    
+    if (all_buffers)
+    {
+        for (size_t i = 0; i < all_buffers->size(); i++)
+        {
+            (*all_buffers)[i]->next = 0;
+        }
+    }
+}
+
+void profiler_get_counts(uint64_t* pSpans, uint64_t* pOverwritten)
+{
+    soar_thread::Lock lock(profiler_mutex());
+    
+    *pSpans = 0;
+    *pOverwritten = 0;
+    
+    if (all_buffers)
+    {
+        for (size_t i = 0; i < all_buffers->size(); i++)
+        {
+            uint64_t next = (*all_buffers)[i]->next;
+            
+            *pSpans += std::min(next, profile_buffer_size);
+            *pOverwritten += (next > profile_buffer_size) ? next - profile_buffer_size : 0;
+        }
+    }
+}
+
+/***************************************************************************
+ * Reading the spans back.  Each thread's spans are in the order they
+ * ended; we sort them into the order they started (outer spans first) and
+ * walk them with a stack, so each span knows what it was called from and
+ * how much of its time was spent in spans inside it.  Nesting is decided
+ * by time rather than the recorded depth, so spans whose parents have been
+ * overwritten still come out (as roots).
+ ***************************************************************************/
+ 
+static bool span_starts_before(const profile_event& a, const profile_event& b)
+{
+    if (a.start != b.start)
+    {
+        return a.start < b.start;
+    }
+    if (a.end != b.end)
+    {
+        return a.end > b.end;
+    }
+    return a.depth < b.depth;
+}
+
+// Takes a copy of each thread's spans (sorted as above) with the thread's id
+static void copy_spans(std::vector< std::pair< int, std::vector<profile_event> > >* pThreads)
+{
+    soar_thread::Lock lock(profiler_mutex());
+    
+    if (!all_buffers)
+    {
+        return;
+    }
+    
+    for (size_t i = 0; i < all_buffers->size(); i++)
+    {
+        profile_thread_buffer* buffer = (*all_buffers)[i];
+        uint64_t next = buffer->next;
+        uint64_t count = std::min(next, profile_buffer_size);
+        
+        if (!count)
+        {
+            continue;
+        }
+        
+        pThreads->push_back(std::make_pair(buffer->id, std::vector<profile_event>()));
+        std::vector<profile_event>& events = pThreads->back().second;
+        events.reserve(static_cast<size_t>(count));
+        
+        for (uint64_t j = next - count; j < next; j++)
+        {
+            events.push_back(buffer->events[j & (profile_buffer_size - 1)]);
+        }
+        
+        std::sort(events.begin(), events.end(), span_starts_before);
+    }
+}
+
+class span_visitor
+{
+    public:
+        virtual ~span_visitor() {}
+        
+        // Called as each span is finished with.  stack holds the types of the spans it's inside, outermost first.
+        virtual void visit(const std::vector<uint16_t>& stack, const profile_event& event, uint64_t self) = 0;
+};
+
+// A span we're inside while walking, and how long the spans inside it took
+struct profile_frame
+{
+    const profile_event* event;
+    uint64_t children;
+};
+
+static void walk_spans(const std::vector<profile_event>& events, span_visitor* visitor)
+{
+    std::vector<profile_frame> frames;
+    std::vector<uint16_t> stack;
+    
+    for (size_t i = 0; i <= events.size(); i++)
+    {
+        // Finish the spans this one isn't inside (all of them at the end)
+        while (!frames.empty() && (i == events.size() || frames.back().event->end <= events[i].start))
+        {
+            const profile_event* event = frames.back().event;
+            uint64_t duration = event->end - event->start;
+            uint64_t children = std::min(frames.back().children, duration);
+            
+            stack.pop_back();
+            visitor->visit(stack, *event, duration - children);
+            frames.pop_back();
+        }
+        
+        if (i == events.size())
+        {
+            break;
+        }
+        
+        if (!frames.empty())
+        {
+            frames.back().children += events[i].end - events[i].start;
+        }
+        
+        profile_frame f;
+        f.event = &events[i];
+        f.children = 0;
+        frames.push_back(f);
+        stack.push_back(events[i].type);
+    }
+}
+
+void profiler_write_chrome_trace(std::ostream& out)
+{
+    std::vector< std::pair< int, std::vector<profile_event> > > threads;
+    copy_spans(&threads);
+    
+    // Times are in microseconds from the first span recorded
+    double raw_per_usec = get_raw_time_per_usec();
+    uint64_t first = 0;
+    
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        uint64_t start = threads[i].second.front().start;
+        if (!first || start < first)
+        {
+            first = start;
+        }
+    }
+    
+    std::ios_base::fmtflags oldFlags = out.flags();
+    std::streamsize oldPrecision = out.precision(3);
+    out << std::setiosflags(std::ios_base::fixed);
+    
+    out << "{\"traceEvents\":[";
+    
+    bool comma = false;
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        const std::vector<profile_event>& events = threads[i].second;
+        
+        for (size_t j = 0; j < events.size(); j++)
+        {
+            out << (comma ? ",\n" : "\n");
+            comma = true;
+            
+            out << "{\"name\":\"" << profile_span_names[events[j].type] << "\",\"cat\":\"soar\",\"ph\":\"X\""
+                << ",\"ts\":" << (events[j].start - first) / raw_per_usec
+                << ",\"dur\":" << (events[j].end - events[j].start) / raw_per_usec
+                << ",\"pid\":1,\"tid\":" << threads[i].first << "}";
+        }
+    }
+    
+    out << "\n]}\n";
+    
+    out.flags(oldFlags);
+    out.precision(oldPrecision);
+}
+
+class collapsed_stack_visitor : public span_visitor
+{
+    public:
+        std::map<std::string, uint64_t> totals;
+        
+        void visit(const std::vector<uint16_t>& stack, const profile_event& event, uint64_t self)
+        {
+            std::string path;
+            for (size_t i = 0; i < stack.size(); i++)
+            {
+                path += profile_span_names[stack[i]];
+                path += ';';
+            }
+            path += profile_span_names[event.type];
+            
+            totals[path] += self;
+        }
+};
+
+void profiler_write_collapsed_stacks(std::ostream& out)
+{
+    std::vector< std::pair< int, std::vector<profile_event> > > threads;
+    copy_spans(&threads);
+    
+    collapsed_stack_visitor visitor;
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        walk_spans(threads[i].second, &visitor);
+    }
+    
+    // Self time in whole microseconds (stacks that round to nothing are left out)
+    double raw_per_usec = get_raw_time_per_usec();
+    
+    for (std::map<std::string, uint64_t>::iterator iter = visitor.totals.begin(); iter != visitor.totals.end(); iter++)
+    {
+        uint64_t usec = static_cast<uint64_t>(iter->second / raw_per_usec);
+        if (usec)
+        {
+            out << iter->first << " " << usec << "\n";
+        }
+    }
+}
+
+class summary_visitor : public span_visitor
+{
+    public:
+        uint64_t count[NUM_PROFILE_SPAN_TYPES];
+        uint64_t total[NUM_PROFILE_SPAN_TYPES];
+        uint64_t self[NUM_PROFILE_SPAN_TYPES];
+        
+        summary_visitor()
+        {
+            for (int i = 0; i < NUM_PROFILE_SPAN_TYPES; i++)
+            {
+                count[i] = total[i] = self[i] = 0;
+            }
+        }
+        
+        void visit(const std::vector<uint16_t>& stack, const profile_event& event, uint64_t self_time)
+        {
+            count[event.type]++;
+            self[event.type] += self_time;
+            
+            // A span inside another of the same type (e.g. recursive chunking) is already in the outer one's total
+            if (std::find(stack.begin(), stack.end(), event.type) == stack.end())
+            {
+                total[event.type] += event.end - event.start;
+            }
+        }
+};
+
+void profiler_write_summary(std::ostream& out)
+{
+    std::vector< std::pair< int, std::vector<profile_event> > > threads;
+    copy_spans(&threads);
+    
+    summary_visitor visitor;
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        walk_spans(threads[i].second, &visitor);
+    }
+    
+    double raw_per_usec = get_raw_time_per_usec();
+    
+    std::ios_base::fmtflags oldFlags = out.flags();
+    std::streamsize oldPrecision = out.precision(3);
+    out << std::setiosflags(std::ios_base::fixed);
+    
+    out << "Span             Count       Total (sec) Self (sec)\n";
+    out << "---------------- ----------- ----------- -----------\n";
+    
+    for (int i = 0; i < NUM_PROFILE_SPAN_TYPES; i++)
+    {
+        if (!visitor.count[i])
+        {
+            continue;
+        }
+        
+        out << std::setw(16) << std::left << profile_span_names[i] << std::right << " ";
+        out << std::setw(11) << visitor.count[i] << " ";
+        out << std::setw(11) << visitor.total[i] / raw_per_usec / 1000000.0 << " ";
+        out << std::setw(11) << visitor.self[i] / raw_per_usec / 1000000.0 << "\n";
+    }
+    
+    out.flags(oldFlags);
+    out.precision(oldPrecision);
+}
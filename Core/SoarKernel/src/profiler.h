@@ -0,0 +1,118 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/* -- profiler.h
+ *
+ *    A span profiler for the kernel, meant to be cheap enough to leave on.
+ *
+ *    Code wraps the work it wants to see in a profile_span, which records
+ *    the time it was created and destroyed (and how deeply it was nested)
+ *    in a ring buffer belonging to the current thread.  Nothing is shared
+ *    between threads while recording, so agents stepped on several run
+ *    threads don't contend, and when the buffer fills the oldest spans are
+ *    overwritten.  When the profiler is off a span is a single test of
+ *    profiler_enabled.
+ *
+ *    The spans can be written out in Chrome's trace event format (load the
+ *    file in chrome://tracing or Perfetto) or as collapsed stacks, one line
+ *    per stack with its self time, which is what flamegraph.pl and
+ *    speedscope read.  See the profile command.
+ *
+ *    Spans are kept for whole phases and for the parts of them that usually
+ *    matter: rete matching (working memory changes), firing and retracting
+ *    productions, chunking, epmem and smem, the input and output functions,
+ *    and the SML commands handled by the kernel.
+ */
+ 
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "portability.h"
+
+#include <iosfwd>
+
+enum profile_span_type
+{
+    // Must stay in the same order as top_level_phase
+    PROFILE_INPUT_PHASE = 0,
+    PROFILE_PROPOSE_PHASE,
+    PROFILE_DECISION_PHASE,
+    PROFILE_APPLY_PHASE,
+    PROFILE_OUTPUT_PHASE,
+    PROFILE_PREFERENCE_PHASE,
+    PROFILE_WM_PHASE,
+    
+    PROFILE_MATCH,
+    PROFILE_FIRING,
+    PROFILE_CHUNKING,
+    PROFILE_EPMEM,
+    PROFILE_SMEM,
+    PROFILE_INPUT_FUNCTION,
+    PROFILE_OUTPUT_FUNCTION,
+    PROFILE_SML_COMMAND,
+    
+    NUM_PROFILE_SPAN_TYPES
+};
+
+extern const char* profile_span_names[NUM_PROFILE_SPAN_TYPES];
+
+// True while the profiler is recording (only change it through profiler_start/stop)
+extern volatile bool profiler_enabled;
+
+extern void profiler_start();
+extern void profiler_stop();
+
+// Throws away everything recorded so far
+extern void profiler_clear();
+
+// How many spans are held (over all threads) and how many were overwritten before they could be written out
+extern void profiler_get_counts(uint64_t* pSpans, uint64_t* pOverwritten);
+
+// Writers for what's been recorded.  Best called with the profiler stopped,
+// otherwise spans recorded while writing may or may not be included.
+extern void profiler_write_chrome_trace(std::ostream& out);
+extern void profiler_write_collapsed_stacks(std::ostream& out);
+
+// A table of the total and self time spent in each type of span
+extern void profiler_write_summary(std::ostream& out);
+
+// Called by profile_span; records a span that has just ended
+extern uint16_t profiler_begin_span();
+extern void profiler_end_span(profile_span_type type, uint16_t depth, uint64_t start);
+
+class profile_span
+{
+    public:
+        profile_span(profile_span_type type)
+        {
+            m_active = profiler_enabled;
+            
+            if (m_active)
+            {
+                m_type = type;
+                m_depth = profiler_begin_span();
+                m_start = get_raw_time();
+            }
+        }
+        
+        ~profile_span()
+        {
+            if (m_active)
+            {
+                profiler_end_span(m_type, m_depth, m_start);
+            }
+        }
+        
+    private:
+        bool                m_active;
+        profile_span_type   m_type;
+        uint16_t            m_depth;
+        uint64_t            m_start;
+        
+        profile_span(const profile_span&);
+        profile_span& operator=(const profile_span&);
+};
+
+#endif // PROFILER_H
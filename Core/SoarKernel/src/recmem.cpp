@@ -52,6 +52,7 @@
 #include "consistency.h"
 #include "misc.h"
 #include "soar_module.h"
+#include "profiler.h"
 
 #include "assert.h"
 #include <string> // SBW 8/4/08
@@ -76,7 +77,7 @@ typedef std::list< condition* > cond_mpool_list;
  the external kernel interface but for now using a
  couple of global STL lists to get this information
  from the rhs function to this preference adding code)*/
-wme* glbDeepCopyWMEs = NULL;
+THREAD_LOCAL wme* glbDeepCopyWMEs = NULL;
 
 
 /* --------------------------------------------------------------------------
@@ -765,6 +766,7 @@ void create_instantiation(agent* thisAgent, production* prod,
     bool trace_it;
     int64_t index;
     Symbol** cell;
+    uint64_t firing_start = thisAgent->production_cost_enabled ? get_raw_time() : 0;
     
 #ifdef BUG_139_WORKAROUND
     /* New waterfall model: this is now checked for before we call this function */
@@ -960,6 +962,12 @@ void create_instantiation(agent* thisAgent, production* prod,
     
     thisAgent->production_being_fired = NIL;
     
+    /* --- charge the production for building its instantiation and running its RHS --- */
+    if (firing_start)
+    {
+        prod->firing_time += get_raw_time() - firing_start;
+    }
+    
     /* --- build chunks/justifications if necessary --- */
     chunk_instantiation(thisAgent, inst, false,
                         &(thisAgent->newly_created_instantiations));
@@ -1529,6 +1537,8 @@ void assert_new_preferences(agent* thisAgent, pref_buffer_list& bufdeallo)
 
 void do_preference_phase(agent* thisAgent)
 {
+    profile_span span(PROFILE_FIRING);
+    
     instantiation* inst = 0;
     
     /* AGR 617/634:  These are 2 bug reports that report the same problem,
@@ -26,8 +26,9 @@
 /* TEMPORARY HACK (Ideally this should be doable through
    the external kernel interface but for now using a
    couple of global STL lists to get this information
-   from the rhs function to this prefference adding code)*/
-extern wme* glbDeepCopyWMEs;
+   from the rhs function to this prefference adding code)
+   Per thread, as agents can be run on several threads at once. */
+extern THREAD_LOCAL wme* glbDeepCopyWMEs;
 
 typedef signed short goal_stack_level;
 typedef struct agent_struct agent;
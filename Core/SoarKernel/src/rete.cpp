@@ -114,6 +114,7 @@
 #include "assert.h"
 
 #include <sstream>
+#include <map>
 
 /* ----------- handle inter-switch dependencies ----------- */
 
@@ -435,6 +436,8 @@ typedef struct rete_node_struct
 #ifdef SHARING_FACTORS
     uint64_t sharing_factor;
 #endif
+
+    struct rete_node_cost_struct* cost;    /* NIL unless production costs were on when it did something */
     
     struct rete_node_struct* parent;       /* points to parent node */
     struct rete_node_struct* first_child;  /* used for dll of all children, */
@@ -950,7 +953,7 @@ inline uint64_t real_sharing_factor(rete_node* node)
 /*#define token_added(node) { \
   thisAgent->token_additions++; \
   thisAgent->token_additions_without_sharing += real_sharing_factor(node);}*/
-inline void token_added(rete_node* node)
+inline void token_sharing_stats(agent* thisAgent, rete_node* node)
 {
     thisAgent->token_additions++;
     thisAgent->token_additions_without_sharing += real_sharing_factor(node);
@@ -958,28 +961,104 @@ inline void token_added(rete_node* node)
 
 #else
 
-#define token_added(node) {}
+#define token_sharing_stats(thisAgent,node) {}
 
 #endif
 
+/* ----------------------------------------------------------------------
+
+             Structures and Declarations:  Production Costs
+             
+   While thisAgent->production_cost_enabled is set, every beta node
+   counts the work done there: tokens created, left and right
+   activations, and the variable tests evaluated when joining.  The
+   counts are kept in a rete_node_cost, allocated the first time the
+   node does anything, so nodes cost one pointer each when this is off.
+   
+   The counts belong to nodes, not productions, since nodes are shared.
+   Get_production_costs() splits each node's counts evenly among the
+   productions using it (the same sharing that
+   adjust_sharing_factors_from_here_to_top() tracks, but counted when
+   asked for rather than kept up to date).
+---------------------------------------------------------------------- */
+
+typedef struct rete_node_cost_struct
+{
+    uint64_t tokens;
+    uint64_t left_activations;
+    uint64_t right_activations;
+    uint64_t tests;
+} rete_node_cost;
+
+inline rete_node_cost* get_rete_node_cost(agent* thisAgent, rete_node* node)
+{
+    if (!node->cost)
+    {
+        allocate_with_pool(thisAgent, &thisAgent->rete_node_cost_pool, &node->cost);
+        node->cost->tokens = 0;
+        node->cost->left_activations = 0;
+        node->cost->right_activations = 0;
+        node->cost->tests = 0;
+    }
+    return node->cost;
+}
+
+/* Adds the counts on "from" to those on "to", for when nodes are merged */
+void transfer_rete_node_cost(agent* thisAgent, rete_node* from, rete_node* to)
+{
+    if (!from->cost)
+    {
+        return;
+    }
+    
+    if (!to->cost)
+    {
+        to->cost = from->cost;
+    }
+    else
+    {
+        to->cost->tokens += from->cost->tokens;
+        to->cost->left_activations += from->cost->left_activations;
+        to->cost->right_activations += from->cost->right_activations;
+        to->cost->tests += from->cost->tests;
+        free_with_pool(&thisAgent->rete_node_cost_pool, from->cost);
+    }
+    from->cost = NIL;
+}
+
+inline void token_added(agent* thisAgent, rete_node* node)
+{
+    token_sharing_stats(thisAgent, node);
+    if (thisAgent->production_cost_enabled)
+    {
+        get_rete_node_cost(thisAgent, node)->tokens++;
+    }
+}
+
 /* --- Invoked on every right activation; add=true means right addition --- */
 /* NOT invoked on removals unless DO_ACTIVATION_STATS_ON_REMOVALS is set */
 /*#define right_node_activation(node,add) { \
   null_activation_stats_for_right_activation(node); }*/
-inline void right_node_activation(rete_node* node, bool/*add*/)
+inline void right_node_activation(agent* thisAgent, rete_node* node, bool/*add*/)
 {
-    (void)node;
     null_activation_stats_for_right_activation(node);
+    if (thisAgent->production_cost_enabled)
+    {
+        get_rete_node_cost(thisAgent, node)->right_activations++;
+    }
 }
 
 /* --- Invoked on every left activation; add=true means left addition --- */
 /* NOT invoked on removals unless DO_ACTIVATION_STATS_ON_REMOVALS is set */
 /*#define left_node_activation(node,add) { \
   null_activation_stats_for_left_activation(node); }*/
-inline void left_node_activation(rete_node* node, bool/*add*/)
+inline void left_node_activation(agent* thisAgent, rete_node* node, bool/*add*/)
 {
-    (void)node;
     null_activation_stats_for_left_activation(node);
+    if (thisAgent->production_cost_enabled)
+    {
+        get_rete_node_cost(thisAgent, node)->left_activations++;
+    }
 }
 
 /* --- The following two macros are used when creating/destroying nodes --- */
@@ -991,6 +1070,7 @@ inline void left_node_activation(rete_node* node, bool/*add*/)
 inline void init_new_rete_node_with_type(agent* thisAgent, rete_node* node, byte type)
 {
     (node)->node_type = (type);
+    (node)->cost = NIL;
     thisAgent->rete_node_counts[(type)]++;
     init_sharing_stats_for_new_node(node);
 }
@@ -1002,6 +1082,11 @@ inline void update_stats_for_destroying_node(agent* thisAgent, rete_node* node)
 {
     set_sharing_factor(node, 0);
     thisAgent->rete_node_counts[(node)->node_type]--;
+    if ((node)->cost)
+    {
+        free_with_pool(&thisAgent->rete_node_cost_pool, (node)->cost);
+        (node)->cost = NIL;
+    }
 }
 
 
@@ -1954,7 +2039,7 @@ void remove_wme_from_rete(agent* thisAgent, wme* w)
         for (node = am->beta_nodes; node != NIL; node = next)
         {
             next = node->b.posneg.next_from_alpha_mem;
-            right_node_activation(node, false);
+            right_node_activation(thisAgent, node, false);
         }
 #endif
         
@@ -2340,6 +2425,7 @@ rete_node* split_mp_node(agent* thisAgent, rete_node* mp_node)
     mp_copy = *mp_node;
     parent = mp_node->parent;
     remove_node_from_parents_list_of_children(mp_node);
+    mp_node->cost = NIL;   /* the new Pos node takes over its costs */
     update_stats_for_destroying_node(thisAgent, mp_node);   /* clean up rete stats stuff */
     
     /* --- the old MP node will get transmogrified into the new Pos node --- */
@@ -2371,6 +2457,7 @@ rete_node* split_mp_node(agent* thisAgent, rete_node* mp_node)
     pos_node->first_child = mp_copy.first_child;
     pos_node->next_sibling = NIL;
     pos_node->b.posneg = mp_copy.b.posneg;
+    pos_node->cost = mp_copy.cost;
     relink_to_left_mem(pos_node);    /* for now, but might undo this below */
     set_sharing_factor(pos_node, mp_copy.sharing_factor);
     
@@ -2421,6 +2508,7 @@ rete_node* merge_into_mp_node(agent* thisAgent, rete_node* mem_node)
     
     /* --- save a copy of the Pos data, then kill the Pos node --- */
     pos_copy = *pos_node;
+    pos_node->cost = NIL;   /* the new MP node takes over its costs */
     update_stats_for_destroying_node(thisAgent, pos_node);   /* clean up rete stats stuff */
     
     /* --- the old Pos node gets transmogrified into the new MP node --- */
@@ -2428,6 +2516,7 @@ rete_node* merge_into_mp_node(agent* thisAgent, rete_node* mem_node)
     init_new_rete_node_with_type(thisAgent, mp_node, node_type);
     set_sharing_factor(mp_node, pos_copy.sharing_factor);
     mp_node->b.posneg = pos_copy.b.posneg;
+    mp_node->cost = pos_copy.cost;
     
     /* --- transfer the Mem node's tokens to the MP node --- */
     mp_node->a.np.tokens = mem_node->a.np.tokens;
@@ -2446,6 +2535,7 @@ rete_node* merge_into_mp_node(agent* thisAgent, rete_node* mem_node)
     mp_node->first_child = pos_copy.first_child;
     
     remove_node_from_parents_list_of_children(mem_node);
+    transfer_rete_node_cost(thisAgent, mem_node, mp_node);
     update_stats_for_destroying_node(thisAgent, mem_node);   /* clean up rete stats stuff */
     free_with_pool(&thisAgent->rete_node_pool, mem_node);
     
@@ -5308,9 +5398,13 @@ bool((*(rete_test_routines[256]))
 /*#define match_left_and_right(rete_test,left,w) \
   ( (*(rete_test_routines[(rete_test)->type])) \
     ((rete_test),(left),(w)) )*/
-inline bool match_left_and_right(agent* thisAgent, rete_test* _rete_test,
+inline bool match_left_and_right(agent* thisAgent, rete_node* node, rete_test* _rete_test,
                                  token* left, wme* w)
 {
+    if (thisAgent->production_cost_enabled)
+    {
+        get_rete_node_cost(thisAgent, node)->tests++;
+    }
     return ((*(rete_test_routines[(_rete_test)->type])) \
             (thisAgent, (_rete_test), (left), (w)));
 }
@@ -5698,7 +5792,7 @@ void beta_memory_node_left_addition(agent* thisAgent, rete_node* node,
     token* New;
     
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
     
     {
         int levels_up;
@@ -5722,7 +5816,7 @@ void beta_memory_node_left_addition(agent* thisAgent, rete_node* node,
     hv = node->node_id ^ referent->hash_id;
     
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     allocate_with_pool(thisAgent, &thisAgent->token_pool, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5746,12 +5840,12 @@ void unhashed_beta_memory_node_left_addition(agent* thisAgent,
     token* New;
     
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
     
     hv = node->node_id;
     
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     allocate_with_pool(thisAgent, &thisAgent->token_pool, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5778,7 +5872,7 @@ void positive_node_left_addition(agent* thisAgent,
     rete_node* child;
     
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
     
     am = node->b.posneg.alpha_mem_;
     
@@ -5808,7 +5902,7 @@ void positive_node_left_addition(agent* thisAgent,
         }
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
+            if (! match_left_and_right(thisAgent, node, rt, New, rm->w))
             {
                 failed_a_test = true;
                 break;
@@ -5834,7 +5928,7 @@ void unhashed_positive_node_left_addition(agent* thisAgent, rete_node* node, tok
     rete_node* child;
     
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
     
     if (node_is_right_unlinked(node))
     {
@@ -5854,7 +5948,7 @@ void unhashed_positive_node_left_addition(agent* thisAgent, rete_node* node, tok
         /* --- does rm->w match new? --- */
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
+            if (! match_left_and_right(thisAgent, node, rt, New, rm->w))
             {
                 failed_a_test = true;
                 break;
@@ -5885,7 +5979,7 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
     bool failed_a_test;
     
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
     
     {
         int levels_up;
@@ -5909,7 +6003,7 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
     hv = node->node_id ^ referent->hash_id;
     
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     allocate_with_pool(thisAgent, &thisAgent->token_pool, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5949,7 +6043,7 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
         }
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
+            if (! match_left_and_right(thisAgent, node, rt, New, rm->w))
             {
                 failed_a_test = true;
                 break;
@@ -5979,12 +6073,12 @@ void unhashed_mp_node_left_addition(agent* thisAgent, rete_node* node,
     bool failed_a_test;
     
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
     
     hv = node->node_id;
     
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     allocate_with_pool(thisAgent, &thisAgent->token_pool, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -6013,7 +6107,7 @@ void unhashed_mp_node_left_addition(agent* thisAgent, rete_node* node,
         /* --- does rm->w match new? --- */
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
+            if (! match_left_and_right(thisAgent, node, rt, New, rm->w))
             {
                 failed_a_test = true;
                 break;
@@ -6041,7 +6135,7 @@ void positive_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
     rete_node* child;
     
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
     
     if (node_is_left_unlinked(node))
     {
@@ -6070,7 +6164,7 @@ void positive_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
         }
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, tok, w))
+            if (! match_left_and_right(thisAgent, node, rt, tok, w))
             {
                 failed_a_test = true;
                 break;
@@ -6097,7 +6191,7 @@ void unhashed_positive_node_right_addition(agent* thisAgent, rete_node* node, wm
     rete_node* child;
     
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
     
     if (node_is_left_unlinked(node))
     {
@@ -6121,7 +6215,7 @@ void unhashed_positive_node_right_addition(agent* thisAgent, rete_node* node, wm
         /* --- does tok match w? --- */
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, tok, w))
+            if (! match_left_and_right(thisAgent, node, rt, tok, w))
             {
                 failed_a_test = true;
                 break;
@@ -6149,7 +6243,7 @@ void mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
     rete_node* child;
     
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
     
     if (mp_bnode_is_left_unlinked(node))
     {
@@ -6178,7 +6272,7 @@ void mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
         }
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, tok, w))
+            if (! match_left_and_right(thisAgent, node, rt, tok, w))
             {
                 failed_a_test = true;
                 break;
@@ -6205,7 +6299,7 @@ void unhashed_mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
     rete_node* child;
     
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
     
     if (mp_bnode_is_left_unlinked(node))
     {
@@ -6229,7 +6323,7 @@ void unhashed_mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
         /* --- does tok match w? --- */
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, tok, w))
+            if (! match_left_and_right(thisAgent, node, rt, tok, w))
             {
                 failed_a_test = true;
                 break;
@@ -6266,7 +6360,7 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
     token* New;
     
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
     
     if (node_is_right_unlinked(node))
     {
@@ -6295,7 +6389,7 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
     hv = node->node_id ^ referent->hash_id;
     
     /* --- build new token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     allocate_with_pool(thisAgent, &thisAgent->token_pool, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -6318,7 +6412,7 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
         }
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
+            if (! match_left_and_right(thisAgent, node, rt, New, rm->w))
             {
                 failed_a_test = true;
                 break;
@@ -6363,7 +6457,7 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
     token* New;
     
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
     
     if (node_is_right_unlinked(node))
     {
@@ -6373,7 +6467,7 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
     hv = node->node_id;
     
     /* --- build new token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     allocate_with_pool(thisAgent, &thisAgent->token_pool, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -6386,7 +6480,7 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
         /* --- does rm->w match new? --- */
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
+            if (! match_left_and_right(thisAgent, node, rt, New, rm->w))
             {
                 failed_a_test = true;
                 break;
@@ -6429,7 +6523,7 @@ void negative_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
     bool failed_a_test;
     
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
     
     referent = w->id;
     hv = node->node_id ^ referent->hash_id;
@@ -6447,7 +6541,7 @@ void negative_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
         }
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, tok, w))
+            if (! match_left_and_right(thisAgent, node, rt, tok, w))
             {
                 failed_a_test = true;
                 break;
@@ -6485,7 +6579,7 @@ void unhashed_negative_node_right_addition(agent* thisAgent, rete_node* node, wm
     bool failed_a_test;
     
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
     
     hv = node->node_id;
     
@@ -6498,7 +6592,7 @@ void unhashed_negative_node_right_addition(agent* thisAgent, rete_node* node, wm
         /* --- does tok match w? --- */
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, tok, w))
+            if (! match_left_and_right(thisAgent, node, rt, tok, w))
             {
                 failed_a_test = true;
                 break;
@@ -6544,7 +6638,7 @@ void cn_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
     rete_node* child;
     
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
     
     hv = node->node_id ^ cast_and_possibly_truncate<uint32_t>(tok) ^ cast_and_possibly_truncate<uint32_t>(w);
     
@@ -6558,7 +6652,7 @@ void cn_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
         }
         
     /* --- build left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     allocate_with_pool(thisAgent, &thisAgent->token_pool, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -6581,12 +6675,12 @@ void cn_partner_node_left_addition(agent* thisAgent, rete_node* node,
     token* left, *negrm_tok;
     
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
     
     partner = node->b.cn.partner;
     
     /* --- build new negrm token --- */
-    token_added(node);
+    token_added(thisAgent, node);
     allocate_with_pool(thisAgent, &thisAgent->token_pool, &negrm_tok);
     new_left_token(negrm_tok, node, tok, w);
     
@@ -6610,7 +6704,7 @@ void cn_partner_node_left_addition(agent* thisAgent, rete_node* node,
     /* --- if not found, create a new left token --- */
     if (!left)
     {
-        token_added(partner);
+        token_added(thisAgent, partner);
         allocate_with_pool(thisAgent, &thisAgent->token_pool, &left);
         new_left_token(left, partner, tok, w);
         insert_token_into_left_ht(thisAgent, left, hv);
@@ -6687,10 +6781,10 @@ void p_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w)
     /* RCHONG: end 10.11 */
     
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
     
     /* --- build new left token (used only for tree-based remove) --- */
-    token_added(node);
+    token_added(thisAgent, node);
     allocate_with_pool(thisAgent, &thisAgent->token_pool, &New);
     new_left_token(New, node, tok, w);
     
@@ -7382,7 +7476,7 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
         
         /* --- cleanup stuff common to all types of nodes --- */
         node = tok->node;
-        left_node_activation(node, false);
+        left_node_activation(thisAgent, node, false);
         fast_remove_from_dll(node->a.np.tokens, tok, token, next_of_node,
                              prev_of_node);
         fast_remove_from_dll(tok->parent->first_child, tok, token,
@@ -7442,7 +7536,7 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
             for (child = node->b.mem.first_linked_child; child != NIL; child = next)
             {
                 next = child->a.pos.next_from_beta_mem;
-                left_node_activation(child, false);
+                left_node_activation(thisAgent, child, false);
             }
 #endif
             /* --- for right unlinking, then if the beta memory just went to
@@ -8717,6 +8811,7 @@ void reteload_node_and_children(agent* thisAgent, rete_node* parent, FILE* f)
             allocate_with_pool(thisAgent, &thisAgent->production_pool, &prod);
             prod->reference_count = 1;
             prod->firing_count = 0;
+            prod->firing_time = 0;
             prod->trace_firings = false;
             prod->instantiations = NIL;
             prod->filename = NIL;
@@ -8990,6 +9085,140 @@ uint64_t count_rete_tokens_for_production(agent* thisAgent, production* prod)
     return count;
 }
 
+/* ----------------------------------------------------------------------
+                          Production Costs
+                          
+   Get_production_costs() fills in a production_cost for each production
+   in the rete, giving it its share of the counts on every node between
+   its p-node and the top of the net (see the comment with
+   rete_node_cost above).  A node used by n productions gives each of
+   them 1/n of its counts, so summing over every production gives the
+   total work done in the rete.  Reset_production_costs() zeroes all the
+   counts, along with the time spent firing each production.
+---------------------------------------------------------------------- */
+
+/* Calls f on "node" and every node above it, including the subnetworks of NCCs */
+template <class F>
+void for_each_node_from_here_to_top(rete_node* node, F& f)
+{
+    while (node != NIL)
+    {
+        f(node);
+        if (node->node_type == CN_BNODE)
+        {
+            node = node->b.cn.partner;
+        }
+        else
+        {
+            node = node->parent;
+        }
+    }
+}
+
+struct count_node_users
+{
+    std::map<rete_node*, uint64_t> users;
+    
+    void operator()(rete_node* node)
+    {
+        if (node->cost)
+        {
+            users[node]++;
+        }
+    }
+};
+
+struct add_node_shares
+{
+    std::map<rete_node*, uint64_t>* users;
+    production_cost* result;
+    
+    void operator()(rete_node* node)
+    {
+        if (node->cost)
+        {
+            double share = 1.0 / (*users)[node];
+            result->tokens += node->cost->tokens * share;
+            result->left_activations += node->cost->left_activations * share;
+            result->right_activations += node->cost->right_activations * share;
+            result->tests += node->cost->tests * share;
+        }
+    }
+};
+
+struct reset_node_costs
+{
+    void operator()(rete_node* node)
+    {
+        if (node->cost)
+        {
+            node->cost->tokens = 0;
+            node->cost->left_activations = 0;
+            node->cost->right_activations = 0;
+            node->cost->tests = 0;
+        }
+    }
+};
+
+void get_production_costs(agent* thisAgent, std::vector<production_cost>* costs)
+{
+    count_node_users counter;
+    
+    for (int i = 0; i < NUM_PRODUCTION_TYPES; i++)
+    {
+        for (production* prod = thisAgent->all_productions_of_type[i]; prod != NIL; prod = prod->next)
+        {
+            if (prod->p_node)
+            {
+                for_each_node_from_here_to_top(prod->p_node, counter);
+            }
+        }
+    }
+    
+    add_node_shares adder;
+    adder.users = &counter.users;
+    
+    for (int i = 0; i < NUM_PRODUCTION_TYPES; i++)
+    {
+        for (production* prod = thisAgent->all_productions_of_type[i]; prod != NIL; prod = prod->next)
+        {
+            if (!prod->p_node)
+            {
+                continue;
+            }
+            
+            production_cost cost;
+            cost.prod = prod;
+            cost.tokens = 0;
+            cost.left_activations = 0;
+            cost.right_activations = 0;
+            cost.tests = 0;
+            
+            adder.result = &cost;
+            for_each_node_from_here_to_top(prod->p_node, adder);
+            
+            costs->push_back(cost);
+        }
+    }
+}
+
+void reset_production_costs(agent* thisAgent)
+{
+    reset_node_costs resetter;
+    
+    for (int i = 0; i < NUM_PRODUCTION_TYPES; i++)
+    {
+        for (production* prod = thisAgent->all_productions_of_type[i]; prod != NIL; prod = prod->next)
+        {
+            prod->firing_time = 0;
+            if (prod->p_node)
+            {
+                for_each_node_from_here_to_top(prod->p_node, resetter);
+            }
+        }
+    }
+}
+
 /* --------------------------------------------------------------------
                           Rete Statistics
 
@@ -10524,6 +10753,8 @@ void init_rete(agent* thisAgent)
                      "rete node");
     init_memory_pool(thisAgent, &thisAgent->node_varnames_pool, sizeof(node_varnames),
                      "node varnames");
+    init_memory_pool(thisAgent, &thisAgent->rete_node_cost_pool, sizeof(rete_node_cost),
+                     "rete node cost");
     init_memory_pool(thisAgent, &thisAgent->token_pool, sizeof(token), "token");
     init_memory_pool(thisAgent, &thisAgent->right_mem_pool, sizeof(right_mem),
                      "right mem");
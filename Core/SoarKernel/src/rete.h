@@ -43,6 +43,10 @@
    Count_rete_tokens_for_production() returns a count of the number of
    tokens currently in use for the given production.
 
+   Get_production_costs() reports how much of the work done in the rete
+   (while production_cost_enabled is set on the agent) each production is
+   responsible for; reset_production_costs() starts the counts again.
+   
    Print_partial_match_information(), print_match_set(), and
    print_rete_statistics() do printouts for various interface routines.
 
@@ -55,6 +59,7 @@
 #define RETE_H
 
 #include <stdio.h>  // Needed for FILE token below
+#include <vector>
 
 struct not_struct;
 
@@ -142,6 +147,20 @@ extern void xml_partial_match_information(agent* thisAgent, rete_node* p_node, w
 
 extern void print_match_set(agent* thisAgent, wme_trace_type wtt, ms_trace_type  mst);
 extern void xml_match_set(agent* thisAgent, wme_trace_type wtt, ms_trace_type  mst);
+
+/* A production's share of the work done in the rete while production costs were on */
+typedef struct production_cost_struct
+{
+    production* prod;
+    double tokens;
+    double left_activations;
+    double right_activations;
+    double tests;
+} production_cost;
+
+extern void get_production_costs(agent* thisAgent, std::vector<production_cost>* costs);
+extern void reset_production_costs(agent* thisAgent);
+
 extern void get_all_node_count_stats(agent* thisAgent);
 extern int get_node_count_statistic(agent* thisAgent, char* node_type_name,
                                     char* column_name,
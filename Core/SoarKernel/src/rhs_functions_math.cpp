@@ -1283,9 +1283,9 @@ Symbol* rand_float_rhs_function_code(agent* thisAgent, list* args, void* /*user_
     
     if (n > 0)
     {
-        return make_float_constant(thisAgent, SoarRand(n));
+        return make_float_constant(thisAgent, SoarRand(thisAgent, n));
     }
-    return make_float_constant(thisAgent, SoarRand());
+    return make_float_constant(thisAgent, SoarRand(thisAgent));
 }
 
 /* --------------------------------------------------------------------
@@ -1327,9 +1327,9 @@ Symbol* rand_int_rhs_function_code(agent* thisAgent, list* args, void* /*user_da
     
     if (n > 0)
     {
-        return make_int_constant(thisAgent, static_cast<int64_t>(SoarRandInt(static_cast<uint32_t>(n))));
+        return make_int_constant(thisAgent, static_cast<int64_t>(SoarRandInt(thisAgent, static_cast<uint32_t>(n))));
     }
-    return make_int_constant(thisAgent, SoarRandInt());
+    return make_int_constant(thisAgent, SoarRandInt(thisAgent));
 }
 
 inline double _dice_zero_tolerance(double in)
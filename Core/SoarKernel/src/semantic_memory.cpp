@@ -27,6 +27,10 @@
 #include "decide.h"
 #include "test.h"
 #include "tempmem.h"
+#include "thread_Lock.h"
+#include "profiler.h"
+#include "deadline.h"
+#include "tokenizer.h"
 
 #include <list>
 #include <map>
@@ -163,6 +167,30 @@ smem_param_container::smem_param_container(agent* new_agent): soar_module::param
     // mirroring
     mirroring = new soar_module::boolean_param("mirroring", off, new smem_db_predicate< boolean >(thisAgent));
     add(mirroring);
+    
+    // native_store
+    native_store = new soar_module::boolean_param("native-store", on, new smem_db_predicate< boolean >(thisAgent));
+    add(native_store);
+    
+    // shared
+    shared = new soar_module::boolean_param("shared", off, new smem_db_predicate< boolean >(thisAgent));
+    add(shared);
+    
+    // spreading
+    spreading = new soar_module::boolean_param("spreading", off, new smem_db_predicate< boolean >(thisAgent));
+    add(spreading);
+    
+    // spreading_depth
+    spreading_depth = new soar_module::integer_param("spreading-depth", 2, new soar_module::gt_predicate<int64_t>(1, true), new smem_db_predicate<int64_t>(thisAgent));
+    add(spreading_depth);
+    
+    // spreading_limit
+    spreading_limit = new soar_module::integer_param("spreading-limit", 100, new soar_module::gt_predicate<int64_t>(1, true), new smem_db_predicate<int64_t>(thisAgent));
+    add(spreading_limit);
+    
+    // spreading_budget
+    spreading_budget = new soar_module::integer_param("spreading-budget", 10000, new soar_module::gt_predicate<int64_t>(1, true), new soar_module::f_predicate<int64_t>());
+    add(spreading_budget);
 }
 
 //
@@ -390,6 +418,9 @@ smem_timer_container::smem_timer_container(agent* new_agent): soar_module::timer
     
     act = new smem_timer("three_activation", thisAgent, soar_module::timer::three);
     add(act);
+    
+    spread = new smem_timer("three_spreading", thisAgent, soar_module::timer::three);
+    add(spread);
 }
 
 //
@@ -471,6 +502,36 @@ void smem_statement_container::create_indices()
     add_structure("CREATE UNIQUE INDEX smem_ct_lti_attr_val ON smem_wmes_lti_frequency (attribute_s_id, value_lti_id)");
 }
 
+// the retrieval indices lead with the attribute and are only needed
+// to walk candidates, so a bulk import can build them afterwards
+void smem_statement_container::drop_retrieval_indices(agent* new_agent)
+{
+    new_agent->smem_db->sql_execute("DROP INDEX IF EXISTS smem_augmentations_attr_val_lti_cycle");
+    new_agent->smem_db->sql_execute("DROP INDEX IF EXISTS smem_augmentations_attr_cycle");
+}
+
+void smem_statement_container::create_retrieval_indices(agent* new_agent)
+{
+    new_agent->smem_db->sql_execute("CREATE INDEX IF NOT EXISTS smem_augmentations_attr_val_lti_cycle ON smem_augmentations (attribute_s_id, value_constant_s_id, value_lti_id, activation_value)");
+    new_agent->smem_db->sql_execute("CREATE INDEX IF NOT EXISTS smem_augmentations_attr_cycle ON smem_augmentations (attribute_s_id, activation_value)");
+}
+
+// INSERT with SMEM_IMPORT_BATCH_ROWS value tuples
+static std::string smem_build_web_add_batch_sql()
+{
+    std::string sql("INSERT INTO smem_augmentations (lti_id, attribute_s_id, value_constant_s_id, value_lti_id, activation_value) VALUES (?,?,?,?,?)");
+    for (int i = 1; i < SMEM_IMPORT_BATCH_ROWS; i++)
+    {
+        sql.append(",(?,?,?,?,?)");
+    }
+    
+    return sql;
+}
+    
+// statements keep the pointer, and agents on several threads prepare
+// them, so it is built when the library is loaded rather than on first use
+static const std::string smem_web_add_batch_sql = smem_build_web_add_batch_sql();
+
 void smem_statement_container::drop_tables(agent* new_agent)
 {
     new_agent->smem_db->sql_execute("DROP TABLE IF EXISTS smem_persistent_variables");
@@ -587,10 +648,13 @@ smem_statement_container::smem_statement_container(agent* new_agent): soar_modul
     web_add = new soar_module::sqlite_statement(new_db, "INSERT INTO smem_augmentations (lti_id, attribute_s_id, value_constant_s_id, value_lti_id, activation_value) VALUES (?,?,?,?,?)");
     add(web_add);
     
+    web_add_batch = new soar_module::sqlite_statement(new_db, smem_web_add_batch_sql.c_str());
+    add(web_add_batch);
+    
     web_truncate = new soar_module::sqlite_statement(new_db, "DELETE FROM smem_augmentations WHERE lti_id=?");
     add(web_truncate);
     
-    web_expand = new soar_module::sqlite_statement(new_db, "SELECT tsh_a.symbol_type AS attr_type, tsh_a.s_id AS attr_hash, vcl.symbol_type AS value_type, vcl.s_id AS value_hash, vcl.soar_letter AS value_letter, vcl.soar_number AS value_num, vcl.value_lti_id AS value_lti FROM ((smem_augmentations w LEFT JOIN smem_symbols_type tsh_v ON w.value_constant_s_id=tsh_v.s_id) vc LEFT JOIN smem_lti AS lti ON vc.value_lti_id=lti.lti_id) vcl INNER JOIN smem_symbols_type tsh_a ON vcl.attribute_s_id=tsh_a.s_id WHERE lti_id=?");
+    web_expand = new soar_module::sqlite_statement(new_db, "SELECT tsh_a.symbol_type AS attr_type, tsh_a.s_id AS attr_hash, vcl.symbol_type AS value_type, vcl.s_id AS value_hash, vcl.soar_letter AS value_letter, vcl.soar_number AS value_num, vcl.value_lti_id AS value_lti FROM ((smem_augmentations w LEFT JOIN smem_symbols_type tsh_v ON w.value_constant_s_id=tsh_v.s_id) vc LEFT JOIN smem_lti AS lti ON vc.value_lti_id=lti.lti_id) vcl INNER JOIN smem_symbols_type tsh_a ON vcl.attribute_s_id=tsh_a.s_id WHERE w.lti_id=?"); // LOCALONLY
     add(web_expand);
     
     //
@@ -692,17 +756,803 @@ smem_statement_container::smem_statement_container(agent* new_agent): soar_modul
     
     //
     
-    vis_lti = new soar_module::sqlite_statement(new_db, "SELECT lti_id, soar_letter, soar_number, activation_value FROM smem_lti ORDER BY soar_letter ASC, soar_number ASC");
-    add(vis_lti);
+    vis_lti = new soar_module::sqlite_statement(new_db, "SELECT lti_id, soar_letter, soar_number, activation_value FROM smem_lti ORDER BY soar_letter ASC, soar_number ASC");
+    add(vis_lti);
+    
+    vis_lti_act = new soar_module::sqlite_statement(new_db, "SELECT activation_value FROM smem_lti WHERE lti_id=?");
+    add(vis_lti_act);
+    
+    vis_value_const = new soar_module::sqlite_statement(new_db, "SELECT lti_id, tsh1.symbol_type AS attr_type, tsh1.s_id AS attr_hash, tsh2.symbol_type AS val_type, tsh2.s_id AS val_hash FROM smem_augmentations w, smem_symbols_type tsh1, smem_symbols_type tsh2 WHERE (w.attribute_s_id=tsh1.s_id) AND (w.value_constant_s_id=tsh2.s_id)");
+    add(vis_value_const);
+    
+    vis_value_lti = new soar_module::sqlite_statement(new_db, "SELECT lti_id, tsh.symbol_type AS attr_type, tsh.s_id AS attr_hash, value_lti_id FROM smem_augmentations w, smem_symbols_type tsh WHERE (w.attribute_s_id=tsh.s_id) AND (value_lti_id<>" SMEM_AUGMENTATIONS_NULL_STR ")");
+    add(vis_value_lti);
+}
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Native Store Functions (smem::store)
+//
+// The native store mirrors the semantic store in
+// process memory.  It is populated from the database
+// when the database is initialized and kept current
+// by the storage functions, which continue to write
+// every change through to SQLite.
+//
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+smem_native_store::smem_native_store(): edge_version(0), edge_reset(0), log_edge_changes(false) {}
+
+smem_native_store::~smem_native_store()
+{
+    clear();
+}
+
+void smem_native_store::clear()
+{
+    for (std::vector<smem_store_symbol*>::iterator s = symbols.begin(); s != symbols.end(); s++)
+    {
+        delete(*s);
+    }
+    symbols.clear();
+    int_hashes.clear();
+    float_hashes.clear();
+    str_hashes.clear();
+    
+    for (std::vector<smem_store_lti*>::iterator l = ltis.begin(); l != ltis.end(); l++)
+    {
+        delete(*l);
+    }
+    ltis.clear();
+    lti_names.clear();
+    
+    attribute_frequency.clear();
+    constant_frequency.clear();
+    lti_frequency.clear();
+    
+    attr_index.clear();
+    const_index.clear();
+    lti_index.clear();
+    
+    variables.clear();
+    last_access_index.clear();
+    edge_changes.clear();
+    edge_version++;
+    edge_reset = edge_version;
+}
+
+// reads the entire semantic store from the database
+void smem_native_store::load(soar_module::sqlite_database* db)
+{
+    soar_module::sqlite_statement* q;
+    
+    clear();
+    
+    // symbols
+    {
+        q = new soar_module::sqlite_statement(db, "SELECT s_id, symbol_type FROM smem_symbols_type");
+        q->prepare();
+        while (q->execute() == soar_module::row)
+        {
+            add_symbol(static_cast<smem_hash_id>(q->column_int(0)), static_cast<byte>(q->column_int(1)));
+        }
+        delete q;
+        
+        q = new soar_module::sqlite_statement(db, "SELECT s_id, symbol_value FROM smem_symbols_integer");
+        q->prepare();
+        while (q->execute() == soar_module::row)
+        {
+            smem_hash_id hash = static_cast<smem_hash_id>(q->column_int(0));
+            add_symbol(hash, INT_CONSTANT_SYMBOL_TYPE)->int_value = q->column_int(1);
+            int_hashes[ q->column_int(1) ] = hash;
+        }
+        delete q;
+        
+        q = new soar_module::sqlite_statement(db, "SELECT s_id, symbol_value FROM smem_symbols_float");
+        q->prepare();
+        while (q->execute() == soar_module::row)
+        {
+            smem_hash_id hash = static_cast<smem_hash_id>(q->column_int(0));
+            add_symbol(hash, FLOAT_CONSTANT_SYMBOL_TYPE)->float_value = q->column_double(1);
+            float_hashes[ q->column_double(1) ] = hash;
+        }
+        delete q;
+        
+        q = new soar_module::sqlite_statement(db, "SELECT s_id, symbol_value FROM smem_symbols_string");
+        q->prepare();
+        while (q->execute() == soar_module::row)
+        {
+            smem_hash_id hash = static_cast<smem_hash_id>(q->column_int(0));
+            add_symbol(hash, STR_CONSTANT_SYMBOL_TYPE)->str_value.assign(q->column_text(1));
+            str_hashes[ std::string(q->column_text(1)) ] = hash;
+        }
+        delete q;
+    }
+    
+    // long-term identifiers
+    {
+        q = new soar_module::sqlite_statement(db, "SELECT lti_id, soar_letter, soar_number, total_augmentations, activation_value, activations_total, activations_last, activations_first FROM smem_lti");
+        q->prepare();
+        while (q->execute() == soar_module::row)
+        {
+            smem_store_lti* lti = add_lti(static_cast<smem_lti_id>(q->column_int(0)), static_cast<char>(q->column_int(1)), static_cast<uint64_t>(q->column_int(2)));
+            
+            lti->total_augmentations = static_cast<uint64_t>(q->column_int(3));
+            lti->act.activation_value = q->column_double(4);
+            lti->act.activations_total = static_cast<uint64_t>(q->column_int(5));
+            lti->act.activations_last = static_cast<uint64_t>(q->column_int(6));
+            lti->act.activations_first = static_cast<uint64_t>(q->column_int(7));
+        }
+        delete q;
+        
+        q = new soar_module::sqlite_statement(db, "SELECT lti_id, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10 FROM smem_activation_history");
+        q->prepare();
+        while (q->execute() == soar_module::row)
+        {
+            smem_store_lti* lti = get_lti(static_cast<smem_lti_id>(q->column_int(0)));
+            if (lti)
+            {
+                lti->act.has_history = true;
+                for (int i = 0; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+                {
+                    lti->act.history[ i ] = q->column_int(i + 1);
+                }
+            }
+        }
+        delete q;
+    }
+    
+    // augmentations (sorted once at the end rather than per insert)
+    {
+        q = new soar_module::sqlite_statement(db, "SELECT lti_id, attribute_s_id, value_constant_s_id, value_lti_id FROM smem_augmentations");
+        q->prepare();
+        while (q->execute() == soar_module::row)
+        {
+            smem_store_lti* lti = get_lti(static_cast<smem_lti_id>(q->column_int(0)));
+            if (lti)
+            {
+                smem_store_edge e;
+                e.attr = static_cast<smem_hash_id>(q->column_int(1));
+                e.value_const = static_cast<smem_hash_id>(q->column_int(2));
+                e.value_lti = static_cast<smem_lti_id>(q->column_int(3));
+                lti->edges.push_back(e);
+            }
+        }
+        delete q;
+        
+        for (std::vector<smem_store_lti*>::iterator l = ltis.begin(); l != ltis.end(); l++)
+        {
+            if ((*l) && ((*l)->edges.size() > 1))
+            {
+                std::sort((*l)->edges.begin(), (*l)->edges.end(), smem_compare_store_edges());
+            }
+        }
+        
+        for (smem_lti_id lti_id = 0; lti_id < ltis.size(); lti_id++)
+        {
+            if (ltis[ lti_id ])
+            {
+                smem_store_edge_list& edges = ltis[ lti_id ]->edges;
+                for (smem_store_edge_list::iterator e = edges.begin(); e != edges.end(); e++)
+                {
+                    index_edge(lti_id, (*e), ((e == edges.begin()) || ((e - 1)->attr != e->attr)));
+                }
+            }
+        }
+    }
+    
+    // persistent variables
+    {
+        q = new soar_module::sqlite_statement(db, "SELECT variable_id, variable_value FROM smem_persistent_variables");
+        q->prepare();
+        while (q->execute() == soar_module::row)
+        {
+            variables[ static_cast<smem_variable_key>(q->column_int(0)) ] = q->column_int(1);
+        }
+        delete q;
+    }
+    
+    load_frequencies(db);
+}
+
+// (re)reads the three frequency tables
+void smem_native_store::load_frequencies(soar_module::sqlite_database* db)
+{
+    soar_module::sqlite_statement* q;
+    
+    attribute_frequency.clear();
+    constant_frequency.clear();
+    lti_frequency.clear();
+    
+    {
+        q = new soar_module::sqlite_statement(db, "SELECT attribute_s_id, edge_frequency FROM smem_attribute_frequency");
+        q->prepare();
+        while (q->execute() == soar_module::row)
+        {
+            attribute_frequency[ static_cast<smem_hash_id>(q->column_int(0)) ] = q->column_int(1);
+        }
+        delete q;
+        
+        q = new soar_module::sqlite_statement(db, "SELECT attribute_s_id, value_constant_s_id, edge_frequency FROM smem_wmes_constant_frequency");
+        q->prepare();
+        while (q->execute() == soar_module::row)
+        {
+            constant_frequency[ std::make_pair(static_cast<smem_hash_id>(q->column_int(0)), static_cast<smem_hash_id>(q->column_int(1))) ] = q->column_int(2);
+        }
+        delete q;
+        
+        q = new soar_module::sqlite_statement(db, "SELECT attribute_s_id, value_lti_id, edge_frequency FROM smem_wmes_lti_frequency");
+        q->prepare();
+        while (q->execute() == soar_module::row)
+        {
+            lti_frequency[ std::make_pair(static_cast<smem_hash_id>(q->column_int(0)), static_cast<smem_lti_id>(q->column_int(1))) ] = q->column_int(2);
+        }
+        delete q;
+    }
+}
+
+// indexes the ltis by access time (only done for a shared store,
+// which nothing changes once it is loaded)
+void smem_native_store::index_last_access()
+{
+    last_access_index.clear();
+    
+    for (smem_lti_id lti_id = 0; lti_id < ltis.size(); lti_id++)
+    {
+        if (ltis[ lti_id ])
+        {
+            last_access_index[ ltis[ lti_id ]->act.activations_last ].push_back(lti_id);
+        }
+    }
+}
+
+smem_store_symbol* smem_native_store::add_symbol(smem_hash_id hash, byte symbol_type)
+{
+    if (hash >= symbols.size())
+    {
+        symbols.resize(static_cast<size_t>(hash + 1), NULL);
+    }
+    
+    smem_store_symbol* s = symbols[ hash ];
+    if (!s)
+    {
+        s = new smem_store_symbol;
+        s->int_value = 0;
+        s->float_value = 0.0;
+        symbols[ hash ] = s;
+    }
+    s->symbol_type = symbol_type;
+    
+    return s;
+}
+
+smem_store_lti* smem_native_store::add_lti(smem_lti_id lti_id, char letter, uint64_t number)
+{
+    if (lti_id >= ltis.size())
+    {
+        ltis.resize(static_cast<size_t>(lti_id + 1), NULL);
+    }
+    
+    smem_store_lti* lti = ltis[ lti_id ];
+    if (!lti)
+    {
+        lti = new smem_store_lti;
+        ltis[ lti_id ] = lti;
+    }
+    
+    lti->letter = letter;
+    lti->number = number;
+    lti->total_augmentations = 0;
+    lti->act.activation_value = 0.0;
+    lti->act.activations_total = 0;
+    lti->act.activations_last = 0;
+    lti->act.activations_first = 0;
+    lti->act.has_history = false;
+    for (int i = 0; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+    {
+        lti->act.history[ i ] = 0;
+    }
+    
+    lti_names[ std::make_pair(letter, number) ] = lti_id;
+    
+    return lti;
+}
+
+smem_lti_id smem_native_store::find_lti(char letter, uint64_t number)
+{
+    std::map< std::pair<char, uint64_t>, smem_lti_id >::iterator p = lti_names.find(std::make_pair(letter, number));
+    
+    return (p != lti_names.end()) ? (p->second) : (NIL);
+}
+
+void smem_native_store::add_edge(smem_lti_id lti_id, smem_hash_id attr, smem_hash_id value_const, smem_lti_id value_lti)
+{
+    smem_store_lti* lti = get_lti(lti_id);
+    if (lti)
+    {
+        smem_store_edge e;
+        e.attr = attr;
+        e.value_const = value_const;
+        e.value_lti = value_lti;
+        
+        bool new_attr = !has_edge(lti_id, attr);
+        
+        lti->edges.insert(std::lower_bound(lti->edges.begin(), lti->edges.end(), e, smem_compare_store_edges()), e);
+        index_edge(lti_id, e, new_attr);
+        
+        if (value_lti != SMEM_AUGMENTATIONS_NULL)
+        {
+            edge_changed(lti_id);
+        }
+    }
+}
+
+smem_store_edge_list::iterator smem_native_store::first_edge(smem_store_lti* lti, smem_hash_id attr)
+{
+    smem_store_edge e;
+    e.attr = attr;
+    e.value_const = 0;
+    e.value_lti = 0;
+    
+    return std::lower_bound(lti->edges.begin(), lti->edges.end(), e, smem_compare_store_edges());
+}
+
+bool smem_native_store::has_edge(smem_lti_id lti_id, smem_hash_id attr)
+{
+    smem_store_lti* lti = get_lti(lti_id);
+    if (!lti)
+    {
+        return false;
+    }
+    
+    smem_store_edge_list::iterator e = first_edge(lti, attr);
+    
+    return ((e != lti->edges.end()) && (e->attr == attr));
+}
+
+bool smem_native_store::has_edge(smem_lti_id lti_id, smem_hash_id attr, smem_hash_id value_const, smem_lti_id value_lti)
+{
+    smem_store_lti* lti = get_lti(lti_id);
+    if (!lti)
+    {
+        return false;
+    }
+    
+    smem_store_edge e;
+    e.attr = attr;
+    e.value_const = value_const;
+    e.value_lti = value_lti;
+    
+    return std::binary_search(lti->edges.begin(), lti->edges.end(), e, smem_compare_store_edges());
+}
+
+void smem_native_store::clear_edges(smem_lti_id lti_id)
+{
+    smem_store_lti* lti = get_lti(lti_id);
+    if (lti)
+    {
+        for (smem_store_edge_list::iterator e = lti->edges.begin(); e != lti->edges.end(); e++)
+        {
+            unindex_edge(lti_id, (*e), (((e + 1) == lti->edges.end()) || ((e + 1)->attr != e->attr)));
+        }
+        
+        lti->edges.clear();
+        edge_changed(lti_id);
+    }
+}
+
+// logs a change to an lti's values, if anyone is following them;
+// a change that isn't logged (or overflows the log) resets everyone
+void smem_native_store::edge_changed(smem_lti_id lti_id)
+{
+    edge_version++;
+    
+    if (log_edge_changes && (edge_changes.size() < SMEM_MAX_EDGE_CHANGES))
+    {
+        edge_changes.push_back(lti_id);
+    }
+    else
+    {
+        edge_changes.clear();
+        edge_reset = edge_version;
+    }
+}
+
+// drops the changes up to version, which their reader has seen
+// (a native store that changes has only the one reader)
+void smem_native_store::edge_changes_seen(uint64_t version)
+{
+    if (version <= edge_reset)
+    {
+        return;
+    }
+    
+    edge_changes.erase(edge_changes.begin(), edge_changes.begin() + static_cast<size_t>(version - edge_reset));
+    edge_reset = version;
+}
+
+// the attribute index holds each lti once, however many values it has
+void smem_native_store::index_edge(smem_lti_id lti_id, const smem_store_edge& e, bool new_attr)
+{
+    smem_store_lti_entry entry = std::make_pair(ltis[ lti_id ]->act.activation_value, lti_id);
+    
+    if (new_attr)
+    {
+        attr_index[ e.attr ].insert(entry);
+    }
+    
+    if (e.value_lti == SMEM_AUGMENTATIONS_NULL)
+    {
+        const_index[ std::make_pair(e.attr, e.value_const) ].insert(entry);
+    }
+    else
+    {
+        lti_index[ std::make_pair(e.attr, e.value_lti) ].insert(entry);
+    }
+}
+
+void smem_native_store::unindex_edge(smem_lti_id lti_id, const smem_store_edge& e, bool last_attr)
+{
+    smem_store_lti_entry entry = std::make_pair(ltis[ lti_id ]->act.activation_value, lti_id);
+    
+    if (last_attr)
+    {
+        attr_index[ e.attr ].erase(entry);
+    }
+    
+    if (e.value_lti == SMEM_AUGMENTATIONS_NULL)
+    {
+        const_index[ std::make_pair(e.attr, e.value_const) ].erase(entry);
+    }
+    else
+    {
+        lti_index[ std::make_pair(e.attr, e.value_lti) ].erase(entry);
+    }
+}
+
+// the candidate lists are keyed on the activation, so the lti
+// leaves them under its old value and rejoins under the new
+void smem_native_store::set_activation(smem_lti_id lti_id, double activation_value)
+{
+    smem_store_lti* lti = get_lti(lti_id);
+    if ((!lti) || (lti->act.activation_value == activation_value))
+    {
+        return;
+    }
+    
+    for (smem_store_edge_list::iterator e = lti->edges.begin(); e != lti->edges.end(); e++)
+    {
+        unindex_edge(lti_id, (*e), ((e == lti->edges.begin()) || ((e - 1)->attr != e->attr)));
+    }
+    
+    lti->act.activation_value = activation_value;
+    
+    for (smem_store_edge_list::iterator e = lti->edges.begin(); e != lti->edges.end(); e++)
+    {
+        index_edge(lti_id, (*e), ((e == lti->edges.begin()) || ((e - 1)->attr != e->attr)));
+    }
+}
+
+smem_store_lti_list* smem_native_store::get_candidates(smem_hash_id attr, smem_hash_id value_const, smem_lti_id value_lti)
+{
+    if (value_const != SMEM_AUGMENTATIONS_NULL)
+    {
+        std::map<smem_store_const_key, smem_store_lti_list>::iterator p = const_index.find(std::make_pair(attr, value_const));
+        return (p != const_index.end()) ? (&(p->second)) : (NULL);
+    }
+    else if (value_lti != SMEM_AUGMENTATIONS_NULL)
+    {
+        std::map<smem_store_lti_key, smem_store_lti_list>::iterator p = lti_index.find(std::make_pair(attr, value_lti));
+        return (p != lti_index.end()) ? (&(p->second)) : (NULL);
+    }
+    
+    std::map<smem_hash_id, smem_store_lti_list>::iterator p = attr_index.find(attr);
+    return (p != attr_index.end()) ? (&(p->second)) : (NULL);
+}
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Store Overlay Functions (smem::overlay)
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+smem_store_overlay::smem_store_overlay(smem_native_store* new_store, bool new_shared): store(new_store), shared(new_shared), spread_version(new_store->edge_version) {}
+
+// for writing: a shared store's record is copied on first use
+smem_store_activation* smem_store_overlay::get_act(smem_lti_id lti_id)
+{
+    smem_store_lti* lti = store->get_lti(lti_id);
+    if (!lti)
+    {
+        return NULL;
+    }
+    
+    if (!shared)
+    {
+        return &(lti->act);
+    }
+    
+    std::map<smem_lti_id, smem_store_activation>::iterator p = activations.find(lti_id);
+    if (p == activations.end())
+    {
+        p = activations.insert(std::make_pair(lti_id, lti->act)).first;
+        last_access.insert(std::make_pair(lti->act.activations_last, lti_id));
+    }
+    
+    return &(p->second);
+}
+
+// records an access at time t, keeping a shared store's index up to date
+void smem_store_overlay::set_last_access(smem_lti_id lti_id, smem_store_activation* act, uint64_t t)
+{
+    if (shared)
+    {
+        std::pair< std::multimap<uint64_t, smem_lti_id>::iterator, std::multimap<uint64_t, smem_lti_id>::iterator > old = last_access.equal_range(act->activations_last);
+        for (std::multimap<uint64_t, smem_lti_id>::iterator p = old.first; p != old.second; p++)
+        {
+            if (p->second == lti_id)
+            {
+                last_access.erase(p);
+                break;
+            }
+        }
+        
+        last_access.insert(std::make_pair(t, lti_id));
+    }
+    
+    act->activations_last = t;
+}
+
+// the ltis of a shared store last accessed at time t: this agent's own
+// accesses, and the store's for ltis this agent hasn't accessed
+void smem_store_overlay::get_last_accessed(uint64_t t, std::list<smem_lti_id>& lti_ids)
+{
+    std::map< uint64_t, std::vector<smem_lti_id> >::iterator s = store->last_access_index.find(t);
+    if (s != store->last_access_index.end())
+    {
+        for (std::vector<smem_lti_id>::iterator l = s->second.begin(); l != s->second.end(); l++)
+        {
+            if (activations.find(*l) == activations.end())
+            {
+                lti_ids.push_back(*l);
+            }
+        }
+    }
+    
+    std::pair< std::multimap<uint64_t, smem_lti_id>::iterator, std::multimap<uint64_t, smem_lti_id>::iterator > own = last_access.equal_range(t);
+    for (std::multimap<uint64_t, smem_lti_id>::iterator p = own.first; p != own.second; p++)
+    {
+        lti_ids.push_back(p->second);
+    }
+}
+
+void smem_store_overlay::history_add(smem_store_activation* act, int64_t t)
+{
+    act->has_history = true;
+    act->history[ 0 ] = t;
+    for (int i = 1; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+    {
+        act->history[ i ] = 0;
+    }
+}
+
+void smem_store_overlay::history_push(smem_store_activation* act, int64_t t)
+{
+    // mirrors the database, where pushing onto a missing row is a no-op
+    if (act->has_history)
+    {
+        for (int i = (SMEM_ACT_HISTORY_ENTRIES - 1); i > 0; i--)
+        {
+            act->history[ i ] = act->history[ i - 1 ];
+        }
+        act->history[ 0 ] = t;
+    }
+}
+
+// an lti may be in working memory more than once, so
+// only the first reference adds it to the context
+void smem_store_overlay::context_add(smem_lti_id lti_id)
+{
+    if ((++context[ lti_id ]) == 1)
+    {
+        spread_pending.insert(lti_id);
+    }
+}
+
+void smem_store_overlay::context_remove(smem_lti_id lti_id)
+{
+    // ltis can be stored after they entered working memory
+    std::map<smem_lti_id, uint64_t>::iterator c = context.find(lti_id);
+    if ((c == context.end()) || ((--c->second) > 0))
+    {
+        return;
+    }
+    context.erase(c);
+    
+    if (spread_version != store->edge_version)
+    {
+        spread_invalidate();
+    }
+    
+    if (spread_pending.erase(lti_id))
+    {
+        return;
+    }
+    
+    std::map<smem_lti_id, smem_spread_map>::iterator f = fan_out.find(lti_id);
+    if (f != fan_out.end())
+    {
+        spread_remove(f);
+    }
+}
+
+// takes a source's fan-out out of the total spread
+void smem_store_overlay::spread_remove(std::map<smem_lti_id, smem_spread_map>::iterator f)
+{
+    for (smem_spread_map::iterator r = f->second.begin(); r != f->second.end(); r++)
+    {
+        // rounding may have dropped the total before its last source
+        smem_spread_map::iterator p = spread.find(r->first);
+        if (p == spread.end())
+        {
+            continue;
+        }
+        
+        p->second -= r->second;
+            
+        // no other source reaches this lti
+        if (p->second <= 0.0)
+        {
+            spread.erase(p);
+        }
+    }
+    fan_out.erase(f);
+}
+
+// brings fan-out of new context ltis into the total spread,
+// stopping once budget ltis have been visited (the rest wait
+// for the next call); returns the number visited
+uint64_t smem_store_overlay::spread_update(uint64_t depth, uint64_t limit, uint64_t budget)
+{
+    uint64_t visited = 0;
+    
+    if (spread_version != store->edge_version)
+    {
+        spread_invalidate();
+    }
+    
+    while ((!spread_pending.empty()) && (visited < budget))
+    {
+        smem_lti_id source = (*spread_pending.begin());
+        spread_pending.erase(spread_pending.begin());
+        
+        visited += spread_fan_out(source, depth, limit);
+        
+        smem_spread_map& f = fan_out[ source ];
+        for (smem_spread_map::iterator r = f.begin(); r != f.end(); r++)
+        {
+            spread[ r->first ] += r->second;
+        }
+    }
+    
+    return visited;
+}
+
+// a unit of activation leaves the source and is divided evenly
+// among the lti values of each lti it reaches, to the given depth;
+// ltis with more than limit such values do not spread (fan effect)
+uint64_t smem_store_overlay::spread_fan_out(smem_lti_id source, uint64_t depth, uint64_t limit)
+{
+    smem_spread_map& result = fan_out[ source ];
+    smem_spread_map frontier;
+    smem_spread_map next;
+    uint64_t visited = 0;
+    
+    result.clear();
+    frontier[ source ] = 1.0;
+    
+    for (uint64_t d = 0; (d < depth) && (!frontier.empty()); d++)
+    {
+        next.clear();
+        
+        for (smem_spread_map::iterator n = frontier.begin(); n != frontier.end(); n++)
+        {
+            smem_store_lti* lti = store->get_lti(n->first);
+            visited++;
+            
+            if (!lti)
+            {
+                continue;
+            }
+            
+            uint64_t fan = 0;
+            for (smem_store_edge_list::iterator e = lti->edges.begin(); e != lti->edges.end(); e++)
+            {
+                if (e->value_lti != SMEM_AUGMENTATIONS_NULL)
+                {
+                    fan++;
+                }
+            }
+            
+            if ((fan == 0) || (fan > limit))
+            {
+                continue;
+            }
+            
+            double share = (n->second / static_cast<double>(fan));
+            for (smem_store_edge_list::iterator e = lti->edges.begin(); e != lti->edges.end(); e++)
+            {
+                if (e->value_lti != SMEM_AUGMENTATIONS_NULL)
+                {
+                    result[ e->value_lti ] += share;
+                    next[ e->value_lti ] += share;
+                }
+            }
+        }
+        
+        frontier.swap(next);
+    }
+    
+    return visited;
+}
+
+// fan-out follows lti edges, so a source whose fan-out reached
+// an lti with changed values must spread again (after a reload,
+// every context lti must)
+void smem_store_overlay::spread_invalidate()
+{
+    bool reset = (spread_version < store->edge_reset);
+    std::vector<smem_lti_id> changed;
     
-    vis_lti_act = new soar_module::sqlite_statement(new_db, "SELECT activation_value FROM smem_lti WHERE lti_id=?");
-    add(vis_lti_act);
+    if (!reset)
+    {
+        changed.assign(store->edge_changes.begin() + static_cast<size_t>(spread_version - store->edge_reset), store->edge_changes.end());
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    }
+    spread_version = store->edge_version;
+    store->edge_changes_seen(spread_version);
     
-    vis_value_const = new soar_module::sqlite_statement(new_db, "SELECT lti_id, tsh1.symbol_type AS attr_type, tsh1.s_id AS attr_hash, tsh2.symbol_type AS val_type, tsh2.s_id AS val_hash FROM smem_augmentations w, smem_symbols_type tsh1, smem_symbols_type tsh2 WHERE (w.attribute_s_id=tsh1.s_id) AND (w.value_constant_s_id=tsh2.s_id)");
-    add(vis_value_const);
+    if (reset)
+    {
+        fan_out.clear();
+        spread.clear();
+        for (std::map<smem_lti_id, uint64_t>::iterator c = context.begin(); c != context.end(); c++)
+        {
+            spread_pending.insert(c->first);
+        }
+        
+        return;
+    }
     
-    vis_value_lti = new soar_module::sqlite_statement(new_db, "SELECT lti_id, tsh.symbol_type AS attr_type, tsh.s_id AS attr_hash, value_lti_id FROM smem_augmentations w, smem_symbols_type tsh WHERE (w.attribute_s_id=tsh.s_id) AND (value_lti_id<>" SMEM_AUGMENTATIONS_NULL_STR ")");
-    add(vis_value_lti);
+    std::map<smem_lti_id, smem_spread_map>::iterator f = fan_out.begin();
+    while (f != fan_out.end())
+    {
+        // every lti the fan-out expanded was also reached by it
+        bool affected = std::binary_search(changed.begin(), changed.end(), f->first);
+        for (std::vector<smem_lti_id>::iterator c = changed.begin(); (c != changed.end()) && (!affected); c++)
+        {
+            affected = (f->second.find(*c) != f->second.end());
+        }
+        
+        if (affected)
+        {
+            spread_pending.insert(f->first);
+            spread_remove(f++);
+        }
+        else
+        {
+            f++;
+        }
+    }
+}
+
+// agents sharing a store may not change it
+inline bool smem_read_only(agent* thisAgent)
+{
+    return ((thisAgent->smem_overlay != NULL) && (thisAgent->smem_overlay->shared));
 }
 
 
@@ -918,7 +1768,14 @@ inline smem_hash_id smem_temporal_hash_add_type(agent* thisAgent, byte symbol_ty
 {
     thisAgent->smem_stmts->hash_add_type->bind_int(1, symbol_type);
     thisAgent->smem_stmts->hash_add_type->execute(soar_module::op_reinit);
-    return static_cast<smem_hash_id>(thisAgent->smem_db->last_insert_rowid());
+    smem_hash_id return_val = static_cast<smem_hash_id>(thisAgent->smem_db->last_insert_rowid());
+    
+    if (thisAgent->smem_store)
+    {
+        thisAgent->smem_store->add_symbol(return_val, symbol_type);
+    }
+    
+    return return_val;
 }
 
 inline smem_hash_id smem_temporal_hash_int(agent* thisAgent, int64_t val, bool add_on_fail = true)
@@ -926,12 +1783,23 @@ inline smem_hash_id smem_temporal_hash_int(agent* thisAgent, int64_t val, bool a
     smem_hash_id return_val = NIL;
     
     // search first
-    thisAgent->smem_stmts->hash_get_int->bind_int(1, val);
-    if (thisAgent->smem_stmts->hash_get_int->execute() == soar_module::row)
+    if (thisAgent->smem_store)
+    {
+        std::map<int64_t, smem_hash_id>::iterator p = thisAgent->smem_store->int_hashes.find(val);
+        if (p != thisAgent->smem_store->int_hashes.end())
+        {
+            return_val = p->second;
+        }
+    }
+    else
     {
-        return_val = static_cast<smem_hash_id>(thisAgent->smem_stmts->hash_get_int->column_int(0));
+        thisAgent->smem_stmts->hash_get_int->bind_int(1, val);
+        if (thisAgent->smem_stmts->hash_get_int->execute() == soar_module::row)
+        {
+            return_val = static_cast<smem_hash_id>(thisAgent->smem_stmts->hash_get_int->column_int(0));
+        }
+        thisAgent->smem_stmts->hash_get_int->reinitialize();
     }
-    thisAgent->smem_stmts->hash_get_int->reinitialize();
     
     // if fail and supposed to add
     if (!return_val && add_on_fail)
@@ -943,6 +1811,12 @@ inline smem_hash_id smem_temporal_hash_int(agent* thisAgent, int64_t val, bool a
         thisAgent->smem_stmts->hash_add_int->bind_int(1, return_val);
         thisAgent->smem_stmts->hash_add_int->bind_int(2, val);
         thisAgent->smem_stmts->hash_add_int->execute(soar_module::op_reinit);
+        
+        if (thisAgent->smem_store)
+        {
+            thisAgent->smem_store->get_symbol(return_val)->int_value = val;
+            thisAgent->smem_store->int_hashes[ val ] = return_val;
+        }
     }
     
     return return_val;
@@ -953,12 +1827,23 @@ inline smem_hash_id smem_temporal_hash_float(agent* thisAgent, double val, bool
     smem_hash_id return_val = NIL;
     
     // search first
-    thisAgent->smem_stmts->hash_get_float->bind_double(1, val);
-    if (thisAgent->smem_stmts->hash_get_float->execute() == soar_module::row)
+    if (thisAgent->smem_store)
     {
-        return_val = static_cast<smem_hash_id>(thisAgent->smem_stmts->hash_get_float->column_int(0));
+        std::map<double, smem_hash_id>::iterator p = thisAgent->smem_store->float_hashes.find(val);
+        if (p != thisAgent->smem_store->float_hashes.end())
+        {
+            return_val = p->second;
+        }
+    }
+    else
+    {
+        thisAgent->smem_stmts->hash_get_float->bind_double(1, val);
+        if (thisAgent->smem_stmts->hash_get_float->execute() == soar_module::row)
+        {
+            return_val = static_cast<smem_hash_id>(thisAgent->smem_stmts->hash_get_float->column_int(0));
+        }
+        thisAgent->smem_stmts->hash_get_float->reinitialize();
     }
-    thisAgent->smem_stmts->hash_get_float->reinitialize();
     
     // if fail and supposed to add
     if (!return_val && add_on_fail)
@@ -970,6 +1855,12 @@ inline smem_hash_id smem_temporal_hash_float(agent* thisAgent, double val, bool
         thisAgent->smem_stmts->hash_add_float->bind_int(1, return_val);
         thisAgent->smem_stmts->hash_add_float->bind_double(2, val);
         thisAgent->smem_stmts->hash_add_float->execute(soar_module::op_reinit);
+        
+        if (thisAgent->smem_store)
+        {
+            thisAgent->smem_store->get_symbol(return_val)->float_value = val;
+            thisAgent->smem_store->float_hashes[ val ] = return_val;
+        }
     }
     
     return return_val;
@@ -980,12 +1871,23 @@ inline smem_hash_id smem_temporal_hash_str(agent* thisAgent, char* val, bool add
     smem_hash_id return_val = NIL;
     
     // search first
-    thisAgent->smem_stmts->hash_get_str->bind_text(1, static_cast<const char*>(val));
-    if (thisAgent->smem_stmts->hash_get_str->execute() == soar_module::row)
+    if (thisAgent->smem_store)
+    {
+        std::map<std::string, smem_hash_id>::iterator p = thisAgent->smem_store->str_hashes.find(std::string(val));
+        if (p != thisAgent->smem_store->str_hashes.end())
+        {
+            return_val = p->second;
+        }
+    }
+    else
     {
-        return_val = static_cast<smem_hash_id>(thisAgent->smem_stmts->hash_get_str->column_int(0));
+        thisAgent->smem_stmts->hash_get_str->bind_text(1, static_cast<const char*>(val));
+        if (thisAgent->smem_stmts->hash_get_str->execute() == soar_module::row)
+        {
+            return_val = static_cast<smem_hash_id>(thisAgent->smem_stmts->hash_get_str->column_int(0));
+        }
+        thisAgent->smem_stmts->hash_get_str->reinitialize();
     }
-    thisAgent->smem_stmts->hash_get_str->reinitialize();
     
     // if fail and supposed to add
     if (!return_val && add_on_fail)
@@ -997,6 +1899,12 @@ inline smem_hash_id smem_temporal_hash_str(agent* thisAgent, char* val, bool add
         thisAgent->smem_stmts->hash_add_str->bind_int(1, return_val);
         thisAgent->smem_stmts->hash_add_str->bind_text(2, static_cast<const char*>(val));
         thisAgent->smem_stmts->hash_add_str->execute(soar_module::op_reinit);
+        
+        if (thisAgent->smem_store)
+        {
+            thisAgent->smem_store->get_symbol(return_val)->str_value.assign(val);
+            thisAgent->smem_store->str_hashes[ std::string(val) ] = return_val;
+        }
     }
     
     return return_val;
@@ -1052,6 +1960,13 @@ inline int64_t smem_reverse_hash_int(agent* thisAgent, smem_hash_id hash_value)
 {
     int64_t return_val = NIL;
     
+    if (thisAgent->smem_store)
+    {
+        smem_store_symbol* s = thisAgent->smem_store->get_symbol(hash_value);
+        assert(s);
+        return s->int_value;
+    }
+    
     thisAgent->smem_stmts->hash_rev_int->bind_int(1, hash_value);
     soar_module::exec_result res = thisAgent->smem_stmts->hash_rev_int->execute();
     (void)res; // quells compiler warning
@@ -1066,6 +1981,13 @@ inline double smem_reverse_hash_float(agent* thisAgent, smem_hash_id hash_value)
 {
     double return_val = NIL;
     
+    if (thisAgent->smem_store)
+    {
+        smem_store_symbol* s = thisAgent->smem_store->get_symbol(hash_value);
+        assert(s);
+        return s->float_value;
+    }
+    
     thisAgent->smem_stmts->hash_rev_float->bind_int(1, hash_value);
     soar_module::exec_result res = thisAgent->smem_stmts->hash_rev_float->execute();
     (void)res; // quells compiler warning
@@ -1078,6 +2000,14 @@ inline double smem_reverse_hash_float(agent* thisAgent, smem_hash_id hash_value)
 
 inline void smem_reverse_hash_str(agent* thisAgent, smem_hash_id hash_value, std::string& dest)
 {
+    if (thisAgent->smem_store)
+    {
+        smem_store_symbol* s = thisAgent->smem_store->get_symbol(hash_value);
+        assert(s);
+        dest.assign(s->str_value);
+        return;
+    }
+    
     thisAgent->smem_stmts->hash_rev_str->bind_int(1, hash_value);
     soar_module::exec_result res = thisAgent->smem_stmts->hash_rev_str->execute();
     (void)res; // quells compiler warning
@@ -1128,31 +2058,53 @@ inline double smem_lti_calc_base(agent* thisAgent, smem_lti_id lti, int64_t time
     uint64_t t_k;
     uint64_t t_n = (time_now - activations_first);
     
-    if (n == 0)
+    if (thisAgent->smem_store)
     {
-        thisAgent->smem_stmts->lti_access_get->bind_int(1, lti);
-        thisAgent->smem_stmts->lti_access_get->execute();
+        const smem_store_activation* l = thisAgent->smem_overlay->peek_act(lti);
         
-        n = thisAgent->smem_stmts->lti_access_get->column_int(0);
-        activations_first = thisAgent->smem_stmts->lti_access_get->column_int(2);
+        if (n == 0)
+        {
+            n = l->activations_total;
+            activations_first = l->activations_first;
+        }
         
-        thisAgent->smem_stmts->lti_access_get->reinitialize();
-    }
-    
-    // get all history
-    thisAgent->smem_stmts->history_get->bind_int(1, lti);
-    thisAgent->smem_stmts->history_get->execute();
-    {
         int available_history = static_cast<int>((SMEM_ACT_HISTORY_ENTRIES < n) ? (SMEM_ACT_HISTORY_ENTRIES) : (n));
-        t_k = static_cast<uint64_t>(time_now - thisAgent->smem_stmts->history_get->column_int(available_history - 1));
+        t_k = static_cast<uint64_t>(time_now - l->history[ available_history - 1 ]);
         
         for (int i = 0; i < available_history; i++)
         {
-            sum += pow(static_cast<double>(time_now - thisAgent->smem_stmts->history_get->column_int(i)),
+            sum += pow(static_cast<double>(time_now - l->history[ i ]),
                        static_cast<double>(-d));
         }
     }
-    thisAgent->smem_stmts->history_get->reinitialize();
+    else
+    {
+        if (n == 0)
+        {
+            thisAgent->smem_stmts->lti_access_get->bind_int(1, lti);
+            thisAgent->smem_stmts->lti_access_get->execute();
+            
+            n = thisAgent->smem_stmts->lti_access_get->column_int(0);
+            activations_first = thisAgent->smem_stmts->lti_access_get->column_int(2);
+            
+            thisAgent->smem_stmts->lti_access_get->reinitialize();
+        }
+        
+        // get all history
+        thisAgent->smem_stmts->history_get->bind_int(1, lti);
+        thisAgent->smem_stmts->history_get->execute();
+        {
+            int available_history = static_cast<int>((SMEM_ACT_HISTORY_ENTRIES < n) ? (SMEM_ACT_HISTORY_ENTRIES) : (n));
+            t_k = static_cast<uint64_t>(time_now - thisAgent->smem_stmts->history_get->column_int(available_history - 1));
+            
+            for (int i = 0; i < available_history; i++)
+            {
+                sum += pow(static_cast<double>(time_now - thisAgent->smem_stmts->history_get->column_int(i)),
+                           static_cast<double>(-d));
+            }
+        }
+        thisAgent->smem_stmts->history_get->reinitialize();
+    }
     
     // if available history was insufficient, approximate rest
     if (n > SMEM_ACT_HISTORY_ENTRIES)
@@ -1182,35 +2134,12 @@ inline double smem_lti_activate(agent* thisAgent, smem_lti_id lti, bool add_acce
     {
         time_now = thisAgent->smem_max_cycle++;
         
+        // in deadline mode the update may be left for a later cycle
         if ((thisAgent->smem_params->activation_mode->get_value() == smem_param_container::act_base) &&
-                (thisAgent->smem_params->base_update->get_value() == smem_param_container::bupt_incremental))
+                (thisAgent->smem_params->base_update->get_value() == smem_param_container::bupt_incremental) &&
+                !deadline_defer(thisAgent, DEFERRED_SMEM_ACTIVATION, time_now))
         {
-            int64_t time_diff;
-            
-            for (std::set< int64_t >::iterator b = thisAgent->smem_params->base_incremental_threshes->set_begin(); b != thisAgent->smem_params->base_incremental_threshes->set_end(); b++)
-            {
-                if (*b > 0)
-                {
-                    time_diff = (time_now - *b);
-                    
-                    if (time_diff > 0)
-                    {
-                        std::list< smem_lti_id > to_update;
-                        
-                        thisAgent->smem_stmts->lti_get_t->bind_int(1, time_diff);
-                        while (thisAgent->smem_stmts->lti_get_t->execute() == soar_module::row)
-                        {
-                            to_update.push_back(static_cast< smem_lti_id >(thisAgent->smem_stmts->lti_get_t->column_int(0)));
-                        }
-                        thisAgent->smem_stmts->lti_get_t->reinitialize();
-                        
-                        for (std::list< smem_lti_id >::iterator it = to_update.begin(); it != to_update.end(); it++)
-                        {
-                            smem_lti_activate(thisAgent, (*it), false);
-                        }
-                    }
-                }
-            }
+            smem_update_incremental_activations(thisAgent, time_now);
         }
     }
     else
@@ -1220,12 +2149,26 @@ inline double smem_lti_activate(agent* thisAgent, smem_lti_id lti, bool add_acce
         thisAgent->smem_stats->act_updates->set_value(thisAgent->smem_stats->act_updates->get_value() + 1);
     }
     
+    // native record, if any (written alongside the database below)
+    smem_store_lti* store_lti = ((thisAgent->smem_store) ? (thisAgent->smem_store->get_lti(lti)) : (NULL));
+    smem_store_activation* store_act = ((store_lti) ? (thisAgent->smem_overlay->get_act(lti)) : (NULL));
+    
+    // a shared store is read-only, so access data stays in the overlay
+    bool persist = ((!thisAgent->smem_overlay) || (!thisAgent->smem_overlay->shared));
+    
     // access information
     uint64_t prev_access_n = 0;
     uint64_t prev_access_t = 0;
     uint64_t prev_access_1 = 0;
     {
         // get old (potentially useful below)
+        if (store_act)
+        {
+            prev_access_n = store_act->activations_total;
+            prev_access_t = store_act->activations_last;
+            prev_access_1 = store_act->activations_first;
+        }
+        else
         {
             thisAgent->smem_stmts->lti_access_get->bind_int(1, lti);
             thisAgent->smem_stmts->lti_access_get->execute();
@@ -1240,11 +2183,21 @@ inline double smem_lti_activate(agent* thisAgent, smem_lti_id lti, bool add_acce
         // set new
         if (add_access)
         {
-            thisAgent->smem_stmts->lti_access_set->bind_int(1, (prev_access_n + 1));
-            thisAgent->smem_stmts->lti_access_set->bind_int(2, time_now);
-            thisAgent->smem_stmts->lti_access_set->bind_int(3, ((prev_access_n == 0) ? (time_now) : (prev_access_1)));
-            thisAgent->smem_stmts->lti_access_set->bind_int(4, lti);
-            thisAgent->smem_stmts->lti_access_set->execute(soar_module::op_reinit);
+            if (persist)
+            {
+                thisAgent->smem_stmts->lti_access_set->bind_int(1, (prev_access_n + 1));
+                thisAgent->smem_stmts->lti_access_set->bind_int(2, time_now);
+                thisAgent->smem_stmts->lti_access_set->bind_int(3, ((prev_access_n == 0) ? (time_now) : (prev_access_1)));
+                thisAgent->smem_stmts->lti_access_set->bind_int(4, lti);
+                thisAgent->smem_stmts->lti_access_set->execute(soar_module::op_reinit);
+            }
+            
+            if (store_act)
+            {
+                store_act->activations_first = ((prev_access_n == 0) ? (time_now) : (prev_access_1));
+                store_act->activations_total = (prev_access_n + 1);
+                thisAgent->smem_overlay->set_last_access(lti, store_act, time_now);
+            }
         }
     }
     
@@ -1265,9 +2218,17 @@ inline double smem_lti_activate(agent* thisAgent, smem_lti_id lti, bool add_acce
         {
             if (add_access)
             {
-                thisAgent->smem_stmts->history_add->bind_int(1, lti);
-                thisAgent->smem_stmts->history_add->bind_int(2, time_now);
-                thisAgent->smem_stmts->history_add->execute(soar_module::op_reinit);
+                if (persist)
+                {
+                    thisAgent->smem_stmts->history_add->bind_int(1, lti);
+                    thisAgent->smem_stmts->history_add->bind_int(2, time_now);
+                    thisAgent->smem_stmts->history_add->execute(soar_module::op_reinit);
+                }
+                
+                if (store_act)
+                {
+                    thisAgent->smem_overlay->history_add(store_act, time_now);
+                }
             }
             
             new_activation = 0;
@@ -1276,9 +2237,17 @@ inline double smem_lti_activate(agent* thisAgent, smem_lti_id lti, bool add_acce
         {
             if (add_access)
             {
-                thisAgent->smem_stmts->history_push->bind_int(1, time_now);
-                thisAgent->smem_stmts->history_push->bind_int(2, lti);
-                thisAgent->smem_stmts->history_push->execute(soar_module::op_reinit);
+                if (persist)
+                {
+                    thisAgent->smem_stmts->history_push->bind_int(1, time_now);
+                    thisAgent->smem_stmts->history_push->bind_int(2, lti);
+                    thisAgent->smem_stmts->history_push->execute(soar_module::op_reinit);
+                }
+                
+                if (store_act)
+                {
+                    thisAgent->smem_overlay->history_push(store_act, time_now);
+                }
             }
             
             new_activation = smem_lti_calc_base(thisAgent, lti, time_now + ((add_access) ? (1) : (0)), prev_access_n + ((add_access) ? (1) : (0)), prev_access_1);
@@ -1286,7 +2255,11 @@ inline double smem_lti_activate(agent* thisAgent, smem_lti_id lti, bool add_acce
     }
     
     // get number of augmentations (if not supplied)
-    if (num_edges == SMEM_ACT_MAX)
+    if ((num_edges == SMEM_ACT_MAX) && store_lti)
+    {
+        num_edges = store_lti->total_augmentations;
+    }
+    else if (num_edges == SMEM_ACT_MAX)
     {
         thisAgent->smem_stmts->act_lti_child_ct_get->bind_int(1, lti);
         thisAgent->smem_stmts->act_lti_child_ct_get->execute();
@@ -1297,7 +2270,15 @@ inline double smem_lti_activate(agent* thisAgent, smem_lti_id lti, bool add_acce
     }
     
     // only if augmentation count is less than threshold do we associate with edges
-    if (num_edges < static_cast<uint64_t>(thisAgent->smem_params->thresh->get_value()))
+    // (the native index orders on the lti record, so edges are written back lazily)
+    if (store_lti && (num_edges < static_cast<uint64_t>(thisAgent->smem_params->thresh->get_value())))
+    {
+        if (persist)
+        {
+            thisAgent->smem_overlay->stale_activations.insert(lti);
+        }
+    }
+    else if (num_edges < static_cast<uint64_t>(thisAgent->smem_params->thresh->get_value()))
     {
         // activation_value=? WHERE lti=?
         thisAgent->smem_stmts->act_set->bind_double(1, new_activation);
@@ -1307,10 +2288,26 @@ inline double smem_lti_activate(agent* thisAgent, smem_lti_id lti, bool add_acce
     
     // always associate activation with lti
     {
-        // activation_value=? WHERE lti=?
-        thisAgent->smem_stmts->act_lti_set->bind_double(1, new_activation);
-        thisAgent->smem_stmts->act_lti_set->bind_int(2, lti);
-        thisAgent->smem_stmts->act_lti_set->execute(soar_module::op_reinit);
+        if (persist)
+        {
+            // activation_value=? WHERE lti=?
+            thisAgent->smem_stmts->act_lti_set->bind_double(1, new_activation);
+            thisAgent->smem_stmts->act_lti_set->bind_int(2, lti);
+            thisAgent->smem_stmts->act_lti_set->execute(soar_module::op_reinit);
+        }
+        
+        if (store_act)
+        {
+            // the store's own record is also moved in the candidate index
+            if (thisAgent->smem_overlay->shared)
+            {
+                store_act->activation_value = new_activation;
+            }
+            else
+            {
+                thisAgent->smem_store->set_activation(lti, new_activation);
+            }
+        }
     }
     
     ////////////////////////////////////////////////////////////////////////////
@@ -1320,6 +2317,88 @@ inline double smem_lti_activate(agent* thisAgent, smem_lti_id lti, bool add_acce
     return new_activation;
 }
 
+// incremental base-level updates: reactivates the ltis last accessed
+// one of the incremental thresholds before an access at time_now
+void smem_update_incremental_activations(agent* thisAgent, int64_t time_now)
+{
+    int64_t time_diff;
+    
+    for (std::set< int64_t >::iterator b = thisAgent->smem_params->base_incremental_threshes->set_begin(); b != thisAgent->smem_params->base_incremental_threshes->set_end(); b++)
+    {
+        if (*b > 0)
+        {
+            time_diff = (time_now - *b);
+            
+            if (time_diff > 0)
+            {
+                std::list< smem_lti_id > to_update;
+                
+                if (smem_read_only(thisAgent))
+                {
+                    // the database is a scratch copy, so the access data is
+                    // this agent's (where it has any) or else the store's
+                    thisAgent->smem_overlay->get_last_accessed(static_cast<uint64_t>(time_diff), to_update);
+                }
+                else
+                {
+                    thisAgent->smem_stmts->lti_get_t->bind_int(1, time_diff);
+                    while (thisAgent->smem_stmts->lti_get_t->execute() == soar_module::row)
+                    {
+                        to_update.push_back(static_cast< smem_lti_id >(thisAgent->smem_stmts->lti_get_t->column_int(0)));
+                    }
+                    thisAgent->smem_stmts->lti_get_t->reinitialize();
+                }
+                
+                for (std::list< smem_lti_id >::iterator it = to_update.begin(); it != to_update.end(); it++)
+                {
+                    smem_lti_activate(thisAgent, (*it), false);
+                }
+            }
+        }
+    }
+}
+
+// writes deferred edge activations to the database, so that it
+// remains valid for retrievals without the native store
+void smem_store_flush_activations(agent* thisAgent)
+{
+    smem_native_store* store = thisAgent->smem_store;
+    smem_store_overlay* overlay = thisAgent->smem_overlay;
+    uint64_t thresh = static_cast<uint64_t>(thisAgent->smem_params->thresh->get_value());
+    
+    if (overlay->stale_activations.empty())
+    {
+        return;
+    }
+    
+    // start transaction (if not lazy)
+    if (thisAgent->smem_params->lazy_commit->get_value() == off)
+    {
+        thisAgent->smem_stmts->begin->execute(soar_module::op_reinit);
+    }
+    
+    for (std::set<smem_lti_id>::iterator l = overlay->stale_activations.begin(); l != overlay->stale_activations.end(); l++)
+    {
+        smem_store_lti* lti = store->get_lti(*l);
+        
+        // crossing the threshold already set the edges to SMEM_ACT_MAX
+        if (lti && (lti->total_augmentations < thresh))
+        {
+            thisAgent->smem_stmts->act_set->bind_double(1, lti->act.activation_value);
+            thisAgent->smem_stmts->act_set->bind_int(2, (*l));
+            thisAgent->smem_stmts->act_set->execute(soar_module::op_reinit);
+        }
+    }
+    
+    overlay->stale_activations.clear();
+    
+    // commit transaction (if not lazy)
+    if (thisAgent->smem_params->lazy_commit->get_value() == off)
+    {
+        thisAgent->smem_stmts->commit->execute(soar_module::op_reinit);
+    }
+}
+
 
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
@@ -1500,6 +2579,11 @@ smem_lti_id smem_lti_get_id(agent* thisAgent, char name_letter, uint64_t name_nu
     // getting lti ids requires an open semantic database
     smem_attach(thisAgent);
     
+    if (thisAgent->smem_store)
+    {
+        return thisAgent->smem_store->find_lti(name_letter, name_number);
+    }
+    
     // soar_letter=? AND number=?
     thisAgent->smem_stmts->lti_get->bind_int(1, static_cast<uint64_t>(name_letter));
     thisAgent->smem_stmts->lti_get->bind_int(2, static_cast<uint64_t>(name_number));
@@ -1531,6 +2615,11 @@ inline smem_lti_id smem_lti_add_id(agent* thisAgent, char name_letter, uint64_t
     
     return_val = static_cast<smem_lti_id>(thisAgent->smem_db->last_insert_rowid());
     
+    if (thisAgent->smem_store)
+    {
+        thisAgent->smem_store->add_lti(return_val, name_letter, name_number);
+    }
+    
     // increment stat
     thisAgent->smem_stats->chunks->set_value(thisAgent->smem_stats->chunks->get_value() + 1);
     
@@ -1592,7 +2681,18 @@ Symbol* smem_lti_soar_make(agent* thisAgent, smem_lti_id lti, char name_letter,
 
 void smem_reset_id_counters(agent* thisAgent)
 {
-    if (thisAgent->smem_db->get_status() == soar_module::connected)
+    if (smem_read_only(thisAgent))
+    {
+        // the agent's own database holds no ltis
+        for (std::vector<smem_store_lti*>::iterator l = thisAgent->smem_store->ltis.begin(); l != thisAgent->smem_store->ltis.end(); l++)
+        {
+            if ((*l) && (thisAgent->id_counter[(*l)->letter - 'A' ] <= (*l)->number))
+            {
+                thisAgent->id_counter[(*l)->letter - 'A' ] = ((*l)->number + 1);
+            }
+        }
+    }
+    else if (thisAgent->smem_db->get_status() == soar_module::connected)
     {
         // soar_letter, max
         while (thisAgent->smem_stmts->lti_max->execute() == soar_module::row)
@@ -1636,6 +2736,72 @@ inline smem_slot* smem_make_slot(smem_slot_map* slots, Symbol* attr)
     return (*s);
 }
 
+// state of a bulk import: augmentations waiting for a multi-row
+// insert and the ltis to activate once loading is complete
+typedef struct smem_import_batch_struct
+{
+    std::vector< std::pair<smem_lti_id, smem_store_edge> > edges;
+    
+    std::vector<smem_lti_id> ltis;
+    std::set<smem_lti_id> lti_set;
+    
+    uint64_t clauses;
+} smem_import_batch;
+
+// edges go in at maximum activation; imported ltis are activated
+// (which resets sub-threshold edges) once loading is complete
+void smem_import_flush(agent* thisAgent, smem_import_batch* batch)
+{
+    soar_module::sqlite_statement* q;
+    double web_act = static_cast<double>(SMEM_ACT_MAX);
+    
+    if (batch->edges.size() == SMEM_IMPORT_BATCH_ROWS)
+    {
+        q = thisAgent->smem_stmts->web_add_batch;
+        
+        int param = 1;
+        for (std::vector< std::pair<smem_lti_id, smem_store_edge> >::iterator e = batch->edges.begin(); e != batch->edges.end(); e++)
+        {
+            q->bind_int(param++, e->first);
+            q->bind_int(param++, e->second.attr);
+            q->bind_int(param++, e->second.value_const);
+            q->bind_int(param++, e->second.value_lti);
+            q->bind_double(param++, web_act);
+        }
+        q->execute(soar_module::op_reinit);
+    }
+    else
+    {
+        q = thisAgent->smem_stmts->web_add;
+        
+        for (std::vector< std::pair<smem_lti_id, smem_store_edge> >::iterator e = batch->edges.begin(); e != batch->edges.end(); e++)
+        {
+            q->bind_int(1, e->first);
+            q->bind_int(2, e->second.attr);
+            q->bind_int(3, e->second.value_const);
+            q->bind_int(4, e->second.value_lti);
+            q->bind_double(5, web_act);
+            q->execute(soar_module::op_reinit);
+        }
+    }
+    
+    batch->edges.clear();
+}
+
+inline void smem_import_add_edge(agent* thisAgent, smem_import_batch* batch, smem_lti_id lti_id, smem_hash_id attr, smem_hash_id value_const, smem_lti_id value_lti)
+{
+    smem_store_edge e;
+    e.attr = attr;
+    e.value_const = value_const;
+    e.value_lti = value_lti;
+    
+    batch->edges.push_back(std::make_pair(lti_id, e));
+    if (batch->edges.size() == SMEM_IMPORT_BATCH_ROWS)
+    {
+        smem_import_flush(thisAgent, batch);
+    }
+}
+
 void smem_disconnect_chunk(agent* thisAgent, smem_lti_id lti_id)
 {
     // adjust attr, attr/value counts
@@ -1646,33 +2812,73 @@ void smem_disconnect_chunk(agent* thisAgent, smem_lti_id lti_id)
         std::set<smem_lti_id> distinct_attr;
         
         // pairs first, accumulate distinct attributes and pair count
-        thisAgent->smem_stmts->web_all->bind_int(1, lti_id);
-        while (thisAgent->smem_stmts->web_all->execute() == soar_module::row)
+        smem_store_edge_list old_edges;
+        if (thisAgent->smem_store)
+        {
+            smem_store_lti* lti = thisAgent->smem_store->get_lti(lti_id);
+            if (lti)
+            {
+                old_edges = lti->edges;
+            }
+        }
+        else
+        {
+            smem_store_edge e;
+            
+            thisAgent->smem_stmts->web_all->bind_int(1, lti_id);
+            while (thisAgent->smem_stmts->web_all->execute() == soar_module::row)
+            {
+                e.attr = thisAgent->smem_stmts->web_all->column_int(0);
+                e.value_const = thisAgent->smem_stmts->web_all->column_int(1);
+                e.value_lti = thisAgent->smem_stmts->web_all->column_int(2);
+                old_edges.push_back(e);
+            }
+            thisAgent->smem_stmts->web_all->reinitialize();
+        }
+        
+        for (smem_store_edge_list::iterator e = old_edges.begin(); e != old_edges.end(); e++)
         {
             pair_count++;
             
-            child_attr = thisAgent->smem_stmts->web_all->column_int(0);
+            child_attr = e->attr;
             distinct_attr.insert(child_attr);
             
             // null -> attr/lti
-            if (thisAgent->smem_stmts->web_all->column_int(1) != SMEM_AUGMENTATIONS_NULL)
+            if (e->value_const != SMEM_AUGMENTATIONS_NULL)
             {
                 // adjust in opposite direction ( adjust, attribute, const )
                 thisAgent->smem_stmts->wmes_constant_frequency_update->bind_int(1, -1);
                 thisAgent->smem_stmts->wmes_constant_frequency_update->bind_int(2, child_attr);
-                thisAgent->smem_stmts->wmes_constant_frequency_update->bind_int(3, thisAgent->smem_stmts->web_all->column_int(1));
+                thisAgent->smem_stmts->wmes_constant_frequency_update->bind_int(3, e->value_const);
                 thisAgent->smem_stmts->wmes_constant_frequency_update->execute(soar_module::op_reinit);
+                
+                if (thisAgent->smem_store)
+                {
+                    std::map<smem_store_const_key, int64_t>::iterator f = thisAgent->smem_store->constant_frequency.find(std::make_pair(child_attr, e->value_const));
+                    if (f != thisAgent->smem_store->constant_frequency.end())
+                    {
+                        f->second--;
+                    }
+                }
             }
             else
             {
                 // adjust in opposite direction ( adjust, attribute, lti )
                 thisAgent->smem_stmts->wmes_lti_frequency_update->bind_int(1, -1);
                 thisAgent->smem_stmts->wmes_lti_frequency_update->bind_int(2, child_attr);
-                thisAgent->smem_stmts->wmes_lti_frequency_update->bind_int(3, thisAgent->smem_stmts->web_all->column_int(2));
+                thisAgent->smem_stmts->wmes_lti_frequency_update->bind_int(3, e->value_lti);
                 thisAgent->smem_stmts->wmes_lti_frequency_update->execute(soar_module::op_reinit);
+                
+                if (thisAgent->smem_store)
+                {
+                    std::map<smem_store_lti_key, int64_t>::iterator f = thisAgent->smem_store->lti_frequency.find(std::make_pair(child_attr, e->value_lti));
+                    if (f != thisAgent->smem_store->lti_frequency.end())
+                    {
+                        f->second--;
+                    }
+                }
             }
         }
-        thisAgent->smem_stmts->web_all->reinitialize();
         
         // now attributes
         for (std::set<smem_lti_id>::iterator a = distinct_attr.begin(); a != distinct_attr.end(); a++)
@@ -1681,6 +2887,15 @@ void smem_disconnect_chunk(agent* thisAgent, smem_lti_id lti_id)
             thisAgent->smem_stmts->attribute_frequency_update->bind_int(1, -1);
             thisAgent->smem_stmts->attribute_frequency_update->bind_int(2, *a);
             thisAgent->smem_stmts->attribute_frequency_update->execute(soar_module::op_reinit);
+            
+            if (thisAgent->smem_store)
+            {
+                std::map<smem_hash_id, int64_t>::iterator f = thisAgent->smem_store->attribute_frequency.find(*a);
+                if (f != thisAgent->smem_store->attribute_frequency.end())
+                {
+                    f->second--;
+                }
+            }
         }
         
         // update local statistic
@@ -1691,11 +2906,25 @@ void smem_disconnect_chunk(agent* thisAgent, smem_lti_id lti_id)
     {
         thisAgent->smem_stmts->web_truncate->bind_int(1, lti_id);
         thisAgent->smem_stmts->web_truncate->execute(soar_module::op_reinit);
+        
+        if (thisAgent->smem_store)
+        {
+            thisAgent->smem_store->clear_edges(lti_id);
+        }
     }
 }
 
-void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* children, bool remove_old_children = true, Symbol* print_id = NULL, bool activate = true)
+// note: when batch is supplied (bulk import), new augmentations are
+//       buffered for multi-row inserts and the frequency tables are
+//       left for smem_import_chunks to recompute
+void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* children, bool remove_old_children = true, Symbol* print_id = NULL, bool activate = true, smem_import_batch* batch = NULL)
 {
+    // existing-edge checks below read the database unless the native store is on
+    if (batch && (!thisAgent->smem_store))
+    {
+        smem_import_flush(thisAgent, batch);
+    }
+    
     // if remove children, disconnect chunk -> no existing edges
     // else, need to query number of existing edges
     uint64_t existing_edges = 0;
@@ -1714,6 +2943,10 @@ void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* child
             xml_generate_warning(thisAgent, buf);
         }
     }
+    else if (thisAgent->smem_store)
+    {
+        existing_edges = thisAgent->smem_store->get_lti(lti_id)->total_augmentations;
+    }
     else
     {
         thisAgent->smem_stmts->act_lti_child_ct_get->bind_int(1, lti_id);
@@ -1744,6 +2977,13 @@ void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* child
             {
                 attr_new.insert(attr_hash);
             }
+            else if (thisAgent->smem_store)
+            {
+                if (!thisAgent->smem_store->has_edge(lti_id, attr_hash))
+                {
+                    attr_new.insert(attr_hash);
+                }
+            }
             else
             {
                 // lti_id, attribute_s_id
@@ -1765,6 +3005,13 @@ void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* child
                     {
                         const_new.insert(std::make_pair(attr_hash, value_hash));
                     }
+                    else if (thisAgent->smem_store)
+                    {
+                        if (!thisAgent->smem_store->has_edge(lti_id, attr_hash, value_hash, SMEM_AUGMENTATIONS_NULL))
+                        {
+                            const_new.insert(std::make_pair(attr_hash, value_hash));
+                        }
+                    }
                     else
                     {
                         // lti_id, attribute_s_id, val_const
@@ -1810,6 +3057,13 @@ void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* child
                     {
                         lti_new.insert(std::make_pair(attr_hash, value_lti));
                     }
+                    else if (thisAgent->smem_store)
+                    {
+                        if (!thisAgent->smem_store->has_edge(lti_id, attr_hash, SMEM_AUGMENTATIONS_NULL, value_lti))
+                        {
+                            lti_new.insert(std::make_pair(attr_hash, value_lti));
+                        }
+                    }
                     else
                     {
                         // lti_id, attribute_s_id, val_lti
@@ -1870,6 +3124,11 @@ void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* child
         thisAgent->smem_stmts->act_lti_child_ct_set->bind_int(1, new_edges);
         thisAgent->smem_stmts->act_lti_child_ct_set->bind_int(2, lti_id);
         thisAgent->smem_stmts->act_lti_child_ct_set->execute(soar_module::op_reinit);
+        
+        if (thisAgent->smem_store)
+        {
+            thisAgent->smem_store->get_lti(lti_id)->total_augmentations = new_edges;
+        }
     }
     
     // now we can safely activate the lti
@@ -1890,6 +3149,18 @@ void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* child
             for (std::set< std::pair< smem_hash_id, smem_hash_id > >::iterator p = const_new.begin(); p != const_new.end(); p++)
             {
                 // insert
+                if (batch)
+                {
+                    smem_import_add_edge(thisAgent, batch, lti_id, p->first, p->second, SMEM_AUGMENTATIONS_NULL);
+                    
+                    if (thisAgent->smem_store)
+                    {
+                        thisAgent->smem_store->add_edge(lti_id, p->first, p->second, SMEM_AUGMENTATIONS_NULL);
+                    }
+                    
+                    continue;
+                }
+                else
                 {
                     // lti_id, attribute_s_id, val_const, value_lti_id, activation_value
                     thisAgent->smem_stmts->web_add->bind_int(1, lti_id);
@@ -1898,14 +3169,38 @@ void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* child
                     thisAgent->smem_stmts->web_add->bind_int(4, SMEM_AUGMENTATIONS_NULL);
                     thisAgent->smem_stmts->web_add->bind_double(5, web_act);
                     thisAgent->smem_stmts->web_add->execute(soar_module::op_reinit);
+                    
+                    if (thisAgent->smem_store)
+                    {
+                        thisAgent->smem_store->add_edge(lti_id, p->first, p->second, SMEM_AUGMENTATIONS_NULL);
+                    }
                 }
                 
                 // update counter
                 {
                     // check if counter exists (and add if does not): attribute_s_id, val
-                    thisAgent->smem_stmts->wmes_constant_frequency_check->bind_int(1, p->first);
-                    thisAgent->smem_stmts->wmes_constant_frequency_check->bind_int(2, p->second);
-                    if (thisAgent->smem_stmts->wmes_constant_frequency_check->execute(soar_module::op_reinit) != soar_module::row)
+                    bool counter_exists;
+                    if (thisAgent->smem_store)
+                    {
+                        std::map<smem_store_const_key, int64_t>::iterator f = thisAgent->smem_store->constant_frequency.find(*p);
+                        counter_exists = (f != thisAgent->smem_store->constant_frequency.end());
+                        if (counter_exists)
+                        {
+                            f->second++;
+                        }
+                        else
+                        {
+                            thisAgent->smem_store->constant_frequency[ *p ] = 1;
+                        }
+                    }
+                    else
+                    {
+                        thisAgent->smem_stmts->wmes_constant_frequency_check->bind_int(1, p->first);
+                        thisAgent->smem_stmts->wmes_constant_frequency_check->bind_int(2, p->second);
+                        counter_exists = (thisAgent->smem_stmts->wmes_constant_frequency_check->execute(soar_module::op_reinit) == soar_module::row);
+                    }
+                    
+                    if (!counter_exists)
                     {
                         thisAgent->smem_stmts->wmes_constant_frequency_add->bind_int(1, p->first);
                         thisAgent->smem_stmts->wmes_constant_frequency_add->bind_int(2, p->second);
@@ -1928,6 +3223,18 @@ void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* child
             for (std::set< std::pair< smem_hash_id, smem_lti_id > >::iterator p = lti_new.begin(); p != lti_new.end(); p++)
             {
                 // insert
+                if (batch)
+                {
+                    smem_import_add_edge(thisAgent, batch, lti_id, p->first, SMEM_AUGMENTATIONS_NULL, p->second);
+                    
+                    if (thisAgent->smem_store)
+                    {
+                        thisAgent->smem_store->add_edge(lti_id, p->first, SMEM_AUGMENTATIONS_NULL, p->second);
+                    }
+                    
+                    continue;
+                }
+                else
                 {
                     // lti_id, attribute_s_id, val_const, value_lti_id, activation_value
                     thisAgent->smem_stmts->web_add->bind_int(1, lti_id);
@@ -1936,14 +3243,38 @@ void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* child
                     thisAgent->smem_stmts->web_add->bind_int(4, p->second);
                     thisAgent->smem_stmts->web_add->bind_double(5, web_act);
                     thisAgent->smem_stmts->web_add->execute(soar_module::op_reinit);
+                    
+                    if (thisAgent->smem_store)
+                    {
+                        thisAgent->smem_store->add_edge(lti_id, p->first, SMEM_AUGMENTATIONS_NULL, p->second);
+                    }
                 }
                 
                 // update counter
                 {
                     // check if counter exists (and add if does not): attribute_s_id, val
-                    thisAgent->smem_stmts->wmes_lti_frequency_check->bind_int(1, p->first);
-                    thisAgent->smem_stmts->wmes_lti_frequency_check->bind_int(2, p->second);
-                    if (thisAgent->smem_stmts->wmes_lti_frequency_check->execute(soar_module::op_reinit) != soar_module::row)
+                    bool counter_exists;
+                    if (thisAgent->smem_store)
+                    {
+                        std::map<smem_store_lti_key, int64_t>::iterator f = thisAgent->smem_store->lti_frequency.find(*p);
+                        counter_exists = (f != thisAgent->smem_store->lti_frequency.end());
+                        if (counter_exists)
+                        {
+                            f->second++;
+                        }
+                        else
+                        {
+                            thisAgent->smem_store->lti_frequency[ *p ] = 1;
+                        }
+                    }
+                    else
+                    {
+                        thisAgent->smem_stmts->wmes_lti_frequency_check->bind_int(1, p->first);
+                        thisAgent->smem_stmts->wmes_lti_frequency_check->bind_int(2, p->second);
+                        counter_exists = (thisAgent->smem_stmts->wmes_lti_frequency_check->execute(soar_module::op_reinit) == soar_module::row);
+                    }
+                    
+                    if (!counter_exists)
                     {
                         thisAgent->smem_stmts->wmes_lti_frequency_add->bind_int(1, p->first);
                         thisAgent->smem_stmts->wmes_lti_frequency_add->bind_int(2, p->second);
@@ -1962,12 +3293,32 @@ void smem_store_chunk(agent* thisAgent, smem_lti_id lti_id, smem_slot_map* child
         }
         
         // update attribute count
+        if (!batch)
         {
             for (std::set< smem_hash_id >::iterator a = attr_new.begin(); a != attr_new.end(); a++)
             {
                 // check if counter exists (and add if does not): attribute_s_id
-                thisAgent->smem_stmts->attribute_frequency_check->bind_int(1, *a);
-                if (thisAgent->smem_stmts->attribute_frequency_check->execute(soar_module::op_reinit) != soar_module::row)
+                bool counter_exists;
+                if (thisAgent->smem_store)
+                {
+                    std::map<smem_hash_id, int64_t>::iterator f = thisAgent->smem_store->attribute_frequency.find(*a);
+                    counter_exists = (f != thisAgent->smem_store->attribute_frequency.end());
+                    if (counter_exists)
+                    {
+                        f->second++;
+                    }
+                    else
+                    {
+                        thisAgent->smem_store->attribute_frequency[ *a ] = 1;
+                    }
+                }
+                else
+                {
+                    thisAgent->smem_stmts->attribute_frequency_check->bind_int(1, *a);
+                    counter_exists = (thisAgent->smem_stmts->attribute_frequency_check->execute(soar_module::op_reinit) == soar_module::row);
+                }
+                
+                if (!counter_exists)
                 {
                     thisAgent->smem_stmts->attribute_frequency_add->bind_int(1, *a);
                     thisAgent->smem_stmts->attribute_frequency_add->execute(soar_module::op_reinit);
@@ -2117,14 +3468,23 @@ void smem_install_memory(agent* thisAgent, Symbol* state, smem_lti_id lti_id, Sy
     bool lti_created_here = false;
     if (lti == NIL && install_type == wm_install)
     {
-        soar_module::sqlite_statement* q = thisAgent->smem_stmts->lti_letter_num;
-        
-        q->bind_int(1, lti_id);
-        q->execute();
-        
-        lti = smem_lti_soar_make(thisAgent, lti_id, static_cast<char>(q->column_int(0)), static_cast<uint64_t>(q->column_int(1)), result_header->id->level);
-        
-        q->reinitialize();
+        if (thisAgent->smem_store)
+        {
+            smem_store_lti* l = thisAgent->smem_store->get_lti(lti_id);
+            
+            lti = smem_lti_soar_make(thisAgent, lti_id, l->letter, l->number, result_header->id->level);
+        }
+        else
+        {
+            soar_module::sqlite_statement* q = thisAgent->smem_stmts->lti_letter_num;
+            
+            q->bind_int(1, lti_id);
+            q->execute();
+            
+            lti = smem_lti_soar_make(thisAgent, lti_id, static_cast<char>(q->column_int(0)), static_cast<uint64_t>(q->column_int(1)), result_header->id->level);
+            
+            q->reinitialize();
+        }
         
         lti_created_here = true;
     }
@@ -2161,39 +3521,72 @@ void smem_install_memory(agent* thisAgent, Symbol* state, smem_lti_id lti_id, Sy
         Symbol* attr_sym;
         Symbol* value_sym;
         
-        // get direct children: attr_type, attr_hash, value_type, value_hash, value_letter, value_num, value_lti
-        expand_q->bind_int(1, lti_id);
-        
         std::list<Symbol*> children;
         
-        while (expand_q->execute() == soar_module::row)
+        if (thisAgent->smem_store)
         {
-            // make the identifier symbol irrespective of value type
-            attr_sym = smem_reverse_hash(thisAgent, static_cast<byte>(expand_q->column_int(0)), static_cast<smem_hash_id>(expand_q->column_int(1)));
+            // direct children, in the same (attr, value) order as the database index
+            smem_store_edge_list& edges = thisAgent->smem_store->get_lti(lti_id)->edges;
             
-            // identifier vs. constant
-            if (expand_q->column_int(6) != SMEM_AUGMENTATIONS_NULL)
+            for (smem_store_edge_list::iterator e = edges.begin(); e != edges.end(); e++)
             {
-                value_sym = smem_lti_soar_make(thisAgent, static_cast<smem_lti_id>(expand_q->column_int(6)), static_cast<char>(expand_q->column_int(4)), static_cast<uint64_t>(expand_q->column_int(5)), lti->id->level);
-                if (depth > 1)
+                attr_sym = smem_reverse_hash(thisAgent, thisAgent->smem_store->get_symbol(e->attr)->symbol_type, e->attr);
+                
+                if (e->value_lti != SMEM_AUGMENTATIONS_NULL)
+                {
+                    smem_store_lti* v = thisAgent->smem_store->get_lti(e->value_lti);
+                    
+                    value_sym = smem_lti_soar_make(thisAgent, e->value_lti, v->letter, v->number, lti->id->level);
+                    if (depth > 1)
+                    {
+                        children.push_back(value_sym);
+                    }
+                }
+                else
                 {
-                    children.push_back(value_sym);
+                    value_sym = smem_reverse_hash(thisAgent, thisAgent->smem_store->get_symbol(e->value_const)->symbol_type, e->value_const);
                 }
+                
+                smem_buffer_add_wme(thisAgent, retrieval_wmes, lti, attr_sym, value_sym);
+                
+                symbol_remove_ref(thisAgent, attr_sym);
+                symbol_remove_ref(thisAgent, value_sym);
             }
-            else
+        }
+        else
+        {
+            // get direct children: attr_type, attr_hash, value_type, value_hash, value_letter, value_num, value_lti
+            expand_q->bind_int(1, lti_id);
+            
+            while (expand_q->execute() == soar_module::row)
             {
-                value_sym = smem_reverse_hash(thisAgent, static_cast<byte>(expand_q->column_int(2)), static_cast<smem_hash_id>(expand_q->column_int(3)));
-            }
+                // make the identifier symbol irrespective of value type
+                attr_sym = smem_reverse_hash(thisAgent, static_cast<byte>(expand_q->column_int(0)), static_cast<smem_hash_id>(expand_q->column_int(1)));
+            
+                // identifier vs. constant
+                if (expand_q->column_int(6) != SMEM_AUGMENTATIONS_NULL)
+                {
+                    value_sym = smem_lti_soar_make(thisAgent, static_cast<smem_lti_id>(expand_q->column_int(6)), static_cast<char>(expand_q->column_int(4)), static_cast<uint64_t>(expand_q->column_int(5)), lti->id->level);
+                    if (depth > 1)
+                    {
+                        children.push_back(value_sym);
+                    }
+                }
+                else
+                {
+                    value_sym = smem_reverse_hash(thisAgent, static_cast<byte>(expand_q->column_int(2)), static_cast<smem_hash_id>(expand_q->column_int(3)));
+                }
             
-            // add wme
-            smem_buffer_add_wme(thisAgent, retrieval_wmes, lti, attr_sym, value_sym);
+                // add wme
+                smem_buffer_add_wme(thisAgent, retrieval_wmes, lti, attr_sym, value_sym);
             
-            // deal with ref counts - attribute/values are always created in this function
-            // (thus an extra ref count is set before adding a wme)
-            symbol_remove_ref(thisAgent, attr_sym);
-            symbol_remove_ref(thisAgent, value_sym);
+                // deal with ref counts - attribute/values are always created in this function
+                // (thus an extra ref count is set before adding a wme)
+                symbol_remove_ref(thisAgent, attr_sym);
+                symbol_remove_ref(thisAgent, value_sym);
+            }
+            expand_q->reinitialize();
         }
-        expand_q->reinitialize();
         
         //Attempt to find children for the case of depth.
         std::list<Symbol*>::iterator iterator;
@@ -2217,6 +3610,196 @@ void smem_install_memory(agent* thisAgent, Symbol* state, smem_lti_id lti_id, Sy
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
 
+// native equivalent of the web_*_child checks in the candidate walk
+inline bool smem_store_check_candidate(agent* thisAgent, smem_lti_id cand, smem_weighted_cue_element* el)
+{
+    smem_native_store* store = thisAgent->smem_store;
+    bool has_feature = false;
+    
+    if (el->element_type == attr_t)
+    {
+        has_feature = store->has_edge(cand, el->attr_hash);
+    }
+    else if (el->element_type == value_const_t)
+    {
+        has_feature = store->has_edge(cand, el->attr_hash, el->value_hash, SMEM_AUGMENTATIONS_NULL);
+    }
+    else if (el->element_type == value_lti_t)
+    {
+        has_feature = store->has_edge(cand, el->attr_hash, SMEM_AUGMENTATIONS_NULL, el->value_lti);
+    }
+    
+    if ((el->mathElement != NIL) && has_feature)
+    {
+        // only numeric constants can satisfy a math query
+        bool mathQueryMet = false;
+        smem_store_lti* lti = store->get_lti(cand);
+        
+        for (smem_store_edge_list::iterator e = store->first_edge(lti, el->attr_hash); (e != lti->edges.end()) && (e->attr == el->attr_hash); e++)
+        {
+            smem_store_symbol* v = ((e->value_const != SMEM_AUGMENTATIONS_NULL) ? (store->get_symbol(e->value_const)) : (NULL));
+            if (v)
+            {
+                switch (v->symbol_type)
+                {
+                    case FLOAT_CONSTANT_SYMBOL_TYPE:
+                        mathQueryMet |= el->mathElement->valueIsAcceptable(v->float_value);
+                        break;
+                    case INT_CONSTANT_SYMBOL_TYPE:
+                        mathQueryMet |= el->mathElement->valueIsAcceptable(v->int_value);
+                        break;
+                }
+            }
+        }
+        
+        return mathQueryMet;
+    }
+    
+    return ((el->pos_element) ? (has_feature) : (!has_feature));
+}
+
+// the candidates of a cue element in order of activation: the
+// store's list, less the ltis queued separately because their
+// activation for this agent is not the one they are listed under
+typedef struct smem_store_candidate_walk_struct
+{
+    smem_store_lti_list* cands;
+    smem_store_lti_list::iterator next;
+    std::set<smem_lti_id> queued;
+} smem_store_candidate_walk;
+
+inline bool smem_store_walk_valid(smem_store_candidate_walk& walk)
+{
+    if (!walk.cands)
+    {
+        return false;
+    }
+    
+    while ((walk.next != walk.cands->end()) && (walk.queued.find(walk.next->second) != walk.queued.end()))
+    {
+        walk.next++;
+    }
+    
+    return (walk.next != walk.cands->end());
+}
+
+inline void smem_store_queue_candidate(agent* thisAgent, smem_lti_id lti_id, bool spreading, smem_prioritized_activated_lti_queue& queue)
+{
+    double act = thisAgent->smem_overlay->peek_act(lti_id)->activation_value;
+    if (spreading)
+    {
+        act += thisAgent->smem_overlay->get_spread(lti_id);
+    }
+    queue.push(std::make_pair(act, lti_id));
+}
+
+// sets up the walk of a cue element's candidates from the native
+// index.  Only the ltis whose activation here differs from their
+// listing (copied into a shared store's overlay, or reached by
+// spreading) are queued, so the query reads no more of the list
+// than it walks.  With naive base-level updates every candidate is
+// brought up to date (and queued) first, as the database does.
+inline void smem_store_queue_candidates(agent* thisAgent, smem_weighted_cue_element* el, smem_prioritized_activated_lti_queue& queue, smem_store_candidate_walk& walk)
+{
+    smem_store_lti_list* cands = NULL;
+    
+    walk.cands = NULL;
+    walk.queued.clear();
+    
+    if (el->element_type == attr_t)
+    {
+        cands = thisAgent->smem_store->get_candidates(el->attr_hash, SMEM_AUGMENTATIONS_NULL, SMEM_AUGMENTATIONS_NULL);
+    }
+    else if (el->element_type == value_const_t)
+    {
+        cands = thisAgent->smem_store->get_candidates(el->attr_hash, el->value_hash, SMEM_AUGMENTATIONS_NULL);
+    }
+    else if (el->element_type == value_lti_t)
+    {
+        cands = thisAgent->smem_store->get_candidates(el->attr_hash, SMEM_AUGMENTATIONS_NULL, el->value_lti);
+    }
+    
+    if (!cands || cands->empty())
+    {
+        return;
+    }
+    
+    smem_store_overlay* overlay = thisAgent->smem_overlay;
+    bool naive = ((thisAgent->smem_params->activation_mode->get_value() == smem_param_container::act_base) &&
+                  (thisAgent->smem_params->base_update->get_value() == smem_param_container::bupt_naive));
+    bool spreading = (thisAgent->smem_params->spreading->get_value() == on);
+    
+    if (spreading)
+    {
+        ////////////////////////////////////////////////////////////////////////////
+        thisAgent->smem_timers->spread->start();
+        ////////////////////////////////////////////////////////////////////////////
+        
+        overlay->spread_update(static_cast<uint64_t>(thisAgent->smem_params->spreading_depth->get_value()),
+                               static_cast<uint64_t>(thisAgent->smem_params->spreading_limit->get_value()),
+                               static_cast<uint64_t>(thisAgent->smem_params->spreading_budget->get_value()));
+                                             
+        ////////////////////////////////////////////////////////////////////////////
+        thisAgent->smem_timers->spread->stop();
+        ////////////////////////////////////////////////////////////////////////////
+    }
+    
+    size_t overrides = (((overlay->shared) ? (overlay->activations.size()) : (0)) + ((spreading) ? (overlay->spread.size()) : (0)));
+    
+    if (naive || (overrides >= cands->size()))
+    {
+        // updating moves ltis within the list, so it is copied first
+        std::vector<smem_lti_id> ids;
+        ids.reserve(cands->size());
+        for (smem_store_lti_list::iterator c = cands->begin(); c != cands->end(); c++)
+        {
+            ids.push_back(c->second);
+        }
+        
+        for (std::vector<smem_lti_id>::iterator c = ids.begin(); c != ids.end(); c++)
+        {
+            if (naive)
+            {
+                smem_lti_activate(thisAgent, (*c), false);
+            }
+            smem_store_queue_candidate(thisAgent, (*c), spreading, queue);
+        }
+        
+        return;
+    }
+    
+    if (overlay->shared)
+    {
+        for (std::map<smem_lti_id, smem_store_activation>::iterator a = overlay->activations.begin(); a != overlay->activations.end(); a++)
+        {
+            if (cands->count(std::make_pair(thisAgent->smem_store->get_lti(a->first)->act.activation_value, a->first)))
+            {
+                walk.queued.insert(a->first);
+            }
+        }
+    }
+    
+    if (spreading)
+    {
+        for (smem_spread_map::iterator p = overlay->spread.begin(); p != overlay->spread.end(); p++)
+        {
+            smem_store_lti* lti = thisAgent->smem_store->get_lti(p->first);
+            if (lti && cands->count(std::make_pair(lti->act.activation_value, p->first)))
+            {
+                walk.queued.insert(p->first);
+            }
+        }
+    }
+    
+    for (std::set<smem_lti_id>::iterator q = walk.queued.begin(); q != walk.queued.end(); q++)
+    {
+        smem_store_queue_candidate(thisAgent, (*q), spreading, queue);
+    }
+    
+    walk.cands = cands;
+    walk.next = cands->begin();
+}
+
 inline soar_module::sqlite_statement* smem_setup_web_crawl(agent* thisAgent, smem_weighted_cue_element* el)
 {
     soar_module::sqlite_statement* q = NULL;
@@ -2258,6 +3841,8 @@ inline bool _smem_process_cue_wme(agent* thisAgent, wme* w, bool pos_cue, smem_p
     smem_cue_element_type element_type;
     
     soar_module::sqlite_statement* q = NULL;
+    bool has_frequency = false;
+    int64_t frequency = 0;
     
     {
         // we only have to do hard work if
@@ -2270,7 +3855,13 @@ inline bool _smem_process_cue_wme(agent* thisAgent, wme* w, bool pos_cue, smem_p
                 value_hash = smem_temporal_hash(thisAgent, w->value, false);
                 element_type = value_const_t;
                 
-                if (value_hash != NIL)
+                if ((value_hash != NIL) && thisAgent->smem_store)
+                {
+                    std::map<smem_store_const_key, int64_t>::iterator f = thisAgent->smem_store->constant_frequency.find(std::make_pair(attr_hash, value_hash));
+                    has_frequency = (f != thisAgent->smem_store->constant_frequency.end());
+                    frequency = ((has_frequency) ? (f->second) : (0));
+                }
+                else if (value_hash != NIL)
                 {
                     q = thisAgent->smem_stmts->wmes_constant_frequency_get;
                     q->bind_int(1, attr_hash);
@@ -2303,16 +3894,34 @@ inline bool _smem_process_cue_wme(agent* thisAgent, wme* w, bool pos_cue, smem_p
                 
                 if (value_lti == NIL)
                 {
-                    q = thisAgent->smem_stmts->attribute_frequency_get;
-                    q->bind_int(1, attr_hash);
+                    if (thisAgent->smem_store)
+                    {
+                        std::map<smem_hash_id, int64_t>::iterator f = thisAgent->smem_store->attribute_frequency.find(attr_hash);
+                        has_frequency = (f != thisAgent->smem_store->attribute_frequency.end());
+                        frequency = ((has_frequency) ? (f->second) : (0));
+                    }
+                    else
+                    {
+                        q = thisAgent->smem_stmts->attribute_frequency_get;
+                        q->bind_int(1, attr_hash);
+                    }
                     
                     element_type = attr_t;
                 }
                 else
                 {
-                    q = thisAgent->smem_stmts->wmes_lti_frequency_get;
-                    q->bind_int(1, attr_hash);
-                    q->bind_int(2, value_lti);
+                    if (thisAgent->smem_store)
+                    {
+                        std::map<smem_store_lti_key, int64_t>::iterator f = thisAgent->smem_store->lti_frequency.find(std::make_pair(attr_hash, value_lti));
+                        has_frequency = (f != thisAgent->smem_store->lti_frequency.end());
+                        frequency = ((has_frequency) ? (f->second) : (0));
+                    }
+                    else
+                    {
+                        q = thisAgent->smem_stmts->wmes_lti_frequency_get;
+                        q->bind_int(1, attr_hash);
+                        q->bind_int(2, value_lti);
+                    }
                     
                     element_type = value_lti_t;
                 }
@@ -2320,11 +3929,18 @@ inline bool _smem_process_cue_wme(agent* thisAgent, wme* w, bool pos_cue, smem_p
             
             if (good_wme)
             {
-                if (q->execute() == soar_module::row)
+                if (q)
+                {
+                    has_frequency = (q->execute() == soar_module::row);
+                    frequency = ((has_frequency) ? (q->column_int(0)) : (0));
+                    q->reinitialize();
+                }
+                
+                if (has_frequency)
                 {
                     new_cue_element = new smem_weighted_cue_element;
                     
-                    new_cue_element->weight = q->column_int(0);
+                    new_cue_element->weight = frequency;
                     new_cue_element->attr_hash = attr_hash;
                     new_cue_element->value_hash = value_hash;
                     new_cue_element->value_lti = value_lti;
@@ -2344,8 +3960,6 @@ inline bool _smem_process_cue_wme(agent* thisAgent, wme* w, bool pos_cue, smem_p
                         good_wme = false;
                     }
                 }
-                
-                q->reinitialize();
             }
         }
         else
@@ -2634,8 +4248,8 @@ smem_lti_id smem_process_query(agent* thisAgent, Symbol* state, Symbol* query, S
         {
             // naive base-level updates means update activation of
             // every candidate in the minimal list before the
-            // confirmation walk
-            if (thisAgent->smem_params->base_update->get_value() == smem_param_container::bupt_naive)
+            // confirmation walk (the native index does so as it reads)
+            if ((thisAgent->smem_params->base_update->get_value() == smem_param_container::bupt_naive) && (!thisAgent->smem_store))
             {
                 q = smem_setup_web_crawl(thisAgent, (*cand_set));
                 
@@ -2658,16 +4272,23 @@ smem_lti_id smem_process_query(agent* thisAgent, Symbol* state, Symbol* query, S
             }
         }
         
-        // setup first query, which is sorted on activation already
-        q = smem_setup_web_crawl(thisAgent, (*cand_set));
+        smem_prioritized_activated_lti_queue plentiful_parents;
+        smem_store_candidate_walk store_walk;
+        bool more_rows = false;
         
-        // this becomes the minimal set to walk (till match or fail)
-        if (q->execute() == soar_module::row)
+        if (thisAgent->smem_store)
         {
-            smem_prioritized_activated_lti_queue plentiful_parents;
-            bool more_rows = true;
-            bool use_db = false;
-            bool has_feature = false;
+            // native index: its list stands in for the sorted query,
+            // and the queue holds the ltis that are out of its order
+            q = NULL;
+            smem_store_queue_candidates(thisAgent, (*cand_set), plentiful_parents, store_walk);
+            more_rows = smem_store_walk_valid(store_walk);
+        }
+        else
+        {
+            // setup first query, which is sorted on activation already
+            q = smem_setup_web_crawl(thisAgent, (*cand_set));
+            more_rows = (q->execute() == soar_module::row);
             
             while (more_rows && (q->column_double(1) == static_cast<double>(SMEM_ACT_MAX)))
             {
@@ -2678,6 +4299,14 @@ smem_lti_id smem_process_query(agent* thisAgent, Symbol* state, Symbol* query, S
                 
                 more_rows = (q->execute() == soar_module::row);
             }
+        }
+        
+        // this becomes the minimal set to walk (till match or fail)
+        if (more_rows || (!plentiful_parents.empty()))
+        {
+            bool use_db = false;
+            bool has_feature = false;
+            
             bool first_element = false;
             while (((match_ids->size() < number_to_retrieve) || (needFullSearch)) && ((more_rows) || (!plentiful_parents.empty())))
             {
@@ -2695,10 +4324,16 @@ smem_lti_id smem_process_query(agent* thisAgent, Symbol* state, Symbol* query, S
                     }
                     else
                     {
-                        use_db = (q->column_double(1) >  plentiful_parents.top().first);
+                        use_db = (((q) ? (q->column_double(1)) : (store_walk.next->first)) >  plentiful_parents.top().first);
                     }
                     
-                    if (use_db)
+                    if (use_db && (!q))
+                    {
+                        cand = store_walk.next->second;
+                        store_walk.next++;
+                        more_rows = smem_store_walk_valid(store_walk);
+                    }
+                    else if (use_db)
                     {
                         cand = q->column_int(0);
                         more_rows = (q->execute() == soar_module::row);
@@ -2725,6 +4360,17 @@ smem_lti_id smem_process_query(agent* thisAgent, Symbol* state, Symbol* query, S
                             continue;
                         }
                         
+                        if (thisAgent->smem_store)
+                        {
+                            good_cand = smem_store_check_candidate(thisAgent, cand, (*next_element));
+                            if (!good_cand)
+                            {
+                                break;
+                            }
+                            
+                            continue;
+                        }
+                        
                         if ((*next_element)->element_type == attr_t)
                         {
                             // parent=? AND attribute_s_id=?
@@ -2823,7 +4469,11 @@ smem_lti_id smem_process_query(agent* thisAgent, Symbol* state, Symbol* query, S
 //                king_id = match_ids->front();
 //            }
         }
-        q->reinitialize();
+        
+        if (q)
+        {
+            q->reinitialize();
+        }
         
         // clean weighted cue
         for (next_element = weighted_cue.begin(); next_element != weighted_cue.end(); next_element++)
@@ -3003,6 +4653,87 @@ inline void smem_update_schema_one_to_two(agent* thisAgent)
     thisAgent->smem_db->sql_execute("COMMIT");
 }
 
+// Shared stores, by database path.  A loaded store is only
+// read, but agents can attach to (and release) stores from
+// several threads at once when they are run in parallel,
+// so the registry has a lock.
+typedef struct smem_shared_store_struct
+{
+    smem_native_store* store;
+    uint64_t refs;
+} smem_shared_store;
+
+static std::map<std::string, smem_shared_store> smem_shared_stores;
+
+// never freed, so it outlives any agent
+static soar_thread::Mutex* smem_shared_stores_mutex()
+{
+    static soar_thread::Mutex* pMutex = new soar_thread::Mutex();
+    return pMutex;
+}
+
+// returns the store for path, reading it (read-only) on first use
+// (with a copy of its persistent variables, taken under the lock)
+smem_native_store* smem_shared_acquire(const char* path, std::map<smem_variable_key, int64_t>& variables, std::string& err)
+{
+    soar_thread::Lock lock(smem_shared_stores_mutex());
+    
+    std::map<std::string, smem_shared_store>::iterator p = smem_shared_stores.find(path);
+    if (p != smem_shared_stores.end())
+    {
+        p->second.refs++;
+        variables = p->second.store->variables;
+        return p->second.store;
+    }
+    
+    soar_module::sqlite_database db;
+    db.connect(path, SQLITE_OPEN_READONLY);
+    if (db.get_status() != soar_module::connected)
+    {
+        err.assign(db.get_errmsg());
+        return NULL;
+    }
+    
+    std::string schema_version;
+    if ((!db.sql_simple_get_string("SELECT version_number FROM versions WHERE system = 'smem_schema'", schema_version)) || (schema_version != SMEM_SCHEMA_VERSION))
+    {
+        err.assign("Not a semantic memory database with schema version " SMEM_SCHEMA_VERSION ".");
+        db.disconnect();
+        return NULL;
+    }
+    
+    smem_shared_store shared_store;
+    shared_store.store = new smem_native_store();
+    shared_store.store->load(&db);
+    shared_store.store->index_last_access();
+    shared_store.refs = 1;
+    db.disconnect();
+    
+    smem_shared_stores[ path ] = shared_store;
+    variables = shared_store.store->variables;
+    
+    return shared_store.store;
+}
+
+// the last agent to release a store frees it
+void smem_shared_release(smem_native_store* store)
+{
+    soar_thread::Lock lock(smem_shared_stores_mutex());
+    
+    for (std::map<std::string, smem_shared_store>::iterator p = smem_shared_stores.begin(); p != smem_shared_stores.end(); p++)
+    {
+        if (p->second.store == store)
+        {
+            if ((--p->second.refs) == 0)
+            {
+                delete store;
+                smem_shared_stores.erase(p);
+            }
+            return;
+        }
+    }
+}
+
 // opens the SQLite database and performs all initialization required for the current mode
 void smem_init_db(agent* thisAgent)
 {
@@ -3018,12 +4749,21 @@ void smem_init_db(agent* thisAgent)
     const char* db_path;
     bool tabula_rasa;
     
+    // the agent's own database only holds its variables when sharing
+    bool shared = ((thisAgent->smem_params->shared->get_value() == on) && (thisAgent->smem_params->database->get_value() == smem_param_container::file));
+    
     if (thisAgent->smem_params->database->get_value() == smem_param_container::memory)
     {
         db_path = ":memory:";
         tabula_rasa = true;
         print_sysparam_trace(thisAgent, TRACE_SMEM_SYSPARAM, "Initializing semantic memory database in cpu memory.\n");
     }
+    else if (shared)
+    {
+        db_path = ":memory:";
+        tabula_rasa = true;
+        print_sysparam_trace(thisAgent, TRACE_SMEM_SYSPARAM, "Initializing shared semantic memory store at %s\n", thisAgent->smem_params->path->get_value());
+    }
     else
     {
         db_path = thisAgent->smem_params->path->get_value();
@@ -3264,6 +5004,38 @@ void smem_init_db(agent* thisAgent)
             thisAgent->smem_params->activation_mode->set_value(static_cast< smem_param_container::act_choices >(temp));
         }
         
+        // use (or read) the kernel-wide copy of the store
+        if (shared)
+        {
+            std::string err;
+            std::map<smem_variable_key, int64_t> vars;
+            thisAgent->smem_store = smem_shared_acquire(thisAgent->smem_params->path->get_value(), vars, err);
+            
+            if (thisAgent->smem_store)
+            {
+                thisAgent->smem_overlay = new smem_store_overlay(thisAgent->smem_store, true);
+                
+                thisAgent->smem_max_cycle = vars[ var_max_cycle ];
+                thisAgent->smem_stats->chunks->set_value(vars[ var_num_nodes ]);
+                thisAgent->smem_stats->slots->set_value(vars[ var_num_edges ]);
+                thisAgent->smem_params->thresh->set_value(vars[ var_act_thresh ]);
+                thisAgent->smem_params->activation_mode->set_value(static_cast< smem_param_container::act_choices >(vars[ var_act_mode ]));
+            }
+            else
+            {
+                print_sysparam_trace(thisAgent, 0, "Semantic memory shared store error: %s\n...Using an unshared memory-based database.\n", err.c_str());
+            }
+        }
+        
+        // read the store into process memory
+        if ((!thisAgent->smem_store) && (thisAgent->smem_params->native_store->get_value() == on))
+        {
+            thisAgent->smem_store = new smem_native_store();
+            thisAgent->smem_store->load(thisAgent->smem_db);
+            thisAgent->smem_store->log_edge_changes = (thisAgent->smem_params->spreading->get_value() == on);
+            thisAgent->smem_overlay = new smem_store_overlay(thisAgent->smem_store, false);
+        }
+        
         // reset identifier counters
         smem_reset_id_counters(thisAgent);
         
@@ -3289,6 +5061,11 @@ void smem_attach(agent* thisAgent)
 
 inline void _smem_close_vars(agent* thisAgent)
 {
+    if (thisAgent->smem_overlay)
+    {
+        smem_store_flush_activations(thisAgent);
+    }
+    
     // store max cycle for future use of the smem database
     smem_variable_set(thisAgent, var_max_cycle, thisAgent->smem_max_cycle);
     
@@ -3313,6 +5090,20 @@ void smem_close(agent* thisAgent)
         // de-allocate common statements
         delete thisAgent->smem_stmts;
         
+        // de-allocate the native store (or release the shared one)
+        if (smem_read_only(thisAgent))
+        {
+            smem_shared_release(thisAgent->smem_store);
+        }
+        else
+        {
+            delete thisAgent->smem_store;
+        }
+        thisAgent->smem_store = NIL;
+        
+        delete thisAgent->smem_overlay;
+        thisAgent->smem_overlay = NIL;
+        
         // close the database
         thisAgent->smem_db->disconnect();
     }
@@ -3759,7 +5550,8 @@ bool smem_parse_chunk(agent* thisAgent, smem_str_to_chunk_map* chunks, smem_chun
     return return_val;
 }
 
-bool smem_parse_chunks(agent* thisAgent, const char* chunks_str, std::string** err_msg)
+// with store false, the chunks are only checked for errors
+bool _smem_parse_chunks(agent* thisAgent, const char* chunks_str, std::string** err_msg, smem_import_batch* batch, bool store = true)
 {
     bool return_val = false;
     uint64_t clause_count = 0;
@@ -3767,6 +5559,12 @@ bool smem_parse_chunks(agent* thisAgent, const char* chunks_str, std::string** e
     // parsing chunks requires an open semantic database
     smem_attach(thisAgent);
     
+    if (smem_read_only(thisAgent))
+    {
+        (*err_msg)->append("Semantic memory is shared and cannot be changed.");
+        return false;
+    }
+    
     // copied primarily from cli_sp
     thisAgent->alternate_input_string = chunks_str;
     thisAgent->alternate_input_suffix = const_cast<char*>(") ");
@@ -3797,8 +5595,8 @@ bool smem_parse_chunks(agent* thisAgent, const char* chunks_str, std::string** e
         
         if (good_chunk)
         {
-            // add all newbie lti's as appropriate
-            for (c_new = newbies.begin(); c_new != newbies.end(); c_new++)
+            // add all newbie lti's as appropriate (unless only checking)
+            for (c_new = newbies.begin(); (c_new != newbies.end()) && store; c_new++)
             {
                 if ((*c_new)->lti_id == NIL)
                 {
@@ -3840,11 +5638,17 @@ bool smem_parse_chunks(agent* thisAgent, const char* chunks_str, std::string** e
             }
             
             // add all newbie contents (append, as opposed to replace, children)
-            for (c_new = newbies.begin(); c_new != newbies.end(); c_new++)
+            for (c_new = newbies.begin(); (c_new != newbies.end()) && store; c_new++)
             {
                 if ((*c_new)->slots != NIL)
                 {
-                    smem_store_chunk(thisAgent, (*c_new)->lti_id, (*c_new)->slots, false);
+                    // a bulk import activates each lti once, after loading
+                    smem_store_chunk(thisAgent, (*c_new)->lti_id, (*c_new)->slots, false, NULL, (batch == NULL), batch);
+                    
+                    if (batch && batch->lti_set.insert((*c_new)->lti_id).second)
+                    {
+                        batch->ltis.push_back((*c_new)->lti_id);
+                    }
                 }
             }
             
@@ -3857,6 +5661,16 @@ bool smem_parse_chunks(agent* thisAgent, const char* chunks_str, std::string** e
             // increment clause counter
             clause_count++;
             
+            if (batch)
+            {
+                batch->clauses++;
+                
+                if ((batch->clauses % SMEM_IMPORT_PROGRESS) == 0)
+                {
+                    print_sysparam_trace(thisAgent, TRACE_SMEM_SYSPARAM, "SMEM import: %llu clauses, %llu ltis\n", static_cast<long long unsigned>(batch->clauses), static_cast<long long unsigned>(batch->ltis.size()));
+                }
+            }
+            
             // clear newbie list
             newbies.clear();
         }
@@ -3885,6 +5699,217 @@ bool smem_parse_chunks(agent* thisAgent, const char* chunks_str, std::string** e
     return return_val;
 }
 
+bool smem_parse_chunks(agent* thisAgent, const char* chunks_str, std::string** err_msg)
+{
+    return _smem_parse_chunks(thisAgent, chunks_str, err_msg, NULL);
+}
+
+// collects the bodies of the "smem --add {...}" (or "smem -a {...}")
+// commands in a source file, and the lines they start on, splitting
+// it into commands and words as the command line interface does when
+// it sources the file (so comments, quoting and other commands'
+// braces are treated the same way)
+class smem_import_add_collector: public soar::tokenizer_callback
+{
+    public:
+        smem_import_add_collector(soar::tokenizer& new_source, std::vector<std::string>& new_chunks, std::vector<int>& new_lines): source(new_source), chunks(new_chunks), lines(new_lines) {}
+    
+        bool handle_command(std::vector<std::string>& argv)
+        {
+            if ((argv.size() == 3) && (argv[0] == "smem") && ((argv[1] == "--add") || (argv[1] == "-a")))
+            {
+                chunks.push_back(argv[2]);
+                lines.push_back(source.get_command_line_number());
+            }
+        
+            return true;
+        }
+        
+    private:
+        soar::tokenizer& source;
+        std::vector<std::string>& chunks;
+        std::vector<int>& lines;
+};
+
+bool smem_import_extract_adds(const std::string& source, std::vector<std::string>& chunks, std::vector<int>& lines, std::string** err_msg)
+{
+    soar::tokenizer tokenizer;
+    smem_import_add_collector collector(tokenizer, chunks, lines);
+    
+    tokenizer.set_handler(&collector);
+    if (!tokenizer.evaluate(source.c_str()))
+    {
+        std::string num;
+        to_string(tokenizer.get_current_line_number(), num);
+        
+        (*err_msg)->append("Error reading line ");
+        (*err_msg)->append(num);
+        if (tokenizer.get_error_string())
+        {
+            (*err_msg)->append(": ");
+            (*err_msg)->append(tokenizer.get_error_string());
+        }
+        
+        return false;
+    }
+        
+    return true;
+}
+
+bool smem_import_chunks(agent* thisAgent, const char* file_path, std::string** err_msg, std::string** result_message)
+{
+    soar_timer import_timer;
+    import_timer.start();
+    
+    // importing requires an open semantic database
+    smem_attach(thisAgent);
+    
+    if (smem_read_only(thisAgent))
+    {
+        (*err_msg)->append("Semantic memory is shared and cannot be changed.");
+        return false;
+    }
+    
+    // variables are scoped to a single --add, so each is parsed on its own
+    std::vector<std::string> chunks;
+    std::vector<int> lines;
+    {
+        std::ifstream in(file_path, std::ios::in | std::ios::binary);
+        if (!in)
+        {
+            (*err_msg)->append("Could not open file: ");
+            (*err_msg)->append(file_path);
+            return false;
+        }
+        
+        std::string source((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        
+        // either raw clauses or a source file with smem --add commands
+        size_t first = source.find_first_not_of(" \t\r\n");
+        if ((first != std::string::npos) && (source[ first ] == '('))
+        {
+            chunks.push_back(source);
+            lines.push_back(0);
+        }
+        else if (!smem_import_extract_adds(source, chunks, lines, err_msg))
+        {
+            return false;
+        }
+    }
+    
+    if (chunks.empty())
+    {
+        (*err_msg)->append("No semantic memory clauses found in file: ");
+        (*err_msg)->append(file_path);
+        return false;
+    }
+    
+    // every clause is checked before any is stored, so a parse error
+    // leaves semantic memory as it was (with the default optimization,
+    // the database has no journal, so a rollback couldn't undo writes)
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        if (!_smem_parse_chunks(thisAgent, chunks[ i ].c_str(), err_msg, NULL, false))
+        {
+            if (lines[ i ])
+            {
+                std::string num;
+                to_string(lines[ i ], num);
+                
+                (*err_msg)->append(" of the smem --add on line ");
+                (*err_msg)->append(num);
+            }
+            (*err_msg)->append(". Nothing was imported.");
+            
+            return false;
+        }
+    }
+    
+    // start transaction (if not lazy)
+    bool own_transaction = (thisAgent->smem_params->lazy_commit->get_value() == off);
+    if (own_transaction)
+    {
+        thisAgent->smem_stmts->begin->execute(soar_module::op_reinit);
+    }
+    
+    uint64_t edges_before = thisAgent->smem_stats->slots->get_value();
+    
+    smem_import_batch batch;
+    batch.clauses = 0;
+    
+    smem_statement_container::drop_retrieval_indices(thisAgent);
+    
+    for (std::vector<std::string>::iterator c = chunks.begin(); c != chunks.end(); c++)
+    {
+        _smem_parse_chunks(thisAgent, c->c_str(), err_msg, &(batch));
+    }
+    smem_import_flush(thisAgent, &(batch));
+    
+    // frequencies: one recount, as opposed to an update per edge
+    {
+        thisAgent->smem_db->sql_execute("DELETE FROM smem_attribute_frequency");
+        thisAgent->smem_db->sql_execute("INSERT INTO smem_attribute_frequency (attribute_s_id, edge_frequency) SELECT attribute_s_id, COUNT(DISTINCT lti_id) FROM smem_augmentations GROUP BY attribute_s_id");
+        
+        thisAgent->smem_db->sql_execute("DELETE FROM smem_wmes_constant_frequency");
+        thisAgent->smem_db->sql_execute("INSERT INTO smem_wmes_constant_frequency (attribute_s_id, value_constant_s_id, edge_frequency) SELECT attribute_s_id, value_constant_s_id, COUNT(*) FROM smem_augmentations WHERE value_lti_id=0 GROUP BY attribute_s_id, value_constant_s_id");
+        
+        thisAgent->smem_db->sql_execute("DELETE FROM smem_wmes_lti_frequency");
+        thisAgent->smem_db->sql_execute("INSERT INTO smem_wmes_lti_frequency (attribute_s_id, value_lti_id, edge_frequency) SELECT attribute_s_id, value_lti_id, COUNT(*) FROM smem_augmentations WHERE value_constant_s_id=0 GROUP BY attribute_s_id, value_lti_id");
+        
+        if (thisAgent->smem_store)
+        {
+            thisAgent->smem_store->load_frequencies(thisAgent->smem_db);
+        }
+    }
+    
+    // activations: one pass, in order of first appearance
+    for (std::vector<smem_lti_id>::iterator l = batch.ltis.begin(); l != batch.ltis.end(); l++)
+    {
+        smem_lti_activate(thisAgent, (*l), true);
+    }
+    
+    smem_statement_container::create_retrieval_indices(thisAgent);
+    
+    // commit transaction (if not lazy)
+    if (own_transaction)
+    {
+        thisAgent->smem_stmts->commit->execute(soar_module::op_reinit);
+    }
+    
+    import_timer.stop();
+    
+    // summary
+    {
+        double secs = (import_timer.get_usec() / 1000000.0);
+        uint64_t edges = (thisAgent->smem_stats->slots->get_value() - edges_before);
+        
+        std::string temp;
+        (*result_message)->append("Imported ");
+        to_string(batch.clauses, temp);
+        (*result_message)->append(temp);
+        (*result_message)->append(" clauses (");
+        to_string(static_cast<uint64_t>(batch.ltis.size()), temp);
+        (*result_message)->append(temp);
+        (*result_message)->append(" ltis, ");
+        to_string(edges, temp);
+        (*result_message)->append(temp);
+        (*result_message)->append(" augmentations) in ");
+        to_string(secs, temp, 3, true);
+        (*result_message)->append(temp);
+        (*result_message)->append(" sec");
+        if (secs > 0)
+        {
+            to_string(static_cast<uint64_t>(batch.clauses / secs), temp);
+            (*result_message)->append(" (");
+            (*result_message)->append(temp);
+            (*result_message)->append(" clauses/sec)");
+        }
+        (*result_message)->append(".");
+    }
+    
+    return true;
+}
+
 /* The following function is supposed to read in the lexemes
  * and turn them into the cue wme for a call to smem_process_query.
  * This is intended to be run from the command line and does not yet have
@@ -4215,6 +6240,12 @@ bool smem_parse_remove(agent* thisAgent, const char* chunks_str, std::string** e
     //parsing chunks requires an open semantic database
     smem_attach(thisAgent);
     
+    if (smem_read_only(thisAgent))
+    {
+        (*err_msg)->append("Semantic memory is shared and cannot be changed.");
+        return false;
+    }
+    
     //copied primarily from cli_sp
     thisAgent->alternate_input_string = chunks_str;
     thisAgent->alternate_input_suffix = const_cast<char*>(") ");
@@ -4556,7 +6587,7 @@ void smem_respond_to_cmd(agent* thisAgent, bool store_only)
     std::queue<int> levels;
     
     bool do_wm_phase = false;
-    bool mirroring_on = (thisAgent->smem_params->mirroring->get_value() == on);
+    bool mirroring_on = ((thisAgent->smem_params->mirroring->get_value() == on) && (!smem_read_only(thisAgent)));
     
     //
     
@@ -4742,7 +6773,8 @@ void smem_respond_to_cmd(agent* thisAgent, bool store_only)
                     else if ((*w_p)->attr == thisAgent->smem_sym_store)
                     {
                         if (((*w_p)->value->symbol_type == IDENTIFIER_SYMBOL_TYPE) &&
-                                ((path == blank_slate) || (path == cmd_store)))
+                                ((path == blank_slate) || (path == cmd_store)) &&
+                                (!smem_read_only(thisAgent)))
                         {
                             store.push_back((*w_p)->value);
                             path = cmd_store;
@@ -4823,7 +6855,19 @@ void smem_respond_to_cmd(agent* thisAgent, bool store_only)
                         prohibit_lti.insert((*sym_p)->id->smem_lti);
                     }
                     
+#ifndef NO_TIMING_STUFF
+                    soar_timer query_timer;
+                    query_timer.set_enabled(&(thisAgent->sysparams[ TIMERS_ENABLED ]));
+                    query_timer.start();
+#endif
                     smem_process_query(thisAgent, state, query, negquery, math, &(prohibit_lti), cue_wmes, meta_wmes, retrieval_wmes);
+#ifndef NO_TIMING_STUFF
+                    query_timer.stop();
+                    if (thisAgent->sysparams[ TIMERS_ENABLED ])
+                    {
+                        thisAgent->latency_smem_query.record(query_timer.get_usec());
+                    }
+#endif
                     
                     // add one to the cbr stat
                     thisAgent->smem_stats->cbr->set_value(thisAgent->smem_stats->cbr->get_value() + 1);
@@ -4971,6 +7015,8 @@ void smem_respond_to_cmd(agent* thisAgent, bool store_only)
 
 void smem_go(agent* thisAgent, bool store_only)
 {
+    profile_span span(PROFILE_SMEM);
+    
     thisAgent->smem_timers->total->start();
     
 #ifndef SMEM_EXPERIMENT
@@ -4988,7 +7034,11 @@ bool smem_backup_db(agent* thisAgent, const char* file_name, std::string* err)
 {
     bool return_val = false;
     
-    if (thisAgent->smem_db->get_status() == soar_module::connected)
+    if (smem_read_only(thisAgent))
+    {
+        err->assign("Semantic memory is shared; back up its database file instead.");
+    }
+    else if (thisAgent->smem_db->get_status() == soar_module::connected)
     {
         _smem_close_vars(thisAgent);
         
@@ -5012,6 +7062,28 @@ bool smem_backup_db(agent* thisAgent, const char* file_name, std::string* err)
     return return_val;
 }
 
+// spreading needs the lti graph held in the native store
+inline bool smem_spread_enabled(agent* thisAgent)
+{
+    return ((thisAgent->smem_overlay != NULL) && (thisAgent->smem_params->spreading->get_value() == on));
+}
+
+void smem_spread_context_add(agent* thisAgent, smem_lti_id lti_id)
+{
+    if (smem_spread_enabled(thisAgent))
+    {
+        thisAgent->smem_overlay->context_add(lti_id);
+    }
+}
+
+void smem_spread_context_remove(agent* thisAgent, smem_lti_id lti_id)
+{
+    if (smem_spread_enabled(thisAgent))
+    {
+        thisAgent->smem_overlay->context_remove(lti_id);
+    }
+}
+
 
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
@@ -5534,6 +7606,12 @@ void smem_visualize_lti(agent* thisAgent, smem_lti_id lti_id, unsigned int depth
     return_val->append(return_val2);
 }
 
+// one row of the expansion printed for an lti (see web_expand)
+typedef struct smem_print_child_struct
+{
+    int64_t col[ 7 ];
+} smem_print_child;
+
 inline std::set< smem_lti_id > _smem_print_lti(agent* thisAgent, smem_lti_id lti_id, char lti_letter, uint64_t lti_number, double lti_act, std::string* return_val, std::list<uint64_t>* history = NIL)
 {
     std::set< smem_lti_id > next;
@@ -5558,15 +7636,46 @@ inline std::set< smem_lti_id > _smem_print_lti(agent* thisAgent, smem_lti_id lti
     bool possible_id, possible_ic, possible_fc, possible_sc, possible_var, is_rereadable;
     
     // get direct children: attr_type, attr_hash, value_type, value_hash, value_letter, value_num, value_lti
-    expand_q->bind_int(1, lti_id);
-    while (expand_q->execute() == soar_module::row)
+    std::vector<smem_print_child> children;
+    if (smem_read_only(thisAgent))
+    {
+        smem_store_edge_list& edges = thisAgent->smem_store->get_lti(lti_id)->edges;
+        for (smem_store_edge_list::iterator e = edges.begin(); e != edges.end(); e++)
+        {
+            smem_print_child child;
+            child.col[ 0 ] = thisAgent->smem_store->get_symbol(e->attr)->symbol_type;
+            child.col[ 1 ] = e->attr;
+            child.col[ 2 ] = ((e->value_const != SMEM_AUGMENTATIONS_NULL) ? (thisAgent->smem_store->get_symbol(e->value_const)->symbol_type) : (0));
+            child.col[ 3 ] = e->value_const;
+            child.col[ 4 ] = ((e->value_lti != SMEM_AUGMENTATIONS_NULL) ? (thisAgent->smem_store->get_lti(e->value_lti)->letter) : (0));
+            child.col[ 5 ] = ((e->value_lti != SMEM_AUGMENTATIONS_NULL) ? (thisAgent->smem_store->get_lti(e->value_lti)->number) : (0));
+            child.col[ 6 ] = e->value_lti;
+            children.push_back(child);
+        }
+    }
+    else
+    {
+        expand_q->bind_int(1, lti_id);
+        while (expand_q->execute() == soar_module::row)
+        {
+            smem_print_child child;
+            for (int i = 0; i < 7; i++)
+            {
+                child.col[ i ] = expand_q->column_int(i);
+            }
+            children.push_back(child);
+        }
+        expand_q->reinitialize();
+    }
+    
+    for (std::vector<smem_print_child>::iterator r = children.begin(); r != children.end(); r++)
     {
         // get attribute
-        switch (expand_q->column_int(0))
+        switch (r->col[ 0 ])
         {
             case STR_CONSTANT_SYMBOL_TYPE:
             {
-                smem_reverse_hash_str(thisAgent, expand_q->column_int(1), temp_str);
+                smem_reverse_hash_str(thisAgent, r->col[ 1 ], temp_str);
                 
                 if (count(temp_str.begin(), temp_str.end(), ' ') > 0)
                 {
@@ -5598,12 +7707,12 @@ inline std::set< smem_lti_id > _smem_print_lti(agent* thisAgent, smem_lti_id lti
                 break;
             }
             case INT_CONSTANT_SYMBOL_TYPE:
-                temp_int = smem_reverse_hash_int(thisAgent, expand_q->column_int(1));
+                temp_int = smem_reverse_hash_int(thisAgent, r->col[ 1 ]);
                 to_string(temp_int, temp_str);
                 break;
                 
             case FLOAT_CONSTANT_SYMBOL_TYPE:
-                temp_double = smem_reverse_hash_float(thisAgent, expand_q->column_int(1));
+                temp_double = smem_reverse_hash_float(thisAgent, r->col[ 1 ]);
                 to_string(temp_double, temp_str);
                 break;
                 
@@ -5613,29 +7722,29 @@ inline std::set< smem_lti_id > _smem_print_lti(agent* thisAgent, smem_lti_id lti
         }
         
         // identifier vs. constant
-        if (expand_q->column_int(6) != SMEM_AUGMENTATIONS_NULL)
+        if (r->col[ 6 ] != SMEM_AUGMENTATIONS_NULL)
         {
             temp_str2.clear();
             temp_str2.push_back('@');
             
             // soar_letter
-            temp_str2.push_back(static_cast<char>(expand_q->column_int(4)));
+            temp_str2.push_back(static_cast<char>(r->col[ 4 ]));
             
             // number
-            temp_int = expand_q->column_int(5);
+            temp_int = r->col[ 5 ];
             to_string(temp_int, temp_str3);
             temp_str2.append(temp_str3);
             
             // add to next
-            next.insert(static_cast< smem_lti_id >(expand_q->column_int(6)));
+            next.insert(static_cast< smem_lti_id >(r->col[ 6 ]));
         }
         else
         {
-            switch (expand_q->column_int(2))
+            switch (r->col[ 2 ])
             {
                 case STR_CONSTANT_SYMBOL_TYPE:
                 {
-                    smem_reverse_hash_str(thisAgent, expand_q->column_int(3), temp_str2);
+                    smem_reverse_hash_str(thisAgent, r->col[ 3 ], temp_str2);
                     
                     if (count(temp_str2.begin(), temp_str2.end(), ' ') > 0)
                     {
@@ -5667,12 +7776,12 @@ inline std::set< smem_lti_id > _smem_print_lti(agent* thisAgent, smem_lti_id lti
                     break;
                 }
                 case INT_CONSTANT_SYMBOL_TYPE:
-                    temp_int = smem_reverse_hash_int(thisAgent, expand_q->column_int(3));
+                    temp_int = smem_reverse_hash_int(thisAgent, r->col[ 3 ]);
                     to_string(temp_int, temp_str2);
                     break;
                     
                 case FLOAT_CONSTANT_SYMBOL_TYPE:
-                    temp_double = smem_reverse_hash_float(thisAgent, expand_q->column_int(3));
+                    temp_double = smem_reverse_hash_float(thisAgent, r->col[ 3 ]);
                     to_string(temp_double, temp_str2);
                     break;
                     
@@ -5684,7 +7793,6 @@ inline std::set< smem_lti_id > _smem_print_lti(agent* thisAgent, smem_lti_id lti
         
         augmentations[ temp_str ].push_back(temp_str2);
     }
-    expand_q->reinitialize();
     
     // output augmentations nicely
     {
@@ -5735,6 +7843,17 @@ inline std::set< smem_lti_id > _smem_print_lti(agent* thisAgent, smem_lti_id lti
 
 void smem_print_store(agent* thisAgent, std::string* return_val)
 {
+    if (smem_read_only(thisAgent))
+    {
+        // lti_names is ordered by letter and number, as is vis_lti
+        std::map< std::pair<char, uint64_t>, smem_lti_id >& names = thisAgent->smem_store->lti_names;
+        for (std::map< std::pair<char, uint64_t>, smem_lti_id >::iterator n = names.begin(); n != names.end(); n++)
+        {
+            _smem_print_lti(thisAgent, n->second, n->first.first, n->first.second, thisAgent->smem_overlay->peek_act(n->second)->activation_value, return_val);
+        }
+        return;
+    }
+    
     // id, soar_letter, number
     soar_module::sqlite_statement* q = thisAgent->smem_stmts->vis_lti;
     while (q->execute() == soar_module::row)
@@ -5779,45 +7898,78 @@ void smem_print_lti(agent* thisAgent, smem_lti_id lti_id, unsigned int depth, st
         
         // get lti info
         {
-            lti_q->bind_int(1, c.first);
-            lti_q->execute();
-            
-            act_q->bind_int(1, c.first);
-            act_q->execute();
+            char lti_letter;
+            uint64_t lti_number;
+            double lti_act;
             
             //Look up activation history.
             std::list<uint64_t> access_history;
-            if (history)
+            
+            if (smem_read_only(thisAgent))
+            {
+                // the agent's own database holds no ltis
+                smem_store_lti* l = thisAgent->smem_store->get_lti(c.first);
+                const smem_store_activation* a = thisAgent->smem_overlay->peek_act(c.first);
+                
+                lti_letter = l->letter;
+                lti_number = l->number;
+                lti_act = a->activation_value;
+                
+                if (history && a->has_history)
+                {
+                    for (uint64_t i = 0; i < a->activations_total && i < SMEM_ACT_HISTORY_ENTRIES; ++i)
+                    {
+                        if (a->history[ i ] != 0)
+                        {
+                            access_history.push_back(a->history[ i ]);
+                        }
+                    }
+                }
+            }
+            else
             {
-                lti_access_q->bind_int(1, c.first);
-                lti_access_q->execute();
-                uint64_t n = lti_access_q->column_int(0);
-                lti_access_q->reinitialize();
-                hist_q->bind_int(1, c.first);
-                hist_q->execute();
-                for (int i = 0; i < n && i < 10; ++i) //10 because of the length of the history record kept for smem.
+                lti_q->bind_int(1, c.first);
+                lti_q->execute();
+                
+                act_q->bind_int(1, c.first);
+                act_q->execute();
+                
+                lti_letter = static_cast<char>(lti_q->column_int(0));
+                lti_number = static_cast<uint64_t>(lti_q->column_int(1));
+                lti_act = act_q->column_double(0);
+                
+                if (history)
                 {
-                    if (thisAgent->smem_stmts->history_get->column_int(i) != 0)
+                    lti_access_q->bind_int(1, c.first);
+                    lti_access_q->execute();
+                    uint64_t n = lti_access_q->column_int(0);
+                    lti_access_q->reinitialize();
+                    hist_q->bind_int(1, c.first);
+                    hist_q->execute();
+                    for (int i = 0; i < n && i < 10; ++i) //10 because of the length of the history record kept for smem.
                     {
-                        access_history.push_back(hist_q->column_int(i));
+                        if (thisAgent->smem_stmts->history_get->column_int(i) != 0)
+                        {
+                            access_history.push_back(hist_q->column_int(i));
+                        }
                     }
+                    hist_q->reinitialize();
                 }
-                hist_q->reinitialize();
+                
+                // done with lookup
+                lti_q->reinitialize();
+                act_q->reinitialize();
             }
             
             if (history && !access_history.empty())
             {
-                next = _smem_print_lti(thisAgent, c.first, static_cast<char>(lti_q->column_int(0)), static_cast<uint64_t>(lti_q->column_int(1)), act_q->column_double(0), return_val, &(access_history));
+                next = _smem_print_lti(thisAgent, c.first, lti_letter, lti_number, lti_act, return_val, &(access_history));
             }
             else
             {
-                next = _smem_print_lti(thisAgent, c.first, static_cast<char>(lti_q->column_int(0)), static_cast<uint64_t>(lti_q->column_int(1)), act_q->column_double(0), return_val);
+                next = _smem_print_lti(thisAgent, c.first, lti_letter, lti_number, lti_act, return_val);
             }
             
-            // done with lookup
-            lti_q->reinitialize();
-            act_q->reinitialize();
-            
             // consider further depth
             if (c.second < depth)
             {
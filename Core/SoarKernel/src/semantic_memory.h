@@ -20,6 +20,8 @@
 #include <list>
 #include <vector>
 #include <queue>
+#include <map>
+#include <string>
 
 #include "soar_module.h"
 #include "soar_db.h"
@@ -80,6 +82,14 @@ class smem_param_container: public soar_module::param_container
         
         soar_module::boolean_param* mirroring;
         
+        soar_module::boolean_param* native_store;
+        soar_module::boolean_param* shared;
+        
+        soar_module::boolean_param* spreading;
+        soar_module::integer_param* spreading_depth;
+        soar_module::integer_param* spreading_limit;
+        soar_module::integer_param* spreading_budget;
+        
         smem_param_container(agent* new_agent);
 };
 
@@ -181,6 +191,7 @@ class smem_timer_container: public soar_module::timer_container
         soar_module::timer* init;
         soar_module::timer* hash;
         soar_module::timer* act;
+        soar_module::timer* spread;
         
         smem_timer_container(agent* thisAgent);
 };
@@ -235,6 +246,7 @@ class smem_statement_container: public soar_module::sqlite_statement_container
         soar_module::sqlite_statement* lti_get_t;
         
         soar_module::sqlite_statement* web_add;
+        soar_module::sqlite_statement* web_add_batch;
         soar_module::sqlite_statement* web_truncate;
         soar_module::sqlite_statement* web_expand;
         
@@ -281,6 +293,9 @@ class smem_statement_container: public soar_module::sqlite_statement_container
         
         smem_statement_container(agent* new_agent);
         
+        static void drop_retrieval_indices(agent* new_agent);
+        static void create_retrieval_indices(agent* new_agent);
+        
     private:
     
         void create_tables();
@@ -305,10 +320,21 @@ enum smem_variable_key
 #define SMEM_AUGMENTATIONS_NULL_STR "0"
 
 #define SMEM_ACT_HISTORY_ENTRIES 10
+
+// changes to lti values logged for spreading before the log is dropped
+// (and spreading starts over)
+#define SMEM_MAX_EDGE_CHANGES 4096
 #define SMEM_ACT_LOW -1000000000
 
 #define SMEM_SCHEMA_VERSION "2.0"
 
+// rows per multi-row augmentation insert during bulk import
+// (5 parameters per row, must stay under SQLITE_MAX_VARIABLE_NUMBER)
+#define SMEM_IMPORT_BATCH_ROWS 100
+
+// clauses between progress reports during bulk import
+#define SMEM_IMPORT_PROGRESS 100000
+
 //////////////////////////////////////////////////////////
 // Soar Integration Types
 //////////////////////////////////////////////////////////
@@ -438,6 +464,257 @@ union smem_chunk_value_union
 typedef std::map<std::string, smem_chunk*> smem_str_to_chunk_map;
 typedef std::map<Symbol*, smem_chunk*> smem_sym_to_chunk_map;
 
+//////////////////////////////////////////////////////////
+// SMem Native Store
+//
+// In-process copy of the semantic store.  When the
+// native-store parameter is on, the database is read
+// once when it is opened and all lookups are served
+// from these structures; SQLite only receives writes
+// so that the store persists.
+//
+// Symbol hashes and lti ids are sqlite rowids that
+// are never deleted, so both are kept in vectors
+// indexed by id.
+//////////////////////////////////////////////////////////
+
+// one augmentation of an lti (value_const xor value_lti is set)
+typedef struct smem_store_edge_struct
+{
+    smem_hash_id attr;
+    smem_hash_id value_const;
+    smem_lti_id value_lti;
+} smem_store_edge;
+
+struct smem_compare_store_edges
+{
+    bool operator()(const smem_store_edge& a, const smem_store_edge& b) const
+    {
+        if (a.attr != b.attr)
+        {
+            return (a.attr < b.attr);
+        }
+        if (a.value_const != b.value_const)
+        {
+            return (a.value_const < b.value_const);
+        }
+        return (a.value_lti < b.value_lti);
+    }
+};
+
+// kept sorted by (attr, value_const, value_lti)
+typedef std::vector<smem_store_edge> smem_store_edge_list;
+
+// access data of an lti (agent-local when the store is shared)
+typedef struct smem_store_activation_struct
+{
+    double activation_value;
+    
+    uint64_t activations_total;
+    uint64_t activations_last;
+    uint64_t activations_first;
+    
+    bool has_history;
+    int64_t history[ SMEM_ACT_HISTORY_ENTRIES ];
+} smem_store_activation;
+
+typedef struct smem_store_lti_struct
+{
+    char letter;
+    uint64_t number;
+    
+    uint64_t total_augmentations;
+    smem_store_activation act;
+    
+    smem_store_edge_list edges;
+} smem_store_lti;
+
+typedef struct smem_store_symbol_struct
+{
+    byte symbol_type;
+    int64_t int_value;
+    double float_value;
+    std::string str_value;
+} smem_store_symbol;
+
+typedef std::pair<smem_hash_id, smem_hash_id> smem_store_const_key;
+typedef std::pair<smem_hash_id, smem_lti_id> smem_store_lti_key;
+
+// an lti in a candidate list, under its stored activation
+typedef std::pair<double, smem_lti_id> smem_store_lti_entry;
+
+struct smem_compare_store_lti_entries
+{
+    bool operator()(const smem_store_lti_entry& a, const smem_store_lti_entry& b) const
+    {
+        if (a.first != b.first)
+        {
+            return (a.first > b.first);
+        }
+        return (a.second < b.second);
+    }
+};
+
+// ltis sharing a cue element, most active first (as the
+// database's activation indexes are); an lti is moved in
+// each of its lists when its stored activation changes
+typedef std::set<smem_store_lti_entry, smem_compare_store_lti_entries> smem_store_lti_list;
+
+// activation spread to each lti
+typedef std::map<smem_lti_id, double> smem_spread_map;
+
+class smem_native_store
+{
+    public:
+        std::vector<smem_store_symbol*> symbols;
+        std::map<int64_t, smem_hash_id> int_hashes;
+        std::map<double, smem_hash_id> float_hashes;
+        std::map<std::string, smem_hash_id> str_hashes;
+        
+        std::vector<smem_store_lti*> ltis;
+        std::map< std::pair<char, uint64_t>, smem_lti_id > lti_names;
+        
+        std::map<smem_hash_id, int64_t> attribute_frequency;
+        std::map<smem_store_const_key, int64_t> constant_frequency;
+        std::map<smem_store_lti_key, int64_t> lti_frequency;
+        
+        // candidate index for cue-based retrieval, by attribute,
+        // attribute/constant and attribute/lti
+        std::map<smem_hash_id, smem_store_lti_list> attr_index;
+        std::map<smem_store_const_key, smem_store_lti_list> const_index;
+        std::map<smem_store_lti_key, smem_store_lti_list> lti_index;
+        
+        // persistent variables as of the load
+        std::map<smem_variable_key, int64_t> variables;
+        
+        // ltis by activations_last, for incremental base-level updates
+        // over a shared store (which never changes once it is loaded)
+        std::map< uint64_t, std::vector<smem_lti_id> > last_access_index;
+        
+        // counts changes to lti values (which spreading follows); while
+        // log_edge_changes is set, the ltis changed since edge_reset are
+        // logged in order, so edge_version is edge_reset plus the length
+        // of the log (unlogged changes move edge_reset up instead)
+        uint64_t edge_version;
+        uint64_t edge_reset;
+        bool log_edge_changes;
+        std::vector<smem_lti_id> edge_changes;
+        
+        smem_native_store();
+        ~smem_native_store();
+        
+        void load(soar_module::sqlite_database* db);
+        void load_frequencies(soar_module::sqlite_database* db);
+        void index_last_access();
+        
+        smem_store_symbol* add_symbol(smem_hash_id hash, byte symbol_type);
+        inline smem_store_symbol* get_symbol(smem_hash_id hash)
+        {
+            return (hash < symbols.size()) ? (symbols[ hash ]) : (NULL);
+        }
+        
+        smem_store_lti* add_lti(smem_lti_id lti_id, char letter, uint64_t number);
+        inline smem_store_lti* get_lti(smem_lti_id lti_id)
+        {
+            return (lti_id < ltis.size()) ? (ltis[ lti_id ]) : (NULL);
+        }
+        smem_lti_id find_lti(char letter, uint64_t number);
+        
+        void add_edge(smem_lti_id lti_id, smem_hash_id attr, smem_hash_id value_const, smem_lti_id value_lti);
+        bool has_edge(smem_lti_id lti_id, smem_hash_id attr);
+        bool has_edge(smem_lti_id lti_id, smem_hash_id attr, smem_hash_id value_const, smem_lti_id value_lti);
+        smem_store_edge_list::iterator first_edge(smem_store_lti* lti, smem_hash_id attr);
+        void clear_edges(smem_lti_id lti_id);
+        void edge_changes_seen(uint64_t version);
+        
+        void set_activation(smem_lti_id lti_id, double activation_value);
+        smem_store_lti_list* get_candidates(smem_hash_id attr, smem_hash_id value_const, smem_lti_id value_lti);
+        
+    private:
+        void clear();
+        void edge_changed(smem_lti_id lti_id);
+        void index_edge(smem_lti_id lti_id, const smem_store_edge& e, bool new_attr);
+        void unindex_edge(smem_lti_id lti_id, const smem_store_edge& e, bool last_attr);
+};
+
+//////////////////////////////////////////////////////////
+// SMem Store Overlay
+//
+// Agent-local state over the native store.  A native
+// store opened with the shared parameter is loaded once
+// per database file and used read-only by every agent
+// in the process; each agent then keeps the access data
+// of the ltis it has activated here (copied on first
+// write), so N agents cost one store plus what they
+// touch.  Unshared, the overlay reads and writes the
+// store's own records.
+//////////////////////////////////////////////////////////
+
+class smem_store_overlay
+{
+    public:
+        smem_native_store* store;
+        bool shared;
+        
+        std::map<smem_lti_id, smem_store_activation> activations;
+        
+        // ltis whose edge activations in the database are out of date
+        std::set<smem_lti_id> stale_activations;
+        
+        // spreading activation: ltis in working memory (with reference
+        // counts), the fan-out of each, those whose fan-out is not yet
+        // in the total, and the total spread to each lti
+        std::map<smem_lti_id, uint64_t> context;
+        std::map<smem_lti_id, smem_spread_map> fan_out;
+        std::set<smem_lti_id> spread_pending;
+        smem_spread_map spread;
+        
+        smem_store_overlay(smem_native_store* new_store, bool new_shared);
+        
+        // for reading (never copies)
+        inline const smem_store_activation* peek_act(smem_lti_id lti_id)
+        {
+            if (shared)
+            {
+                std::map<smem_lti_id, smem_store_activation>::iterator p = activations.find(lti_id);
+                if (p != activations.end())
+                {
+                    return &(p->second);
+                }
+            }
+            
+            smem_store_lti* lti = store->get_lti(lti_id);
+            return (lti) ? (&(lti->act)) : (NULL);
+        }
+        smem_store_activation* get_act(smem_lti_id lti_id);
+        
+        // access times (indexed for a shared store, see last_access)
+        void set_last_access(smem_lti_id lti_id, smem_store_activation* act, uint64_t t);
+        void get_last_accessed(uint64_t t, std::list<smem_lti_id>& lti_ids);
+        
+        void history_add(smem_store_activation* act, int64_t t);
+        void history_push(smem_store_activation* act, int64_t t);
+        
+        void context_add(smem_lti_id lti_id);
+        void context_remove(smem_lti_id lti_id);
+        uint64_t spread_update(uint64_t depth, uint64_t limit, uint64_t budget);
+        inline double get_spread(smem_lti_id lti_id)
+        {
+            smem_spread_map::iterator p = spread.find(lti_id);
+            return (p != spread.end()) ? (p->second) : (0.0);
+        }
+        
+    private:
+        uint64_t spread_version;
+        
+        // the times of this agent's own accesses (to a shared store)
+        std::multimap<uint64_t, smem_lti_id> last_access;
+        
+        void spread_invalidate();
+        void spread_remove(std::map<smem_lti_id, smem_spread_map>::iterator f);
+        uint64_t spread_fan_out(smem_lti_id source, uint64_t depth, uint64_t limit);
+};
+
 //
 
 typedef struct smem_vis_lti_struct
@@ -463,6 +740,7 @@ extern void smem_attach(agent* thisAgent);
 extern bool smem_parse_chunks(agent* thisAgent, const char* chunks, std::string** err_msg);
 extern bool smem_parse_cues(agent* thisAgent, const char* chunks, std::string** err_msg, std::string** result_message, uint64_t number_to_retrieve);
 extern bool smem_parse_remove(agent* thisAgent, const char* chunks, std::string** err_msg, std::string** result_message, bool force = false);
+extern bool smem_import_chunks(agent* thisAgent, const char* file_path, std::string** err_msg, std::string** result_message);
 
 extern void smem_visualize_store(agent* thisAgent, std::string* return_val);
 extern void smem_visualize_lti(agent* thisAgent, smem_lti_id lti_id, unsigned int depth, std::string* return_val);
@@ -486,8 +764,13 @@ extern void smem_reinit_cmd(agent* thisAgent);
 
 // perform smem actions
 extern void smem_go(agent* thisAgent, bool store_only);
+extern void smem_update_incremental_activations(agent* thisAgent, int64_t time_now);
 extern bool smem_backup_db(agent* thisAgent, const char* file_name, std::string* err);
 
+// track ltis entering and leaving working memory (spreading activation)
+extern void smem_spread_context_add(agent* thisAgent, smem_lti_id lti_id);
+extern void smem_spread_context_remove(agent* thisAgent, smem_lti_id lti_id);
+
 void smem_init_db(agent* thisAgent);
 
 #endif
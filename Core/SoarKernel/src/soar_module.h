@@ -985,20 +985,26 @@ namespace soar_module
                 return thisAgent;
             }
             
-            soar_memory_pool_allocator(agent* new_agent): thisAgent(new_agent), mem_pool(NULL), size(sizeof(value_type))
+            uint64_t* get_live_bytes() const
+            {
+                return live_bytes;
+            }
+            
+            // The subsystem is the one the container's memory is put down to (see get_memory_accounting)
+            soar_memory_pool_allocator(agent* new_agent, mem_subsystem subsystem = MEM_SUBSYSTEM_OTHER): thisAgent(new_agent), mem_pool(NULL), size(sizeof(value_type)), live_bytes(get_pool_allocator_counter(new_agent, subsystem))
             {
                 // useful for debugging
                 // std::string temp_this( typeid( value_type ).name() );
             }
             
-            soar_memory_pool_allocator(const soar_memory_pool_allocator& obj): thisAgent(obj.get_agent()), mem_pool(NULL), size(sizeof(value_type))
+            soar_memory_pool_allocator(const soar_memory_pool_allocator& obj): thisAgent(obj.get_agent()), mem_pool(NULL), size(sizeof(value_type)), live_bytes(obj.get_live_bytes())
             {
                 // useful for debugging
                 // std::string temp_this( typeid( value_type ).name() );
             }
             
             template <class _other>
-            soar_memory_pool_allocator(const soar_memory_pool_allocator<_other>& other): thisAgent(other.get_agent()), mem_pool(NULL), size(sizeof(value_type))
+            soar_memory_pool_allocator(const soar_memory_pool_allocator<_other>& other): thisAgent(other.get_agent()), mem_pool(NULL), size(sizeof(value_type)), live_bytes(other.get_live_bytes())
             {
                 // useful for debugging
                 // std::string temp_this( typeid( T ).name() );
@@ -1020,6 +1026,7 @@ namespace soar_module
                 
                 pointer t;
                 allocate_with_pool(thisAgent, mem_pool, &t);
+                *live_bytes += mem_pool->item_size;
                 
                 return t;
             }
@@ -1044,6 +1051,7 @@ namespace soar_module
                 if (p)
                 {
                     free_with_pool(mem_pool, p);
+                    *live_bytes -= mem_pool->item_size;
                 }
             }
             
@@ -1077,12 +1085,15 @@ namespace soar_module
             {
                 typedef soar_memory_pool_allocator<U> other;
             };
+            bool operator==(const soar_memory_pool_allocator& o) const { return thisAgent == o.thisAgent; } // LOCALONLY
+            bool operator!=(const soar_memory_pool_allocator& o) const { return thisAgent != o.thisAgent; } // LOCALONLY
             
             
         private:
             agent* thisAgent;
             memory_pool* mem_pool;
             size_type size;
+            uint64_t* live_bytes;
             
             soar_memory_pool_allocator() {}
             
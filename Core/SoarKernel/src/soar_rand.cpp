@@ -1,30 +1,44 @@
 #include "portability.h"
 
 #include "soar_rand.h"
+#include "agent.h"
+#include "thread_Lock.h"
 
 static MTRand gSoarRand;
 
+// Clients may use the kernel-wide generator from several threads (agents have
+// their own).  Never freed, so it outlives anything using the generator.
+static soar_thread::Mutex* rand_mutex()
+{
+    static soar_thread::Mutex* pMutex = new soar_thread::Mutex();
+    return pMutex;
+}
+
 // real number in [0,1]
 double SoarRand()
 {
+    soar_thread::Lock lock(rand_mutex());
     return gSoarRand.rand();
 }
 
 // real number in [0,n]
 double SoarRand(const double& max)
 {
+    soar_thread::Lock lock(rand_mutex());
     return gSoarRand.rand(max);
 }
 
 // integer in [0,2^32-1]
 uint32_t SoarRandInt()
 {
+    soar_thread::Lock lock(rand_mutex());
     return gSoarRand.randInt();
 }
 
 // integer in [0,n] for n < 2^32
 uint32_t SoarRandInt(const uint32_t& max)
 {
+    soar_thread::Lock lock(rand_mutex());
     return gSoarRand.randInt(max);
 }
 
@@ -32,11 +46,49 @@ uint32_t SoarRandInt(const uint32_t& max)
 // automatically seed with a value based on the time or /dev/urandom
 void SoarSeedRNG()
 {
+    soar_thread::Lock lock(rand_mutex());
     gSoarRand.seed();
 }
 
 // seed with a provided value
 void SoarSeedRNG(const uint32_t seed)
 {
+    soar_thread::Lock lock(rand_mutex());
     gSoarRand.seed(seed);
 }
+
+// real number in [0,1]
+double SoarRand(agent* thisAgent)
+{
+    return thisAgent->rand_generator->rand();
+}
+
+// real number in [0,n]
+double SoarRand(agent* thisAgent, const double& max)
+{
+    return thisAgent->rand_generator->rand(max);
+}
+
+// integer in [0,2^32-1]
+uint32_t SoarRandInt(agent* thisAgent)
+{
+    return thisAgent->rand_generator->randInt();
+}
+
+// integer in [0,n] for n < 2^32
+uint32_t SoarRandInt(agent* thisAgent, const uint32_t& max)
+{
+    return thisAgent->rand_generator->randInt(max);
+}
+
+// automatically seed with a value based on the time or /dev/urandom
+void SoarSeedRNG(agent* thisAgent)
+{
+    thisAgent->rand_generator->seed();
+}
+
+// seed with a provided value
+void SoarSeedRNG(agent* thisAgent, const uint32_t seed)
+{
+    thisAgent->rand_generator->seed(seed);
+}
@@ -471,6 +471,8 @@ inline std::istream& operator>>(std::istream& is, MTRand& mtrand)
     return is;
 }
 
+// The kernel-wide generator, for callers without an agent
+
 // real number in [0,1]
 EXPORT double SoarRand();
 
@@ -489,6 +491,18 @@ EXPORT void SoarSeedRNG();
 // seed with a provided value
 EXPORT void SoarSeedRNG(const uint32_t seed);
 
+// The same from an agent's own generator, so that agents run on
+// different threads neither share a sequence nor wait on each other
+
+typedef struct agent_struct agent;
+
+EXPORT double SoarRand(agent* thisAgent);
+EXPORT double SoarRand(agent* thisAgent, const double& max);
+EXPORT uint32_t SoarRandInt(agent* thisAgent);
+EXPORT uint32_t SoarRandInt(agent* thisAgent, const uint32_t& max);
+EXPORT void SoarSeedRNG(agent* thisAgent);
+EXPORT void SoarSeedRNG(agent* thisAgent, const uint32_t seed);
+
 #endif  // SOAR_RAND_H
 
 // Change log:
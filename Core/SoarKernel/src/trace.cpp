@@ -1176,15 +1176,17 @@ inline void set_tagged_trace_formats(agent* thisAgent)
 growable_string object_to_trace_string(agent* thisAgent, Symbol* object);
 
 
-bool found_undefined;   /* set to true whenever an escape sequence result is
-                           undefined--for use with %ifdef */
+/* These two are per thread, as agents can be run on several threads at once */
+THREAD_LOCAL bool found_undefined;   /* set to true whenever an escape sequence result is
+                                        undefined--for use with %ifdef */
 
 struct tracing_parameters
 {
     Symbol* current_s;          /* current state, etc. -- for use in %cs, etc. */
     Symbol* current_o;
     bool allow_cycle_counts;    /* true means allow %dc and %ec */
-} tparams;
+};
+THREAD_LOCAL tracing_parameters tparams;
 
 /* ----------------------------------------------------------------
    Adds all values of the given attribute path off the given object
@@ -31,6 +31,7 @@
 #include "misc.h"
 #include "xml.h"
 #include "print.h"
+#include "deadline.h"
 
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
@@ -598,7 +599,7 @@ void wma_activate_wme(agent* thisAgent, wme* w, wma_reference num_references, wm
         {
             allocate_with_pool(thisAgent, &(thisAgent->wma_wme_oset_pool), &my_o_set);
 #ifdef USE_MEM_POOL_ALLOCATORS
-            my_o_set = new(my_o_set) wma_pooled_wme_set(std::less< wme* >(), soar_module::soar_memory_pool_allocator< wme* >(thisAgent));
+            my_o_set = new(my_o_set) wma_pooled_wme_set(std::less< wme* >(), soar_module::soar_memory_pool_allocator< wme* >(thisAgent, MEM_SUBSYSTEM_WMA));
 #else
             my_o_set = new(my_o_set) wma_pooled_wme_set();
 #endif
@@ -750,7 +751,7 @@ inline void wma_forgetting_add_to_p_queue(agent* thisAgent, wma_decay_element* d
             wma_decay_set* newbie;
             allocate_with_pool(thisAgent, &(thisAgent->wma_decay_set_pool), &newbie);
 #ifdef USE_MEM_POOL_ALLOCATORS
-            newbie = new(newbie) wma_decay_set(std::less< wma_decay_element* >(), soar_module::soar_memory_pool_allocator< wma_decay_element* >(thisAgent));
+            newbie = new(newbie) wma_decay_set(std::less< wma_decay_element* >(), soar_module::soar_memory_pool_allocator< wma_decay_element* >(thisAgent, MEM_SUBSYSTEM_WMA));
 #else
             newbie = new(newbie) wma_decay_set();
 #endif
@@ -940,7 +941,8 @@ inline bool wma_forgetting_update_p_queue(agent* thisAgent)
         double decay_thresh = thisAgent->wma_thresh_exp;
         bool forget_only_lti = (thisAgent->wma_params->forget_wme->get_value() == wma_param_container::lti);
         
-        if (pq_p->first == current_cycle)
+        // earlier cycles are only still here if deadline mode put the sweep off
+        while ((pq_p != thisAgent->wma_forget_pq->end()) && (pq_p->first <= current_cycle))
         {
             wma_decay_set::iterator d_p = pq_p->second->begin();
             wma_decay_set::iterator current_p;
@@ -1007,6 +1009,8 @@ inline bool wma_forgetting_update_p_queue(agent* thisAgent)
             // clean up decay set
             thisAgent->wma_touched_sets->insert(pq_p->first);
             pq_p->second->clear();
+            
+            pq_p++;
         }
         
         // clean up touched sets
@@ -1330,7 +1334,8 @@ void wma_go(agent* thisAgent, wma_go_action go_action)
     {
         wma_param_container::forgetting_choices forgetting = thisAgent->wma_params->forgetting->get_value();
         
-        if (forgetting != wma_param_container::disabled)
+        // in deadline mode the sweep may be left for a later cycle
+        if ((forgetting != wma_param_container::disabled) && !deadline_defer(thisAgent, DEFERRED_WMA_FORGETTING))
         {
             thisAgent->wma_timers->forgetting->start();
             
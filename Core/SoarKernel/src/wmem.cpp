@@ -32,6 +32,9 @@
 
 #include "wma.h"
 #include "episodic_memory.h"
+#include "semantic_memory.h"
+#include "profiler.h"
+#include "perf_counters.h"
 
 using namespace soar_TraceNames;
 
@@ -196,6 +199,11 @@ void remove_wme_list_from_wm(agent* thisAgent, wme* w, bool updateWmeMap)
 
 void do_buffered_wm_changes(agent* thisAgent)
 {
+    profile_span span(PROFILE_MATCH);
+#ifndef NO_TIMING_STUFF
+    perf_span perf_match_span(thisAgent->perf_match, thisAgent->sysparams[PERF_COUNTERS_ENABLED]);
+#endif
+    
     cons* c, *next_c, *cr;
     wme* w;
     /*
@@ -280,6 +288,11 @@ void do_buffered_wm_changes(agent* thisAgent)
             filtered_print_wme_add(thisAgent, w); /* kjh(CUSP-B2) begin */
         }
         
+        if ((w->value->symbol_type == IDENTIFIER_SYMBOL_TYPE) && (w->value->id->smem_lti != NIL))
+        {
+            smem_spread_context_add(thisAgent, w->value->id->smem_lti);
+        }
+        
         wme_add_ref(w);
         free_cons(thisAgent, c);
         thisAgent->wme_addition_count++;
@@ -296,6 +309,11 @@ void do_buffered_wm_changes(agent* thisAgent)
             filtered_print_wme_remove(thisAgent, w);   /* kjh(CUSP-B2) begin */
         }
         
+        if ((w->value->symbol_type == IDENTIFIER_SYMBOL_TYPE) && (w->value->id->smem_lti != NIL))
+        {
+            smem_spread_context_remove(thisAgent, w->value->id->smem_lti);
+        }
+        
         wme_remove_ref(thisAgent, w);
         free_cons(thisAgent, c);
         thisAgent->wme_removal_count++;
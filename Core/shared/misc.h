@@ -276,6 +276,16 @@ class soar_timer
             return 0;
         }
         
+        // Time since start(), for a timer that hasn't been stopped yet
+        uint64_t get_running_usec()
+        {
+            if ((!enabled_ptr) || (*enabled_ptr))
+            {
+                return static_cast<uint64_t>((get_raw_time() - t1) / raw_per_usec);
+            }
+            return 0;
+        }
+        
     private:
         uint64_t t1, elapsed;
         double raw_per_usec;
@@ -326,5 +336,156 @@ class soar_timer_accumulator
         }
 };
 
+// Counts how often each latency (in microseconds, or any other unit) is
+// seen, HdrHistogram style: values below 16 get a bucket each and every
+// power of two above that is split into 16 buckets, so a percentile read
+// back is never more than 1/16th above the true value.  Recording is a few
+// shifts and an increment, however large the value.  It takes about 8k.
+class soar_latency_histogram
+{
+    public:
+        enum
+        {
+            SUB_BUCKET_BITS = 4,
+            SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+            NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS
+        };
+        
+        soar_latency_histogram()
+        {
+            reset();
+        }
+        
+        void reset()
+        {
+            for (int i = 0; i < NUM_BUCKETS; i++)
+            {
+                counts[i] = 0;
+            }
+            count = total = max = 0;
+        }
+        
+        void record(uint64_t value)
+        {
+            counts[get_bucket(value)]++;
+            count++;
+            total += value;
+            if (value > max)
+            {
+                max = value;
+            }
+        }
+        
+        uint64_t get_count() const
+        {
+            return count;
+        }
+        
+        uint64_t get_total() const
+        {
+            return total;
+        }
+        
+        uint64_t get_max() const
+        {
+            return max;
+        }
+        
+        double get_mean() const
+        {
+            return count ? static_cast<double>(total) / count : 0;
+        }
+        
+        // The value that percent% of those recorded are at or below (0 if none were),
+        // e.g. get_percentile(99.9).  Rounded up to the top of its bucket.
+        uint64_t get_percentile(double percent) const
+        {
+            if (!count)
+            {
+                return 0;
+            }
+            
+            double wanted = count * percent / 100.0;
+            uint64_t seen = 0;
+            
+            for (int i = 0; i < NUM_BUCKETS; i++)
+            {
+                seen += counts[i];
+                if (seen && seen >= wanted)
+                {
+                    uint64_t top = get_bucket_top(i);
+                    return (top < max) ? top : max;
+                }
+            }
+            return max;
+        }
+        
+    private:
+        uint64_t counts[NUM_BUCKETS];
+        uint64_t count;
+        uint64_t total;
+        uint64_t max;
+        
+        static int get_highest_bit(uint64_t value)
+        {
+            int bit = 0;
+            if (value >> 32)
+            {
+                value >>= 32;
+                bit += 32;
+            }
+            if (value >> 16)
+            {
+                value >>= 16;
+                bit += 16;
+            }
+            if (value >> 8)
+            {
+                value >>= 8;
+                bit += 8;
+            }
+            if (value >> 4)
+            {
+                value >>= 4;
+                bit += 4;
+            }
+            if (value >> 2)
+            {
+                value >>= 2;
+                bit += 2;
+            }
+            if (value >> 1)
+            {
+                bit += 1;
+            }
+            return bit;
+        }
+        
+        static int get_bucket(uint64_t value)
+        {
+            if (value < SUB_BUCKETS)
+            {
+                return static_cast<int>(value);
+            }
+            
+            // The highest bit picks the power of two, the four bits below it the sub-bucket
+            int shift = get_highest_bit(value) - SUB_BUCKET_BITS;
+            return (shift * SUB_BUCKETS) + static_cast<int>(value >> shift);
+        }
+        
+        // The largest value that goes in the given bucket
+        static uint64_t get_bucket_top(int bucket)
+        {
+            if (bucket < 2 * SUB_BUCKETS)
+            {
+                return bucket;
+            }
+            
+            int shift = (bucket / SUB_BUCKETS) - 1;
+            uint64_t bottom = static_cast<uint64_t>(SUB_BUCKETS + (bucket % SUB_BUCKETS)) << shift;
+            return bottom + ((static_cast<uint64_t>(1) << shift) - 1);
+        }
+};
+
 #endif /*MISC_H_*/
 
@@ -24,6 +24,15 @@ static inline long atomic_dec(volatile long* v)
 {
     return --(*v);
 }
+static inline void* atomic_exchange_ptr(void* volatile* p, void* value)
+{
+    void* old = *p;
+    *p = value;
+    return old;
+}
+static inline void memory_barrier()
+{
+}
 #endif // HAVE_ATOMICS
 
 
@@ -39,12 +39,23 @@
 // Use local sockets instead of internet sockets for same-machine interprocess communication
 #define ENABLE_LOCAL_SOCKETS
 
+// Clients on the same machine can ask to use shared memory instead of a local socket (see sock_SharedMemory.h)
+#define ENABLE_SHARED_MEMORY
+
+// The kernel waits on all of its sockets at once with epoll rather than polling each (see sock_Reactor.h)
+#ifdef __linux__
+#define ENABLE_EPOLL
+#endif
+
 #include <dlfcn.h>      // Needed for dlopen and dlsym
 #define GetProcAddress dlsym
 
 #define SNPRINTF snprintf
 #define VSNPRINTF vsnprintf
 
+// Gives each thread its own copy of a global (only for plain data)
+#define THREAD_LOCAL __thread
+
 /* socket support stuff */
 
 ///////
@@ -110,6 +121,18 @@ static inline long atomic_dec(volatile long* v)
     return __sync_sub_and_fetch(v, 1);
 }
 
+// Stores value and returns what was there (a full barrier, like the Windows version)
+static inline void* atomic_exchange_ptr(void* volatile* p, void* value)
+{
+    __sync_synchronize();
+    return __sync_lock_test_and_set(p, value);
+}
+
+static inline void memory_barrier()
+{
+    __sync_synchronize();
+}
+
 #define HAVE_ATOMICS 1
 
 #endif // GCC<4.2.0
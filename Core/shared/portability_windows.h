@@ -39,6 +39,9 @@
 #define strcasecmp _stricmp
 #define VSNPRINTF _vsnprintf
 #define SNPRINTF _snprintf
+
+// Gives each thread its own copy of a global (only for plain data)
+#define THREAD_LOCAL __declspec(thread)
 #ifndef strdup
 #define strdup _strdup
 #endif // strdup
@@ -97,6 +100,16 @@ static inline long atomic_dec( volatile long *v )
        return _InterlockedDecrement(v);
 }
 
+static inline void* atomic_exchange_ptr( void* volatile *p, void* value )
+{
+       return InterlockedExchangePointer(p, value);
+}
+
+static inline void memory_barrier()
+{
+       MemoryBarrier();
+}
+
 #define HAVE_ATOMICS 1
 
 #endif // _MSC_VER
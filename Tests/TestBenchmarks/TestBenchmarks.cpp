@@ -0,0 +1,674 @@
+// Runs a fixed set of workloads, each in a fresh kernel, and reports how long they took
+// so releases can be checked for performance regressions.
+//
+// The workloads:
+//   count-test     the large rete net TestSoarPerformance runs (count-test-5000), run to halt
+//   big-rete       sourcing big.soar (every old demo agent, over 800 productions) and excising it again
+//   chunking       the arithmetic agent with learning on, which chunks through deep subgoals
+//   water-jug-rl   20 episodes of the RL water jug agent, keeping what it learns between them
+//   epmem-store    2000 decisions storing an episode each
+//   epmem-query    2000 decisions each querying an epmem store built as above
+//   smem-store     adding 20000 long-term identifiers to smem
+//   smem-query     2000 cue-based retrievals from a store built as above
+//   multi-agent    32 agents run together for 1000 decisions on 4 run threads
+//   sml-input      100 input-link wmes changed by the client every decision for 2000 decisions
+//
+// Every agent has its own random number generator, which each trial seeds with srand (the
+// multi-agent workload gives agent i the seed plus i), so agents on different run threads
+// don't draw from one sequence in whatever order they get to it.  A number of untimed
+// warm-up trials are run first.  For each workload we print the median, low and high of the
+// trials' wall clock times, and can write them as JSON with --json.  Given a baseline
+// (a file written by --json on an earlier run) each median is compared with the baseline's
+// and the program exits with 1 if any got slower by more than the tolerance.
+//
+// usage: TestBenchmarks [--trials n] [--warmup n] [--seed n] [--json file]
+//                       [--baseline file] [--tolerance percent] [--list] [workload ...]
+
+#include "portability.h"
+#include "misc.h"
+
+#include <stdlib.h>
+
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include "sml_Client.h"
+
+using namespace sml;
+using namespace std;
+
+#define DEFAULT_TRIALS 5
+#define DEFAULT_WARMUP 1
+#define DEFAULT_SEED 233391
+#define DEFAULT_TOLERANCE 10.0
+
+#define RL_EPISODES 20
+#define EPMEM_DECISIONS 2000
+#define SMEM_LTIS 20000
+#define SMEM_QUERIES 2000
+#define SMEM_ADD_BATCH 1000
+#define SMEM_GROUPS 100
+#define MULTI_AGENTS 32
+#define MULTI_DECISIONS 1000
+#define MULTI_RUN_THREADS 4
+#define INPUT_WMES 100
+#define INPUT_DECISIONS 2000
+
+// A workload sets up a kernel, times the part that matters and returns the time (seconds).
+// The seed is for srand and anything else the workload picks at random.
+typedef double (*WorkloadFunction)(int seed);
+
+struct Workload
+{
+    const char*         name;
+    WorkloadFunction    run;
+};
+
+// Measures the wall clock time between Start and Stop
+class WallTimer
+{
+    public:
+        void Start()
+        {
+            m_Timer.start();
+        }
+        
+        double Stop()
+        {
+            m_Timer.stop();
+            return m_Timer.get_usec() / 1000000.0;
+        }
+        
+    private:
+        soar_timer m_Timer;
+};
+
+// deterministic for a given seed, so every trial sees the same queries
+class BenchRandom
+{
+    public:
+        BenchRandom(int seed): state(static_cast<unsigned int>(seed)) {}
+        
+        unsigned int Next(unsigned int limit)
+        {
+            state = (state * 1103515245 + 12345) & 0x7fffffff;
+            return (state % limit);
+        }
+        
+    private:
+        unsigned int state;
+};
+
+// Reports a failed command (a benchmark that silently does nothing is worse than none)
+static void Command(Agent* agent, const string& cmd)
+{
+    agent->ExecuteCommandLine(cmd.c_str());
+    if (!agent->GetLastCommandLineResult())
+    {
+        cerr << "Command failed: " << cmd << endl << agent->GetLastErrorDescription() << endl;
+    }
+}
+
+static Agent* CreateAgent(Kernel* kernel, const char* name, int seed)
+{
+    Agent* agent = kernel->CreateAgent(name);
+    
+    agent->SetOutputLinkChangeTracking(false);
+    Command(agent, "watch 0");
+    
+    // Seeds only this agent's generator
+    ostringstream cmd;
+    cmd << "srand " << seed;
+    Command(agent, cmd.str());
+    
+    return agent;
+}
+
+static void DestroyKernel(Kernel* kernel)
+{
+    kernel->Shutdown();
+    delete kernel;
+}
+
+static double RunSourced(const char* path, const char* setup, int seed)
+{
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = CreateAgent(kernel, "bench", seed);
+    
+    Command(agent, string("source ") + path);
+    if (setup)
+    {
+        Command(agent, setup);
+    }
+    
+    WallTimer timer;
+    timer.Start();
+    agent->RunSelfForever();
+    double elapsed = timer.Stop();
+    
+    DestroyKernel(kernel);
+    return elapsed;
+}
+
+static double CountTest(int seed)
+{
+    return RunSourced("test_agents/TestSoarPerformance.soar", NULL, seed);
+}
+
+static double BigRete(int seed)
+{
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = CreateAgent(kernel, "bench", seed);
+    
+    WallTimer timer;
+    timer.Start();
+    Command(agent, "source test_agents/big.soar");
+    Command(agent, "excise --all");
+    double elapsed = timer.Stop();
+    
+    DestroyKernel(kernel);
+    return elapsed;
+}
+
+static double Chunking(int seed)
+{
+    return RunSourced("test_agents/arithmetic/arithmetic.soar", "learn --on", seed);
+}
+
+static double WaterJugRL(int seed)
+{
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = CreateAgent(kernel, "bench", seed);
+    
+    Command(agent, "source test_agents/water-jug-rl/water-jug-rl.soar");
+    
+    WallTimer timer;
+    timer.Start();
+    for (int i = 0; i < RL_EPISODES; i++)
+    {
+        agent->RunSelfForever();
+        agent->InitSoar();
+    }
+    double elapsed = timer.Stop();
+    
+    DestroyKernel(kernel);
+    return elapsed;
+}
+
+// Counts, changing a value on the top state every decision, so each episode differs from the last
+static const char* epmem_counter[] =
+{
+    "sp {bench*propose*init (state <s> ^superstate nil -^count) --> (<s> ^operator <o> +) (<o> ^name init)}",
+    "sp {bench*apply*init (state <s> ^operator.name init) --> (<s> ^count 0 ^value 0)}",
+    "sp {bench*propose*count (state <s> ^count <c>) --> (<s> ^operator <o> +) (<o> ^name count)}",
+    "sp {bench*apply*count (state <s> ^operator.name count ^count <c> ^value <v>) --> (<s> ^count <c> - (+ <c> 1) ^value <v> - (mod <c> 97))}",
+    NULL
+};
+
+// Replaces the epmem query every decision
+static const char* epmem_query[] =
+{
+    "sp {bench*query*first (state <s> ^operator.name count ^count <c> ^epmem.command <cmd>) -(<cmd> ^query) --> (<cmd> ^query <q>) (<q> ^value (mod <c> 89))}",
+    "sp {bench*query (state <s> ^operator.name count ^count <c> ^epmem.command <cmd>) (<cmd> ^query <old>) --> (<cmd> ^query <old> - <q>) (<q> ^value (mod <c> 89))}",
+    NULL
+};
+
+static void Commands(Agent* agent, const char** cmds)
+{
+    for (int i = 0; cmds[i]; i++)
+    {
+        Command(agent, cmds[i]);
+    }
+}
+
+static Agent* CreateEpMemAgent(Kernel* kernel, int seed)
+{
+    Agent* agent = CreateAgent(kernel, "bench", seed);
+    
+    Command(agent, "epmem --set learning on");
+    Command(agent, "epmem --set trigger dc");
+    Commands(agent, epmem_counter);
+    
+    return agent;
+}
+
+static double EpMemStore(int seed)
+{
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = CreateEpMemAgent(kernel, seed);
+    
+    WallTimer timer;
+    timer.Start();
+    agent->RunSelf(EPMEM_DECISIONS);
+    double elapsed = timer.Stop();
+    
+    DestroyKernel(kernel);
+    return elapsed;
+}
+
+static double EpMemQuery(int seed)
+{
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = CreateEpMemAgent(kernel, seed);
+    
+    agent->RunSelf(EPMEM_DECISIONS);
+    Commands(agent, epmem_query);
+    
+    WallTimer timer;
+    timer.Start();
+    agent->RunSelf(EPMEM_DECISIONS);
+    double elapsed = timer.Stop();
+    
+    DestroyKernel(kernel);
+    return elapsed;
+}
+
+static void BuildSMemStore(Agent* agent)
+{
+    for (int base = 0; base < SMEM_LTIS; base += SMEM_ADD_BATCH)
+    {
+        ostringstream cmd;
+        int end = ((base + SMEM_ADD_BATCH) < SMEM_LTIS) ? (base + SMEM_ADD_BATCH) : (SMEM_LTIS);
+        
+        cmd << "smem --add {";
+        for (int i = base; i < end; i++)
+        {
+            cmd << "(<n" << i << "> ^id " << i << " ^group " << (i % SMEM_GROUPS) << " ^weight " << (i * 0.5);
+            if ((i + 1) < end)
+            {
+                cmd << " ^next <n" << (i + 1) << ">";
+            }
+            cmd << ") ";
+        }
+        cmd << "}";
+        
+        Command(agent, cmd.str());
+    }
+}
+
+static double SMemStore(int seed)
+{
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = CreateAgent(kernel, "bench", seed);
+    
+    WallTimer timer;
+    timer.Start();
+    BuildSMemStore(agent);
+    double elapsed = timer.Stop();
+    
+    DestroyKernel(kernel);
+    return elapsed;
+}
+
+static double SMemQuery(int seed)
+{
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = CreateAgent(kernel, "bench", seed);
+    
+    BuildSMemStore(agent);
+    
+    BenchRandom rand(seed);
+    
+    WallTimer timer;
+    timer.Start();
+    for (int i = 0; i < SMEM_QUERIES; i++)
+    {
+        ostringstream cmd;
+        if (i % 2)
+        {
+            cmd << "smem --query {(<cue> ^group " << rand.Next(SMEM_GROUPS) << " ^weight <w>)}";
+        }
+        else
+        {
+            cmd << "smem --query {(<cue> ^id " << rand.Next(SMEM_LTIS) << " ^next <x>)}";
+        }
+        
+        Command(agent, cmd.str());
+    }
+    double elapsed = timer.Stop();
+    
+    DestroyKernel(kernel);
+    return elapsed;
+}
+
+static double MultiAgent(int seed)
+{
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    
+    for (int i = 0; i < MULTI_AGENTS; i++)
+    {
+        ostringstream name;
+        name << "bench" << i;
+        
+        Agent* agent = CreateAgent(kernel, name.str().c_str(), seed + i);
+        agent->LoadProductions("test_agents/TestSMLPerformance.soar");
+    }
+    
+    kernel->SetRunThreads(MULTI_RUN_THREADS);
+    
+    WallTimer timer;
+    timer.Start();
+    kernel->RunAllAgents(MULTI_DECISIONS);
+    double elapsed = timer.Stop();
+    
+    DestroyKernel(kernel);
+    return elapsed;
+}
+
+static double SMLInput(int seed)
+{
+    // In its own thread, so the input goes over the client/kernel connection
+    Kernel* kernel = Kernel::CreateKernelInNewThread();
+    Agent* agent = CreateAgent(kernel, "bench", seed);
+    
+    agent->LoadProductions("test_agents/TestSMLPerformance.soar");
+    agent->SetBlinkIfNoChange(true);
+    
+    vector<IntElement*> wmes;
+    Identifier* pInputLink = agent->GetInputLink();
+    for (int i = 0; i < INPUT_WMES; i++)
+    {
+        std::string temp;
+        wmes.push_back(pInputLink->CreateIntWME(to_string(i, temp).c_str(), 0));
+    }
+    agent->Commit();
+    
+    BenchRandom rand(seed);
+    
+    WallTimer timer;
+    timer.Start();
+    for (int d = 0; d < INPUT_DECISIONS; d++)
+    {
+        for (int i = 0; i < INPUT_WMES; i++)
+        {
+            agent->Update(wmes[i], rand.Next(1000));
+        }
+        agent->Commit();
+        agent->RunSelf(1);
+    }
+    double elapsed = timer.Stop();
+    
+    DestroyKernel(kernel);
+    return elapsed;
+}
+
+static const Workload workloads[] =
+{
+    { "count-test",   CountTest },
+    { "big-rete",     BigRete },
+    { "chunking",     Chunking },
+    { "water-jug-rl", WaterJugRL },
+    { "epmem-store",  EpMemStore },
+    { "epmem-query",  EpMemQuery },
+    { "smem-store",   SMemStore },
+    { "smem-query",   SMemQuery },
+    { "multi-agent",  MultiAgent },
+    { "sml-input",    SMLInput },
+};
+
+static const int num_workloads = sizeof(workloads) / sizeof(workloads[0]);
+
+struct Result
+{
+    string          name;
+    vector<double>  times;      // One per trial, in seconds
+    double          median;
+    double          low;
+    double          high;
+};
+
+static void Summarize(Result* pResult)
+{
+    vector<double> sorted = pResult->times;
+    sort(sorted.begin(), sorted.end());
+    
+    size_t n = sorted.size();
+    pResult->median = (n % 2) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+    pResult->low = sorted.front();
+    pResult->high = sorted.back();
+}
+
+// One workload per line, so a baseline can be read back a line at a time
+static void WriteJSON(ostream& out, const vector<Result>& results, int trials, int warmup, int seed)
+{
+    out << setiosflags(ios::fixed) << setprecision(6);
+    out << "{\n";
+    out << "  \"trials\": " << trials << ", \"warmup\": " << warmup << ", \"seed\": " << seed << ",\n";
+    out << "  \"workloads\": [\n";
+    
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        out << "    {\"name\": \"" << results[i].name << "\", \"median\": " << results[i].median
+            << ", \"low\": " << results[i].low << ", \"high\": " << results[i].high << ", \"times\": [";
+        for (size_t t = 0; t < results[i].times.size(); t++)
+        {
+            out << (t ? ", " : "") << results[i].times[t];
+        }
+        out << "]}" << ((i + 1) < results.size() ? "," : "") << "\n";
+    }
+    
+    out << "  ]\n";
+    out << "}\n";
+}
+
+// Reads the median of each workload from a file written by WriteJSON
+static bool ReadBaseline(const char* path, map<string, double>* pMedians)
+{
+    ifstream in(path);
+    if (!in)
+    {
+        return false;
+    }
+    
+    const string nameKey = "\"name\": \"";
+    const string medianKey = "\"median\": ";
+    
+    string line;
+    while (getline(in, line))
+    {
+        size_t name = line.find(nameKey);
+        size_t median = line.find(medianKey);
+        
+        if (name == string::npos || median == string::npos)
+        {
+            continue;
+        }
+        
+        name += nameKey.size();
+        size_t end = line.find('"', name);
+        
+        (*pMedians)[line.substr(name, end - name)] = atof(line.c_str() + median + medianKey.size());
+    }
+    
+    return true;
+}
+
+static void Usage(const char* program)
+{
+    cout << "usage: " << program << " [--trials n] [--warmup n] [--seed n] [--json file]" << endl;
+    cout << "       [--baseline file] [--tolerance percent] [--list] [workload ...]" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    set_working_directory_to_executable_path();
+    
+    int trials = DEFAULT_TRIALS;
+    int warmup = DEFAULT_WARMUP;
+    int seed = DEFAULT_SEED;
+    double tolerance = DEFAULT_TOLERANCE;
+    const char* jsonPath = NULL;
+    const char* baselinePath = NULL;
+    vector<string> selected;
+    
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = (i + 1) < argc;
+        
+        if (arg == "--list")
+        {
+            for (int w = 0; w < num_workloads; w++)
+            {
+                cout << workloads[w].name << endl;
+            }
+            return 0;
+        }
+        else if (arg == "--trials" && hasValue)
+        {
+            stringstream(argv[++i]) >> trials;
+        }
+        else if (arg == "--warmup" && hasValue)
+        {
+            stringstream(argv[++i]) >> warmup;
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            stringstream(argv[++i]) >> seed;
+        }
+        else if (arg == "--tolerance" && hasValue)
+        {
+            stringstream(argv[++i]) >> tolerance;
+        }
+        else if (arg == "--json" && hasValue)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--baseline" && hasValue)
+        {
+            baselinePath = argv[++i];
+        }
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            Usage(argv[0]);
+            return 2;
+        }
+        else
+        {
+            selected.push_back(arg);
+        }
+    }
+    
+    if (trials < 1 || warmup < 0)
+    {
+        Usage(argv[0]);
+        return 2;
+    }
+    
+    for (size_t s = 0; s < selected.size(); s++)
+    {
+        int w = 0;
+        while (w < num_workloads && selected[s] != workloads[w].name)
+        {
+            w++;
+        }
+        
+        if (w == num_workloads)
+        {
+            cout << "Unknown workload " << selected[s] << " (see --list)" << endl;
+            return 2;
+        }
+    }
+    
+    map<string, double> baseline;
+    if (baselinePath && !ReadBaseline(baselinePath, &baseline))
+    {
+        cout << "Couldn't read baseline " << baselinePath << endl;
+        return 2;
+    }
+    
+    cout << "========================================\n            TestBenchmarks\n========================================" << endl;
+    cout << trials << " trials (after " << warmup << " warm-up) of each workload, seed " << seed << ".\n" << endl;
+    
+    vector<Result> results;
+    
+    for (int w = 0; w < num_workloads; w++)
+    {
+        if (!selected.empty() && find(selected.begin(), selected.end(), workloads[w].name) == selected.end())
+        {
+            continue;
+        }
+        
+        cout << "***** " << workloads[w].name << " *****" << endl;
+        
+        for (int i = 0; i < warmup; i++)
+        {
+            workloads[w].run(seed);
+        }
+        
+        Result result;
+        result.name = workloads[w].name;
+        
+        for (int i = 0; i < trials; i++)
+        {
+            result.times.push_back(workloads[w].run(seed));
+        }
+        
+        Summarize(&result);
+        results.push_back(result);
+    }
+    
+    cout << endl;
+    cout << setiosflags(ios::fixed) << setprecision(3);
+    cout << setw(14) << left << "Workload" << right << setw(10) << "Median" << setw(10) << "Low" << setw(10) << "High";
+    if (baselinePath)
+    {
+        cout << setw(10) << "Baseline" << setw(10) << "Change";
+    }
+    cout << endl;
+    
+    int regressions = 0;
+    
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        cout << setw(14) << left << results[i].name << right;
+        cout << setw(10) << results[i].median << setw(10) << results[i].low << setw(10) << results[i].high;
+        
+        if (baselinePath)
+        {
+            map<string, double>::iterator iter = baseline.find(results[i].name);
+            
+            if (iter == baseline.end() || iter->second <= 0)
+            {
+                cout << setw(10) << "-";
+            }
+            else
+            {
+                double change = 100.0 * (results[i].median - iter->second) / iter->second;
+                
+                cout << setw(10) << iter->second << setw(9) << setprecision(1) << change << "%" << setprecision(3);
+                
+                if (change > tolerance)
+                {
+                    cout << "  REGRESSION";
+                    regressions++;
+                }
+            }
+        }
+        cout << endl;
+    }
+    
+    if (jsonPath)
+    {
+        ofstream out(jsonPath);
+        if (!out)
+        {
+            cout << "Couldn't write " << jsonPath << endl;
+            return 2;
+        }
+        WriteJSON(out, results, trials, warmup, seed);
+    }
+    
+    if (regressions)
+    {
+        cout << endl << regressions << " workload(s) more than " << tolerance << "% slower than the baseline." << endl;
+        return 1;
+    }
+    
+    return 0;
+}
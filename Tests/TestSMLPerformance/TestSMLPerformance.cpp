@@ -8,6 +8,18 @@
 // Thus, in the first subtest, a total of 999 events fire, whereas in the second subtest 3999 events fire.
 //
 // The number of agents to create, wmes to update, and decision cycles to run can be changed at the beginning of the main function.
+//
+// A final test measures the throughput of the two encodings a remote connection can use for its messages:
+// XML strings (generated and parsed again) and binary SML (see sml_BinarySML.h).
+// The last one compares parsing large input and trace messages into an ElementXML tree
+// with just reading them with the pull parser (see ParseXMLPull.h).
+// Finally we time round trips from a remote client on this machine to the kernel,
+// first through a local socket and then through shared memory (see sock_SharedMemory.h).
+// The very last one has 1 to 16 client threads sending small commands to a kernel in its own thread
+// and reports commands/sec and how long the slowest calls took.
+// After that we time the commands a client makes every decision over an embedded connection,
+// once sent as messages and once through the direct calls an optimized connection makes.
+// Last of all 8 agents are run on 0, 2, 4 and 8 run threads to see how well stepping them in parallel scales.
 
 #include "portability.h"
 #include "misc.h"
@@ -16,12 +28,18 @@
 
 #include <vector>
 #include <string>
+#include <algorithm>
 #include <sstream>
 #include <iostream>
 #include <time.h>
 #include "sml_Client.h"
 #include "sml_Connection.h"
+#include "sml_Utils.h"
+#include "sml_BinarySML.h"
+#include "ElementXML.h"
+#include "ParseXMLPull.h"
 #include "thread_OSspecific.h"
+#include "thread_Thread.h"
 #include "misc.h"
 
 using namespace sml;
@@ -365,6 +383,397 @@ void RunTest4(int numAgents, int numWmes, int numCycles)
     delete kernel;
 }
 
+// Builds the kind of message a client sends to update its input-link (one <wme> per changed wme)
+soarxml::ElementXML* CreateInputMessage(int numWmes)
+{
+    soarxml::ElementXML* pMsg = new soarxml::ElementXML() ;
+    pMsg->SetTagName(sml_Names::kTagSML) ;
+    pMsg->AddAttribute(sml_Names::kDocType, sml_Names::kDocType_Call) ;
+    pMsg->AddAttribute(sml_Names::kSMLVersion, sml_Names::kSMLVersionValue) ;
+    pMsg->AddAttribute(sml_Names::kID, "1234") ;
+    
+    soarxml::ElementXML* pCommand = new soarxml::ElementXML() ;
+    pCommand->SetTagName(sml_Names::kTagCommand) ;
+    pCommand->AddAttribute(sml_Names::kCommandName, sml_Names::kCommand_Input) ;
+    
+    soarxml::ElementXML* pArg = new soarxml::ElementXML() ;
+    pArg->SetTagName(sml_Names::kTagArg) ;
+    pArg->AddAttribute(sml_Names::kArgParam, sml_Names::kParamAgent) ;
+    pArg->SetCharacterData("0") ;
+    pCommand->AddChild(pArg) ;
+    
+    for (int i = 0; i < numWmes; i++)
+    {
+        std::string attr, value, timeTag;
+        soarxml::ElementXML* pWme = new soarxml::ElementXML() ;
+        pWme->SetTagName(sml_Names::kTagWME) ;
+        pWme->AddAttribute(sml_Names::kWME_Action, sml_Names::kValueAdd) ;
+        pWme->AddAttribute(sml_Names::kWME_Id, "I3") ;
+        pWme->AddAttribute(sml_Names::kWME_Attribute, to_string(i, attr).c_str()) ;
+        if (i % 2)
+        {
+            pWme->AddAttribute(sml_Names::kWME_Value, to_string(rand() / 7.0, value).c_str()) ;
+            pWme->AddAttribute(sml_Names::kWME_ValueType, sml_Names::kTypeDouble) ;
+        }
+        else
+        {
+            pWme->AddAttribute(sml_Names::kWME_Value, to_string(rand(), value).c_str()) ;
+            pWme->AddAttribute(sml_Names::kWME_ValueType, sml_Names::kTypeInt) ;
+        }
+        pWme->AddAttribute(sml_Names::kWME_TimeTag, to_string(-(i + 1), timeTag).c_str()) ;
+        pCommand->AddChild(pWme) ;
+    }
+    
+    pMsg->AddChild(pCommand) ;
+    return pMsg ;
+}
+
+void RunEncodingTest(int numWmes, int numMessages)
+{
+    soarxml::ElementXML::SetCountAllocations(true) ;
+    
+    long allocations = soarxml::ElementXML::GetAllocationCount() ;
+    soarxml::ElementXML* pMsg = CreateInputMessage(numWmes) ;
+    long buildAllocations = soarxml::ElementXML::GetAllocationCount() - allocations ;
+    
+    soar_timer timer ;
+    soar_timer_accumulator xmlTime ;
+    soar_timer_accumulator binaryTime ;
+    xmlTime.reset() ;
+    binaryTime.reset() ;
+    
+    size_t xmlBytes = 0 ;
+    size_t binaryBytes = 0 ;
+    
+    // Generate the string and parse it again, as the two ends of a remote connection do
+    allocations = soarxml::ElementXML::GetAllocationCount() ;
+    timer.reset() ;
+    timer.start() ;
+    for (int i = 0; i < numMessages; i++)
+    {
+        char* pXMLString = pMsg->GenerateXMLString(true) ;
+        xmlBytes = strlen(pXMLString) ;
+        soarxml::ElementXML* pParsed = soarxml::ElementXML::ParseXMLFromString(pXMLString) ;
+        delete pParsed ;
+        pMsg->DeleteString(pXMLString) ;
+    }
+    timer.stop() ;
+    xmlTime.update(timer) ;
+    long xmlAllocations = (soarxml::ElementXML::GetAllocationCount() - allocations) / numMessages ;
+    
+    std::string buffer ;
+    allocations = soarxml::ElementXML::GetAllocationCount() ;
+    timer.reset() ;
+    timer.start() ;
+    for (int i = 0; i < numMessages; i++)
+    {
+        BinarySML::Encode(pMsg, &buffer) ;
+        binaryBytes = buffer.size() ;
+        soarxml::ElementXML* pDecoded = BinarySML::Decode(buffer.data(), buffer.size()) ;
+        delete pDecoded ;
+    }
+    timer.stop() ;
+    binaryTime.update(timer) ;
+    long binaryAllocations = (soarxml::ElementXML::GetAllocationCount() - allocations) / numMessages ;
+    
+    cout << "Encoding " << numMessages << " messages of " << numWmes << " wmes (" << buildAllocations << " element allocations to build)" << endl ;
+    cout << "XML    : " << xmlBytes << " bytes/msg, " << xmlAllocations << " allocs/msg, " << xmlTime.get_sec() << " sec, " << numMessages / xmlTime.get_sec() << " msgs/sec" << endl ;
+    cout << "Binary : " << binaryBytes << " bytes/msg, " << binaryAllocations << " allocs/msg, " << binaryTime.get_sec() << " sec, " << numMessages / binaryTime.get_sec() << " msgs/sec" << endl ;
+    
+    delete pMsg ;
+    
+    soarxml::ElementXML::SetCountAllocations(false) ;
+}
+
+// A watch 5 style trace: a phase containing many production firings, each with its wme changes
+soarxml::ElementXML* CreateTraceMessage(int numFirings)
+{
+    soarxml::ElementXML* pTrace = new soarxml::ElementXML() ;
+    pTrace->SetTagName(sml_Names::kTagTrace) ;
+    
+    soarxml::ElementXML* pPhase = new soarxml::ElementXML() ;
+    pPhase->SetTagName(sml_Names::kTagPhase) ;
+    pPhase->AddAttribute(sml_Names::kPhase_Name, sml_Names::kPhaseName_Apply) ;
+    pPhase->AddAttribute(sml_Names::kPhase_Status, sml_Names::kPhaseStatus_Begin) ;
+    pTrace->AddChild(pPhase) ;
+    
+    for (int i = 0; i < numFirings; i++)
+    {
+        std::string name = "apply*operator*" ;
+        std::string number ;
+        name += to_string(i, number) ;
+        
+        soarxml::ElementXML* pFiring = new soarxml::ElementXML() ;
+        pFiring->SetTagName(sml_Names::kTagProduction_Firing) ;
+        
+        soarxml::ElementXML* pProduction = new soarxml::ElementXML() ;
+        pProduction->SetTagName(sml_Names::kTagProduction) ;
+        pProduction->AddAttribute(sml_Names::kProduction_Name, name.c_str()) ;
+        pFiring->AddChild(pProduction) ;
+        
+        for (int j = 0; j < 4; j++)
+        {
+            std::string attr, timeTag ;
+            soarxml::ElementXML* pWme = new soarxml::ElementXML() ;
+            pWme->SetTagName(sml_Names::kTagWME) ;
+            pWme->AddAttribute(sml_Names::kWME_TimeTag, to_string(i * 4 + j, timeTag).c_str()) ;
+            pWme->AddAttribute(sml_Names::kWME_Id, "S1") ;
+            pWme->AddAttribute(sml_Names::kWME_Attribute, to_string(j, attr).c_str()) ;
+            pWme->AddAttribute(sml_Names::kWME_Value, "<value & more>") ;
+            pFiring->AddChild(pWme) ;
+        }
+        
+        pTrace->AddChild(pFiring) ;
+    }
+    
+    return pTrace ;
+}
+
+void RunParseTest(char const* pName, soarxml::ElementXML* pMsg, int numMessages)
+{
+    char* pXMLString = pMsg->GenerateXMLString(true) ;
+    size_t length = strlen(pXMLString) ;
+    
+    soar_timer timer ;
+    soar_timer_accumulator domTime ;
+    soar_timer_accumulator pullTime ;
+    domTime.reset() ;
+    pullTime.reset() ;
+    
+    // Build the whole tree, as a connection receiving the message does
+    timer.reset() ;
+    timer.start() ;
+    for (int i = 0; i < numMessages; i++)
+    {
+        soarxml::ElementXML* pParsed = soarxml::ElementXML::ParseXMLFromString(pXMLString) ;
+        delete pParsed ;
+    }
+    timer.stop() ;
+    domTime.update(timer) ;
+    
+    // Visit every attribute in place, without building anything
+    int numAttributes = 0 ;
+    timer.reset() ;
+    timer.start() ;
+    for (int i = 0; i < numMessages; i++)
+    {
+        soarxml::ParseXMLPull parser(pXMLString, length) ;
+        
+        while (parser.Next() < soarxml::ParseXMLPull::kEndDocument)
+        {
+            if (parser.GetEventType() == soarxml::ParseXMLPull::kAttribute)
+            {
+                numAttributes++ ;
+            }
+        }
+    }
+    timer.stop() ;
+    pullTime.update(timer) ;
+    
+    cout << "Parsing " << numMessages << " " << pName << " messages (" << length << " bytes, " << numAttributes / numMessages << " attributes)" << endl ;
+    cout << "Tree : " << domTime.get_sec() << " sec, " << numMessages / domTime.get_sec() << " msgs/sec" << endl ;
+    cout << "Pull : " << pullTime.get_sec() << " sec, " << numMessages / pullTime.get_sec() << " msgs/sec" << endl ;
+    
+    pMsg->DeleteString(pXMLString) ;
+    delete pMsg ;
+}
+
+void RunRoundTripTest(int numCalls)
+{
+    Kernel* kernel = Kernel::CreateKernelInNewThread() ;
+    if (kernel->HadError())
+    {
+        cout << "Error: " << kernel->GetLastErrorDescription() << endl ;
+    }
+    
+    soar_timer timer ;
+    
+    for (int i = 0 ; i < 2 ; i++)
+    {
+        bool sharedMemory = (i == 1) ;
+        
+        Kernel* remote = Kernel::CreateRemoteConnection(true, NULL, Kernel::GetDefaultPort(), true, sharedMemory) ;
+        if (remote->HadError())
+        {
+            cout << "Error: " << remote->GetLastErrorDescription() << endl ;
+            delete remote ;
+            continue ;
+        }
+        
+        soar_timer_accumulator callTime ;
+        callTime.reset() ;
+        
+        timer.reset() ;
+        timer.start() ;
+        for (int call = 0 ; call < numCalls ; call++)
+        {
+            remote->IsSoarRunning() ;
+        }
+        timer.stop() ;
+        callTime.update(timer) ;
+        
+        cout << (sharedMemory ? "Shared memory" : "Local socket ") << " : " << numCalls << " round trips, " << static_cast<double>(callTime.get_usec()) / numCalls << " usec/call" << endl ;
+        
+        delete remote ;
+    }
+    
+    kernel->Shutdown() ;
+    delete kernel ;
+}
+
+// Sends small commands to the kernel as fast as it can, timing each one
+class CommandThread : public soar_thread::Thread
+{
+    public:
+        CommandThread(Kernel* pKernel, int numCalls)
+        {
+            m_pKernel = pKernel ;
+            m_NumCalls = numCalls ;
+        }
+        
+        // The time each call took (usecs)
+        vector<uint64_t> m_Times ;
+        
+        void Run()
+        {
+            soar_timer timer ;
+            m_Times.reserve(m_NumCalls) ;
+            
+            for (int call = 0 ; call < m_NumCalls ; call++)
+            {
+                timer.reset() ;
+                timer.start() ;
+                m_pKernel->IsSoarRunning() ;
+                timer.stop() ;
+                m_Times.push_back(timer.get_usec()) ;
+            }
+        }
+        
+    protected:
+        Kernel* m_pKernel ;
+        int     m_NumCalls ;
+} ;
+
+void RunCommandThreadTest(int numCalls)
+{
+    Kernel* kernel = Kernel::CreateKernelInNewThread() ;
+    if (kernel->HadError())
+    {
+        cout << "Error: " << kernel->GetLastErrorDescription() << endl ;
+    }
+    
+    soar_timer timer ;
+    
+    for (int numThreads = 1 ; numThreads <= 16 ; numThreads *= 2)
+    {
+        vector<CommandThread*> threads ;
+        
+        timer.reset() ;
+        timer.start() ;
+        for (int i = 0 ; i < numThreads ; i++)
+        {
+            threads.push_back(new CommandThread(kernel, numCalls / numThreads)) ;
+            threads.back()->Start() ;
+        }
+        
+        vector<uint64_t> times ;
+        for (int i = 0 ; i < numThreads ; i++)
+        {
+            while (!threads[i]->IsStopped())
+            {
+                sml::Sleep(0, 1) ;
+            }
+            
+            times.insert(times.end(), threads[i]->m_Times.begin(), threads[i]->m_Times.end()) ;
+            delete threads[i] ;
+        }
+        timer.stop() ;
+        
+        sort(times.begin(), times.end()) ;
+        
+        cout << numThreads << " client thread(s) : " << times.size() * 1000000.0 / timer.get_usec() << " cmds/sec, "
+             << "median " << times[times.size() / 2] << " usec, "
+             << "99% " << times[times.size() * 99 / 100] << " usec, "
+             << "max " << times.back() << " usec" << endl ;
+    }
+    
+    kernel->Shutdown() ;
+    delete kernel ;
+}
+
+void RunDirectCallTest(int numCalls)
+{
+    soar_timer timer ;
+    
+    for (int i = 0 ; i < 2 ; i++)
+    {
+        bool optimized = (i == 1) ;
+        
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(optimized, Kernel::kUseAnyPort) ;
+        if (kernel->HadError())
+        {
+            cout << "Error: " << kernel->GetLastErrorDescription() << endl ;
+            delete kernel ;
+            continue ;
+        }
+        
+        Agent* agent = kernel->CreateAgent("direct") ;
+        
+        timer.reset() ;
+        timer.start() ;
+        for (int call = 0 ; call < numCalls ; call++)
+        {
+            kernel->IsSoarRunning() ;
+            agent->GetDecisionCycleCounter() ;
+            agent->GetRunState() ;
+            agent->GetResultOfLastRun() ;
+        }
+        timer.stop() ;
+        
+        cout << (optimized ? "Direct calls" : "SML messages") << " : " << numCalls * 4 << " commands, "
+             << static_cast<double>(timer.get_usec()) / (numCalls * 4) << " usec/command" << endl ;
+             
+        kernel->Shutdown() ;
+        delete kernel ;
+    }
+}
+
+void RunParallelRunTest(int numAgents, int numWmes, int numCycles)
+{
+    soar_timer timer ;
+    int threadCounts[] = { 0, 2, 4, 8 } ;
+    
+    for (int i = 0 ; i < 4 ; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInNewThread() ;
+        if (kernel->HadError())
+        {
+            cout << "Error: " << kernel->GetLastErrorDescription() << endl ;
+            delete kernel ;
+            continue ;
+        }
+        
+        kernel->SetAutoCommit(false) ;
+        kernel->SetRunThreads(threadCounts[i]) ;
+        
+        Environment* pEnv = new Environment(kernel, numAgents, numWmes) ;
+        kernel->RegisterForUpdateEvent(smlEVENT_AFTER_ALL_OUTPUT_PHASES, UpdateEnvironmentAndAgents, pEnv) ;
+        
+        timer.reset() ;
+        timer.start() ;
+        kernel->RunAllAgents(numCycles) ;
+        timer.stop() ;
+        
+        cout << "Run threads " << threadCounts[i] << " : " << numAgents << " agents, "
+             << static_cast<double>(timer.get_usec()) / 1000000 << " sec" << endl ;
+             
+        delete pEnv ;
+        
+        kernel->Shutdown() ;
+        delete kernel ;
+    }
+}
+
 int main()
 {
 #ifdef _DEBUG
@@ -393,6 +802,19 @@ int main()
         ResetEventCounts();
         RunTest4(numAgents, numWmes, numCycles);
         
+        RunEncodingTest(numWmes, numCycles);
+        
+        RunParseTest("input", CreateInputMessage(1000), 500);
+        RunParseTest("trace", CreateTraceMessage(500), 500);
+        
+        RunRoundTripTest(10000);
+        
+        RunCommandThreadTest(20000);
+        
+        RunDirectCallTest(100000);
+        
+        RunParallelRunTest(8, numWmes, numCycles);
+        
         //cout << endl << endl << "Press enter to exit.";
         //cin.get();
     }
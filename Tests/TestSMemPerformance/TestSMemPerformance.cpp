@@ -0,0 +1,164 @@
+#include "portability.h"
+
+#include <stdlib.h>
+
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include "sml_Client.h"
+#include "sml_Connection.h"
+
+// Builds a large semantic store and times cue-based retrievals
+// against it, once with the native store and once with every
+// read going through SQLite.
+
+#define DEFAULT_LTIS 1000000
+#define DEFAULT_QUERIES 10000
+#define ADD_BATCH 1000
+#define GROUPS 1000
+#define NUM_COLORS 8
+
+using namespace std;
+using namespace sml;
+
+static const char* colors[ NUM_COLORS ] = { "red", "orange", "yellow", "green", "blue", "indigo", "violet", "black" };
+
+// deterministic so both configurations see the same queries
+class QueryRandom
+{
+    public:
+        QueryRandom(): state(233391) {}
+        
+        unsigned int Next(unsigned int limit)
+        {
+            state = (state * 1103515245 + 12345) & 0x7fffffff;
+            return (state % limit);
+        }
+        
+    private:
+        unsigned int state;
+};
+
+double GetTimer(Agent* agent, const char* timer)
+{
+    string cmd("smem --timers ");
+    cmd += timer;
+    
+    string result = agent->ExecuteCommandLine(cmd.c_str());
+    size_t start = result.find_first_of("0123456789");
+    
+    return (start == string::npos) ? (0.0) : (atof(result.c_str() + start));
+}
+
+// runs a command under "time", returning the elapsed real seconds
+double TimeCommand(Agent* agent, const string& cmd)
+{
+    ClientAnalyzedXML response;
+    agent->ExecuteCommandLineXML((string("time ") + cmd).c_str(), &response);
+    
+    return response.GetArgFloat(sml_Names::kParamRealSeconds, 0.0);
+}
+
+double BuildStore(Agent* agent, int numLTIs)
+{
+    double elapsed = 0.0;
+    
+    for (int base = 0; base < numLTIs; base += ADD_BATCH)
+    {
+        ostringstream cmd;
+        int end = ((base + ADD_BATCH) < numLTIs) ? (base + ADD_BATCH) : (numLTIs);
+        
+        cmd << "smem --add {";
+        for (int i = base; i < end; i++)
+        {
+            cmd << "(<n" << i << "> ^id " << i << " ^group " << (i % GROUPS) << " ^color " << colors[ i % NUM_COLORS ] << " ^weight " << (i * 0.5);
+            if ((i + 1) < end)
+            {
+                cmd << " ^next <n" << (i + 1) << ">";
+            }
+            cmd << ") ";
+        }
+        cmd << "}";
+        
+        elapsed += TimeCommand(agent, cmd.str());
+        if (!agent->GetLastCommandLineResult())
+        {
+            cout << "smem --add failed: " << agent->GetLastErrorDescription() << endl;
+            break;
+        }
+    }
+    
+    return elapsed;
+}
+
+void Test(bool nativeStore, int numLTIs, int numQueries)
+{
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = kernel->CreateAgent("Soar1");
+    
+    agent->ExecuteCommandLine("watch 0");
+    agent->ExecuteCommandLine("smem --set timers three");
+    agent->ExecuteCommandLine(nativeStore ? "smem --set native-store on" : "smem --set native-store off");
+    
+    cout << "***** " << (nativeStore ? "native store" : "sqlite reads") << " *****" << endl;
+    
+    double storage = BuildStore(agent, numLTIs);
+    double real = 0.0;
+    
+    QueryRandom rand;
+    for (int i = 0; i < numQueries; i++)
+    {
+        ostringstream cmd;
+        if (i % 2)
+        {
+            cmd << "smem --query {(<cue> ^group " << rand.Next(GROUPS) << " ^color " << colors[ rand.Next(NUM_COLORS) ] << ")}";
+        }
+        else
+        {
+            cmd << "smem --query {(<cue> ^id " << rand.Next(numLTIs) << " ^next <x>)}";
+        }
+        
+        real += TimeCommand(agent, cmd.str());
+    }
+    
+    double query = GetTimer(agent, "smem_query");
+    
+    cout << setiosflags(ios::fixed) << setprecision(3);
+    cout << setw(24) << left << "store (s):" << setw(12) << right << storage << endl;
+    cout << setw(24) << left << "query timer (s):" << setw(12) << right << query << endl;
+    cout << setw(24) << left << "query real (s):" << setw(12) << right << real << endl;
+    cout << setw(24) << left << "per query (us):" << setw(12) << right << ((query * 1000000.0) / numQueries) << endl;
+    cout << endl;
+    
+    kernel->Shutdown();
+    delete kernel;
+}
+
+int main(int argc, char* argv[])
+{
+    int numLTIs = DEFAULT_LTIS;
+    int numQueries = DEFAULT_QUERIES;
+    
+    if (argc > 3)
+    {
+        cout << "usage: " << argv[0] << " [<num ltis>] [<num queries>]" << endl;
+        return 1;
+    }
+    if (argc > 1)
+    {
+        stringstream(argv[1]) >> numLTIs;
+    }
+    if (argc > 2)
+    {
+        stringstream(argv[2]) >> numQueries;
+    }
+    
+    cout << "========================================\n         TestSMemPerformance\n========================================" << endl;
+    cout << "Storing " << numLTIs << " long-term identifiers and running " << numQueries << " queries.\n" << endl;
+    
+    Test(true, numLTIs, numQueries);
+    Test(false, numLTIs, numQueries);
+    
+    return 0;
+}
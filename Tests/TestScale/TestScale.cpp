@@ -0,0 +1,775 @@
+// Generates Soar programs and input streams of a given size and runs them, reporting
+// throughput and memory, so we can see how the rete, working memory, epmem and smem
+// scale instead of guessing from the small test agents.
+//
+// The scenarios:
+//   rete    sources --productions generated productions and runs --decisions decisions
+//           with the generated input changing underneath them
+//   wm      runs --decisions decisions of input churn over --items items with no
+//           generated productions, so it's just working memory changes
+//   epmem   stores an episode every decision for --episodes decisions of input churn
+//   smem    adds a generated store of --smem-size long-term identifiers, then runs
+//           --queries cue-based retrievals against it
+//
+// The generated programs:
+//   Each input-link ^item has --attributes attributes (a0, a1, ...), each with --multi
+//   values.  The values are drawn from a range sized so each attribute/value pair is
+//   shared by about --fanout items.  A production joins a chain of --conditions items,
+//   each linked to the one before it by a shared value, so it has about fanout^conditions
+//   matches.  The first item also tests a constant, and each production adds --negations
+//   negated conditions and --nccs conjunctive negations on the items it has bound.
+//   Every decision, --churn percent of the item values are changed.
+//
+// Everything is generated from --seed, so a run can be repeated.  --steps n runs each
+// scenario n times, doubling its size (productions, items, episodes or smem-size) each
+// time, for a scaling curve.  --generate writes the program, smem store and input stream
+// to files named from --out instead of running them.
+//
+// usage: TestScale [--seed n] [--steps n] [--generate] [--out prefix] [--<knob> n ...]
+//                  [scenario ...]
+
+#include "portability.h"
+#include "misc.h"
+
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include "sml_Client.h"
+#include "sml_Connection.h"
+
+using namespace sml;
+using namespace std;
+
+#define DEFAULT_SEED 233391
+#define DEFAULT_OUT "scale"
+#define SMEM_ADD_BATCH 1000
+#define SMEM_GROUPS 100
+
+// The knobs, each settable with --<name> n
+struct ScaleParams
+{
+    int seed;
+    int productions;
+    int conditions;
+    int negations;
+    int nccs;
+    int items;
+    int attributes;
+    int multi;
+    int fanout;
+    int churn;          // percent of values changed per decision
+    int decisions;
+    int episodes;
+    int smemSize;
+    int smemEdges;
+    int queries;
+};
+
+struct Knob
+{
+    const char*         name;
+    int ScaleParams::*  value;
+    int                 initial;
+    const char*         description;
+};
+
+static const Knob knobs[] =
+{
+    { "productions", &ScaleParams::productions, 10000,  "generated productions (rete)" },
+    { "conditions",  &ScaleParams::conditions,  3,      "items joined by each production" },
+    { "negations",   &ScaleParams::negations,   1,      "negated conditions per production" },
+    { "nccs",        &ScaleParams::nccs,        0,      "conjunctive negations per production" },
+    { "items",       &ScaleParams::items,       1000,   "input-link items" },
+    { "attributes",  &ScaleParams::attributes,  4,      "attributes per item" },
+    { "multi",       &ScaleParams::multi,       1,      "values per item attribute" },
+    { "fanout",      &ScaleParams::fanout,      2,      "items sharing each attribute value" },
+    { "churn",       &ScaleParams::churn,       10,     "percent of values changed each decision" },
+    { "decisions",   &ScaleParams::decisions,   1000,   "decisions run (rete, wm)" },
+    { "episodes",    &ScaleParams::episodes,    10000,  "episodes stored (epmem)" },
+    { "smem-size",   &ScaleParams::smemSize,    100000, "long-term identifiers (smem)" },
+    { "smem-edges",  &ScaleParams::smemEdges,   2,      "links from each long-term identifier" },
+    { "queries",     &ScaleParams::queries,     1000,   "smem retrievals" },
+};
+
+static const int num_knobs = sizeof(knobs) / sizeof(knobs[0]);
+
+// deterministic for a given seed, so the same knobs always generate the same program
+class ScaleRandom
+{
+    public:
+        ScaleRandom(int seed): state(static_cast<unsigned int>(seed)) {}
+        
+        unsigned int Next(unsigned int limit)
+        {
+            state = (state * 1103515245 + 12345) & 0x7fffffff;
+            return (limit ? (state % limit) : 0);
+        }
+        
+    private:
+        unsigned int state;
+};
+
+// Number of distinct values an attribute can have, so each value is shared by about fanout items
+static int ValueRange(const ScaleParams& params)
+{
+    int range = (params.items * params.multi) / ((params.fanout > 0) ? params.fanout : 1);
+    return (range > 0) ? range : 1;
+}
+
+/////////////////////////////////////////////////////////////////
+// Generators
+/////////////////////////////////////////////////////////////////
+
+// The operator that runs every decision (as in TestBenchmarks' epmem workloads), so the
+// agent never impasses and sinks into substates
+static void GenerateCounter(ostream& out)
+{
+    out << "sp {scale*propose*init (state <s> ^superstate nil -^count) --> (<s> ^operator <o> +) (<o> ^name init)}\n";
+    out << "sp {scale*apply*init (state <s> ^operator.name init) --> (<s> ^count 0)}\n";
+    out << "sp {scale*propose*count (state <s> ^count <c>) --> (<s> ^operator <o> +) (<o> ^name count)}\n";
+    out << "sp {scale*apply*count (state <s> ^operator.name count ^count <c>) --> (<s> ^count <c> - (+ <c> 1))}\n";
+}
+
+static void GenerateProductions(const ScaleParams& params, ostream& out)
+{
+    ScaleRandom rand(params.seed);
+    int range = ValueRange(params);
+    int conditions = (params.conditions > 0) ? params.conditions : 1;
+    
+    if (params.multi > 1)
+    {
+        for (int a = 0; a < params.attributes; a++)
+        {
+            out << "multi-attributes a" << a << " " << params.multi << "\n";
+        }
+    }
+    
+    for (int p = 0; p < params.productions; p++)
+    {
+        out << "sp {scale*match*" << p << "\n";
+        out << "    (state <s> ^io.input-link <il>)\n";
+        
+        // A chain of items: <ik> joins on the value <v(k-1)> bound by the item before it
+        for (int k = 1; k <= conditions; k++)
+        {
+            int joinAttr = rand.Next(params.attributes);
+            int nextAttr = rand.Next(params.attributes);
+            
+            out << "    (<il> ^item <i" << k << ">)\n";
+            out << "    (<i" << k << "> ^a" << joinAttr << " ";
+            if (k == 1)
+            {
+                out << rand.Next(range);
+            }
+            else
+            {
+                out << "<v" << (k - 1) << ">";
+            }
+            out << " ^a" << nextAttr << " <v" << k << ">)\n";
+        }
+        
+        for (int n = 0; n < params.negations; n++)
+        {
+            out << "   -(<i" << (rand.Next(conditions) + 1) << "> ^a" << rand.Next(params.attributes) << " " << rand.Next(range) << ")\n";
+        }
+        
+        for (int n = 0; n < params.nccs; n++)
+        {
+            out << "   -{(<il> ^item <n" << n << ">)\n";
+            out << "     (<n" << n << "> ^a" << rand.Next(params.attributes) << " <v" << (rand.Next(conditions) + 1) << ">";
+            out << " ^a" << rand.Next(params.attributes) << " " << rand.Next(range) << ")}\n";
+        }
+        
+        out << "-->\n";
+        out << "    (<s> ^match " << p << ")}\n";
+    }
+}
+
+// Writes the store as smem --add commands of SMEM_ADD_BATCH identifiers each.  Links only
+// go to identifiers in the same batch, since the variables are local to the command.
+static void GenerateSMemStore(const ScaleParams& params, ostream& out)
+{
+    ScaleRandom rand(params.seed);
+    int range = ValueRange(params);
+    
+    for (int base = 0; base < params.smemSize; base += SMEM_ADD_BATCH)
+    {
+        int end = ((base + SMEM_ADD_BATCH) < params.smemSize) ? (base + SMEM_ADD_BATCH) : (params.smemSize);
+        
+        out << "smem --add {";
+        for (int i = base; i < end; i++)
+        {
+            out << "(<n" << i << "> ^id " << i << " ^group " << (i % SMEM_GROUPS) << " ^value " << rand.Next(range);
+            for (int e = 0; e < params.smemEdges; e++)
+            {
+                out << " ^link <n" << (base + rand.Next(end - base)) << ">";
+            }
+            out << ") ";
+        }
+        out << "}\n";
+    }
+}
+
+// One value of one item's attribute
+struct ValueChange
+{
+    int item;
+    int attribute;
+    int slot;           // which of the attribute's values (see --multi)
+    int value;
+};
+
+// Generates the input: the items' first values, then the values changed each decision
+class InputStream
+{
+    public:
+        InputStream(const ScaleParams& params): m_Params(params), m_Rand(params.seed), m_Range(ValueRange(params)) {}
+        
+        int NumValues() const
+        {
+            return m_Params.items * m_Params.attributes * m_Params.multi;
+        }
+        
+        void Initial(vector<ValueChange>* pValues)
+        {
+            pValues->clear();
+            for (int i = 0; i < NumValues(); i++)
+            {
+                pValues->push_back(MakeChange(i));
+            }
+        }
+        
+        void NextDecision(vector<ValueChange>* pChanges)
+        {
+            pChanges->clear();
+            
+            int count = (NumValues() * m_Params.churn) / 100;
+            for (int c = 0; c < count; c++)
+            {
+                pChanges->push_back(MakeChange(m_Rand.Next(NumValues())));
+            }
+        }
+        
+        // Index into the flat list of values Initial returns
+        int Index(const ValueChange& change) const
+        {
+            return ((change.item * m_Params.attributes) + change.attribute) * m_Params.multi + change.slot;
+        }
+        
+    private:
+        ValueChange MakeChange(int index)
+        {
+            ValueChange change;
+            change.slot = index % m_Params.multi;
+            change.attribute = (index / m_Params.multi) % m_Params.attributes;
+            change.item = index / (m_Params.multi * m_Params.attributes);
+            change.value = m_Rand.Next(m_Range);
+            return change;
+        }
+        
+        const ScaleParams&  m_Params;
+        ScaleRandom         m_Rand;
+        int                 m_Range;
+};
+
+// A line per value: "item <n> a<k> <value>" for the first values, then "decision <d>"
+// followed by "update <n> a<k> <slot> <value>" for each change in that decision
+static void WriteInputStream(const ScaleParams& params, ostream& out)
+{
+    InputStream input(params);
+    vector<ValueChange> values;
+    
+    input.Initial(&values);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        out << "item " << values[i].item << " a" << values[i].attribute << " " << values[i].value << "\n";
+    }
+    
+    for (int d = 0; d < params.decisions; d++)
+    {
+        input.NextDecision(&values);
+        
+        out << "decision " << d << "\n";
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            out << "update " << values[i].item << " a" << values[i].attribute << " " << values[i].slot << " " << values[i].value << "\n";
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////
+// Driver
+/////////////////////////////////////////////////////////////////
+
+struct ScaleResult
+{
+    int         size;           // of the knob the scenario scales
+    string      unit;           // what the rate counts
+    double      setupSeconds;   // sourcing the program or building the store
+    double      runSeconds;
+    double      count;          // units done in runSeconds
+    long long   kernelBytes;    // allocated by the kernel (as stats --memory reports it)
+    long long   peakBytes;      // peak resident size of the process so far
+};
+
+// Measures the wall clock time between Start and Stop
+class WallTimer
+{
+    public:
+        void Start()
+        {
+            m_Timer.start();
+        }
+        
+        double Stop()
+        {
+            m_Timer.stop();
+            return m_Timer.get_usec() / 1000000.0;
+        }
+        
+    private:
+        soar_timer m_Timer;
+};
+
+static void Command(Agent* agent, const string& cmd)
+{
+    agent->ExecuteCommandLine(cmd.c_str());
+    if (!agent->GetLastCommandLineResult())
+    {
+        cerr << "Command failed: " << cmd.substr(0, 200) << endl << agent->GetLastErrorDescription() << endl;
+    }
+}
+
+// Runs what a generator writes a command per line
+static void CommandLines(Agent* agent, void (*generate)(ostream&))
+{
+    stringstream text;
+    generate(text);
+    
+    string line;
+    while (getline(text, line))
+    {
+        Command(agent, line);
+    }
+}
+
+static bool WriteFile(const string& path, void (*generate)(const ScaleParams&, ostream&), const ScaleParams& params)
+{
+    ofstream out(path.c_str());
+    if (!out)
+    {
+        cout << "Couldn't write " << path << endl;
+        return false;
+    }
+    generate(params, out);
+    return true;
+}
+
+static void GenerateProgram(const ScaleParams& params, ostream& out)
+{
+    GenerateCounter(out);
+    GenerateProductions(params, out);
+}
+
+static long long PeakResidentBytes()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+#ifdef __APPLE__
+        return usage.ru_maxrss;
+#else
+        return usage.ru_maxrss * 1024LL;
+#endif
+    }
+#endif
+    return 0;
+}
+
+static long long KernelBytes(Agent* agent)
+{
+    ClientAnalyzedXML response;
+    agent->ExecuteCommandLineXML("stats", &response);
+    
+    return response.GetArgInt(sml_Names::kParamStatsMemoryUsageMiscellaneous, 0LL)
+           + response.GetArgInt(sml_Names::kParamStatsMemoryUsageHash, 0LL)
+           + response.GetArgInt(sml_Names::kParamStatsMemoryUsageString, 0LL)
+           + response.GetArgInt(sml_Names::kParamStatsMemoryUsagePool, 0LL)
+           + response.GetArgInt(sml_Names::kParamStatsMemoryUsageStatsOverhead, 0LL);
+}
+
+// Puts the items on the input-link
+static void CreateInput(Agent* agent, InputStream* pInput, vector<Identifier*>* pItems, vector<IntElement*>* pValues)
+{
+    vector<ValueChange> initial;
+    pInput->Initial(&initial);
+    
+    Identifier* pInputLink = agent->GetInputLink();
+    for (size_t i = 0; i < initial.size(); i++)
+    {
+        if (static_cast<int>(pItems->size()) <= initial[i].item)
+        {
+            pItems->push_back(pInputLink->CreateIdWME("item"));
+        }
+        
+        ostringstream attribute;
+        attribute << "a" << initial[i].attribute;
+        pValues->push_back((*pItems)[initial[i].item]->CreateIntWME(attribute.str().c_str(), initial[i].value));
+    }
+    agent->Commit();
+}
+
+// Runs the decisions one at a time, changing the input before each.  Returns the number of
+// values changed.
+static double RunWithInput(Agent* agent, InputStream* pInput, vector<IntElement*>& values, int decisions)
+{
+    vector<ValueChange> changes;
+    double changed = 0;
+    
+    for (int d = 0; d < decisions; d++)
+    {
+        pInput->NextDecision(&changes);
+        for (size_t c = 0; c < changes.size(); c++)
+        {
+            agent->Update(values[pInput->Index(changes[c])], changes[c].value);
+        }
+        agent->Commit();
+        changed += changes.size();
+        
+        agent->RunSelf(1);
+    }
+    
+    return changed;
+}
+
+static Agent* CreateAgent(Kernel* kernel, const ScaleParams& params)
+{
+    Agent* agent = kernel->CreateAgent("scale");
+    
+    agent->SetOutputLinkChangeTracking(false);
+    Command(agent, "watch 0");
+    
+    ostringstream cmd;
+    cmd << "srand " << params.seed;
+    Command(agent, cmd.str());
+    
+    return agent;
+}
+
+static void Finish(Kernel* kernel, Agent* agent, ScaleResult* pResult)
+{
+    pResult->kernelBytes = KernelBytes(agent);
+    pResult->peakBytes = PeakResidentBytes();
+    
+    kernel->Shutdown();
+    delete kernel;
+}
+
+static ScaleResult RunRete(const ScaleParams& params, const string& out)
+{
+    ScaleResult result;
+    result.size = params.productions;
+    result.unit = "decisions";
+    
+    string program = out + ".soar";
+    WriteFile(program, GenerateProgram, params);
+    
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = CreateAgent(kernel, params);
+    
+    InputStream input(params);
+    vector<Identifier*> items;
+    vector<IntElement*> values;
+    CreateInput(agent, &input, &items, &values);
+    
+    WallTimer timer;
+    timer.Start();
+    Command(agent, "source " + program);
+    result.setupSeconds = timer.Stop();
+    
+    timer.Start();
+    RunWithInput(agent, &input, values, params.decisions);
+    result.runSeconds = timer.Stop();
+    result.count = params.decisions;
+    
+    Finish(kernel, agent, &result);
+    return result;
+}
+
+static ScaleResult RunWM(const ScaleParams& params, const string&)
+{
+    ScaleResult result;
+    result.size = params.items;
+    result.unit = "wme changes";
+    
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = CreateAgent(kernel, params);
+    
+    CommandLines(agent, GenerateCounter);
+    
+    InputStream input(params);
+    vector<Identifier*> items;
+    vector<IntElement*> values;
+    
+    WallTimer timer;
+    timer.Start();
+    CreateInput(agent, &input, &items, &values);
+    result.setupSeconds = timer.Stop();
+    
+    timer.Start();
+    result.count = RunWithInput(agent, &input, values, params.decisions);
+    result.runSeconds = timer.Stop();
+    
+    Finish(kernel, agent, &result);
+    return result;
+}
+
+static ScaleResult RunEpMem(const ScaleParams& params, const string&)
+{
+    ScaleResult result;
+    result.size = params.episodes;
+    result.unit = "episodes";
+    
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = CreateAgent(kernel, params);
+    
+    Command(agent, "epmem --set learning on");
+    Command(agent, "epmem --set trigger dc");
+    
+    CommandLines(agent, GenerateCounter);
+    
+    InputStream input(params);
+    vector<Identifier*> items;
+    vector<IntElement*> values;
+    
+    WallTimer timer;
+    timer.Start();
+    CreateInput(agent, &input, &items, &values);
+    result.setupSeconds = timer.Stop();
+    
+    timer.Start();
+    RunWithInput(agent, &input, values, params.episodes);
+    result.runSeconds = timer.Stop();
+    result.count = params.episodes;
+    
+    Finish(kernel, agent, &result);
+    return result;
+}
+
+static ScaleResult RunSMem(const ScaleParams& params, const string& out)
+{
+    ScaleResult result;
+    result.size = params.smemSize;
+    result.unit = "queries";
+    
+    string store = out + "-smem.soar";
+    WriteFile(store, GenerateSMemStore, params);
+    
+    Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+    Agent* agent = CreateAgent(kernel, params);
+    
+    WallTimer timer;
+    timer.Start();
+    Command(agent, "source " + store);
+    result.setupSeconds = timer.Stop();
+    
+    ScaleRandom rand(params.seed);
+    int range = ValueRange(params);
+    
+    timer.Start();
+    for (int i = 0; i < params.queries; i++)
+    {
+        ostringstream cmd;
+        if (i % 2)
+        {
+            cmd << "smem --query {(<cue> ^group " << rand.Next(SMEM_GROUPS) << " ^value " << rand.Next(range) << ")}";
+        }
+        else
+        {
+            cmd << "smem --query {(<cue> ^id " << rand.Next(params.smemSize) << " ^link <x>)}";
+        }
+        Command(agent, cmd.str());
+    }
+    result.runSeconds = timer.Stop();
+    result.count = params.queries;
+    
+    Finish(kernel, agent, &result);
+    return result;
+}
+
+typedef ScaleResult (*ScenarioFunction)(const ScaleParams& params, const string& out);
+
+struct Scenario
+{
+    const char*         name;
+    ScenarioFunction    run;
+    int ScaleParams::*  size;       // doubled each --steps
+};
+
+static const Scenario scenarios[] =
+{
+    { "rete",  RunRete,  &ScaleParams::productions },
+    { "wm",    RunWM,    &ScaleParams::items },
+    { "epmem", RunEpMem, &ScaleParams::episodes },
+    { "smem",  RunSMem,  &ScaleParams::smemSize },
+};
+
+static const int num_scenarios = sizeof(scenarios) / sizeof(scenarios[0]);
+
+static void Usage(const char* program)
+{
+    cout << "usage: " << program << " [--seed n] [--steps n] [--generate] [--out prefix] [--<knob> n ...] [scenario ...]" << endl;
+    cout << endl << "scenarios:";
+    for (int s = 0; s < num_scenarios; s++)
+    {
+        cout << " " << scenarios[s].name;
+    }
+    cout << endl << endl << "knobs:" << endl;
+    for (int k = 0; k < num_knobs; k++)
+    {
+        cout << "  --" << setw(12) << left << knobs[k].name << right << setw(8) << knobs[k].initial << "  " << knobs[k].description << endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    set_working_directory_to_executable_path();
+    
+    ScaleParams params;
+    params.seed = DEFAULT_SEED;
+    for (int k = 0; k < num_knobs; k++)
+    {
+        params.*(knobs[k].value) = knobs[k].initial;
+    }
+    
+    int steps = 1;
+    bool generate = false;
+    string out = DEFAULT_OUT;
+    vector<string> selected;
+    
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = (i + 1) < argc;
+        
+        if (arg == "--generate")
+        {
+            generate = true;
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            stringstream(argv[++i]) >> params.seed;
+        }
+        else if (arg == "--steps" && hasValue)
+        {
+            stringstream(argv[++i]) >> steps;
+        }
+        else if (arg == "--out" && hasValue)
+        {
+            out = argv[++i];
+        }
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            int k = 0;
+            while (k < num_knobs && arg.compare(2, string::npos, knobs[k].name) != 0)
+            {
+                k++;
+            }
+            
+            if (k == num_knobs || !hasValue)
+            {
+                Usage(argv[0]);
+                return 2;
+            }
+            
+            stringstream(argv[++i]) >> params.*(knobs[k].value);
+        }
+        else
+        {
+            int s = 0;
+            while (s < num_scenarios && arg != scenarios[s].name)
+            {
+                s++;
+            }
+            
+            if (s == num_scenarios)
+            {
+                Usage(argv[0]);
+                return 2;
+            }
+            
+            selected.push_back(arg);
+        }
+    }
+    
+    if (steps < 1 || params.items < 1 || params.attributes < 1 || params.multi < 1)
+    {
+        Usage(argv[0]);
+        return 2;
+    }
+    
+    if (generate)
+    {
+        if (!WriteFile(out + ".soar", GenerateProgram, params)
+                || !WriteFile(out + "-smem.soar", GenerateSMemStore, params)
+                || !WriteFile(out + "-input.txt", WriteInputStream, params))
+        {
+            return 2;
+        }
+        
+        cout << "Wrote " << out << ".soar, " << out << "-smem.soar and " << out << "-input.txt" << endl;
+        return 0;
+    }
+    
+    cout << "========================================\n               TestScale\n========================================" << endl;
+    cout << "seed " << params.seed;
+    for (int k = 0; k < num_knobs; k++)
+    {
+        cout << ", " << knobs[k].name << " " << params.*(knobs[k].value);
+    }
+    cout << endl;
+    
+    for (int s = 0; s < num_scenarios; s++)
+    {
+        if (!selected.empty() && find(selected.begin(), selected.end(), scenarios[s].name) == selected.end())
+        {
+            continue;
+        }
+        
+        cout << endl << "***** " << scenarios[s].name << " *****" << endl;
+        cout << setw(10) << "Size" << setw(12) << "Setup (s)" << setw(12) << "Run (s)" << setw(14) << "Rate (/s)"
+             << setw(14) << "Kernel (KB)" << setw(14) << "Peak RSS (KB)" << endl;
+             
+        ScaleParams stepParams = params;
+        string unit;
+        
+        for (int step = 0; step < steps; step++)
+        {
+            ScaleResult result = scenarios[s].run(stepParams, out);
+            unit = result.unit;
+            
+            cout << setiosflags(ios::fixed) << setprecision(3);
+            cout << setw(10) << result.size << setw(12) << result.setupSeconds << setw(12) << result.runSeconds;
+            cout << setprecision(0);
+            cout << setw(14) << ((result.runSeconds > 0) ? (result.count / result.runSeconds) : 0.0);
+            cout << setw(14) << (result.kernelBytes / 1024) << setw(14) << (result.peakBytes / 1024) << endl;
+            
+            stepParams.*(scenarios[s].size) *= 2;
+        }
+        
+        cout << "(rate is " << unit << " per second of run time)" << endl;
+    }
+    
+    return 0;
+}
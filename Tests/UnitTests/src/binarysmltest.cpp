@@ -0,0 +1,201 @@
+#include "portability.h"
+
+#include "unittest.h"
+
+#include <string>
+
+#include <ElementXML.h>
+#include "sml_BinarySML.h"
+#include "sml_Names.h"
+
+class BinarySMLTest : public CPPUNIT_NS::TestCase
+{
+        CPPUNIT_TEST_SUITE(BinarySMLTest);
+#ifdef DO_BINARYSML_TESTS
+        CPPUNIT_TEST(testRoundTrip);
+        CPPUNIT_TEST(testValues);
+        CPPUNIT_TEST(testBinaryData);
+        CPPUNIT_TEST(testCorrupt);
+#endif
+        CPPUNIT_TEST_SUITE_END();
+        
+    public:
+        void setUp() {}
+        void tearDown() {}
+        
+    protected:
+        void testRoundTrip();
+        void testValues();
+        void testBinaryData();
+        void testCorrupt();
+        
+    private:
+        soarxml::ElementXML* createMessage();
+        soarxml::ElementXML* roundTrip(soarxml::ElementXML const* pXML, std::string* pBuffer = NULL);
+        std::string toXML(soarxml::ElementXML const* pXML);
+        std::string roundTripValue(char const* pAttribute, char const* pValue);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BinarySMLTest);
+
+// Builds a message shaped like an input-link update: interned tags and
+// attributes, literal attributes, numeric values, a comment and CDATA.
+soarxml::ElementXML* BinarySMLTest::createMessage()
+{
+    soarxml::ElementXML* pMsg = new soarxml::ElementXML();
+    pMsg->SetTagName(sml::sml_Names::kTagSML);
+    pMsg->AddAttribute(sml::sml_Names::kDocType, sml::sml_Names::kDocType_Call);
+    pMsg->AddAttribute(sml::sml_Names::kID, "42");
+    pMsg->AddAttribute("custom-attribute", "custom value with <markup> & \"quotes\"");
+    pMsg->SetComment("a comment");
+    
+    soarxml::ElementXML* pCommand = new soarxml::ElementXML();
+    pCommand->SetTagName(sml::sml_Names::kTagCommand);
+    pCommand->AddAttribute(sml::sml_Names::kCommandName, "input");
+    
+    for (int i = 0 ; i < 5 ; i++)
+    {
+        soarxml::ElementXML* pWme = new soarxml::ElementXML();
+        pWme->SetTagName(sml::sml_Names::kTagWME);
+        pWme->AddAttribute(sml::sml_Names::kWME_Action, sml::sml_Names::kValueAdd);
+        pWme->AddAttribute(sml::sml_Names::kWME_Id, "I3");
+        pWme->AddAttribute(sml::sml_Names::kWME_Attribute, "x");
+        pWme->AddAttribute(sml::sml_Names::kWME_Value, i % 2 ? "1.5" : "-17");
+        pWme->AddAttribute(sml::sml_Names::kWME_ValueType, i % 2 ? sml::sml_Names::kTypeDouble : sml::sml_Names::kTypeInt);
+        pWme->AddAttribute(sml::sml_Names::kWME_TimeTag, "-12");
+        pCommand->AddChild(pWme);
+    }
+    
+    soarxml::ElementXML* pText = new soarxml::ElementXML();
+    pText->SetTagName("unknown-tag");
+    pText->SetCharacterData("some <text> in a CDATA section");
+    pText->SetUseCData(true);
+    pCommand->AddChild(pText);
+    
+    pMsg->AddChild(pCommand);
+    return pMsg;
+}
+
+std::string BinarySMLTest::toXML(soarxml::ElementXML const* pXML)
+{
+    char* pStr = pXML->GenerateXMLString(true);
+    std::string result(pStr);
+    soarxml::ElementXML::DeleteString(pStr);
+    return result;
+}
+
+soarxml::ElementXML* BinarySMLTest::roundTrip(soarxml::ElementXML const* pXML, std::string* pBuffer)
+{
+    std::string buffer;
+    sml::BinarySML::Encode(pXML, &buffer);
+    
+    CPPUNIT_ASSERT(sml::BinarySML::IsBinary(buffer.data(), buffer.size()));
+    
+    if (pBuffer)
+    {
+        *pBuffer = buffer;
+    }
+    
+    return sml::BinarySML::Decode(buffer.data(), buffer.size());
+}
+
+std::string BinarySMLTest::roundTripValue(char const* pAttribute, char const* pValue)
+{
+    soarxml::ElementXML xml;
+    xml.SetTagName(sml::sml_Names::kTagWME);
+    xml.AddAttribute(pAttribute, pValue);
+    
+    soarxml::ElementXML* pDecoded = roundTrip(&xml);
+    CPPUNIT_ASSERT(pDecoded != NULL);
+    CPPUNIT_ASSERT(pDecoded->GetAttribute(pAttribute) != NULL);
+    
+    std::string result(pDecoded->GetAttribute(pAttribute));
+    delete pDecoded;
+    return result;
+}
+
+void BinarySMLTest::testRoundTrip()
+{
+    soarxml::ElementXML* pMsg = createMessage();
+    
+    std::string buffer;
+    soarxml::ElementXML* pDecoded = roundTrip(pMsg, &buffer);
+    
+    CPPUNIT_ASSERT(pDecoded != NULL);
+    CPPUNIT_ASSERT(toXML(pDecoded) == toXML(pMsg));
+    CPPUNIT_ASSERT(pDecoded->GetUseCData() == false);
+    CPPUNIT_ASSERT(std::string(pDecoded->GetComment()) == "a comment");
+    
+    // The point of the exercise
+    CPPUNIT_ASSERT(buffer.size() < toXML(pMsg).size() / 2);
+    
+    // XML is never mistaken for a binary message
+    std::string xml = toXML(pMsg);
+    CPPUNIT_ASSERT(!sml::BinarySML::IsBinary(xml.data(), xml.size()));
+    
+    delete pDecoded;
+    delete pMsg;
+}
+
+void BinarySMLTest::testValues()
+{
+    char const* pValue = sml::sml_Names::kWME_Value;
+    
+    // Values must come back exactly as they were sent, whichever way they were encoded
+    char const* values[] = { "0", "-1", "17", "-9223372036854775", "123456789012345678", "1234567890123456789",
+                             "007", "-0", "+5", "1.5", "-0.25", "3.141592653589793", "0.1", "1e+20", "1.0", "1.50",
+                             "nan", "", "call", "id", "I3"
+                           };
+                           
+    for (size_t i = 0 ; i < sizeof(values) / sizeof(values[0]) ; i++)
+    {
+        CPPUNIT_ASSERT_MESSAGE(values[i], roundTripValue(pValue, values[i]) == values[i]);
+        CPPUNIT_ASSERT_MESSAGE(values[i], roundTripValue("other", values[i]) == values[i]);
+    }
+}
+
+void BinarySMLTest::testBinaryData()
+{
+    char buffer[256];
+    for (int i = 0 ; i < 256 ; i++)
+    {
+        buffer[i] = static_cast<char>(i);
+    }
+    
+    soarxml::ElementXML xml;
+    xml.SetTagName("data");
+    xml.SetBinaryCharacterData(buffer, 256);
+    
+    soarxml::ElementXML* pDecoded = roundTrip(&xml);
+    
+    CPPUNIT_ASSERT(pDecoded != NULL);
+    CPPUNIT_ASSERT(pDecoded->IsCharacterDataBinary());
+    CPPUNIT_ASSERT(pDecoded->GetCharacterDataLength() == 256);
+    CPPUNIT_ASSERT(memcmp(pDecoded->GetCharacterData(), buffer, 256) == 0);
+    
+    delete pDecoded;
+}
+
+void BinarySMLTest::testCorrupt()
+{
+    soarxml::ElementXML* pMsg = createMessage();
+    
+    std::string buffer;
+    sml::BinarySML::Encode(pMsg, &buffer);
+    
+    // Every truncation must be rejected rather than read past the end
+    for (size_t length = 0 ; length < buffer.size() ; length++)
+    {
+        CPPUNIT_ASSERT(sml::BinarySML::Decode(buffer.data(), length) == NULL);
+    }
+    
+    // As must trailing garbage and an unknown version
+    std::string extra = buffer + "x";
+    CPPUNIT_ASSERT(sml::BinarySML::Decode(extra.data(), extra.size()) == NULL);
+    
+    std::string version = buffer;
+    version[1] = static_cast<char>(sml::BinarySML::kVersion + 1);
+    CPPUNIT_ASSERT(sml::BinarySML::Decode(version.data(), version.size()) == NULL);
+    
+    delete pMsg;
+}
@@ -49,6 +49,10 @@ class CliAdapter : public cli::Cli
         {
             return false;
         }
+        virtual bool DoDeadline(eDeadlineMode mode, int64_t usec = 0)
+        {
+            return false;
+        }
         virtual bool DoDebug(std::vector< std::string >* argv = 0)
         {
             return false;
@@ -197,10 +201,18 @@ class CliAdapter : public cli::Cli
         {
             return false;
         }
+        virtual bool DoProductionCost(eProductionCostMode mode, eProductionCostSort sort = PRODUCTION_COST_SORT_MATCH, int numberToList = -1)
+        {
+            return false;
+        }
         virtual bool DoProductionFind(const ProductionFindBitset& options, const std::string& pattern)
         {
             return false;
         }
+        virtual bool DoProfile(eProfileMode mode, const std::string* pFilename = 0)
+        {
+            return false;
+        }
         virtual bool DoPushD(const std::string& directory)
         {
             return false;
@@ -285,7 +297,7 @@ class CliAdapter : public cli::Cli
         {
             return false;
         }
-        virtual bool DoTimers(bool* pSetting = 0)
+        virtual bool DoTimers(bool* pSetting = 0, bool* pCounters = 0)
         {
             return false;
         }
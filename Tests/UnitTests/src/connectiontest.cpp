@@ -0,0 +1,312 @@
+#include "portability.h"
+
+#include "unittest.h"
+#include "handlers.h"
+
+#include <string>
+
+#include "sml_Connection.h"
+#include "sml_Client.h"
+#include "sml_Utils.h"
+#include "sock_ListenerSocket.h"
+#include "sock_ClientSocket.h"
+#include "sock_Reactor.h"
+#include "sock_SharedMemory.h"
+#include "thread_Thread.h"
+
+class ConnectionTest : public CPPUNIT_NS::TestCase
+{
+        CPPUNIT_TEST_SUITE(ConnectionTest);
+#ifdef DO_CONNECTION_TESTS
+        CPPUNIT_TEST(testBatchedEventsDuringRun);
+#ifdef ENABLE_SHARED_MEMORY
+        CPPUNIT_TEST(testSharedMemoryClose);
+#endif
+#ifdef ENABLE_EPOLL
+        CPPUNIT_TEST(testSocketReassembly);
+#endif
+#endif
+        CPPUNIT_TEST_SUITE_END();
+        
+    public:
+        void setUp() {}
+        void tearDown() {}
+        
+    protected:
+        void testBatchedEventsDuringRun(); // batched print events arrive while the run that made them goes on
+        void testSharedMemoryClose();      // what's sent before a shared memory connection closes still arrives
+        void testSocketReassembly();       // a socket on a reactor puts messages back together from the pieces that arrive
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ConnectionTest);
+
+void ConnectionTest::testBatchedEventsDuringRun()
+{
+    const int kPort = sml::Kernel::kDefaultSMLPort - 3;
+    const int kDecisions = 50000;
+    
+    sml::Kernel* pServer = sml::Kernel::CreateKernelInNewThread(kPort);
+    CPPUNIT_ASSERT(pServer != NULL);
+    CPPUNIT_ASSERT_MESSAGE(pServer->GetLastErrorDescription(), !pServer->HadError());
+    
+    // Print events are the only ones this client listens for, so only the batcher sends it anything during the run
+    sml::Kernel* pClient = sml::Kernel::CreateRemoteConnection(true, 0, kPort, true);
+    CPPUNIT_ASSERT_MESSAGE(pClient->GetLastErrorDescription(), !pClient->HadError());
+    CPPUNIT_ASSERT(pClient->SetEventBatching(10, 64 * 1024, 0));
+    
+    sml::Agent* pAgent = pClient->CreateAgent("ConnectionTest");
+    CPPUNIT_ASSERT(pAgent != NULL);
+    
+    pAgent->ExecuteCommandLine("sp {init (state <s> ^superstate nil -^count) --> (<s> ^count 0)}");
+    CPPUNIT_ASSERT_MESSAGE("init", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("sp {propose*count (state <s> ^count <c>) --> (<s> ^operator <o> +) (<o> ^name count)}");
+    CPPUNIT_ASSERT_MESSAGE("propose*count", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("sp {apply*count (state <s> ^operator.name count ^count <c>) --> (<s> ^count <c> - (+ <c> 1)) (write |count | <c> (crlf))}");
+    CPPUNIT_ASSERT_MESSAGE("apply*count", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("watch 0");
+    
+    // The handler stops the run when the first batch arrives, which it can only do
+    // if the batch is sent while the run (holding the connection) is still going
+    bool printed = false;
+    pAgent->RegisterForPrintEvent(sml::smlEVENT_PRINT, Handlers::MyStopOnPrintHandler, &printed);
+    pAgent->RunSelf(kDecisions);
+    
+    CPPUNIT_ASSERT(printed);
+    CPPUNIT_ASSERT(pAgent->GetDecisionCycleCounter() < kDecisions);
+    
+    CPPUNIT_ASSERT(pClient->DestroyAgent(pAgent));
+    delete pClient;
+    pServer->Shutdown();
+    delete pServer;
+}
+
+#ifdef ENABLE_SHARED_MEMORY
+
+// Accepts one shared memory connection (the kernel's side of the handshake, as in ListenerThread)
+class SharedMemoryAcceptThread : public soar_thread::Thread
+{
+    public:
+        SharedMemoryAcceptThread(sock::ListenerSocket* pListener) : m_pListener(pListener), m_pServer(NULL) {}
+        
+        void Run()
+        {
+            for (int i = 0; i < 5000 && !m_pServer; i++)
+            {
+                sock::Socket* pSocket = m_pListener->CheckForClientConnection();
+                if (pSocket)
+                {
+                    m_pServer = sock::SharedMemory::AcceptClient(pSocket);
+                    return;
+                }
+                sml::Sleep(0, 1);
+            }
+        }
+        
+        sock::ListenerSocket* m_pListener;
+        sock::SharedMemory* m_pServer;
+};
+
+// Sends a few messages and closes straight away, while the other side may be waiting to read
+class SharedMemoryCloseThread : public soar_thread::Thread
+{
+    public:
+        SharedMemoryCloseThread(sock::SharedMemory* pSender, int messages) : m_pSender(pSender), m_Messages(messages) {}
+        
+        void Run()
+        {
+            for (int i = 0; i < m_Messages; i++)
+            {
+                m_pSender->SendString("message");
+            }
+            m_pSender->Close();
+        }
+        
+        sock::SharedMemory* m_pSender;
+        int m_Messages;
+};
+
+static sock::SharedMemory* connectSharedMemory(sock::ListenerSocket* pListener, int port, sock::SharedMemory** ppServer)
+{
+    SharedMemoryAcceptThread accept(pListener);
+    accept.Start();
+    
+    sock::SharedMemory* pClient = sock::SharedMemory::ConnectToServer(port);
+    while (!accept.IsStopped())
+    {
+        sml::Sleep(0, 1);
+    }
+    
+    *ppServer = accept.m_pServer;
+    return pClient;
+}
+
+void ConnectionTest::testSharedMemoryClose()
+{
+    const int kPort = sml::Kernel::kDefaultSMLPort - 4;
+    
+    sock::ListenerSocket listener;
+    CPPUNIT_ASSERT(listener.CreateListener(kPort, true, sock::SharedMemory::kHandshakeSuffix));
+    
+    sock::SharedMemory* pServer = NULL;
+    sock::SharedMemory* pClient = connectSharedMemory(&listener, kPort, &pServer);
+    CPPUNIT_ASSERT(pClient != NULL && pServer != NULL);
+    
+    std::string received;
+    CPPUNIT_ASSERT(pClient->SendString("hello"));
+    CPPUNIT_ASSERT(pServer->IsReadDataAvailable(1, 0));
+    CPPUNIT_ASSERT(pServer->ReceiveString(&received));
+    CPPUNIT_ASSERT(received == "hello");
+    CPPUNIT_ASSERT(pServer->SendString("world"));
+    CPPUNIT_ASSERT(pClient->ReceiveString(&received));
+    CPPUNIT_ASSERT(received == "world");
+    
+    // What was sent before the close is read first, and only then does the close show
+    CPPUNIT_ASSERT(pServer->SendString("one"));
+    CPPUNIT_ASSERT(pServer->SendString("two"));
+    pServer->Close();
+    CPPUNIT_ASSERT(pClient->IsReadDataAvailable());
+    CPPUNIT_ASSERT(pClient->ReceiveString(&received));
+    CPPUNIT_ASSERT(received == "one");
+    CPPUNIT_ASSERT(pClient->ReceiveString(&received));
+    CPPUNIT_ASSERT(received == "two");
+    CPPUNIT_ASSERT(!pClient->ReceiveString(&received));
+    CPPUNIT_ASSERT(!pClient->IsAlive());
+    delete pClient;
+    delete pServer;
+    
+    // Again with the reader already waiting when the messages and the close arrive
+    for (int i = 0; i < 20; i++)
+    {
+        pClient = connectSharedMemory(&listener, kPort, &pServer);
+        CPPUNIT_ASSERT(pClient != NULL && pServer != NULL);
+        
+        SharedMemoryCloseThread sender(pServer, i % 4);
+        sender.Start();
+        
+        for (int j = 0; j < i % 4; j++)
+        {
+            CPPUNIT_ASSERT(pClient->ReceiveString(&received));
+            CPPUNIT_ASSERT(received == "message");
+        }
+        CPPUNIT_ASSERT(!pClient->ReceiveString(&received));
+        
+        while (!sender.IsStopped())
+        {
+            sml::Sleep(0, 1);
+        }
+        delete pClient;
+        delete pServer;
+    }
+}
+
+#endif // ENABLE_SHARED_MEMORY
+
+#ifdef ENABLE_EPOLL
+
+// A client socket that can send any piece of a message, length and all
+class PieceSocket : public sock::ClientSocket
+{
+    public:
+        bool SendPiece(std::string const& data, size_t start, size_t length)
+        {
+            return SendBuffer(data.data() + start, static_cast<uint32_t>(length));
+        }
+};
+
+// A message as it goes over a socket: its length (in network order) and then the data
+static std::string wireMessage(std::string const& data)
+{
+    uint32_t netLen = htonl(static_cast<uint32_t>(data.size()));
+    return std::string(reinterpret_cast<char const*>(&netLen), sizeof(netLen)) + data;
+}
+
+void ConnectionTest::testSocketReassembly()
+{
+    const int kPort = sml::Kernel::kDefaultSMLPort - 5;
+    
+    sock::ListenerSocket listener;
+    CPPUNIT_ASSERT(listener.CreateListener(kPort, true));
+    
+    PieceSocket client;
+    CPPUNIT_ASSERT(client.ConnectToServer(NULL, kPort));
+    
+    sock::Socket* pServer = NULL;
+    for (int i = 0; i < 5000 && !pServer; i++)
+    {
+        pServer = listener.CheckForClientConnection();
+        if (!pServer)
+        {
+            sml::Sleep(0, 1);
+        }
+    }
+    CPPUNIT_ASSERT(pServer != NULL);
+    
+    // (Socket hides the data sender's SendString and ReceiveString)
+    sock::DataSender* pServerData = pServer;
+    sock::DataSender* pClientData = &client;
+    
+    sock::Reactor reactor;
+    CPPUNIT_ASSERT(reactor.IsValid());
+    CPPUNIT_ASSERT(pServer->AttachReactor(&reactor, NULL));
+    
+    // A message is only available once all of it has arrived, however it was split up
+    std::string message = wireMessage("put back together");
+    size_t pieces[] = { 2, 3, 6 };
+    size_t start = 0;
+    std::string received;
+    for (int i = 0; i < 3; i++)
+    {
+        CPPUNIT_ASSERT(client.SendPiece(message, start, pieces[i]));
+        start += pieces[i];
+        CPPUNIT_ASSERT(!pServer->IsReadDataAvailable());
+    }
+    CPPUNIT_ASSERT(client.SendPiece(message, start, message.size() - start));
+    CPPUNIT_ASSERT(pServer->IsReadDataAvailable());
+    CPPUNIT_ASSERT(pServerData->ReceiveString(&received));
+    CPPUNIT_ASSERT(received == "put back together");
+    CPPUNIT_ASSERT(!pServer->IsReadDataAvailable());
+    
+    // Two whole messages and the start of a third in one piece, and one larger than a read
+    std::string large(100000, 'x');
+    std::string several = wireMessage("first") + wireMessage("second") + wireMessage(large);
+    size_t split = several.size() - large.size() / 2;
+    CPPUNIT_ASSERT(client.SendPiece(several, 0, split));
+    CPPUNIT_ASSERT(pServer->IsReadDataAvailable());
+    CPPUNIT_ASSERT(pServerData->ReceiveString(&received));
+    CPPUNIT_ASSERT(received == "first");
+    CPPUNIT_ASSERT(pServer->IsReadDataAvailable());
+    CPPUNIT_ASSERT(pServerData->ReceiveString(&received));
+    CPPUNIT_ASSERT(received == "second");
+    CPPUNIT_ASSERT(!pServer->IsReadDataAvailable());
+    CPPUNIT_ASSERT(client.SendPiece(several, split, several.size() - split));
+    CPPUNIT_ASSERT(pServer->IsReadDataAvailable());
+    CPPUNIT_ASSERT(pServerData->ReceiveString(&received));
+    CPPUNIT_ASSERT(received == large);
+    
+    // Going the other way, what the socket won't take straight away is queued and sent on in pieces
+    CPPUNIT_ASSERT(client.AttachReactor(&reactor, NULL));
+    std::string queued(512 * 1024, 'q');
+    CPPUNIT_ASSERT(pServerData->SendString(queued.c_str()));
+    
+    sock::DataSenderStats stats;
+    pServer->GetStats(&stats);
+    CPPUNIT_ASSERT(stats.m_EventDriven);
+    CPPUNIT_ASSERT(stats.m_PeakQueuedBytes > 0);
+    
+    for (int i = 0; i < 5000 && !client.IsReadDataAvailable(); i++)
+    {
+        CPPUNIT_ASSERT(pServer->SendQueuedData());
+    }
+    CPPUNIT_ASSERT(pClientData->ReceiveString(&received));
+    CPPUNIT_ASSERT(received == queued);
+    
+    pServer->GetStats(&stats);
+    CPPUNIT_ASSERT(stats.m_QueuedBytes == 0);
+    
+    client.Close();
+    CPPUNIT_ASSERT(pServer->IsReadDataAvailable());
+    CPPUNIT_ASSERT(!pServerData->ReceiveString(&received));
+    delete pServer;
+}
+
+#endif // ENABLE_EPOLL
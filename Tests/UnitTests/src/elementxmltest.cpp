@@ -18,6 +18,10 @@ class ElementXMLTest : public CPPUNIT_NS::TestCase
         CPPUNIT_TEST(testParse);
         CPPUNIT_TEST(testBinaryData);
         CPPUNIT_TEST(testEquals);   // bug 1028
+        CPPUNIT_TEST(testCopy);
+        CPPUNIT_TEST(testReplace);
+        CPPUNIT_TEST(testReplaceParsed);
+        CPPUNIT_TEST(testPullParser);
 #endif
         CPPUNIT_TEST_SUITE_END();
         
@@ -31,6 +35,10 @@ class ElementXMLTest : public CPPUNIT_NS::TestCase
         void testParse();
         void testBinaryData();
         void testEquals();
+        void testCopy();
+        void testReplace();
+        void testReplaceParsed();
+        void testPullParser();
         
     private:
         soarxml::ElementXML* createXML1();
@@ -50,6 +58,7 @@ CPPUNIT_TEST_SUITE_REGISTRATION(ElementXMLTest);
 #include <string>
 
 #include <ElementXML.h>
+#include <ParseXMLPull.h>
 
 const std::string tag1("tag1");
 const std::string att11("att11");
@@ -337,3 +346,146 @@ void ElementXMLTest::testEquals()
     CPPUNIT_ASSERT_MESSAGE(soarxml::ElementXML::GetLastParseErrorDescription(), element != 0);
     delete element;
 }
+
+void ElementXMLTest::testCopy()
+{
+    soarxml::ElementXML* pXML1 = createXML1();
+    
+    // Replacing a value and adding enough attributes to overflow the element's own string storage
+    pXML1->AddAttribute(att11.c_str(), val41.c_str());
+    std::string longValue(2000, 'x');
+    for (int i = 0 ; i < 20 ; i++)
+    {
+        std::string att = "extra" + std::string(1, static_cast<char>('a' + i));
+        pXML1->AddAttribute(att.c_str(), (i % 2) ? longValue.c_str() : att.c_str());
+    }
+    
+    CPPUNIT_ASSERT(pXML1->GetNumberAttributes() == 22);
+    CPPUNIT_ASSERT(std::string(pXML1->GetAttribute(att11.c_str())) == val41);
+    CPPUNIT_ASSERT(std::string(pXML1->GetAttribute(att12.c_str())) == val12);
+    
+    // The copy has to own its strings, because the original is deleted first
+    soarxml::ElementXML* pCopy = pXML1->MakeCopy();
+    delete pXML1;
+    
+    CPPUNIT_ASSERT(pCopy->GetNumberAttributes() == 22);
+    CPPUNIT_ASSERT(std::string(pCopy->GetTagName()) == tag1);
+    CPPUNIT_ASSERT(std::string(pCopy->GetAttribute(att11.c_str())) == val41);
+    CPPUNIT_ASSERT(std::string(pCopy->GetAttribute("extraa")) == "extraa");
+    CPPUNIT_ASSERT(std::string(pCopy->GetAttribute("extrab")) == longValue);
+    CPPUNIT_ASSERT(std::string(pCopy->GetCharacterData()) == data1);
+    CPPUNIT_ASSERT(std::string(pCopy->GetComment()) == comment1);
+    
+    delete pCopy;
+}
+
+void ElementXMLTest::testReplace()
+{
+    soarxml::ElementXML* pXML1 = createXML1();
+    std::string longValue(3000, 'y');
+    
+    // Setting the same values over and over, growing and shrinking, past the point the element gives up on its
+    // own string storage
+    for (int i = 0 ; i < 200 ; i++)
+    {
+        std::string value = (i % 3) ? std::string(static_cast<size_t>(i % 50), 'v') : longValue;
+        pXML1->AddAttribute(att11.c_str(), value.c_str());
+        pXML1->AddAttribute(att12.c_str(), value.c_str());
+        pXML1->SetCharacterData(value.c_str());
+        pXML1->SetComment(value.c_str());
+        
+        CPPUNIT_ASSERT(pXML1->GetNumberAttributes() == 2);
+        CPPUNIT_ASSERT(std::string(pXML1->GetAttribute(att11.c_str())) == value);
+        CPPUNIT_ASSERT(std::string(pXML1->GetAttribute(att12.c_str())) == value);
+        CPPUNIT_ASSERT(std::string(pXML1->GetCharacterData()) == value);
+        CPPUNIT_ASSERT(std::string(pXML1->GetComment()) == value);
+    }
+    
+    pXML1->SetBinaryCharacterData(buffer, BUFFER_LENGTH);
+    CPPUNIT_ASSERT(pXML1->IsCharacterDataBinary());
+    CPPUNIT_ASSERT(pXML1->GetCharacterDataLength() == BUFFER_LENGTH);
+    CPPUNIT_ASSERT(verifyBuffer(pXML1->GetCharacterData()));
+    
+    pXML1->SetCharacterData(data1.c_str());
+    CPPUNIT_ASSERT(std::string(pXML1->GetCharacterData()) == data1);
+    
+    // A value set from the element's own value
+    std::string current(pXML1->GetAttribute(att11.c_str()));
+    pXML1->AddAttribute(att11.c_str(), pXML1->GetAttribute(att11.c_str()));
+    CPPUNIT_ASSERT(std::string(pXML1->GetAttribute(att11.c_str())) == current);
+    
+    delete pXML1;
+}
+
+void ElementXMLTest::testReplaceParsed()
+{
+    // Replacing the long character data leaves the arena wasteful, so the parser's later strings are
+    // allocated separately and handed over to the element that recorded them already
+    std::string longData(5000, 'x');
+    std::string doc = "<a>" + longData + "<b/>short<c/>again</a>";
+    
+    soarxml::ElementXML* pXML = soarxml::ElementXML::ParseXMLFromString(doc.c_str());
+    CPPUNIT_ASSERT(pXML != NULL);
+    CPPUNIT_ASSERT(std::string(pXML->GetCharacterData()) == "again");
+    CPPUNIT_ASSERT(pXML->GetNumberChildren() == 2);
+    
+    // More than the arena will waste, in replacements of parsed strings
+    for (int i = 0 ; i < 20 ; i++)
+    {
+        std::string value = (i % 2) ? std::string("v") : longData;
+        pXML->SetCharacterData(value.c_str());
+        pXML->AddAttribute(att11.c_str(), value.c_str());
+        
+        CPPUNIT_ASSERT(std::string(pXML->GetCharacterData()) == value);
+        CPPUNIT_ASSERT(std::string(pXML->GetAttribute(att11.c_str())) == value);
+    }
+    
+    delete pXML;
+}
+
+void ElementXMLTest::testPullParser()
+{
+    std::string doc = "<!-- note --><sml id=\"3\"><command name=\"a &lt; b\"><arg param=\"x\">10</arg><arg param=\"y\"/></command></sml><next/>";
+    
+    soarxml::ParseXMLPull parser(doc.c_str(), doc.size());
+    
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kComment);
+    CPPUNIT_ASSERT(parser.GetValue().ToString() == " note ");
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kStartElement);
+    CPPUNIT_ASSERT(parser.GetName().Equals("sml"));
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kAttribute);
+    CPPUNIT_ASSERT(parser.GetName().Equals("id"));
+    CPPUNIT_ASSERT(parser.GetValue().Equals("3"));
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kStartElement);
+    CPPUNIT_ASSERT(parser.GetName().Equals("command"));
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kAttribute);
+    CPPUNIT_ASSERT(parser.GetValue().IsEscaped());
+    CPPUNIT_ASSERT(parser.GetValue().Equals("a < b"));
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kStartElement);
+    CPPUNIT_ASSERT(parser.GetDepth() == 3);
+    CPPUNIT_ASSERT(parser.SkipElement());
+    CPPUNIT_ASSERT(parser.GetName().Equals("arg"));
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kStartElement);
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kAttribute);
+    CPPUNIT_ASSERT(parser.GetValue().Equals("y"));
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kEndElement);
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kEndElement);
+    CPPUNIT_ASSERT(parser.GetName().Equals("command"));
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kEndElement);
+    CPPUNIT_ASSERT(parser.GetDepth() == 0);
+    
+    // We stop at the end of the first document
+    CPPUNIT_ASSERT(parser.Next() == soarxml::ParseXMLPull::kEndDocument);
+    CPPUNIT_ASSERT(doc.substr(parser.GetPosition()) == "<next/>");
+    
+    // Mismatched tags are reported as errors
+    std::string bad = "<a><b></c></a>";
+    soarxml::ParseXMLPull badParser(bad.c_str(), bad.size());
+    
+    while (badParser.Next() != soarxml::ParseXMLPull::kError && badParser.GetEventType() != soarxml::ParseXMLPull::kEndDocument)
+    {
+    }
+    
+    CPPUNIT_ASSERT(badParser.IsError());
+    CPPUNIT_ASSERT(soarxml::ElementXML::ParseXMLFromString(bad.c_str()) == NULL);
+}
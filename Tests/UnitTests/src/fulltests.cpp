@@ -564,6 +564,14 @@ TEST_DEFINITION(testFilterHandler)
     // This is important -- if we don't unregister all subsequent commands will
     // come to our filter and promptly fail!
     CPPUNIT_ASSERT(m_pKernel->UnregisterForClientMessageEvent(clientFilter));
+    
+    // A filter that consumes the command supplies the output itself
+    clientFilter = m_pKernel->RegisterForClientMessageEvent(sml::sml_Names::kFilterName, Handlers::MyConsumingFilterHandler, &filterHandlerReceived) ;
+    output = m_pAgent->ExecuteCommandLine("print <s>") ;
+    CPPUNIT_ASSERT_MESSAGE(output, m_pAgent->GetLastCommandLineResult());
+    CPPUNIT_ASSERT(filterHandlerReceived);
+    CPPUNIT_ASSERT_MESSAGE(output, output == "consumed <\"command\"> & done");
+    CPPUNIT_ASSERT(m_pKernel->UnregisterForClientMessageEvent(clientFilter));
 }
 
 TEST_DEFINITION(testWMEs)
@@ -111,6 +111,29 @@ std::string Handlers::MyFilterHandler(sml::smlRhsEventId, void* pUserData, sml::
     return res ;
 }
 
+// This filter consumes every command, giving output that has to be escaped instead
+std::string Handlers::MyConsumingFilterHandler(sml::smlRhsEventId, void* pUserData, sml::Agent*, char const*, char const* pCommandLine)
+{
+    soarxml::ElementXML* pXML = soarxml::ElementXML::ParseXMLFromString(pCommandLine) ;
+    CPPUNIT_ASSERT(pXML);
+    
+    CPPUNIT_ASSERT(pXML->AddAttribute(sml::sml_Names::kFilterCommand, ""));
+    CPPUNIT_ASSERT(pXML->AddAttribute(sml::sml_Names::kFilterOutput, "consumed <\"command\"> & done"));
+    
+    char* pXMLString = pXML->GenerateXMLString(true) ;
+    CPPUNIT_ASSERT(pXMLString);
+    std::string res(pXMLString);
+    
+    pXML->DeleteString(pXMLString);
+    delete pXML ;
+    
+    CPPUNIT_ASSERT(pUserData);
+    bool* pHandlerReceived = static_cast< bool* >(pUserData);
+    *pHandlerReceived = true;
+    
+    return res ;
+}
+
 void Handlers::MyRunEventHandler(sml::smlRunEventId, void* pUserData, sml::Agent*, sml::smlPhase)
 {
     CPPUNIT_ASSERT(pUserData);
@@ -242,6 +265,19 @@ void Handlers::MyInterruptHandler(sml::smlRunEventId, void* pUserData, sml::Agen
     *pHandlerReceived = true;
 }
 
+void Handlers::MyStopOnPrintHandler(sml::smlPrintEventId, void* pUserData, sml::Agent* pAgent, char const*)
+{
+    CPPUNIT_ASSERT(pUserData);
+    bool* pHandlerReceived = static_cast< bool* >(pUserData);
+    
+    // Stopping reads the replies, which can bring more output
+    if (!*pHandlerReceived)
+    {
+        *pHandlerReceived = true;
+        pAgent->GetKernel()->StopAllAgents() ;
+    }
+}
+
 std::string Handlers::MyRhsFunctionHandler(sml::smlRhsEventId, void* pUserData, sml::Agent*, char const*, char const* pArgument)
 {
     // This is optional because the callback needs to be around for the program to function properly
@@ -0,0 +1,179 @@
+#include "portability.h"
+
+#include "unittest.h"
+
+#include <string>
+#include <vector>
+
+#include <ElementXML.h>
+#include "sml_InputBatch.h"
+#include "sml_Names.h"
+
+class InputBatchTest : public CPPUNIT_NS::TestCase
+{
+        CPPUNIT_TEST_SUITE(InputBatchTest);
+#ifdef DO_INPUTBATCH_TESTS
+        CPPUNIT_TEST(testRoundTrip);
+        CPPUNIT_TEST(testHandles);
+        CPPUNIT_TEST(testClear);
+        CPPUNIT_TEST(testCorrupt);
+#endif
+        CPPUNIT_TEST_SUITE_END();
+        
+    public:
+        void setUp() {}
+        void tearDown() {}
+        
+    protected:
+        void testRoundTrip();
+        void testHandles();
+        void testClear();
+        void testCorrupt();
+        
+    private:
+        std::string takeBatch(sml::InputBatchWriter* pWriter);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(InputBatchTest);
+
+// Returns the data the writer's current batch would send
+std::string InputBatchTest::takeBatch(sml::InputBatchWriter* pWriter)
+{
+    soarxml::ElementXML* pTag = pWriter->CreateBatchTag();
+    
+    CPPUNIT_ASSERT(pTag->IsTag(sml::sml_Names::kTagWMEBatch));
+    CPPUNIT_ASSERT(pTag->IsCharacterDataBinary());
+    CPPUNIT_ASSERT(pWriter->GetSize() == 0);
+    
+    std::string data(pTag->GetCharacterData(), pTag->GetCharacterDataLength());
+    delete pTag;
+    return data;
+}
+
+void InputBatchTest::testRoundTrip()
+{
+    sml::InputBatchWriter writer;
+    writer.AddIdWME("I2", "object", "o1", -1);
+    writer.AddStringWME("o1", "name", "block <a> & \"b\"", -2);
+    writer.AddIntWME("o1", "x", -9223372036854775807LL, -3);
+    writer.AddDoubleWME("o1", "y", 0.1, -4);
+    writer.RemoveWME(-2);
+    
+    CPPUNIT_ASSERT(writer.GetSize() == 5);
+    
+    std::string data = takeBatch(&writer);
+    
+    sml::InputBatchReader reader;
+    std::vector<sml::InputBatchChange> changes;
+    CPPUNIT_ASSERT(reader.Read(data.data(), data.size(), &changes));
+    CPPUNIT_ASSERT(changes.size() == 5);
+    
+    CPPUNIT_ASSERT(changes[0].m_Type == sml::InputBatch::kAddId);
+    CPPUNIT_ASSERT(std::string(changes[0].m_pID) == "I2");
+    CPPUNIT_ASSERT(std::string(changes[0].m_pAttribute) == "object");
+    CPPUNIT_ASSERT(std::string(changes[0].m_pValue) == "o1");
+    CPPUNIT_ASSERT(changes[0].m_TimeTag == -1);
+    
+    CPPUNIT_ASSERT(changes[1].m_Type == sml::InputBatch::kAddString);
+    CPPUNIT_ASSERT(std::string(changes[1].m_pValue) == "block <a> & \"b\"");
+    
+    CPPUNIT_ASSERT(changes[2].m_Type == sml::InputBatch::kAddInt);
+    CPPUNIT_ASSERT(changes[2].m_IntValue == -9223372036854775807LL);
+    
+    CPPUNIT_ASSERT(changes[3].m_Type == sml::InputBatch::kAddDouble);
+    CPPUNIT_ASSERT(changes[3].m_DoubleValue == 0.1);
+    CPPUNIT_ASSERT(changes[3].m_TimeTag == -4);
+    
+    CPPUNIT_ASSERT(changes[4].m_Type == sml::InputBatch::kRemove);
+    CPPUNIT_ASSERT(changes[4].m_TimeTag == -2);
+}
+
+void InputBatchTest::testHandles()
+{
+    sml::InputBatchWriter writer;
+    sml::InputBatchReader reader;
+    std::vector<sml::InputBatchChange> changes;
+    
+    writer.AddIntWME("I2", "counter", 1, -1);
+    std::string first = takeBatch(&writer);
+    
+    writer.AddIntWME("I2", "counter", 2, -2);
+    std::string second = takeBatch(&writer);
+    
+    // The second batch refers to the strings the first one defined
+    CPPUNIT_ASSERT(second.size() < first.size());
+    CPPUNIT_ASSERT(second.find("counter") == std::string::npos);
+    
+    CPPUNIT_ASSERT(reader.Read(first.data(), first.size(), &changes));
+    CPPUNIT_ASSERT(reader.Read(second.data(), second.size(), &changes));
+    CPPUNIT_ASSERT(changes.size() == 2);
+    CPPUNIT_ASSERT(std::string(changes[1].m_pAttribute) == "counter");
+    CPPUNIT_ASSERT(changes[1].m_IntValue == 2);
+    
+    // A reader that missed the first batch can't read the second
+    sml::InputBatchReader other;
+    changes.clear();
+    CPPUNIT_ASSERT(!other.Read(second.data(), second.size(), &changes));
+}
+
+void InputBatchTest::testClear()
+{
+    sml::InputBatchWriter writer;
+    sml::InputBatchReader reader;
+    std::vector<sml::InputBatchChange> changes;
+    
+    writer.AddIntWME("I2", "a", 1, -1);
+    std::string first = takeBatch(&writer);
+    CPPUNIT_ASSERT(reader.Read(first.data(), first.size(), &changes));
+    
+    // A batch that is thrown away may have defined strings the reader never sees,
+    // so the next batch has to start the table again.
+    writer.AddIntWME("I2", "b", 2, -2);
+    writer.Clear();
+    CPPUNIT_ASSERT(writer.GetSize() == 0);
+    
+    writer.AddIntWME("I2", "b", 3, -3);
+    std::string next = takeBatch(&writer);
+    
+    changes.clear();
+    CPPUNIT_ASSERT(reader.Read(next.data(), next.size(), &changes));
+    CPPUNIT_ASSERT(changes.size() == 1);
+    CPPUNIT_ASSERT(std::string(changes[0].m_pID) == "I2");
+    CPPUNIT_ASSERT(std::string(changes[0].m_pAttribute) == "b");
+    CPPUNIT_ASSERT(changes[0].m_IntValue == 3);
+}
+
+void InputBatchTest::testCorrupt()
+{
+    sml::InputBatchWriter writer;
+    writer.AddStringWME("I2", "name", "value", -1);
+    std::string data = takeBatch(&writer);
+    
+    std::vector<sml::InputBatchChange> changes;
+    
+    sml::InputBatchReader emptyReader;
+    CPPUNIT_ASSERT(!emptyReader.Read(data.data(), 0, &changes));
+    
+    // Cutting the change short must be rejected rather than read past the end
+    // (it is the last 10 bytes: type, two handles, a 6 byte string and the timetag).
+    for (size_t length = data.size() - 9 ; length < data.size() ; length++)
+    {
+        sml::InputBatchReader reader;
+        CPPUNIT_ASSERT(!reader.Read(data.data(), length, &changes));
+    }
+    
+    // As must an unknown version or change type
+    std::string version = data;
+    version[0] = static_cast<char>(sml::InputBatch::kVersion + 1);
+    sml::InputBatchReader versionReader;
+    CPPUNIT_ASSERT(!versionReader.Read(version.data(), version.size(), &changes));
+    
+    std::string type = data + static_cast<char>(100);
+    sml::InputBatchReader typeReader;
+    CPPUNIT_ASSERT(!typeReader.Read(type.data(), type.size(), &changes));
+    
+    // And a reset after the start of a batch
+    std::string reset = data + static_cast<char>(sml::InputBatch::kReset);
+    sml::InputBatchReader resetReader;
+    CPPUNIT_ASSERT(!resetReader.Read(reset.data(), reset.size(), &changes));
+}
@@ -35,6 +35,10 @@ class IOTest : public CPPUNIT_NS::TestCase
         /* -- This tests fails and seems to have for quite some time. (11-23-2013) -- */
         //CPPUNIT_TEST( testInputLeak4 );
         CPPUNIT_TEST(testOutputLeak1);   // bug 1062
+        CPPUNIT_TEST(testOutputSharedStructure);
+        CPPUNIT_TEST(testOutputCycle);
+        CPPUNIT_TEST(testOutputAddedAndRemoved);
+        CPPUNIT_TEST(testOutputLateListener);
 #endif
         CPPUNIT_TEST_SUITE_END();
         
@@ -48,8 +52,13 @@ class IOTest : public CPPUNIT_NS::TestCase
         void testInputLeak3(); // only delete identifier
         void testInputLeak4(); // do something with shared ids
         void testOutputLeak1(); // output input wme created but not destroyed
+        void testOutputSharedStructure(); // removing one of two links to an id
+        void testOutputCycle(); // cutting a cycle off from the output link
+        void testOutputAddedAndRemoved(); // a wme that comes and goes before the output phase
+        void testOutputLateListener(); // registering for output after some has gone by
         
         void createKernelAndAgents(const KernelBitset& options, int port = 12121);
+        void loadStepRules(sml::Agent* pAgent);
         
         sml::Kernel* pKernel;
         bool remote;
@@ -425,3 +434,178 @@ void IOTest::testOutputLeak1()
 #endif
     
 }
+
+// Rules that step the agent through numbered operators, one per decision
+// (init is the first).  Tests add apply*step*N rules for what each one does.
+void IOTest::loadStepRules(sml::Agent* pAgent)
+{
+    pAgent->ExecuteCommandLine("sp {propose*init (state <s> ^superstate nil -^step) --> (<s> ^operator <o> + =) (<o> ^name init)}");
+    CPPUNIT_ASSERT_MESSAGE("propose*init", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("sp {apply*init (state <s> ^operator.name init) --> (<s> ^step 1)}");
+    CPPUNIT_ASSERT_MESSAGE("apply*init", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("sp {propose*step (state <s> ^superstate nil ^step <n>) --> (<s> ^operator <o> + =) (<o> ^name step ^number <n>)}");
+    CPPUNIT_ASSERT_MESSAGE("propose*step", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("sp {apply*step (state <s> ^operator <o>) (<o> ^name step ^number <n>) --> (<s> ^step <n> - (+ <n> 1))}");
+    CPPUNIT_ASSERT_MESSAGE("apply*step", pAgent->GetLastCommandLineResult());
+}
+
+void IOTest::testOutputSharedStructure()
+{
+    KernelBitset options(0);
+    options.set(EMBEDDED);
+    options.set(USE_CLIENT_THREAD);
+    options.set(FULLY_OPTIMIZED);
+    options.set(AUTO_COMMIT_ENABLED);
+    createKernelAndAgents(options);
+    
+    sml::Agent* pAgent = pKernel->GetAgent("IOTest") ;
+    CPPUNIT_ASSERT(pAgent != 0);
+    
+    loadStepRules(pAgent);
+    pAgent->ExecuteCommandLine("sp {apply*step*1 (state <s> ^operator <o> ^io.output-link <ol>) (<o> ^name step ^number 1) --> (<ol> ^a <x> ^b <x>) (<x> ^val 1)}");
+    CPPUNIT_ASSERT_MESSAGE("apply*step*1", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("sp {apply*step*2 (state <s> ^operator <o> ^io.output-link <ol>) (<o> ^name step ^number 2) (<ol> ^a <x>) --> (<ol> ^a <x> -)}");
+    CPPUNIT_ASSERT_MESSAGE("apply*step*2", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("sp {apply*step*3 (state <s> ^operator <o> ^io.output-link <ol>) (<o> ^name step ^number 3) (<ol> ^b <x>) --> (<ol> ^b <x> - ^c done)}");
+    CPPUNIT_ASSERT_MESSAGE("apply*step*3", pAgent->GetLastCommandLineResult());
+    
+    pKernel->RunAllAgents(2);
+    sml::Identifier* pOutputLink = pAgent->GetOutputLink();
+    CPPUNIT_ASSERT(pOutputLink != 0);
+    CPPUNIT_ASSERT(pOutputLink->FindByAttribute("a", 0) != 0);
+    CPPUNIT_ASSERT(pOutputLink->FindByAttribute("b", 0) != 0);
+    
+    // The shared id loses one reference but keeps the other, so the kernel
+    // has to work out the TC from scratch
+    pKernel->RunAllAgents(1);
+    CPPUNIT_ASSERT(pOutputLink->FindByAttribute("a", 0) == 0);
+    sml::WMElement* pB = pOutputLink->FindByAttribute("b", 0);
+    CPPUNIT_ASSERT(pB != 0 && pB->IsIdentifier());
+    CPPUNIT_ASSERT(std::string("1") == pB->ConvertToIdentifier()->GetParameterValue("val"));
+    
+    // Now it's gone altogether
+    pKernel->RunAllAgents(1);
+    CPPUNIT_ASSERT(pOutputLink->FindByAttribute("b", 0) == 0);
+    CPPUNIT_ASSERT(pOutputLink->FindByAttribute("c", 0) != 0);
+}
+
+void IOTest::testOutputCycle()
+{
+    KernelBitset options(0);
+    options.set(EMBEDDED);
+    options.set(USE_CLIENT_THREAD);
+    options.set(FULLY_OPTIMIZED);
+    options.set(AUTO_COMMIT_ENABLED);
+    createKernelAndAgents(options);
+    
+    sml::Agent* pAgent = pKernel->GetAgent("IOTest") ;
+    CPPUNIT_ASSERT(pAgent != 0);
+    
+    pAgent->SetOutputLinkChangeTracking(true);
+    loadStepRules(pAgent);
+    pAgent->ExecuteCommandLine("sp {apply*step*1 (state <s> ^operator <o> ^io.output-link <ol>) (<o> ^name step ^number 1) --> (<ol> ^c <x>) (<x> ^next <y>) (<y> ^next <x> ^val 2) (<s> ^keep <y>)}");
+    CPPUNIT_ASSERT_MESSAGE("apply*step*1", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("sp {apply*step*2 (state <s> ^operator <o> ^io.output-link <ol>) (<o> ^name step ^number 2) (<ol> ^c <x>) --> (<ol> ^c <x> - ^d <z>) (<z> ^val 3)}");
+    CPPUNIT_ASSERT_MESSAGE("apply*step*2", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("sp {apply*step*3 (state <s> ^operator <o> ^keep <y>) (<o> ^name step ^number 3) (<y> ^val 2) --> (<y> ^val 2 - ^val 4)}");
+    CPPUNIT_ASSERT_MESSAGE("apply*step*3", pAgent->GetLastCommandLineResult());
+    
+    pKernel->RunAllAgents(2);
+    sml::Identifier* pOutputLink = pAgent->GetOutputLink();
+    CPPUNIT_ASSERT(pOutputLink != 0);
+    sml::WMElement* pC = pOutputLink->FindByAttribute("c", 0);
+    CPPUNIT_ASSERT(pC != 0 && pC->IsIdentifier());
+    sml::WMElement* pNext = pC->ConvertToIdentifier()->FindByAttribute("next", 0);
+    CPPUNIT_ASSERT(pNext != 0 && pNext->IsIdentifier());
+    CPPUNIT_ASSERT(std::string("2") == pNext->ConvertToIdentifier()->GetParameterValue("val"));
+    
+    // The cycle still points to itself after it's cut off from the link
+    pKernel->RunAllAgents(1);
+    CPPUNIT_ASSERT(pOutputLink->FindByAttribute("c", 0) == 0);
+    sml::WMElement* pD = pOutputLink->FindByAttribute("d", 0);
+    CPPUNIT_ASSERT(pD != 0 && pD->IsIdentifier());
+    CPPUNIT_ASSERT(std::string("3") == pD->ConvertToIdentifier()->GetParameterValue("val"));
+    
+    // So changing it isn't output
+    pAgent->ClearOutputLinkChanges();
+    pKernel->RunAllAgents(1);
+    CPPUNIT_ASSERT(pAgent->GetNumberOutputLinkChanges() == 0);
+}
+
+void IOTest::testOutputAddedAndRemoved()
+{
+    KernelBitset options(0);
+    options.set(EMBEDDED);
+    options.set(USE_CLIENT_THREAD);
+    options.set(FULLY_OPTIMIZED);
+    options.set(AUTO_COMMIT_ENABLED);
+    createKernelAndAgents(options);
+    
+    sml::Agent* pAgent = pKernel->GetAgent("IOTest") ;
+    CPPUNIT_ASSERT(pAgent != 0);
+    
+    pAgent->SetOutputLinkChangeTracking(true);
+    loadStepRules(pAgent);
+    pAgent->ExecuteCommandLine("sp {apply*step*1 (state <s> ^operator <o> ^io.output-link <ol>) (<o> ^name step ^number 1) --> (<ol> ^a 1)}");
+    CPPUNIT_ASSERT_MESSAGE("apply*step*1", pAgent->GetLastCommandLineResult());
+    
+    // ^temp is added in one wave and retracted in the next, before the output phase
+    pAgent->ExecuteCommandLine("sp {elaborate*temp (state <s> ^step 2 ^io.output-link <ol> -^flag) --> (<ol> ^temp 1)}");
+    CPPUNIT_ASSERT_MESSAGE("elaborate*temp", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("sp {elaborate*flag (state <s> ^step 2) --> (<s> ^flag true)}");
+    CPPUNIT_ASSERT_MESSAGE("elaborate*flag", pAgent->GetLastCommandLineResult());
+    
+    pKernel->RunAllAgents(1);
+    pAgent->ClearOutputLinkChanges();
+    pKernel->RunAllAgents(1);
+    
+    sml::Identifier* pOutputLink = pAgent->GetOutputLink();
+    CPPUNIT_ASSERT(pOutputLink != 0);
+    CPPUNIT_ASSERT(pOutputLink->FindByAttribute("a", 0) != 0);
+    CPPUNIT_ASSERT(pOutputLink->FindByAttribute("temp", 0) == 0);
+    CPPUNIT_ASSERT(pAgent->GetNumberOutputLinkChanges() == 1);
+}
+
+void IOTest::testOutputLateListener()
+{
+    const int kPort = sml::Kernel::kDefaultSMLPort - 2;
+    
+    sml::Kernel* pServer = sml::Kernel::CreateKernelInNewThread(kPort);
+    CPPUNIT_ASSERT(pServer != NULL);
+    CPPUNIT_ASSERT_MESSAGE(pServer->GetLastErrorDescription(), !pServer->HadError());
+    
+    // The agent's made by a client that ignores output, so no one is listening at first
+    sml::Kernel* pQuiet = sml::Kernel::CreateRemoteConnection(true, 0, kPort, true);
+    CPPUNIT_ASSERT_MESSAGE(pQuiet->GetLastErrorDescription(), !pQuiet->HadError());
+    sml::Agent* pAgent = pQuiet->CreateAgent("IOTestLate");
+    CPPUNIT_ASSERT(pAgent != NULL);
+    
+    loadStepRules(pAgent);
+    pAgent->ExecuteCommandLine("sp {apply*step*1 (state <s> ^operator <o> ^io.output-link <ol>) (<o> ^name step ^number 1) --> (<ol> ^a <x>) (<x> ^val 1)}");
+    CPPUNIT_ASSERT_MESSAGE("apply*step*1", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("sp {apply*step*2 (state <s> ^operator <o> ^io.output-link <ol>) (<o> ^name step ^number 2) --> (<ol> ^b 2)}");
+    CPPUNIT_ASSERT_MESSAGE("apply*step*2", pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("set-stop-phase --before --input");
+    pAgent->ExecuteCommandLine("watch 0");
+    pAgent->RunSelf(2);
+    
+    // A listener that turns up now is sent everything, not just the next change
+    sml::Kernel* pLate = sml::Kernel::CreateRemoteConnection(true, 0, kPort, false);
+    CPPUNIT_ASSERT_MESSAGE(pLate->GetLastErrorDescription(), !pLate->HadError());
+    sml::Agent* pLateAgent = pLate->GetAgent("IOTestLate");
+    CPPUNIT_ASSERT(pLateAgent != NULL);
+    pLateAgent->RunSelf(1);
+    
+    sml::Identifier* pOutputLink = pLateAgent->GetOutputLink();
+    CPPUNIT_ASSERT(pOutputLink != 0);
+    CPPUNIT_ASSERT(pOutputLink->FindByAttribute("b", 0) != 0);
+    sml::WMElement* pA = pOutputLink->FindByAttribute("a", 0);
+    CPPUNIT_ASSERT(pA != 0 && pA->IsIdentifier());
+    CPPUNIT_ASSERT(std::string("1") == pA->ConvertToIdentifier()->GetParameterValue("val"));
+    
+    delete pLate;
+    CPPUNIT_ASSERT(pQuiet->DestroyAgent(pAgent));
+    delete pQuiet;
+    pServer->Shutdown();
+    delete pServer;
+}
@@ -5,6 +5,9 @@
 #include "handlers.h"
 #include "kernel.h"
 #include "soar_rand.h"
+#include "misc.h"
+
+#include <ctype.h>
 
 namespace sml
 {
@@ -26,6 +29,13 @@ class MiscTest : public CPPUNIT_NS::TestCase
         CPPUNIT_TEST(testMultipleKernels);
         CPPUNIT_TEST(testSoarRand);
         CPPUNIT_TEST(testPreferenceDeallocation);
+        CPPUNIT_TEST(testProfile);
+        CPPUNIT_TEST(testProductionCost);
+        CPPUNIT_TEST(testLatencyHistogram);
+        CPPUNIT_TEST(testLatencyHistogramBuckets);
+        CPPUNIT_TEST(testDeadline);
+        CPPUNIT_TEST(testMemoryAccounting);
+        CPPUNIT_TEST(testPerfCounters);
 #ifndef SKIP_SLOW_TESTS
         CPPUNIT_TEST(testInstiationDeallocationStackOverflow);
         CPPUNIT_TEST(testSmemArithmetic);
@@ -57,6 +67,13 @@ class MiscTest : public CPPUNIT_NS::TestCase
         
         void testSoarRand();
         void testPreferenceDeallocation();
+        void testProfile();
+        void testProductionCost();
+        void testLatencyHistogram();
+        void testLatencyHistogramBuckets();
+        void testDeadline();
+        void testMemoryAccounting();
+        void testPerfCounters();
         
         void source(const std::string& path);
         
@@ -73,6 +90,10 @@ CPPUNIT_TEST_SUITE_REGISTRATION(MiscTest);
 
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <sstream>
+#include <fstream>
+#include <iterator>
 
 void MiscTest::source(const std::string& path)
 {
@@ -413,3 +434,440 @@ void MiscTest::testPreferenceDeallocation()
     CPPUNIT_ASSERT(response.GetArgInt(sml::sml_Names::kParamStatsCycleCountDecision, -1) == 6);
 }
 
+
+// Moves pos past the JSON value there (and any whitespace around it), or returns false
+static bool skipJSON(const std::string& json, size_t& pos)
+{
+    pos = json.find_first_not_of(" \t\r\n", pos);
+    if (pos == std::string::npos)
+    {
+        return false;
+    }
+    
+    char c = json[pos];
+    if (c == '{' || c == '[')
+    {
+        char close = (c == '{') ? '}' : ']';
+        pos = json.find_first_not_of(" \t\r\n", pos + 1);
+        if (pos != std::string::npos && json[pos] == close)
+        {
+            pos++;
+        }
+        else
+        {
+            for (;;)
+            {
+                if (c == '{')
+                {
+                    // a string key and a colon come before each value
+                    pos = json.find_first_not_of(" \t\r\n", pos);
+                    if (pos == std::string::npos || json[pos] != '"' || !skipJSON(json, pos) || pos >= json.size() || json[pos++] != ':')
+                    {
+                        return false;
+                    }
+                }
+                if (!skipJSON(json, pos) || pos >= json.size())
+                {
+                    return false;
+                }
+                if (json[pos] == close)
+                {
+                    pos++;
+                    break;
+                }
+                if (json[pos++] != ',')
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    else if (c == '"')
+    {
+        for (pos++; pos < json.size() && json[pos] != '"'; pos++)
+        {
+            if (json[pos] == '\\')
+            {
+                pos++;
+            }
+        }
+        if (pos++ >= json.size())
+        {
+            return false;
+        }
+    }
+    else if (c == '-' || isdigit(static_cast<unsigned char>(c)))
+    {
+        // -?digits(.digits)?([eE][+-]?digits)?
+        if (json[pos] == '-')
+        {
+            pos++;
+        }
+        size_t digits = pos;
+        while (pos < json.size() && isdigit(static_cast<unsigned char>(json[pos])))
+        {
+            pos++;
+        }
+        if (pos == digits)
+        {
+            return false;
+        }
+        if (pos < json.size() && json[pos] == '.')
+        {
+            digits = ++pos;
+            while (pos < json.size() && isdigit(static_cast<unsigned char>(json[pos])))
+            {
+                pos++;
+            }
+            if (pos == digits)
+            {
+                return false;
+            }
+        }
+        if (pos < json.size() && (json[pos] == 'e' || json[pos] == 'E'))
+        {
+            pos++;
+            if (pos < json.size() && (json[pos] == '+' || json[pos] == '-'))
+            {
+                pos++;
+            }
+            digits = pos;
+            while (pos < json.size() && isdigit(static_cast<unsigned char>(json[pos])))
+            {
+                pos++;
+            }
+            if (pos == digits)
+            {
+                return false;
+            }
+        }
+    }
+    else if (json.compare(pos, 4, "true") == 0 || json.compare(pos, 4, "null") == 0)
+    {
+        pos += 4;
+    }
+    else if (json.compare(pos, 5, "false") == 0)
+    {
+        pos += 5;
+    }
+    else
+    {
+        return false;
+    }
+    
+    size_t end = json.find_first_not_of(" \t\r\n", pos);
+    pos = (end == std::string::npos) ? json.size() : end;
+    return true;
+}
+
+static std::string readFile(const char* path)
+{
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void MiscTest::testProfile()
+{
+    source("testPreferenceDeallocation.soar");
+    
+    pAgent->ExecuteCommandLine("profile --clear");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("profile --on");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("run 10");
+    pAgent->ExecuteCommandLine("profile --off");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    
+    std::string res = pAgent->ExecuteCommandLine("profile");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("Profiler is off") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("decision-phase") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("match") != std::string::npos);
+    
+    pAgent->ExecuteCommandLine("profile --chrome profile-test.json");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("profile --flame profile-test.txt");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    
+    // The trace is one JSON object holding a complete ("X") event per span
+    std::string trace = readFile("profile-test.json");
+    size_t pos = 0;
+    CPPUNIT_ASSERT_MESSAGE(trace, skipJSON(trace, pos) && pos == trace.size());
+    CPPUNIT_ASSERT_MESSAGE(trace, trace.compare(0, 16, "{\"traceEvents\":[") == 0);
+    
+    std::istringstream events(trace);
+    std::string line;
+    int count = 0;
+    while (std::getline(events, line))
+    {
+        if (line.compare(0, 8, "{\"name\":") != 0)
+        {
+            continue;
+        }
+        
+        count++;
+        pos = 0;
+        CPPUNIT_ASSERT_MESSAGE(line, skipJSON(line, pos) && (pos == line.size() || line.substr(pos) == ","));
+        CPPUNIT_ASSERT_MESSAGE(line, line.find("\"ph\":\"X\"") != std::string::npos);
+        CPPUNIT_ASSERT_MESSAGE(line, line.find(",\"ts\":") != std::string::npos);
+        CPPUNIT_ASSERT_MESSAGE(line, line.find(",\"dur\":") != std::string::npos);
+        CPPUNIT_ASSERT_MESSAGE(line, line.find(",\"tid\":") != std::string::npos);
+    }
+    CPPUNIT_ASSERT(count > 0);
+    CPPUNIT_ASSERT_MESSAGE(trace, trace.find("{\"name\":\"decision-phase\",") != std::string::npos);
+    
+    // Each collapsed stack is "a;b;c N": frames with no spaces and a count of microseconds
+    std::istringstream stacks(readFile("profile-test.txt"));
+    bool nested = false;
+    count = 0;
+    while (std::getline(stacks, line))
+    {
+        count++;
+        size_t space = line.find(' ');
+        CPPUNIT_ASSERT_MESSAGE(line, space != std::string::npos && space > 0 && space + 1 < line.size());
+        CPPUNIT_ASSERT_MESSAGE(line, line.find_first_not_of("0123456789", space + 1) == std::string::npos);
+        
+        std::string stack = line.substr(0, space);
+        CPPUNIT_ASSERT_MESSAGE(line, stack[0] != ';' && stack[stack.size() - 1] != ';' && stack.find(";;") == std::string::npos);
+        nested = nested || (stack.find(';') != std::string::npos);
+    }
+    CPPUNIT_ASSERT(count > 0);
+    CPPUNIT_ASSERT(nested);
+    
+    remove("profile-test.json");
+    remove("profile-test.txt");
+    
+    pAgent->ExecuteCommandLine("profile --clear");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+}
+
+// The match, token, activation and test columns production-cost printed for a production
+static std::string productionCostRow(const std::string& res, const std::string& name)
+{
+    size_t end = res.find("  " + name + "\n");
+    if (end == std::string::npos)
+    {
+        return "";
+    }
+    
+    std::istringstream row(res.substr(res.rfind('\n', end) + 1));
+    std::string column;
+    std::string result;
+    for (int i = 0; i < 5 && row >> column; i++)
+    {
+        result += (i ? " " : "") + column;
+    }
+    return result;
+}
+
+void MiscTest::testProductionCost()
+{
+    // The last join of each is left unlinked (nothing has ^missing), so all of
+    // the work is in the nodes they share: each init-soar adds ^superstate and ^io
+    pAgent->ExecuteCommandLine("sp {share-a (state <s> ^superstate nil ^io <io>) (<io> ^missing a) --> (write a)}");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("production-cost --on");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("init-soar");
+    pAgent->ExecuteCommandLine("init-soar");
+    
+    std::string res = pAgent->ExecuteCommandLine("production-cost");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("Production costs are on") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(res, productionCostRow(res, "share-a") == "18 4 8 4 2");
+    
+    // A second production sharing those nodes takes half of their counts
+    pAgent->ExecuteCommandLine("sp {share-b (state <s> ^superstate nil ^io <io>) (<io> ^missing b) --> (write b)}");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("production-cost --reset");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("init-soar");
+    pAgent->ExecuteCommandLine("init-soar");
+    
+    res = pAgent->ExecuteCommandLine("production-cost");
+    CPPUNIT_ASSERT_MESSAGE(res, productionCostRow(res, "share-a") == "9 2 4 2 1");
+    CPPUNIT_ASSERT_MESSAGE(res, productionCostRow(res, "share-b") == "9 2 4 2 1");
+    
+    // Status, column headings and the single most expensive production
+    res = pAgent->ExecuteCommandLine("production-cost 1");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    CPPUNIT_ASSERT_MESSAGE(res, std::count(res.begin(), res.end(), '\n') == 3);
+    
+    pAgent->ExecuteCommandLine("production-cost --sort firing");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("production-cost --sort bogus");
+    CPPUNIT_ASSERT(!pAgent->GetLastCommandLineResult());
+    
+    pAgent->ExecuteCommandLine("production-cost --reset");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("production-cost --off");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    
+    // Nothing is counted while off
+    pAgent->ExecuteCommandLine("init-soar");
+    res = pAgent->ExecuteCommandLine("production-cost");
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("Production costs are off") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(res, productionCostRow(res, "share-a") == "0 0 0 0 0");
+}
+
+void MiscTest::testLatencyHistogram()
+{
+    source("testPreferenceDeallocation.soar");
+    
+    pAgent->ExecuteCommandLine("run 10");
+    
+    std::string res = pAgent->ExecuteCommandLine("stats --histogram");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("decision-cycle") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("apply-phase") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("sml-command") != std::string::npos);
+    
+    pAgent->ExecuteCommandLine("stats --histogram --reset");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+}
+
+void MiscTest::testLatencyHistogramBuckets()
+{
+    soar_latency_histogram histogram;
+    CPPUNIT_ASSERT(histogram.get_percentile(50) == 0);
+    CPPUNIT_ASSERT(histogram.get_mean() == 0);
+    
+    // values below 32 get a bucket each
+    for (uint64_t i = 0; i < 16; i++)
+    {
+        histogram.record(i);
+    }
+    CPPUNIT_ASSERT(histogram.get_percentile(50) == 7);
+    CPPUNIT_ASSERT(histogram.get_percentile(100) == 15);
+    histogram.record(16);
+    histogram.record(17);
+    CPPUNIT_ASSERT(histogram.get_percentile(90) == 16);
+    
+    // above that, a bucket holds 1/16th of its power of two: 32 and 33 share one
+    histogram.reset();
+    CPPUNIT_ASSERT(histogram.get_count() == 0);
+    histogram.record(31);
+    histogram.record(32);
+    histogram.record(33);
+    histogram.record(34);
+    CPPUNIT_ASSERT(histogram.get_percentile(25) == 31);
+    CPPUNIT_ASSERT(histogram.get_percentile(50) == 33);
+    CPPUNIT_ASSERT(histogram.get_percentile(75) == 33);
+    CPPUNIT_ASSERT(histogram.get_percentile(100) == 34);
+    
+    // 1000 is in [992, 1023]
+    histogram.reset();
+    histogram.record(1000);
+    histogram.record(5000);
+    CPPUNIT_ASSERT(histogram.get_percentile(50) == 1023);
+    
+    histogram.reset();
+    for (uint64_t i = 1; i <= 100; i++)
+    {
+        histogram.record(i);
+    }
+    CPPUNIT_ASSERT(histogram.get_count() == 100);
+    CPPUNIT_ASSERT(histogram.get_total() == 5050);
+    CPPUNIT_ASSERT(histogram.get_max() == 100);
+    CPPUNIT_ASSERT(histogram.get_mean() == 50.5);
+    CPPUNIT_ASSERT(histogram.get_percentile(50) == 51);
+    CPPUNIT_ASSERT(histogram.get_percentile(90) == 91);
+    CPPUNIT_ASSERT(histogram.get_percentile(99) == 99);
+    // the top of 100's bucket is 103, but nothing above 100 was seen
+    CPPUNIT_ASSERT(histogram.get_percentile(100) == 100);
+    
+    // the largest values land in the last bucket without overflowing it
+    uint64_t top = ~static_cast<uint64_t>(0);
+    uint64_t high = static_cast<uint64_t>(1) << 63;
+    histogram.reset();
+    histogram.record(high);
+    histogram.record(top);
+    CPPUNIT_ASSERT(histogram.get_max() == top);
+    CPPUNIT_ASSERT(histogram.get_percentile(50) == high + (static_cast<uint64_t>(1) << 59) - 1);
+    CPPUNIT_ASSERT(histogram.get_percentile(100) == top);
+    CPPUNIT_ASSERT(histogram.get_percentile(200) == top);
+}
+
+void MiscTest::testDeadline()
+{
+    source("testPreferenceDeallocation.soar");
+    pAgent->ExecuteCommandLine("epmem --set learning on");
+    
+    sml::Agent* pReference = pKernel->CreateAgent("reference");
+    CPPUNIT_ASSERT(pReference != NULL);
+    pReference->LoadProductions("test_agents/testPreferenceDeallocation.soar");
+    pReference->ExecuteCommandLine("epmem --set learning on");
+    
+    // Every cycle is over a one microsecond deadline, but episodes are still stored in the cycle that asks for them
+    pAgent->ExecuteCommandLine("deadline 1");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    pKernel->RunAllAgents(10);
+    
+    std::string res = pAgent->ExecuteCommandLine("deadline");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("Deadline: 1 microseconds") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("wma-forgetting") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("epmem-store") == std::string::npos);
+    
+    res = pAgent->ExecuteCommandLine("epmem --stats time");
+    CPPUNIT_ASSERT_MESSAGE(res, res == pReference->ExecuteCommandLine("epmem --stats time"));
+    
+    pKernel->DestroyAgent(pReference);
+    
+    pAgent->ExecuteCommandLine("deadline --off");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("run 1");
+    
+    res = pAgent->ExecuteCommandLine("deadline");
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("Deadline mode is off") != std::string::npos);
+    
+    pAgent->ExecuteCommandLine("deadline 0");
+    CPPUNIT_ASSERT(!pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("deadline --reset");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+}
+
+void MiscTest::testMemoryAccounting()
+{
+    source("testPreferenceDeallocation.soar");
+    pAgent->ExecuteCommandLine("epmem --set learning on");
+    pAgent->ExecuteCommandLine("run 10");
+    
+    std::string res = pAgent->ExecuteCommandLine("stats --accounting");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("rete") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("epmem-db") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("sml") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(res, res.find("SQLite (all agents)") != std::string::npos);
+}
+
+void MiscTest::testPerfCounters()
+{
+    source("testPreferenceDeallocation.soar");
+    
+    // Counters often aren't available (containers, VMs), which has to be reported rather than break anything
+    pAgent->ExecuteCommandLine("timers --counters");
+    bool available = pAgent->GetLastCommandLineResult();
+    pAgent->ExecuteCommandLine("run 10");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    
+    std::string res = pAgent->ExecuteCommandLine("timers");
+    CPPUNIT_ASSERT_MESSAGE(res, res.find(available ? "Hardware counters are enabled" : "Hardware counters are unavailable") != std::string::npos);
+    
+    res = pAgent->ExecuteCommandLine("stats --counters");
+    CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    if (available)
+    {
+        CPPUNIT_ASSERT_MESSAGE(res, res.find("propose-phase") != std::string::npos);
+        CPPUNIT_ASSERT_MESSAGE(res, res.find("match") != std::string::npos);
+        
+        pAgent->ExecuteCommandLine("stats --counters --reset");
+        CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+        pAgent->ExecuteCommandLine("timers --no-counters");
+        CPPUNIT_ASSERT(pAgent->GetLastCommandLineResult());
+    }
+    else
+    {
+        CPPUNIT_ASSERT_MESSAGE(res, res.find("unavailable") != std::string::npos);
+    }
+}
@@ -8,6 +8,10 @@
 
 #include "sml_Client.h"
 
+#ifdef __linux__
+#include <dirent.h>
+#endif
+
 class MultiAgentTest : public CPPUNIT_NS::TestCase
 {
         CPPUNIT_TEST_SUITE(MultiAgentTest);
@@ -16,6 +20,9 @@ class MultiAgentTest : public CPPUNIT_NS::TestCase
         CPPUNIT_TEST(testTwoAgents);
         CPPUNIT_TEST(testTenAgents);
 #endif
+        CPPUNIT_TEST(testRunThreads);
+        CPPUNIT_TEST(testRunThreadsSeeded);
+        CPPUNIT_TEST(testRunThreadsCounters);
         CPPUNIT_TEST_SUITE_END();
         
     public:
@@ -29,9 +36,13 @@ class MultiAgentTest : public CPPUNIT_NS::TestCase
         void testOneAgentForSanity();
         void testTwoAgents();
         void testTenAgents();
+        void testRunThreads();
+        void testRunThreadsSeeded();
+        void testRunThreadsCounters();
         
     private:
         void doTest();
+        std::vector< int > runAgents(int runThreads);
         void createInput(sml::Agent* pAgent, int value);
         void reportAgentStatus(sml::Kernel* pKernel, int numberAgents, std::vector< std::stringstream* >& trace);
         void initAll(sml::Kernel* pKernel);
@@ -191,6 +202,162 @@ void MultiAgentTest::testTenAgents()
     doTest();
 }
 
+// Runs a few agents for a while on this many run threads and returns how many decisions each made
+std::vector< int > MultiAgentTest::runAgents(int runThreads)
+{
+    sml::Kernel* pKernel = sml::Kernel::CreateKernelInNewThread();
+    CPPUNIT_ASSERT_MESSAGE(pKernel->GetLastErrorDescription(), !pKernel->HadError());
+    
+    CPPUNIT_ASSERT(pKernel->SetRunThreads(runThreads));
+    
+    for (int agentCounter = 0 ; agentCounter < numberAgents ; ++agentCounter)
+    {
+        std::stringstream name;
+        name << "agent" << 1 + agentCounter;
+        
+        sml::Agent* pAgent = pKernel->CreateAgent(name.str().c_str()) ;
+        CPPUNIT_ASSERT(pAgent != NULL);
+        CPPUNIT_ASSERT(pAgent->LoadProductions("test_agents/testmulti.soar"));
+        createInput(pAgent, 0);
+    }
+    
+    pKernel->RegisterForUpdateEvent(sml::smlEVENT_AFTER_ALL_GENERATED_OUTPUT, MultiAgentTest::MyUpdateEventHandler, NULL) ;
+    
+    const int kRuns = 10 ;
+    for (int i = 0 ; i < kRuns ; i++)
+    {
+        pKernel->RunAllTilOutput() ;
+    }
+    
+    if (runThreads > 1)
+    {
+        // The utilization stats report on each run thread
+        std::stringstream expected;
+        expected << "Run threads: " << runThreads;
+        
+        std::string stats = pKernel->GetAgentByIndex(0)->ExecuteCommandLine("stats --utilization") ;
+        CPPUNIT_ASSERT(stats.find(expected.str()) != std::string::npos);
+    }
+    
+    // Can't change the threads while running, but can once we've stopped
+    CPPUNIT_ASSERT(pKernel->SetRunThreads(0));
+    
+    std::vector< int > decisions;
+    for (int agentCounter = 0 ; agentCounter < numberAgents ; ++agentCounter)
+    {
+        decisions.push_back(pKernel->GetAgentByIndex(agentCounter)->GetDecisionCycleCounter());
+    }
+    
+    pKernel->Shutdown() ;
+    delete pKernel ;
+    
+    return decisions;
+}
+
+void MultiAgentTest::testRunThreads()
+{
+    // Stepping the agents in parallel shouldn't change what any of them does
+    numberAgents = 8;
+    
+    std::vector< int > serial = runAgents(0);
+    std::vector< int > parallel = runAgents(4);
+    
+    CPPUNIT_ASSERT(serial == parallel);
+    CPPUNIT_ASSERT(serial[0] > 0);
+}
+
+void MultiAgentTest::testRunThreadsSeeded()
+{
+    // Agents given the same seed draw the same numbers, even while they run in parallel
+    sml::Kernel* pKernel = sml::Kernel::CreateKernelInNewThread();
+    CPPUNIT_ASSERT_MESSAGE(pKernel->GetLastErrorDescription(), !pKernel->HadError());
+    CPPUNIT_ASSERT(pKernel->SetRunThreads(2));
+    
+    sml::Agent* agents[2];
+    for (int i = 0; i < 2; i++)
+    {
+        agents[i] = pKernel->CreateAgent((i == 0) ? "seeded1" : "seeded2");
+        CPPUNIT_ASSERT(agents[i] != NULL);
+        
+        // a draw a decision, twenty times
+        agents[i]->ExecuteCommandLine("sp {propose*init (state <s> ^superstate nil -^count) --> (<s> ^operator <o> +) (<o> ^name init)}");
+        agents[i]->ExecuteCommandLine("sp {apply*init (state <s> ^operator.name init) --> (<s> ^count 0)}");
+        agents[i]->ExecuteCommandLine("sp {propose*draw (state <s> ^superstate nil ^count { <c> < 20 }) --> (<s> ^operator <o> + =) (<o> ^name draw)}");
+        agents[i]->ExecuteCommandLine("sp {apply*draw (state <s> ^operator.name draw ^count <c>) --> (<s> ^count <c> - (+ <c> 1) ^draw (rand-int 1000000))}");
+        CPPUNIT_ASSERT_MESSAGE(agents[i]->GetLastErrorDescription(), agents[i]->GetLastCommandLineResult());
+        agents[i]->ExecuteCommandLine("srand 42");
+        CPPUNIT_ASSERT(agents[i]->GetLastCommandLineResult());
+    }
+    
+    pKernel->RunAllAgents(50);
+    CPPUNIT_ASSERT(pKernel->SetRunThreads(0));
+    
+    std::string count = agents[0]->ExecuteCommandLine("print --depth 1 s1");
+    CPPUNIT_ASSERT_MESSAGE(count, count.find("^count 20") != std::string::npos);
+    
+    std::string first = agents[0]->ExecuteCommandLine("rand --integer");
+    std::string second = agents[1]->ExecuteCommandLine("rand --integer");
+    CPPUNIT_ASSERT_MESSAGE(first + " " + second, first == second);
+    
+    pKernel->Shutdown();
+    delete pKernel;
+}
+
+// How many descriptors the process has open (-1 where that can't be told)
+static int countOpenFiles()
+{
+    int count = -1;
+#ifdef __linux__
+    DIR* pDir = opendir("/proc/self/fd");
+    if (pDir)
+    {
+        count = 0;
+        while (readdir(pDir))
+        {
+            count++;
+        }
+        closedir(pDir);
+    }
+#endif
+    return count;
+}
+
+void MultiAgentTest::testRunThreadsCounters()
+{
+    // Each run thread opens its own hardware counters, which have to be closed when the threads go
+    sml::Kernel* pKernel = sml::Kernel::CreateKernelInNewThread();
+    CPPUNIT_ASSERT_MESSAGE(pKernel->GetLastErrorDescription(), !pKernel->HadError());
+    
+    for (int i = 0; i < 4; i++)
+    {
+        std::stringstream name;
+        name << "counted" << (i + 1);
+        
+        sml::Agent* pAgent = pKernel->CreateAgent(name.str().c_str());
+        CPPUNIT_ASSERT(pAgent != NULL);
+        CPPUNIT_ASSERT(pAgent->LoadProductions("test_agents/testmulti.soar"));
+        
+        // Unavailable counters are reported as an error, and there's nothing to close
+        pAgent->ExecuteCommandLine("timers --counters");
+    }
+    
+    int before = countOpenFiles();
+    
+    for (int pass = 0; pass < 3; pass++)
+    {
+        CPPUNIT_ASSERT(pKernel->SetRunThreads(4));
+        pKernel->RunAllAgents(20);
+        CPPUNIT_ASSERT(pKernel->SetRunThreads(0));
+    }
+    
+    std::stringstream counts;
+    counts << before << " open before, " << countOpenFiles() << " after";
+    CPPUNIT_ASSERT_MESSAGE(counts.str(), countOpenFiles() == before);
+    
+    pKernel->Shutdown();
+    delete pKernel;
+}
+
 void MultiAgentTest::doTest()
 {
     sml::Kernel* pKernel = sml::Kernel::CreateKernelInNewThread();
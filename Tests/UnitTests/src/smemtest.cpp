@@ -6,6 +6,10 @@
 #include "kernel.h"
 #include "sml_Events.h"
 
+#include <ctype.h>
+#include <fstream>
+#include <sstream>
+
 
 //IMPORTANT:  DON'T USE THE VARIABLE success.  It is declared globally in another test suite and we don't own it here.
 
@@ -16,6 +20,13 @@ class SMemTest : public CPPUNIT_NS::TestCase
 #ifdef DO_SMEM_TESTS
         CPPUNIT_TEST(testISupport);
         CPPUNIT_TEST(testISupportWithLearning);
+        CPPUNIT_TEST(testNativeStoreParity);
+        CPPUNIT_TEST(testActivationIndexParity);
+        CPPUNIT_TEST(testSpreading);
+        CPPUNIT_TEST(testSharedStore);
+        CPPUNIT_TEST(testSharedIncrementalUpdates);
+        CPPUNIT_TEST(testImportParity);
+        CPPUNIT_TEST(testImportAllOrNothing);
 #endif
         CPPUNIT_TEST_SUITE_END();
         
@@ -29,6 +40,16 @@ class SMemTest : public CPPUNIT_NS::TestCase
         
         void testISupport();
         void testISupportWithLearning();
+        void testNativeStoreParity();
+        void testActivationIndexParity();
+        void testSpreading();
+        void testSharedStore();
+        void testSharedIncrementalUpdates();
+        void testImportParity();
+        void testImportAllOrNothing();
+        
+        std::string runStoreQueries(const char* nativeStore);
+        std::string runImportQueries();
         
         sml::Kernel* pKernel;
         sml::Agent* pAgent;
@@ -81,3 +102,353 @@ void SMemTest::testISupportWithLearning()
     pAgent->RunSelf(10, sml::sml_DECISION);
     CPPUNIT_ASSERT(succeeded);
 }
+
+std::string SMemTest::runStoreQueries(const char* nativeStore)
+{
+    std::string output;
+    
+    pAgent->ExecuteCommandLine((std::string("smem --set native-store ") + nativeStore).c_str());
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    
+    pAgent->ExecuteCommandLine("smem --add {(<a> ^name alice ^age 30 ^height 1.6 ^friend <b>) (<b> ^name bob ^age 25 ^friend <c>) (<c> ^name carol ^age 30 ^height 1.7)}");
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    
+    // activate bob so that recency changes the ordering below
+    output += pAgent->ExecuteCommandLine("smem --query {(<cue> ^name bob)}");
+    output += pAgent->ExecuteCommandLine("smem --query {(<cue> ^age 30)} 5");
+    output += pAgent->ExecuteCommandLine("smem --query {(<cue> ^friend <x>)} 5");
+    output += pAgent->ExecuteCommandLine("smem --query {(<cue> ^age 30 -^friend <x>)} 5");
+    output += pAgent->ExecuteCommandLine("smem --query {(<cue> ^name dave)}");
+    
+    // replacing a node must update the frequency and edge data used by queries
+    pAgent->ExecuteCommandLine("smem --add {(@C4 ^name carol ^age 31)}");
+    output += pAgent->ExecuteCommandLine("smem --query {(<cue> ^age 30)} 5");
+    output += pAgent->ExecuteCommandLine("smem --query {(<cue> ^age 31)} 5");
+    
+    return output;
+}
+
+void SMemTest::testNativeStoreParity()
+{
+    std::string native = runStoreQueries("on");
+    CPPUNIT_ASSERT(native.find("alice") != std::string::npos);
+    
+    pKernel->DestroyAgent(pAgent);
+    pAgent = pKernel->CreateAgent("soar2");
+    CPPUNIT_ASSERT(pAgent != NULL);
+    
+    std::string database = runStoreQueries("off");
+    CPPUNIT_ASSERT_MESSAGE(database, database == native);
+}
+
+void SMemTest::testActivationIndexParity()
+{
+    // naive base-level updates activate candidates as the index reads them
+    pAgent->ExecuteCommandLine("smem --set activation-mode base-level");
+    pAgent->ExecuteCommandLine("smem --set base-update-policy naive");
+    std::string native = runStoreQueries("on");
+    CPPUNIT_ASSERT(native.find("alice") != std::string::npos);
+    
+    pKernel->DestroyAgent(pAgent);
+    pAgent = pKernel->CreateAgent("soar2");
+    CPPUNIT_ASSERT(pAgent != NULL);
+    
+    pAgent->ExecuteCommandLine("smem --set activation-mode base-level");
+    pAgent->ExecuteCommandLine("smem --set base-update-policy naive");
+    std::string database = runStoreQueries("off");
+    CPPUNIT_ASSERT_MESSAGE(database, database == native);
+}
+
+// the name of the lti a query printed (such as @C4), or empty
+static std::string retrievedName(const std::string& result)
+{
+    size_t start = result.find("(@");
+    if (start == std::string::npos)
+    {
+        return "";
+    }
+    
+    return result.substr(start + 1, result.find(' ', start) - start - 1);
+}
+
+void SMemTest::testSpreading()
+{
+    pAgent->ExecuteCommandLine("smem --set learning on");
+    pAgent->ExecuteCommandLine("smem --set spreading on");
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine("smem --set activation-mode frequency");
+    
+    // both targets are accessed once, but only bob is linked from the context
+    pAgent->ExecuteCommandLine("smem --add {(<c> ^name context ^link <b>) (<a> ^type target ^name alice) (<b> ^type target ^name bob)}");
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    
+    pAgent->ExecuteCommandLine("sp {retrieve-context (state <s> ^superstate nil ^smem.command <cmd>) --> (<cmd> ^query <q>) (<q> ^name context)}");
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    pAgent->RunSelf(2, sml::sml_DECISION);
+    
+    std::string result = pAgent->ExecuteCommandLine("smem --query {(<cue> ^type target)}");
+    CPPUNIT_ASSERT_MESSAGE(result, result.find("bob") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(result, result.find("alice") == std::string::npos);
+    
+    // relinking the context must move its spread to alice
+    std::string context = retrievedName(pAgent->ExecuteCommandLine("smem --query {(<cue> ^name context)}"));
+    std::string alice = retrievedName(pAgent->ExecuteCommandLine("smem --query {(<cue> ^name alice)}"));
+    CPPUNIT_ASSERT(!context.empty() && !alice.empty());
+    
+    pAgent->ExecuteCommandLine(("smem --remove {(" + context + " ^link)}").c_str());
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine(("smem --add {(" + context + " ^link " + alice + ")}").c_str());
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    
+    result = pAgent->ExecuteCommandLine("smem --query {(<cue> ^type target)}");
+    CPPUNIT_ASSERT_MESSAGE(result, result.find("alice") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(result, result.find("bob") == std::string::npos);
+    
+    // more changes than are logged start the spread over, which must
+    // still follow the context when it is linked back to bob
+    std::ostringstream chain;
+    chain << "smem --add {";
+    for (int i = 0; i < 5000; i++)
+    {
+        chain << "(<n" << i << "> ^next <n" << (i + 1) << ">) ";
+    }
+    chain << "}";
+    pAgent->ExecuteCommandLine(chain.str().c_str());
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    
+    std::string bob = retrievedName(pAgent->ExecuteCommandLine("smem --query {(<cue> ^name bob)}"));
+    CPPUNIT_ASSERT(!bob.empty());
+    pAgent->ExecuteCommandLine(("smem --remove {(" + context + " ^link)}").c_str());
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    pAgent->ExecuteCommandLine(("smem --add {(" + context + " ^link " + bob + ")}").c_str());
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    
+    result = pAgent->ExecuteCommandLine("smem --query {(<cue> ^type target)}");
+    CPPUNIT_ASSERT_MESSAGE(result, result.find("bob") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(result, result.find("alice") == std::string::npos);
+}
+
+void SMemTest::testSharedStore()
+{
+    remove("smem-shared-test.db");
+    
+    pAgent->ExecuteCommandLine("smem --set database file");
+    pAgent->ExecuteCommandLine("smem --set path smem-shared-test.db");
+    pAgent->ExecuteCommandLine("smem --add {(<a> ^name alice ^age 30 ^friend <b>) (<b> ^name bob ^age 25)}");
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    
+    // closing writes the database file
+    pKernel->DestroyAgent(pAgent);
+    
+    sml::Agent* agents[2];
+    for (int i = 0; i < 2; i++)
+    {
+        agents[i] = pKernel->CreateAgent((i == 0) ? "shared1" : "shared2");
+        CPPUNIT_ASSERT(agents[i] != NULL);
+        agents[i]->ExecuteCommandLine("smem --set database file");
+        agents[i]->ExecuteCommandLine("smem --set path smem-shared-test.db");
+        agents[i]->ExecuteCommandLine("smem --set shared on");
+        CPPUNIT_ASSERT_MESSAGE(agents[i]->GetLastErrorDescription(), agents[i]->GetLastCommandLineResult());
+    }
+    
+    // activation by one agent must not show in the other
+    std::string first = agents[0]->ExecuteCommandLine("smem --query {(<cue> ^age 30)}");
+    CPPUNIT_ASSERT_MESSAGE(first, first.find("alice") != std::string::npos);
+    agents[0]->ExecuteCommandLine("smem --query {(<cue> ^age 30)}");
+    std::string second = agents[1]->ExecuteCommandLine("smem --query {(<cue> ^age 30)}");
+    CPPUNIT_ASSERT_MESSAGE(second, second == first);
+    
+    // the shared store is read-only
+    agents[1]->ExecuteCommandLine("smem --add {(<c> ^name carol)}");
+    CPPUNIT_ASSERT(!agents[1]->GetLastCommandLineResult());
+    
+    // and its database is only a scratch copy, so it can't be visualized
+    std::string viz = agents[1]->ExecuteCommandLine("smem --viz");
+    CPPUNIT_ASSERT(!agents[1]->GetLastCommandLineResult());
+    CPPUNIT_ASSERT_MESSAGE(viz, viz.find("shared") != std::string::npos);
+    
+    pKernel->DestroyAgent(agents[0]);
+    pKernel->DestroyAgent(agents[1]);
+    pAgent = pKernel->CreateAgent("soar1");
+    
+    remove("smem-shared-test.db");
+}
+
+void SMemTest::testSharedIncrementalUpdates()
+{
+    // the same store, shared by one agent and private to the other
+    const char* paths[2] = { "smem-shared-incremental.db", "smem-private-incremental.db" };
+    for (int i = 0; i < 2; i++)
+    {
+        remove(paths[i]);
+        pAgent->ExecuteCommandLine("smem --set database file");
+        pAgent->ExecuteCommandLine((std::string("smem --set path ") + paths[i]).c_str());
+        
+        // (the database keeps the activation mode it was made with)
+        pAgent->ExecuteCommandLine("smem --set activation-mode base-level");
+        pAgent->ExecuteCommandLine("smem --add {(<a> ^name alice ^age 30) (<b> ^name bob ^age 30) (<c> ^name carol ^age 30) (<d> ^name dave ^age 30)}");
+        CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+        
+        // closing writes the database file
+        pKernel->DestroyAgent(pAgent);
+        pAgent = pKernel->CreateAgent("soar1");
+    }
+    
+    std::string output[2];
+    for (int i = 0; i < 2; i++)
+    {
+        sml::Agent* pIncremental = pKernel->CreateAgent((i == 0) ? "shared" : "private");
+        CPPUNIT_ASSERT(pIncremental != NULL);
+        pIncremental->ExecuteCommandLine("smem --set database file");
+        pIncremental->ExecuteCommandLine((std::string("smem --set path ") + paths[i]).c_str());
+        pIncremental->ExecuteCommandLine((i == 0) ? "smem --set shared on" : "smem --set shared off");
+        pIncremental->ExecuteCommandLine("smem --set learning on");
+        pIncremental->ExecuteCommandLine("smem --set base-update-policy incremental");
+        pIncremental->ExecuteCommandLine("smem --set base-incremental-threshes 1");
+        pIncremental->ExecuteCommandLine("smem --set base-incremental-threshes 3");
+        CPPUNIT_ASSERT_MESSAGE(pIncremental->GetLastErrorDescription(), pIncremental->GetLastCommandLineResult());
+        
+        // retrieve the names in turn; each retrieval reactivates the ltis
+        // retrieved one and three retrievals before it
+        pIncremental->ExecuteCommandLine("sp {propose*init (state <s> ^superstate nil -^current) --> (<s> ^operator <o> +) (<o> ^name init)}");
+        CPPUNIT_ASSERT_MESSAGE(pIncremental->GetLastErrorDescription(), pIncremental->GetLastCommandLineResult());
+        pIncremental->ExecuteCommandLine("sp {apply*init (state <s> ^operator.name init) --> (<s> ^current <q1>) (<q1> ^name bob ^next <q2>) (<q2> ^name carol ^next <q3>) (<q3> ^name bob ^next <q4>) (<q4> ^name dave ^next <q5>) (<q5> ^name alice ^next <q6>) (<q6> ^name carol ^next <q7>) (<q7> ^name bob)}");
+        CPPUNIT_ASSERT_MESSAGE(pIncremental->GetLastErrorDescription(), pIncremental->GetLastCommandLineResult());
+        pIncremental->ExecuteCommandLine("sp {query (state <s> ^current.name <name> ^smem.command <cmd>) --> (<cmd> ^query <q>) (<q> ^name <name>)}");
+        CPPUNIT_ASSERT_MESSAGE(pIncremental->GetLastErrorDescription(), pIncremental->GetLastCommandLineResult());
+        pIncremental->ExecuteCommandLine("sp {propose*next (state <s> ^current.next <n> ^smem.result.success) --> (<s> ^operator <o> +) (<o> ^name next)}");
+        CPPUNIT_ASSERT_MESSAGE(pIncremental->GetLastErrorDescription(), pIncremental->GetLastCommandLineResult());
+        pIncremental->ExecuteCommandLine("sp {apply*next (state <s> ^operator.name next ^current <q>) (<q> ^next <n>) --> (<s> ^current <q> - <n>)}");
+        CPPUNIT_ASSERT_MESSAGE(pIncremental->GetLastErrorDescription(), pIncremental->GetLastCommandLineResult());
+        pIncremental->ExecuteCommandLine("watch 0");
+        pIncremental->RunSelf(20, sml::sml_DECISION);
+        
+        output[i] += pIncremental->ExecuteCommandLine("smem --print");
+        output[i] += pIncremental->ExecuteCommandLine("smem --query {(<cue> ^age 30)} 4");
+        
+        pKernel->DestroyAgent(pIncremental);
+        remove(paths[i]);
+    }
+    
+    CPPUNIT_ASSERT_MESSAGE(output[0] + output[1], output[0] == output[1]);
+}
+
+std::string SMemTest::runImportQueries()
+{
+    std::string output;
+    
+    output += pAgent->ExecuteCommandLine("smem --query {(<cue> ^group 3)} 5");
+    output += pAgent->ExecuteCommandLine("smem --query {(<cue> ^name |item 17|)}");
+    output += pAgent->ExecuteCommandLine("smem --query {(<cue> ^next <n> ^group 4)} 3");
+    output += pAgent->ExecuteCommandLine("smem --query {(<cue> ^weight 40)} 3");
+    
+    // lti numbers within a clause depend on parse order, so mask them
+    std::string masked;
+    for (std::string::size_type i = 0; i < output.size(); i++)
+    {
+        masked += output[i];
+        if (output[i] == '@')
+        {
+            while (((i + 1) < output.size()) && (isalnum(output[i + 1])))
+            {
+                i++;
+            }
+        }
+    }
+    
+    return masked;
+}
+
+void SMemTest::testImportParity()
+{
+    // enough augmentations for several full insert batches plus a partial one
+    {
+        std::ofstream out("smem-import-test.soar");
+        for (int i = 0; i < 150; i++)
+        {
+            out << "smem --add {(<i" << i << "> ^name |item " << i << "| ^group " << (i % 7) << " ^weight " << (i * 2);
+            if (i > 0)
+            {
+                out << " ^next <i" << (i - 1) << ">";
+            }
+            out << ")}\n";
+        }
+    }
+    
+    pAgent->LoadProductions("smem-import-test.soar");
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+    std::string added = runImportQueries();
+    CPPUNIT_ASSERT(added.find("item 17") != std::string::npos);
+    
+    pKernel->DestroyAgent(pAgent);
+    pAgent = pKernel->CreateAgent("soar2");
+    CPPUNIT_ASSERT(pAgent != NULL);
+    
+    CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->ImportSMem("smem-import-test.soar"));
+    std::string imported = runImportQueries();
+    CPPUNIT_ASSERT_MESSAGE(imported, imported == added);
+    
+    // a missing file is an error, not an empty import
+    CPPUNIT_ASSERT(!pAgent->ImportSMem("smem-import-missing.soar"));
+    
+    remove("smem-import-test.soar");
+}
+
+void SMemTest::testImportAllOrNothing()
+{
+    const char* nativeStores[] = { "on", "off" };
+    
+    for (int i = 0; i < 2; i++)
+    {
+        pKernel->DestroyAgent(pAgent);
+        pAgent = pKernel->CreateAgent("soar1");
+        CPPUNIT_ASSERT(pAgent != NULL);
+        
+        pAgent->ExecuteCommandLine((std::string("smem --set native-store ") + nativeStores[i]).c_str());
+        CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+        pAgent->ExecuteCommandLine("smem --add {(<k> ^name kept ^next <l>) (<l> ^name later)}");
+        CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->GetLastCommandLineResult());
+        
+        // (the store's size, and its contents without activating them)
+        std::string stats = pAgent->ExecuteCommandLine("smem --stats");
+        std::string before = pAgent->ExecuteCommandLine("smem --print") + stats.substr(stats.find("Nodes:"));
+        
+        // the last clause is missing a value, so none of the file may be imported
+        {
+            std::ofstream out("smem-import-test.soar");
+            out << "# smem --add {(<c> ^name commented)}\n";
+            out << "sp {rule (state <s> ^superstate nil) --> (<s> ^note |smem --add {(<z> ^name inside)}|)}\n";
+            out << "smem --add {(<a> ^name first ^next <b>)\n    (<b> ^name second)}\n";
+            out << "smem -a {(<x> ^name |brace } in bars|)}\n";
+            out << "smem --add {(<y> ^name broken ^next)}\n";
+        }
+        
+        CPPUNIT_ASSERT(!pAgent->ImportSMem("smem-import-test.soar"));
+        std::string error = pAgent->GetLastErrorDescription();
+        CPPUNIT_ASSERT_MESSAGE(error, error.find("line 6") != std::string::npos);
+        
+        stats = pAgent->ExecuteCommandLine("smem --stats");
+        std::string after = pAgent->ExecuteCommandLine("smem --print") + stats.substr(stats.find("Nodes:"));
+        CPPUNIT_ASSERT_MESSAGE(after, after == before);
+        
+        // without it, only the smem --add commands are imported
+        {
+            std::ofstream out("smem-import-test.soar");
+            out << "# smem --add {(<c> ^name commented)}\n";
+            out << "sp {rule (state <s> ^superstate nil) --> (<s> ^note |smem --add {(<z> ^name inside)}|)}\n";
+            out << "smem --add {(<a> ^name first ^next <b>)\n    (<b> ^name second)}\n";
+            out << "smem -a {(<x> ^name |brace } in bars|)}\n";
+        }
+        
+        CPPUNIT_ASSERT_MESSAGE(pAgent->GetLastErrorDescription(), pAgent->ImportSMem("smem-import-test.soar"));
+        
+        std::string imported = pAgent->ExecuteCommandLine("smem --query {(<cue> ^name <n>)} 10");
+        CPPUNIT_ASSERT_MESSAGE(imported, imported.find("kept") != std::string::npos);
+        CPPUNIT_ASSERT_MESSAGE(imported, imported.find("second") != std::string::npos);
+        CPPUNIT_ASSERT_MESSAGE(imported, imported.find("brace } in bars") != std::string::npos);
+        CPPUNIT_ASSERT_MESSAGE(imported, imported.find("commented") == std::string::npos);
+        CPPUNIT_ASSERT_MESSAGE(imported, imported.find("inside") == std::string::npos);
+        
+        remove("smem-import-test.soar");
+    }
+}
@@ -2,15 +2,19 @@
 #define UNITTEST_H
 
 #include <iostream>
+#include <cstdlib> // LOCALONLY
 #include <list>
 #include <stdexcept>
 #include <string>
 #include <sstream>
 
 #define DO_ALIAS_TESTS
+#define DO_BINARYSML_TESTS
 #define DO_CLIPARSER_TESTS
+#define DO_CONNECTION_TESTS
 #define DO_ELEMENTXML_TESTS
 #define DO_FULL_TESTS
+#define DO_INPUTBATCH_TESTS
 #define DO_IO_TESTS
 #define DO_EPMEM_TESTS
 #define DO_SMEM_TESTS
@@ -124,6 +128,7 @@ class CPPUNIT_NS
                     std::list<std::pair<std::string, CPPUnit_Function*> > tests = get_tests();
                     for (std::list<std::pair<std::string, CPPUnit_Function*> >::iterator tt = tests.begin(), tend = tests.end(); tt != tend; ++tt)
                     {
+                        if (getenv("UT_FILTER") && (std::string(getenv("UT_FILTER")).find(this->get_class_name() + "::" + tt->first) == std::string::npos) && (std::string(getenv("UT_FILTER")) != this->get_class_name())) { delete tt->second; continue; } // LOCALONLY
                         std::cout << this->get_class_name() << "::" << tt->first;
                         std::cout.flush();
                         this->setUp();